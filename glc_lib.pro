@@ -17,5 +17,5 @@ greaterThan(QT_MAJOR_VERSION, 4){
 cache()
 }
 
-SUBDIRS += src/lib src/examples \
+SUBDIRS += src/lib src/examples src/benchmarks \
     src/plugins
@@ -0,0 +1,4 @@
+TEMPLATE = subdirs
+!ios{
+SUBDIRS +=  glc_benchmarks
+}
@@ -0,0 +1,128 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include <algorithm>
+
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QTextStream>
+
+#include "benchmarkrunner.h"
+
+BenchmarkRunner::BenchmarkRunner()
+: m_RepetitionCount(5)
+, m_Filters()
+, m_Context()
+, m_Results()
+, m_Name()
+, m_Parameters()
+, m_Counters()
+, m_Samples()
+, m_Timer()
+, m_FailureCount(0)
+{
+
+}
+
+bool BenchmarkRunner::isSelected(const QString& name) const
+{
+	if (m_Filters.isEmpty()) return true;
+	const int count= m_Filters.size();
+	for (int i= 0; i < count; ++i)
+	{
+		// A group name is selected by the filter of one of its benchmarks
+		if (name.contains(m_Filters.at(i)) || m_Filters.at(i).contains(name)) return true;
+	}
+	return false;
+}
+
+QByteArray BenchmarkRunner::toJson() const
+{
+	QJsonObject document;
+	document.insert("suite", QString("glc_benchmarks"));
+	document.insert("context", QJsonObject::fromVariantMap(m_Context));
+	document.insert("results", m_Results);
+	return QJsonDocument(document).toJson(QJsonDocument::Indented);
+}
+
+void BenchmarkRunner::setContext(const QString& key, const QVariant& value)
+{
+	m_Context.insert(key, value);
+}
+
+void BenchmarkRunner::begin(const QString& name, const QVariantMap& parameters)
+{
+	m_Name= name;
+	m_Parameters= parameters;
+	m_Counters.clear();
+	m_Samples.clear();
+
+	// Progress goes to the error output, the results may go to the standard output
+	QTextStream(stderr) << "Running " << name << endl;
+}
+
+void BenchmarkRunner::setCounter(const QString& key, const QVariant& value)
+{
+	m_Counters.insert(key, value);
+}
+
+void BenchmarkRunner::end()
+{
+	QJsonObject result;
+	result.insert("name", m_Name);
+	result.insert("parameters", QJsonObject::fromVariantMap(m_Parameters));
+	result.insert("counters", QJsonObject::fromVariantMap(m_Counters));
+
+	const int count= m_Samples.size();
+	result.insert("repetitions", count);
+	if (count > 0)
+	{
+		QVector<qint64> samples(m_Samples);
+		std::sort(samples.begin(), samples.end());
+		qint64 total= 0;
+		for (int i= 0; i < count; ++i)
+		{
+			total+= samples.at(i);
+		}
+
+		// Times in milliseconds
+		result.insert("min_ms", static_cast<double>(samples.first()) / 1000000.0);
+		result.insert("median_ms", static_cast<double>(samples.at(count / 2)) / 1000000.0);
+		result.insert("mean_ms", static_cast<double>(total) / (1000000.0 * count));
+		result.insert("max_ms", static_cast<double>(samples.last()) / 1000000.0);
+	}
+	m_Results.append(result);
+	m_Samples.clear();
+}
+
+void BenchmarkRunner::fail(const QString& message)
+{
+	QJsonObject result;
+	result.insert("name", m_Name);
+	result.insert("parameters", QJsonObject::fromVariantMap(m_Parameters));
+	result.insert("error", message);
+	m_Results.append(result);
+	m_Samples.clear();
+	++m_FailureCount;
+
+	QTextStream(stderr) << "Failed " << m_Name << " : " << message << endl;
+}
@@ -0,0 +1,122 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#ifndef BENCHMARKRUNNER_H_
+#define BENCHMARKRUNNER_H_
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QVariantMap>
+#include <QJsonArray>
+#include <QElapsedTimer>
+
+//! Collect the timings of the benchmarks and write them as JSON
+/*! A benchmark measures an operation repetitionCount() times with
+ *  start() and stop() around the measured code. The minimum, median,
+ *  mean and maximum times are recorded with the benchmark parameters.
+ */
+class BenchmarkRunner
+{
+public:
+	BenchmarkRunner();
+
+public:
+	//! Return the number of measures by benchmark
+	inline int repetitionCount() const
+	{return m_RepetitionCount;}
+
+	//! Return true if the benchmark of the given name must be run
+	bool isSelected(const QString& name) const;
+
+	//! Return the results as a JSON document
+	QByteArray toJson() const;
+
+	//! Return the number of failed benchmarks
+	inline int failureCount() const
+	{return m_FailureCount;}
+
+public:
+	//! Set the number of measures by benchmark
+	inline void setRepetitionCount(int count)
+	{m_RepetitionCount= qMax(1, count);}
+
+	//! Set the name filters, a benchmark is run if its name contains one of them or is contained by one of them
+	inline void setFilters(const QStringList& filters)
+	{m_Filters= filters;}
+
+	//! Set a value describing the run, written with the results
+	void setContext(const QString& key, const QVariant& value);
+
+	//! Begin the measures of the benchmark of the given name and parameters
+	void begin(const QString& name, const QVariantMap& parameters);
+
+	//! Start a measure
+	inline void start()
+	{m_Timer.start();}
+
+	//! Stop the current measure
+	inline void stop()
+	{m_Samples.append(m_Timer.nsecsElapsed());}
+
+	//! Set a counter of the current benchmark, used to check the measured work
+	void setCounter(const QString& key, const QVariant& value);
+
+	//! End the measures of the current benchmark and record the result
+	void end();
+
+	//! End the current benchmark with the given error
+	void fail(const QString& message);
+
+private:
+	//! The number of measures by benchmark
+	int m_RepetitionCount;
+
+	//! The name filters
+	QStringList m_Filters;
+
+	//! The values describing the run
+	QVariantMap m_Context;
+
+	//! The recorded results
+	QJsonArray m_Results;
+
+	//! The name of the current benchmark
+	QString m_Name;
+
+	//! The parameters of the current benchmark
+	QVariantMap m_Parameters;
+
+	//! The counters of the current benchmark
+	QVariantMap m_Counters;
+
+	//! The measures of the current benchmark in nanoseconds
+	QVector<qint64> m_Samples;
+
+	//! The measure timer
+	QElapsedTimer m_Timer;
+
+	//! The number of failed benchmarks
+	int m_FailureCount;
+};
+
+#endif /* BENCHMARKRUNNER_H_ */
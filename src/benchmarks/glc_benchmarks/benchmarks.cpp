@@ -0,0 +1,611 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <qmath.h>
+
+#include <GLC_Factory>
+#include <GLC_World>
+#include <GLC_Mesh>
+#include <GLC_3DRep>
+#include <GLC_BSRep>
+#include <GLC_Octree>
+#include <GLC_RayPicker>
+#include <GLC_OcclusionCuller>
+#include <GLC_SectionEngine>
+#include <GLC_Camera>
+#include <GLC_Frustum>
+#include <GLC_Matrix4x4>
+#include <GLC_Plane>
+#include <GLC_StructOccurrence>
+#include <GLC_Exception>
+#include <GLC_WorldTo3dxml>
+#include <GLC_State>
+
+#include "benchmarks.h"
+#include "benchmarkrunner.h"
+
+// The number of camera positions of a frustum culling measure
+#define BENCHMARK_CAMERA_STEPS 32
+
+// The number of rays of a picking measure
+#define BENCHMARK_RAY_COUNT 1000
+
+Benchmarks::Benchmarks(BenchmarkRunner* pRunner, const QString& workDirectory, Scale scale)
+: m_pRunner(pRunner)
+, m_WorkDirectory(workDirectory)
+, m_InstanceCount(10000)
+, m_TriangleCount(512)
+{
+	if (scale == Small)
+	{
+		m_InstanceCount= 1000;
+		m_TriangleCount= 128;
+	}
+	else if (scale == Large)
+	{
+		m_InstanceCount= 100000;
+		m_TriangleCount= 1024;
+	}
+}
+
+QStringList Benchmarks::names()
+{
+	QStringList subject;
+	subject << "load_stl" << "load_obj" << "load_collada" << "load_3dxml" << "export_3dxml" << "bsrep" << "mesh_finish"
+			<< "vertex_cache" << "octree" << "occlusion" << "picking" << "section" << "traversal";
+	return subject;
+}
+
+Benchmarks::Scale Benchmarks::scaleFromName(const QString& name)
+{
+	if (name == "small") return Small;
+	else if (name == "large") return Large;
+	else return Medium;
+}
+
+void Benchmarks::run()
+{
+	if (m_pRunner->isSelected("load_stl")) benchmarkStlLoading();
+	if (m_pRunner->isSelected("load_obj")) benchmarkObjLoading();
+	if (m_pRunner->isSelected("load_collada")) benchmarkColladaLoading();
+	if (m_pRunner->isSelected("load_3dxml")) benchmark3dxmlLoading();
+	if (m_pRunner->isSelected("export_3dxml")) benchmark3dxmlExport();
+	if (m_pRunner->isSelected("bsrep")) benchmarkBSRep();
+	if (m_pRunner->isSelected("mesh_finish")) benchmarkMeshFinish();
+	if (m_pRunner->isSelected("vertex_cache")) benchmarkVertexCache();
+	if (m_pRunner->isSelected("octree")) benchmarkOctree();
+	if (m_pRunner->isSelected("occlusion")) benchmarkOcclusion();
+	if (m_pRunner->isSelected("picking")) benchmarkPicking();
+	if (m_pRunner->isSelected("section")) benchmarkSection();
+	if (m_pRunner->isSelected("traversal")) benchmarkTraversal();
+}
+
+void Benchmarks::benchmarkStlLoading()
+{
+	// A single large part, STL has no assembly
+	SyntheticWorld::Parameters parameters= SyntheticWorld::parameters(1, m_TriangleCount * 200);
+	const QString fileName(QDir(m_WorkDirectory).filePath("part.stl"));
+	if (SyntheticWorld::writeStl(fileName, parameters))
+	{
+		measureLoading("load_stl", fileName, parameters);
+	}
+	else
+	{
+		m_pRunner->begin("load_stl", SyntheticWorld::toVariantMap(parameters));
+		m_pRunner->fail("Unable to write " + fileName);
+	}
+}
+
+void Benchmarks::benchmarkObjLoading()
+{
+	// OBJ has no instancing, keep the file size of the other formats
+	SyntheticWorld::Parameters parameters= worldParameters(SyntheticWorld::Flat, SyntheticWorld::SharedReps);
+	parameters.m_InstanceCount= qMax(1, parameters.m_InstanceCount / 10);
+	const QString fileName(QDir(m_WorkDirectory).filePath("world.obj"));
+	if (SyntheticWorld::writeObj(fileName, parameters))
+	{
+		measureLoading("load_obj", fileName, parameters);
+	}
+	else
+	{
+		m_pRunner->begin("load_obj", SyntheticWorld::toVariantMap(parameters));
+		m_pRunner->fail("Unable to write " + fileName);
+	}
+}
+
+void Benchmarks::benchmarkColladaLoading()
+{
+	for (int sharing= SyntheticWorld::SharedReps; sharing <= SyntheticWorld::UniqueReps; ++sharing)
+	{
+		SyntheticWorld::Parameters parameters= worldParameters(SyntheticWorld::Flat, static_cast<SyntheticWorld::RepSharing>(sharing));
+		parameters.m_InstanceCount= qMax(1, parameters.m_InstanceCount / 10);
+		const QString fileName(QDir(m_WorkDirectory).filePath(QString("world%1.dae").arg(sharing)));
+		if (SyntheticWorld::writeCollada(fileName, parameters))
+		{
+			// The geometries are built serially then on worker threads
+			const bool parallelLoadingIsActivated= GLC_State::isParallelLoadingActivated();
+			for (int parallel= 0; parallel < 2; ++parallel)
+			{
+				QVariantMap extraParameters;
+				extraParameters.insert("parallel", parallel == 1);
+				GLC_State::setParallelLoadingUsage(parallel == 1);
+				measureLoading("load_collada", fileName, parameters, extraParameters);
+			}
+			GLC_State::setParallelLoadingUsage(parallelLoadingIsActivated);
+		}
+		else
+		{
+			m_pRunner->begin("load_collada", SyntheticWorld::toVariantMap(parameters));
+			m_pRunner->fail("Unable to write " + fileName);
+		}
+	}
+}
+
+void Benchmarks::benchmark3dxmlLoading()
+{
+	for (int hierarchy= SyntheticWorld::Flat; hierarchy <= SyntheticWorld::Deep; ++hierarchy)
+	{
+		for (int sharing= SyntheticWorld::SharedReps; sharing <= SyntheticWorld::UniqueReps; ++sharing)
+		{
+			SyntheticWorld::Parameters parameters= worldParameters(static_cast<SyntheticWorld::Hierarchy>(hierarchy), static_cast<SyntheticWorld::RepSharing>(sharing));
+			parameters.m_InstanceCount= qMax(1, parameters.m_InstanceCount / 10);
+			const QString fileName(QDir(m_WorkDirectory).filePath(QString("world%1%2.3dxml").arg(hierarchy).arg(sharing)));
+			bool isWritten= false;
+			QString message;
+			try
+			{
+				isWritten= SyntheticWorld::write3dxml(fileName, parameters);
+			}
+			catch (GLC_Exception& e)
+			{
+				message= e.what();
+			}
+
+			if (isWritten)
+			{
+				measureLoading("load_3dxml", fileName, parameters);
+			}
+			else
+			{
+				m_pRunner->begin("load_3dxml", SyntheticWorld::toVariantMap(parameters));
+				m_pRunner->fail("Unable to write " + fileName + " " + message);
+			}
+		}
+	}
+}
+
+void Benchmarks::benchmark3dxmlExport()
+{
+	// Every part has its own 3DRep, as in a large assembly
+	SyntheticWorld::Parameters parameters= worldParameters(SyntheticWorld::Flat, SyntheticWorld::UniqueReps);
+	parameters.m_InstanceCount= qMax(1, parameters.m_InstanceCount / 10);
+	GLC_World world(SyntheticWorld::createWorld(parameters));
+	const QString fileName(QDir(m_WorkDirectory).filePath("export.3dxml"));
+	const bool parallelExportIsActivated= GLC_State::isParallelExportActivated();
+
+	for (int parallel= 0; parallel < 2; ++parallel)
+	{
+		QVariantMap variantParameters(SyntheticWorld::toVariantMap(parameters));
+		variantParameters.insert("parallel", parallel == 1);
+		GLC_State::setParallelExportUsage(parallel == 1);
+
+		m_pRunner->begin("export_3dxml", variantParameters);
+		try
+		{
+			for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+			{
+				QFile::remove(fileName);
+				GLC_WorldTo3dxml worldTo3dxml(world, false);
+				m_pRunner->start();
+				const bool isExported= worldTo3dxml.exportTo3dxml(fileName, GLC_WorldTo3dxml::Compressed3dxml);
+				m_pRunner->stop();
+				if (!isExported) throw GLC_Exception("Unable to write " + fileName);
+			}
+			m_pRunner->setCounter("bytes", QFileInfo(fileName).size());
+			m_pRunner->end();
+		}
+		catch (GLC_Exception& e)
+		{
+			m_pRunner->fail(e.what());
+		}
+	}
+	GLC_State::setParallelExportUsage(parallelExportIsActivated);
+}
+
+void Benchmarks::benchmarkBSRep()
+{
+	SyntheticWorld::Parameters parameters= SyntheticWorld::parameters(1, m_TriangleCount * 200);
+	GLC_Mesh* pMesh= SyntheticWorld::createMesh(parameters.m_TriangleCount, parameters.m_Seed);
+	pMesh->finish();
+	GLC_3DRep rep(pMesh);
+	const QString fileName(QDir(m_WorkDirectory).filePath("part." + GLC_BSRep::suffix()));
+
+	for (int compression= 0; compression < 2; ++compression)
+	{
+		QVariantMap variantParameters(SyntheticWorld::toVariantMap(parameters));
+		variantParameters.insert("compression", compression == 1);
+
+		try
+		{
+			m_pRunner->begin("bsrep_save", variantParameters);
+			for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+			{
+				QFile::remove(fileName);
+				GLC_BSRep bsRep(fileName, compression == 1);
+				m_pRunner->start();
+				const bool isSaved= bsRep.save(rep);
+				m_pRunner->stop();
+				if (!isSaved) throw GLC_Exception("Unable to save " + fileName);
+			}
+			m_pRunner->setCounter("bytes", QFileInfo(fileName).size());
+			m_pRunner->end();
+
+			m_pRunner->begin("bsrep_load", variantParameters);
+			unsigned int faceCount= 0;
+			for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+			{
+				GLC_BSRep bsRep(fileName);
+				m_pRunner->start();
+				GLC_3DRep loadedRep(bsRep.loadRep());
+				m_pRunner->stop();
+				faceCount= loadedRep.faceCount();
+			}
+			m_pRunner->setCounter("faces", faceCount);
+			m_pRunner->end();
+		}
+		catch (GLC_Exception& e)
+		{
+			m_pRunner->fail(e.what());
+		}
+	}
+}
+
+void Benchmarks::benchmarkMeshFinish()
+{
+	SyntheticWorld::Parameters parameters= SyntheticWorld::parameters(1, m_TriangleCount * 200);
+	m_pRunner->begin("mesh_finish", SyntheticWorld::toVariantMap(parameters));
+	for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+	{
+		GLC_Mesh* pMesh= SyntheticWorld::createMesh(parameters.m_TriangleCount, parameters.m_Seed);
+		m_pRunner->start();
+		pMesh->finish();
+		m_pRunner->stop();
+		delete pMesh;
+	}
+	m_pRunner->end();
+}
+
+void Benchmarks::benchmarkVertexCache()
+{
+	SyntheticWorld::Parameters parameters= SyntheticWorld::parameters(1, m_TriangleCount * 200);
+	m_pRunner->begin("vertex_cache", SyntheticWorld::toVariantMap(parameters));
+	double acmrBefore= 0.0;
+	double acmrAfter= 0.0;
+	for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+	{
+		GLC_Mesh* pMesh= SyntheticWorld::createMesh(parameters.m_TriangleCount, parameters.m_Seed);
+		m_pRunner->start();
+		pMesh->optimizeVertexCache(&acmrBefore, &acmrAfter);
+		m_pRunner->stop();
+		delete pMesh;
+	}
+	// Average cache miss ratio of the triangles
+	m_pRunner->setCounter("acmrBefore", acmrBefore);
+	m_pRunner->setCounter("acmrAfter", acmrAfter);
+	m_pRunner->end();
+}
+
+void Benchmarks::benchmarkOctree()
+{
+	for (int sharing= SyntheticWorld::SharedReps; sharing <= SyntheticWorld::UniqueReps; ++sharing)
+	{
+		SyntheticWorld::Parameters parameters= worldParameters(SyntheticWorld::Flat, static_cast<SyntheticWorld::RepSharing>(sharing));
+		GLC_World world(SyntheticWorld::createWorld(parameters));
+		GLC_3DViewCollection* pCollection= world.collection();
+		pCollection->bindSpacePartitioning(new GLC_Octree(pCollection));
+		pCollection->setSpacePartitionningUsage(true);
+
+		m_pRunner->begin("octree_build", SyntheticWorld::toVariantMap(parameters));
+		for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+		{
+			m_pRunner->start();
+			pCollection->updateSpacePartitionning();
+			m_pRunner->stop();
+		}
+		m_pRunner->end();
+
+		QVariantMap variantParameters(SyntheticWorld::toVariantMap(parameters));
+		variantParameters.insert("cameraSteps", BENCHMARK_CAMERA_STEPS);
+		m_pRunner->begin("octree_update_viewable", variantParameters);
+		for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+		{
+			m_pRunner->start();
+			for (int step= 0; step < BENCHMARK_CAMERA_STEPS; ++step)
+			{
+				GLC_Frustum frustum;
+				frustum.update(cameraMatrix(step, BENCHMARK_CAMERA_STEPS, parameters));
+				pCollection->updateInstanceViewableState(frustum);
+			}
+			m_pRunner->stop();
+		}
+		m_pRunner->setCounter("viewableInstances", pCollection->viewableInstancesHandle().size());
+		m_pRunner->end();
+
+		// A section view keeping half of the parts lattice
+		double upper[3];
+		SyntheticWorld::partPosition(parameters.m_InstanceCount - 1, parameters.m_InstanceCount, upper);
+		const QList<GLC_Plane> clipPlanes= QList<GLC_Plane>() << GLC_Plane(1.0, 0.0, 0.0, -upper[0] / 2.0);
+		m_pRunner->begin("octree_update_viewable_section", variantParameters);
+		for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+		{
+			m_pRunner->start();
+			for (int step= 0; step < BENCHMARK_CAMERA_STEPS; ++step)
+			{
+				GLC_Frustum frustum;
+				frustum.setClipPlanes(clipPlanes);
+				frustum.update(cameraMatrix(step, BENCHMARK_CAMERA_STEPS, parameters));
+				pCollection->updateInstanceViewableState(frustum);
+			}
+			m_pRunner->stop();
+		}
+		const QList<GLC_3DViewInstance*> instances(pCollection->viewableInstancesHandle());
+		const int instanceCount= instances.size();
+		int viewableCount= 0;
+		for (int i= 0; i < instanceCount; ++i)
+		{
+			if (instances.at(i)->viewableFlag() != GLC_3DViewInstance::NoViewable) ++viewableCount;
+		}
+		m_pRunner->setCounter("viewableInstances", viewableCount);
+		m_pRunner->end();
+	}
+}
+
+void Benchmarks::benchmarkOcclusion()
+{
+	SyntheticWorld::Parameters parameters= worldParameters(SyntheticWorld::Flat, SyntheticWorld::SharedReps);
+	GLC_World world(SyntheticWorld::createWorld(parameters));
+	GLC_3DViewCollection* pCollection= world.collection();
+	pCollection->bindSpacePartitioning(new GLC_Octree(pCollection));
+	pCollection->setSpacePartitionningUsage(true);
+	GLC_OcclusionCuller* pCuller= pCollection->occlusionCullerHandle();
+	pCuller->setViewportSize(1280, 720);
+
+	QVariantMap variantParameters(SyntheticWorld::toVariantMap(parameters));
+	variantParameters.insert("cameraSteps", BENCHMARK_CAMERA_STEPS);
+	variantParameters.insert("instructionSet", QString(GLC_OcclusionCuller::instructionSet()));
+	m_pRunner->begin("occlusion_cull", variantParameters);
+	int occludedCount= 0;
+	int testedCount= 0;
+	for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+	{
+		occludedCount= 0;
+		testedCount= 0;
+		for (int step= 0; step < BENCHMARK_CAMERA_STEPS; ++step)
+		{
+			// Only the occlusion culling is measured, one measure by camera step
+			const GLC_Matrix4x4 matrix(cameraMatrix(step, BENCHMARK_CAMERA_STEPS, parameters));
+			GLC_Frustum frustum;
+			frustum.update(matrix);
+			pCollection->updateInstanceViewableState(frustum);
+			QList<GLC_3DViewInstance*> instances(pCollection->viewableInstancesHandle());
+			for (int j= instances.size() - 1; j >= 0; --j)
+			{
+				if (instances.at(j)->viewableFlag() == GLC_3DViewInstance::NoViewable) instances.removeAt(j);
+			}
+
+			m_pRunner->start();
+			occludedCount+= pCuller->cull(instances, matrix);
+			m_pRunner->stop();
+			testedCount+= pCuller->testedInstanceCount();
+		}
+	}
+	m_pRunner->setCounter("testedInstances", testedCount);
+	m_pRunner->setCounter("occludedInstances", occludedCount);
+	m_pRunner->setCounter("occluders", pCuller->occluderCount());
+	m_pRunner->end();
+}
+
+void Benchmarks::benchmarkPicking()
+{
+	SyntheticWorld::Parameters parameters= worldParameters(SyntheticWorld::Flat, SyntheticWorld::SharedReps);
+	GLC_World world(SyntheticWorld::createWorld(parameters));
+	GLC_RayPicker picker(world.collection());
+
+	m_pRunner->begin("picking_update", SyntheticWorld::toVariantMap(parameters));
+	for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+	{
+		m_pRunner->start();
+		picker.update();
+		m_pRunner->stop();
+	}
+	m_pRunner->setCounter("instances", picker.instanceCount());
+	m_pRunner->end();
+
+	// Vertical rays on the parts lattice, the first measure builds the mesh hierarchies
+	double upper[3];
+	SyntheticWorld::partPosition(parameters.m_InstanceCount - 1, parameters.m_InstanceCount, upper);
+	const int side= static_cast<int>(ceil(pow(static_cast<double>(parameters.m_InstanceCount), 1.0 / 3.0)));
+	const double extent= static_cast<double>(side) * 2.0;
+
+	QVariantMap variantParameters(SyntheticWorld::toVariantMap(parameters));
+	variantParameters.insert("rays", BENCHMARK_RAY_COUNT);
+	m_pRunner->begin("picking_rays", variantParameters);
+	int hitCount= 0;
+	for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+	{
+		hitCount= 0;
+		quint32 state= 12345;
+		m_pRunner->start();
+		for (int ray= 0; ray < BENCHMARK_RAY_COUNT; ++ray)
+		{
+			state= state * 1664525u + 1013904223u;
+			const double x= static_cast<double>(state >> 8) / 16777216.0 * extent;
+			state= state * 1664525u + 1013904223u;
+			const double y= static_cast<double>(state >> 8) / 16777216.0 * extent;
+			const GLC_RayHit hit= picker.pick(GLC_Point3d(x, y, upper[2] + 10.0), GLC_Vector3d(0.0, 0.0, -1.0));
+			if (hit.isValid()) ++hitCount;
+		}
+		m_pRunner->stop();
+	}
+	m_pRunner->setCounter("hits", hitCount);
+	m_pRunner->setCounter("meshHierarchies", picker.meshBvhCount());
+	m_pRunner->end();
+}
+
+void Benchmarks::benchmarkSection()
+{
+	SyntheticWorld::Parameters parameters= worldParameters(SyntheticWorld::Flat, SyntheticWorld::SharedReps);
+	GLC_World world(SyntheticWorld::createWorld(parameters));
+	GLC_SectionEngine engine(world.collection());
+
+	// A plane sweeping the parts lattice along x as if dragged, the first measure builds the mesh hierarchies
+	double upper[3];
+	SyntheticWorld::partPosition(parameters.m_InstanceCount - 1, parameters.m_InstanceCount, upper);
+	QVariantMap variantParameters(SyntheticWorld::toVariantMap(parameters));
+	variantParameters.insert("planeSteps", BENCHMARK_CAMERA_STEPS);
+	m_pRunner->begin("section_compute", variantParameters);
+	int loopCount= 0;
+	int openChainCount= 0;
+	int segmentCount= 0;
+	for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+	{
+		loopCount= 0;
+		openChainCount= 0;
+		segmentCount= 0;
+		m_pRunner->start();
+		for (int step= 0; step < BENCHMARK_CAMERA_STEPS; ++step)
+		{
+			const double x= upper[0] * (static_cast<double>(step) + 0.5) / static_cast<double>(BENCHMARK_CAMERA_STEPS);
+			loopCount+= engine.compute(GLC_Plane(1.0, 0.0, 0.0, -x));
+			openChainCount+= engine.openChainCount();
+			segmentCount+= engine.segmentCount();
+		}
+		m_pRunner->stop();
+	}
+	m_pRunner->setCounter("loops", loopCount);
+	m_pRunner->setCounter("openChains", openChainCount);
+	m_pRunner->setCounter("segments", segmentCount);
+	m_pRunner->setCounter("meshHierarchies", engine.meshBvhCount());
+	m_pRunner->end();
+}
+
+void Benchmarks::benchmarkTraversal()
+{
+	for (int hierarchy= SyntheticWorld::Flat; hierarchy <= SyntheticWorld::Deep; ++hierarchy)
+	{
+		SyntheticWorld::Parameters parameters= worldParameters(static_cast<SyntheticWorld::Hierarchy>(hierarchy), SyntheticWorld::SharedReps);
+		GLC_World world(SyntheticWorld::createWorld(parameters));
+		GLC_StructOccurrence* pRoot= world.rootOccurrence();
+
+		m_pRunner->begin("traversal_occurrences", SyntheticWorld::toVariantMap(parameters));
+		int occurrenceCount= 0;
+		for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+		{
+			m_pRunner->start();
+			occurrenceCount= pRoot->subOccurrenceList().size();
+			m_pRunner->stop();
+		}
+		m_pRunner->setCounter("occurrences", occurrenceCount);
+		m_pRunner->end();
+
+		// The cached values of the whole tree are computed again
+		m_pRunner->begin("traversal_bounding_box", SyntheticWorld::toVariantMap(parameters));
+		unsigned int faceCount= 0;
+		for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+		{
+			const QList<GLC_StructOccurrence*> occurrences(pRoot->subOccurrenceList());
+			const int count= occurrences.size();
+			for (int iOcc= 0; iOcc < count; ++iOcc)
+			{
+				occurrences.at(iOcc)->invalidateBoundingBox();
+				occurrences.at(iOcc)->invalidateStatistics();
+			}
+			m_pRunner->start();
+			pRoot->boundingBox();
+			faceCount= pRoot->numberOfFaces();
+			m_pRunner->stop();
+		}
+		m_pRunner->setCounter("faces", faceCount);
+		m_pRunner->end();
+	}
+}
+
+void Benchmarks::measureLoading(const QString& name, const QString& fileName, const SyntheticWorld::Parameters& parameters, const QVariantMap& extraParameters)
+{
+	QVariantMap variantParameters(SyntheticWorld::toVariantMap(parameters));
+	variantParameters.unite(extraParameters);
+	variantParameters.insert("bytes", QFileInfo(fileName).size());
+	m_pRunner->begin(name, variantParameters);
+	try
+	{
+		int instanceCount= 0;
+		for (int i= 0; i < m_pRunner->repetitionCount(); ++i)
+		{
+			QFile file(fileName);
+			m_pRunner->start();
+			GLC_World world(GLC_Factory::instance()->createWorldFromFile(file));
+			m_pRunner->stop();
+			instanceCount= world.numberOfBody();
+		}
+		m_pRunner->setCounter("bodies", instanceCount);
+		m_pRunner->end();
+	}
+	catch (GLC_Exception& e)
+	{
+		m_pRunner->fail(e.what());
+	}
+}
+
+SyntheticWorld::Parameters Benchmarks::worldParameters(SyntheticWorld::Hierarchy hierarchy, SyntheticWorld::RepSharing sharing) const
+{
+	// Unique reps hold a mesh by part, their triangle count is reduced
+	const int triangleCount= (sharing == SyntheticWorld::UniqueReps) ? qMax(16, m_TriangleCount / 8) : m_TriangleCount;
+	return SyntheticWorld::parameters(m_InstanceCount, triangleCount, hierarchy, sharing);
+}
+
+GLC_Matrix4x4 Benchmarks::cameraMatrix(int step, int stepCount, const SyntheticWorld::Parameters& parameters)
+{
+	const int side= static_cast<int>(ceil(pow(static_cast<double>(parameters.m_InstanceCount), 1.0 / 3.0)));
+	const double extent= static_cast<double>(side) * 2.0;
+	const GLC_Point3d center(extent / 2.0, extent / 2.0, extent / 2.0);
+
+	// The camera turns around the lattice at half its size, the frustum sees a part of it
+	const double angle= 2.0 * M_PI * static_cast<double>(step) / static_cast<double>(stepCount);
+	const GLC_Point3d eye(center + GLC_Vector3d(cos(angle), sin(angle), 0.3) * (extent * 0.75));
+	const GLC_Camera camera(eye, center, GLC_Vector3d(0.0, 0.0, 1.0));
+
+	// Perspective projection of 35 degrees
+	const double nearDistance= 0.1;
+	const double farDistance= extent * 4.0;
+	const double top= nearDistance * tan(35.0 * M_PI / 360.0);
+	double projection[16]= {0.0};
+	projection[0]= nearDistance / top;
+	projection[5]= nearDistance / top;
+	projection[10]= -(farDistance + nearDistance) / (farDistance - nearDistance);
+	projection[11]= -1.0;
+	projection[14]= -2.0 * farDistance * nearDistance / (farDistance - nearDistance);
+
+	return GLC_Matrix4x4(projection) * camera.modelViewMatrix();
+}
@@ -0,0 +1,100 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#ifndef BENCHMARKS_H_
+#define BENCHMARKS_H_
+
+#include <QString>
+#include <QStringList>
+
+#include "syntheticworld.h"
+
+class BenchmarkRunner;
+class GLC_Matrix4x4;
+
+//! The benchmarks of the key paths of GLC_lib
+/*! All benchmarks run without OpenGL context. The model files are
+ *  written in the given work directory before being measured.
+ */
+class Benchmarks
+{
+public:
+	//! The size of the synthetic worlds
+	enum Scale
+	{
+		Small,
+		Medium,
+		Large
+	};
+
+public:
+	Benchmarks(BenchmarkRunner* pRunner, const QString& workDirectory, Scale scale);
+
+public:
+	//! Return the names of the benchmarks
+	static QStringList names();
+
+	//! Return the scale of the given name, medium if unknown
+	static Scale scaleFromName(const QString& name);
+
+	//! Run the selected benchmarks
+	void run();
+
+private:
+	void benchmarkStlLoading();
+	void benchmarkObjLoading();
+	void benchmarkColladaLoading();
+	void benchmark3dxmlLoading();
+	void benchmark3dxmlExport();
+	void benchmarkBSRep();
+	void benchmarkMeshFinish();
+	void benchmarkVertexCache();
+	void benchmarkOctree();
+	void benchmarkOcclusion();
+	void benchmarkPicking();
+	void benchmarkSection();
+	void benchmarkTraversal();
+
+	//! Measure the loading of the given file, the given extra parameters are added to the record
+	void measureLoading(const QString& name, const QString& fileName, const SyntheticWorld::Parameters& parameters, const QVariantMap& extraParameters= QVariantMap());
+
+	//! Return the parameters of the synthetic world of the current scale
+	SyntheticWorld::Parameters worldParameters(SyntheticWorld::Hierarchy hierarchy, SyntheticWorld::RepSharing sharing) const;
+
+	//! Return the projection and view matrix of the given camera step turning around the given world
+	static GLC_Matrix4x4 cameraMatrix(int step, int stepCount, const SyntheticWorld::Parameters& parameters);
+
+private:
+	//! The result collector
+	BenchmarkRunner* m_pRunner;
+
+	//! The directory of the generated files
+	QString m_WorkDirectory;
+
+	//! The number of parts
+	int m_InstanceCount;
+
+	//! The number of triangles of a part
+	int m_TriangleCount;
+};
+
+#endif /* BENCHMARKS_H_ */
@@ -0,0 +1,22 @@
+TARGET = glc_benchmarks
+TEMPLATE = app
+QT += opengl
+CONFIG += console warn_on
+CONFIG -= app_bundle
+
+OBJECTS_DIR = ./Build
+MOC_DIR = ./Build
+UI_DIR = ./Build
+RCC_DIR = ./Build
+
+include(../../../glc_lib.pri)
+
+
+# Input
+HEADERS += syntheticworld.h benchmarkrunner.h benchmarks.h
+SOURCES += syntheticworld.cpp benchmarkrunner.cpp benchmarks.cpp main.cpp
+
+include(../../../install.pri)
+
+target.path = $${GLC_LIB_DIR}/benchmarks
+INSTALLS += target
@@ -0,0 +1,109 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+#include <QSysInfo>
+#include <QThread>
+
+#include <GLC_Global>
+
+#include "benchmarks.h"
+#include "benchmarkrunner.h"
+
+int main(int argc, char **argv)
+{
+	// No window and no OpenGL context : the benchmarks run headless
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("glc_benchmarks");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Time the key paths of GLC_lib on deterministic synthetic worlds");
+	parser.addHelpOption();
+	QCommandLineOption scaleOption("scale", "Size of the synthetic worlds : small, medium or large.", "scale", "medium");
+	QCommandLineOption repeatOption("repeat", "Number of measures by benchmark.", "count", "5");
+	QCommandLineOption filterOption("filter", "Run only the benchmarks whose name contains the given text, can be repeated.", "text");
+	QCommandLineOption outputOption("output", "Write the JSON results in the given file instead of the standard output.", "file");
+	QCommandLineOption workOption("work-dir", "Directory of the generated model files, a temporary directory by default.", "directory");
+	QCommandLineOption listOption("list", "List the benchmark names and exit.");
+	parser.addOption(scaleOption);
+	parser.addOption(repeatOption);
+	parser.addOption(filterOption);
+	parser.addOption(outputOption);
+	parser.addOption(workOption);
+	parser.addOption(listOption);
+	parser.process(app);
+
+	if (parser.isSet(listOption))
+	{
+		QTextStream(stdout) << Benchmarks::names().join("\n") << endl;
+		return 0;
+	}
+
+	QTemporaryDir temporaryDirectory;
+	QString workDirectory(parser.value(workOption));
+	if (workDirectory.isEmpty())
+	{
+		if (!temporaryDirectory.isValid())
+		{
+			QTextStream(stderr) << "Unable to create a temporary directory" << endl;
+			return 2;
+		}
+		workDirectory= temporaryDirectory.path();
+	}
+
+	BenchmarkRunner runner;
+	runner.setRepetitionCount(parser.value(repeatOption).toInt());
+	runner.setFilters(parser.values(filterOption));
+	runner.setContext("scale", parser.value(scaleOption));
+	runner.setContext("repetitions", runner.repetitionCount());
+	runner.setContext("glcVersion", glc::version);
+	runner.setContext("qtVersion", QString(qVersion()));
+	runner.setContext("cpu", QSysInfo::currentCpuArchitecture());
+	runner.setContext("os", QSysInfo::prettyProductName());
+	runner.setContext("threads", QThread::idealThreadCount());
+	runner.setContext("date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+
+	Benchmarks benchmarks(&runner, workDirectory, Benchmarks::scaleFromName(parser.value(scaleOption)));
+	benchmarks.run();
+
+	const QByteArray results(runner.toJson());
+	if (parser.isSet(outputOption))
+	{
+		QFile file(parser.value(outputOption));
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || (file.write(results) != results.size()))
+		{
+			QTextStream(stderr) << "Unable to write " << file.fileName() << endl;
+			return 2;
+		}
+	}
+	else
+	{
+		QTextStream(stdout) << results;
+	}
+
+	return (runner.failureCount() > 0) ? 1 : 0;
+}
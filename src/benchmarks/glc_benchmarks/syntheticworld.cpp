@@ -0,0 +1,373 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#include <QFile>
+#include <QTextStream>
+#include <QDataStream>
+#include <QColor>
+#include <qmath.h>
+
+#include <GLC_Mesh>
+#include <GLC_Material>
+#include <GLC_3DRep>
+#include <GLC_StructOccurrence>
+#include <GLC_StructInstance>
+#include <GLC_StructReference>
+#include <GLC_WorldTo3dxml>
+
+#include "syntheticworld.h"
+
+// The distance between two parts
+#define SYNTHETIC_PART_SPACING 2.0
+
+SyntheticWorld::Parameters SyntheticWorld::parameters(int instanceCount, int triangleCount, Hierarchy hierarchy, RepSharing sharing, quint32 seed)
+{
+	Parameters subject;
+	subject.m_InstanceCount= instanceCount;
+	subject.m_TriangleCount= triangleCount;
+	subject.m_Hierarchy= hierarchy;
+	subject.m_RepSharing= sharing;
+	subject.m_Seed= seed;
+	return subject;
+}
+
+QVariantMap SyntheticWorld::toVariantMap(const Parameters& parameters)
+{
+	QVariantMap subject;
+	subject.insert("instances", parameters.m_InstanceCount);
+	subject.insert("triangles", parameters.m_TriangleCount);
+	subject.insert("hierarchy", QString(parameters.m_Hierarchy == Flat ? "flat" : "deep"));
+	subject.insert("reps", QString(parameters.m_RepSharing == SharedReps ? "shared" : "unique"));
+	subject.insert("seed", parameters.m_Seed);
+	return subject;
+}
+
+GLC_Mesh* SyntheticWorld::createMesh(int triangleCount, quint32 seed)
+{
+	QVector<float> positions;
+	QVector<float> normals;
+	QVector<int> indexes;
+	grid(triangleCount, seed, &positions, &normals, &indexes);
+
+	GLC_Mesh* pMesh= new GLC_Mesh();
+	pMesh->addVertice(positions);
+	pMesh->addNormals(normals);
+
+	IndexList indexList;
+	const int indexCount= indexes.size();
+	for (int i= 0; i < indexCount; ++i)
+	{
+		indexList.append(static_cast<GLuint>(indexes.at(i)));
+	}
+
+	quint32 state= seed;
+	const QColor color(QColor::fromRgbF(nextRandom(&state), nextRandom(&state), nextRandom(&state)));
+	pMesh->addTriangles(new GLC_Material(color), indexList);
+
+	return pMesh;
+}
+
+GLC_World SyntheticWorld::createWorld(const Parameters& parameters)
+{
+	GLC_World world;
+
+	GLC_StructReference* pSharedReference= NULL;
+	if (parameters.m_RepSharing == SharedReps)
+	{
+		GLC_Mesh* pMesh= createMesh(parameters.m_TriangleCount, parameters.m_Seed);
+		pMesh->finish();
+		pSharedReference= new GLC_StructReference(new GLC_3DRep(pMesh));
+		pSharedReference->setName("Part");
+	}
+
+	addParts(world.rootOccurrence(), 0, parameters.m_InstanceCount, parameters, pSharedReference);
+
+	return world;
+}
+
+void SyntheticWorld::partPosition(int index, int instanceCount, double* pPosition)
+{
+	// The parts are on a cubic lattice
+	int side= static_cast<int>(ceil(pow(static_cast<double>(instanceCount), 1.0 / 3.0)));
+	if (side < 1) side= 1;
+	pPosition[0]= static_cast<double>(index % side) * SYNTHETIC_PART_SPACING;
+	pPosition[1]= static_cast<double>((index / side) % side) * SYNTHETIC_PART_SPACING;
+	pPosition[2]= static_cast<double>(index / (side * side)) * SYNTHETIC_PART_SPACING;
+}
+
+bool SyntheticWorld::writeStl(const QString& fileName, const Parameters& parameters)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+	QVector<float> positions;
+	QVector<float> normals;
+	QVector<int> indexes;
+	grid(parameters.m_TriangleCount, parameters.m_Seed, &positions, &normals, &indexes);
+
+	QDataStream stream(&file);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+	// 80 bytes header
+	QByteArray header("GLC_lib synthetic benchmark part");
+	header.resize(80);
+	stream.writeRawData(header.constData(), header.size());
+
+	const int triangleCount= indexes.size() / 3;
+	stream << static_cast<quint32>(triangleCount);
+	for (int i= 0; i < triangleCount; ++i)
+	{
+		stream << 0.0f << 0.0f << 1.0f;
+		for (int j= 0; j < 3; ++j)
+		{
+			const int index= indexes.at(i * 3 + j);
+			stream << positions.at(index * 3) << positions.at(index * 3 + 1) << positions.at(index * 3 + 2);
+		}
+		stream << static_cast<quint16>(0);
+	}
+
+	return stream.status() == QDataStream::Ok;
+}
+
+bool SyntheticWorld::writeObj(const QString& fileName, const Parameters& parameters)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+	QTextStream stream(&file);
+
+	QVector<float> positions;
+	QVector<float> normals;
+	QVector<int> indexes;
+	int vertexOffset= 1;
+	for (int part= 0; part < parameters.m_InstanceCount; ++part)
+	{
+		if ((0 == part) || (parameters.m_RepSharing == UniqueReps))
+		{
+			grid(parameters.m_TriangleCount, parameters.m_Seed + static_cast<quint32>(part), &positions, &normals, &indexes);
+		}
+
+		// OBJ has no instancing, the vertices of each part are written
+		double position[3];
+		partPosition(part, parameters.m_InstanceCount, position);
+
+		stream << "o Part_" << part << "\n";
+		const int vertexCount= positions.size() / 3;
+		for (int i= 0; i < vertexCount; ++i)
+		{
+			stream << "v " << positions.at(i * 3) + position[0] << ' ' << positions.at(i * 3 + 1) + position[1] << ' ' << positions.at(i * 3 + 2) + position[2] << "\n";
+		}
+		for (int i= 0; i < vertexCount; ++i)
+		{
+			stream << "vn " << normals.at(i * 3) << ' ' << normals.at(i * 3 + 1) << ' ' << normals.at(i * 3 + 2) << "\n";
+		}
+		const int triangleCount= indexes.size() / 3;
+		for (int i= 0; i < triangleCount; ++i)
+		{
+			stream << 'f';
+			for (int j= 0; j < 3; ++j)
+			{
+				const int index= indexes.at(i * 3 + j) + vertexOffset;
+				stream << ' ' << index << "//" << index;
+			}
+			stream << "\n";
+		}
+		vertexOffset+= vertexCount;
+	}
+
+	stream.flush();
+	return stream.status() == QTextStream::Ok;
+}
+
+bool SyntheticWorld::writeCollada(const QString& fileName, const Parameters& parameters)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+	QTextStream stream(&file);
+
+	stream << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+	stream << "<COLLADA xmlns=\"http://www.collada.org/2005/11/COLLADASchema\" version=\"1.4.1\">\n";
+	stream << "<asset><unit meter=\"1\" name=\"meter\"/><up_axis>Z_UP</up_axis></asset>\n";
+	stream << "<library_effects><effect id=\"partEffect\"><profile_COMMON><technique sid=\"common\"><lambert>";
+	stream << "<diffuse><color>0.6 0.6 0.7 1</color></diffuse>";
+	stream << "</lambert></technique></profile_COMMON></effect></library_effects>\n";
+	stream << "<library_materials><material id=\"partMaterial\"><instance_effect url=\"#partEffect\"/></material></library_materials>\n";
+
+	// The geometries
+	const int geometryCount= (parameters.m_RepSharing == SharedReps) ? 1 : parameters.m_InstanceCount;
+	stream << "<library_geometries>\n";
+	QVector<float> positions;
+	QVector<float> normals;
+	QVector<int> indexes;
+	for (int geometry= 0; geometry < geometryCount; ++geometry)
+	{
+		grid(parameters.m_TriangleCount, parameters.m_Seed + static_cast<quint32>(geometry), &positions, &normals, &indexes);
+		const QString id(QString("part%1").arg(geometry));
+		stream << "<geometry id=\"" << id << "\"><mesh>\n";
+
+		stream << "<source id=\"" << id << "-positions\"><float_array id=\"" << id << "-positions-array\" count=\"" << positions.size() << "\">";
+		for (int i= 0; i < positions.size(); ++i)
+		{
+			stream << positions.at(i) << ' ';
+		}
+		stream << "</float_array><technique_common><accessor source=\"#" << id << "-positions-array\" count=\"" << positions.size() / 3 << "\" stride=\"3\">";
+		stream << "<param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/><param name=\"Z\" type=\"float\"/></accessor></technique_common></source>\n";
+
+		stream << "<source id=\"" << id << "-normals\"><float_array id=\"" << id << "-normals-array\" count=\"" << normals.size() << "\">";
+		for (int i= 0; i < normals.size(); ++i)
+		{
+			stream << normals.at(i) << ' ';
+		}
+		stream << "</float_array><technique_common><accessor source=\"#" << id << "-normals-array\" count=\"" << normals.size() / 3 << "\" stride=\"3\">";
+		stream << "<param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/><param name=\"Z\" type=\"float\"/></accessor></technique_common></source>\n";
+
+		stream << "<vertices id=\"" << id << "-vertices\"><input semantic=\"POSITION\" source=\"#" << id << "-positions\"/></vertices>\n";
+		stream << "<triangles material=\"partSymbol\" count=\"" << indexes.size() / 3 << "\">";
+		stream << "<input semantic=\"VERTEX\" source=\"#" << id << "-vertices\" offset=\"0\"/>";
+		stream << "<input semantic=\"NORMAL\" source=\"#" << id << "-normals\" offset=\"1\"/><p>";
+		for (int i= 0; i < indexes.size(); ++i)
+		{
+			stream << indexes.at(i) << ' ' << indexes.at(i) << ' ';
+		}
+		stream << "</p></triangles>\n</mesh></geometry>\n";
+	}
+	stream << "</library_geometries>\n";
+
+	// The parts, COLLADA nodes are written flat
+	stream << "<library_visual_scenes><visual_scene id=\"scene\">\n";
+	for (int part= 0; part < parameters.m_InstanceCount; ++part)
+	{
+		double position[3];
+		partPosition(part, parameters.m_InstanceCount, position);
+		const int geometry= (parameters.m_RepSharing == SharedReps) ? 0 : part;
+		stream << "<node id=\"node" << part << "\" name=\"Part_" << part << "\">";
+		stream << "<translate>" << position[0] << ' ' << position[1] << ' ' << position[2] << "</translate>";
+		stream << "<instance_geometry url=\"#part" << geometry << "\"><bind_material><technique_common>";
+		stream << "<instance_material symbol=\"partSymbol\" target=\"#partMaterial\"/>";
+		stream << "</technique_common></bind_material></instance_geometry></node>\n";
+	}
+	stream << "</visual_scene></library_visual_scenes>\n";
+	stream << "<scene><instance_visual_scene url=\"#scene\"/></scene>\n";
+	stream << "</COLLADA>\n";
+
+	stream.flush();
+	return stream.status() == QTextStream::Ok;
+}
+
+bool SyntheticWorld::write3dxml(const QString& fileName, const Parameters& parameters)
+{
+	GLC_World world(createWorld(parameters));
+	GLC_WorldTo3dxml worldTo3dxml(world, false);
+	return worldTo3dxml.exportTo3dxml(fileName, GLC_WorldTo3dxml::Compressed3dxml);
+}
+
+double SyntheticWorld::nextRandom(quint32* pState)
+{
+	// Numerical Recipes linear congruential generator
+	*pState= (*pState) * 1664525u + 1013904223u;
+	return static_cast<double>((*pState) >> 8) / 16777216.0;
+}
+
+void SyntheticWorld::grid(int triangleCount, quint32 seed, QVector<float>* pPositions, QVector<float>* pNormals, QVector<int>* pIndexes)
+{
+	pPositions->clear();
+	pNormals->clear();
+	pIndexes->clear();
+	if (triangleCount < 1) triangleCount= 1;
+
+	// A grid of n x n cells has 2 n n triangles
+	int cells= static_cast<int>(ceil(sqrt(static_cast<double>(triangleCount) / 2.0)));
+	if (cells < 1) cells= 1;
+	const int side= cells + 1;
+	const float step= 1.0f / static_cast<float>(cells);
+
+	quint32 state= seed * 2654435761u + 1u;
+	for (int j= 0; j < side; ++j)
+	{
+		for (int i= 0; i < side; ++i)
+		{
+			pPositions->append(static_cast<float>(i) * step);
+			pPositions->append(static_cast<float>(j) * step);
+			pPositions->append(static_cast<float>(nextRandom(&state) * 0.1));
+			pNormals->append(0.0f);
+			pNormals->append(0.0f);
+			pNormals->append(1.0f);
+		}
+	}
+
+	int count= 0;
+	for (int j= 0; (j < cells) && (count < triangleCount); ++j)
+	{
+		for (int i= 0; (i < cells) && (count < triangleCount); ++i)
+		{
+			const int first= j * side + i;
+			pIndexes->append(first);
+			pIndexes->append(first + 1);
+			pIndexes->append(first + side + 1);
+			++count;
+			if (count < triangleCount)
+			{
+				pIndexes->append(first);
+				pIndexes->append(first + side + 1);
+				pIndexes->append(first + side);
+				++count;
+			}
+		}
+	}
+}
+
+void SyntheticWorld::addParts(GLC_StructOccurrence* pParent, int first, int last, const Parameters& parameters, GLC_StructReference* pSharedReference)
+{
+	if ((parameters.m_Hierarchy == Deep) && ((last - first) > 1))
+	{
+		// Binary tree of assemblies, the parts are the leaves
+		const int middle= first + (last - first) / 2;
+		GLC_StructOccurrence* pFirstHalf= pParent->addChild(new GLC_StructInstance(new GLC_StructReference("Assembly")));
+		addParts(pFirstHalf, first, middle, parameters, pSharedReference);
+		GLC_StructOccurrence* pSecondHalf= pParent->addChild(new GLC_StructInstance(new GLC_StructReference("Assembly")));
+		addParts(pSecondHalf, middle, last, parameters, pSharedReference);
+		return;
+	}
+
+	for (int part= first; part < last; ++part)
+	{
+		GLC_StructInstance* pInstance= NULL;
+		if (NULL != pSharedReference)
+		{
+			pInstance= new GLC_StructInstance(pSharedReference);
+		}
+		else
+		{
+			GLC_Mesh* pMesh= createMesh(parameters.m_TriangleCount, parameters.m_Seed + static_cast<quint32>(part));
+			pMesh->finish();
+			GLC_StructReference* pReference= new GLC_StructReference(new GLC_3DRep(pMesh));
+			pReference->setName(QString("Part_%1").arg(part));
+			pInstance= new GLC_StructInstance(pReference);
+		}
+		pInstance->setName(QString("Part_%1").arg(part));
+
+		double position[3];
+		partPosition(part, parameters.m_InstanceCount, position);
+		pInstance->translate(position[0], position[1], position[2]);
+		pParent->addChild(pInstance);
+	}
+}
@@ -0,0 +1,120 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+#ifndef SYNTHETICWORLD_H_
+#define SYNTHETICWORLD_H_
+
+#include <QString>
+#include <QVector>
+#include <QVariantMap>
+
+#include <GLC_World>
+
+class GLC_Mesh;
+class GLC_StructOccurrence;
+class GLC_StructReference;
+
+//! Generate deterministic worlds and model files for the benchmarks
+/*! The same parameters always give the same geometry : the random numbers
+ *  come from a linear congruential generator seeded by the parameters,
+ *  not from qrand().
+ */
+class SyntheticWorld
+{
+public:
+	//! The occurrence tree shape
+	enum Hierarchy
+	{
+		//! All parts are children of the root
+		Flat,
+		//! The parts are the leaves of a binary tree of assemblies
+		Deep
+	};
+
+	//! The representation sharing
+	enum RepSharing
+	{
+		//! All parts instantiate the same reference
+		SharedReps,
+		//! Each part has its own reference and mesh
+		UniqueReps
+	};
+
+	//! The parameters of a synthetic world
+	struct Parameters
+	{
+		//! The number of parts
+		int m_InstanceCount;
+
+		//! The number of triangles of a part mesh
+		int m_TriangleCount;
+
+		//! The occurrence tree shape
+		Hierarchy m_Hierarchy;
+
+		//! The representation sharing
+		RepSharing m_RepSharing;
+
+		//! The random seed
+		quint32 m_Seed;
+	};
+
+public:
+	//! Return parameters with the given values
+	static Parameters parameters(int instanceCount, int triangleCount, Hierarchy hierarchy= Flat, RepSharing sharing= SharedReps, quint32 seed= 1);
+
+	//! Return the given parameters as a variant map for the results
+	static QVariantMap toVariantMap(const Parameters& parameters);
+
+	//! Create an unfinished mesh with the given number of triangles
+	static GLC_Mesh* createMesh(int triangleCount, quint32 seed);
+
+	//! Create the world of the given parameters
+	static GLC_World createWorld(const Parameters& parameters);
+
+	//! Return the position of the part of the given index
+	static void partPosition(int index, int instanceCount, double* pPosition);
+
+	//! Write the part mesh of the given parameters in a binary STL file
+	static bool writeStl(const QString& fileName, const Parameters& parameters);
+
+	//! Write the world of the given parameters in an OBJ file
+	static bool writeObj(const QString& fileName, const Parameters& parameters);
+
+	//! Write the world of the given parameters in a COLLADA file
+	static bool writeCollada(const QString& fileName, const Parameters& parameters);
+
+	//! Write the world of the given parameters in a compressed 3DXML file
+	static bool write3dxml(const QString& fileName, const Parameters& parameters);
+
+private:
+	//! Return the next random number in [0, 1) of the given generator state
+	static double nextRandom(quint32* pState);
+
+	//! Compute the vertices and triangles of a bumpy grid with the given number of triangles
+	static void grid(int triangleCount, quint32 seed, QVector<float>* pPositions, QVector<float>* pNormals, QVector<int>* pIndexes);
+
+	//! Add the parts of the given index range under the given occurrence
+	static void addParts(GLC_StructOccurrence* pParent, int first, int last, const Parameters& parameters, GLC_StructReference* pSharedReference);
+};
+
+#endif /* SYNTHETICWORLD_H_ */
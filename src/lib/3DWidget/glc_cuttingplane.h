@@ -25,6 +25,7 @@
 #define GLC_CUTTINGPLANE_H_
 
 #include "glc_3dwidget.h"
+#include "../maths/glc_plane.h"
 #include "../glc_config.h"
 
 class GLC_AbstractManipulator;
@@ -70,6 +71,11 @@ public:
 	inline GLC_Vector3d normal() const
 	{return m_Normal;}
 
+	//! Return the plane of this cutting plane, its positive half space is on the normal side
+	/*! Give it to GLC_SectionEngine::compute() when asChanged() is emitted to follow the moves*/
+	inline GLC_Plane plane() const
+	{return GLC_Plane(m_Normal, m_Center);}
+
 	//! Return this plane color
 	inline QColor color() const
 	{return m_Color;}
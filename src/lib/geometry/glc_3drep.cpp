@@ -284,17 +284,7 @@ bool GLC_3DRep::load()
 		else
 		{
 			GLC_3DRep newRep= GLC_Factory::instance()->create3DRepFromFile(fileName());
-			if (!newRep.isEmpty())
-			{
-				const int size= newRep.m_pGeomList->size();
-				for (int i= 0; i < size; ++i)
-				{
-					m_pGeomList->append(newRep.m_pGeomList->at(i));
-				}
-				newRep.m_pGeomList->clear();
-				(*m_pIsLoaded)= true;
-				loadSucces= true;
-			}
+			loadSucces= load(&newRep);
 		}
 	}
 
@@ -302,6 +292,26 @@ bool GLC_3DRep::load()
 
 }
 
+bool GLC_3DRep::load(GLC_3DRep* pLoadedRep)
+{
+	bool loadSucces= false;
+
+	if(!(*m_pIsLoaded) && !pLoadedRep->isEmpty())
+	{
+		Q_ASSERT(m_pGeomList->isEmpty());
+		const int size= pLoadedRep->m_pGeomList->size();
+		for (int i= 0; i < size; ++i)
+		{
+			m_pGeomList->append(pLoadedRep->m_pGeomList->at(i));
+		}
+		pLoadedRep->m_pGeomList->clear();
+		(*m_pIsLoaded)= true;
+		loadSucces= true;
+	}
+
+	return loadSucces;
+}
+
 void GLC_3DRep::replace(GLC_Rep* pRep)
 {
 	GLC_3DRep* p3DRep= dynamic_cast<GLC_3DRep*>(pRep);
@@ -437,31 +447,21 @@ bool GLC_3DRep::unload()
 }
 
 //////////////////////////////////////////////////////////////////////
-// private services functions
+// Binary serialisation Functions
 //////////////////////////////////////////////////////////////////////
 
-void GLC_3DRep::clear3DRepGeom()
-{
-    const int size= m_pGeomList->size();
-    for (int i= 0; i < size; ++i)
-    {
-        delete (*m_pGeomList)[i];
-    }
-    m_pGeomList->clear();
-}
-
-// Non Member methods
-QDataStream &operator<<(QDataStream & stream, const GLC_3DRep & rep)
+// Save the representation to the given stream
+void GLC_3DRep::saveToDataStream(QDataStream& stream, QList<QByteArray>* pBlocks) const
 {
 	quint32 chunckId= GLC_3DRep::m_ChunkId;
 	stream << chunckId;
 
 	// The representation name
-	stream << rep.name();
+	stream << name();
 
 	// Save the list of 3DRep materials
 	QList<GLC_Material> materialsList;
-	QList<GLC_Material*> sourceMaterialsList= rep.materialSet().toList();
+	QList<GLC_Material*> sourceMaterialsList= materialSet().toList();
 	const int materialNumber= sourceMaterialsList.size();
 	for (int i= 0; i < materialNumber; ++i)
 	{
@@ -472,23 +472,22 @@ QDataStream &operator<<(QDataStream & stream, const GLC_3DRep & rep)
 	stream << materialsList;
 
 	// Save the list of mesh
-	const int meshNumber= rep.m_pGeomList->size();
+	const int meshNumber= m_pGeomList->size();
 	stream << meshNumber;
 	for (int i= 0; i < meshNumber; ++i)
 	{
-		GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(rep.m_pGeomList->at(i));
+		GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(m_pGeomList->at(i));
 		if (NULL != pMesh)
 		{
-			pMesh->saveToDataStream(stream);
+			pMesh->saveToDataStream(stream, pBlocks);
 		}
 	}
-
-	return stream;
 }
 
-QDataStream &operator>>(QDataStream & stream, GLC_3DRep & rep)
+// Load the empty representation from the given stream
+void GLC_3DRep::loadFromDataStream(QDataStream& stream, const QList<QByteArray>* pBlocks)
 {
-	Q_ASSERT(rep.isEmpty());
+	Q_ASSERT(isEmpty());
 
 	quint32 chunckId;
 	stream >> chunckId;
@@ -497,7 +496,7 @@ QDataStream &operator>>(QDataStream & stream, GLC_3DRep & rep)
 	// The rep name
 	QString name;
 	stream >> name;
-	rep.setName(name);
+	setName(name);
 
 	// Retrieve the list of rep materials
 	QList<GLC_Material> materialsList;
@@ -519,10 +518,37 @@ QDataStream &operator>>(QDataStream & stream, GLC_3DRep & rep)
 	for (int i= 0; i < meshNumber; ++i)
 	{
 		GLC_Mesh* pMesh= new GLC_Mesh();
-		pMesh->loadFromDataStream(stream, materialHash, materialIdMap);
+		pMesh->loadFromDataStream(stream, materialHash, materialIdMap, pBlocks);
 
-		rep.addGeom(pMesh);
+		addGeom(pMesh);
 	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// private services functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_3DRep::clear3DRepGeom()
+{
+    const int size= m_pGeomList->size();
+    for (int i= 0; i < size; ++i)
+    {
+        delete (*m_pGeomList)[i];
+    }
+    m_pGeomList->clear();
+}
+
+// Non Member methods
+QDataStream &operator<<(QDataStream & stream, const GLC_3DRep & rep)
+{
+	rep.saveToDataStream(stream);
+
+	return stream;
+}
+
+QDataStream &operator>>(QDataStream & stream, GLC_3DRep & rep)
+{
+	rep.loadFromDataStream(stream);
 
 	return stream;
 }
@@ -150,6 +150,10 @@ public:
 	//! Load the representation and return true if success
 	virtual bool load();
 
+	//! Load the representation from the given representation loaded elsewhere and return true if success
+	/*! The geometries of the given representation are taken, used to load a representation on a worker thread*/
+	bool load(GLC_3DRep* pLoadedRep);
+
 	//! UnLoad the representation and return true if success
 	virtual bool unload();
 
@@ -179,6 +183,22 @@ public:
 
 //@}
 
+//////////////////////////////////////////////////////////////////////
+/*! \name Binary serialisation Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Save the representation to the given stream
+	/*! If pBlocks is not NULL, vertex attributes and LODs index are appended to it
+	 *  instead of being written in the stream*/
+	void saveToDataStream(QDataStream& stream, QList<QByteArray>* pBlocks= NULL) const;
+
+	//! Load the empty representation from the given stream
+	/*! pBlocks must be the blocks given on save if it was not NULL*/
+	void loadFromDataStream(QDataStream& stream, const QList<QByteArray>* pBlocks= NULL);
+
+//@}
+
 //////////////////////////////////////////////////////////////////////
 // private services functions
 //////////////////////////////////////////////////////////////////////
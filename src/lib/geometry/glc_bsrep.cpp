@@ -25,6 +25,10 @@
 #include "../glc_fileformatexception.h"
 #include "../glc_tracelog.h"
 
+#include <QBuffer>
+#include <QtEndian>
+#include <QtConcurrent>
+
 // The binary rep suffix
 const QString GLC_BSRep::m_Suffix("BSRep");
 
@@ -32,14 +36,57 @@ const QString GLC_BSRep::m_Suffix("BSRep");
 const QUuid GLC_BSRep::m_Uuid("{d6f97789-36a9-4c2e-b667-0e66c27f839f}");
 
 // The binary rep version
-const quint32 GLC_BSRep::m_Version= 103;
+const quint32 GLC_BSRep::m_Version= 200;
+
+// The first version with a flat body
+static const quint32 flatBodyVersion= 200;
+
+// Alignment of the flat body and of its blocks
+static const qint64 blockAlignment= 16;
+
+// Size of a block table entry : offset, stored size, size, compression and reserved
+static const qint64 blockEntrySize= 32;
+
+// Block compressions
+static const quint32 noCompression= 0;
+static const quint32 zlibCompression= 1;
+
+// Return the given offset aligned on blocks alignment
+static inline qint64 alignedOffset(qint64 offset)
+{
+	return (offset + blockAlignment - 1) & ~(blockAlignment - 1);
+}
+
+// Return the little endian block of the given 32 bits values
+template <typename T>
+static QByteArray blockOfValues(const QVector<T>& vector)
+{
+	QByteArray block(reinterpret_cast<const char*>(vector.constData()), vector.size() * static_cast<int>(sizeof(T)));
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+	quint32* pValues= reinterpret_cast<quint32*>(block.data());
+	const int size= vector.size();
+	for (int i= 0; i < size; ++i) pValues[i]= qbswap(pValues[i]);
+#endif
+	return block;
+}
 
-// Mutex used by compression
-QMutex GLC_BSRep::m_CompressionMutex;
+// Set the given vector of 32 bits values from the given little endian block
+template <typename T>
+static void valuesOfBlock(const QByteArray& block, QVector<T>* pVector)
+{
+	const int size= block.size() / static_cast<int>(sizeof(T));
+	pVector->resize(size);
+	memcpy(pVector->data(), block.constData(), size * sizeof(T));
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+	quint32* pValues= reinterpret_cast<quint32*>(pVector->data());
+	for (int i= 0; i < size; ++i) pValues[i]= qbswap(pValues[i]);
+#endif
+}
 
 // Default constructor
 GLC_BSRep::GLC_BSRep(const QString& fileName, bool useCompression)
 : m_FileInfo()
+, m_FileVersion(0)
 , m_pFile(NULL)
 , m_DataStream()
 , m_UseCompression(useCompression)
@@ -53,6 +100,7 @@ GLC_BSRep::GLC_BSRep(const QString& fileName, bool useCompression)
 // Copy constructor
 GLC_BSRep::GLC_BSRep(const GLC_BSRep& binaryRep)
 : m_FileInfo(binaryRep.m_FileInfo)
+, m_FileVersion(0)
 , m_pFile(NULL)
 , m_DataStream()
 , m_UseCompression(binaryRep.m_UseCompression)
@@ -111,22 +159,35 @@ GLC_3DRep GLC_BSRep::loadRep(QFile *pFile)
 			timeStampOk(QDateTime());
 			GLC_BoundingBox boundingBox;
 			m_DataStream >> boundingBox;
-			bool useCompression;
-			m_DataStream >> useCompression;
-			if (useCompression)
+			if (m_FileVersion >= flatBodyVersion)
 			{
-				QByteArray CompresseBuffer;
-				m_DataStream >> CompresseBuffer;
-				QByteArray uncompressedBuffer= qUncompress(CompresseBuffer);
-				uncompressedBuffer.squeeze();
-				CompresseBuffer.clear();
-				CompresseBuffer.squeeze();
-				QDataStream bufferStream(uncompressedBuffer);
-				bufferStream >> loadedRep;
+				if (!readBody(&loadedRep))
+				{
+					QString message(QString("GLC_BSRep::loadRep Wrong body in file ") + m_FileInfo.fileName());
+					GLC_FileFormatException fileFormatException(message, m_FileInfo.fileName(), GLC_FileFormatException::WrongFileFormat);
+					close();
+					throw(fileFormatException);
+				}
 			}
 			else
 			{
-				m_DataStream >> loadedRep;
+				bool useCompression;
+				m_DataStream >> useCompression;
+				if (useCompression)
+				{
+					QByteArray CompresseBuffer;
+					m_DataStream >> CompresseBuffer;
+					QByteArray uncompressedBuffer= qUncompress(CompresseBuffer);
+					uncompressedBuffer.squeeze();
+					CompresseBuffer.clear();
+					CompresseBuffer.squeeze();
+					QDataStream bufferStream(uncompressedBuffer);
+					bufferStream >> loadedRep;
+				}
+				else
+				{
+					m_DataStream >> loadedRep;
+				}
 			}
 			loadedRep.setFileName(m_FileInfo.filePath());
 
@@ -186,6 +247,30 @@ quint32 GLC_BSRep::version()
 	return m_Version;
 }
 
+// Return the little endian block of the given vector
+QByteArray GLC_BSRep::blockOfVector(const GLfloatVector& vector)
+{
+	return blockOfValues(vector);
+}
+
+// Return the little endian block of the given vector
+QByteArray GLC_BSRep::blockOfVector(const GLuintVector& vector)
+{
+	return blockOfValues(vector);
+}
+
+// Set the given vector from the given little endian block
+void GLC_BSRep::vectorOfBlock(const QByteArray& block, GLfloatVector* pVector)
+{
+	valuesOfBlock(block, pVector);
+}
+
+// Set the given vector from the given little endian block
+void GLC_BSRep::vectorOfBlock(const QByteArray& block, GLuintVector* pVector)
+{
+	valuesOfBlock(block, pVector);
+}
+
 //////////////////////////////////////////////////////////////////////
 //name Set Functions
 //////////////////////////////////////////////////////////////////////
@@ -213,37 +298,18 @@ bool GLC_BSRep::save(const GLC_3DRep& rep)
 		// Representation Bounding Box
 		m_DataStream << rep.boundingBox();
 
-		// Compression usage
-
-		if (m_UseCompression && (rep.faceCount() < 1000000))
-		{
-			m_DataStream << true;
-			QByteArray uncompressedBuffer;
-			{
-				QBuffer buffer(&uncompressedBuffer);
-				buffer.open(QIODevice::WriteOnly);
-				QDataStream bufferStream(&buffer);
-				bufferStream << rep;
-			}
-			m_DataStream << qCompress(uncompressedBuffer, m_CompressionLevel);
-		}
-		else
-		{
-			m_DataStream << false;
-			// Binary representation geometry
-			// Add the rep
-			m_DataStream << rep;
-		}
+		// Representation flat body
+		const bool bodyOk= writeBody(rep);
 
 		// Flag the file
 		qint64 offset= sizeof(QUuid);
 		offset+= sizeof(quint32);
 
 		m_pFile->seek(offset);
-		bool writeOk= true;
+		bool writeOk= bodyOk;
 		m_DataStream << writeOk;
 		// Close the file
-		saveOk= close();
+		saveOk= close() && bodyOk;
 	}
 	return saveOk;
 }
@@ -334,6 +400,7 @@ bool GLC_BSRep::headerIsOk()
 	// Set the version of the data stream
 	m_DataStream.setVersion(QDataStream::Qt_4_6);
 
+	m_FileVersion= version;
 	bool headerOk= (uuid == m_Uuid) && (version <= m_Version) && (version > 101) && writeFinished;
 
 	return headerOk;
@@ -353,3 +420,172 @@ bool GLC_BSRep::timeStampOk(const QDateTime& timeStamp)
 	return timeStampOk;
 }
 
+// Write the flat body of the given representation and return true on success
+bool GLC_BSRep::writeBody(const GLC_3DRep& rep)
+{
+	Q_ASSERT(m_pFile != NULL);
+
+	// Bulk data blocks, the description block is the last one
+	QList<QByteArray> blocks;
+	QByteArray description;
+	{
+		QBuffer buffer(&description);
+		buffer.open(QIODevice::WriteOnly);
+		QDataStream bufferStream(&buffer);
+		bufferStream.setVersion(QDataStream::Qt_4_6);
+		bufferStream.setByteOrder(QDataStream::LittleEndian);
+		bufferStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+		rep.saveToDataStream(bufferStream, &blocks);
+	}
+	blocks.append(description);
+	description.clear();
+
+	const int blockCount= blocks.size();
+	QVector<BlockTask> tasks(blockCount);
+	for (int i= 0; i < blockCount; ++i)
+	{
+		tasks[i].m_Source= blocks.at(i);
+		tasks[i].m_CompressionLevel= m_CompressionLevel;
+	}
+	blocks.clear();
+
+	// Blocks are compressed independently
+	if (m_UseCompression)
+	{
+		QtConcurrent::blockingMap(tasks, &GLC_BSRep::compressTask);
+	}
+
+	// The block count and the blocks table
+	const qint64 bodyOffset= alignedOffset(m_pFile->pos());
+	qint64 blockOffset= alignedOffset(bodyOffset + 8 + blockEntrySize * blockCount);
+	QByteArray head(static_cast<int>(blockOffset - m_pFile->pos()), '\0');
+	uchar* pHead= reinterpret_cast<uchar*>(head.data()) + (bodyOffset - m_pFile->pos());
+	qToLittleEndian<quint32>(static_cast<quint32>(blockCount), pHead);
+	qToLittleEndian<quint32>(0, pHead + 4);
+	for (int i= 0; i < blockCount; ++i)
+	{
+		const bool isCompressed= !tasks.at(i).m_Result.isEmpty();
+		const qint64 storedSize= isCompressed ? tasks.at(i).m_Result.size() : tasks.at(i).m_Source.size();
+		uchar* pEntry= pHead + 8 + blockEntrySize * i;
+		qToLittleEndian<quint64>(static_cast<quint64>(blockOffset), pEntry);
+		qToLittleEndian<quint64>(static_cast<quint64>(storedSize), pEntry + 8);
+		qToLittleEndian<quint64>(static_cast<quint64>(tasks.at(i).m_Source.size()), pEntry + 16);
+		qToLittleEndian<quint32>(isCompressed ? zlibCompression : noCompression, pEntry + 24);
+		qToLittleEndian<quint32>(0, pEntry + 28);
+		blockOffset= alignedOffset(blockOffset + storedSize);
+	}
+	bool writeOk= (m_pFile->write(head) == head.size());
+
+	// The blocks
+	for (int i= 0; writeOk && (i < blockCount); ++i)
+	{
+		const QByteArray& block= tasks.at(i).m_Result.isEmpty() ? tasks.at(i).m_Source : tasks.at(i).m_Result;
+		writeOk= (m_pFile->write(block) == block.size());
+		const qint64 paddingSize= alignedOffset(m_pFile->pos()) - m_pFile->pos();
+		if (writeOk && (paddingSize > 0))
+		{
+			writeOk= (m_pFile->write(QByteArray(static_cast<int>(paddingSize), '\0')) == paddingSize);
+		}
+	}
+
+	return writeOk;
+}
+
+// Load the given representation from the flat body and return true on success
+bool GLC_BSRep::readBody(GLC_3DRep* pLoadedRep)
+{
+	Q_ASSERT(m_pFile != NULL);
+
+	const qint64 bodyOffset= alignedOffset(m_pFile->pos());
+	const qint64 size= m_pFile->size();
+	bool readOk= false;
+
+	// Uncompressed blocks are used directly from the mapped file
+	uchar* pData= m_pFile->map(0, size);
+	if (NULL != pData)
+	{
+		readOk= readBody(pData, size, bodyOffset, pLoadedRep);
+		m_pFile->unmap(pData);
+	}
+	else
+	{
+		m_pFile->seek(0);
+		const QByteArray content(m_pFile->readAll());
+		readOk= readBody(reinterpret_cast<const uchar*>(content.constData()), content.size(), bodyOffset, pLoadedRep);
+	}
+
+	return readOk;
+}
+
+// Load the given representation from the flat body of the given file content and return true on success
+bool GLC_BSRep::readBody(const uchar* pData, qint64 size, qint64 bodyOffset, GLC_3DRep* pLoadedRep)
+{
+	if ((bodyOffset + 8) > size) return false;
+
+	const qint64 blockCount= qFromLittleEndian<quint32>(pData + bodyOffset);
+	if ((0 == blockCount) || ((bodyOffset + 8 + blockEntrySize * blockCount) > size)) return false;
+
+	QVector<BlockTask> tasks(static_cast<int>(blockCount));
+	QVector<qint64> blockSizes(static_cast<int>(blockCount));
+	bool isCompressed= false;
+	for (int i= 0; i < blockCount; ++i)
+	{
+		const uchar* pEntry= pData + bodyOffset + 8 + blockEntrySize * i;
+		const qint64 offset= static_cast<qint64>(qFromLittleEndian<quint64>(pEntry));
+		const qint64 storedSize= static_cast<qint64>(qFromLittleEndian<quint64>(pEntry + 8));
+		blockSizes[i]= static_cast<qint64>(qFromLittleEndian<quint64>(pEntry + 16));
+		const quint32 compression= qFromLittleEndian<quint32>(pEntry + 24);
+		if ((offset < 0) || (storedSize < 0) || ((offset + storedSize) > size) || (compression > zlibCompression)) return false;
+
+		tasks[i].m_Source= QByteArray::fromRawData(reinterpret_cast<const char*>(pData + offset), static_cast<int>(storedSize));
+		if (noCompression == compression)
+		{
+			tasks[i].m_Result= tasks.at(i).m_Source;
+		}
+		else
+		{
+			isCompressed= true;
+		}
+	}
+
+	// Blocks are uncompressed independently
+	if (isCompressed)
+	{
+		QtConcurrent::blockingMap(tasks, &GLC_BSRep::uncompressTask);
+	}
+
+	QList<QByteArray> blocks;
+	for (int i= 0; i < blockCount; ++i)
+	{
+		if (tasks.at(i).m_Result.size() != blockSizes.at(i)) return false;
+		if (i < (blockCount - 1)) blocks.append(tasks.at(i).m_Result);
+	}
+
+	QDataStream bufferStream(tasks.last().m_Result);
+	bufferStream.setVersion(QDataStream::Qt_4_6);
+	bufferStream.setByteOrder(QDataStream::LittleEndian);
+	bufferStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+	pLoadedRep->loadFromDataStream(bufferStream, &blocks);
+
+	return bufferStream.status() == QDataStream::Ok;
+}
+
+// Compress the block of the given task
+void GLC_BSRep::compressTask(BlockTask& task)
+{
+	// Blocks which are not smaller once compressed are stored uncompressed
+	task.m_Result= qCompress(task.m_Source, task.m_CompressionLevel);
+	if (task.m_Result.size() >= task.m_Source.size())
+	{
+		task.m_Result.clear();
+	}
+}
+
+// Uncompress the block of the given task
+void GLC_BSRep::uncompressTask(BlockTask& task)
+{
+	if (task.m_Result.isEmpty())
+	{
+		task.m_Result= qUncompress(task.m_Source);
+	}
+}
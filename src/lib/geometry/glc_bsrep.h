@@ -29,7 +29,7 @@
 #include <QDataStream>
 #include <QUuid>
 #include <QDateTime>
-#include <QMutex>
+#include <QByteArray>
 
 #include "../glc_config.h"
 #include "glc_3drep.h"
@@ -37,9 +37,33 @@
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_BSRep
 /*! \brief GLC_BSRep : The 3D Binary serialised representation*/
+
+/*! Since version 200, the header and the bounding box are followed by a flat
+ *  little endian body, aligned on 16 bytes :
+ *  - The number of blocks and a table of block (offset, stored size, size, compression)
+ *  - The vertex attributes and LODs index blocks, raw little endian arrays
+ *  - The last block which describes the representation : materials, meshes,
+ *    LODs and primitive groups, with the index of the bulk data blocks
+ *
+ *  The file is memory mapped to load uncompressed blocks without deserialization.
+ *  When compression is used, each block is compressed separately on worker threads.
+ *  Previous versions are still loaded.
+ */
 //////////////////////////////////////////////////////////////////////
 class GLC_LIB_EXPORT GLC_BSRep
 {
+	//! \struct BlockTask
+	/*! \brief BlockTask : Compression or decompression of a block on a worker thread */
+	struct BlockTask
+	{
+		//! The source block
+		QByteArray m_Source;
+		//! The resulting block
+		QByteArray m_Result;
+		//! The compression level
+		int m_CompressionLevel;
+	};
+
 //////////////////////////////////////////////////////////////////////
 /*! @name Constructor */
 //@{
@@ -78,6 +102,18 @@ public:
 
 	//! Return bsrep version
 	static quint32 version();
+
+	//! Return the little endian block of the given vector
+	static QByteArray blockOfVector(const GLfloatVector& vector);
+
+	//! Return the little endian block of the given vector
+	static QByteArray blockOfVector(const GLuintVector& vector);
+
+	//! Set the given vector from the given little endian block
+	static void vectorOfBlock(const QByteArray& block, GLfloatVector* pVector);
+
+	//! Set the given vector from the given little endian block
+	static void vectorOfBlock(const QByteArray& block, GLuintVector* pVector);
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -121,6 +157,21 @@ private:
 	//! Check the time Stamp
 	bool timeStampOk(const QDateTime&);
 
+	//! Write the flat body of the given representation and return true on success
+	bool writeBody(const GLC_3DRep& rep);
+
+	//! Load the given representation from the flat body and return true on success
+	bool readBody(GLC_3DRep* pLoadedRep);
+
+	//! Load the given representation from the flat body of the given file content and return true on success
+	bool readBody(const uchar* pData, qint64 size, qint64 bodyOffset, GLC_3DRep* pLoadedRep);
+
+	//! Compress the block of the given task
+	static void compressTask(BlockTask& task);
+
+	//! Uncompress the block of the given task
+	static void uncompressTask(BlockTask& task);
+
 //////////////////////////////////////////////////////////////////////
 // Private members
 //////////////////////////////////////////////////////////////////////
@@ -137,6 +188,9 @@ private:
 	//! the Binary representation file informations
 	QFileInfo m_FileInfo;
 
+	//! The version of the opened file
+	quint32 m_FileVersion;
+
 	//! The brep file
     QFile* m_pFile;
 
@@ -149,9 +203,6 @@ private:
 	//! The compression level
 	int m_CompressionLevel;
 
-	//! Compression Mutex
-	static QMutex m_CompressionMutex;
-
 };
 
 #endif /* GLC_BSREP_H_ */
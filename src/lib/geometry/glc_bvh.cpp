@@ -0,0 +1,458 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_bvh.cpp implementation of the GLC_Bvh class.
+
+#include <limits>
+#include <cfloat>
+#include <cmath>
+
+#include <QtConcurrent>
+
+#include "glc_bvh.h"
+
+// The number of bins of the surface area heuristic
+#define GLC_BVH_BIN_COUNT 16
+
+// The minimum number of items of a subtree built by a worker thread
+#define GLC_BVH_PARALLEL_SIZE 4096
+
+// The maximum depth of the top of the hierarchy split before the parallel build
+#define GLC_BVH_PARALLEL_DEPTH 4
+
+GLC_Bvh::GLC_Bvh(int maximumLeafSize)
+: m_Nodes()
+, m_Slots()
+, m_MaximumLeafSize(qMax(1, maximumLeafSize))
+{
+
+}
+
+double GLC_Bvh::surfaceAreaCost() const
+{
+	if (m_Nodes.isEmpty()) return 0.0;
+
+	const double rootArea= halfArea(m_Nodes.at(0).m_Lower, m_Nodes.at(0).m_Upper);
+	if (rootArea <= 0.0) return 0.0;
+
+	double subject= 0.0;
+	const int size= m_Nodes.size();
+	for (int i= 0; i < size; ++i)
+	{
+		const Node& node= m_Nodes.at(i);
+		const double area= halfArea(node.m_Lower, node.m_Upper);
+		subject+= (node.m_Count > 0) ? (area * node.m_Count) : area;
+	}
+	return subject / rootArea;
+}
+
+int GLC_Bvh::depth() const
+{
+	if (m_Nodes.isEmpty()) return 0;
+
+	int subject= 0;
+	QVector<QPair<int, int> > stack;
+	stack.append(qMakePair(0, 1));
+	while (!stack.isEmpty())
+	{
+		const QPair<int, int> current= stack.last();
+		stack.removeLast();
+		subject= qMax(subject, current.second);
+		const Node& node= m_Nodes.at(current.first);
+		if (0 == node.m_Count)
+		{
+			stack.append(qMakePair(current.first + 1, current.second + 1));
+			stack.append(qMakePair(node.m_Offset, current.second + 1));
+		}
+	}
+	return subject;
+}
+
+void GLC_Bvh::build(const QVector<float>& boxes)
+{
+	clear();
+	Q_ASSERT((boxes.size() % 6) == 0);
+	const int itemCount= boxes.size() / 6;
+	if (0 == itemCount) return;
+
+	const float* pBoxes= boxes.constData();
+
+	// The items centroids
+	QVector<float> centroids(itemCount * 3);
+	for (int i= 0; i < itemCount; ++i)
+	{
+		for (int axis= 0; axis < 3; ++axis)
+		{
+			centroids[i * 3 + axis]= 0.5f * (pBoxes[i * 6 + axis] + pBoxes[i * 6 + 3 + axis]);
+		}
+	}
+	const float* pCentroids= centroids.constData();
+
+	m_Slots.resize(itemCount);
+	for (int i= 0; i < itemCount; ++i) m_Slots[i]= i;
+	m_Nodes.reserve(2 * (itemCount / m_MaximumLeafSize) + 1);
+
+	if (itemCount < (2 * GLC_BVH_PARALLEL_SIZE))
+	{
+		buildSubtree(pBoxes, pCentroids, m_Slots.data(), m_MaximumLeafSize, 0, itemCount, &m_Nodes);
+	}
+	else
+	{
+		// The top of the hierarchy is split here, its subtrees are built in parallel
+		QVector<TopNode> topNodes;
+		QVector<SubtreeTask> tasks;
+		splitTop(pBoxes, pCentroids, 0, itemCount, GLC_BVH_PARALLEL_DEPTH, &topNodes, &tasks);
+		QtConcurrent::blockingMap(tasks, GLC_Bvh::buildSubtreeTask);
+
+		// The subtrees are appended depth first
+		appendTopNode(topNodes, tasks, 0);
+	}
+	m_Nodes.squeeze();
+}
+
+void GLC_Bvh::refit(const QVector<float>& boxes)
+{
+	Q_ASSERT(boxes.size() == (m_Slots.size() * 6));
+
+	// The children of a node follow it, so the nodes are refitted from the last one
+	for (int index= m_Nodes.size() - 1; index >= 0; --index)
+	{
+		refitNode(index, boxes);
+	}
+}
+
+void GLC_Bvh::refitNode(int index, const QVector<float>& boxes)
+{
+	Q_ASSERT(boxes.size() == (m_Slots.size() * 6));
+	const float* pBoxes= boxes.constData();
+
+	Node& node= m_Nodes[index];
+	if (node.m_Count > 0)
+	{
+		for (int axis= 0; axis < 3; ++axis)
+		{
+			node.m_Lower[axis]= std::numeric_limits<float>::max();
+			node.m_Upper[axis]= -std::numeric_limits<float>::max();
+		}
+		const int last= node.m_Offset + node.m_Count;
+		for (int slot= node.m_Offset; slot < last; ++slot)
+		{
+			const int item= m_Slots.at(slot);
+			for (int axis= 0; axis < 3; ++axis)
+			{
+				node.m_Lower[axis]= qMin(node.m_Lower[axis], pBoxes[item * 6 + axis]);
+				node.m_Upper[axis]= qMax(node.m_Upper[axis], pBoxes[item * 6 + 3 + axis]);
+			}
+		}
+	}
+	else
+	{
+		const Node& left= m_Nodes.at(index + 1);
+		const Node& right= m_Nodes.at(node.m_Offset);
+		for (int axis= 0; axis < 3; ++axis)
+		{
+			node.m_Lower[axis]= qMin(left.m_Lower[axis], right.m_Lower[axis]);
+			node.m_Upper[axis]= qMax(left.m_Upper[axis], right.m_Upper[axis]);
+		}
+	}
+}
+
+void GLC_Bvh::clear()
+{
+	m_Nodes.clear();
+	m_Slots.clear();
+}
+
+void GLC_Bvh::appendBox(const GLC_BoundingBox& box, QVector<float>* pBoxes)
+{
+	const GLC_Point3d lower(box.lowerCorner());
+	const GLC_Point3d upper(box.upperCorner());
+	for (int axis= 0; axis < 3; ++axis)
+	{
+		const double value= lower.data()[axis];
+		float result= static_cast<float>(value);
+		if (static_cast<double>(result) > value) result-= fabs(result) * FLT_EPSILON + FLT_MIN;
+		pBoxes->append(result);
+	}
+	for (int axis= 0; axis < 3; ++axis)
+	{
+		const double value= upper.data()[axis];
+		float result= static_cast<float>(value);
+		if (static_cast<double>(result) < value) result+= fabs(result) * FLT_EPSILON + FLT_MIN;
+		pBoxes->append(result);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+int GLC_Bvh::split(const float* pBoxes, const float* pCentroids, int* pSlots, int maximumLeafSize, int begin, int end, Node* pNode)
+{
+	// Compute the node box and the centroids box
+	float centroidLower[3];
+	float centroidUpper[3];
+	for (int axis= 0; axis < 3; ++axis)
+	{
+		pNode->m_Lower[axis]= std::numeric_limits<float>::max();
+		pNode->m_Upper[axis]= -std::numeric_limits<float>::max();
+		centroidLower[axis]= std::numeric_limits<float>::max();
+		centroidUpper[axis]= -std::numeric_limits<float>::max();
+	}
+	for (int slot= begin; slot < end; ++slot)
+	{
+		const int item= pSlots[slot];
+		for (int axis= 0; axis < 3; ++axis)
+		{
+			pNode->m_Lower[axis]= qMin(pNode->m_Lower[axis], pBoxes[item * 6 + axis]);
+			pNode->m_Upper[axis]= qMax(pNode->m_Upper[axis], pBoxes[item * 6 + 3 + axis]);
+			centroidLower[axis]= qMin(centroidLower[axis], pCentroids[item * 3 + axis]);
+			centroidUpper[axis]= qMax(centroidUpper[axis], pCentroids[item * 3 + axis]);
+		}
+	}
+	pNode->m_Offset= begin;
+	pNode->m_Count= end - begin;
+
+	// Choose the split axis : the longest axis of the centroids box
+	int axis= 0;
+	for (int i= 1; i < 3; ++i)
+	{
+		if ((centroidUpper[i] - centroidLower[i]) > (centroidUpper[axis] - centroidLower[axis])) axis= i;
+	}
+	const float extent= centroidUpper[axis] - centroidLower[axis];
+
+	int middle= -1;
+	if (pNode->m_Count > 1 && extent > 0.0f)
+	{
+		// Fill the bins
+		int binCount[GLC_BVH_BIN_COUNT];
+		float binLower[GLC_BVH_BIN_COUNT][3];
+		float binUpper[GLC_BVH_BIN_COUNT][3];
+		for (int bin= 0; bin < GLC_BVH_BIN_COUNT; ++bin)
+		{
+			binCount[bin]= 0;
+			for (int i= 0; i < 3; ++i)
+			{
+				binLower[bin][i]= std::numeric_limits<float>::max();
+				binUpper[bin][i]= -std::numeric_limits<float>::max();
+			}
+		}
+		const float scale= static_cast<float>(GLC_BVH_BIN_COUNT) / extent;
+		for (int slot= begin; slot < end; ++slot)
+		{
+			const int item= pSlots[slot];
+			const int bin= qMin(GLC_BVH_BIN_COUNT - 1, static_cast<int>((pCentroids[item * 3 + axis] - centroidLower[axis]) * scale));
+			++binCount[bin];
+			for (int i= 0; i < 3; ++i)
+			{
+				binLower[bin][i]= qMin(binLower[bin][i], pBoxes[item * 6 + i]);
+				binUpper[bin][i]= qMax(binUpper[bin][i], pBoxes[item * 6 + 3 + i]);
+			}
+		}
+
+		// Sweep the bins from the right to get the cost of the right sides
+		double rightCost[GLC_BVH_BIN_COUNT];
+		int rightCount= 0;
+		float lower[3]= {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+		float upper[3]= {-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+		for (int bin= GLC_BVH_BIN_COUNT - 1; bin > 0; --bin)
+		{
+			rightCount+= binCount[bin];
+			for (int i= 0; i < 3; ++i)
+			{
+				lower[i]= qMin(lower[i], binLower[bin][i]);
+				upper[i]= qMax(upper[i], binUpper[bin][i]);
+			}
+			rightCost[bin]= (rightCount > 0) ? (rightCount * halfArea(lower, upper)) : 0.0;
+		}
+
+		// Sweep from the left and keep the cheapest split
+		int leftCount= 0;
+		double bestCost= std::numeric_limits<double>::max();
+		int bestBin= -1;
+		for (int i= 0; i < 3; ++i)
+		{
+			lower[i]= std::numeric_limits<float>::max();
+			upper[i]= -std::numeric_limits<float>::max();
+		}
+		for (int bin= 0; bin < (GLC_BVH_BIN_COUNT - 1); ++bin)
+		{
+			leftCount+= binCount[bin];
+			for (int i= 0; i < 3; ++i)
+			{
+				lower[i]= qMin(lower[i], binLower[bin][i]);
+				upper[i]= qMax(upper[i], binUpper[bin][i]);
+			}
+			if ((0 == leftCount) || (pNode->m_Count == leftCount)) continue;
+			const double cost= (leftCount * halfArea(lower, upper)) + rightCost[bin + 1];
+			if (cost < bestCost)
+			{
+				bestCost= cost;
+				bestBin= bin;
+			}
+		}
+
+		// Split if it is cheaper than a leaf or if the leaf is too big
+		const double nodeArea= halfArea(pNode->m_Lower, pNode->m_Upper);
+		const double leafCost= pNode->m_Count * nodeArea;
+		const double splitCost= nodeArea + bestCost;
+		if ((bestBin >= 0) && ((pNode->m_Count > maximumLeafSize) || (splitCost < leafCost)))
+		{
+			// Move the items of the left bins before the items of the right bins
+			int first= begin;
+			int last= end - 1;
+			while (first <= last)
+			{
+				const int item= pSlots[first];
+				const int bin= qMin(GLC_BVH_BIN_COUNT - 1, static_cast<int>((pCentroids[item * 3 + axis] - centroidLower[axis]) * scale));
+				if (bin <= bestBin)
+				{
+					++first;
+				}
+				else
+				{
+					qSwap(pSlots[first], pSlots[last]);
+					--last;
+				}
+			}
+			middle= first;
+		}
+	}
+	else if (pNode->m_Count > maximumLeafSize)
+	{
+		// All centroids are equal, split the range in two halves
+		middle= begin + (pNode->m_Count / 2);
+	}
+
+
+	return middle;
+}
+
+void GLC_Bvh::buildSubtree(const float* pBoxes, const float* pCentroids, int* pSlots, int maximumLeafSize, int begin, int end, QVector<Node>* pNodes)
+{
+	// The build tasks, 3 int per task : first slot, end slot and the parent of a right child (-1 otherwise)
+	QVector<int> tasks;
+	tasks << begin << end << -1;
+
+	while (!tasks.isEmpty())
+	{
+		const int taskSize= tasks.size();
+		const int first= tasks.at(taskSize - 3);
+		const int last= tasks.at(taskSize - 2);
+		const int parent= tasks.at(taskSize - 1);
+		tasks.resize(taskSize - 3);
+
+		const int nodeIndex= pNodes->size();
+		if (parent >= 0) (*pNodes)[parent].m_Offset= nodeIndex;
+
+		Node node;
+		const int middle= split(pBoxes, pCentroids, pSlots, maximumLeafSize, first, last, &node);
+		if ((middle > first) && (middle < last))
+		{
+			node.m_Offset= -1;
+			node.m_Count= 0;
+			pNodes->append(node);
+
+			// The left child is built first in order to follow its parent
+			tasks << middle << last << nodeIndex;
+			tasks << first << middle << -1;
+		}
+		else
+		{
+			pNodes->append(node);
+		}
+	}
+}
+
+void GLC_Bvh::buildSubtreeTask(SubtreeTask& task)
+{
+	buildSubtree(task.m_pBoxes, task.m_pCentroids, task.m_pSlots, task.m_MaximumLeafSize, task.m_Begin, task.m_End, &task.m_Nodes);
+}
+
+int GLC_Bvh::splitTop(const float* pBoxes, const float* pCentroids, int begin, int end, int depth, QVector<TopNode>* pTopNodes, QVector<SubtreeTask>* pTasks)
+{
+	const int index= pTopNodes->size();
+	TopNode topNode;
+	topNode.m_Left= -1;
+	topNode.m_Right= -1;
+	topNode.m_Task= -1;
+
+	if ((0 == depth) || ((end - begin) < (2 * GLC_BVH_PARALLEL_SIZE)))
+	{
+		SubtreeTask task;
+		task.m_pBoxes= pBoxes;
+		task.m_pCentroids= pCentroids;
+		task.m_pSlots= m_Slots.data();
+		task.m_MaximumLeafSize= m_MaximumLeafSize;
+		task.m_Begin= begin;
+		task.m_End= end;
+		topNode.m_Task= pTasks->size();
+		pTasks->append(task);
+		pTopNodes->append(topNode);
+	}
+	else
+	{
+		const int middle= split(pBoxes, pCentroids, m_Slots.data(), m_MaximumLeafSize, begin, end, &topNode.m_Node);
+		pTopNodes->append(topNode);
+		if ((middle > begin) && (middle < end))
+		{
+			const int left= splitTop(pBoxes, pCentroids, begin, middle, depth - 1, pTopNodes, pTasks);
+			const int right= splitTop(pBoxes, pCentroids, middle, end, depth - 1, pTopNodes, pTasks);
+			(*pTopNodes)[index].m_Left= left;
+			(*pTopNodes)[index].m_Right= right;
+		}
+	}
+	return index;
+}
+
+void GLC_Bvh::appendTopNode(const QVector<TopNode>& topNodes, const QVector<SubtreeTask>& tasks, int index)
+{
+	const TopNode& topNode= topNodes.at(index);
+	if (topNode.m_Task >= 0)
+	{
+		// The right child index of the subtree inner nodes are relative to the subtree
+		const QVector<Node>& nodes= tasks.at(topNode.m_Task).m_Nodes;
+		const int base= m_Nodes.size();
+		const int size= nodes.size();
+		for (int i= 0; i < size; ++i)
+		{
+			Node node= nodes.at(i);
+			if (0 == node.m_Count) node.m_Offset+= base;
+			m_Nodes.append(node);
+		}
+	}
+	else if (topNode.m_Left < 0)
+	{
+		m_Nodes.append(topNode.m_Node);
+	}
+	else
+	{
+		const int nodeIndex= m_Nodes.size();
+		Node node= topNode.m_Node;
+		node.m_Offset= -1;
+		node.m_Count= 0;
+		m_Nodes.append(node);
+
+		appendTopNode(topNodes, tasks, topNode.m_Left);
+		m_Nodes[nodeIndex].m_Offset= m_Nodes.size();
+		appendTopNode(topNodes, tasks, topNode.m_Right);
+	}
+}
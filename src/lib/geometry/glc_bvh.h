@@ -0,0 +1,330 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_bvh.h interface for the GLC_Bvh class.
+
+#ifndef GLC_BVH_H_
+#define GLC_BVH_H_
+
+#include <QVector>
+#include <QVarLengthArray>
+#include <QPair>
+
+#include "../glc_boundingbox.h"
+
+#include "../glc_config.h"
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_Bvh
+/*! \brief GLC_Bvh : Bounding volume hierarchy of axis aligned boxes */
+
+/*! The hierarchy is built over a list of boxes (items) with the binned
+ *  surface area heuristic and stored depth first in a flat node vector :
+ *  the left child of an inner node follows its parent, the inner node stores
+ *  the index of its right child. A leaf stores a range of slots, a slot
+ *  gives the index of the item in the list used to build the hierarchy.
+ *
+ *  Boxes are stored in float, appendBox() rounds double boxes outward.
+ *
+ *  When there are many items, the top of the hierarchy is split first and
+ *  its subtrees are built on worker threads. refit() updates the node boxes
+ *  of moved items without changing the hierarchy.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_Bvh
+{
+public:
+	//! A node of the hierarchy
+	struct Node
+	{
+		//! The node box lower corner
+		float m_Lower[3];
+
+		//! The node box upper corner
+		float m_Upper[3];
+
+		//! The first slot of a leaf or the right child index of an inner node
+		int m_Offset;
+
+		//! The number of slots of a leaf, 0 for an inner node
+		int m_Count;
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct an empty hierarchy with the given maximum number of items per leaf
+	explicit GLC_Bvh(int maximumLeafSize= 4);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return true if this hierarchy is empty
+	inline bool isEmpty() const
+	{return m_Nodes.isEmpty();}
+
+	//! Return the number of items of this hierarchy
+	inline int itemCount() const
+	{return m_Slots.size();}
+
+	//! Return the nodes of this hierarchy
+	inline const QVector<Node>& nodes() const
+	{return m_Nodes;}
+
+	//! Return the index of the item at the given slot
+	inline int item(int slot) const
+	{return m_Slots.at(slot);}
+
+	//! Return the items index ordered by slot
+	inline const QVector<int>& slots() const
+	{return m_Slots;}
+
+	//! Return the maximum number of items per leaf
+	inline int maximumLeafSize() const
+	{return m_MaximumLeafSize;}
+
+	//! Return the depth of this hierarchy
+	int depth() const;
+
+	//! Return the surface area heuristic cost of this hierarchy
+	/*! The cost is the expected number of nodes and items tested by a query in the root box,
+	 *  it grows when refitted items move apart*/
+	double surfaceAreaCost() const;
+
+	//! Visit the slots of the leaves crossed by the given ray, the nearest first
+	/*! The visitor is called with a slot and the pointer to the maximum distance
+	 *  along the ray, the visitor shrinks this distance when it finds a hit.
+	 *  Leaves beyond the maximum distance are not visited.
+	 *  The distance is expressed in units of the direction length*/
+	template <class Visitor>
+	void raycast(const double origin[3], const double direction[3], double* pMaxDistance, Visitor& visitor) const;
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Build this hierarchy from the given boxes
+	/*! Each box is given by 6 floats : lower x, y, z and upper x, y, z*/
+	void build(const QVector<float>& boxes);
+
+	//! Update the nodes boxes from the given boxes of the items, keep the hierarchy
+	/*! The boxes must be given in the order used to build this hierarchy*/
+	void refit(const QVector<float>& boxes);
+
+	//! Update the box of the given node from the given boxes of the items
+	/*! The box of an inner node is computed from the boxes of its children*/
+	void refitNode(int index, const QVector<float>& boxes);
+
+	//! Remove all nodes of this hierarchy
+	void clear();
+
+	//! Append the given box, rounded outward to float, to the given boxes
+	static void appendBox(const GLC_BoundingBox& box, QVector<float>* pBoxes);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! A subtree built by a worker thread
+	struct SubtreeTask
+	{
+		//! The items boxes
+		const float* m_pBoxes;
+
+		//! The items centroids
+		const float* m_pCentroids;
+
+		//! The slots of the hierarchy
+		int* m_pSlots;
+
+		//! The maximum number of items per leaf
+		int m_MaximumLeafSize;
+
+		//! The first slot of the subtree
+		int m_Begin;
+
+		//! The end slot of the subtree
+		int m_End;
+
+		//! The nodes of the subtree
+		QVector<Node> m_Nodes;
+	};
+
+	//! A node of the top of the hierarchy
+	struct TopNode
+	{
+		//! The node
+		Node m_Node;
+
+		//! The index of the left child top node, -1 for a leaf
+		int m_Left;
+
+		//! The index of the right child top node, -1 for a leaf
+		int m_Right;
+
+		//! The index of the subtree task of this node, -1 otherwise
+		int m_Task;
+	};
+
+	//! Compute the box of the given slots range in the given node and return the first slot of the right child
+	/*! The slots are reordered. The node is set as a leaf, the returned slot is out of the range
+	 *  if the range must not be split*/
+	static int split(const float* pBoxes, const float* pCentroids, int* pSlots, int maximumLeafSize, int begin, int end, Node* pNode);
+
+	//! Append the nodes of the hierarchy of the given slots range depth first to the given nodes
+	static void buildSubtree(const float* pBoxes, const float* pCentroids, int* pSlots, int maximumLeafSize, int begin, int end, QVector<Node>* pNodes);
+
+	//! Build the given subtree
+	static void buildSubtreeTask(SubtreeTask& task);
+
+	//! Split the top of the hierarchy of the given slots range down to the given depth and return the top node index
+	int splitTop(const float* pBoxes, const float* pCentroids, int begin, int end, int depth, QVector<TopNode>* pTopNodes, QVector<SubtreeTask>* pTasks);
+
+	//! Append the given top node and its built subtrees depth first to the nodes of this hierarchy
+	void appendTopNode(const QVector<TopNode>& topNodes, const QVector<SubtreeTask>& tasks, int index);
+
+	//! Return true if the ray crosses the given node before the given distance and set the entry distance
+	static inline bool intersect(const Node& node, const double origin[3], const double inverse[3], double maxDistance, double* pEntry);
+
+	//! Return the half surface area of the given box
+	static inline double halfArea(const float lower[3], const float upper[3]);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The nodes of this hierarchy
+	QVector<Node> m_Nodes;
+
+	//! The index of the item of each slot
+	QVector<int> m_Slots;
+
+	//! The maximum number of items per leaf
+	int m_MaximumLeafSize;
+};
+
+bool GLC_Bvh::intersect(const Node& node, const double origin[3], const double inverse[3], double maxDistance, double* pEntry)
+{
+	double tMin= 0.0;
+	double tMax= maxDistance;
+	for (int axis= 0; axis < 3; ++axis)
+	{
+		double t1= (static_cast<double>(node.m_Lower[axis]) - origin[axis]) * inverse[axis];
+		double t2= (static_cast<double>(node.m_Upper[axis]) - origin[axis]) * inverse[axis];
+		if (t1 > t2) qSwap(t1, t2);
+		if (t1 > tMin) tMin= t1;
+		if (t2 < tMax) tMax= t2;
+		if (tMin > tMax) return false;
+	}
+	*pEntry= tMin;
+	return true;
+}
+
+double GLC_Bvh::halfArea(const float lower[3], const float upper[3])
+{
+	const double dx= static_cast<double>(upper[0]) - lower[0];
+	const double dy= static_cast<double>(upper[1]) - lower[1];
+	const double dz= static_cast<double>(upper[2]) - lower[2];
+	return (dx * dy) + (dy * dz) + (dz * dx);
+}
+
+template <class Visitor>
+void GLC_Bvh::raycast(const double origin[3], const double direction[3], double* pMaxDistance, Visitor& visitor) const
+{
+	if (m_Nodes.isEmpty()) return;
+
+	// A null direction component is replaced by a tiny one to avoid 0 * infinity
+	double inverse[3];
+	for (int axis= 0; axis < 3; ++axis)
+	{
+		const double component= direction[axis];
+		if (qAbs(component) < 1e-300) inverse[axis]= (component < 0.0) ? -1e300 : 1e300;
+		else inverse[axis]= 1.0 / component;
+	}
+
+	const Node* pNodes= m_Nodes.constData();
+	QVarLengthArray<QPair<int, double>, 64> stack;
+
+	double entry;
+	if (intersect(pNodes[0], origin, inverse, *pMaxDistance, &entry))
+	{
+		stack.append(qMakePair(0, entry));
+	}
+
+	while (!stack.isEmpty())
+	{
+		const QPair<int, double> current= stack.last();
+		stack.removeLast();
+		if (current.second > *pMaxDistance) continue;
+
+		const Node& node= pNodes[current.first];
+		if (node.m_Count > 0)
+		{
+			const int last= node.m_Offset + node.m_Count;
+			for (int slot= node.m_Offset; slot < last; ++slot)
+			{
+				visitor(slot, pMaxDistance);
+			}
+		}
+		else
+		{
+			const int left= current.first + 1;
+			const int right= node.m_Offset;
+			double leftEntry, rightEntry;
+			const bool hitLeft= intersect(pNodes[left], origin, inverse, *pMaxDistance, &leftEntry);
+			const bool hitRight= intersect(pNodes[right], origin, inverse, *pMaxDistance, &rightEntry);
+			if (hitLeft && hitRight)
+			{
+				// Push the farthest child first to visit the nearest one first
+				if (leftEntry < rightEntry)
+				{
+					stack.append(qMakePair(right, rightEntry));
+					stack.append(qMakePair(left, leftEntry));
+				}
+				else
+				{
+					stack.append(qMakePair(left, leftEntry));
+					stack.append(qMakePair(right, rightEntry));
+				}
+			}
+			else if (hitLeft)
+			{
+				stack.append(qMakePair(left, leftEntry));
+			}
+			else if (hitRight)
+			{
+				stack.append(qMakePair(right, rightEntry));
+			}
+		}
+	}
+}
+
+#endif /* GLC_BVH_H_ */
@@ -24,6 +24,7 @@
 
 #include "../glc_exception.h"
 #include "glc_lod.h"
+#include "../glc_frameprofiler.h"
 
 // Class chunk id
 quint32 GLC_Lod::m_ChunkId= 0xA708;
@@ -136,6 +137,7 @@ void GLC_Lod::releaseIboClientSide(bool update)
 			const GLsizei indexNbr= static_cast<GLsizei>(m_IndexVector.size());
 			const GLsizeiptr indexSize = indexNbr * sizeof(GLuint);
 			m_IndexBuffer.allocate(m_IndexVector.data(), indexSize);
+			GLC_FrameProfiler::addUploadBytes(indexSize);
 			m_IndexBuffer.release();
 		}
 		m_IndexSize= m_IndexVector.size();
@@ -154,6 +156,7 @@ void GLC_Lod::setIboUsage(bool usage)
 		const GLsizei indexNbr= static_cast<GLsizei>(m_IndexVector.size());
 		const GLsizeiptr indexSize = indexNbr * sizeof(GLuint);
 		m_IndexBuffer.allocate(m_IndexVector.data(), indexSize);
+		GLC_FrameProfiler::addUploadBytes(indexSize);
 		m_IndexBuffer.release();
 
 		m_IndexSize= m_IndexVector.size();
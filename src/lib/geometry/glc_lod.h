@@ -100,6 +100,10 @@ public:
 	inline unsigned int trianglesCount() const
 	{return m_TrianglesCount;}
 
+	//! Return true if the index can be read without the IBO
+	inline bool indexIsOnClientSide() const
+	{return !m_IndexBuffer.isCreated() || !m_IndexVector.isEmpty();}
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -23,10 +23,14 @@
 //! \file glc_mesh.cpp Implementation for the GLC_Mesh class.
 
 #include "glc_mesh.h"
+#include "glc_meshsimplifier.h"
+#include "glc_vertexcacheoptimizer.h"
 #include "../glc_renderstatistics.h"
 #include "../glc_context.h"
 #include "../glc_contextmanager.h"
 
+#include <algorithm>
+
 // Class chunk id
 quint32 GLC_Mesh::m_ChunkId= 0xA701;
 
@@ -40,6 +44,9 @@ GLC_Mesh::GLC_Mesh()
 , m_ColorPearVertex(false)
 , m_MeshData()
 , m_CurrentLod(0)
+, m_MeshBvhHash()
+, m_KeptMeshBvhHash()
+, m_MeshBvhMutex()
 {
 
 }
@@ -54,7 +61,16 @@ GLC_Mesh::GLC_Mesh(const GLC_Mesh& mesh)
 , m_ColorPearVertex(mesh.m_ColorPearVertex)
 , m_MeshData(mesh.m_MeshData)
 , m_CurrentLod(0)
+, m_MeshBvhHash()
+, m_KeptMeshBvhHash()
+, m_MeshBvhMutex()
 {
+	{
+		QMutexLocker locker(&mesh.m_MeshBvhMutex);
+		m_MeshBvhHash= mesh.m_MeshBvhHash;
+		m_KeptMeshBvhHash= mesh.m_KeptMeshBvhHash;
+	}
+
 	// Make a copy of m_PrimitiveGroups with new material id
 	PrimitiveGroupsHash::const_iterator iPrimitiveGroups= mesh.m_PrimitiveGroups.constBegin();
 	while (mesh.m_PrimitiveGroups.constEnd() != iPrimitiveGroups)
@@ -96,6 +112,17 @@ GLC_Mesh& GLC_Mesh::operator=(const GLC_Mesh& mesh)
 		m_ColorPearVertex= mesh.m_ColorPearVertex;
 		m_MeshData= mesh.m_MeshData;
 		m_CurrentLod= 0;
+		{
+			// The hierarchies are copied before the lock of this mesh
+			QMutexLocker otherLocker(&mesh.m_MeshBvhMutex);
+			const QHash<int, QWeakPointer<const GLC_MeshBvh> > meshBvhHash(mesh.m_MeshBvhHash);
+			const QHash<int, QSharedPointer<const GLC_MeshBvh> > keptMeshBvhHash(mesh.m_KeptMeshBvhHash);
+			otherLocker.unlock();
+
+			QMutexLocker locker(&m_MeshBvhMutex);
+			m_MeshBvhHash= meshBvhHash;
+			m_KeptMeshBvhHash= keptMeshBvhHash;
+		}
 
 		// Make a copy of m_PrimitiveGroups with new material id
 		PrimitiveGroupsHash::const_iterator iPrimitiveGroups= mesh.m_PrimitiveGroups.constBegin();
@@ -257,6 +284,95 @@ IndexList GLC_Mesh::getEquivalentTrianglesStripsFansIndex(int lod, GLC_uint mate
 	return subject;
 }
 
+QVector<GLuint> GLC_Mesh::getEquivalentTrianglesIndex(int lod, QVector<GLC_uint>* pPrimitiveIds) const
+{
+	QVector<GLuint> subject;
+	if (NULL != pPrimitiveIds) pPrimitiveIds->clear();
+	if (!m_PrimitiveGroups.contains(lod)) return subject;
+
+	// The index vector of the LOD, used once the primitive groups are finished
+	const QVector<GLuint> lodIndex= (lod < m_MeshData.lodCount()) ? m_MeshData.indexVector(lod) : QVector<GLuint>();
+
+	LodPrimitiveGroups::const_iterator iGroup= m_PrimitiveGroups.value(lod)->constBegin();
+	while (iGroup != m_PrimitiveGroups.value(lod)->constEnd())
+	{
+		const GLC_PrimitiveGroup* pGroup= iGroup.value();
+		// Index of serialized groups are in the LOD even if the group is not finished
+		const bool isFinished= pGroup->isFinished();
+
+		// Triangles
+		if (pGroup->containsTriangles())
+		{
+			const QVector<GLuint> source= (isFinished || pGroup->trianglesIndex().isEmpty()) ? lodIndex : pGroup->trianglesIndex().toVector();
+			const int groupCount= pGroup->trianglesIndexSizes().size();
+			for (int i= 0; i < groupCount; ++i)
+			{
+				const int offset= pGroup->trianglesGroupOffseti().at(i);
+				const int size= pGroup->trianglesIndexSizes().at(i);
+				const GLC_uint id= pGroup->containsTrianglesGroupId() ? pGroup->triangleGroupId(i) : 0;
+				for (int j= 0; j < size; ++j)
+				{
+					subject.append(source.at(offset + j));
+				}
+				if (NULL != pPrimitiveIds)
+				{
+					for (int j= 0; j < (size / 3); ++j) pPrimitiveIds->append(id);
+				}
+			}
+		}
+
+		// Strips
+		if (pGroup->containsStrip())
+		{
+			const QVector<GLuint> source= (isFinished || pGroup->stripsIndex().isEmpty()) ? lodIndex : pGroup->stripsIndex().toVector();
+			const int stripCount= pGroup->stripsSizes().size();
+			for (int i= 0; i < stripCount; ++i)
+			{
+				const GLuint* pStrip= &(source.constData()[pGroup->stripsOffseti().at(i)]);
+				const int size= pGroup->stripsSizes().at(i);
+				const GLC_uint id= pGroup->containsStripGroupId() ? pGroup->stripGroupId(i) : 0;
+				for (int j= 2; j < size; ++j)
+				{
+					// Keep the orientation of the strip triangles
+					if ((j % 2) == 0)
+					{
+						subject << pStrip[j - 2] << pStrip[j - 1] << pStrip[j];
+					}
+					else
+					{
+						subject << pStrip[j] << pStrip[j - 1] << pStrip[j - 2];
+					}
+					if (NULL != pPrimitiveIds) pPrimitiveIds->append(id);
+				}
+			}
+		}
+
+		// Fans
+		if (pGroup->containsFan())
+		{
+			const QVector<GLuint> source= (isFinished || pGroup->fansIndex().isEmpty()) ? lodIndex : pGroup->fansIndex().toVector();
+			const int fanCount= pGroup->fansSizes().size();
+			for (int i= 0; i < fanCount; ++i)
+			{
+				const GLuint* pFan= &(source.constData()[pGroup->fansOffseti().at(i)]);
+				const int size= pGroup->fansSizes().at(i);
+				const GLC_uint id= pGroup->containsFanGroupId() ? pGroup->fanGroupId(i) : 0;
+				for (int j= 1; j < (size - 1); ++j)
+				{
+					subject << pFan[0] << pFan[j] << pFan[j + 1];
+					if (NULL != pPrimitiveIds) pPrimitiveIds->append(id);
+				}
+			}
+		}
+
+		++iGroup;
+	}
+
+	Q_ASSERT((subject.count() % 3) == 0);
+
+	return subject;
+}
+
 // Return the number of triangles
 int GLC_Mesh::numberOfTriangles(int lod, GLC_uint materialId) const
 {
@@ -446,6 +562,50 @@ QSet<GLC_uint> GLC_Mesh::setOfPrimitiveId() const
 	return QSet<GLC_uint>::fromList(subject);
 }
 
+int GLC_Mesh::lodIndex(int value) const
+{
+	int index= 0;
+	if (value)
+	{
+		const int numberOfLod= m_MeshData.lodCount();
+		// Clamp value to number of load
+		index= static_cast<int>((static_cast<double>(value) / 100.0) * numberOfLod);
+		if (index >= numberOfLod) index= numberOfLod - 1;
+		if (index < 0) index= 0;
+	}
+	return index;
+}
+
+QList<GLC_uint> GLC_Mesh::lodMaterialIds(int lod) const
+{
+	QList<GLC_uint> subject;
+	if (m_PrimitiveGroups.contains(lod))
+	{
+		subject= m_PrimitiveGroups.value(lod)->keys();
+	}
+	return subject;
+}
+
+QSharedPointer<const GLC_MeshBvh> GLC_Mesh::meshBvh(int lod) const
+{
+	QMutexLocker locker(&m_MeshBvhMutex);
+	QSharedPointer<const GLC_MeshBvh> subject= m_MeshBvhHash.value(lod).toStrongRef();
+	if (subject.isNull())
+	{
+		if (m_MeshData.clientSideIsAvailable(lod))
+		{
+			subject= QSharedPointer<const GLC_MeshBvh>(new GLC_MeshBvh(*this, lod));
+			m_MeshBvhHash.insert(lod, subject.toWeakRef());
+		}
+		else
+		{
+			// Never read the OpenGL buffers
+			subject= QSharedPointer<const GLC_MeshBvh>(new GLC_MeshBvh());
+		}
+	}
+	return subject;
+}
+
 GLC_Mesh* GLC_Mesh::createMeshOfGivenLod(int lodIndex)
 {
 	Q_ASSERT(m_MeshData.lodCount() > lodIndex);
@@ -611,6 +771,9 @@ void GLC_Mesh::clearMeshWireAndBoundingBox()
 	// Reset primitive local id
 	m_NextPrimitiveLocalId= 1;
 
+	// The hierarchies are built again on demand
+	clearMeshBvhs();
+
 	// Remove all primitive groups
 	PrimitiveGroupsHash::iterator iGroups= m_PrimitiveGroups.begin();
 	while (iGroups != m_PrimitiveGroups.constEnd())
@@ -726,12 +889,18 @@ void GLC_Mesh::reverseNormals()
 // Copy index list in a vector for Vertex Array Use
 void GLC_Mesh::finish()
 {
+	clearMeshBvhs();
 	if (m_MeshData.lodCount() > 0)
 	{
 		boundingBox();
 
 		m_MeshData.finishLod();
 
+		if (GLC_State::isVertexCacheOptimizationActivated())
+		{
+			optimizeVertexCache();
+		}
+
 		moveIndexToMeshDataLod();
 	}
 	else
@@ -743,21 +912,187 @@ void GLC_Mesh::finish()
 }
 
 
-// Set the lod Index
-void GLC_Mesh::setCurrentLod(const int value)
+// Reorder triangles and vertices for the GPU vertex caches and return true on success
+bool GLC_Mesh::optimizeVertexCache(double* pAcmrBefore, double* pAcmrAfter)
 {
-	if (value)
+	const int vertexCount= m_MeshData.positionVectorHandle()->size() / 3;
+	if (m_PrimitiveGroups.isEmpty() || (0 == vertexCount)) return false;
+
+	QList<int> lods= m_PrimitiveGroups.keys();
+	std::sort(lods.begin(), lods.end());
+	const int lodCount= lods.size();
+
+	// Index are moved to the mesh data when the mesh is finished
+	for (int i= 0; i < lodCount; ++i)
 	{
-		const int numberOfLod= m_MeshData.lodCount();
-		// Clamp value to number of load
-		m_CurrentLod= static_cast<int>((static_cast<double>(value) / 100.0) * numberOfLod);
-		if (m_CurrentLod >= numberOfLod) m_CurrentLod = numberOfLod - 1;
-		if (m_CurrentLod < 0) m_CurrentLod = 0;
+		LodPrimitiveGroups::const_iterator iGroup= m_PrimitiveGroups.value(lods.at(i))->constBegin();
+		while (iGroup != m_PrimitiveGroups.value(lods.at(i))->constEnd())
+		{
+			if (iGroup.value()->isFinished()) return false;
+			++iGroup;
+		}
+	}
+
+	GLC_VertexCacheOptimizer optimizer;
+	int triangleCount= 0;
+	int missBefore= 0;
+	int missAfter= 0;
+	QList<IndexList> indexLists;
+	for (int i= 0; i < lodCount; ++i)
+	{
+		LodPrimitiveGroups::iterator iGroup= m_PrimitiveGroups.value(lods.at(i))->begin();
+		while (iGroup != m_PrimitiveGroups.value(lods.at(i))->end())
+		{
+			GLC_PrimitiveGroup* pGroup= iGroup.value();
+			if (pGroup->containsTriangles())
+			{
+				IndexList* pTrianglesIndex= pGroup->trianglesIndexHandle();
+				missBefore+= optimizer.cacheMissCount(*pTrianglesIndex);
+
+				// Triangles of a primitive id are kept together
+				if (pGroup->containsTrianglesGroupId())
+				{
+					const IndexSizes& sizes= pGroup->trianglesIndexSizes();
+					int offset= 0;
+					const int groupCount= sizes.size();
+					for (int iSize= 0; iSize < groupCount; ++iSize)
+					{
+						optimizer.optimizeTriangles(pTrianglesIndex, offset, sizes.at(iSize));
+						offset+= sizes.at(iSize);
+					}
+				}
+				else
+				{
+					optimizer.optimizeTriangles(pTrianglesIndex);
+				}
+				missAfter+= optimizer.cacheMissCount(*pTrianglesIndex);
+				triangleCount+= pTrianglesIndex->size() / 3;
+				indexLists.append(*pTrianglesIndex);
+			}
+			if (pGroup->containsStrip()) indexLists.append(*(pGroup->stripsIndexHandle()));
+			if (pGroup->containsFan()) indexLists.append(*(pGroup->fansIndexHandle()));
+			++iGroup;
+		}
+	}
+
+	// Vertices are renumbered by first use
+	const QVector<GLuint> remap= GLC_VertexCacheOptimizer::vertexFetchRemap(indexLists, vertexCount);
+	indexLists.clear();
+	for (int i= 0; i < lodCount; ++i)
+	{
+		LodPrimitiveGroups::iterator iGroup= m_PrimitiveGroups.value(lods.at(i))->begin();
+		while (iGroup != m_PrimitiveGroups.value(lods.at(i))->end())
+		{
+			GLC_PrimitiveGroup* pGroup= iGroup.value();
+			GLC_VertexCacheOptimizer::remapIndex(pGroup->trianglesIndexHandle(), remap);
+			GLC_VertexCacheOptimizer::remapIndex(pGroup->stripsIndexHandle(), remap);
+			GLC_VertexCacheOptimizer::remapIndex(pGroup->fansIndexHandle(), remap);
+			++iGroup;
+		}
+	}
+	GLC_VertexCacheOptimizer::remapVertices(m_MeshData.positionVectorHandle(), 3, remap);
+	GLC_VertexCacheOptimizer::remapVertices(m_MeshData.normalVectorHandle(), 3, remap);
+	GLC_VertexCacheOptimizer::remapVertices(m_MeshData.texelVectorHandle(), 2, remap);
+	GLC_VertexCacheOptimizer::remapVertices(m_MeshData.colorVectorHandle(), 4, remap);
+	clearMeshBvhs();
+
+	if (0 != triangleCount)
+	{
+		if (NULL != pAcmrBefore) *pAcmrBefore= static_cast<double>(missBefore) / static_cast<double>(triangleCount);
+		if (NULL != pAcmrAfter) *pAcmrAfter= static_cast<double>(missAfter) / static_cast<double>(triangleCount);
 	}
 	else
 	{
-		m_CurrentLod= 0;
+		if (NULL != pAcmrBefore) *pAcmrBefore= 0.0;
+		if (NULL != pAcmrAfter) *pAcmrAfter= 0.0;
 	}
+
+	return true;
+}
+
+// Add the LODs generated by the given simplifier and return the number of added LOD
+int GLC_Mesh::generateLods(const GLC_MeshSimplifier& simplifier)
+{
+	// Client side data are only available before the first rendering
+	if ((m_MeshData.lodCount() != 1) || m_MeshData.positionSizeIsSet() || m_MeshData.positionVectorHandle()->isEmpty())
+	{
+		return 0;
+	}
+
+	QList<GLC_uint> materialIds= m_PrimitiveGroups.value(0)->keys();
+	std::sort(materialIds.begin(), materialIds.end());
+	QList<IndexList> trianglesIndex;
+	const int materialCount= materialIds.size();
+	for (int i= 0; i < materialCount; ++i)
+	{
+		trianglesIndex.append(getEquivalentTrianglesStripsFansIndex(0, materialIds.at(i)));
+	}
+
+	QList<QList<IndexList> > lods;
+	QList<double> errors;
+	simplifier.simplify(*(m_MeshData.positionVectorHandle()), *(m_MeshData.normalVectorHandle())
+			, *(m_MeshData.texelVectorHandle()), trianglesIndex, &lods, &errors);
+
+	const int lodCount= lods.size();
+	for (int lod= 0; lod < lodCount; ++lod)
+	{
+		QHash<GLC_uint, IndexList> lodIndex;
+		for (int i= 0; i < materialCount; ++i)
+		{
+			lodIndex.insert(materialIds.at(i), lods.at(lod).at(i));
+		}
+		appendLod(lodIndex, errors.at(lod));
+	}
+
+	return lodCount;
+}
+
+// Append a LOD made of the given triangles index of each material id and return its index
+int GLC_Mesh::appendLod(const QHash<GLC_uint, IndexList>& trianglesIndex, double accuracy)
+{
+	Q_ASSERT(!m_MeshData.positionSizeIsSet());
+	const int lod= m_MeshData.lodCount();
+	m_MeshData.appendLod(accuracy);
+	clearMeshBvhs();
+	LodPrimitiveGroups* pPrimitiveGroups= new LodPrimitiveGroups();
+	m_PrimitiveGroups.insert(lod, pPrimitiveGroups);
+
+	QHash<GLC_uint, IndexList>::const_iterator iIndex= trianglesIndex.constBegin();
+	while (iIndex != trianglesIndex.constEnd())
+	{
+		const IndexList& indexList= iIndex.value();
+		if (!indexList.isEmpty())
+		{
+			Q_ASSERT(containsMaterial(iIndex.key()));
+			GLC_PrimitiveGroup* pGroup= new GLC_PrimitiveGroup(iIndex.key());
+			pGroup->addTriangles(indexList, 0);
+			if (GLC_State::isVertexCacheOptimizationActivated())
+			{
+				GLC_VertexCacheOptimizer().optimizeTriangles(pGroup->trianglesIndexHandle());
+			}
+			m_MeshData.getLod(lod)->trianglesAdded(indexList.size() / 3);
+
+			// The mesh is finished, so the index are directly moved to the LOD
+			pGroup->setTrianglesOffseti(m_MeshData.indexVectorSize(lod));
+			(*m_MeshData.indexVectorHandle(lod))+= pGroup->trianglesIndex().toVector();
+			pGroup->computeVboOffset();
+			pGroup->finish();
+			pPrimitiveGroups->insert(iIndex.key(), pGroup);
+		}
+		++iIndex;
+	}
+
+	// Invalid the geometry
+	m_GeometryIsValid = false;
+
+	return lod;
+}
+
+
+// Set the lod Index
+void GLC_Mesh::setCurrentLod(const int value)
+{
+	m_CurrentLod= lodIndex(value);
 }
 // Replace the Master material
 void GLC_Mesh::replaceMasterMaterial(GLC_Material* pMat)
@@ -828,6 +1163,10 @@ void GLC_Mesh::copyVboToClientSide()
 
 void GLC_Mesh::releaseVboClientSide(bool update)
 {
+	// Keep the hierarchies of the updated data, if activated, before the client side data are released
+	if (update) clearMeshBvhs();
+	keepMeshBvhs();
+
 	m_MeshData.releaseVboClientSide(update);
 	GLC_Geometry::releaseVboClientSide(update);
 }
@@ -842,7 +1181,7 @@ void GLC_Mesh::setVboUsage(bool usage)
 }
 
 // Load the mesh from binary data stream
-void GLC_Mesh::loadFromDataStream(QDataStream& stream, const MaterialHash& materialHash, const QHash<GLC_uint, GLC_uint>& materialIdMap)
+void GLC_Mesh::loadFromDataStream(QDataStream& stream, const MaterialHash& materialHash, const QHash<GLC_uint, GLC_uint>& materialIdMap, const QList<QByteArray>* pBlocks)
 {
 	quint32 chunckId;
 	stream >> chunckId;
@@ -862,7 +1201,14 @@ void GLC_Mesh::loadFromDataStream(QDataStream& stream, const MaterialHash& mater
 	setNextPrimitiveLocalId(localId);
 
 	// Retrieve geom mesh data
-	stream >> m_MeshData;
+	if (NULL != pBlocks)
+	{
+		m_MeshData.loadFromDataStream(stream, *pBlocks);
+	}
+	else
+	{
+		stream >> m_MeshData;
+	}
 
 	// Retrieve primitiveGroupLodList
 	QList<int> primitiveGroupLodList;
@@ -901,7 +1247,7 @@ void GLC_Mesh::loadFromDataStream(QDataStream& stream, const MaterialHash& mater
 }
 
 // Save the mesh to binary data stream
-void GLC_Mesh::saveToDataStream(QDataStream& stream) const
+void GLC_Mesh::saveToDataStream(QDataStream& stream, QList<QByteArray>* pBlocks) const
 {
 	quint32 chunckId= m_ChunkId;
 	stream << chunckId;
@@ -916,7 +1262,14 @@ void GLC_Mesh::saveToDataStream(QDataStream& stream) const
 	stream << nextPrimitiveLocalId();
 
 	// Mesh data serialisation
-	stream << m_MeshData;
+	if (NULL != pBlocks)
+	{
+		m_MeshData.saveToDataStream(stream, pBlocks);
+	}
+	else
+	{
+		stream << m_MeshData;
+	}
 
 	// Primitive groups serialisation
 	QList<int> primitiveGroupLodList;
@@ -947,6 +1300,47 @@ void GLC_Mesh::saveToDataStream(QDataStream& stream) const
 // OpenGL Functions
 //////////////////////////////////////////////////////////////////////
 
+// Activate the VBOs and the IBO of the specified LOD
+void GLC_Mesh::glBindLod(int lod)
+{
+	Q_ASSERT(canBeQueued());
+	m_CurrentLod= lod;
+	m_MeshData.createVBOs();
+	activateVboAndIbo();
+}
+
+// Draw the primitives of the given material of the LOD bound by glBindLod()
+void GLC_Mesh::glDrawMaterialGroup(GLC_uint materialId, int instanceCount)
+{
+	Q_ASSERT(m_PrimitiveGroups.contains(m_CurrentLod));
+	GLC_PrimitiveGroup* pGroup= m_PrimitiveGroups.value(m_CurrentLod)->value(materialId, NULL);
+	if (NULL != pGroup)
+	{
+		if (instanceCount > 1)
+		{
+			vboDrawInstancedPrimitivesOf(pGroup, instanceCount);
+		}
+		else
+		{
+			vboDrawPrimitivesOf(pGroup);
+		}
+	}
+}
+
+// Release the VBOs and the IBO activated by glBindLod()
+void GLC_Mesh::glReleaseLod()
+{
+	GLC_Context* pContext= GLC_ContextManager::instance()->currentContext();
+	Q_ASSERT(NULL != pContext);
+
+	pContext->glcDisableVertexClientState();
+	pContext->glcDisableNormalClientState();
+	pContext->glcDisableTextureClientState();
+
+	QOpenGLBuffer::release(QOpenGLBuffer::IndexBuffer);
+	QOpenGLBuffer::release(QOpenGLBuffer::VertexBuffer);
+}
+
 // Virtual interface for OpenGL Geometry set up.
 void GLC_Mesh::glDraw(const GLC_RenderProperties& renderProperties)
 {
@@ -1161,6 +1555,9 @@ GLC_uint GLC_Mesh::setCurrentMaterial(GLC_Material* pMaterial, int lod, double a
 // Fill VBOs and IBOs
 void GLC_Mesh::fillVbosAndIbos()
 {
+	// The hierarchies must be kept before the client side data are released
+	keepMeshBvhs();
+
 	// Fill VBO of vertices
 	m_MeshData.fillVbo(GLC_MeshData::GLC_Vertex);
 
@@ -1192,6 +1589,28 @@ void GLC_Mesh::finishSerialized()
 		++iGroups;
 	}
 }
+
+void GLC_Mesh::keepMeshBvhs()
+{
+	const int lodCount= m_MeshData.lodCount();
+	if (GLC_State::isMeshBvhActivated() && (lodCount > 0))
+	{
+		const QSharedPointer<const GLC_MeshBvh> pMeshBvh(meshBvh(0));
+		const QSharedPointer<const GLC_MeshBvh> pCoarsestMeshBvh(meshBvh(lodCount - 1));
+
+		// Empty hierarchies of data already released are not kept
+		QMutexLocker locker(&m_MeshBvhMutex);
+		if (!pMeshBvh->isEmpty()) m_KeptMeshBvhHash.insert(0, pMeshBvh);
+		if (!pCoarsestMeshBvh->isEmpty()) m_KeptMeshBvhHash.insert(lodCount - 1, pCoarsestMeshBvh);
+	}
+}
+
+void GLC_Mesh::clearMeshBvhs()
+{
+	QMutexLocker locker(&m_MeshBvhMutex);
+	m_MeshBvhHash.clear();
+	m_KeptMeshBvhHash.clear();
+}
 /*
 // Move Indexs from the primitive groups to the mesh Data LOD and Set IBOs offsets
 void GLC_Mesh::finishVbo()
@@ -1273,6 +1692,58 @@ void GLC_Mesh::moveIndexToMeshDataLod()
 	}
 }
 
+// Draw the given number of instances of the given number of index from the given offset and count the draw call
+void GLC_Mesh::drawElementsInstanced(GLenum mode, GLsizei count, const GLvoid* pIndex, int instanceCount)
+{
+#if !defined(Q_OS_MAC)
+	glcDrawElementsInstanced(mode, count, GL_UNSIGNED_INT, pIndex, instanceCount);
+	GLC_FrameProfiler::addDrawCalls(1);
+#else
+	Q_UNUSED(mode);
+	Q_UNUSED(count);
+	Q_UNUSED(pIndex);
+	Q_UNUSED(instanceCount);
+	Q_ASSERT(false);
+#endif
+}
+
+// Use VBO to Draw the given number of instances of the primitives from the specified GLC_PrimitiveGroup
+void GLC_Mesh::vboDrawInstancedPrimitivesOf(GLC_PrimitiveGroup* pCurrentGroup, int instanceCount)
+{
+#if !defined(Q_OS_MAC)
+	Q_ASSERT(NULL != glcDrawElementsInstanced);
+	// Draw triangles
+	if (pCurrentGroup->containsTriangles())
+	{
+		drawElementsInstanced(GL_TRIANGLES, pCurrentGroup->trianglesIndexSize(), pCurrentGroup->trianglesIndexOffset(), instanceCount);
+	}
+
+	// Draw Triangles strip
+	if (pCurrentGroup->containsStrip())
+	{
+		const GLsizei stripsCount= static_cast<GLsizei>(pCurrentGroup->stripsOffset().size());
+		for (GLint i= 0; i < stripsCount; ++i)
+		{
+			drawElementsInstanced(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pCurrentGroup->stripsOffset().at(i), instanceCount);
+		}
+	}
+
+	// Draw Triangles fan
+	if (pCurrentGroup->containsFan())
+	{
+		const GLsizei fansCount= static_cast<GLsizei>(pCurrentGroup->fansOffset().size());
+		for (GLint i= 0; i < fansCount; ++i)
+		{
+			drawElementsInstanced(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pCurrentGroup->fansOffset().at(i), instanceCount);
+		}
+	}
+#else
+	Q_UNUSED(pCurrentGroup);
+	Q_UNUSED(instanceCount);
+	Q_ASSERT(false);
+#endif
+}
+
 // The normal display loop
 void GLC_Mesh::normalRenderLoop(const GLC_RenderProperties& renderProperties, bool vboIsUsed)
 {
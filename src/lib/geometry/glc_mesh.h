@@ -27,6 +27,9 @@
 
 #include <QHash>
 #include <QList>
+#include <QSharedPointer>
+#include <QWeakPointer>
+#include <QMutex>
 #include "../maths/glc_vector2df.h"
 #include "../maths/glc_vector3df.h"
 #include "../glc_global.h"
@@ -34,13 +37,17 @@
 #include "glc_meshdata.h"
 #include "glc_geometry.h"
 #include "glc_primitivegroup.h"
+#include "glc_meshbvh.h"
 #include "../glc_state.h"
 #include "../shading/glc_selectionmaterial.h"
 #include "../glc_context.h"
 #include "../glc_contextmanager.h"
+#include "../glc_frameprofiler.h"
 
 #include "../glc_config.h"
 
+class GLC_MeshSimplifier;
+
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_Mesh
 /*! \brief GLC_Mesh : OpenGL 3D Mesh*/
@@ -109,6 +116,21 @@ public:
 	inline int lodCount() const
 	{return m_MeshData.lodCount();}
 
+	//! Return the index of the LOD used for the given LOD value in percent
+	int lodIndex(int value) const;
+
+	//! Return the number of triangles of the specified LOD
+	inline unsigned int trianglesCount(int lod) const
+	{return m_MeshData.trianglesCount(lod);}
+
+	//! Return the id of the materials used by the specified LOD
+	QList<GLC_uint> lodMaterialIds(int lod) const;
+
+	//! Return true if this mesh can be drawn by a GLC_RenderQueue
+	/*! The mesh must have been drawn once with VBO and must not use color per vertex*/
+	inline bool canBeQueued() const
+	{return m_GeometryIsValid && GLC_Geometry::vboIsUsed() && !m_ColorPearVertex && !GLC_Geometry::typeIsWire() && !m_MeshData.isEmpty();}
+
 	//! Return the Position Vector
 	inline GLfloatVector positionVector() const
 	{return m_MeshData.positionVector();}
@@ -131,6 +153,11 @@ public:
 	//! Return the equivalent triangle index of (triangle, strip and fan)
 	IndexList getEquivalentTrianglesStripsFansIndex(int lod, GLC_uint materialId);
 
+	//! Return the equivalent triangle index of the specified LOD and set the primitive id of each triangle
+	/*! Triangles, strips and fans of all materials are converted to triangles.
+	 *  If the given vector is not NULL, it is filled with the primitive id of each triangle*/
+	QVector<GLuint> getEquivalentTrianglesIndex(int lod, QVector<GLC_uint>* pPrimitiveIds= NULL) const;
+
 	//! Return the number of triangles in the specified LOD
 	int numberOfTriangles(int lod, GLC_uint materialId) const;
 
@@ -191,6 +218,14 @@ public:
 	inline QColor wireColor() const
 	{return m_WireColor;}
 
+	//! Return the hierarchy of the triangles of the given LOD
+	/*! The hierarchy is built on demand from the client side data, it is shared while it is
+	 *  referenced, the OpenGL buffers are never read and no context is needed. Thread safe.
+	 *  If GLC_State::isMeshBvhActivated() the hierarchies of the LOD 0 and of the coarsest LOD
+	 *  are kept before the data are moved to the VBOs.
+	 *  Return an empty hierarchy if the data of the given LOD are only available in the OpenGL buffers*/
+	QSharedPointer<const GLC_MeshBvh> meshBvh(int lod= 0) const;
+
 	//! Create a mesh of the given LOD index
 	GLC_Mesh* createMeshOfGivenLod(int lodIndex);
 
@@ -261,6 +296,22 @@ public:
 	//! Copy vertex list in a vector list for Vertex Array Use
 	void finish();
 
+	//! Reorder triangles and vertices for the GPU vertex caches and return true on success
+	/*! Triangles of each primitive group are reordered, primitive ids are kept.
+	 *  Vertices are then renumbered by first use in the LODs index.
+	 *  The average cache miss ratio of triangles before and after are set if not NULL.
+	 *  The mesh must not be finished, finish() calls this function if
+	 *  GLC_State::isVertexCacheOptimizationActivated() is true*/
+	bool optimizeVertexCache(double* pAcmrBefore= NULL, double* pAcmrAfter= NULL);
+
+	//! Add the LODs generated by the given simplifier and return the number of added LOD
+	/*! The mesh must be finished, not yet rendered and without LOD*/
+	int generateLods(const GLC_MeshSimplifier& simplifier);
+
+	//! Append a LOD made of the given triangles index of each material id and return its index
+	/*! The mesh must be finished and not yet rendered*/
+	int appendLod(const QHash<GLC_uint, IndexList>& trianglesIndex, double accuracy);
+
 	//! Set the lod Index
 	virtual void setCurrentLod(const int);
 
@@ -299,10 +350,12 @@ public:
 	 *  The QHash<GLC_uint, GLC_uint> is used to map serialised material ID to the new
 	 *  constructed materials
 	 */
-	void loadFromDataStream(QDataStream&, const MaterialHash&, const QHash<GLC_uint, GLC_uint>&);
+	void loadFromDataStream(QDataStream&, const MaterialHash&, const QHash<GLC_uint, GLC_uint>&, const QList<QByteArray>* pBlocks= NULL);
 
 	//! Save the mesh to binary data stream
-	void saveToDataStream(QDataStream&) const;
+	/*! If pBlocks is not NULL, vertex attributes and LODs index are appended to it
+	 *  instead of being written in the stream*/
+	void saveToDataStream(QDataStream&, QList<QByteArray>* pBlocks= NULL) const;
 
 //@}
 //////////////////////////////////////////////////////////////////////
@@ -315,6 +368,19 @@ protected:
 	/*! This Virtual function is implemented here.*/
 	virtual void glDraw(const GLC_RenderProperties&);
 
+public:
+	//! Activate the VBOs and the IBO of the specified LOD
+	/*! Used by GLC_RenderQueue on a queueable mesh*/
+	void glBindLod(int lod);
+
+	//! Draw the primitives of the given material of the LOD bound by glBindLod()
+	/*! If the given instance count is greater than 1 one instanced draw call
+	 *  is done by primitive and the instancing extension must be supported*/
+	void glDrawMaterialGroup(GLC_uint materialId, int instanceCount= 1);
+
+	//! Release the VBOs and the IBO activated by glBindLod()
+	void glReleaseLod();
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -331,15 +397,36 @@ private:
 	//! Set primitive group offset after loading mesh from binary
 	void finishSerialized();
 
+	//! Keep the hierarchies of the LOD 0 and of the coarsest LOD if GLC_State::isMeshBvhActivated()
+	/*! Called before the client side data are released*/
+	void keepMeshBvhs();
+
+	//! Remove the hierarchies of the previous data
+	void clearMeshBvhs();
+
 	//! Move Indexs from the primitive groups to the mesh Data LOD and Set IBOs offsets
 	//void finishVbo();
 
 	//! Move Indexs from the primitive groups to the mesh Data LOD and Set Index offsets
 	void moveIndexToMeshDataLod();
 
+	//! Draw the given number of index from the given offset and count the draw call
+	/*! All the draw calls of a mesh go through this function or drawElementsInstanced()*/
+	static inline void drawElements(GLenum mode, GLsizei count, const GLvoid* pIndex)
+	{
+		glDrawElements(mode, count, GL_UNSIGNED_INT, pIndex);
+		GLC_FrameProfiler::addDrawCalls(1);
+	}
+
+	//! Draw the given number of instances of the given number of index from the given offset and count the draw call
+	static void drawElementsInstanced(GLenum mode, GLsizei count, const GLvoid* pIndex, int instanceCount);
+
 	//! Use VBO to Draw primitives from the specified GLC_PrimitiveGroup
 	inline void vboDrawPrimitivesOf(GLC_PrimitiveGroup*);
 
+	//! Use VBO to Draw the given number of instances of the primitives from the specified GLC_PrimitiveGroup
+	void vboDrawInstancedPrimitivesOf(GLC_PrimitiveGroup*, int);
+
 	//! Use Vertex Array to Draw primitives from the specified GLC_PrimitiveGroup
 	inline void vertexArrayDrawPrimitivesOf(GLC_PrimitiveGroup*);
 
@@ -438,6 +525,15 @@ private:
 	//! The current LOD index
 	int m_CurrentLod;
 
+	//! The hierarchies of the triangles by LOD, shared while they are referenced
+	mutable QHash<int, QWeakPointer<const GLC_MeshBvh> > m_MeshBvhHash;
+
+	//! The hierarchies by LOD kept when the client side data are released
+	mutable QHash<int, QSharedPointer<const GLC_MeshBvh> > m_KeptMeshBvhHash;
+
+	//! The mutex protecting the hierarchies
+	mutable QMutex m_MeshBvhMutex;
+
 	//! Class chunk id
 	static quint32 m_ChunkId;
 
@@ -451,7 +547,7 @@ void GLC_Mesh::vboDrawPrimitivesOf(GLC_PrimitiveGroup* pCurrentGroup)
 	// Draw triangles
 	if (pCurrentGroup->containsTriangles())
 	{
-		glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSize(), GL_UNSIGNED_INT, pCurrentGroup->trianglesIndexOffset());
+		drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSize(), pCurrentGroup->trianglesIndexOffset());
 	}
 
 	// Draw Triangles strip
@@ -460,7 +556,7 @@ void GLC_Mesh::vboDrawPrimitivesOf(GLC_PrimitiveGroup* pCurrentGroup)
 		const GLsizei stripsCount= static_cast<GLsizei>(pCurrentGroup->stripsOffset().size());
 		for (GLint i= 0; i < stripsCount; ++i)
 		{
-			glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->stripsOffset().at(i));
+			drawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pCurrentGroup->stripsOffset().at(i));
 		}
 	}
 
@@ -470,7 +566,7 @@ void GLC_Mesh::vboDrawPrimitivesOf(GLC_PrimitiveGroup* pCurrentGroup)
 		const GLsizei fansCount= static_cast<GLsizei>(pCurrentGroup->fansOffset().size());
 		for (GLint i= 0; i < fansCount; ++i)
 		{
-			glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->fansOffset().at(i));
+			drawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pCurrentGroup->fansOffset().at(i));
 		}
 	}
 }
@@ -481,7 +577,7 @@ void GLC_Mesh::vertexArrayDrawPrimitivesOf(GLC_PrimitiveGroup* pCurrentGroup)
 	if (pCurrentGroup->containsTriangles())
 	{
 		GLvoid* pOffset= &(m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->trianglesIndexOffseti()]);
-		glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSize(), GL_UNSIGNED_INT, pOffset);
+		drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSize(), pOffset);
 	}
 
 	// Draw Triangles strip
@@ -491,7 +587,7 @@ void GLC_Mesh::vertexArrayDrawPrimitivesOf(GLC_PrimitiveGroup* pCurrentGroup)
 		for (GLint i= 0; i < stripsCount; ++i)
 		{
 			GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->stripsOffseti().at(i)];
-			glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pOffset);
+			drawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pOffset);
 		}
 	}
 
@@ -502,7 +598,7 @@ void GLC_Mesh::vertexArrayDrawPrimitivesOf(GLC_PrimitiveGroup* pCurrentGroup)
 		for (GLint i= 0; i < fansCount; ++i)
 		{
 			GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->fansOffseti().at(i)];
-			glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pOffset);
+			drawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pOffset);
 		}
 	}
 }
@@ -519,7 +615,7 @@ void GLC_Mesh::vboDrawInSelectionModePrimitivesOf(GLC_PrimitiveGroup* pCurrentGr
 		{
 			glc::encodeRgbId(pCurrentGroup->triangleGroupId(i), colorId);
 			glColor3ubv(colorId);
-			glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->trianglesGroupOffset().at(i));
+			drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), pCurrentGroup->trianglesGroupOffset().at(i));
 		}
 	}
 
@@ -531,7 +627,7 @@ void GLC_Mesh::vboDrawInSelectionModePrimitivesOf(GLC_PrimitiveGroup* pCurrentGr
 		{
 			glc::encodeRgbId(pCurrentGroup->stripGroupId(i), colorId);
 			glColor3ubv(colorId);
-			glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->stripsOffset().at(i));
+			drawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pCurrentGroup->stripsOffset().at(i));
 		}
 	}
 
@@ -544,7 +640,7 @@ void GLC_Mesh::vboDrawInSelectionModePrimitivesOf(GLC_PrimitiveGroup* pCurrentGr
 			glc::encodeRgbId(pCurrentGroup->fanGroupId(i), colorId);
 			glColor3ubv(colorId);
 
-			glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->fansOffset().at(i));
+			drawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pCurrentGroup->fansOffset().at(i));
 		}
 	}
 
@@ -564,11 +660,11 @@ void GLC_Mesh::vertexArrayDrawInSelectionModePrimitivesOf(GLC_PrimitiveGroup* pC
 			glColor3ubv(colorId);
 
 			GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->trianglesGroupOffseti().at(i)];
-			glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pOffset);
+			drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), pOffset);
 		}
 
 		GLvoid* pOffset= &(m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->trianglesIndexOffseti()]);
-		glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSize(), GL_UNSIGNED_INT, pOffset);
+		drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSize(), pOffset);
 	}
 
 	// Draw Triangles strip
@@ -581,7 +677,7 @@ void GLC_Mesh::vertexArrayDrawInSelectionModePrimitivesOf(GLC_PrimitiveGroup* pC
 			glColor3ubv(colorId);
 
 			GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->stripsOffseti().at(i)];
-			glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pOffset);
+			drawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pOffset);
 		}
 	}
 
@@ -595,7 +691,7 @@ void GLC_Mesh::vertexArrayDrawInSelectionModePrimitivesOf(GLC_PrimitiveGroup* pC
 			glColor3ubv(colorId);
 
 			GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->fansOffseti().at(i)];
-			glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pOffset);
+			drawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pOffset);
 		}
 	}
 }
@@ -628,7 +724,7 @@ void GLC_Mesh::vboDrawPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGroup, GLC_M
 			}
 			if (pCurrentLocalMaterial->isTransparent() == isTransparent)
 			{
-				glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->trianglesGroupOffset().at(i));
+				drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), pCurrentGroup->trianglesGroupOffset().at(i));
 			}
 		}
 	}
@@ -656,7 +752,7 @@ void GLC_Mesh::vboDrawPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGroup, GLC_M
 			}
 			if (pCurrentLocalMaterial->isTransparent() == isTransparent)
 			{
-				glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->stripsOffset().at(i));
+				drawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pCurrentGroup->stripsOffset().at(i));
 			}
 		}
 	}
@@ -684,7 +780,7 @@ void GLC_Mesh::vboDrawPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGroup, GLC_M
 			}
 			if (pCurrentLocalMaterial->isTransparent() == isTransparent)
 			{
-				glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->fansOffset().at(i));
+				drawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pCurrentGroup->fansOffset().at(i));
 			}
 		}
 	}
@@ -720,7 +816,7 @@ void GLC_Mesh::vertexArrayDrawPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 			if (pCurrentLocalMaterial->isTransparent() == isTransparent)
 			{
 				GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->trianglesGroupOffseti().at(i)];
-				glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pOffset);
+				drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), pOffset);
 			}
 		}
 	}
@@ -749,7 +845,7 @@ void GLC_Mesh::vertexArrayDrawPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 			if (pCurrentLocalMaterial->isTransparent() == isTransparent)
 			{
 				GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->stripsOffseti().at(i)];
-				glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pOffset);
+				drawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pOffset);
 			}
 		}
 	}
@@ -778,7 +874,7 @@ void GLC_Mesh::vertexArrayDrawPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 			if (pCurrentLocalMaterial->isTransparent() == isTransparent)
 			{
 				GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->fansOffseti().at(i)];
-				glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pOffset);
+				drawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pOffset);
 			}
 		}
 	}
@@ -813,7 +909,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 				{
 					GLC_SelectionMaterial::glExecute();
 					pCurrentLocalMaterial= NULL;
-					glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->trianglesGroupOffset().at(i));
+					drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), pCurrentGroup->trianglesGroupOffset().at(i));
 				}
 			}
 			else if ((NULL != pMaterialHash) && pMaterialHash->contains(currentPrimitiveId))
@@ -826,7 +922,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 						pCurrentLocalMaterial= pMat;
 						pCurrentLocalMaterial->glExecute();
 					}
-					glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->trianglesGroupOffset().at(i));
+					drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), pCurrentGroup->trianglesGroupOffset().at(i));
 				}
 
 			}
@@ -837,7 +933,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 					pCurrentLocalMaterial= pCurrentMaterial;
 					pCurrentLocalMaterial->glExecute();
 				}
-				glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->trianglesGroupOffset().at(i));
+				drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), pCurrentGroup->trianglesGroupOffset().at(i));
 			}
 		}
 	}
@@ -856,7 +952,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 				{
 					GLC_SelectionMaterial::glExecute();
 					pCurrentLocalMaterial= NULL;
-					glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->stripsOffset().at(i));
+					drawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pCurrentGroup->stripsOffset().at(i));
 				}
 			}
 			else if ((NULL != pMaterialHash) && pMaterialHash->contains(currentPrimitiveId))
@@ -869,7 +965,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 						pCurrentLocalMaterial= pMat;
 						pCurrentLocalMaterial->glExecute();
 					}
-					glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->stripsOffset().at(i));
+					drawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pCurrentGroup->stripsOffset().at(i));
 				}
 
 			}
@@ -880,7 +976,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 					pCurrentLocalMaterial= pCurrentMaterial;
 					pCurrentLocalMaterial->glExecute();
 				}
-				glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->stripsOffset().at(i));
+				drawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pCurrentGroup->stripsOffset().at(i));
 			}
 		}
 	}
@@ -899,7 +995,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 				{
 					GLC_SelectionMaterial::glExecute();
 					pCurrentLocalMaterial= NULL;
-					glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->fansOffset().at(i));
+					drawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pCurrentGroup->fansOffset().at(i));
 				}
 			}
 			else if ((NULL != pMaterialHash) && pMaterialHash->contains(currentPrimitiveId))
@@ -912,7 +1008,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 						pCurrentLocalMaterial= pMat;
 						pCurrentLocalMaterial->glExecute();
 					}
-					glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->fansOffset().at(i));
+					drawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pCurrentGroup->fansOffset().at(i));
 				}
 
 			}
@@ -923,7 +1019,7 @@ void GLC_Mesh::vboDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCurrentGrou
 					pCurrentLocalMaterial= pCurrentMaterial;
 					pCurrentLocalMaterial->glExecute();
 				}
-				glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pCurrentGroup->fansOffset().at(i));
+				drawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pCurrentGroup->fansOffset().at(i));
 			}
 		}
 	}
@@ -959,7 +1055,7 @@ void GLC_Mesh::vertexArrayDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCur
 					GLC_SelectionMaterial::glExecute();
 					pCurrentLocalMaterial= NULL;
 					GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->trianglesGroupOffseti().at(i)];
-					glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pOffset);
+					drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), pOffset);
 				}
 			}
 			else if ((NULL != pMaterialHash) && pMaterialHash->contains(currentPrimitiveId))
@@ -973,7 +1069,7 @@ void GLC_Mesh::vertexArrayDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCur
 						pCurrentLocalMaterial->glExecute();
 					}
 					GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->trianglesGroupOffseti().at(i)];
-					glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pOffset);
+					drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), pOffset);
 				}
 
 			}
@@ -985,7 +1081,7 @@ void GLC_Mesh::vertexArrayDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCur
 					pCurrentLocalMaterial->glExecute();
 				}
 				GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->trianglesGroupOffseti().at(i)];
-				glDrawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), GL_UNSIGNED_INT, pOffset);
+				drawElements(GL_TRIANGLES, pCurrentGroup->trianglesIndexSizes().at(i), pOffset);
 			}
 		}
 	}
@@ -1005,7 +1101,7 @@ void GLC_Mesh::vertexArrayDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCur
 					GLC_SelectionMaterial::glExecute();
 					pCurrentLocalMaterial= NULL;
 					GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->stripsOffseti().at(i)];
-					glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pOffset);
+					drawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pOffset);
 				}
 			}
 			else if ((NULL != pMaterialHash) && pMaterialHash->contains(currentPrimitiveId))
@@ -1019,7 +1115,7 @@ void GLC_Mesh::vertexArrayDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCur
 						pCurrentLocalMaterial->glExecute();
 					}
 					GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->stripsOffseti().at(i)];
-					glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pOffset);
+					drawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pOffset);
 				}
 
 			}
@@ -1031,7 +1127,7 @@ void GLC_Mesh::vertexArrayDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCur
 					pCurrentLocalMaterial->glExecute();
 				}
 				GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->stripsOffseti().at(i)];
-				glDrawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), GL_UNSIGNED_INT, pOffset);
+				drawElements(GL_TRIANGLE_STRIP, pCurrentGroup->stripsSizes().at(i), pOffset);
 			}
 		}
 	}
@@ -1051,7 +1147,7 @@ void GLC_Mesh::vertexArrayDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCur
 					GLC_SelectionMaterial::glExecute();
 					pCurrentLocalMaterial= NULL;
 					GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->fansOffseti().at(i)];
-					glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pOffset);
+					drawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pOffset);
 				}
 			}
 			else if ((NULL != pMaterialHash) && pMaterialHash->contains(currentPrimitiveId))
@@ -1065,7 +1161,7 @@ void GLC_Mesh::vertexArrayDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCur
 						pCurrentLocalMaterial->glExecute();
 					}
 					GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->fansOffseti().at(i)];
-					glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pOffset);
+					drawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pOffset);
 				}
 
 			}
@@ -1077,7 +1173,7 @@ void GLC_Mesh::vertexArrayDrawSelectedPrimitivesGroupOf(GLC_PrimitiveGroup* pCur
 					pCurrentLocalMaterial->glExecute();
 				}
 				GLvoid* pOffset= &m_MeshData.indexVectorHandle(m_CurrentLod)->data()[pCurrentGroup->fansOffseti().at(i)];
-				glDrawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), GL_UNSIGNED_INT, pOffset);
+				drawElements(GL_TRIANGLE_FAN, pCurrentGroup->fansSizes().at(i), pOffset);
 			}
 		}
 	}
@@ -0,0 +1,192 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_meshbvh.cpp implementation of the GLC_MeshBvh class.
+
+#include "glc_meshbvh.h"
+#include "glc_mesh.h"
+
+// Test the ray against the triangles of the visited slots and keep the nearest hit
+struct GLC_MeshBvhVisitor
+{
+	const double* m_pOrigin;
+	const double* m_pDirection;
+	const float* m_pPositions;
+	const GLuint* m_pIndex;
+	int m_Slot;
+
+	inline void operator()(int slot, double* pMaxDistance)
+	{
+		const GLuint* pTriangle= m_pIndex + (slot * 3);
+		if (GLC_MeshBvh::intersectTriangle(m_pOrigin, m_pDirection, m_pPositions + (pTriangle[0] * 3)
+				, m_pPositions + (pTriangle[1] * 3), m_pPositions + (pTriangle[2] * 3), pMaxDistance))
+		{
+			m_Slot= slot;
+		}
+	}
+};
+
+GLC_MeshBvh::GLC_MeshBvh()
+: m_Positions()
+, m_Index()
+, m_PrimitiveIds()
+, m_Bvh()
+{
+
+}
+
+GLC_MeshBvh::GLC_MeshBvh(const GLC_Mesh& mesh, int lod)
+: m_Positions()
+, m_Index()
+, m_PrimitiveIds()
+, m_Bvh()
+{
+	build(mesh, lod);
+}
+
+qint64 GLC_MeshBvh::memorySize() const
+{
+	qint64 subject= m_Positions.size() * sizeof(GLfloat);
+	subject+= m_Index.size() * sizeof(GLuint);
+	subject+= m_PrimitiveIds.size() * sizeof(GLC_uint);
+	subject+= m_Bvh.nodes().size() * sizeof(GLC_Bvh::Node);
+	subject+= m_Bvh.slots().size() * sizeof(int);
+	return subject;
+}
+
+bool GLC_MeshBvh::intersect(const double origin[3], const double direction[3], double* pDistance, GLC_uint* pPrimitiveId) const
+{
+	GLC_MeshBvhVisitor visitor;
+	visitor.m_pOrigin= origin;
+	visitor.m_pDirection= direction;
+	visitor.m_pPositions= m_Positions.constData();
+	visitor.m_pIndex= m_Index.constData();
+	visitor.m_Slot= -1;
+
+	m_Bvh.raycast(origin, direction, pDistance, visitor);
+
+	const bool subject= (visitor.m_Slot >= 0);
+	if (subject && (NULL != pPrimitiveId))
+	{
+		*pPrimitiveId= m_PrimitiveIds.at(visitor.m_Slot);
+	}
+	return subject;
+}
+
+bool GLC_MeshBvh::intersectTriangle(const double origin[3], const double direction[3], const float* p0, const float* p1, const float* p2, double* pDistance)
+{
+	const double edge1[3]= {p1[0] - static_cast<double>(p0[0]), p1[1] - static_cast<double>(p0[1]), p1[2] - static_cast<double>(p0[2])};
+	const double edge2[3]= {p2[0] - static_cast<double>(p0[0]), p2[1] - static_cast<double>(p0[1]), p2[2] - static_cast<double>(p0[2])};
+
+	// p= direction ^ edge2
+	const double p[3]= {direction[1] * edge2[2] - direction[2] * edge2[1]
+					  , direction[2] * edge2[0] - direction[0] * edge2[2]
+					  , direction[0] * edge2[1] - direction[1] * edge2[0]};
+	const double determinant= edge1[0] * p[0] + edge1[1] * p[1] + edge1[2] * p[2];
+
+	// The ray is parallel to the triangle plane
+	if (qAbs(determinant) < 1e-300) return false;
+	const double inverse= 1.0 / determinant;
+
+	const double s[3]= {origin[0] - p0[0], origin[1] - p0[1], origin[2] - p0[2]};
+	const double u= (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverse;
+	if ((u < 0.0) || (u > 1.0)) return false;
+
+	// q= s ^ edge1
+	const double q[3]= {s[1] * edge1[2] - s[2] * edge1[1]
+					  , s[2] * edge1[0] - s[0] * edge1[2]
+					  , s[0] * edge1[1] - s[1] * edge1[0]};
+	const double v= (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * inverse;
+	if ((v < 0.0) || ((u + v) > 1.0)) return false;
+
+	const double distance= (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]) * inverse;
+	if ((distance < 0.0) || (distance > *pDistance)) return false;
+
+	*pDistance= distance;
+	return true;
+}
+
+void GLC_MeshBvh::build(const GLC_Mesh& mesh, int lod)
+{
+	QVector<GLC_uint> primitiveIds;
+	const QVector<GLuint> index= mesh.getEquivalentTrianglesIndex(lod, &primitiveIds);
+	build(mesh.positionVector(), index, primitiveIds);
+}
+
+void GLC_MeshBvh::build(const GLfloatVector& positions, const QVector<GLuint>& index, const QVector<GLC_uint>& primitiveIds)
+{
+	clear();
+	Q_ASSERT((index.size() % 3) == 0);
+	Q_ASSERT(primitiveIds.size() == (index.size() / 3));
+
+	const int vertexCount= positions.size() / 3;
+	const int triangleCount= index.size() / 3;
+	const float* pPositions= positions.constData();
+
+	// The boxes of the valid triangles
+	QVector<float> boxes;
+	boxes.reserve(triangleCount * 6);
+	QVector<int> triangles;
+	triangles.reserve(triangleCount);
+	for (int i= 0; i < triangleCount; ++i)
+	{
+		const GLuint* pTriangle= index.constData() + (i * 3);
+		if ((pTriangle[0] >= static_cast<GLuint>(vertexCount)) || (pTriangle[1] >= static_cast<GLuint>(vertexCount))
+				|| (pTriangle[2] >= static_cast<GLuint>(vertexCount))) continue;
+
+		const float* p0= pPositions + (pTriangle[0] * 3);
+		const float* p1= pPositions + (pTriangle[1] * 3);
+		const float* p2= pPositions + (pTriangle[2] * 3);
+		for (int axis= 0; axis < 3; ++axis)
+		{
+			boxes.append(qMin(p0[axis], qMin(p1[axis], p2[axis])));
+		}
+		for (int axis= 0; axis < 3; ++axis)
+		{
+			boxes.append(qMax(p0[axis], qMax(p1[axis], p2[axis])));
+		}
+		triangles.append(i);
+	}
+
+	m_Bvh.build(boxes);
+
+	// Store the triangles in the order of the hierarchy slots
+	const int slotCount= m_Bvh.itemCount();
+	m_Index.resize(slotCount * 3);
+	m_PrimitiveIds.resize(slotCount);
+	for (int slot= 0; slot < slotCount; ++slot)
+	{
+		const int triangle= triangles.at(m_Bvh.item(slot));
+		m_Index[slot * 3]= index.at(triangle * 3);
+		m_Index[slot * 3 + 1]= index.at(triangle * 3 + 1);
+		m_Index[slot * 3 + 2]= index.at(triangle * 3 + 2);
+		m_PrimitiveIds[slot]= primitiveIds.at(triangle);
+	}
+	m_Positions= positions;
+}
+
+void GLC_MeshBvh::clear()
+{
+	m_Positions.clear();
+	m_Index.clear();
+	m_PrimitiveIds.clear();
+	m_Bvh.clear();
+}
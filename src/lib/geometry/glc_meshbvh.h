@@ -0,0 +1,140 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_meshbvh.h interface for the GLC_MeshBvh class.
+
+#ifndef GLC_MESHBVH_H_
+#define GLC_MESHBVH_H_
+
+#include <QVector>
+
+#include "glc_bvh.h"
+#include "../glc_global.h"
+
+#include "../glc_config.h"
+
+class GLC_Mesh;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_MeshBvh
+/*! \brief GLC_MeshBvh : Triangles bounding volume hierarchy of a mesh */
+
+/*! The hierarchy is built in the mesh coordinates from the triangles, strips
+ *  and fans of a mesh LOD. Each triangle keeps the id of its primitive,
+ *  the id used by GLC_Mesh in primitive selection mode.
+ *  Triangles are stored in the order of the hierarchy leaves.
+ *
+ *  Once built the hierarchy doesn't depend on the mesh and can be used
+ *  from any thread.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_MeshBvh
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct an empty hierarchy
+	GLC_MeshBvh();
+
+	//! Construct the hierarchy of the given LOD of the given mesh
+	/*! The mesh client side data must not have been released, use GLC_Mesh::meshBvh() otherwise*/
+	explicit GLC_MeshBvh(const GLC_Mesh& mesh, int lod= 0);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return true if this hierarchy is empty
+	inline bool isEmpty() const
+	{return m_Bvh.isEmpty();}
+
+	//! Return the number of triangles of this hierarchy
+	inline int triangleCount() const
+	{return m_PrimitiveIds.size();}
+
+	//! Return the hierarchy of triangles boxes
+	inline const GLC_Bvh& bvh() const
+	{return m_Bvh;}
+
+	//! Return the vertices positions, 3 floats per vertex
+	inline const GLfloatVector& positions() const
+	{return m_Positions;}
+
+	//! Return the triangles vertices index ordered by slot, 3 index per triangle
+	inline const QVector<GLuint>& trianglesIndex() const
+	{return m_Index;}
+
+	//! Return the triangles primitive id ordered by slot
+	inline const QVector<GLC_uint>& primitiveIds() const
+	{return m_PrimitiveIds;}
+
+	//! Return the estimated memory size of this hierarchy in bytes
+	qint64 memorySize() const;
+
+	//! Return true if the given ray hits a triangle before the given distance
+	/*! On hit, the distance is set to the hit distance in units of the direction length
+	 *  and the primitive id is set to the id of the hit triangle*/
+	bool intersect(const double origin[3], const double direction[3], double* pDistance, GLC_uint* pPrimitiveId) const;
+
+	//! Return true if the given ray hits the given triangle before the given distance and set the distance
+	/*! Both faces are tested with the Moller Trumbore algorithm*/
+	static bool intersectTriangle(const double origin[3], const double direction[3], const float* p0, const float* p1, const float* p2, double* pDistance);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Build the hierarchy of the given LOD of the given mesh
+	void build(const GLC_Mesh& mesh, int lod= 0);
+
+	//! Build the hierarchy of the given triangles
+	/*! positions contains 3 floats per vertex, index 3 vertices per triangle and
+	 *  primitiveIds one id per triangle*/
+	void build(const GLfloatVector& positions, const QVector<GLuint>& index, const QVector<GLC_uint>& primitiveIds);
+
+	//! Remove all triangles of this hierarchy
+	void clear();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The vertices positions
+	GLfloatVector m_Positions;
+
+	//! The triangles vertices index ordered by slot
+	QVector<GLuint> m_Index;
+
+	//! The triangles primitive id ordered by slot
+	QVector<GLC_uint> m_PrimitiveIds;
+
+	//! The hierarchy of the triangles boxes
+	GLC_Bvh m_Bvh;
+};
+
+#endif /* GLC_MESHBVH_H_ */
@@ -24,8 +24,30 @@
 
 #include "../glc_exception.h"
 #include "glc_meshdata.h"
+#include "glc_bsrep.h"
 #include "../glc_state.h"
 #include "../glc_contextmanager.h"
+#include "../glc_frameprofiler.h"
+
+// Append the block of the given vector to the given blocks and return its index, -1 if the vector is empty
+template <typename T>
+static qint32 appendBlock(const QVector<T>& vector, QList<QByteArray>* pBlocks)
+{
+	if (vector.isEmpty()) return -1;
+	pBlocks->append(GLC_BSRep::blockOfVector(vector));
+	return pBlocks->size() - 1;
+}
+
+// Set the given vector from the block of the given index and return true on success
+template <typename T>
+static bool readBlock(qint32 index, const QList<QByteArray>& blocks, QVector<T>* pVector)
+{
+	pVector->clear();
+	if (-1 == index) return true;
+	if ((index < 0) || (index >= blocks.size())) return false;
+	GLC_BSRep::vectorOfBlock(blocks.at(index), pVector);
+	return true;
+}
 
 // Class chunk id
 quint32 GLC_MeshData::m_ChunkId= 0xA704;
@@ -451,6 +473,7 @@ void GLC_MeshData::fillVbo(GLC_MeshData::VboType type)
 		const GLsizei dataNbr= static_cast<GLsizei>(m_Positions.size());
 		const GLsizeiptr dataSize= dataNbr * sizeof(GLfloat);
 		m_VertexBuffer.allocate(m_Positions.data(), dataSize);
+		GLC_FrameProfiler::addUploadBytes(dataSize);
 
 		m_PositionSize= m_Positions.size();
 		m_Positions.clear();
@@ -461,6 +484,7 @@ void GLC_MeshData::fillVbo(GLC_MeshData::VboType type)
 		const GLsizei dataNbr= static_cast<GLsizei>(m_Normals.size());
 		const GLsizeiptr dataSize= dataNbr * sizeof(GLfloat);
 		m_NormalBuffer.allocate(m_Normals.data(), dataSize);
+		GLC_FrameProfiler::addUploadBytes(dataSize);
 
 		m_Normals.clear();
 	}
@@ -470,6 +494,7 @@ void GLC_MeshData::fillVbo(GLC_MeshData::VboType type)
 		const GLsizei dataNbr= static_cast<GLsizei>(m_Texels.size());
 		const GLsizeiptr dataSize= dataNbr * sizeof(GLfloat);
 		m_TexelBuffer.allocate(m_Texels.data(), dataSize);
+		GLC_FrameProfiler::addUploadBytes(dataSize);
 
 		m_TexelsSize= m_Texels.size();
 		m_Texels.clear();
@@ -480,6 +505,7 @@ void GLC_MeshData::fillVbo(GLC_MeshData::VboType type)
 		const GLsizei dataNbr= static_cast<GLsizei>(m_Colors.size());
 		const GLsizeiptr dataSize= dataNbr * sizeof(GLfloat);
 		m_ColorBuffer.allocate(m_Colors.data(), dataSize);
+		GLC_FrameProfiler::addUploadBytes(dataSize);
 
 		m_ColorSize= m_Colors.size();
 		m_Colors.clear();
@@ -494,6 +520,69 @@ void GLC_MeshData::fillLodIbo()
 		m_LodList.at(i)->fillIbo();
 	}
 }
+//////////////////////////////////////////////////////////////////////
+// Binary serialisation Functions
+//////////////////////////////////////////////////////////////////////
+
+// Save the mesh data to the given stream, vertex attributes and LODs index are appended to the given blocks
+void GLC_MeshData::saveToDataStream(QDataStream& stream, QList<QByteArray>* pBlocks) const
+{
+	quint32 chunckId= m_ChunkId;
+	stream << chunckId;
+
+	stream << appendBlock(positionVector(), pBlocks);
+	stream << appendBlock(normalVector(), pBlocks);
+	stream << appendBlock(texelVector(), pBlocks);
+	stream << appendBlock(colorVector(), pBlocks);
+
+	const int lodCount= m_LodList.size();
+	stream << lodCount;
+	for (int i= 0; i < lodCount; ++i)
+	{
+		const GLC_Lod* pLod= m_LodList.at(i);
+		stream << pLod->accuracy();
+		stream << static_cast<quint32>(pLod->trianglesCount());
+		stream << appendBlock(pLod->indexVector(), pBlocks);
+	}
+}
+
+// Load the mesh data from the given stream and blocks
+void GLC_MeshData::loadFromDataStream(QDataStream& stream, const QList<QByteArray>& blocks)
+{
+	quint32 chunckId;
+	stream >> chunckId;
+	Q_ASSERT(chunckId == m_ChunkId);
+
+	clear();
+
+	qint32 positionBlock, normalBlock, texelBlock, colorBlock;
+	stream >> positionBlock >> normalBlock >> texelBlock >> colorBlock;
+	bool blocksOk= readBlock(positionBlock, blocks, &m_Positions);
+	blocksOk= blocksOk && readBlock(normalBlock, blocks, &m_Normals);
+	blocksOk= blocksOk && readBlock(texelBlock, blocks, &m_Texels);
+	blocksOk= blocksOk && readBlock(colorBlock, blocks, &m_Colors);
+
+	int lodCount;
+	stream >> lodCount;
+	for (int i= 0; blocksOk && (i < lodCount) && (stream.status() == QDataStream::Ok); ++i)
+	{
+		double accuracy;
+		quint32 trianglesCount;
+		qint32 indexBlock;
+		stream >> accuracy >> trianglesCount >> indexBlock;
+
+		GLC_Lod* pLod= new GLC_Lod(accuracy);
+		pLod->trianglesAdded(trianglesCount);
+		blocksOk= readBlock(indexBlock, blocks, pLod->indexVectorHandle());
+		m_LodList.append(pLod);
+	}
+
+	if (!blocksOk)
+	{
+		stream.setStatus(QDataStream::ReadCorruptData);
+	}
+}
+
 // Non Member methods
 // Non-member stream operator
 QDataStream &operator<<(QDataStream &stream, const GLC_MeshData &meshData)
@@ -159,6 +159,13 @@ public:
 	inline bool positionSizeIsSet() const
 	{return m_PositionSize != -1;}
 
+	//! Return true if the positions and the index of the given LOD can be read without the OpenGL buffers
+	inline bool clientSideIsAvailable(int lod) const
+	{
+		const bool positionsAvailable= !m_VertexBuffer.isCreated() || !m_Positions.isEmpty();
+		return positionsAvailable && ((lod >= m_LodList.size()) || m_LodList.at(lod)->indexIsOnClientSide());
+	}
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -199,6 +206,19 @@ public:
 
 //@}
 
+//////////////////////////////////////////////////////////////////////
+/*! \name Binary serialisation Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Save the mesh data to the given stream, vertex attributes and LODs index are appended to the given blocks
+	void saveToDataStream(QDataStream& stream, QList<QByteArray>* pBlocks) const;
+
+	//! Load the mesh data from the given stream and blocks
+	void loadFromDataStream(QDataStream& stream, const QList<QByteArray>& blocks);
+
+//@}
+
 //////////////////////////////////////////////////////////////////////
 /*! \name OpenGL Functions*/
 //@{
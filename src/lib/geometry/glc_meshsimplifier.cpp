@@ -0,0 +1,770 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_meshsimplifier.cpp implementation of the GLC_MeshSimplifier class.
+
+#include "glc_meshsimplifier.h"
+#include "glc_mesh.h"
+#include "glc_3drep.h"
+#include "../sceneGraph/glc_world.h"
+#include "../sceneGraph/glc_structreference.h"
+#include "../glc_state.h"
+#include "../maths/glc_utils_maths.h"
+
+#include <QSet>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <string.h>
+
+// Weight of the planes which keep feature edges in place
+static const double featureEdgeWeight= 10.0;
+
+// Vertex kinds
+enum VertexKind
+{
+	ManifoldVertex,
+	BorderVertex,
+	LockedVertex
+};
+
+//! Quadric of the squared distance to a set of weighted planes
+struct GLC_MeshSimplifier::Quadric
+{
+	Quadric()
+	: m_Weight(0.0)
+	{
+		for (int i= 0; i < 10; ++i) m_Values[i]= 0.0;
+	}
+	//! a², ab, ac, ad, b², bc, bd, c², cd, d²
+	double m_Values[10];
+	//! Sum of the planes weight
+	double m_Weight;
+};
+
+//! Triangles and vertices of a mesh during simplification
+struct GLC_MeshSimplifier::WorkingMesh
+{
+	//! The number of position class (vertices sharing the same position)
+	int m_ClassCount;
+	//! The position of each class
+	QVector<double> m_ClassPositions;
+	//! The quadric of each class
+	QVector<Quadric> m_Quadrics;
+	//! The class of each wedge (vertices of a class with continuous attributes)
+	QVector<int> m_WedgeClass;
+	//! The vertex used for each wedge
+	QVector<GLuint> m_WedgeVertex;
+	//! The vertex of each triangle corner
+	QVector<GLuint> m_Corners;
+	//! The wedge of each triangle corner
+	QVector<int> m_CornerWedges;
+	//! The material index of each triangle
+	QVector<int> m_TriangleMaterial;
+	//! The removed flag of each triangle
+	QVector<char> m_TriangleRemoved;
+	//! The number of material
+	int m_MaterialCount;
+	//! The number of triangles not removed
+	int m_LiveTriangleCount;
+};
+
+// Half edge of the working mesh sorted by position classes
+struct HalfEdge
+{
+	quint64 m_Key;
+	int m_Corner;
+	inline bool operator<(const HalfEdge& other) const
+	{return (m_Key < other.m_Key) || ((m_Key == other.m_Key) && (m_Corner < other.m_Corner));}
+};
+
+// Add a weighted plane to the given quadric
+static inline void addPlane(GLC_MeshSimplifier::Quadric* pQuadric, double a, double b, double c, double d, double weight)
+{
+	double* q= pQuadric->m_Values;
+	q[0]+= weight * a * a;
+	q[1]+= weight * a * b;
+	q[2]+= weight * a * c;
+	q[3]+= weight * a * d;
+	q[4]+= weight * b * b;
+	q[5]+= weight * b * c;
+	q[6]+= weight * b * d;
+	q[7]+= weight * c * c;
+	q[8]+= weight * c * d;
+	q[9]+= weight * d * d;
+	pQuadric->m_Weight+= weight;
+}
+
+// Return the class of the given corner
+static inline int cornerClass(const GLC_MeshSimplifier::WorkingMesh* pMesh, int corner)
+{
+	return pMesh->m_WedgeClass.at(pMesh->m_CornerWedges.at(corner));
+}
+
+// Return the next corner of the triangle
+static inline int nextCorner(int corner)
+{
+	return ((corner % 3) == 2) ? corner - 2 : corner + 1;
+}
+
+// Return the normal of the triangle defined by the given points (not normalized)
+static inline void triangleNormal(const double* p0, const double* p1, const double* p2, double* pNormal)
+{
+	const double e1[3]= {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+	const double e2[3]= {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+	pNormal[0]= e1[1] * e2[2] - e1[2] * e2[1];
+	pNormal[1]= e1[2] * e2[0] - e1[0] * e2[2];
+	pNormal[2]= e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+// Return the quadric error of the given quadrics sum at the given position normalized by their weight
+static double collapseError(const GLC_MeshSimplifier::Quadric& q1, const GLC_MeshSimplifier::Quadric& q2, const double* p)
+{
+	double q[10];
+	for (int i= 0; i < 10; ++i) q[i]= q1.m_Values[i] + q2.m_Values[i];
+	const double x= p[0];
+	const double y= p[1];
+	const double z= p[2];
+	const double error= q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x
+			+ q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y
+			+ q[7] * z * z + 2.0 * q[8] * z
+			+ q[9];
+	const double weight= q1.m_Weight + q2.m_Weight;
+	if ((error <= 0.0) || (weight <= 0.0)) return 0.0;
+	else return sqrt(error / weight);
+}
+
+// Return the hash of the given position
+static inline uint positionHash(const GLfloat* p)
+{
+	uint hash= 0;
+	for (int i= 0; i < 3; ++i)
+	{
+		// Adding 0.0f gives the same bits to 0.0f and -0.0f
+		const GLfloat value= p[i] + 0.0f;
+		uint bits;
+		memcpy(&bits, &value, sizeof(uint));
+		hash= (hash ^ bits) * 16777619u;
+	}
+	return hash ^ (hash >> 15);
+}
+
+// Fill the sorted half edges of the live triangles
+static void buildHalfEdges(const GLC_MeshSimplifier::WorkingMesh* pMesh, QVector<HalfEdge>* pHalfEdges)
+{
+	pHalfEdges->clear();
+	pHalfEdges->reserve(pMesh->m_LiveTriangleCount * 3);
+	const int triangleCount= pMesh->m_TriangleRemoved.size();
+	for (int t= 0; t < triangleCount; ++t)
+	{
+		if (pMesh->m_TriangleRemoved.at(t)) continue;
+		for (int k= 0; k < 3; ++k)
+		{
+			const int corner= t * 3 + k;
+			const quint64 a= static_cast<quint64>(cornerClass(pMesh, corner));
+			const quint64 b= static_cast<quint64>(cornerClass(pMesh, nextCorner(corner)));
+			HalfEdge halfEdge;
+			halfEdge.m_Key= (a < b) ? ((a << 32) | b) : ((b << 32) | a);
+			halfEdge.m_Corner= corner;
+			pHalfEdges->append(halfEdge);
+		}
+	}
+	std::sort(pHalfEdges->begin(), pHalfEdges->end());
+}
+
+// Return true if the edge made of the given half edges is a feature edge
+/*! An edge is a feature edge if it's an open border, a material boundary, a seam
+ *  or if its triangles are not consistently oriented. pNonManifold is set to true
+ *  if the edge is shared by more than 2 triangles*/
+static bool isFeatureEdge(const GLC_MeshSimplifier::WorkingMesh* pMesh, const HalfEdge* pFirst, int count, bool* pNonManifold)
+{
+	*pNonManifold= (count > 2);
+	if (2 != count) return true;
+
+	const int corner0= pFirst[0].m_Corner;
+	const int corner1= pFirst[1].m_Corner;
+	if (pMesh->m_TriangleMaterial.at(corner0 / 3) != pMesh->m_TriangleMaterial.at(corner1 / 3)) return true;
+
+	// The two half edges must be opposite and use the same wedges
+	const int next0= nextCorner(corner0);
+	const int next1= nextCorner(corner1);
+	if (cornerClass(pMesh, corner0) != cornerClass(pMesh, next1)) return true;
+	return (pMesh->m_CornerWedges.at(corner0) != pMesh->m_CornerWedges.at(next1))
+			|| (pMesh->m_CornerWedges.at(next0) != pMesh->m_CornerWedges.at(corner1));
+}
+
+//////////////////////////////////////////////////////////////////////
+// Constructor
+//////////////////////////////////////////////////////////////////////
+GLC_MeshSimplifier::GLC_MeshSimplifier()
+: m_TargetRatios(GLC_State::automaticLodRatios())
+, m_MaximumErrors()
+, m_CreaseAngle(45.0)
+{
+
+}
+
+GLC_MeshSimplifier::GLC_MeshSimplifier(const QList<double>& targetRatios, const QList<double>& maximumErrors)
+: m_TargetRatios(targetRatios)
+, m_MaximumErrors(maximumErrors)
+, m_CreaseAngle(45.0)
+{
+
+}
+
+//////////////////////////////////////////////////////////////////////
+// Get Functions
+//////////////////////////////////////////////////////////////////////
+
+// Simplify the given triangles at each target ratio
+void GLC_MeshSimplifier::simplify(const GLfloatVector& positions, const GLfloatVector& normals, const GLfloatVector& texels
+		, const QList<IndexList>& trianglesIndex, QList<QList<IndexList> >* pLods, QList<double>* pErrors) const
+{
+	WorkingMesh mesh;
+	initialize(&mesh, positions, normals, texels, trianglesIndex);
+
+	const int initialCount= mesh.m_LiveTriangleCount;
+	int previousCount= initialCount;
+	double reachedError= 0.0;
+	const int lodCount= m_TargetRatios.size();
+	for (int lod= 0; (lod < lodCount) && (previousCount > 1); ++lod)
+	{
+		const int targetCount= qMax(1, static_cast<int>(static_cast<double>(initialCount) * m_TargetRatios.at(lod)));
+		const double maximumError= (lod < m_MaximumErrors.size()) ? m_MaximumErrors.at(lod) : 0.0;
+
+		bool collapsed= true;
+		while (collapsed && (mesh.m_LiveTriangleCount > targetCount))
+		{
+			collapsed= (collapsePass(&mesh, targetCount, maximumError, &reachedError) > 0);
+		}
+
+		// Stop if this LOD doesn't remove any triangles
+		if (mesh.m_LiveTriangleCount >= previousCount) break;
+		previousCount= mesh.m_LiveTriangleCount;
+
+		QList<IndexList> lodIndex;
+		for (int i= 0; i < mesh.m_MaterialCount; ++i)
+		{
+			lodIndex.append(IndexList());
+		}
+		const int triangleCount= mesh.m_TriangleRemoved.size();
+		for (int t= 0; t < triangleCount; ++t)
+		{
+			if (mesh.m_TriangleRemoved.at(t)) continue;
+			IndexList& currentIndex= lodIndex[mesh.m_TriangleMaterial.at(t)];
+			currentIndex.append(mesh.m_Corners.at(t * 3));
+			currentIndex.append(mesh.m_Corners.at(t * 3 + 1));
+			currentIndex.append(mesh.m_Corners.at(t * 3 + 2));
+		}
+		pLods->append(lodIndex);
+		pErrors->append(reachedError);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// Set Functions
+//////////////////////////////////////////////////////////////////////
+
+// Add LODs to the given mesh and return the number of added LOD
+int GLC_MeshSimplifier::generateLods(GLC_Mesh* pMesh) const
+{
+	return pMesh->generateLods(*this);
+}
+
+// Add LODs to the meshes of the given representation
+void GLC_MeshSimplifier::generateLods(const GLC_3DRep& rep) const
+{
+	const int bodyCount= rep.numberOfBody();
+	for (int i= 0; i < bodyCount; ++i)
+	{
+		GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(rep.geomAt(i));
+		if (NULL != pMesh)
+		{
+			generateLods(pMesh);
+		}
+	}
+}
+
+// Add LODs to the given meshes on worker threads
+void GLC_MeshSimplifier::generateLods(const QList<GLC_Mesh*>& meshes) const
+{
+	const int meshCount= meshes.size();
+	QVector<LodTask> tasks(meshCount);
+	for (int i= 0; i < meshCount; ++i)
+	{
+		tasks[i].m_pSimplifier= this;
+		tasks[i].m_pMesh= meshes.at(i);
+	}
+	QtConcurrent::blockingMap(tasks, &GLC_MeshSimplifier::generateTaskLods);
+}
+
+// Add LODs to the meshes of the given world on worker threads
+void GLC_MeshSimplifier::generateLods(const GLC_World& world) const
+{
+	// Meshes can be shared by representations
+	QList<GLC_Mesh*> meshes;
+	QSet<GLC_Mesh*> meshSet;
+	const QList<GLC_StructReference*> references= world.references();
+	const int referenceCount= references.size();
+	for (int i= 0; i < referenceCount; ++i)
+	{
+		GLC_StructReference* pReference= references.at(i);
+		if (!pReference->hasRepresentation()) continue;
+		GLC_3DRep* pRep= dynamic_cast<GLC_3DRep*>(pReference->representationHandle());
+		if (NULL == pRep) continue;
+
+		const int bodyCount= pRep->numberOfBody();
+		for (int iBody= 0; iBody < bodyCount; ++iBody)
+		{
+			GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pRep->geomAt(iBody));
+			if ((NULL != pMesh) && !meshSet.contains(pMesh))
+			{
+				meshSet.insert(pMesh);
+				meshes.append(pMesh);
+			}
+		}
+	}
+	generateLods(meshes);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+// Initialize the working mesh from the given data
+void GLC_MeshSimplifier::initialize(WorkingMesh* pMesh, const GLfloatVector& positions, const GLfloatVector& normals
+		, const GLfloatVector& texels, const QList<IndexList>& trianglesIndex) const
+{
+	const int vertexCount= positions.size() / 3;
+	const bool hasNormals= (normals.size() == (vertexCount * 3));
+	const bool hasTexels= (texels.size() == (vertexCount * 2));
+	const GLfloat* pPositions= positions.constData();
+
+	// Vertices with the same position belong to the same class
+	QVector<int> vertexClass(vertexCount, -1);
+	int slotCount= 16;
+	while (slotCount < (vertexCount * 2)) slotCount*= 2;
+	const uint mask= static_cast<uint>(slotCount - 1);
+	QVector<int> slots(slotCount, -1);
+	QVector<int> classVertex;
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		const GLfloat* p= pPositions + i * 3;
+		uint slot= positionHash(p) & mask;
+		while (-1 != slots.at(slot))
+		{
+			const GLfloat* pOther= pPositions + classVertex.at(slots.at(slot)) * 3;
+			if ((p[0] == pOther[0]) && (p[1] == pOther[1]) && (p[2] == pOther[2])) break;
+			slot= (slot + 1) & mask;
+		}
+		if (-1 == slots.at(slot))
+		{
+			slots[slot]= classVertex.size();
+			classVertex.append(i);
+		}
+		vertexClass[i]= slots.at(slot);
+	}
+	slots.clear();
+
+	pMesh->m_ClassCount= classVertex.size();
+	pMesh->m_ClassPositions.resize(pMesh->m_ClassCount * 3);
+	for (int c= 0; c < pMesh->m_ClassCount; ++c)
+	{
+		for (int k= 0; k < 3; ++k)
+		{
+			pMesh->m_ClassPositions[c * 3 + k]= pPositions[classVertex.at(c) * 3 + k];
+		}
+	}
+
+	// Vertices of a class with the same texel and close normals belong to the same wedge
+	const double creaseCosine= cos(m_CreaseAngle * glc::PI / 180.0);
+	QVector<int> vertexWedge(vertexCount, -1);
+	QVector<int> classFirstWedge(pMesh->m_ClassCount, -1);
+	QVector<int> nextClassWedge;
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		const int currentClass= vertexClass.at(i);
+		int wedge= classFirstWedge.at(currentClass);
+		while (-1 != wedge)
+		{
+			const int other= static_cast<int>(pMesh->m_WedgeVertex.at(wedge));
+			bool continuous= true;
+			if (hasTexels)
+			{
+				continuous= (texels.at(i * 2) == texels.at(other * 2)) && (texels.at(i * 2 + 1) == texels.at(other * 2 + 1));
+			}
+			if (continuous && hasNormals)
+			{
+				const GLfloat* n1= normals.constData() + i * 3;
+				const GLfloat* n2= normals.constData() + other * 3;
+				const double dot= n1[0] * n2[0] + n1[1] * n2[1] + n1[2] * n2[2];
+				const double length= sqrt((n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]) * (n2[0] * n2[0] + n2[1] * n2[1] + n2[2] * n2[2]));
+				continuous= (length > 0.0) ? (dot >= (creaseCosine * length)) : (dot == length);
+			}
+			if (continuous) break;
+			wedge= nextClassWedge.at(wedge);
+		}
+		if (-1 == wedge)
+		{
+			wedge= pMesh->m_WedgeVertex.size();
+			pMesh->m_WedgeVertex.append(static_cast<GLuint>(i));
+			pMesh->m_WedgeClass.append(currentClass);
+			nextClassWedge.append(classFirstWedge.at(currentClass));
+			classFirstWedge[currentClass]= wedge;
+		}
+		vertexWedge[i]= wedge;
+	}
+
+	// Copy the triangles, degenerated ones are skipped
+	pMesh->m_MaterialCount= trianglesIndex.size();
+	for (int material= 0; material < pMesh->m_MaterialCount; ++material)
+	{
+		const IndexList& currentIndex= trianglesIndex.at(material);
+		const int indexCount= currentIndex.size() - (currentIndex.size() % 3);
+		for (int i= 0; i < indexCount; i+= 3)
+		{
+			const GLuint v0= currentIndex.at(i);
+			const GLuint v1= currentIndex.at(i + 1);
+			const GLuint v2= currentIndex.at(i + 2);
+			if ((v0 >= static_cast<GLuint>(vertexCount)) || (v1 >= static_cast<GLuint>(vertexCount)) || (v2 >= static_cast<GLuint>(vertexCount))) continue;
+			const int c0= vertexClass.at(v0);
+			const int c1= vertexClass.at(v1);
+			const int c2= vertexClass.at(v2);
+			if ((c0 == c1) || (c1 == c2) || (c0 == c2)) continue;
+
+			pMesh->m_Corners << v0 << v1 << v2;
+			pMesh->m_CornerWedges << vertexWedge.at(v0) << vertexWedge.at(v1) << vertexWedge.at(v2);
+			pMesh->m_TriangleMaterial.append(material);
+		}
+	}
+	const int triangleCount= pMesh->m_TriangleMaterial.size();
+	pMesh->m_TriangleRemoved.fill(0, triangleCount);
+	pMesh->m_LiveTriangleCount= triangleCount;
+
+	// The quadric of a class is the sum of its triangles planes weighted by their area
+	pMesh->m_Quadrics.fill(Quadric(), pMesh->m_ClassCount);
+	const double* pClassPositions= pMesh->m_ClassPositions.constData();
+	for (int t= 0; t < triangleCount; ++t)
+	{
+		const int c0= cornerClass(pMesh, t * 3);
+		const int c1= cornerClass(pMesh, t * 3 + 1);
+		const int c2= cornerClass(pMesh, t * 3 + 2);
+		double normal[3];
+		triangleNormal(pClassPositions + c0 * 3, pClassPositions + c1 * 3, pClassPositions + c2 * 3, normal);
+		const double length= sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length <= 0.0) continue;
+		const double a= normal[0] / length;
+		const double b= normal[1] / length;
+		const double c= normal[2] / length;
+		const double* p0= pClassPositions + c0 * 3;
+		const double d= - (a * p0[0] + b * p0[1] + c * p0[2]);
+		const double area= length * 0.5;
+		addPlane(&(pMesh->m_Quadrics[c0]), a, b, c, d, area);
+		addPlane(&(pMesh->m_Quadrics[c1]), a, b, c, d, area);
+		addPlane(&(pMesh->m_Quadrics[c2]), a, b, c, d, area);
+	}
+
+	// Feature edges are kept in place by planes orthogonal to their triangles
+	QVector<HalfEdge> halfEdges;
+	buildHalfEdges(pMesh, &halfEdges);
+	const int halfEdgeCount= halfEdges.size();
+	int first= 0;
+	while (first < halfEdgeCount)
+	{
+		int last= first + 1;
+		while ((last < halfEdgeCount) && (halfEdges.at(last).m_Key == halfEdges.at(first).m_Key)) ++last;
+		bool nonManifold= false;
+		if (isFeatureEdge(pMesh, halfEdges.constData() + first, last - first, &nonManifold))
+		{
+			for (int i= first; i < last; ++i)
+			{
+				const int corner= halfEdges.at(i).m_Corner;
+				const int ca= cornerClass(pMesh, corner);
+				const int cb= cornerClass(pMesh, nextCorner(corner));
+				const int cc= cornerClass(pMesh, nextCorner(nextCorner(corner)));
+				const double* pa= pClassPositions + ca * 3;
+				const double* pb= pClassPositions + cb * 3;
+				double normal[3];
+				triangleNormal(pa, pb, pClassPositions + cc * 3, normal);
+				const double edge[3]= {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+				double plane[3]= {edge[1] * normal[2] - edge[2] * normal[1], edge[2] * normal[0] - edge[0] * normal[2], edge[0] * normal[1] - edge[1] * normal[0]};
+				const double length= sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+				if (length <= 0.0) continue;
+				plane[0]/= length;
+				plane[1]/= length;
+				plane[2]/= length;
+				const double d= - (plane[0] * pa[0] + plane[1] * pa[1] + plane[2] * pa[2]);
+				const double weight= featureEdgeWeight * (edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2]);
+				addPlane(&(pMesh->m_Quadrics[ca]), plane[0], plane[1], plane[2], d, weight);
+				addPlane(&(pMesh->m_Quadrics[cb]), plane[0], plane[1], plane[2], d, weight);
+			}
+		}
+		first= last;
+	}
+}
+
+// Collapse vertices until the target triangles count or the maximum error is reached
+int GLC_MeshSimplifier::collapsePass(WorkingMesh* pMesh, int targetCount, double maximumError, double* pReachedError) const
+{
+	const int classCount= pMesh->m_ClassCount;
+	const int triangleCount= pMesh->m_TriangleRemoved.size();
+	const double* pClassPositions= pMesh->m_ClassPositions.constData();
+
+	// The live triangles of each class
+	QVector<int> classTriangleOffset(classCount + 1, 0);
+	for (int t= 0; t < triangleCount; ++t)
+	{
+		if (pMesh->m_TriangleRemoved.at(t)) continue;
+		for (int k= 0; k < 3; ++k) ++classTriangleOffset[cornerClass(pMesh, t * 3 + k) + 1];
+	}
+	for (int c= 0; c < classCount; ++c) classTriangleOffset[c + 1]+= classTriangleOffset.at(c);
+	QVector<int> classTriangles(classTriangleOffset.at(classCount));
+	{
+		QVector<int> cursor(classTriangleOffset);
+		for (int t= 0; t < triangleCount; ++t)
+		{
+			if (pMesh->m_TriangleRemoved.at(t)) continue;
+			for (int k= 0; k < 3; ++k) classTriangles[cursor[cornerClass(pMesh, t * 3 + k)]++]= t;
+		}
+	}
+
+	// Classify vertices from their feature edges
+	QVector<HalfEdge> halfEdges;
+	buildHalfEdges(pMesh, &halfEdges);
+	const int halfEdgeCount= halfEdges.size();
+	QVector<int> featureEdgeCount(classCount, 0);
+	QVector<char> nonManifoldClass(classCount, 0);
+	QVector<int> edgeFirst;
+	QVector<char> edgeIsFeature;
+	int first= 0;
+	while (first < halfEdgeCount)
+	{
+		int last= first + 1;
+		while ((last < halfEdgeCount) && (halfEdges.at(last).m_Key == halfEdges.at(first).m_Key)) ++last;
+		bool nonManifold= false;
+		const bool feature= isFeatureEdge(pMesh, halfEdges.constData() + first, last - first, &nonManifold);
+		const int a= static_cast<int>(halfEdges.at(first).m_Key >> 32);
+		const int b= static_cast<int>(halfEdges.at(first).m_Key & 0xFFFFFFFF);
+		if (nonManifold)
+		{
+			nonManifoldClass[a]= 1;
+			nonManifoldClass[b]= 1;
+		}
+		else
+		{
+			if (feature)
+			{
+				++featureEdgeCount[a];
+				++featureEdgeCount[b];
+			}
+			edgeFirst.append(first);
+			edgeIsFeature.append(feature ? 1 : 0);
+		}
+		first= last;
+	}
+	QVector<char> vertexKind(classCount, LockedVertex);
+	for (int c= 0; c < classCount; ++c)
+	{
+		if (nonManifoldClass.at(c)) continue;
+		if (0 == featureEdgeCount.at(c)) vertexKind[c]= ManifoldVertex;
+		else if (2 == featureEdgeCount.at(c)) vertexKind[c]= BorderVertex;
+	}
+
+	// The best collapse of each class, border vertices only move along their feature edges
+	const double noError= std::numeric_limits<double>::max();
+	QVector<double> bestError(classCount, noError);
+	QVector<int> bestTarget(classCount, -1);
+	const int edgeCount= edgeFirst.size();
+	for (int i= 0; i < edgeCount; ++i)
+	{
+		const quint64 key= halfEdges.at(edgeFirst.at(i)).m_Key;
+		const int ends[2]= {static_cast<int>(key >> 32), static_cast<int>(key & 0xFFFFFFFF)};
+		for (int k= 0; k < 2; ++k)
+		{
+			const int u= ends[k];
+			const int v= ends[1 - k];
+			const bool allowed= (vertexKind.at(u) == ManifoldVertex) || ((vertexKind.at(u) == BorderVertex) && edgeIsFeature.at(i));
+			if (!allowed) continue;
+			const double error= collapseError(pMesh->m_Quadrics.at(u), pMesh->m_Quadrics.at(v), pClassPositions + v * 3);
+			if ((error < bestError.at(u)) || ((error == bestError.at(u)) && (v < bestTarget.at(u))))
+			{
+				bestError[u]= error;
+				bestTarget[u]= v;
+			}
+		}
+	}
+	QVector<QPair<double, int> > candidates;
+	for (int c= 0; c < classCount; ++c)
+	{
+		if (-1 != bestTarget.at(c)) candidates.append(qMakePair(bestError.at(c), c));
+	}
+	std::sort(candidates.begin(), candidates.end());
+
+	// Collapse the candidates, a vertex and its neighbours are collapsed once by pass
+	QVector<char> locked(classCount, 0);
+	QVector<int> mark(classCount, 0);
+	int stamp= 0;
+	QVector<QPair<int, int> > wedgeMap;
+	int collapseCount= 0;
+	const int candidateCount= candidates.size();
+	for (int i= 0; (i < candidateCount) && (pMesh->m_LiveTriangleCount > targetCount); ++i)
+	{
+		const double error= candidates.at(i).first;
+		if ((maximumError > 0.0) && (error > maximumError)) break;
+		const int u= candidates.at(i).second;
+		const int v= bestTarget.at(u);
+		if (locked.at(u) || locked.at(v)) continue;
+
+		const int* pUTriangles= classTriangles.constData() + classTriangleOffset.at(u);
+		const int uTriangleCount= classTriangleOffset.at(u + 1) - classTriangleOffset.at(u);
+		const int* pVTriangles= classTriangles.constData() + classTriangleOffset.at(v);
+		const int vTriangleCount= classTriangleOffset.at(v + 1) - classTriangleOffset.at(v);
+
+		// Mark neighbours of u and map the wedges of u to the wedges of v through the shared triangles
+		++stamp;
+		int sharedCount= 0;
+		wedgeMap.clear();
+		for (int j= 0; j < uTriangleCount; ++j)
+		{
+			const int t= pUTriangles[j];
+			int uWedge= -1;
+			int vWedge= -1;
+			for (int k= 0; k < 3; ++k)
+			{
+				const int c= cornerClass(pMesh, t * 3 + k);
+				if (c == u) uWedge= pMesh->m_CornerWedges.at(t * 3 + k);
+				else if (c == v) vWedge= pMesh->m_CornerWedges.at(t * 3 + k);
+				else mark[c]= stamp;
+			}
+			if (-1 != vWedge)
+			{
+				++sharedCount;
+				wedgeMap.append(qMakePair(uWedge, vWedge));
+			}
+		}
+		if (0 == sharedCount) continue;
+
+		// Link condition : u and v must not have more common neighbours than shared triangles
+		int commonCount= 0;
+		for (int j= 0; j < vTriangleCount; ++j)
+		{
+			const int t= pVTriangles[j];
+			for (int k= 0; k < 3; ++k)
+			{
+				const int c= cornerClass(pMesh, t * 3 + k);
+				if ((c != u) && (c != v) && (mark.at(c) == stamp))
+				{
+					mark[c]= -stamp;
+					++commonCount;
+				}
+			}
+		}
+		if (commonCount > sharedCount) continue;
+
+		// Each wedge of u must have a wedge of v and triangles must not flip
+		bool valid= true;
+		for (int j= 0; valid && (j < uTriangleCount); ++j)
+		{
+			const int t= pUTriangles[j];
+			const double* p[3];
+			const double* pCollapsed[3];
+			bool containsV= false;
+			for (int k= 0; k < 3; ++k)
+			{
+				const int corner= t * 3 + k;
+				const int c= cornerClass(pMesh, corner);
+				containsV= containsV || (c == v);
+				p[k]= pClassPositions + c * 3;
+				pCollapsed[k]= p[k];
+				if (c == u)
+				{
+					pCollapsed[k]= pClassPositions + v * 3;
+					bool mapped= false;
+					for (int m= 0; !mapped && (m < wedgeMap.size()); ++m)
+					{
+						mapped= (wedgeMap.at(m).first == pMesh->m_CornerWedges.at(corner));
+					}
+					valid= mapped;
+				}
+			}
+			if (valid && !containsV)
+			{
+				double normal[3];
+				double collapsedNormal[3];
+				triangleNormal(p[0], p[1], p[2], normal);
+				triangleNormal(pCollapsed[0], pCollapsed[1], pCollapsed[2], collapsedNormal);
+				const double dot= normal[0] * collapsedNormal[0] + normal[1] * collapsedNormal[1] + normal[2] * collapsedNormal[2];
+				valid= (dot > 0.0);
+			}
+		}
+		if (!valid) continue;
+
+		// Collapse u into v
+		for (int j= 0; j < uTriangleCount; ++j)
+		{
+			const int t= pUTriangles[j];
+			bool containsV= false;
+			for (int k= 0; k < 3; ++k)
+			{
+				const int c= cornerClass(pMesh, t * 3 + k);
+				containsV= containsV || (c == v);
+				if ((c != u) && (c != v)) locked[c]= 1;
+			}
+			if (containsV)
+			{
+				pMesh->m_TriangleRemoved[t]= 1;
+				--(pMesh->m_LiveTriangleCount);
+				continue;
+			}
+			for (int k= 0; k < 3; ++k)
+			{
+				const int corner= t * 3 + k;
+				if (cornerClass(pMesh, corner) != u) continue;
+				int vWedge= -1;
+				for (int m= 0; (-1 == vWedge) && (m < wedgeMap.size()); ++m)
+				{
+					if (wedgeMap.at(m).first == pMesh->m_CornerWedges.at(corner)) vWedge= wedgeMap.at(m).second;
+				}
+				pMesh->m_CornerWedges[corner]= vWedge;
+				pMesh->m_Corners[corner]= pMesh->m_WedgeVertex.at(vWedge);
+			}
+		}
+		Quadric& vQuadric= pMesh->m_Quadrics[v];
+		const Quadric& uQuadric= pMesh->m_Quadrics.at(u);
+		for (int k= 0; k < 10; ++k) vQuadric.m_Values[k]+= uQuadric.m_Values[k];
+		vQuadric.m_Weight+= uQuadric.m_Weight;
+
+		locked[u]= 1;
+		locked[v]= 1;
+		*pReachedError= qMax(*pReachedError, error);
+		++collapseCount;
+	}
+
+	return collapseCount;
+}
+
+// Generate LODs of the mesh of the given task
+void GLC_MeshSimplifier::generateTaskLods(LodTask& task)
+{
+	task.m_pSimplifier->generateLods(task.m_pMesh);
+}
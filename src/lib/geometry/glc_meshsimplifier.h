@@ -0,0 +1,170 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_meshsimplifier.h interface for the GLC_MeshSimplifier class.
+
+#ifndef GLC_MESHSIMPLIFIER_H_
+#define GLC_MESHSIMPLIFIER_H_
+
+#include <QList>
+#include <QVector>
+
+#include "../glc_global.h"
+
+#include "../glc_config.h"
+
+class GLC_Mesh;
+class GLC_3DRep;
+class GLC_World;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_MeshSimplifier
+/*! \brief GLC_MeshSimplifier : Generate mesh LODs by quadric error simplification */
+
+/*! Vertices are collapsed into one of their neighbours (half edge collapse),
+ *  so the generated LODs share the vertices of the master LOD.
+ *  Open borders, material boundaries and normal or texture coordinate seams
+ *  are preserved : their vertices only move along them.
+ *  Vertices are identified by position, vertices with the same position,
+ *  texture coordinate and a normal deviation under the crease angle are merged.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_MeshSimplifier
+{
+public:
+	//! Quadric and working mesh used during simplification
+	struct Quadric;
+	struct WorkingMesh;
+
+private:
+	//! \struct LodTask
+	/*! \brief LodTask : LODs generation of a mesh on a worker thread */
+	struct LodTask
+	{
+		//! The simplifier to use
+		const GLC_MeshSimplifier* m_pSimplifier;
+		//! The mesh to simplify
+		GLC_Mesh* m_pMesh;
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a simplifier with the automatic LOD ratios of GLC_State
+	GLC_MeshSimplifier();
+
+	//! Construct a simplifier with the given LOD ratios and maximum errors
+	GLC_MeshSimplifier(const QList<double>& targetRatios, const QList<double>& maximumErrors= QList<double>());
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the triangles count ratio of each LOD, from the finest to the coarsest
+	inline QList<double> targetRatios() const
+	{return m_TargetRatios;}
+
+	//! Return the maximum error of each LOD
+	/*! The error is a distance, 0.0 means that the error is not limited*/
+	inline QList<double> maximumErrors() const
+	{return m_MaximumErrors;}
+
+	//! Return the angle in degree above which normals of a vertex are discontinuous
+	inline double creaseAngle() const
+	{return m_CreaseAngle;}
+
+	//! Simplify the given triangles at each target ratio
+	/*! trianglesIndex contains the triangles index of each material.
+	 *  For each LOD, the simplified triangles index of each material are appended to pLods
+	 *  and the reached error is appended to pErrors.
+	 *  Simplification stops when a LOD doesn't remove any triangle*/
+	void simplify(const GLfloatVector& positions, const GLfloatVector& normals, const GLfloatVector& texels
+			, const QList<IndexList>& trianglesIndex, QList<QList<IndexList> >* pLods, QList<double>* pErrors) const;
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set the triangles count ratio of each LOD
+	inline void setTargetRatios(const QList<double>& ratios)
+	{m_TargetRatios= ratios;}
+
+	//! Set the maximum error of each LOD
+	inline void setMaximumErrors(const QList<double>& errors)
+	{m_MaximumErrors= errors;}
+
+	//! Set the angle in degree above which normals of a vertex are discontinuous
+	inline void setCreaseAngle(double angle)
+	{m_CreaseAngle= angle;}
+
+	//! Add LODs to the given mesh and return the number of added LOD
+	/*! Nothing is done if the mesh already has LODs*/
+	int generateLods(GLC_Mesh* pMesh) const;
+
+	//! Add LODs to the meshes of the given representation
+	void generateLods(const GLC_3DRep& rep) const;
+
+	//! Add LODs to the given meshes on worker threads
+	void generateLods(const QList<GLC_Mesh*>& meshes) const;
+
+	//! Add LODs to the meshes of the given world on worker threads
+	void generateLods(const GLC_World& world) const;
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Initialize the working mesh from the given data
+	void initialize(WorkingMesh* pMesh, const GLfloatVector& positions, const GLfloatVector& normals
+			, const GLfloatVector& texels, const QList<IndexList>& trianglesIndex) const;
+
+	//! Collapse vertices until the target triangles count or the maximum error is reached
+	/*! Return the number of collapsed vertices and update the reached error*/
+	int collapsePass(WorkingMesh* pMesh, int targetCount, double maximumError, double* pReachedError) const;
+
+	//! Generate LODs of the mesh of the given task
+	static void generateTaskLods(LodTask& task);
+
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Triangles count ratio of each LOD
+	QList<double> m_TargetRatios;
+
+	//! Maximum error of each LOD
+	QList<double> m_MaximumErrors;
+
+	//! Crease angle in degree
+	double m_CreaseAngle;
+};
+
+#endif /* GLC_MESHSIMPLIFIER_H_ */
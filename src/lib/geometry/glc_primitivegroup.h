@@ -216,6 +216,27 @@ public:
 	inline void setId(GLC_uint id)
 	{m_Id= id;}
 
+	//! Return the handle of the list of triangles index of the group
+	inline IndexList* trianglesIndexHandle()
+	{
+		Q_ASSERT(!m_IsFinished);
+		return &m_TrianglesIndex;
+	}
+
+	//! Return the handle of the list of index of strips
+	inline IndexList* stripsIndexHandle()
+	{
+		Q_ASSERT(!m_IsFinished);
+		return &m_StripsIndex;
+	}
+
+	//! Return the handle of the list of index of fans
+	inline IndexList* fansIndexHandle()
+	{
+		Q_ASSERT(!m_IsFinished);
+		return &m_FansIndex;
+	}
+
 	//! Add triangles to the group
 	void addTriangles(const IndexList& input, GLC_uint id= 0);
 
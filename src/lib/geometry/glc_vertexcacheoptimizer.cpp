@@ -0,0 +1,307 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_vertexcacheoptimizer.cpp implementation of the GLC_VertexCacheOptimizer class.
+
+#include "glc_vertexcacheoptimizer.h"
+
+#include <QHash>
+
+#include <math.h>
+
+// Score of the 3 vertices of the last triangle
+static const double lastTriangleScore= 0.75;
+// Decay of the score with the position in the cache
+static const double cacheDecayPower= 1.5;
+// Weight of the score of vertices with few remaining triangles
+static const double valenceBoostScale= 2.0;
+
+// Return the score of a vertex at the given cache position with the given remaining triangles
+static inline double vertexScore(int cachePosition, int remainingTriangles, int cacheSize)
+{
+	if (0 == remainingTriangles) return -1.0;
+
+	double score= 0.0;
+	if (cachePosition >= 0)
+	{
+		if (cachePosition < 3)
+		{
+			score= lastTriangleScore;
+		}
+		else
+		{
+			const double scaler= 1.0 / static_cast<double>(cacheSize - 3);
+			score= pow(1.0 - static_cast<double>(cachePosition - 3) * scaler, cacheDecayPower);
+		}
+	}
+	return score + valenceBoostScale / sqrt(static_cast<double>(remainingTriangles));
+}
+
+//////////////////////////////////////////////////////////////////////
+// Constructor
+//////////////////////////////////////////////////////////////////////
+GLC_VertexCacheOptimizer::GLC_VertexCacheOptimizer(int cacheSize)
+: m_CacheSize(qMax(4, cacheSize))
+{
+
+}
+
+//////////////////////////////////////////////////////////////////////
+// Get Functions
+//////////////////////////////////////////////////////////////////////
+
+// Return the average cache miss ratio of the given triangles index
+double GLC_VertexCacheOptimizer::acmr(const IndexList& trianglesIndex) const
+{
+	const int triangleCount= trianglesIndex.size() / 3;
+	if (0 == triangleCount) return 0.0;
+	else return static_cast<double>(cacheMissCount(trianglesIndex)) / static_cast<double>(triangleCount);
+}
+
+// Return the number of cache miss of the given triangles index
+int GLC_VertexCacheOptimizer::cacheMissCount(const IndexList& trianglesIndex) const
+{
+	// FIFO cache
+	QVector<GLuint> cache(m_CacheSize, 0);
+	QVector<char> cacheUsed(m_CacheSize, 0);
+	int head= 0;
+	int missCount= 0;
+	const int indexCount= trianglesIndex.size() - (trianglesIndex.size() % 3);
+	for (int i= 0; i < indexCount; ++i)
+	{
+		const GLuint index= trianglesIndex.at(i);
+		bool hit= false;
+		for (int j= 0; !hit && (j < m_CacheSize); ++j)
+		{
+			hit= cacheUsed.at(j) && (cache.at(j) == index);
+		}
+		if (!hit)
+		{
+			cache[head]= index;
+			cacheUsed[head]= 1;
+			head= (head + 1) % m_CacheSize;
+			++missCount;
+		}
+	}
+	return missCount;
+}
+
+// Return the vertices permutation which makes the given index sequential
+QVector<GLuint> GLC_VertexCacheOptimizer::vertexFetchRemap(const QList<IndexList>& indexLists, int vertexCount)
+{
+	const GLuint unused= static_cast<GLuint>(vertexCount);
+	QVector<GLuint> remap(vertexCount, unused);
+	GLuint nextVertex= 0;
+	const int listCount= indexLists.size();
+	for (int i= 0; i < listCount; ++i)
+	{
+		const IndexList& currentList= indexLists.at(i);
+		const int indexCount= currentList.size();
+		for (int j= 0; j < indexCount; ++j)
+		{
+			const GLuint index= currentList.at(j);
+			if ((index < unused) && (remap.at(index) == unused))
+			{
+				remap[index]= nextVertex++;
+			}
+		}
+	}
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		if (remap.at(i) == unused) remap[i]= nextVertex++;
+	}
+	return remap;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Set Functions
+//////////////////////////////////////////////////////////////////////
+
+// Reorder the triangles of the given triangles index for the vertex cache
+void GLC_VertexCacheOptimizer::optimizeTriangles(IndexList* pTrianglesIndex) const
+{
+	optimizeTriangles(pTrianglesIndex, 0, pTrianglesIndex->size());
+}
+
+// Reorder the triangles of the given range of the triangles index
+void GLC_VertexCacheOptimizer::optimizeTriangles(IndexList* pTrianglesIndex, int offset, int size) const
+{
+	const int triangleCount= size / 3;
+	if (triangleCount < 2) return;
+
+	// Compact the vertices used by the range
+	QHash<GLuint, int> vertexOfIndex;
+	QVector<GLuint> indexOfVertex;
+	QVector<int> corners(triangleCount * 3);
+	for (int i= 0; i < (triangleCount * 3); ++i)
+	{
+		const GLuint index= pTrianglesIndex->at(offset + i);
+		QHash<GLuint, int>::const_iterator iVertex= vertexOfIndex.constFind(index);
+		if (iVertex == vertexOfIndex.constEnd())
+		{
+			iVertex= vertexOfIndex.insert(index, indexOfVertex.size());
+			indexOfVertex.append(index);
+		}
+		corners[i]= iVertex.value();
+	}
+	const int vertexCount= indexOfVertex.size();
+
+	// Triangles of each vertex, the live triangles of a vertex are at the beginning of its range
+	QVector<int> remainingTriangles(vertexCount, 0);
+	for (int i= 0; i < (triangleCount * 3); ++i) ++remainingTriangles[corners.at(i)];
+	QVector<int> adjacencyOffset(vertexCount + 1, 0);
+	for (int v= 0; v < vertexCount; ++v) adjacencyOffset[v + 1]= adjacencyOffset.at(v) + remainingTriangles.at(v);
+	QVector<int> adjacency(triangleCount * 3);
+	{
+		QVector<int> cursor(adjacencyOffset);
+		for (int i= 0; i < (triangleCount * 3); ++i) adjacency[cursor[corners.at(i)]++]= i / 3;
+	}
+
+	// Initial scores
+	const int cacheSize= m_CacheSize;
+	QVector<int> cachePosition(vertexCount, -1);
+	QVector<double> vertexScores(vertexCount);
+	for (int v= 0; v < vertexCount; ++v) vertexScores[v]= vertexScore(-1, remainingTriangles.at(v), cacheSize);
+	QVector<double> triangleScores(triangleCount, 0.0);
+	QVector<char> triangleAdded(triangleCount, 0);
+	int bestTriangle= 0;
+	for (int t= 0; t < triangleCount; ++t)
+	{
+		triangleScores[t]= vertexScores.at(corners.at(t * 3)) + vertexScores.at(corners.at(t * 3 + 1)) + vertexScores.at(corners.at(t * 3 + 2));
+		if (triangleScores.at(t) > triangleScores.at(bestTriangle)) bestTriangle= t;
+	}
+
+	QVector<int> cache;
+	cache.reserve(cacheSize + 3);
+	QVector<int> newCache;
+	newCache.reserve(cacheSize + 3);
+	QVector<GLuint> result;
+	result.reserve(triangleCount * 3);
+	int nextCandidate= 0;
+	for (int emitted= 0; emitted < triangleCount; ++emitted)
+	{
+		// The best triangle is not found in the cache, take the next one
+		if (bestTriangle < 0)
+		{
+			while (triangleAdded.at(nextCandidate)) ++nextCandidate;
+			bestTriangle= nextCandidate;
+		}
+
+		const int* pCorners= corners.constData() + bestTriangle * 3;
+		triangleAdded[bestTriangle]= 1;
+		newCache.clear();
+		for (int k= 0; k < 3; ++k)
+		{
+			const int v= pCorners[k];
+			result.append(indexOfVertex.at(v));
+
+			// Remove the triangle from the live triangles of the vertex
+			int* pAdjacency= adjacency.data() + adjacencyOffset.at(v);
+			const int last= remainingTriangles.at(v) - 1;
+			for (int j= 0; j <= last; ++j)
+			{
+				if (pAdjacency[j] == bestTriangle)
+				{
+					pAdjacency[j]= pAdjacency[last];
+					pAdjacency[last]= bestTriangle;
+					break;
+				}
+			}
+			--remainingTriangles[v];
+
+			if (!newCache.contains(v)) newCache.append(v);
+		}
+
+		// Vertices of the triangle are moved to the front of the cache
+		const int cacheCount= cache.size();
+		for (int i= 0; i < cacheCount; ++i)
+		{
+			const int v= cache.at(i);
+			if ((v != pCorners[0]) && (v != pCorners[1]) && (v != pCorners[2])) newCache.append(v);
+		}
+
+		// Update scores of the vertices in the cache and of their triangles
+		bestTriangle= -1;
+		double bestScore= -1.0;
+		const int newCacheCount= newCache.size();
+		for (int i= 0; i < newCacheCount; ++i)
+		{
+			const int v= newCache.at(i);
+			const int position= (i < cacheSize) ? i : -1;
+			cachePosition[v]= position;
+			const double score= vertexScore(position, remainingTriangles.at(v), cacheSize);
+			const double delta= score - vertexScores.at(v);
+			vertexScores[v]= score;
+
+			const int* pAdjacency= adjacency.constData() + adjacencyOffset.at(v);
+			const int adjacencyCount= remainingTriangles.at(v);
+			for (int j= 0; j < adjacencyCount; ++j)
+			{
+				const int t= pAdjacency[j];
+				triangleScores[t]+= delta;
+				if (triangleScores.at(t) > bestScore)
+				{
+					bestScore= triangleScores.at(t);
+					bestTriangle= t;
+				}
+			}
+		}
+		if (newCacheCount > cacheSize) newCache.resize(cacheSize);
+		cache.swap(newCache);
+	}
+
+	for (int i= 0; i < (triangleCount * 3); ++i)
+	{
+		(*pTrianglesIndex)[offset + i]= result.at(i);
+	}
+}
+
+// Apply the given vertices permutation to the given index
+void GLC_VertexCacheOptimizer::remapIndex(IndexList* pIndex, const QVector<GLuint>& remap)
+{
+	const GLuint vertexCount= static_cast<GLuint>(remap.size());
+	const int indexCount= pIndex->size();
+	for (int i= 0; i < indexCount; ++i)
+	{
+		const GLuint index= pIndex->at(i);
+		if (index < vertexCount) (*pIndex)[i]= remap.at(index);
+	}
+}
+
+// Apply the given vertices permutation to the given vertex attribute
+void GLC_VertexCacheOptimizer::remapVertices(GLfloatVector* pAttribute, int stride, const QVector<GLuint>& remap)
+{
+	const int vertexCount= remap.size();
+	if (pAttribute->size() != (vertexCount * stride)) return;
+
+	GLfloatVector result(pAttribute->size());
+	const GLfloat* pSource= pAttribute->constData();
+	GLfloat* pTarget= result.data();
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		const int target= static_cast<int>(remap.at(i));
+		for (int k= 0; k < stride; ++k)
+		{
+			pTarget[target * stride + k]= pSource[i * stride + k];
+		}
+	}
+	pAttribute->swap(result);
+}
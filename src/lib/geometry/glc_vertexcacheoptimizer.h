@@ -0,0 +1,113 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_vertexcacheoptimizer.h interface for the GLC_VertexCacheOptimizer class.
+
+#ifndef GLC_VERTEXCACHEOPTIMIZER_H_
+#define GLC_VERTEXCACHEOPTIMIZER_H_
+
+#include <QVector>
+
+#include "../glc_global.h"
+
+#include "../glc_config.h"
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_VertexCacheOptimizer
+/*! \brief GLC_VertexCacheOptimizer : Reorder triangles and vertices for the GPU vertex caches */
+
+/*! Triangles are reordered with the linear speed vertex cache optimisation
+ *  of Tom Forsyth : the next triangle is the one with the highest score,
+ *  vertices score depend on their position in a simulated LRU cache and on
+ *  their number of remaining triangles.
+ *  Vertices are then renumbered by first use, so the vertex fetch is sequential.
+ *  Efficiency is measured by the average cache miss ratio (ACMR) : the number
+ *  of transformed vertices per triangle with a simulated FIFO cache.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_VertexCacheOptimizer
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct an optimizer for the given vertex cache size
+	GLC_VertexCacheOptimizer(int cacheSize= 32);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the simulated vertex cache size
+	inline int cacheSize() const
+	{return m_CacheSize;}
+
+	//! Return the average cache miss ratio of the given triangles index
+	/*! Return 0.0 if there is no triangle*/
+	double acmr(const IndexList& trianglesIndex) const;
+
+	//! Return the number of cache miss of the given triangles index
+	int cacheMissCount(const IndexList& trianglesIndex) const;
+
+	//! Return the vertices permutation which makes the given index sequential
+	/*! The returned vector gives the new position of each of the vertexCount vertices.
+	 *  Vertices are numbered by first use in the given index lists,
+	 *  unused vertices are moved at the end with their order kept*/
+	static QVector<GLuint> vertexFetchRemap(const QList<IndexList>& indexLists, int vertexCount);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set the simulated vertex cache size
+	inline void setCacheSize(int size)
+	{m_CacheSize= qMax(4, size);}
+
+	//! Reorder the triangles of the given triangles index for the vertex cache
+	void optimizeTriangles(IndexList* pTrianglesIndex) const;
+
+	//! Reorder the triangles of the given range of the triangles index
+	/*! offset and size are given in index*/
+	void optimizeTriangles(IndexList* pTrianglesIndex, int offset, int size) const;
+
+	//! Apply the given vertices permutation to the given index
+	static void remapIndex(IndexList* pIndex, const QVector<GLuint>& remap);
+
+	//! Apply the given vertices permutation to the given vertex attribute
+	/*! stride is the number of component of the attribute, nothing is done if
+	 *  the attribute doesn't have a value for each vertex*/
+	static void remapVertices(GLfloatVector* pAttribute, int stride, const QVector<GLuint>& remap);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The simulated vertex cache size
+	int m_CacheSize;
+};
+
+#endif /* GLC_VERTEXCACHEOPTIMIZER_H_ */
@@ -28,6 +28,7 @@
 #include "../glc_state.h"
 #include "../glc_exception.h"
 #include "../glc_contextmanager.h"
+#include "../glc_frameprofiler.h"
 
 // Class chunk id
 // Old chunkId = 0xA706
@@ -430,6 +431,7 @@ void GLC_WireData::glDraw(const GLC_RenderProperties&, GLenum mode)
 		for (int i= 0; i < m_VerticeGroupCount; ++i)
 		{
 			glDrawElements(mode, m_VerticeGrouprSizes.at(i), GL_UNSIGNED_INT, m_VerticeGroupOffset.at(i));
+			GLC_FrameProfiler::addDrawCalls(1);
 		}
 
         QOpenGLBuffer::release(QOpenGLBuffer::VertexBuffer);
@@ -448,6 +450,7 @@ void GLC_WireData::glDraw(const GLC_RenderProperties&, GLenum mode)
 		for (int i= 0; i < m_VerticeGroupCount; ++i)
 		{
 			glDrawElements(mode, m_VerticeGrouprSizes.at(i), GL_UNSIGNED_INT, &(m_IndexVector.data()[m_VerticeGroupOffseti.at(i)]));
+			GLC_FrameProfiler::addDrawCalls(1);
 		}
 
 	}
@@ -475,6 +478,7 @@ void GLC_WireData::fillVBOs()
 		const GLsizei dataNbr= static_cast<GLsizei>(m_Positions.size());
 		const GLsizeiptr dataSize= dataNbr * sizeof(GLfloat);
 		m_VerticeBuffer.allocate(m_Positions.data(), dataSize);
+		GLC_FrameProfiler::addUploadBytes(dataSize);
 	}
 
 	{
@@ -483,6 +487,7 @@ void GLC_WireData::fillVBOs()
 		const GLsizei dataNbr= static_cast<GLsizei>(m_IndexVector.size());
 		const GLsizeiptr dataSize= dataNbr * sizeof(GLuint);
 		m_IndexBuffer.allocate(m_IndexVector.data(), dataSize);
+		GLC_FrameProfiler::addUploadBytes(dataSize);
 	}
 
 	if (m_ColorBuffer.isCreated())
@@ -491,6 +496,7 @@ void GLC_WireData::fillVBOs()
 		const GLsizei dataNbr= static_cast<GLsizei>(m_Colors.size());
 		const GLsizeiptr dataSize= dataNbr * sizeof(GLfloat);
 		m_ColorBuffer.allocate(m_Colors.data(), dataSize);
+		GLC_FrameProfiler::addUploadBytes(dataSize);
 	}
 }
 
@@ -22,13 +22,92 @@
 //! \file glc_cachemanager.cpp implementation of the GLC_CacheManager class.
 
 #include "glc_cachemanager.h"
+#include "glc_state.h"
+#include "glc_exception.h"
+#include <QAtomicInt>
+#include <QDataStream>
+#include <QPair>
 #include <QtDebug>
 
+#include <algorithm>
+
+const QString GLC_CacheManager::m_IndexFileName("contents.index");
+const QString GLC_CacheManager::m_ContentDirName("contents");
+
+namespace
+{
+	//! The index file magic number and version
+	const quint32 glcCacheIndexMagic= 0x47434958;
+	const quint32 glcCacheIndexVersion= 1;
+
+	//! Number of added contents after which the index is saved
+	const int glcCacheIndexSaveBatch= 64;
+
+	//! Counter used to build unique temporary file names
+	QAtomicInt glcCacheTemporaryCounter;
+
+	//! Return true if the first entry is older than the second
+	bool glcCacheEntryIsOlder(const QPair<qint64, QString>& entry1, const QPair<qint64, QString>& entry2)
+	{
+		return entry1.first < entry2.first;
+	}
+}
+
+GLC_CacheManager::ContentIndex::ContentIndex()
+: m_Mutex()
+, m_FileName()
+, m_Entries()
+, m_TotalSize(0)
+, m_MaximumSize(0)
+, m_IsLoaded(false)
+, m_IsDirty(false)
+, m_UnsavedCount(0)
+{
+
+}
+
+GLC_CacheManager::ContentIndex::~ContentIndex()
+{
+	if (m_IsDirty) save();
+}
+
+// Save the index into its file
+void GLC_CacheManager::ContentIndex::save()
+{
+	if (m_FileName.isEmpty() || !m_IsLoaded) return;
+
+	// Write a temporary file then rename it in order to never leave a truncated index
+	const QString temporaryFileName(m_FileName + ".tmp");
+	QFile indexFile(temporaryFileName);
+	if (indexFile.open(QIODevice::WriteOnly))
+	{
+		QDataStream stream(&indexFile);
+		stream.setVersion(QDataStream::Qt_4_6);
+		stream << glcCacheIndexMagic << glcCacheIndexVersion;
+		stream << static_cast<quint32>(m_Entries.size());
+		QHash<QString, ContentEntry>::const_iterator iEntry= m_Entries.constBegin();
+		while (m_Entries.constEnd() != iEntry)
+		{
+			stream << iEntry.key() << iEntry.value().m_Size << iEntry.value().m_LastAccess;
+			++iEntry;
+		}
+		indexFile.close();
+
+		QFile::remove(m_FileName);
+		if (QFile::rename(temporaryFileName, m_FileName))
+		{
+			m_IsDirty= false;
+			m_UnsavedCount= 0;
+		}
+	}
+}
+
 
 GLC_CacheManager::GLC_CacheManager(const QString& path)
 : m_Dir()
 , m_UseCompression(true)
 , m_CompressionLevel(-1)
+, m_pContentIndex(new ContentIndex)
 {
 	if (! path.isEmpty())
 	{
@@ -36,6 +115,7 @@ GLC_CacheManager::GLC_CacheManager(const QString& path)
 		if (pathInfo.isDir() && pathInfo.isReadable())
 		{
 			m_Dir.setPath(path);
+			m_pContentIndex->m_FileName= m_Dir.absolutePath() + QDir::separator() + m_IndexFileName;
 		}
 	}
 }
@@ -45,6 +125,7 @@ GLC_CacheManager::GLC_CacheManager(const GLC_CacheManager& cacheManager)
 :m_Dir(cacheManager.m_Dir)
 , m_UseCompression(cacheManager.m_UseCompression)
 , m_CompressionLevel(cacheManager.m_CompressionLevel)
+, m_pContentIndex(cacheManager.m_pContentIndex)
 {
 
 }
@@ -55,6 +136,7 @@ GLC_CacheManager& GLC_CacheManager::operator=(const GLC_CacheManager& cacheManag
 	m_Dir= cacheManager.m_Dir;
 	m_UseCompression= cacheManager.m_UseCompression;
 	m_CompressionLevel= cacheManager.m_CompressionLevel;
+	m_pContentIndex= cacheManager.m_pContentIndex;
 
 	return *this;
 }
@@ -163,6 +245,157 @@ bool GLC_CacheManager::addToCache(const QString& context, const GLC_3DRep& rep)
 	return addedToCache;
 }
 
+// Return the content key of the given source bytes
+QString GLC_CacheManager::contentKey(const QByteArray& content)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	addSettingsToHash(&hash);
+	hash.addData(content);
+
+	return QString::fromLatin1(hash.result().toHex());
+}
+
+// Return the content key of the given list of source chunks
+QString GLC_CacheManager::contentKey(const QList<QByteArray>& contentChunks)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	addSettingsToHash(&hash);
+	const int size= contentChunks.size();
+	for (int i= 0; i < size; ++i)
+	{
+		hash.addData(contentChunks.at(i));
+	}
+
+	return QString::fromLatin1(hash.result().toHex());
+}
+
+// Return true if the representation of the given content key is cached
+bool GLC_CacheManager::contentIsCached(const QString& key) const
+{
+	if (key.isEmpty() || !isReadable()) return false;
+
+	QMutexLocker locker(&(m_pContentIndex->m_Mutex));
+	loadIndex();
+
+	return m_pContentIndex->m_Entries.contains(key);
+}
+
+// Load the representation of the given content key into the given rep and return true on success
+bool GLC_CacheManager::loadCachedContent(const QString& key, GLC_3DRep* pRep) const
+{
+	Q_ASSERT(NULL != pRep);
+	if (!contentIsCached(key)) return false;
+
+	bool loaded= true;
+	try
+	{
+		GLC_BSRep binaryRep(contentFileName(key));
+		*pRep= binaryRep.loadRep();
+	}
+	catch (GLC_Exception&)
+	{
+		loaded= false;
+	}
+
+	QMutexLocker locker(&(m_pContentIndex->m_Mutex));
+	if (loaded)
+	{
+		QHash<QString, ContentEntry>::iterator iEntry= m_pContentIndex->m_Entries.find(key);
+		if (m_pContentIndex->m_Entries.end() != iEntry)
+		{
+			iEntry.value().m_LastAccess= QDateTime::currentMSecsSinceEpoch();
+			m_pContentIndex->m_IsDirty= true;
+		}
+	}
+	else if (m_pContentIndex->m_Entries.contains(key))
+	{
+		// The cached file is corrupted or has been removed
+		m_pContentIndex->m_TotalSize-= m_pContentIndex->m_Entries.take(key).m_Size;
+		QFile::remove(contentFileName(key));
+		m_pContentIndex->save();
+	}
+
+	return loaded;
+}
+
+// Add the given representation in the cache under the given content key
+bool GLC_CacheManager::addContentToCache(const QString& key, const GLC_3DRep& rep)
+{
+	if (key.isEmpty() || !isWritable()) return false;
+
+	const QString contentDirPath(contentPath());
+	if (!QFileInfo(contentDirPath).exists() && !m_Dir.mkpath(m_ContentDirName))
+	{
+		return false;
+	}
+
+	// The representation is written into a unique temporary file and then renamed
+	// in order to never expose a partially written file to the other loaders
+	const QString temporaryFileName(contentDirPath + QDir::separator() + key + '.'
+									+ QString::number(glcCacheTemporaryCounter.fetchAndAddOrdered(1)) + ".tmp." + GLC_BSRep::suffix());
+	GLC_BSRep binaryRep(temporaryFileName, m_UseCompression);
+	binaryRep.setCompressionLevel(m_CompressionLevel);
+	if (!binaryRep.save(rep))
+	{
+		QFile::remove(temporaryFileName);
+		return false;
+	}
+
+	const QString fileName(contentFileName(key));
+	const qint64 fileSize= QFileInfo(temporaryFileName).size();
+
+	QMutexLocker locker(&(m_pContentIndex->m_Mutex));
+	loadIndex();
+
+	ContentEntry entry;
+	entry.m_Size= fileSize;
+	entry.m_LastAccess= QDateTime::currentMSecsSinceEpoch();
+
+	if (m_pContentIndex->m_Entries.contains(key))
+	{
+		// Another loader has cached the same content
+		QFile::remove(temporaryFileName);
+		m_pContentIndex->m_Entries[key].m_LastAccess= entry.m_LastAccess;
+	}
+	else
+	{
+		QFile::remove(fileName);
+		if (!QFile::rename(temporaryFileName, fileName))
+		{
+			QFile::remove(temporaryFileName);
+			return false;
+		}
+		m_pContentIndex->m_Entries.insert(key, entry);
+		m_pContentIndex->m_TotalSize+= fileSize;
+		evict();
+	}
+
+	// The index is saved by batch and when it is destroyed
+	m_pContentIndex->m_IsDirty= true;
+	++(m_pContentIndex->m_UnsavedCount);
+	if (m_pContentIndex->m_UnsavedCount >= glcCacheIndexSaveBatch)
+	{
+		m_pContentIndex->save();
+	}
+
+	return true;
+}
+
+// Return the maximum size in bytes of the content cache
+qint64 GLC_CacheManager::maximumSize() const
+{
+	QMutexLocker locker(&(m_pContentIndex->m_Mutex));
+	return m_pContentIndex->m_MaximumSize;
+}
+
+// Return the size in bytes of the content cache
+qint64 GLC_CacheManager::contentSize() const
+{
+	QMutexLocker locker(&(m_pContentIndex->m_Mutex));
+	loadIndex();
+	return m_pContentIndex->m_TotalSize;
+}
+
 //////////////////////////////////////////////////////////////////////
 //Set Functions
 //////////////////////////////////////////////////////////////////////
@@ -177,7 +410,167 @@ bool GLC_CacheManager::setCachePath(const QString& path)
 	if (result)
 	{
 		m_Dir.setPath(path);
+
+		// The content index is bound to the cache directory
+		const qint64 maximumSize= m_pContentIndex->m_MaximumSize;
+		m_pContentIndex= QSharedPointer<ContentIndex>(new ContentIndex);
+		m_pContentIndex->m_FileName= m_Dir.absolutePath() + QDir::separator() + m_IndexFileName;
+		m_pContentIndex->m_MaximumSize= maximumSize;
 	}
 	return result;
 }
 
+// Set the maximum size in bytes of the content cache
+void GLC_CacheManager::setMaximumSize(qint64 size)
+{
+	Q_ASSERT(size >= 0);
+	QMutexLocker locker(&(m_pContentIndex->m_Mutex));
+	m_pContentIndex->m_MaximumSize= size;
+	if (isWritable())
+	{
+		loadIndex();
+		evict();
+		if (m_pContentIndex->m_IsDirty) m_pContentIndex->save();
+	}
+}
+
+// Remove all content cached representations
+void GLC_CacheManager::clearContents()
+{
+	QMutexLocker locker(&(m_pContentIndex->m_Mutex));
+	loadIndex();
+	QHash<QString, ContentEntry>::const_iterator iEntry= m_pContentIndex->m_Entries.constBegin();
+	while (m_pContentIndex->m_Entries.constEnd() != iEntry)
+	{
+		QFile::remove(contentFileName(iEntry.key()));
+		++iEntry;
+	}
+	m_pContentIndex->m_Entries.clear();
+	m_pContentIndex->m_TotalSize= 0;
+	m_pContentIndex->m_IsDirty= true;
+	m_pContentIndex->save();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+// Return the absolute path of the content directory
+QString GLC_CacheManager::contentPath() const
+{
+	return m_Dir.absolutePath() + QDir::separator() + m_ContentDirName;
+}
+
+// Return the absolute file name of the given content key
+QString GLC_CacheManager::contentFileName(const QString& key) const
+{
+	return contentPath() + QDir::separator() + key + '.' + GLC_BSRep::suffix();
+}
+
+// Load the content index from file or rebuild it from the content directory
+void GLC_CacheManager::loadIndex() const
+{
+	ContentIndex* pIndex= m_pContentIndex.data();
+	if (pIndex->m_IsLoaded || pIndex->m_FileName.isEmpty()) return;
+
+	pIndex->m_Entries.clear();
+	pIndex->m_TotalSize= 0;
+
+	bool indexIsValid= false;
+	QFile indexFile(pIndex->m_FileName);
+	if (indexFile.open(QIODevice::ReadOnly))
+	{
+		QDataStream stream(&indexFile);
+		stream.setVersion(QDataStream::Qt_4_6);
+		quint32 magic= 0;
+		quint32 version= 0;
+		quint32 size= 0;
+		stream >> magic >> version >> size;
+		indexIsValid= (glcCacheIndexMagic == magic) && (glcCacheIndexVersion == version);
+		for (quint32 i= 0; indexIsValid && (i < size); ++i)
+		{
+			QString key;
+			ContentEntry entry;
+			stream >> key >> entry.m_Size >> entry.m_LastAccess;
+			indexIsValid= (QDataStream::Ok == stream.status());
+			// Entries whose file has been removed are dropped
+			if (indexIsValid && QFileInfo(contentFileName(key)).exists())
+			{
+				pIndex->m_Entries.insert(key, entry);
+				pIndex->m_TotalSize+= entry.m_Size;
+			}
+		}
+	}
+
+	if (!indexIsValid)
+	{
+		// Rebuild the index from the content directory
+		pIndex->m_Entries.clear();
+		pIndex->m_TotalSize= 0;
+		const QString suffix(GLC_BSRep::suffix());
+		QStringList filters("*." + suffix);
+		const QFileInfoList fileInfoList(QDir(contentPath()).entryInfoList(filters, QDir::Files));
+		const int size= fileInfoList.size();
+		for (int i= 0; i < size; ++i)
+		{
+			const QFileInfo& fileInfo= fileInfoList.at(i);
+			if (fileInfo.fileName().contains(".tmp."))
+			{
+				// Left over of an interrupted write
+				QFile::remove(fileInfo.absoluteFilePath());
+				continue;
+			}
+			ContentEntry entry;
+			entry.m_Size= fileInfo.size();
+			entry.m_LastAccess= fileInfo.lastModified().toMSecsSinceEpoch();
+			pIndex->m_Entries.insert(fileInfo.completeBaseName(), entry);
+			pIndex->m_TotalSize+= entry.m_Size;
+		}
+		pIndex->m_IsDirty= true;
+	}
+	pIndex->m_IsLoaded= true;
+}
+
+// Evict least recently used representations until the cache fit the maximum size
+void GLC_CacheManager::evict() const
+{
+	ContentIndex* pIndex= m_pContentIndex.data();
+	if ((0 == pIndex->m_MaximumSize) || (pIndex->m_TotalSize <= pIndex->m_MaximumSize)) return;
+
+	QList<QPair<qint64, QString> > entries;
+	QHash<QString, ContentEntry>::const_iterator iEntry= pIndex->m_Entries.constBegin();
+	while (pIndex->m_Entries.constEnd() != iEntry)
+	{
+		entries.append(qMakePair(iEntry.value().m_LastAccess, iEntry.key()));
+		++iEntry;
+	}
+	std::sort(entries.begin(), entries.end(), glcCacheEntryIsOlder);
+
+	const int size= entries.size();
+	int i= 0;
+	while ((i < size) && (pIndex->m_TotalSize > pIndex->m_MaximumSize))
+	{
+		const QString& key= entries.at(i).second;
+		QFile::remove(contentFileName(key));
+		pIndex->m_TotalSize-= pIndex->m_Entries.take(key).m_Size;
+		++i;
+	}
+	pIndex->m_IsDirty= true;
+}
+
+// Add the loader settings which change the cached geometry to the given hash
+void GLC_CacheManager::addSettingsToHash(QCryptographicHash* pHash)
+{
+	QByteArray settings;
+	QDataStream stream(&settings, QIODevice::WriteOnly);
+	stream << GLC_BSRep::version();
+	stream << GLC_State::isAutomaticLodActivated();
+	if (GLC_State::isAutomaticLodActivated())
+	{
+		stream << GLC_State::automaticLodRatios();
+	}
+	stream << GLC_State::isVertexCacheOptimizationActivated();
+
+	pHash->addData(settings);
+}
+
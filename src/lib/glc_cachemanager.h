@@ -27,6 +27,10 @@
 #include <QDir>
 #include <QString>
 #include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QCryptographicHash>
 #include "geometry/glc_bsrep.h"
 
 #include "glc_config.h"
@@ -37,6 +41,14 @@
 
 /*! By default the binary rep are compressed with a default
  * compression level
+ *
+ * Beside the file name keyed cache, representations can be cached by content :
+ * the key is a hash of the source bytes salted with the loader settings which
+ * change the produced geometry. Content cached representations are stored in
+ * the "contents" sub directory and listed in an index file at the cache root.
+ * When a maximum size is set, the least recently used representations are
+ * evicted after each insertion. Copies of a cache manager share the same index,
+ * which is protected by a mutex so loader threads can read and write concurrently.
  */
 //////////////////////////////////////////////////////////////////////
 class GLC_LIB_EXPORT GLC_CacheManager
@@ -98,6 +110,29 @@ public:
 	inline int compressionLevel() const
 	{return m_CompressionLevel;}
 
+	//! Return the content key of the given source bytes
+	static QString contentKey(const QByteArray& content);
+
+	//! Return the content key of the given list of source chunks
+	static QString contentKey(const QList<QByteArray>& contentChunks);
+
+	//! Return true if the representation of the given content key is cached
+	bool contentIsCached(const QString& key) const;
+
+	//! Load the representation of the given content key into the given rep and return true on success
+	bool loadCachedContent(const QString& key, GLC_3DRep* pRep) const;
+
+	//! Add the given representation in the cache under the given content key
+	/*! The index file is saved by batch of added contents and when the last copy
+	 *  of this cache manager is destroyed*/
+	bool addContentToCache(const QString& key, const GLC_3DRep& rep);
+
+	//! Return the maximum size in bytes of the content cache (0 means unlimited)
+	qint64 maximumSize() const;
+
+	//! Return the size in bytes of the content cache
+	qint64 contentSize() const;
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -116,6 +151,84 @@ public:
 	//! Set the cache compression level
 	inline void setCompressionLevel(int level)
 	{m_CompressionLevel= level;}
+
+	//! Set the maximum size in bytes of the content cache (0 means unlimited)
+	/*! The least recently used representations are evicted if needed*/
+	void setMaximumSize(qint64 size);
+
+	//! Remove all content cached representations
+	void clearContents();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Shared content index entry
+	struct ContentEntry
+	{
+		//! The size of the cached file
+		qint64 m_Size;
+
+		//! The last access time in ms since epoch
+		qint64 m_LastAccess;
+	};
+
+	//! Content index shared by the copies of a cache manager
+	struct ContentIndex
+	{
+		ContentIndex();
+
+		//! Save the index if it has been modified
+		~ContentIndex();
+
+		//! Save the index into its file
+		/*! The mutex must be locked*/
+		void save();
+
+		//! The mutex which protect the index
+		QMutex m_Mutex;
+
+		//! The absolute file name of the index
+		QString m_FileName;
+
+		//! Hash table of content key to entry
+		QHash<QString, ContentEntry> m_Entries;
+
+		//! The sum of the entry sizes
+		qint64 m_TotalSize;
+
+		//! The maximum size of the content cache (0 means unlimited)
+		qint64 m_MaximumSize;
+
+		//! True if the index has been loaded
+		bool m_IsLoaded;
+
+		//! True if the index has been modified since the last save
+		bool m_IsDirty;
+
+		//! The number of contents added since the last save
+		int m_UnsavedCount;
+	};
+
+	//! Return the absolute path of the content directory
+	QString contentPath() const;
+
+	//! Return the absolute file name of the given content key
+	QString contentFileName(const QString& key) const;
+
+	//! Load the content index from file or rebuild it from the content directory
+	/*! The index mutex must be locked*/
+	void loadIndex() const;
+
+	//! Evict least recently used representations until the cache fit the maximum size
+	/*! The index mutex must be locked*/
+	void evict() const;
+
+	//! Add the loader settings which change the cached geometry to the given hash
+	static void addSettingsToHash(QCryptographicHash* pHash);
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -131,6 +244,15 @@ private:
 
 	//! The compression level
 	int m_CompressionLevel;
+
+	//! The shared content index
+	QSharedPointer<ContentIndex> m_pContentIndex;
+
+	//! The index file name
+	static const QString m_IndexFileName;
+
+	//! The content sub directory name
+	static const QString m_ContentDirName;
 };
 
 #endif /* GLC_CACHEMANAGER_H_ */
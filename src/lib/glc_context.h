@@ -106,6 +106,10 @@ public:
     inline QVector<int> enableLights() const
     {return m_ContextSharedData->enableLights();}
 
+    //! Return the instancing shader, NULL if instancing is not supported
+    inline GLC_Shader* instancingShaderHandle() const
+    {return m_ContextSharedData->instancingShaderHandle();}
+
     //! Return the OpenGLContext handle of this GLC_Context
     inline QOpenGLContext* contextHandle() const
     {return m_pOpenGLContext;}
@@ -29,6 +29,7 @@
 
 GLC_ContextSharedData::GLC_ContextSharedData()
     : m_pDefaultShader(NULL)
+    , m_pInstancingShader(NULL)
     , m_IsClean(false)
     , m_CurrentMatrixMode()
     , m_MatrixStackHash()
@@ -67,6 +68,7 @@ GLC_ContextSharedData::~GLC_ContextSharedData()
     }
 
     delete m_pDefaultShader;
+    delete m_pInstancingShader;
 }
 
 void GLC_ContextSharedData::init()
@@ -74,6 +76,10 @@ void GLC_ContextSharedData::init()
     if (!m_IsClean)
     {
         initDefaultShader();
+        if (GLC_State::instancingSupported())
+        {
+            initInstancingShader();
+        }
 
 #ifdef GLC_OPENGL_ES_2
         useDefaultShader();
@@ -310,6 +316,19 @@ void GLC_ContextSharedData::initDefaultShader()
     m_pDefaultShader->createAndCompileProgrammShader();
 }
 
+void GLC_ContextSharedData::initInstancingShader()
+{
+    QFile vertexShader(":/GLC_lib_Shaders/instancing_vert");
+    Q_ASSERT(vertexShader.exists());
+
+    QFile fragmentShader(":/GLC_lib_Shaders/instancing_frag");
+    Q_ASSERT(fragmentShader.exists());
+
+    m_pInstancingShader= new GLC_Shader(vertexShader, fragmentShader);
+    m_pInstancingShader->setName("GLC_lib Instancing Shader");
+    m_pInstancingShader->createAndCompileProgrammShader();
+}
+
 void GLC_ContextSharedData::initLightEnableState()
 {
     const int count= GLC_Light::maxLightCount();
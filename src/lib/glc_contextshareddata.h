@@ -71,6 +71,10 @@ public:
     //! Return the vector of enable light
     inline QVector<int> enableLights() const
     {return m_LightsEnableState.values().toVector();}
+
+    //! Return the instancing shader, NULL if instancing is not supported
+    inline GLC_Shader* instancingShaderHandle() const
+    {return m_pInstancingShader;}
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -143,10 +147,14 @@ public:
 
 private:
     void initDefaultShader();
+    void initInstancingShader();
     void initLightEnableState();
 
 private:
     GLC_Shader* m_pDefaultShader;
+
+    //! The shader used by render queues for instanced draws
+    GLC_Shader* m_pInstancingShader;
     bool m_IsClean;
 
     //! The current matrix mode
@@ -34,6 +34,10 @@
 PFNGLPOINTPARAMETERFARBPROC			glPointParameterf		= NULL;
 PFNGLPOINTPARAMETERFVARBPROC		glPointParameterfv		= NULL;
 
+// GL_ARB_draw_instanced and GL_ARB_instanced_arrays Instancing
+PFNGLDRAWELEMENTSINSTANCEDARBPROC	glcDrawElementsInstanced	= NULL;
+PFNGLVERTEXATTRIBDIVISORPROC		glcVertexAttribDivisor		= NULL;
+
 #endif
 
 
@@ -76,3 +80,20 @@ bool glc::loadPointSpriteExtension()
     return result;
 }
 
+// Load instanced draw and instanced arrays extensions
+bool glc::loadInstancingExtension()
+{
+	bool result= false;
+#if !defined(Q_OS_MAC)
+    const QOpenGLContext* pContext= QOpenGLContext::currentContext();
+    glcDrawElementsInstanced		= (PFNGLDRAWELEMENTSINSTANCEDARBPROC)pContext->getProcAddress("glDrawElementsInstancedARB");
+	if (!glcDrawElementsInstanced) qDebug() << "not glDrawElementsInstancedARB";
+    glcVertexAttribDivisor			= (PFNGLVERTEXATTRIBDIVISORPROC)pContext->getProcAddress("glVertexAttribDivisorARB");
+	if (!glcVertexAttribDivisor) qDebug() << "not glVertexAttribDivisorARB";
+
+	result= glcDrawElementsInstanced && glcVertexAttribDivisor;
+
+#endif
+    return result;
+}
+
@@ -33,6 +33,10 @@
 extern PFNGLPOINTPARAMETERFARBPROC  glPointParameterf;
 extern PFNGLPOINTPARAMETERFVARBPROC glPointParameterfv;
 
+// GL_ARB_draw_instanced and GL_ARB_instanced_arrays Instancing
+extern PFNGLDRAWELEMENTSINSTANCEDARBPROC glcDrawElementsInstanced;
+extern PFNGLVERTEXATTRIBDIVISORPROC glcVertexAttribDivisor;
+
 #endif
 
 // Buffer offset used by VBO
@@ -52,5 +56,8 @@ namespace glc
 
 	//! Load Point Sprite extension
 	bool loadPointSpriteExtension();
+
+	//! Load instanced draw and instanced arrays extensions
+	bool loadInstancingExtension();
 };
 #endif /*GLC_EXT_H_*/
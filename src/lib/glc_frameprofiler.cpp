@@ -0,0 +1,497 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_frameprofiler.cpp implementation of the GLC_FrameProfiler class.
+
+#include <QThread>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QMutexLocker>
+
+#if !defined(QT_OPENGL_ES_2)
+#include <QOpenGLTimerQuery>
+#endif
+
+#include "glc_frameprofiler.h"
+#include "glc_renderstatistics.h"
+
+// The default number of kept frames
+#define GLC_FRAMEPROFILER_CAPACITY 120
+
+// The thread index of the GPU passes in the trace
+#define GLC_FRAMEPROFILER_GPU_THREAD 0
+
+// Static variables initialisation
+bool GLC_FrameProfiler::m_IsActivated= false;
+int GLC_FrameProfiler::m_FrameCapacity= GLC_FRAMEPROFILER_CAPACITY;
+QList<GLC_FrameProfiler::Frame> GLC_FrameProfiler::m_Frames;
+GLC_FrameProfiler::Frame GLC_FrameProfiler::m_CurrentFrame= {0, 0, 0, QVector<GLC_FrameProfiler::Scope>(), QHash<QByteArray, qint64>(), QVector<GLC_FrameProfiler::GpuPass>(), 0, 0, 0, 0, 0};
+int GLC_FrameProfiler::m_NextFrameNumber= 0;
+QElapsedTimer GLC_FrameProfiler::m_Timer;
+QHash<Qt::HANDLE, int> GLC_FrameProfiler::m_ThreadIndexes;
+QList<GLC_FrameProfiler::GpuQuery> GLC_FrameProfiler::m_PendingQueries;
+QList<QOpenGLTimerQuery*> GLC_FrameProfiler::m_FreeQueries;
+GLC_FrameProfiler::GpuQuery GLC_FrameProfiler::m_CurrentQuery= {NULL, NULL, -1};
+bool GLC_FrameProfiler::m_GpuQueriesAreUnsupported= false;
+QAtomicInt GLC_FrameProfiler::m_DrawCallCount(0);
+QAtomicInt GLC_FrameProfiler::m_StateChangeCount(0);
+QAtomicInteger<qint64> GLC_FrameProfiler::m_UploadBytes(0);
+QAtomicInteger<qint64> GLC_FrameProfiler::m_LodChoiceDuration(0);
+unsigned int GLC_FrameProfiler::m_BodyCountAtBegin= 0;
+unsigned long GLC_FrameProfiler::m_TriangleCountAtBegin= 0;
+QMutex GLC_FrameProfiler::m_Mutex;
+
+GLC_FrameProfiler::GLC_FrameProfiler()
+{
+
+}
+
+GLC_FrameProfiler::~GLC_FrameProfiler()
+{
+
+}
+
+//////////////////////////////////////////////////////////////////////
+// Get methods
+//////////////////////////////////////////////////////////////////////
+int GLC_FrameProfiler::frameCapacity()
+{
+	QMutexLocker locker(&m_Mutex);
+	return m_FrameCapacity;
+}
+
+QList<GLC_FrameProfiler::Frame> GLC_FrameProfiler::frames()
+{
+	QMutexLocker locker(&m_Mutex);
+	return m_Frames;
+}
+
+GLC_FrameProfiler::Frame GLC_FrameProfiler::lastFrame()
+{
+	QMutexLocker locker(&m_Mutex);
+	if (m_Frames.isEmpty())
+	{
+		Frame frame;
+		clearFrame(&frame);
+		frame.m_Number= -1;
+		return frame;
+	}
+	return m_Frames.last();
+}
+
+QVariantMap GLC_FrameProfiler::summary()
+{
+	QMutexLocker locker(&m_Mutex);
+	QVariantMap subject;
+	if (m_Frames.isEmpty()) return subject;
+
+	const Frame& frame= m_Frames.last();
+	subject.insert("frameNumber", frame.m_Number);
+	subject.insert("frameTime", static_cast<double>(frame.m_Duration) / 1000000.0);
+
+	qint64 totalDuration= 0;
+	const int frameCount= m_Frames.size();
+	for (int i= 0; i < frameCount; ++i)
+	{
+		totalDuration+= m_Frames.at(i).m_Duration;
+	}
+	subject.insert("averageFrameTime", static_cast<double>(totalDuration) / (1000000.0 * frameCount));
+
+	subject.insert("drawCalls", frame.m_DrawCallCount);
+	subject.insert("stateChanges", frame.m_StateChangeCount);
+	subject.insert("uploadBytes", frame.m_UploadBytes);
+	subject.insert("bodies", frame.m_BodyCount);
+	subject.insert("triangles", static_cast<qulonglong>(frame.m_TriangleCount));
+
+	QVariantMap scopes;
+	QHash<QByteArray, qint64>::const_iterator iScope= frame.m_ScopeDurations.constBegin();
+	while (iScope != frame.m_ScopeDurations.constEnd())
+	{
+		scopes.insert(QString::fromLatin1(iScope.key()), static_cast<double>(iScope.value()) / 1000000.0);
+		++iScope;
+	}
+	subject.insert("scopes", scopes);
+
+	// The GPU passes of the last frame are not read yet, use the last frame which have some
+	QVariantMap gpuPasses;
+	int index= frameCount - 1;
+	while ((index >= 0) && m_Frames.at(index).m_GpuPasses.isEmpty())
+	{
+		--index;
+	}
+	if (index >= 0)
+	{
+		const QVector<GpuPass>& passes= m_Frames.at(index).m_GpuPasses;
+		const int passCount= passes.size();
+		for (int i= 0; i < passCount; ++i)
+		{
+			const QString name(QString::fromLatin1(passes.at(i).m_pName));
+			const double duration= static_cast<double>(passes.at(i).m_Duration) / 1000000.0;
+			gpuPasses.insert(name, gpuPasses.value(name, 0.0).toDouble() + duration);
+		}
+	}
+	subject.insert("gpuPasses", gpuPasses);
+
+	return subject;
+}
+
+QByteArray GLC_FrameProfiler::chromeTrace()
+{
+	QMutexLocker locker(&m_Mutex);
+	QJsonArray events;
+
+	// Thread names
+	QJsonObject gpuThread;
+	gpuThread.insert("name", QString("thread_name"));
+	gpuThread.insert("ph", QString("M"));
+	gpuThread.insert("pid", 1);
+	gpuThread.insert("tid", GLC_FRAMEPROFILER_GPU_THREAD);
+	QJsonObject gpuThreadArgs;
+	gpuThreadArgs.insert("name", QString("GPU"));
+	gpuThread.insert("args", gpuThreadArgs);
+	events.append(gpuThread);
+
+	const int threadCount= m_ThreadIndexes.size();
+	for (int i= 1; i <= threadCount; ++i)
+	{
+		QJsonObject cpuThread;
+		cpuThread.insert("name", QString("thread_name"));
+		cpuThread.insert("ph", QString("M"));
+		cpuThread.insert("pid", 1);
+		cpuThread.insert("tid", i);
+		QJsonObject cpuThreadArgs;
+		cpuThreadArgs.insert("name", QString("CPU %1").arg(i));
+		cpuThread.insert("args", cpuThreadArgs);
+		events.append(cpuThread);
+	}
+
+	// Time stamps are in microseconds
+	const int frameCount= m_Frames.size();
+	for (int i= 0; i < frameCount; ++i)
+	{
+		const Frame& frame= m_Frames.at(i);
+		const double frameStart= static_cast<double>(frame.m_Start) / 1000.0;
+
+		QJsonObject frameEvent;
+		frameEvent.insert("name", QString("Frame %1").arg(frame.m_Number));
+		frameEvent.insert("cat", QString("frame"));
+		frameEvent.insert("ph", QString("X"));
+		frameEvent.insert("ts", frameStart);
+		frameEvent.insert("dur", static_cast<double>(frame.m_Duration) / 1000.0);
+		frameEvent.insert("pid", 1);
+		frameEvent.insert("tid", 1);
+		events.append(frameEvent);
+
+		const int scopeCount= frame.m_Scopes.size();
+		for (int iScope= 0; iScope < scopeCount; ++iScope)
+		{
+			const Scope& scope= frame.m_Scopes.at(iScope);
+			QJsonObject scopeEvent;
+			scopeEvent.insert("name", QString::fromLatin1(scope.m_pName));
+			scopeEvent.insert("cat", QString("cpu"));
+			scopeEvent.insert("ph", QString("X"));
+			scopeEvent.insert("ts", static_cast<double>(scope.m_Start) / 1000.0);
+			scopeEvent.insert("dur", static_cast<double>(scope.m_Duration) / 1000.0);
+			scopeEvent.insert("pid", 1);
+			scopeEvent.insert("tid", scope.m_Thread);
+			events.append(scopeEvent);
+		}
+
+		// The GPU passes are laid out one after the other from the frame start
+		double gpuTime= frameStart;
+		const int passCount= frame.m_GpuPasses.size();
+		for (int iPass= 0; iPass < passCount; ++iPass)
+		{
+			const GpuPass& pass= frame.m_GpuPasses.at(iPass);
+			const double duration= static_cast<double>(pass.m_Duration) / 1000.0;
+			QJsonObject passEvent;
+			passEvent.insert("name", QString::fromLatin1(pass.m_pName));
+			passEvent.insert("cat", QString("gpu"));
+			passEvent.insert("ph", QString("X"));
+			passEvent.insert("ts", gpuTime);
+			passEvent.insert("dur", duration);
+			passEvent.insert("pid", 1);
+			passEvent.insert("tid", GLC_FRAMEPROFILER_GPU_THREAD);
+			events.append(passEvent);
+			gpuTime+= duration;
+		}
+
+		QJsonObject counterArgs;
+		counterArgs.insert("drawCalls", frame.m_DrawCallCount);
+		counterArgs.insert("stateChanges", frame.m_StateChangeCount);
+		counterArgs.insert("uploadBytes", static_cast<double>(frame.m_UploadBytes));
+		counterArgs.insert("bodies", static_cast<double>(frame.m_BodyCount));
+		counterArgs.insert("triangles", static_cast<double>(frame.m_TriangleCount));
+		QJsonObject counterEvent;
+		counterEvent.insert("name", QString("Counters"));
+		counterEvent.insert("ph", QString("C"));
+		counterEvent.insert("ts", frameStart);
+		counterEvent.insert("pid", 1);
+		counterEvent.insert("args", counterArgs);
+		events.append(counterEvent);
+	}
+
+	QJsonObject trace;
+	trace.insert("traceEvents", events);
+	trace.insert("displayTimeUnit", QString("ms"));
+
+	return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Set methods
+//////////////////////////////////////////////////////////////////////
+void GLC_FrameProfiler::setActivationFlag(bool flag)
+{
+	QMutexLocker locker(&m_Mutex);
+	if (!m_Timer.isValid())
+	{
+		m_Timer.start();
+	}
+	m_IsActivated= flag;
+}
+
+void GLC_FrameProfiler::setFrameCapacity(int capacity)
+{
+	Q_ASSERT(capacity > 0);
+	QMutexLocker locker(&m_Mutex);
+	m_FrameCapacity= capacity;
+	while (m_Frames.size() > m_FrameCapacity)
+	{
+		m_Frames.removeFirst();
+	}
+}
+
+void GLC_FrameProfiler::reset()
+{
+	QMutexLocker locker(&m_Mutex);
+	m_Frames.clear();
+	clearFrame(&m_CurrentFrame);
+	m_ThreadIndexes.clear();
+}
+
+void GLC_FrameProfiler::glDeleteGpuQueries()
+{
+	QMutexLocker locker(&m_Mutex);
+#if !defined(QT_OPENGL_ES_2)
+	const int pendingCount= m_PendingQueries.size();
+	for (int i= 0; i < pendingCount; ++i)
+	{
+		delete m_PendingQueries.at(i).m_pQuery;
+	}
+	qDeleteAll(m_FreeQueries);
+	delete m_CurrentQuery.m_pQuery;
+#endif
+	m_PendingQueries.clear();
+	m_FreeQueries.clear();
+	m_CurrentQuery.m_pQuery= NULL;
+	m_GpuQueriesAreUnsupported= false;
+}
+
+void GLC_FrameProfiler::beginFrame()
+{
+	if (!m_IsActivated) return;
+
+	QMutexLocker locker(&m_Mutex);
+	clearFrame(&m_CurrentFrame);
+	m_CurrentFrame.m_Number= m_NextFrameNumber++;
+	m_CurrentFrame.m_Start= m_Timer.nsecsElapsed();
+	m_DrawCallCount.fetchAndStoreRelaxed(0);
+	m_StateChangeCount.fetchAndStoreRelaxed(0);
+	m_UploadBytes.fetchAndStoreRelaxed(0);
+	m_LodChoiceDuration.fetchAndStoreRelaxed(0);
+
+	// The render statistics belong to the application, they are read, not reset
+	m_BodyCountAtBegin= GLC_RenderStatistics::bodyCount();
+	m_TriangleCountAtBegin= GLC_RenderStatistics::triangleCount();
+}
+
+void GLC_FrameProfiler::endFrame()
+{
+	if (!m_IsActivated) return;
+
+	QMutexLocker locker(&m_Mutex);
+	m_CurrentFrame.m_Duration= m_Timer.nsecsElapsed() - m_CurrentFrame.m_Start;
+	m_CurrentFrame.m_DrawCallCount= m_DrawCallCount.fetchAndStoreRelaxed(0);
+	m_CurrentFrame.m_StateChangeCount= m_StateChangeCount.fetchAndStoreRelaxed(0);
+	m_CurrentFrame.m_UploadBytes= m_UploadBytes.fetchAndStoreRelaxed(0);
+	const qint64 lodChoiceDuration= m_LodChoiceDuration.fetchAndStoreRelaxed(0);
+	if (lodChoiceDuration > 0)
+	{
+		m_CurrentFrame.m_ScopeDurations[QByteArray("LOD choice")]+= lodChoiceDuration;
+	}
+
+	// The application may have reset the render statistics during the frame
+	const unsigned int bodyCount= GLC_RenderStatistics::bodyCount();
+	const unsigned long triangleCount= GLC_RenderStatistics::triangleCount();
+	m_CurrentFrame.m_BodyCount= (bodyCount >= m_BodyCountAtBegin) ? (bodyCount - m_BodyCountAtBegin) : bodyCount;
+	m_CurrentFrame.m_TriangleCount= (triangleCount >= m_TriangleCountAtBegin) ? (triangleCount - m_TriangleCountAtBegin) : triangleCount;
+
+	m_Frames.append(m_CurrentFrame);
+	while (m_Frames.size() > m_FrameCapacity)
+	{
+		m_Frames.removeFirst();
+	}
+
+	readGpuPasses();
+}
+
+void GLC_FrameProfiler::addScope(const char* pName, qint64 start, qint64 duration, bool traced)
+{
+	QMutexLocker locker(&m_Mutex);
+
+	// The name is a literal, its data is not copied
+	m_CurrentFrame.m_ScopeDurations[QByteArray::fromRawData(pName, qstrlen(pName))]+= duration;
+	if (traced)
+	{
+		Scope scope;
+		scope.m_pName= pName;
+		scope.m_Start= start;
+		scope.m_Duration= duration;
+		scope.m_Thread= currentThreadIndex();
+		m_CurrentFrame.m_Scopes.append(scope);
+	}
+}
+
+void GLC_FrameProfiler::beginGpuPass(const char* pName)
+{
+#if !defined(QT_OPENGL_ES_2)
+	if (!m_IsActivated || m_GpuQueriesAreUnsupported) return;
+
+	QMutexLocker locker(&m_Mutex);
+
+	// A pass left open by an exception is ended
+	if (NULL != m_CurrentQuery.m_pQuery)
+	{
+		m_CurrentQuery.m_pQuery->end();
+		m_PendingQueries.append(m_CurrentQuery);
+		m_CurrentQuery.m_pQuery= NULL;
+	}
+
+	QOpenGLTimerQuery* pQuery= NULL;
+	if (!m_FreeQueries.isEmpty())
+	{
+		pQuery= m_FreeQueries.takeLast();
+	}
+	else
+	{
+		pQuery= new QOpenGLTimerQuery;
+		if (!pQuery->create())
+		{
+			delete pQuery;
+			m_GpuQueriesAreUnsupported= true;
+			return;
+		}
+	}
+
+	pQuery->begin();
+	m_CurrentQuery.m_pQuery= pQuery;
+	m_CurrentQuery.m_pName= pName;
+	m_CurrentQuery.m_FrameNumber= m_CurrentFrame.m_Number;
+#else
+	Q_UNUSED(pName);
+#endif
+}
+
+void GLC_FrameProfiler::endGpuPass()
+{
+#if !defined(QT_OPENGL_ES_2)
+	QMutexLocker locker(&m_Mutex);
+	if (NULL != m_CurrentQuery.m_pQuery)
+	{
+		m_CurrentQuery.m_pQuery->end();
+		m_PendingQueries.append(m_CurrentQuery);
+		m_CurrentQuery.m_pQuery= NULL;
+	}
+#endif
+}
+
+qint64 GLC_FrameProfiler::currentTime()
+{
+	return m_Timer.nsecsElapsed();
+}
+
+bool GLC_FrameProfiler::exportChromeTrace(const QString& fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+	const QByteArray trace(chromeTrace());
+	const bool subject= (file.write(trace) == trace.size());
+	file.close();
+	return subject;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+int GLC_FrameProfiler::currentThreadIndex()
+{
+	const Qt::HANDLE threadId= QThread::currentThreadId();
+	if (!m_ThreadIndexes.contains(threadId))
+	{
+		// The index 0 is the GPU
+		m_ThreadIndexes.insert(threadId, m_ThreadIndexes.size() + 1);
+	}
+	return m_ThreadIndexes.value(threadId);
+}
+
+void GLC_FrameProfiler::clearFrame(Frame* pFrame)
+{
+	pFrame->m_Number= 0;
+	pFrame->m_Start= 0;
+	pFrame->m_Duration= 0;
+	pFrame->m_Scopes.clear();
+	pFrame->m_ScopeDurations.clear();
+	pFrame->m_GpuPasses.clear();
+	pFrame->m_DrawCallCount= 0;
+	pFrame->m_StateChangeCount= 0;
+	pFrame->m_UploadBytes= 0;
+	pFrame->m_BodyCount= 0;
+	pFrame->m_TriangleCount= 0;
+}
+
+void GLC_FrameProfiler::readGpuPasses()
+{
+#if !defined(QT_OPENGL_ES_2)
+	// The queries end in order, stop at the first one without result
+	while (!m_PendingQueries.isEmpty() && m_PendingQueries.first().m_pQuery->isResultAvailable())
+	{
+		const GpuQuery query= m_PendingQueries.takeFirst();
+		GpuPass pass;
+		pass.m_pName= query.m_pName;
+		pass.m_Duration= static_cast<qint64>(query.m_pQuery->waitForResult());
+		m_FreeQueries.append(query.m_pQuery);
+
+		// The frame of the query may have left the ring buffer
+		const int frameCount= m_Frames.size();
+		for (int i= frameCount - 1; i >= 0; --i)
+		{
+			if (m_Frames.at(i).m_Number == query.m_FrameNumber)
+			{
+				m_Frames[i].m_GpuPasses.append(pass);
+				break;
+			}
+		}
+	}
+#endif
+}
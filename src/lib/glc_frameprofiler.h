@@ -0,0 +1,358 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_frameprofiler.h interface for the GLC_FrameProfiler class.
+
+#ifndef GLC_FRAMEPROFILER_H_
+#define GLC_FRAMEPROFILER_H_
+
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+#include <QVariantMap>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+
+#include "glc_config.h"
+
+class QOpenGLTimerQuery;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_FrameProfiler
+/*! \brief GLC_FrameProfiler is use to collect the timings and the counters of the last frames*/
+
+/*! A frame starts with beginFrame() and ends with endFrame(). In between,
+ *  GLC_ProfileScope measures the CPU time of named scopes, beginGpuPass() and
+ *  endGpuPass() measure the GPU time of a render pass with a timer query and
+ *  the draw calls, the state changes and the uploaded buffer bytes are
+ *  counted. The body and triangle counts of the frame are read from
+ *  GLC_RenderStatistics, they stay at 0 unless the application activates the
+ *  render statistics : the profiler never activates nor resets them.
+ *
+ *  The last frameCapacity() frames are kept in a ring buffer, they can be
+ *  exported in the Chrome trace event format with chromeTrace() and the last
+ *  frame is summarized by summary().
+ *
+ *  The timer query results are read when available at the end of a later
+ *  frame, so the GPU passes of a frame are filled one or two frames late.
+ *
+ *  Scope names must be string literals : the name pointers are stored.
+ *  Nothing is recorded while the profiler is not activated.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_FrameProfiler
+{
+public:
+	//! A timed scope of a frame
+	struct Scope
+	{
+		//! The name of the scope
+		const char* m_pName;
+
+		//! The start time in nanoseconds
+		qint64 m_Start;
+
+		//! The duration in nanoseconds
+		qint64 m_Duration;
+
+		//! The index of the thread which has run the scope
+		int m_Thread;
+	};
+
+	//! A timed GPU pass of a frame
+	struct GpuPass
+	{
+		//! The name of the pass
+		const char* m_pName;
+
+		//! The duration in nanoseconds
+		qint64 m_Duration;
+	};
+
+	//! A profiled frame
+	struct Frame
+	{
+		//! The number of the frame
+		int m_Number;
+
+		//! The start time in nanoseconds
+		qint64 m_Start;
+
+		//! The duration in nanoseconds
+		qint64 m_Duration;
+
+		//! The traced scopes
+		QVector<Scope> m_Scopes;
+
+		//! The total duration of each scope name, traced or not
+		QHash<QByteArray, qint64> m_ScopeDurations;
+
+		//! The GPU passes
+		QVector<GpuPass> m_GpuPasses;
+
+		//! The number of draw calls
+		int m_DrawCallCount;
+
+		//! The number of state changes
+		int m_StateChangeCount;
+
+		//! The number of bytes uploaded to buffer objects
+		qint64 m_UploadBytes;
+
+		//! The number of rendered bodies
+		unsigned int m_BodyCount;
+
+		//! The number of rendered triangles
+		unsigned long m_TriangleCount;
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Private constructor. This class is static only
+	GLC_FrameProfiler();
+	virtual ~GLC_FrameProfiler();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return true if the profiler is activated
+	static inline bool activated()
+	{return m_IsActivated;}
+
+	//! Return the maximum number of kept frames
+	static int frameCapacity();
+
+	//! Return the list of kept frames, the oldest first
+	static QList<Frame> frames();
+
+	//! Return the last ended frame
+	/*! Return a frame numbered -1 if no frame has been ended*/
+	static Frame lastFrame();
+
+	//! Return the summary of the last ended frame
+	/*! The durations are in milliseconds*/
+	static QVariantMap summary();
+
+	//! Return the kept frames in the Chrome trace event JSON format
+	static QByteArray chromeTrace();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set activation flag to the given flag
+	static void setActivationFlag(bool flag);
+
+	//! Set the maximum number of kept frames
+	static void setFrameCapacity(int capacity);
+
+	//! Remove the kept frames
+	static void reset();
+
+	//! Delete the timer queries
+	/*! The OpenGL context of the timer queries must be current*/
+	static void glDeleteGpuQueries();
+
+	//! Begin a new frame
+	static void beginFrame();
+
+	//! End the current frame and push it in the ring buffer
+	static void endFrame();
+
+	//! Add the given scope duration to the current frame, traced or not
+	static void addScope(const char* pName, qint64 start, qint64 duration, bool traced);
+
+	//! Add draw calls to the current frame
+	/*! Lock free, can be called from any thread*/
+	static inline void addDrawCalls(int count)
+	{if (m_IsActivated) m_DrawCallCount.fetchAndAddRelaxed(count);}
+
+	//! Add state changes to the current frame
+	/*! Lock free, can be called from any thread*/
+	static inline void addStateChanges(int count)
+	{if (m_IsActivated) m_StateChangeCount.fetchAndAddRelaxed(count);}
+
+	//! Add uploaded buffer bytes to the current frame
+	/*! Lock free, can be called from any thread*/
+	static inline void addUploadBytes(qint64 bytes)
+	{if (m_IsActivated) m_UploadBytes.fetchAndAddRelaxed(bytes);}
+
+	//! Add the given duration of LOD choices to the current frame
+	/*! Lock free, the total is added to the "LOD choice" scope duration at the end of the frame*/
+	static inline void addLodChoiceDuration(qint64 duration)
+	{if (m_IsActivated) m_LodChoiceDuration.fetchAndAddRelaxed(duration);}
+
+	//! Begin the GPU pass of the given name in the current OpenGL context
+	static void beginGpuPass(const char* pName);
+
+	//! End the current GPU pass
+	static void endGpuPass();
+
+	//! Return the time in nanoseconds since the profiler clock start
+	static qint64 currentTime();
+
+	//! Write the Chrome trace of the kept frames in the given file
+	/*! Return true on success*/
+	static bool exportChromeTrace(const QString& fileName);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Return the index of the current thread
+	static int currentThreadIndex();
+
+	//! Reset the given frame counters and timings
+	static void clearFrame(Frame* pFrame);
+
+	//! Read the available timer query results
+	static void readGpuPasses();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! A pending timer query
+	struct GpuQuery
+	{
+		//! The query
+		QOpenGLTimerQuery* m_pQuery;
+
+		//! The name of the pass
+		const char* m_pName;
+
+		//! The number of the frame of the pass
+		int m_FrameNumber;
+	};
+
+	//! Flag to know if the profiler is activated
+	static bool m_IsActivated;
+
+	//! The maximum number of kept frames
+	static int m_FrameCapacity;
+
+	//! The kept frames
+	static QList<Frame> m_Frames;
+
+	//! The current frame
+	static Frame m_CurrentFrame;
+
+	//! The number of the next frame
+	static int m_NextFrameNumber;
+
+	//! The profiler clock
+	static QElapsedTimer m_Timer;
+
+	//! The index of each profiled thread
+	static QHash<Qt::HANDLE, int> m_ThreadIndexes;
+
+	//! The timer queries waiting for their result
+	static QList<GpuQuery> m_PendingQueries;
+
+	//! The timer queries which can be reused
+	static QList<QOpenGLTimerQuery*> m_FreeQueries;
+
+	//! The current GPU pass query
+	static GpuQuery m_CurrentQuery;
+
+	//! True if timer queries are not supported by the OpenGL context
+	static bool m_GpuQueriesAreUnsupported;
+
+	//! The number of draw calls of the current frame
+	static QAtomicInt m_DrawCallCount;
+
+	//! The number of state changes of the current frame
+	static QAtomicInt m_StateChangeCount;
+
+	//! The number of bytes uploaded to buffer objects during the current frame
+	static QAtomicInteger<qint64> m_UploadBytes;
+
+	//! The duration of the LOD choices of the current frame
+	static QAtomicInteger<qint64> m_LodChoiceDuration;
+
+	//! The render statistics body count at the beginning of the current frame
+	static unsigned int m_BodyCountAtBegin;
+
+	//! The render statistics triangle count at the beginning of the current frame
+	static unsigned long m_TriangleCountAtBegin;
+
+	//! The profiler mutex
+	static QMutex m_Mutex;
+};
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_ProfileScope
+/*! \brief GLC_ProfileScope measure the CPU time of a scope for GLC_FrameProfiler*/
+
+/*! The time between the construction and the destruction is added to the
+ *  current frame of the profiler under the given name. An untraced scope is
+ *  only added to the total duration of its name, it is used for scopes run
+ *  once by body to keep the trace small.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_ProfileScope
+{
+public:
+	//! Start the scope of the given name, a string literal
+	inline GLC_ProfileScope(const char* pName, bool traced= true)
+	: m_pName(pName)
+	, m_Start(GLC_FrameProfiler::activated() ? GLC_FrameProfiler::currentTime() : -1)
+	, m_Traced(traced)
+	{}
+
+	//! End the scope
+	inline ~GLC_ProfileScope()
+	{
+		if (m_Start >= 0)
+		{
+			GLC_FrameProfiler::addScope(m_pName, m_Start, GLC_FrameProfiler::currentTime() - m_Start, m_Traced);
+		}
+	}
+
+private:
+	Q_DISABLE_COPY(GLC_ProfileScope)
+
+	//! The name of the scope
+	const char* m_pName;
+
+	//! The start time, -1 if the profiler is not activated
+	qint64 m_Start;
+
+	//! True if the scope is traced
+	bool m_Traced;
+};
+
+#endif /* GLC_FRAMEPROFILER_H_ */
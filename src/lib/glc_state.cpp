@@ -33,6 +33,7 @@
 
 bool GLC_State::m_UseVbo= true;
 bool GLC_State::m_PointSpriteSupported= true;
+bool GLC_State::m_IsInstancingSupported= false;
 bool GLC_State::m_UseShader= true;
 bool GLC_State::m_UseSelectionShader= false;
 bool GLC_State::m_IsInSelectionMode= false;
@@ -50,6 +51,16 @@ GLC_CacheManager GLC_State::m_CacheManager;
 
 bool GLC_State::m_IsSpacePartitionningActivated= false;
 bool GLC_State::m_IsFrustumCullingActivated= false;
+bool GLC_State::m_IsStlVertexWeldingActivated= false;
+bool GLC_State::m_IsParallelLoadingActivated= false;
+bool GLC_State::m_IsParallelExportActivated= false;
+bool GLC_State::m_IsAutomaticLodActivated= false;
+QList<double> GLC_State::m_AutomaticLodRatios= QList<double>() << 0.5 << 0.25 << 0.1;
+bool GLC_State::m_IsVertexCacheOptimizationActivated= false;
+bool GLC_State::m_IsRenderQueueActivated= false;
+bool GLC_State::m_IsOcclusionCullingActivated= false;
+bool GLC_State::m_IsTextureReleaseActivated= true;
+bool GLC_State::m_IsMeshBvhActivated= false;
 bool GLC_State::m_IsValid= false;
 
 GLC_State::~GLC_State()
@@ -84,6 +95,12 @@ bool GLC_State::pointSpriteSupported()
     return m_PointSpriteSupported;
 }
 
+bool GLC_State::instancingSupported()
+{
+    Q_ASSERT(m_IsValid);
+    return m_IsInstancingSupported;
+}
+
 bool GLC_State::selectionShaderUsed()
 {
     Q_ASSERT(m_IsValid);
@@ -151,12 +168,63 @@ bool GLC_State::isFrustumCullingActivated()
     return m_IsFrustumCullingActivated;
 }
 
+bool GLC_State::isStlVertexWeldingActivated()
+{
+    return m_IsStlVertexWeldingActivated;
+}
+
+bool GLC_State::isParallelLoadingActivated()
+{
+    return m_IsParallelLoadingActivated;
+}
+
+bool GLC_State::isParallelExportActivated()
+{
+    return m_IsParallelExportActivated;
+}
+
+bool GLC_State::isAutomaticLodActivated()
+{
+    return m_IsAutomaticLodActivated;
+}
+
+QList<double> GLC_State::automaticLodRatios()
+{
+    return m_AutomaticLodRatios;
+}
+
+bool GLC_State::isVertexCacheOptimizationActivated()
+{
+    return m_IsVertexCacheOptimizationActivated;
+}
+
+bool GLC_State::isRenderQueueActivated()
+{
+    return m_IsRenderQueueActivated;
+}
+
+bool GLC_State::isOcclusionCullingActivated()
+{
+    return m_IsOcclusionCullingActivated;
+}
+
+bool GLC_State::isTextureReleaseActivated()
+{
+    return m_IsTextureReleaseActivated;
+}
+
+bool GLC_State::isMeshBvhActivated()
+{
+    return m_IsMeshBvhActivated;
+}
+
 void GLC_State::init()
 {
     if (!m_IsValid)
     {
         Q_ASSERT((NULL != QOpenGLContext::currentContext()) &&  QOpenGLContext::currentContext()->isValid());
         setPointSpriteSupport();
+        setInstancingSupport();
         setFrameBufferSupport();
         setFrameBufferBlitSupport();
         m_Version= (char *) glGetString(GL_VERSION);
@@ -183,6 +251,12 @@ void GLC_State::setPointSpriteSupport()
     Q_ASSERT(m_PointSpriteSupported);
 }
 
+void GLC_State::setInstancingSupport()
+{
+    m_IsInstancingSupported= m_UseShader && glc::extensionIsSupported("GL_ARB_draw_instanced")
+            && glc::extensionIsSupported("GL_ARB_instanced_arrays") && glc::loadInstancingExtension();
+}
+
 void GLC_State::setFrameBufferSupport()
 {
     m_IsFrameBufferSupported= QOpenGLFramebufferObject::hasOpenGLFramebufferObjects();
@@ -237,3 +311,53 @@ void GLC_State::setFrustumCullingUsage(bool usage)
 {
     m_IsFrustumCullingActivated= usage;
 }
+
+void GLC_State::setStlVertexWeldingUsage(bool usage)
+{
+    m_IsStlVertexWeldingActivated= usage;
+}
+
+void GLC_State::setParallelLoadingUsage(bool usage)
+{
+    m_IsParallelLoadingActivated= usage;
+}
+
+void GLC_State::setParallelExportUsage(bool usage)
+{
+    m_IsParallelExportActivated= usage;
+}
+
+void GLC_State::setAutomaticLodUsage(bool usage)
+{
+    m_IsAutomaticLodActivated= usage;
+}
+
+void GLC_State::setAutomaticLodRatios(const QList<double>& ratios)
+{
+    m_AutomaticLodRatios= ratios;
+}
+
+void GLC_State::setVertexCacheOptimizationUsage(bool usage)
+{
+    m_IsVertexCacheOptimizationActivated= usage;
+}
+
+void GLC_State::setRenderQueueUsage(bool usage)
+{
+    m_IsRenderQueueActivated= usage;
+}
+
+void GLC_State::setOcclusionCullingUsage(bool usage)
+{
+    m_IsOcclusionCullingActivated= usage;
+}
+
+void GLC_State::setTextureReleaseUsage(bool usage)
+{
+    m_IsTextureReleaseActivated= usage;
+}
+
+void GLC_State::setMeshBvhUsage(bool usage)
+{
+    m_IsMeshBvhActivated= usage;
+}
@@ -26,6 +26,7 @@
 #define GLC_STATE_H_
 
 #include <QString>
+#include <QList>
 
 #include "glc_cachemanager.h"
 
@@ -65,6 +66,9 @@ public:
 	//! Return true if Point Sprite is supported
 	static bool pointSpriteSupported();
 
+	//! Return true if instanced draws with per instance attributes are supported
+	static bool instancingSupported();
+
 	//! Return true if selection shader is used
 	static bool selectionShaderUsed();
 
@@ -101,6 +105,36 @@ public:
 	//! Return true if frustum culling is activated
 	static bool isFrustumCullingActivated();
 
+	//! Return true if duplicated vertices of binary STL are welded at loading
+	static bool isStlVertexWeldingActivated();
+
+	//! Return true if file loaders use worker threads
+	static bool isParallelLoadingActivated();
+
+	//! Return true if file writers use worker threads
+	static bool isParallelExportActivated();
+
+	//! Return true if LODs are generated for loaded meshes without LOD
+	static bool isAutomaticLodActivated();
+
+	//! Return the triangles count ratio of each automatically generated LOD
+	static QList<double> automaticLodRatios();
+
+	//! Return true if finished meshes are optimized for the GPU vertex caches
+	static bool isVertexCacheOptimizationActivated();
+
+	//! Return true if the opaque instances are drawn with a render queue
+	static bool isRenderQueueActivated();
+
+	//! Return true if the instances hidden by the largest occluders are culled
+	static bool isOcclusionCullingActivated();
+
+	//! Return true if the CPU copy of a texture image is released after its upload
+	static bool isTextureReleaseActivated();
+
+	//! Return true if the meshes keep the hierarchies of their triangles when their data move to the VBOs
+	static bool isMeshBvhActivated();
+
 	//! Return true valid
 	static bool isValid();
 //@}
@@ -119,6 +153,9 @@ public:
 	//! Set Point Sprite support
 	static void setPointSpriteSupport();
 
+	//! Set instancing support
+	static void setInstancingSupport();
+
 	//! Set the frame buffer support
 	static void setFrameBufferSupport();
 
@@ -152,6 +189,42 @@ public:
 	//! Set the frustum culling usage
 	static void setFrustumCullingUsage(bool);
 
+	//! Set binary STL vertex welding usage
+	static void setStlVertexWeldingUsage(bool);
+
+	//! Set file loaders worker threads usage
+	static void setParallelLoadingUsage(bool);
+
+	//! Set file writers worker threads usage
+	static void setParallelExportUsage(bool);
+
+	//! Set automatic LOD generation usage
+	static void setAutomaticLodUsage(bool);
+
+	//! Set the triangles count ratio of each automatically generated LOD
+	static void setAutomaticLodRatios(const QList<double>& ratios);
+
+	//! Set vertex cache optimization usage
+	static void setVertexCacheOptimizationUsage(bool);
+
+	//! Set render queue usage
+	/*! If instancing is supported, instances sharing the same mesh are drawn with one instanced draw call*/
+	static void setRenderQueueUsage(bool);
+
+	//! Set occlusion culling usage
+	/*! The occlusion culling is done after the frustum culling of the space partitioning*/
+	static void setOcclusionCullingUsage(bool);
+
+	//! Set texture release usage
+	/*! The CPU copy of a texture image read from a file is released after its upload and read again on demand*/
+	static void setTextureReleaseUsage(bool);
+
+	//! Set mesh hierarchies usage
+	/*! The meshes keep the hierarchies of their LOD 0 and coarsest LOD triangles before their data are
+	 *  released on the client side, so the CPU picking, the section engine and the occlusion culling work
+	 *  after the upload of the meshes. The hierarchies hold a copy of the triangles*/
+	static void setMeshBvhUsage(bool);
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -164,6 +237,9 @@ private:
 	//! Point Sprite supported flag
 	static bool m_PointSpriteSupported;
 
+	//! Instancing supported flag
+	static bool m_IsInstancingSupported;
+
 	//! Use shader
 	static bool m_UseShader;
 
@@ -197,6 +273,36 @@ private:
 	//! Frustum culling activated
 	static bool m_IsFrustumCullingActivated;
 
+	//! Binary STL vertex welding activated
+	static bool m_IsStlVertexWeldingActivated;
+
+	//! File loaders worker threads activated
+	static bool m_IsParallelLoadingActivated;
+
+	//! File writers worker threads activated
+	static bool m_IsParallelExportActivated;
+
+	//! Automatic LOD generation activated
+	static bool m_IsAutomaticLodActivated;
+
+	//! Triangles count ratio of automatically generated LODs
+	static QList<double> m_AutomaticLodRatios;
+
+	//! Vertex cache optimization activated
+	static bool m_IsVertexCacheOptimizationActivated;
+
+	//! Render queue activated
+	static bool m_IsRenderQueueActivated;
+
+	//! Occlusion culling activated
+	static bool m_IsOcclusionCullingActivated;
+
+	//! Texture release activated
+	static bool m_IsTextureReleaseActivated;
+
+	//! Mesh hierarchies activated
+	static bool m_IsMeshBvhActivated;
+
 	//! Frame buffer supported
 	static bool m_IsFrameBufferSupported;
 
@@ -27,7 +27,9 @@
 #include "../glc_fileformatexception.h"
 #include "../geometry/glc_mesh.h"
 #include "../geometry/glc_3drep.h"
+#include "../geometry/glc_meshsimplifier.h"
 #include "glc_xmlutil.h"
+#include "glc_numericparser.h"
 
 // Quazip library
 #include "../3rdparty/quazip/quazip.h"
@@ -37,6 +39,9 @@
 #include <QFileInfo>
 #include <QSet>
 #include <QMutexLocker>
+#include <QtConcurrent>
+
+#include <algorithm>
 
 //using namespace glcXmlUtil;
 
@@ -70,12 +75,15 @@ GLC_3dxmlToWorld::GLC_3dxmlToWorld()
 , m_SetOfAttachedFileName()
 , m_CurrentFileName()
 , m_CurrentDateTime()
+, m_CurrentContentKey()
+, m_MaterialContentKey()
 , m_V3OccurrenceAttribHash()
 , m_V4OccurrenceAttribList()
 , m_GetExternalRef3DName(false)
 , m_ByteArrayList()
 , m_IsVersion3(false)
 , m_UseZipMutex(true)
+, m_pMasterMaterialHash(NULL)
 {
 
 }
@@ -215,16 +223,9 @@ GLC_3DRep GLC_3dxmlToWorld::create3DrepFrom3dxmlRep(const QString& fileName, boo
 
 	if (QFileInfo(m_CurrentFileName).suffix().toLower() == "3dxml")
 	{
-		if (GLC_State::cacheIsUsed() && GLC_State::currentCacheManager().isUsable(m_CurrentDateTime, QFileInfo(m_FileName).baseName(), QFileInfo(m_CurrentFileName).fileName()))
-		{
-			GLC_CacheManager cacheManager = GLC_State::currentCacheManager();
-
-			GLC_BSRep binaryRep = cacheManager.binary3DRep(QFileInfo(m_FileName).baseName(), QFileInfo(m_CurrentFileName).fileName());
-			resultRep = binaryRep.loadRep();
-		}
-		else
+		if (setStreamReaderToFile(m_CurrentFileName, true))
 		{
-			if (setStreamReaderToFile(m_CurrentFileName, true))
+			if (!loadCurrentRepFromCache(&resultRep))
 			{
 				GLC_StructReference* pStructRef = createReferenceRep(QString(), NULL);
 				GLC_3DRep* pRep = NULL;
@@ -244,15 +245,9 @@ GLC_3DRep GLC_3dxmlToWorld::create3DrepFrom3dxmlRep(const QString& fileName, boo
 	}
 	else if ((QFileInfo(m_CurrentFileName).suffix().toLower() == "3drep") || (QFileInfo(m_CurrentFileName).suffix().toLower() == "xml"))
 	{
-        if (GLC_State::cacheIsUsed() && GLC_State::currentCacheManager().isUsable(m_CurrentDateTime, QFileInfo(m_FileName).baseName(), QFileInfo(m_CurrentFileName).fileName()))
-		{
-			GLC_CacheManager cacheManager = GLC_State::currentCacheManager();
-			GLC_BSRep binaryRep = cacheManager.binary3DRep(QFileInfo(m_FileName).baseName(), QFileInfo(m_CurrentFileName).fileName());
-			resultRep = binaryRep.loadRep();
-		}
-		else
+		if (setStreamReaderToFile(m_CurrentFileName, true))
 		{
-			if (setStreamReaderToFile(m_CurrentFileName, true))
+			if (!loadCurrentRepFromCache(&resultRep))
 			{
 				resultRep = loadCurrentExtRep();
 			}
@@ -313,6 +308,7 @@ void GLC_3dxmlToWorld::clear()
 	m_SetOfAttachedFileName.clear();
 
 	clearMaterialHash();
+	m_MaterialContentKey.clear();
 }
 
 // Go to a Rep of a xml
@@ -794,27 +790,23 @@ void GLC_3dxmlToWorld::loadExternalRef3D()
 			m_CurrentDateTime= QFileInfo(QFileInfo(m_FileName).absolutePath() + QDir::separator() + QFileInfo(m_CurrentFileName).fileName()).lastModified();
 		}
 
-		if (!m_LoadStructureOnly && GLC_State::cacheIsUsed() && GLC_State::currentCacheManager().isUsable(m_CurrentDateTime, QFileInfo(m_FileName).baseName(), m_CurrentFileName))
-		{
-			GLC_CacheManager cacheManager= GLC_State::currentCacheManager();
-
-			GLC_BSRep binaryRep= cacheManager.binary3DRep(QFileInfo(m_FileName).baseName(), m_CurrentFileName);
-			GLC_3DRep* pRep= new GLC_3DRep(binaryRep.loadRep());
-
-			setRepresentationFileName(pRep);
-
-			GLC_StructReference* pCurrentRef= new GLC_StructReference(pRep);
-			pCurrentRef->setName(QFileInfo(m_CurrentFileName).baseName());
-			m_ExternalReferenceHash.insert(m_CurrentFileName, pCurrentRef);
-
-		}
-		else if (!m_LoadStructureOnly && setStreamReaderToFile(m_CurrentFileName))
+		if (!m_LoadStructureOnly && setStreamReaderToFile(m_CurrentFileName))
 		{
 
 			// Avoid recursive call off createReferenceRep
 			const QString localFileName= m_CurrentFileName;
 
-			GLC_StructReference* pCurrentRef= createReferenceRep(QString(), NULL);
+			GLC_StructReference* pCurrentRef= NULL;
+			GLC_3DRep cachedRep;
+			if (loadCurrentRepFromCache(&cachedRep))
+			{
+				pCurrentRef= new GLC_StructReference(new GLC_3DRep(cachedRep));
+				pCurrentRef->setName(QFileInfo(localFileName).baseName());
+			}
+			else
+			{
+				pCurrentRef= createReferenceRep(QString(), NULL);
+			}
 			if (NULL != pCurrentRef)
 			{
 				m_ExternalReferenceHash.insert(localFileName, pCurrentRef);
@@ -980,17 +972,7 @@ GLC_StructReference* GLC_3dxmlToWorld::createReferenceRep(QString repId, GLC_3DR
 				currentMesh3DRep.clean();
 				if (!currentMesh3DRep.isEmpty())
 				{
-					if (GLC_State::cacheIsUsed())
-					{
-						GLC_CacheManager currentManager= GLC_State::currentCacheManager();
-						if (!currentManager.addToCache(QFileInfo(m_FileName).baseName(), currentMesh3DRep))
-						{
-							QStringList stringList("GLC_3dxmlToWorld::createReferenceRep");
-							stringList.append(m_FileName);
-							stringList.append("File " + currentMesh3DRep.fileName() + " Not Added to cache");
-							GLC_ErrorLog::addError(stringList);
-						}
-					}
+					addCurrentRepToCache(currentMesh3DRep);
 
 					return new GLC_StructReference(new GLC_3DRep(currentMesh3DRep));
 				}
@@ -1018,11 +1000,7 @@ GLC_StructReference* GLC_3dxmlToWorld::createReferenceRep(QString repId, GLC_3DR
 	currentMesh3DRep.clean();
 	if (!currentMesh3DRep.isEmpty())
 	{
-		if (GLC_State::cacheIsUsed())
-		{
-			GLC_CacheManager currentManager= GLC_State::currentCacheManager();
-			currentManager.addToCache(QFileInfo(m_FileName).baseName(), currentMesh3DRep);
-		}
+		addCurrentRepToCache(currentMesh3DRep);
 
 		return new GLC_StructReference(new GLC_3DRep(currentMesh3DRep));
 	}
@@ -1198,14 +1176,68 @@ void GLC_3dxmlToWorld::checkForXmlError(const QString& info)
 	}
 }
 
+// Append the floats content of an element to the given vector
+bool GLC_3dxmlToWorld::getFloatArrayContent(QXmlStreamReader* pReader, const QString& element, GLfloatVector* pValues)
+{
+	bool result= true;
+	// The last number of a characters token can be continued by the next token
+	QString tail;
+	while(endElementNotReached(pReader, element))
+	{
+		readNext();
+		if (pReader->isCharacters() && !pReader->text().isEmpty())
+		{
+			const QStringRef text= pReader->text();
+			const QChar* pBegin= text.constData();
+			const QChar* pEnd= pBegin + text.size();
+			if (!tail.isEmpty())
+			{
+				const QChar* pTailEnd= pBegin;
+				while ((pTailEnd != pEnd) && !glc::isNumericSeparator(pTailEnd->unicode())) ++pTailEnd;
+				tail.append(pBegin, static_cast<int>(pTailEnd - pBegin));
+				if (pTailEnd == pEnd) continue;
+
+				result= glc::parseFloatArray(tail.constData(), tail.constData() + tail.size(), pValues) && result;
+				tail.clear();
+				pBegin= pTailEnd;
+			}
+			const QChar* pLastNumber= pEnd;
+			while ((pLastNumber != pBegin) && !glc::isNumericSeparator((pLastNumber - 1)->unicode())) --pLastNumber;
+			tail= QString(pLastNumber, static_cast<int>(pEnd - pLastNumber));
+
+			result= glc::parseFloatArray(pBegin, pLastNumber, pValues) && result;
+		}
+	}
+	result= glc::parseFloatArray(tail.constData(), tail.constData() + tail.size(), pValues) && result;
+
+	return result;
+}
+
+// Check the result of numeric data parsing
+void GLC_3dxmlToWorld::checkNumericParsing(bool parsed, const QString& info)
+{
+	if (!parsed)
+	{
+		QString message(info + QString(" contains an invalid number in file ") + m_CurrentFileName);
+
+		QStringList stringList(message);
+		GLC_ErrorLog::addError(stringList);
+
+		GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
+		clear();
+		throw(fileFormatException);
+	}
+}
+
 // Load a face
 void GLC_3dxmlToWorld::loadFace(GLC_Mesh* pMesh, const int lod, double accuracy)
 {
 	//qDebug() << "GLC_3dxmlToWorld::loadFace" << m_pStreamReader->name();
-	// List of index declaration
-	QString triangles= readAttribute("triangles", false).trimmed();
-	QString strips= readAttribute("strips", false).trimmed();
-	QString fans= readAttribute("fans", false).trimmed();
+	// List of index declaration, the attributes copy keeps the parsed characters alive
+	const QXmlStreamAttributes attributes= m_pStreamReader->attributes();
+	const QStringRef triangles= attributes.value("triangles").trimmed();
+	const QStringRef strips= attributes.value("strips").trimmed();
+	const QStringRef fans= attributes.value("fans").trimmed();
 
 	if (triangles.isEmpty() && strips.isEmpty() && fans.isEmpty())
 	{
@@ -1230,60 +1262,54 @@ void GLC_3dxmlToWorld::loadFace(GLC_Mesh* pMesh, const int lod, double accuracy)
 		pCurrentMaterial= m_pCurrentMaterial;
 	}
 
-	// Trying to find triangles
+	// Trying to find triangles, comma are used as separator by 3dvia mesh
 	if (!triangles.isEmpty())
 	{
-		// For 3dvia mesh
-		if (triangles.contains(','))
-		{
-			triangles.remove(',');
-		}
-		QTextStream trianglesStream(&triangles);
 		IndexList trianglesIndex;
-		QString buff;
-		while ((!trianglesStream.atEnd()))
-		{
-			trianglesStream >> buff;
-			trianglesIndex.append(buff.toUInt());
-		}
+		const bool parsed= glc::parseIndexArray(triangles.constData(), triangles.constData() + triangles.size(), &trianglesIndex);
+		checkNumericParsing(parsed, "Face triangles");
 		pMesh->addTriangles(pCurrentMaterial, trianglesIndex, lod, accuracy);
 	}
-	// Trying to find trips
+	// Trying to find trips, strips are separated by comma
 	if (!strips.isEmpty())
 	{
-
-		QStringList stripsList(strips.split(","));
-		const int size= stripsList.size();
-		for (int i= 0; i < size; ++i)
+		const QChar* pBegin= strips.constData();
+		const QChar* pEnd= pBegin + strips.size();
+		while (pBegin < pEnd)
 		{
-			//qDebug() << "Strip " << stripsList.at(i);
-			QTextStream stripsStream(&stripsList[i]);
+			const QChar* pStripEnd= pBegin;
+			while ((pStripEnd != pEnd) && (',' != pStripEnd->unicode())) ++pStripEnd;
+
 			IndexList stripsIndex;
-			QString buff;
-			while ((!stripsStream.atEnd()))
+			checkNumericParsing(glc::parseIndexArray(pBegin, pStripEnd, &stripsIndex), "Face strips");
+			if (!stripsIndex.isEmpty())
 			{
-				stripsStream >> buff;
-				stripsIndex.append(buff.toUInt());
+				pMesh->addTrianglesStrip(pCurrentMaterial, stripsIndex, lod, accuracy);
 			}
-			pMesh->addTrianglesStrip(pCurrentMaterial, stripsIndex, lod, accuracy);
+			// The last one is not followed by a comma
+			if (pStripEnd == pEnd) break;
+			pBegin= pStripEnd + 1;
 		}
 	}
-	// Trying to find fans
+	// Trying to find fans, fans are separated by comma
 	if (!fans.isEmpty())
 	{
-		QStringList fansList(fans.split(","));
-		const int size= fansList.size();
-		for (int i= 0; i < size; ++i)
+		const QChar* pBegin= fans.constData();
+		const QChar* pEnd= pBegin + fans.size();
+		while (pBegin < pEnd)
 		{
-			QTextStream fansStream(&fansList[i]);
+			const QChar* pFanEnd= pBegin;
+			while ((pFanEnd != pEnd) && (',' != pFanEnd->unicode())) ++pFanEnd;
+
 			IndexList fansIndex;
-			QString buff;
-			while ((!fansStream.atEnd()))
+			checkNumericParsing(glc::parseIndexArray(pBegin, pFanEnd, &fansIndex), "Face fans");
+			if (!fansIndex.isEmpty())
 			{
-				fansStream >> buff;
-				fansIndex.append(buff.toUInt());
+				pMesh->addTrianglesFan(pCurrentMaterial, fansIndex, lod, accuracy);
 			}
-			pMesh->addTrianglesFan(pCurrentMaterial, fansIndex, lod, accuracy);
+			// The last one is not followed by a comma
+			if (pFanEnd == pEnd) break;
+			pBegin= pFanEnd + 1;
 		}
 	}
 
@@ -1292,20 +1318,13 @@ void GLC_3dxmlToWorld::loadFace(GLC_Mesh* pMesh, const int lod, double accuracy)
 // Load polyline
 void GLC_3dxmlToWorld::loadPolyline(GLC_Mesh* pMesh)
 {
-	QString data= readAttribute("vertices", true);
+	const QString data= readAttribute("vertices", true);
 
-	data.replace(',', ' ');
-	QTextStream dataStream(&data);
-	QList<GLfloat> values;
-	QString buff;
-	while ((!dataStream.atEnd()))
-	{
-		dataStream >> buff;
-		values.append(buff.toFloat());
-	}
+	GLfloatVector values;
+	checkNumericParsing(glc::parseFloatArray(data.constData(), data.constData() + data.size(), &values), "Polyline vertices");
 	if ((values.size() % 3) == 0)
 	{
-		pMesh->addVerticeGroup(values.toVector());
+		pMesh->addVerticeGroup(values);
 	}
 	else
 	{
@@ -1356,7 +1375,7 @@ GLC_Material* GLC_3dxmlToWorld::loadSurfaceAttributes()
 				{
 					checkForXmlError("Material ID not found");
 					QString materialId= readAttribute("id", true).remove("urn:3DXML:CATMaterialRef.3dxml#");
-					pMaterial= m_MaterialHash.value(materialId);
+					pMaterial= loaderMaterial(materialId);
 				}
 			}
 
@@ -1382,17 +1401,20 @@ GLC_Material* GLC_3dxmlToWorld::getMaterial()
 	QColor diffuse;
 	diffuse.setRgbF(redReal, greenReal, blueReal);
 	pMaterial= new GLC_Material(diffuse);
-	pMaterial->setName("Material_" + QString::number(m_MaterialHash.size()));
+	int materialIndex= m_MaterialHash.size();
+	if (NULL != m_pMasterMaterialHash) materialIndex+= m_pMasterMaterialHash->size();
+	pMaterial->setName("Material_" + QString::number(materialIndex));
 	pMaterial->setAmbientColor(QColor(50, 50, 50));
 	pMaterial->setSpecularColor(QColor(70, 70, 70));
 	pMaterial->setShininess(35.0);
 	pMaterial->setOpacity(alphaReal);
 
 	const QString matKey= QString::number(pMaterial->hashCode());
-	if (m_MaterialHash.contains(matKey))
+	GLC_Material* pLoaderMaterial= loaderMaterial(matKey);
+	if (NULL != pLoaderMaterial)
 	{
 		delete pMaterial;
-		pMaterial= m_MaterialHash.value(matKey);
+		pMaterial= pLoaderMaterial;
 	}
 	else
 	{
@@ -1402,6 +1424,23 @@ GLC_Material* GLC_3dxmlToWorld::getMaterial()
 	return pMaterial;
 }
 
+GLC_Material* GLC_3dxmlToWorld::loaderMaterial(const QString& key)
+{
+	GLC_Material* pMaterial= m_MaterialHash.value(key, NULL);
+	if ((NULL == pMaterial) && (NULL != m_pMasterMaterialHash))
+	{
+		// Geometries register themselves into their materials, the worker uses a copy with the same id
+		// which is replaced by the master material on the loading thread
+		GLC_Material* pMasterMaterial= m_pMasterMaterialHash->value(key, NULL);
+		if (NULL != pMasterMaterial)
+		{
+			pMaterial= new GLC_Material(*pMasterMaterial);
+			m_MaterialHash.insert(key, pMaterial);
+		}
+	}
+	return pMaterial;
+}
+
 // Set the stream reader to the specified file
 bool GLC_3dxmlToWorld::setStreamReaderToFile(QString fileName, bool test)
 {
@@ -1457,6 +1496,11 @@ bool GLC_3dxmlToWorld::setStreamReaderToFile(QString fileName, bool test)
 			currentByteArray= p3dxmlFile->read(chunckSize);
 			m_ByteArrayList.append(currentByteArray);
 		}
+		m_CurrentContentKey.clear();
+		if (GLC_State::cacheIsUsed())
+		{
+			m_CurrentContentKey= GLC_CacheManager::contentKey(m_ByteArrayList);
+		}
 		m_pStreamReader= new QXmlStreamReader(m_ByteArrayList.takeFirst());
 		delete p3dxmlFile;
         if (m_UseZipMutex) m_ZipMutex.unlock();
@@ -1490,7 +1534,18 @@ bool GLC_3dxmlToWorld::setStreamReaderToFile(QString fileName, bool test)
 
 		// Set the stream reader
 		delete m_pStreamReader;
-		m_pStreamReader= new QXmlStreamReader(m_pCurrentFile);
+		m_CurrentContentKey.clear();
+		if (GLC_State::cacheIsUsed())
+		{
+			// The content is read once to be hashed and parsed
+			const QByteArray content(m_pCurrentFile->readAll());
+			m_CurrentContentKey= GLC_CacheManager::contentKey(content);
+			m_pStreamReader= new QXmlStreamReader(content);
+		}
+		else
+		{
+			m_pStreamReader= new QXmlStreamReader(m_pCurrentFile);
+		}
 	}
 	return true;
 }
@@ -1503,6 +1558,9 @@ void GLC_3dxmlToWorld::loadLocalRepresentations()
 	if (m_LocalRepLinkList.isEmpty()) return;
 	QHash<const QString, GLC_3DRep> repHash;
 
+	// Local representations are cached by the content of the structure file and their id
+	const QString structureContentKey(m_CurrentContentKey);
+
 	// Load all local ref
 	goToElement(m_pStreamReader, "GeometricRepresentationSet");
 	while (endElementNotReached(m_pStreamReader, "GeometricRepresentationSet"))
@@ -1510,16 +1568,37 @@ void GLC_3dxmlToWorld::loadLocalRepresentations()
 		if (m_pStreamReader->name() == "Representation")
 		{
 			QString id= readAttribute("id", true);
-			GLC_StructReference* pRef= createReferenceRep("3DXML_Local_" + id, NULL);
-			if (pRef->hasRepresentation())
+			const QString localRepId("3DXML_Local_" + id);
+			if (!structureContentKey.isEmpty())
 			{
-				GLC_3DRep representation(*(dynamic_cast<GLC_3DRep*>(pRef->representationHandle())));
-				repHash.insert(id, representation);
+				m_CurrentContentKey= GLC_CacheManager::contentKey(QString(structureContentKey + localRepId).toUtf8());
+			}
+
+			const QString saveCurrentFileName= m_CurrentFileName;
+			m_CurrentFileName= localRepId;
+			GLC_3DRep cachedRep;
+			const bool isCached= loadCurrentRepFromCache(&cachedRep);
+			m_CurrentFileName= saveCurrentFileName;
+
+			if (isCached)
+			{
+				repHash.insert(id, cachedRep);
+				m_pStreamReader->skipCurrentElement();
+			}
+			else
+			{
+				GLC_StructReference* pRef= createReferenceRep(localRepId, NULL);
+				if (pRef->hasRepresentation())
+				{
+					GLC_3DRep representation(*(dynamic_cast<GLC_3DRep*>(pRef->representationHandle())));
+					repHash.insert(id, representation);
+				}
+				delete pRef;
 			}
-			delete pRef;
 		}
 		readNext();
 	}
+	m_CurrentContentKey= structureContentKey;
 	//qDebug() << "Local rep loaded";
 
 	// Attach the ref to the structure reference
@@ -1782,67 +1861,62 @@ void GLC_3dxmlToWorld::loadExternRepresentations()
 	int currentFileIndex= 0;
 	emit currentQuantum(currentQuantumValue);
 
-	// Load all external rep
-	ReferenceRepHash::iterator iRefRep= m_ReferenceRepHash.begin();
-	while (iRefRep != m_ReferenceRepHash.constEnd())
+	if (!m_LoadStructureOnly && GLC_State::isParallelLoadingActivated() && (size > 1))
 	{
-		m_CurrentFileName= iRefRep.value();
-		const unsigned int id= iRefRep.key();
-
-		if (!m_IsInArchive)
+		loadExternRepresentationsInParallel(&repHash);
+	}
+	else
+	{
+		// Load all external rep
+		ReferenceRepHash::iterator iRefRep= m_ReferenceRepHash.begin();
+		while (iRefRep != m_ReferenceRepHash.constEnd())
 		{
-			// Get the 3DXML time stamp
-			m_CurrentDateTime= QFileInfo(QFileInfo(m_FileName).absolutePath() + QDir::separator() + QFileInfo(m_CurrentFileName).fileName()).lastModified();
-		}
-
+			m_CurrentFileName= iRefRep.value();
+			const unsigned int id= iRefRep.key();
 
-		if (!m_LoadStructureOnly && setStreamReaderToFile(m_CurrentFileName))
-		{
-			GLC_3DRep representation;
-            if (GLC_State::cacheIsUsed() && GLC_State::currentCacheManager().isUsable(m_CurrentDateTime, QFileInfo(m_FileName).baseName(), QFileInfo(m_CurrentFileName).fileName()))
+			if (!m_IsInArchive)
 			{
-				GLC_CacheManager cacheManager= GLC_State::currentCacheManager();
-                GLC_BSRep binaryRep= cacheManager.binary3DRep(QFileInfo(m_FileName).baseName(), QFileInfo(m_CurrentFileName).fileName());
-				representation= binaryRep.loadRep();
-				setRepresentationFileName(&representation);
+				// Get the 3DXML time stamp
+				m_CurrentDateTime= QFileInfo(QFileInfo(m_FileName).absolutePath() + QDir::separator() + QFileInfo(m_CurrentFileName).fileName()).lastModified();
 			}
-			else
+
+
+			if (!m_LoadStructureOnly && setStreamReaderToFile(m_CurrentFileName))
 			{
-				representation= loadCurrentExtRep();
-				representation.clean();
+				GLC_3DRep representation(loadCurrentExtRepOrCachedRep());
+				if (!representation.isEmpty())
+				{
+					repHash.insert(id, representation);
+				}
 			}
-			if (!representation.isEmpty())
+			else if (m_LoadStructureOnly)
 			{
+				GLC_3DRep representation;
+				if (m_IsInArchive)
+				{
+					representation.setFileName(glc::builtArchiveString(m_FileName, m_CurrentFileName));
+				}
+				else
+				{
+					const QString repFileName= glc::builtFileString(m_FileName, m_CurrentFileName);
+					representation.setFileName(repFileName);
+					m_SetOfAttachedFileName << glc::archiveEntryFileName(repFileName);
+				}
+
 				repHash.insert(id, representation);
 			}
-		}
-		else if (m_LoadStructureOnly)
-		{
-			GLC_3DRep representation;
-			if (m_IsInArchive)
-			{
-				representation.setFileName(glc::builtArchiveString(m_FileName, m_CurrentFileName));
-			}
-			else
+
+			// Progrees bar indicator
+			++currentFileIndex;
+			currentQuantumValue = static_cast<int>((static_cast<double>(currentFileIndex) / size) * 100);
+			if (currentQuantumValue > previousQuantumValue)
 			{
-				const QString repFileName= glc::builtFileString(m_FileName, m_CurrentFileName);
-				representation.setFileName(repFileName);
-				m_SetOfAttachedFileName << glc::archiveEntryFileName(repFileName);
+				emit currentQuantum(currentQuantumValue);
 			}
+			previousQuantumValue= currentQuantumValue;
 
-			repHash.insert(id, representation);
+			++iRefRep;
 		}
-
-		// Progrees bar indicator
-		++currentFileIndex;
-		currentQuantumValue = static_cast<int>((static_cast<double>(currentFileIndex) / size) * 100);
-		if (currentQuantumValue > previousQuantumValue)
-		{
-			emit currentQuantum(currentQuantumValue);
-		}
-		previousQuantumValue= currentQuantumValue;
-
-		++iRefRep;
 	}
 
 	// Attach the ref to the structure reference
@@ -1877,6 +1951,228 @@ void GLC_3dxmlToWorld::loadExternRepresentations()
 
 }
 
+// Return the current extern representation from the cache or from the current file
+GLC_3DRep GLC_3dxmlToWorld::loadCurrentExtRepOrCachedRep()
+{
+	GLC_3DRep representation;
+	if (!loadCurrentRepFromCache(&representation))
+	{
+		representation= loadCurrentExtRep();
+		representation.clean();
+	}
+	return representation;
+}
+
+// Load the representation of the current file from the cache into the given rep and return true on success
+bool GLC_3dxmlToWorld::loadCurrentRepFromCache(GLC_3DRep* pRep)
+{
+	if (m_CurrentContentKey.isEmpty() || !GLC_State::cacheIsUsed()) return false;
+
+	GLC_3DRep cachedRep;
+	const bool loaded= GLC_State::currentCacheManager().loadCachedContent(currentRepContentKey(), &cachedRep);
+	if (loaded)
+	{
+		// The same content can be shared by several files
+		*pRep= cachedRep;
+		setRepresentationFileName(pRep);
+		pRep->setLastModified(m_CurrentDateTime);
+	}
+	return loaded;
+}
+
+// Add the given representation of the current file in the cache
+void GLC_3dxmlToWorld::addCurrentRepToCache(GLC_3DRep& rep)
+{
+	if (m_CurrentContentKey.isEmpty() || !GLC_State::cacheIsUsed()) return;
+
+	// The LODs are generated before caching to be persisted
+	if (GLC_State::isAutomaticLodActivated())
+	{
+		GLC_MeshSimplifier().generateLods(rep);
+	}
+	GLC_CacheManager currentManager= GLC_State::currentCacheManager();
+	if (!currentManager.addContentToCache(currentRepContentKey(), rep))
+	{
+		QStringList stringList("GLC_3dxmlToWorld::addCurrentRepToCache");
+		stringList.append(m_FileName);
+		stringList.append("File " + rep.fileName() + " Not Added to cache");
+		GLC_ErrorLog::addError(stringList);
+	}
+}
+
+// Return the cache key of the representation of the current file
+QString GLC_3dxmlToWorld::currentRepContentKey() const
+{
+	// The cached representation contains the materials used by its meshes
+	if (m_MaterialContentKey.isEmpty() || m_CurrentContentKey.isEmpty()) return m_CurrentContentKey;
+	else return GLC_CacheManager::contentKey(QString(m_CurrentContentKey + m_MaterialContentKey).toLatin1());
+}
+
+// Fold the content key of the current file into the content key of the material definitions
+void GLC_3dxmlToWorld::addCurrentContentToMaterialKey()
+{
+	if (!m_CurrentContentKey.isEmpty())
+	{
+		m_MaterialContentKey= GLC_CacheManager::contentKey(QString(m_MaterialContentKey + m_CurrentContentKey).toLatin1());
+	}
+}
+
+// Load the extern representation on worker threads into the given hash table
+void GLC_3dxmlToWorld::loadExternRepresentationsInParallel(QHash<const unsigned int, GLC_3DRep>* pRepHash)
+{
+	// Sort tasks by id in order to keep a deterministic result
+	QList<unsigned int> idList= m_ReferenceRepHash.keys();
+	std::sort(idList.begin(), idList.end());
+
+	const int size= idList.size();
+	ExtRepProgress progress;
+	progress.m_pLoader= this;
+	progress.m_TaskCount= size;
+	QVector<ExtRepTask> tasks(size);
+	for (int i= 0; i < size; ++i)
+	{
+		ExtRepTask& task= tasks[i];
+		task.m_pMaster= this;
+		task.m_pProgress= &progress;
+		task.m_Id= idList.at(i);
+		task.m_FileName= m_ReferenceRepHash.value(task.m_Id);
+		if (!m_IsInArchive)
+		{
+			// Get the 3DXML time stamp
+			task.m_DateTime= QFileInfo(QFileInfo(m_FileName).absolutePath() + QDir::separator() + QFileInfo(task.m_FileName).fileName()).lastModified();
+		}
+	}
+
+	// Each worker opens its own archive handle, the main one is left untouched
+	// The materials and the loader are only read while the workers run
+	QtConcurrent::blockingMap(tasks, &GLC_3dxmlToWorld::loadExternRepresentationTask);
+
+	QString error;
+	for (int i= 0; i < size; ++i)
+	{
+		ExtRepTask& task= tasks[i];
+		if (error.isEmpty() && !task.m_Error.isEmpty())
+		{
+			error= task.m_Error;
+		}
+		// The materials are attached on this thread
+		shareTaskMaterials(&task);
+		if (!task.m_Rep.isEmpty())
+		{
+			pRepHash->insert(task.m_Id, task.m_Rep);
+		}
+		m_SetOfAttachedFileName.unite(task.m_AttachedFileName);
+	}
+	emit currentQuantum(100);
+
+	if (!error.isEmpty())
+	{
+		QStringList stringList(m_FileName);
+		stringList.append(error);
+		GLC_ErrorLog::addError(stringList);
+		GLC_FileFormatException fileFormatException(error, m_FileName, GLC_FileFormatException::WrongFileFormat);
+		clear();
+		throw(fileFormatException);
+	}
+}
+
+// Load the representation of the given task
+void GLC_3dxmlToWorld::loadExternRepresentationTask(ExtRepTask& task)
+{
+	const GLC_3dxmlToWorld* pMaster= task.m_pMaster;
+
+	GLC_3dxmlToWorld loader;
+	loader.m_FileName= pMaster->m_FileName;
+	loader.m_IsInArchive= pMaster->m_IsInArchive;
+	// Only the materials used by the representation are copied
+	loader.m_pMasterMaterialHash= &(pMaster->m_MaterialHash);
+	loader.m_MaterialContentKey= pMaster->m_MaterialContentKey;
+	loader.m_UseZipMutex= false;
+	loader.m_CurrentFileName= task.m_FileName;
+	loader.m_CurrentDateTime= task.m_DateTime;
+
+	try
+	{
+		bool archiveOpened= true;
+		if (loader.m_IsInArchive)
+		{
+			loader.m_p3dxmlArchive= new QuaZip(loader.m_FileName);
+			archiveOpened= loader.m_p3dxmlArchive->open(QuaZip::mdUnzip);
+			if (!archiveOpened)
+			{
+				task.m_Error= QString("GLC_3dxmlToWorld::loadExternRepresentationTask Unable to open ") + loader.m_FileName;
+			}
+		}
+
+		if (archiveOpened && loader.setStreamReaderToFile(task.m_FileName))
+		{
+			task.m_Rep= loader.loadCurrentExtRepOrCachedRep();
+		}
+		task.m_AttachedFileName= loader.m_SetOfAttachedFileName;
+	}
+	catch (GLC_FileFormatException& e)
+	{
+		task.m_Error= e.what();
+	}
+
+	// The unused materials are deleted with the worker loader
+	MaterialHash::const_iterator iUsedMaterial= loader.m_MaterialHash.constBegin();
+	while (loader.m_MaterialHash.constEnd() != iUsedMaterial)
+	{
+		if (!iUsedMaterial.value()->isUnused())
+		{
+			task.m_MaterialHash.insert(iUsedMaterial.key(), iUsedMaterial.value());
+		}
+		++iUsedMaterial;
+	}
+
+	// The signal is queued to the receivers of the other threads
+	ExtRepProgress* pProgress= task.m_pProgress;
+	const int finishedCount= pProgress->m_FinishedCount.fetchAndAddOrdered(1) + 1;
+	const int quantum= static_cast<int>((static_cast<double>(finishedCount) / pProgress->m_TaskCount) * 100);
+	int previousQuantum= pProgress->m_Quantum.fetchAndAddRelaxed(0);
+	while (quantum > previousQuantum)
+	{
+		if (pProgress->m_Quantum.testAndSetOrdered(previousQuantum, quantum))
+		{
+			emit pProgress->m_pLoader->currentQuantum(quantum);
+		}
+		previousQuantum= pProgress->m_Quantum.fetchAndAddRelaxed(0);
+	}
+}
+
+// Replace the materials of the representation of the given task by the materials of this loader
+void GLC_3dxmlToWorld::shareTaskMaterials(ExtRepTask* pTask)
+{
+	MaterialHash::const_iterator iMaterial= pTask->m_MaterialHash.constBegin();
+	while (pTask->m_MaterialHash.constEnd() != iMaterial)
+	{
+		GLC_Material* pTaskMaterial= iMaterial.value();
+		GLC_Material* pMaterial= m_MaterialHash.value(iMaterial.key(), NULL);
+		if (NULL == pMaterial)
+		{
+			// A new color material is shared with the next representations
+			m_MaterialHash.insert(iMaterial.key(), pTaskMaterial);
+		}
+		else if (pMaterial != pTaskMaterial)
+		{
+			// The task material is deleted when its last geometry releases it
+			const GLC_uint taskMaterialId= pTaskMaterial->id();
+			const int bodyCount= pTask->m_Rep.numberOfBody();
+			for (int i= 0; i < bodyCount; ++i)
+			{
+				GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pTask->m_Rep.geomAt(i));
+				if ((NULL != pMesh) && pMesh->containsMaterial(taskMaterialId))
+				{
+					pMesh->replaceMaterial(taskMaterialId, pMaterial);
+				}
+			}
+		}
+		++iMaterial;
+	}
+	pTask->m_MaterialHash.clear();
+}
+
 // Return the instance of the current extern representation
 GLC_3DRep GLC_3dxmlToWorld::loadCurrentExtRep()
 {
@@ -1906,12 +2202,7 @@ GLC_3DRep GLC_3dxmlToWorld::loadCurrentExtRep()
 			{
 				pMesh->finish();
 				currentMeshRep.clean();
-
-				if (GLC_State::cacheIsUsed())
-				{
-					GLC_CacheManager currentManager= GLC_State::currentCacheManager();
-					currentManager.addToCache(QFileInfo(m_FileName).baseName(), currentMeshRep);
-				}
+				addCurrentRepToCache(currentMeshRep);
 
 				return currentMeshRep;
 			}
@@ -1930,12 +2221,7 @@ GLC_3DRep GLC_3dxmlToWorld::loadCurrentExtRep()
 
 	pMesh->finish();
 	currentMeshRep.clean();
-
-	if (GLC_State::cacheIsUsed())
-	{
-		GLC_CacheManager currentManager= GLC_State::currentCacheManager();
-		currentManager.addToCache(QFileInfo(m_FileName).baseName(), currentMeshRep);
-	}
+	addCurrentRepToCache(currentMeshRep);
 
 	return currentMeshRep;
 }
@@ -1948,6 +2234,8 @@ void GLC_3dxmlToWorld::loadCatMaterialRef()
 	// Load material Name, Id and associated File
 	if (setStreamReaderToFile("CATMaterialRef.3dxml", true))
 	{
+		addCurrentContentToMaterialKey();
+
 		// Load the material file
 		//qDebug() << "CATMaterialRef.3dxml found and current";
 		goToElement(m_pStreamReader, "CATMaterialRef");
@@ -1978,6 +2266,7 @@ void GLC_3dxmlToWorld::loadCatMaterialRef()
 	{
 		if (setStreamReaderToFile(materialRefList.at(i).m_AssociatedFile, true))
 		{
+			addCurrentContentToMaterialKey();
 			//qDebug() << "Load MaterialDef : " << materialRefList.at(i).m_AssociatedFile;
 			loadMaterialDef(materialRefList.at(i));
 		}
@@ -2074,6 +2363,8 @@ void GLC_3dxmlToWorld::loadCatRepImage()
 	// Load texture image name
 	if (setStreamReaderToFile("CATRepImage.3dxml", true))
 	{
+		addCurrentContentToMaterialKey();
+
 		//qDebug() << "CATRepImage.3dxml Found";
 		goToElement(m_pStreamReader, "CATRepImage");
 		checkForXmlError("Element CATRepImage not found in CATRepImage.3dxml");
@@ -2333,21 +2624,14 @@ void GLC_3dxmlToWorld::loadRep(GLC_Mesh* pMesh)
 void GLC_3dxmlToWorld::loadVertexBuffer(GLC_Mesh* pMesh)
 {
 	{
-		QString verticePosition= getContent(m_pStreamReader, "Positions").replace(',', ' ');
-		//qDebug() << "Position " << verticePosition;
-		checkForXmlError("Error while retrieving Position ContentVertexBuffer");
 		// Load Vertice position
-		QTextStream verticeStream(&verticePosition);
-		QList<GLfloat> verticeValues;
-		QString buff;
-		while ((!verticeStream.atEnd()))
-		{
-			verticeStream >> buff;
-			verticeValues.append(buff.toFloat());
-		}
+		GLfloatVector verticeValues;
+		const bool parsed= getFloatArrayContent(m_pStreamReader, "Positions", &verticeValues);
+		checkForXmlError("Error while retrieving Position ContentVertexBuffer");
+		checkNumericParsing(parsed, "Vertice buffer");
 		if ((verticeValues.size() % 3) == 0)
 		{
-			pMesh->addVertice(verticeValues.toVector());
+			pMesh->addVertice(verticeValues);
 		}
 		else
 		{
@@ -2363,21 +2647,14 @@ void GLC_3dxmlToWorld::loadVertexBuffer(GLC_Mesh* pMesh)
 	}
 
 	{
-		QString normals= getContent(m_pStreamReader, "Normals").replace(',', ' ');
-		//qDebug() << "Normals " << normals;
-		checkForXmlError("Error while retrieving Normals values");
 		// Load Vertice Normals
-		QTextStream normalsStream(&normals);
-		QList<GLfloat> normalValues;
-		QString buff;
-		while ((!normalsStream.atEnd()))
-		{
-			normalsStream >> buff;
-			normalValues.append(buff.toFloat());
-		}
+		GLfloatVector normalValues;
+		const bool parsed= getFloatArrayContent(m_pStreamReader, "Normals", &normalValues);
+		checkForXmlError("Error while retrieving Normals values");
+		checkNumericParsing(parsed, "Normal buffer");
 		if ((normalValues.size() % 3) == 0)
 		{
-			pMesh->addNormals(normalValues.toVector());
+			pMesh->addNormals(normalValues);
 		}
 		else
 		{
@@ -2397,20 +2674,14 @@ void GLC_3dxmlToWorld::loadVertexBuffer(GLC_Mesh* pMesh)
 	{
 		if ((QXmlStreamReader::StartElement == m_pStreamReader->tokenType()) && (m_pStreamReader->name() == "TextureCoordinates"))
 		{
-			QString texels= getContent(m_pStreamReader, "TextureCoordinates").replace(',', ' ');
+			GLfloatVector texelValues;
+			const bool parsed= getFloatArrayContent(m_pStreamReader, "TextureCoordinates", &texelValues);
 			checkForXmlError("Error while retrieving Texture coordinates");
-			QTextStream texelStream(&texels);
-			QList<GLfloat> texelValues;
-			QString buff;
-			while ((!texelStream.atEnd()))
-			{
-				texelStream >> buff;
-				texelValues.append(buff.toFloat());
-			}
+			checkNumericParsing(parsed, "Texel buffer");
 
 			if ((texelValues.size() % 2) == 0)
 			{
-				pMesh->addTexels(texelValues.toVector());
+				pMesh->addTexels(texelValues);
 			}
 			else
 			{
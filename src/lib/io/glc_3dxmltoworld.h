@@ -31,6 +31,7 @@
 #include <QHash>
 #include <QSet>
 #include <QDateTime>
+#include <QAtomicInt>
 #include "../maths/glc_matrix4x4.h"
 #include "../sceneGraph/glc_3dviewinstance.h"
 
@@ -121,6 +122,45 @@ class GLC_LIB_EXPORT GLC_3dxmlToWorld : public QObject
 		QList<unsigned int> m_Path;
 	};
 
+	//! \struct ExtRepProgress
+	/*! \brief ExtRepProgress : Progress of the external representations loaded by the worker threads */
+	struct ExtRepProgress
+	{
+		//! The loader which emits the progress
+		GLC_3dxmlToWorld* m_pLoader;
+		//! The number of tasks
+		int m_TaskCount;
+		//! The number of finished tasks
+		QAtomicInt m_FinishedCount;
+		//! The last emitted quantum
+		QAtomicInt m_Quantum;
+	};
+
+	//! \struct ExtRepTask
+	/*! \brief ExtRepTask : External representation loaded by a worker thread */
+	struct ExtRepTask
+	{
+		//! The loader which owns the task
+		const GLC_3dxmlToWorld* m_pMaster;
+		//! The progress shared by the tasks
+		ExtRepProgress* m_pProgress;
+		//! The representation id
+		unsigned int m_Id;
+		//! The representation file name
+		QString m_FileName;
+		//! The representation time stamp
+		QDateTime m_DateTime;
+		//! The loaded representation
+		GLC_3DRep m_Rep;
+		//! Files attached by the worker
+		QSet<QString> m_AttachedFileName;
+		//! The materials used by the loaded representation by key
+		/*! Copies of the loader materials keep their id, they are replaced after the loading*/
+		QHash<const QString, GLC_Material*> m_MaterialHash;
+		//! Error message if the loading failed
+		QString m_Error;
+	};
+
 	typedef QHash<unsigned int, GLC_StructReference*> ReferenceHash;
 	typedef QHash<GLC_StructInstance*, unsigned int> InstanceOfHash;
 	typedef QHash<GLC_StructInstance*, QString> InstanceOfExtRefHash;
@@ -219,6 +259,9 @@ private:
 	//! Throw ecxeption if error occur
 	void checkForXmlError(const QString&);
 
+	//! Check the result of numeric data parsing
+	void checkNumericParsing(bool parsed, const QString& info);
+
 	//! Load a face
 	void loadFace(GLC_Mesh*, const int lod, double accuracy);
 
@@ -234,6 +277,10 @@ private:
 	//! get material
 	GLC_Material* getMaterial();
 
+	//! Return the material of the given key, NULL if it is not found
+	/*! A worker loader copies on demand the materials of its master loader*/
+	GLC_Material* loaderMaterial(const QString& key);
+
 	//! Set the stream reader to the specified file
 	bool setStreamReaderToFile(QString, bool test= false);
 
@@ -258,6 +305,35 @@ private:
 	//! Load the extern representation
 	void loadExternRepresentations();
 
+	//! Load the extern representation on worker threads into the given hash table
+	/*! Each worker uses its own archive handle and stream reader*/
+	void loadExternRepresentationsInParallel(QHash<const unsigned int, GLC_3DRep>* pRepHash);
+
+	//! Load the representation of the given task
+	/*! The progress is emitted by the workers, a progress receiver must not live in the loading thread
+	 *  to be updated during the loading*/
+	static void loadExternRepresentationTask(ExtRepTask& task);
+
+	//! Replace the materials of the representation of the given task by the materials of this loader
+	/*! The materials not known by this loader are added to it*/
+	void shareTaskMaterials(ExtRepTask* pTask);
+
+	//! Return the current extern representation from the cache or from the current file
+	GLC_3DRep loadCurrentExtRepOrCachedRep();
+
+	//! Load the representation of the current file from the cache into the given rep and return true on success
+	bool loadCurrentRepFromCache(GLC_3DRep* pRep);
+
+	//! Add the given representation of the current file in the cache
+	void addCurrentRepToCache(GLC_3DRep& rep);
+
+	//! Return the cache key of the representation of the current file
+	/*! The key covers the current file content and the material definitions*/
+	QString currentRepContentKey() const;
+
+	//! Fold the content key of the current file into the content key of the material definitions
+	void addCurrentContentToMaterialKey();
+
 	//! Return the instance of the current extern representation
 	GLC_3DRep loadCurrentExtRep();
 
@@ -285,6 +361,9 @@ private:
 	// Return the content of an element
 	inline QString getContent(QXmlStreamReader* pReader, const QString& element);
 
+	//! Append the floats content of an element to the given vector, return false if a number is not valid
+	bool getFloatArrayContent(QXmlStreamReader* pReader, const QString& element, GLfloatVector* pValues);
+
 	//! Read the specified attribute
 	inline QString readAttribute(QXmlStreamReader* pReader, const QString& attribute);
 
@@ -387,6 +466,12 @@ private:
 	//! The current file time and date
 	QDateTime m_CurrentDateTime;
 
+	//! The content key of the current file (empty if the cache is not used)
+	QString m_CurrentContentKey;
+
+	//! The content key of the material definitions files (empty if there is no material definition)
+	QString m_MaterialContentKey;
+
 	//! Hash table of occurrence specific attributes for 3DXML V3
 	QHash<unsigned int, V3OccurrenceAttrib*> m_V3OccurrenceAttribHash;
 
@@ -406,6 +491,9 @@ private:
     //! Flag to know if zip mutex must be used
     bool m_UseZipMutex;
 
+	//! The materials of the master loader of a worker loader, read only
+	const MaterialHash* m_pMasterMaterialHash;
+
 };
 
 QXmlStreamReader::TokenType GLC_3dxmlToWorld::readNext()
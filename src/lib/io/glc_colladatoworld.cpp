@@ -25,13 +25,24 @@
 #include "../glc_fileformatexception.h"
 #include "../maths/glc_geomtools.h"
 #include "../glc_factory.h"
+#include "../glc_state.h"
 #include "glc_xmlutil.h"
+#include "glc_numericparser.h"
+
+#include <QtConcurrent>
 
 static QString prefixNodeId= "GLC_LIB_COLLADA_ID_";
 static int currentNodeId= 0;
 
 using namespace glcXmlUtil;
 
+// Append the numbers of the given characters to the given floats or to the given index
+static bool parseNumbers(const QChar* pBegin, const QChar* pEnd, GLfloatVector* pValues, GLuintVector* pIndex)
+{
+	if (NULL != pValues) return glc::parseFloatArray(pBegin, pEnd, pValues);
+	else return glc::parseIndexArray(pBegin, pEnd, pIndex);
+}
+
 // Default constructor
 GLC_ColladaToWorld::GLC_ColladaToWorld()
 : QObject()
@@ -194,6 +205,43 @@ QString GLC_ColladaToWorld::getContent(const QString& element)
 	return Content.simplified();
 }
 
+// Append the numbers content of the given element to the given floats or to the given index
+void GLC_ColladaToWorld::getNumericContent(const QString& element, GLfloatVector* pValues, GLuintVector* pIndex)
+{
+	bool parsed= true;
+	// The last number of a characters token can be continued by the next token
+	QString tail;
+	while(endElementNotReached(m_pStreamReader, element))
+	{
+		m_pStreamReader->readNext();
+		if (m_pStreamReader->isCharacters() && !m_pStreamReader->text().isEmpty())
+		{
+			const QStringRef text= m_pStreamReader->text();
+			const QChar* pBegin= text.constData();
+			const QChar* pEnd= pBegin + text.size();
+			if (!tail.isEmpty())
+			{
+				const QChar* pTailEnd= pBegin;
+				while ((pTailEnd != pEnd) && !glc::isNumericSeparator(pTailEnd->unicode())) ++pTailEnd;
+				tail.append(pBegin, static_cast<int>(pTailEnd - pBegin));
+				if (pTailEnd == pEnd) continue;
+
+				parsed= parseNumbers(tail.constData(), tail.constData() + tail.size(), pValues, pIndex) && parsed;
+				tail.clear();
+				pBegin= pTailEnd;
+			}
+			const QChar* pLastNumber= pEnd;
+			while ((pLastNumber != pBegin) && !glc::isNumericSeparator((pLastNumber - 1)->unicode())) --pLastNumber;
+			tail= QString(pLastNumber, static_cast<int>(pEnd - pLastNumber));
+
+			parsed= parseNumbers(pBegin, pLastNumber, pValues, pIndex) && parsed;
+		}
+	}
+	parsed= parseNumbers(tail.constData(), tail.constData() + tail.size(), pValues, pIndex) && parsed;
+
+	if (!parsed) throwException(element + " contains an invalid number");
+}
+
 // Read the specified attribute
 QString GLC_ColladaToWorld::readAttribute(const QString& name, bool required)
 {
@@ -805,7 +853,7 @@ void GLC_ColladaToWorld::loadVertexBulkData()
 	// load Vertex Bulk data id
 	m_CurrentId= readAttribute("id", true);
 	//qDebug() << "id=" << m_CurrentId;
-	QList<float> vertices;
+	GLfloatVector vertices;
 
 	while (endElementNotReached(m_pStreamReader, "source"))
 	{
@@ -814,16 +862,11 @@ void GLC_ColladaToWorld::loadVertexBulkData()
 			const QStringRef currentElementName= m_pStreamReader->name();
 			if ((currentElementName == "float_array"))
 			{
-				int count= readAttribute("count", true).toInt();
-				QString array= getContent("float_array");
-				QStringList list= array.split(' ');
+				const int count= readAttribute("count", true).toInt();
+				vertices.reserve(count);
+				getNumericContent("float_array", &vertices, NULL);
 				// Check the array size
-				if (count != list.size()) throwException("float_array size not match");
-
-				for (int i= 0; i < count; ++i)
-				{
-					vertices.append(list.at(i).toFloat());
-				}
+				if (count != vertices.size()) throwException("float_array size not match");
 			}
 			else if (currentElementName == "technique_common") loadTechniqueCommon();
 		}
@@ -904,76 +947,33 @@ void GLC_ColladaToWorld::loadPolylist()
 	// The number of polygon
 	const int polygonCount= readAttribute("count", true).toInt();
 
+	Primitive primitive;
 	// The material id
-	const QString materialId= readAttribute("material", false);
-
-	// Offsets and data source list
-	QList<InputData> inputDataList;
-
-	// Polygon number of vertice list
-	QList<int> vcountList;
-
-	// Polygon index list
-	QList<int> polyIndexList;
+	primitive.m_MaterialId= readAttribute("material", false);
 
 	while (endElementNotReached(m_pStreamReader, "polylist"))
 	{
 		if (QXmlStreamReader::StartElement == m_pStreamReader->tokenType())
 		{
 			const QStringRef currentElementName= m_pStreamReader->name();
-			if ((currentElementName == "input") && vcountList.isEmpty())
+			if ((currentElementName == "input") && primitive.m_VCount.isEmpty())
 			{
-				InputData currentInput;
-				// Get input data offset
-				currentInput.m_Offset= readAttribute("offset", true).toInt();
-				// Get input data semantic
-				const QString semantic= readAttribute("semantic", true);
-				if (semantic == "VERTEX") currentInput.m_Semantic= VERTEX;
-				else if (semantic == "NORMAL") currentInput.m_Semantic= NORMAL;
-				else if (semantic == "TEXCOORD") currentInput.m_Semantic= TEXCOORD;
-				else throwException("Source semantic :" + semantic + "Not supported");
-				// Get input data source id
-				currentInput.m_Source= readAttribute("source", true).remove('#');
-
-				// Bypasss vertices indirection
-				if (m_VerticesSourceHash.contains(currentInput.m_Source))
-				{
-					currentInput.m_Source= m_VerticesSourceHash.value(currentInput.m_Source);
-				}
-				inputDataList.append(currentInput);
+				primitive.m_Inputs.append(loadInput());
 			}
-			else if ((currentElementName == "vcount") && (inputDataList.size() > 0))
+			else if ((currentElementName == "vcount") && !primitive.m_Inputs.isEmpty())
 			{
-				QString vcountString= getContent("vcount");
-				QStringList vcountStringList= vcountString.split(' ');
-				if (vcountStringList.size() != polygonCount) throwException("vcount size not match");
-				bool toIntOK;
-				for (int i= 0; i < polygonCount; ++i)
-				{
-					vcountList.append(vcountStringList.at(i).toInt(&toIntOK));
-					if (!toIntOK) throwException("Unable to convert string :" + vcountStringList.at(i) + " To int");
-				}
+				getNumericContent("vcount", NULL, &(primitive.m_VCount));
+				if (primitive.m_VCount.size() != polygonCount) throwException("vcount size not match");
 			}
-			else if ((currentElementName == "p") && !vcountList.isEmpty() && polyIndexList.isEmpty())
+			else if ((currentElementName == "p") && !primitive.m_VCount.isEmpty() && primitive.m_Index.isEmpty())
 			{
-				{ // Fill index List
-					QString pString= getContent("p");
-					QStringList pStringList= pString.split(' ');
-					bool toIntOK;
-					const int size= pStringList.size();
-					for (int i= 0; i < size; ++i)
-					{
-						polyIndexList.append(pStringList.at(i).toInt(&toIntOK));
-						if (!toIntOK) throwException("Unable to convert string :" + pStringList.at(i) + " To int");
-					}
-				}
-
+				getNumericContent("p", NULL, &(primitive.m_Index));
 			}
 		}
 		m_pStreamReader->readNext();
 	}
 	// Add the polylist to the current mesh
-	addPolylistToCurrentMesh(inputDataList, vcountList, polyIndexList, materialId);
+	addPrimitiveToCurrentMesh(&primitive);
 
 	updateProgressBar();
 }
@@ -981,435 +981,387 @@ void GLC_ColladaToWorld::loadPolylist()
 // Load Polygons
 void GLC_ColladaToWorld::loadPolygons()
 {
+	Primitive primitive;
 	// The material id
-	const QString materialId= readAttribute("material", false);
-
-	// Offsets and data source list
-	QList<InputData> inputDataList;
-
-	// Polygon number of vertice list
-	QList<int> vcountList;
+	primitive.m_MaterialId= readAttribute("material", false);
 
-	// The input number
-	int inputCount= 0;
-	// Polygon index list
-	QList<int> polyIndexList;
 	while (endElementNotReached(m_pStreamReader, "polygons"))
 	{
 		if (QXmlStreamReader::StartElement == m_pStreamReader->tokenType())
 		{
 			const QStringRef currentElementName= m_pStreamReader->name();
-			if ((currentElementName == "input") && vcountList.isEmpty())
+			if ((currentElementName == "input") && primitive.m_VCount.isEmpty())
 			{
-				++inputCount;
-				InputData currentInput;
-				// Get input data offset
-				currentInput.m_Offset= readAttribute("offset", true).toInt();
-				// Get input data semantic
-				const QString semantic= readAttribute("semantic", true);
-				if (semantic == "VERTEX") currentInput.m_Semantic= VERTEX;
-				else if (semantic == "NORMAL") currentInput.m_Semantic= NORMAL;
-				else if (semantic == "TEXCOORD") currentInput.m_Semantic= TEXCOORD;
-				else throwException("Source semantic :" + semantic + "Not supported");
-				// Get input data source id
-				currentInput.m_Source= readAttribute("source", true).remove('#');
-
-				// Bypasss vertices indirection
-				if (m_VerticesSourceHash.contains(currentInput.m_Source))
-				{
-					currentInput.m_Source= m_VerticesSourceHash.value(currentInput.m_Source);
-				}
-				inputDataList.append(currentInput);
+				const InputData currentInput= loadInput();
+				primitive.m_TupleSize= qMax(primitive.m_TupleSize, currentInput.m_Offset + 1);
+				primitive.m_Inputs.append(currentInput);
 			}
 			else if (currentElementName == "p")
 			{
-				{ // Fill index List
-					QString pString= getContent("p");
-					QStringList pStringList= pString.split(' ');
-					bool toIntOK;
-					const int size= pStringList.size();
-					for (int i= 0; i < size; ++i)
-					{
-						polyIndexList.append(pStringList.at(i).toInt(&toIntOK));
-						if (!toIntOK) throwException("Unable to convert string :" + pStringList.at(i) + " To int");
-					}
-					// Add the polygon size in vcountList
-					vcountList.append(size / inputCount);
-				}
+				// Each p element is a polygon
+				const int previousSize= primitive.m_Index.size();
+				getNumericContent("p", NULL, &(primitive.m_Index));
+				// Add the polygon size in vcount
+				primitive.m_VCount.append((primitive.m_Index.size() - previousSize) / primitive.m_TupleSize);
 			}
 		}
 		m_pStreamReader->readNext();
 	}
-	// Add the polylist to the current mesh
-	addPolylistToCurrentMesh(inputDataList, vcountList, polyIndexList, materialId);
+	// Add the polygons to the current mesh
+	addPrimitiveToCurrentMesh(&primitive);
 
 	updateProgressBar();
 }
 
-// Add the polylist to the current mesh
-void GLC_ColladaToWorld::addPolylistToCurrentMesh(const QList<InputData>& inputDataList, const QList<int>& vcountList, const QList<int>& polyIndexList, const QString& materialId)
+// Load triangles
+void  GLC_ColladaToWorld::loadTriangles()
 {
-	//qDebug() << "GLC_ColladaToWorld::addPolylistToCurrentMesh";
-
-	const int polygonCount= vcountList.size();
-	const int inputDataCount= inputDataList.size();
-	const int polyIndexCount= polyIndexList.size();
+	//qDebug() << "GLC_ColladaToWorld::loadTriangles()";
+	Primitive primitive;
+	// The material id
+	primitive.m_MaterialId= readAttribute("material", false);
 
-	// Flag to know if the polylist has normal
-	bool hasNormals= false;
-	bool hasTexture= false;
-	// Check the existance of data source
-	for (int dataIndex= 0; dataIndex < inputDataCount; ++dataIndex)
+	while (endElementNotReached(m_pStreamReader, "triangles"))
 	{
-		const QString source= inputDataList.at(dataIndex).m_Source;
-		if ( !m_BulkDataHash.contains(source))
+		if (QXmlStreamReader::StartElement == m_pStreamReader->tokenType())
 		{
-			throwException(" Source : " + source + " Not found");
+			const QStringRef currentElementName= m_pStreamReader->name();
+			if ((currentElementName == "input") && primitive.m_Index.isEmpty())
+			{
+				primitive.m_Inputs.append(loadInput());
+			}
+			else if ((currentElementName == "p") && primitive.m_Index.isEmpty())
+			{
+				getNumericContent("p", NULL, &(primitive.m_Index));
+			}
 		}
-		if (inputDataList.at(dataIndex).m_Semantic == NORMAL) hasNormals= true;
-		if (inputDataList.at(dataIndex).m_Semantic == TEXCOORD) hasTexture= true;
+		m_pStreamReader->readNext();
 	}
 
-	int maxOffset= 0;
-	for (int i= 0; i < inputDataCount; ++i)
-	{
-		if (inputDataList.at(i).m_Offset > maxOffset)
-		{
-			maxOffset= inputDataList.at(i).m_Offset;
-		}
-	}
-	//qDebug() << " Max Offset :" << maxOffset;
+	// Add the triangles to the current mesh
+	addPrimitiveToCurrentMesh(&primitive);
 
-	// the polygonIndex of the polylist
-	QList<int> polygonIndex;
+	updateProgressBar();
+}
 
-	// Fill the mapping, bulk data and index list of the current mesh info
-	for (int i= 0; i < polyIndexCount; i+= maxOffset + 1)
+// Load an input of a primitive
+GLC_ColladaToWorld::InputData GLC_ColladaToWorld::loadInput()
+{
+	InputData currentInput;
+	// Get input data offset
+	currentInput.m_Offset= readAttribute("offset", true).toInt();
+	if (currentInput.m_Offset < 0) throwException("Input offset must be positive");
+	// Get input data semantic
+	const QString semantic= readAttribute("semantic", true);
+	if (semantic == "VERTEX") currentInput.m_Semantic= VERTEX;
+	else if (semantic == "NORMAL") currentInput.m_Semantic= NORMAL;
+	else if (semantic == "TEXCOORD") currentInput.m_Semantic= TEXCOORD;
+	else throwException("Source semantic :" + semantic + "Not supported");
+	// Get input data source id
+	currentInput.m_Source= readAttribute("source", true).remove('#');
+
+	// Bypasss vertices indirection
+	if (m_VerticesSourceHash.contains(currentInput.m_Source))
+	{
+		currentInput.m_Source= m_VerticesSourceHash.value(currentInput.m_Source);
+	}
+
+	return currentInput;
+}
+
+// Resolve the sources of the given primitive and add it to the current mesh
+void GLC_ColladaToWorld::addPrimitiveToCurrentMesh(Primitive* pPrimitive)
+{
+	bool hasVertex= false;
+	const int inputDataCount= pPrimitive->m_Inputs.size();
+	for (int dataIndex= 0; dataIndex < inputDataCount; ++dataIndex)
 	{
-		// Create and set the current vertice index
-		ColladaVertice currentVertice;
-		for (int dataIndex= 0; dataIndex < inputDataCount; ++dataIndex)
+		InputData& currentInput= pPrimitive->m_Inputs[dataIndex];
+		// The bulk data are shared, not copied
+		BulkDataHash::const_iterator iBulkHash= m_BulkDataHash.constFind(currentInput.m_Source);
+		if (m_BulkDataHash.constEnd() == iBulkHash)
 		{
-			currentVertice.m_Values[inputDataList.at(dataIndex).m_Semantic]= polyIndexList.at(i + inputDataList.at(dataIndex).m_Offset);
+			throwException(" Source : " + currentInput.m_Source + " Not found");
 		}
+		currentInput.m_Values= iBulkHash.value();
 
-		if (m_pMeshInfo->m_Mapping.contains(currentVertice))
+		DataAccessorHash::const_iterator iAccessor= m_DataAccessorHash.constFind(currentInput.m_Source);
+		if (m_DataAccessorHash.constEnd() != iAccessor)
 		{
-			// Add the the index to the polygon index
-			polygonIndex.append(m_pMeshInfo->m_Mapping.value(currentVertice));
+			currentInput.m_ValueOffset= static_cast<int>(iAccessor.value().m_Offset);
+			currentInput.m_Stride= static_cast<int>(iAccessor.value().m_Stride);
 		}
-		else
-		{
-			// Add the current vertice to the current mesh info mapping hash table and increment the freeIndex
-			m_pMeshInfo->m_Mapping.insert(currentVertice, (m_pMeshInfo->m_FreeIndex)++);
-			// Add the the index to the polygon index
-			polygonIndex.append(m_pMeshInfo->m_Mapping.value(currentVertice));
+		else if (currentInput.m_Semantic != TEXCOORD) currentInput.m_Stride= 3; else currentInput.m_Stride= 2;
 
-			// Add the bulk data associated to the current vertice to the current mesh info
-			for (int dataIndex= 0; dataIndex < inputDataCount; ++dataIndex)
-			{
-				// The current input data
-				InputData currentInputData= inputDataList.at(dataIndex);
-				// QHash iterator on the right QList<float>
-				BulkDataHash::const_iterator iBulkHash= m_BulkDataHash.find(currentInputData.m_Source);
-				int stride;
-				if (m_DataAccessorHash.contains(currentInputData.m_Source))
-				{
-					stride= m_DataAccessorHash.value(currentInputData.m_Source).m_Stride;
-				}
-				else if (currentInputData.m_Semantic != TEXCOORD) stride= 3; else stride= 2;
-				// Firts value
-				m_pMeshInfo->m_Datas[currentInputData.m_Semantic].append(iBulkHash.value().at(polyIndexList.at(i + currentInputData.m_Offset) * stride));
-				// Second value
-				m_pMeshInfo->m_Datas[currentInputData.m_Semantic].append(iBulkHash.value().at(polyIndexList.at(i + currentInputData.m_Offset) * stride + 1));
-				// Fird value
-				if (currentInputData.m_Semantic != TEXCOORD)
-				{
-					m_pMeshInfo->m_Datas[currentInputData.m_Semantic].append(iBulkHash.value().at(polyIndexList.at(i + currentInputData.m_Offset) * stride + 2));
-				}
-			}
-			// Avoid problem wich occur with mesh containing materials with and without texture
-			if (!hasTexture)
-			{
-				m_pMeshInfo->m_Datas[TEXCOORD].append(0.0);
-			}
+		pPrimitive->m_TupleSize= qMax(pPrimitive->m_TupleSize, currentInput.m_Offset + 1);
+		if (currentInput.m_Semantic == VERTEX) hasVertex= true;
+	}
+	if (!hasVertex) throwException("Primitive without VERTEX input in " + m_CurrentId);
 
-		}
+	if (!pPrimitive->m_Index.isEmpty())
+	{
+		m_pMeshInfo->m_Primitives.append(*pPrimitive);
 	}
+}
+
+// Build the vertices and the triangles of the mesh of the given task
+void GLC_ColladaToWorld::buildMeshTask(MeshTask& task)
+{
+	MeshInfo* pMeshInfo= task.m_pMeshInfo;
 
-	// Save mesh info index offset
-	const int indexOffset= m_pMeshInfo->m_Index.size();
-	// Triangulate the polygons of the polylist
-	// Input polygon index must start from 0 and succesive : (0 1 2 3 4)
-	QList<GLuint> onePolygonIndex;
-	for (int i= 0; i < polygonCount; ++i)
+	// Primitives using the same sources share their vertices
+	QHash<QString, int> inputSets;
+	const int primitiveCount= pMeshInfo->m_Primitives.size();
+	for (int i= 0; i < primitiveCount; ++i)
 	{
-		const int polygonSize= vcountList.at(i);
-		Q_ASSERT(polygonSize > 2);
-		for (int i= 0; i < polygonSize; ++i)
-		{
-			onePolygonIndex.append(polygonIndex.takeFirst());
-		}
-		// Triangulate the current polygon if the polygon as more than 3 vertice
-		if (polygonSize > 3)
+		Primitive& primitive= pMeshInfo->m_Primitives[i];
+		QString inputSetKey;
+		const int inputDataCount= primitive.m_Inputs.size();
+		for (int dataIndex= 0; dataIndex < inputDataCount; ++dataIndex)
 		{
-			glc::triangulatePolygon(&onePolygonIndex, m_pMeshInfo->m_Datas.at(VERTEX));
+			inputSetKey+= QString::number(primitive.m_Inputs.at(dataIndex).m_Semantic) + primitive.m_Inputs.at(dataIndex).m_Source + ' ';
 		}
-		// Add index to the mesh info
-		//Q_ASSERT(not onePolygonIndex.isEmpty());
-		if (!onePolygonIndex.isEmpty())
+		if (!inputSets.contains(inputSetKey))
 		{
-			m_pMeshInfo->m_Index.append(onePolygonIndex);
+			inputSets.insert(inputSetKey, inputSets.size());
 		}
-		else
+
+		if (!buildPrimitive(task, inputSets.value(inputSetKey), &primitive))
 		{
-			QStringList stringList(m_FileName);
-			stringList.append("Unable to triangulate a polygon of " + m_pMeshInfo->m_pMesh->name());
-			GLC_ErrorLog::addError(stringList);
+			task.m_Error= "Index out of range in geometry " + pMeshInfo->m_pMesh->name();
+			return;
 		}
-		onePolygonIndex.clear();
 	}
 
-	// Check if normal computation is needed
-	if (!hasNormals)
+	// Vertices of primitives without texture coordinate get an empty one
+	GLfloatVector& texels= pMeshInfo->m_Datas[TEXCOORD];
+	if (!texels.isEmpty())
 	{
-		qDebug() << "Compute Normals with offset " << indexOffset;
-		computeNormalOfCurrentPrimitiveOfCurrentMesh(indexOffset);
+		const int texelCount= pMeshInfo->m_Vertices.size() * 2;
+		texels.reserve(texelCount);
+		while (texels.size() < texelCount) texels.append(0.0f);
 	}
 
-	// Add material the current mesh info
-	MatOffsetSize matInfo;
-	matInfo.m_Offset= indexOffset;
-	matInfo.m_size= m_pMeshInfo->m_Index.size() - indexOffset;
-	m_pMeshInfo->m_Materials.insert(materialId, matInfo);
-
+	// The hash table is only used by the building
+	pMeshInfo->m_Vertices.clear();
+	pMeshInfo->m_VerticeSlots.clear();
 }
-// Compute Normals for the current primitive element of the current mesh
-void GLC_ColladaToWorld::computeNormalOfCurrentPrimitiveOfCurrentMesh(int indexOffset)
+
+// Build the triangles of the given primitive of the given mesh with the given sources set
+bool GLC_ColladaToWorld::buildPrimitive(const MeshTask& task, int inputSet, Primitive* pPrimitive)
 {
-	const QList<float>* pData= &(m_pMeshInfo->m_Datas.at(VERTEX));
-	// Fill the list of normal
-	QList<float>* pNormal= &(m_pMeshInfo->m_Datas[NORMAL]);
-	const int normalOffset= pNormal->size();
-	const int normalCount= pData->size() - normalOffset;
-	for (int i= 0; i < normalCount; ++i)
+	MeshInfo* pMeshInfo= task.m_pMeshInfo;
+
+	// The first input of each semantic is used
+	const InputData* pInputs[3]= {NULL, NULL, NULL};
+	const int inputDataCount= pPrimitive->m_Inputs.size();
+	for (int dataIndex= 0; dataIndex < inputDataCount; ++dataIndex)
 	{
-		pNormal->append(0.0f);
+		const InputData& currentInput= pPrimitive->m_Inputs.at(dataIndex);
+		if (NULL == pInputs[currentInput.m_Semantic]) pInputs[currentInput.m_Semantic]= &currentInput;
 	}
-	// Compute the normals and add them to the current mesh info
-	const int size= m_pMeshInfo->m_Index.size() - indexOffset;
-	double xn, yn, zn;
 
-
-	for (int i= indexOffset; i < size; i+=3)
+	// Check the range of the index of each input
+	const int tupleSize= pPrimitive->m_TupleSize;
+	const int tupleCount= pPrimitive->m_Index.size() / tupleSize;
+	const GLuint* pIndex= pPrimitive->m_Index.constData();
+	for (int semantic= 0; semantic < 3; ++semantic)
 	{
-		// Vertex 1
-		xn= pData->at(m_pMeshInfo->m_Index.at(i) * 3);
-		yn= pData->at(m_pMeshInfo->m_Index.at(i) * 3 + 1);
-		zn= pData->at(m_pMeshInfo->m_Index.at(i) * 3 + 2);
-		const GLC_Vector3d vect1(xn, yn, zn);
-
-		// Vertex 2
-		xn= pData->at(m_pMeshInfo->m_Index.at(i + 1) * 3);
-		yn= pData->at(m_pMeshInfo->m_Index.at(i + 1) * 3  + 1);
-		zn= pData->at(m_pMeshInfo->m_Index.at(i + 1) * 3 + 2);
-		const GLC_Vector3d vect2(xn, yn, zn);
-
-		// Vertex 3
-		xn= pData->at(m_pMeshInfo->m_Index.at(i + 2) * 3);
-		yn= pData->at(m_pMeshInfo->m_Index.at(i + 2) * 3 + 1);
-		zn= pData->at(m_pMeshInfo->m_Index.at(i + 2) * 3 + 2);
-		const GLC_Vector3d vect3(xn, yn, zn);
-
-		const GLC_Vector3d edge1(vect3 - vect2);
-		const GLC_Vector3d edge2(vect1 - vect2);
-
-		GLC_Vector3d normal(edge1 ^ edge2);
-		normal.normalize();
-
-		GLC_Vector3df curNormal= normal.toVector3df();
-		for (int curVertex= 0; curVertex < 3; ++curVertex)
+		const InputData* pInput= pInputs[semantic];
+		if (NULL == pInput) continue;
+		const int componentCount= (TEXCOORD == semantic) ? 2 : 3;
+		const qint64 valueCount= pInput->m_Values.size();
+		for (int i= 0; i < tupleCount; ++i)
 		{
-			(*pNormal)[m_pMeshInfo->m_Index.at(i + curVertex) * 3]= curNormal.x();
-			(*pNormal)[m_pMeshInfo->m_Index.at(i + curVertex) * 3 + 1]= curNormal.y();
-			(*pNormal)[m_pMeshInfo->m_Index.at(i + curVertex) * 3 + 2]= curNormal.z();
+			const qint64 valueIndex= pInput->m_ValueOffset + static_cast<qint64>(pIndex[i * tupleSize + pInput->m_Offset]) * pInput->m_Stride;
+			if ((valueIndex < 0) || ((valueIndex + componentCount) > valueCount)) return false;
 		}
 	}
-}
-
-// Load triangles
-void  GLC_ColladaToWorld::loadTriangles()
-{
-	//qDebug() << "GLC_ColladaToWorld::loadTriangles()";
-	// The material id
-	const QString materialId= readAttribute("material", false);
 
-	// Offsets and data source list
-	QList<InputData> inputDataList;
-
-	// triangle index list
-	QList<int> trianglesIndexList;
+	// Find or add the vertex of each tuple
+	IndexList verticeIndex;
+	verticeIndex.reserve(tupleCount);
+	ColladaVertice currentVertice;
+	currentVertice.m_InputSet= inputSet;
+	for (int i= 0; i < tupleCount; ++i)
+	{
+		for (int semantic= 0; semantic < 3; ++semantic)
+		{
+			if (NULL != pInputs[semantic])
+			{
+				currentVertice.m_Values[semantic]= static_cast<int>(pIndex[i * tupleSize + pInputs[semantic]->m_Offset]);
+			}
+		}
+		verticeIndex.append(colladaVerticeIndex(pMeshInfo, pInputs, currentVertice));
+	}
 
-	while (endElementNotReached(m_pStreamReader, "triangles"))
+	// Triangulate the polygons
+	IndexList& triangles= pPrimitive->m_Triangles;
+	if (pPrimitive->m_VCount.isEmpty())
 	{
-		if (QXmlStreamReader::StartElement == m_pStreamReader->tokenType())
+		triangles= verticeIndex;
+		while ((triangles.size() % 3) != 0) triangles.removeLast();
+	}
+	else
+	{
+		triangles.reserve(tupleCount);
+		const int polygonCount= pPrimitive->m_VCount.size();
+		int verticeOffset= 0;
+		for (int i= 0; i < polygonCount; ++i)
 		{
-			const QStringRef currentElementName= m_pStreamReader->name();
-			if ((currentElementName == "input") && trianglesIndexList.isEmpty())
+			const int polygonSize= static_cast<int>(pPrimitive->m_VCount.at(i));
+			if ((verticeOffset + polygonSize) > tupleCount) return false;
+			if (3 == polygonSize)
 			{
-				InputData currentInput;
-				// Get input data offset
-				currentInput.m_Offset= readAttribute("offset", true).toInt();
-				// Get input data semantic
-				const QString semantic= readAttribute("semantic", true);
-				if (semantic == "VERTEX") currentInput.m_Semantic= VERTEX;
-				else if (semantic == "NORMAL") currentInput.m_Semantic= NORMAL;
-				else if (semantic == "TEXCOORD") currentInput.m_Semantic= TEXCOORD;
-				else throwException("Source semantic :" + semantic + "Not supported");
-				// Get input data source id
-				currentInput.m_Source= readAttribute("source", true).remove('#');
-
-				// Bypasss vertices indirection
-				if (m_VerticesSourceHash.contains(currentInput.m_Source))
-				{
-					currentInput.m_Source= m_VerticesSourceHash.value(currentInput.m_Source);
-				}
-				inputDataList.append(currentInput);
+				triangles.append(verticeIndex.mid(verticeOffset, 3));
 			}
-			else if ((currentElementName == "p") && trianglesIndexList.isEmpty())
+			else if (polygonSize > 3)
 			{
-				{ // Fill index List
-					QString pString= getContent("p");
-					QStringList pStringList= pString.split(' ');
-					bool toIntOK;
-					const int size= pStringList.size();
-					for (int i= 0; i < size; ++i)
-					{
-						trianglesIndexList.append(pStringList.at(i).toInt(&toIntOK));
-						if (!toIntOK) throwException("Unable to convert string :" + pStringList.at(i) + " To int");
-					}
+				IndexList faceIndex(verticeIndex.mid(verticeOffset, polygonSize));
+				triangulateFace(pMeshInfo, &faceIndex);
+				if (!faceIndex.isEmpty())
+				{
+					triangles.append(faceIndex);
+				}
+				else
+				{
+					QStringList stringList(task.m_FileName);
+					stringList.append("Unable to triangulate a polygon of " + pMeshInfo->m_pMesh->name());
+					GLC_ErrorLog::addError(stringList);
 				}
-
 			}
+			verticeOffset+= polygonSize;
 		}
-		m_pStreamReader->readNext();
 	}
 
-	// Add the polylist to the current mesh
-	addTrianglesToCurrentMesh(inputDataList, trianglesIndexList, materialId);
+	// Check if normal computation is needed
+	if (NULL == pInputs[NORMAL])
+	{
+		computeNormals(pMeshInfo, triangles);
+	}
 
-	updateProgressBar();
+	// The index of the primitive are no longer used
+	pPrimitive->m_Index.clear();
+	pPrimitive->m_VCount.clear();
 
+	return true;
 }
 
-// Add the triangles to current mesh
-void GLC_ColladaToWorld::addTrianglesToCurrentMesh(const QList<InputData>& inputDataList, const QList<int>& trianglesIndexList, const QString& materialId)
+// Return the index of the given collada vertice in the given mesh, add it if needed
+GLuint GLC_ColladaToWorld::colladaVerticeIndex(MeshInfo* pMeshInfo, const InputData* const pInputs[3], const ColladaVertice& vertice)
 {
-	//qDebug() << "GLC_ColladaToWorld::addTrianglesToCurrentMesh";
-
-	const int inputDataCount= inputDataList.size();
-	const int trianglesIndexCount= trianglesIndexList.size();
+	// Search the vertice in the hash table
+	GLuint mask= static_cast<GLuint>(pMeshInfo->m_VerticeSlots.size()) - 1;
+	GLuint slot= qHash(vertice) & mask;
+	const GLuint* pSlots= pMeshInfo->m_VerticeSlots.constData();
+	while (0 != pSlots[slot])
+	{
+		const GLuint index= pSlots[slot] - 1;
+		if (pMeshInfo->m_Vertices.at(index) == vertice) return index;
+		slot= (slot + 1) & mask;
+	}
 
-	// Flag to know if the polylist has normal
-	bool hasNormals= false;
-	bool hasTexture= false;
+	// Add the vertice to the hash table
+	const GLuint index= static_cast<GLuint>(pMeshInfo->m_Vertices.size());
+	pMeshInfo->m_VerticeSlots[slot]= index + 1;
+	pMeshInfo->m_Vertices.append(vertice);
 
-	// Check the existance of data source
-	for (int dataIndex= 0; dataIndex < inputDataCount; ++dataIndex)
+	// Add the bulk data associated to the vertice, resolved by the accessors
+	for (int semantic= 0; semantic < 3; ++semantic)
 	{
-		const QString source= inputDataList.at(dataIndex).m_Source;
-		if ( !m_BulkDataHash.contains(source))
+		GLfloatVector& datas= pMeshInfo->m_Datas[semantic];
+		const int componentCount= (TEXCOORD == semantic) ? 2 : 3;
+		const InputData* pInput= pInputs[semantic];
+		if (NULL != pInput)
 		{
-			throwException(" Source : " + source + " Not found");
-		}
-		if (inputDataList.at(dataIndex).m_Semantic == NORMAL) hasNormals= true;
-		if (inputDataList.at(dataIndex).m_Semantic == TEXCOORD) hasTexture= true;
-	}
+			// Previous vertex without texture coordinate get an empty one
+			while (datas.size() < static_cast<int>(index) * componentCount) datas.append(0.0f);
 
-	int maxOffset= 0;
-	for (int i= 0; i < inputDataCount; ++i)
-	{
-		if (inputDataList.at(i).m_Offset > maxOffset)
+			const GLfloat* pValues= pInput->m_Values.constData() + pInput->m_ValueOffset + vertice.m_Values[semantic] * pInput->m_Stride;
+			for (int i= 0; i < componentCount; ++i) datas.append(pValues[i]);
+		}
+		else if ((TEXCOORD != semantic) || !datas.isEmpty())
 		{
-			maxOffset= inputDataList.at(i).m_Offset;
+			// Normals are computed later
+			for (int i= 0; i < componentCount; ++i) datas.append(0.0f);
 		}
 	}
-	//qDebug() << " Triangles Max Offset :" << maxOffset;
 
-	// the polygonIndex of the polylist
-	QList<GLuint> trianglesIndex;
-
-	// Fill the mapping, bulk data and index list of the current mesh info
-	for (int i= 0; i < trianglesIndexCount; i+= maxOffset + 1)
+	// Keep the load of the hash table under 3/4
+	const int verticeCount= pMeshInfo->m_Vertices.size();
+	if ((verticeCount * 4) > (pMeshInfo->m_VerticeSlots.size() * 3))
 	{
-		// Create and set the current vertice index
-		ColladaVertice currentVertice;
-		for (int dataIndex= 0; dataIndex < inputDataCount; ++dataIndex)
-		{
-			currentVertice.m_Values[inputDataList.at(dataIndex).m_Semantic]= trianglesIndexList.at(i + inputDataList.at(dataIndex).m_Offset);
-		}
-
-		if (m_pMeshInfo->m_Mapping.contains(currentVertice))
+		pMeshInfo->m_VerticeSlots.fill(0, pMeshInfo->m_VerticeSlots.size() * 2);
+		mask= static_cast<GLuint>(pMeshInfo->m_VerticeSlots.size()) - 1;
+		GLuint* pNewSlots= pMeshInfo->m_VerticeSlots.data();
+		for (int i= 0; i < verticeCount; ++i)
 		{
-			// Add the the index to the triangles index
-			trianglesIndex.append(m_pMeshInfo->m_Mapping.value(currentVertice));
-		}
-		else
-		{
-			// Add the current vertice to the current mesh info mapping hash table and increment the freeIndex
-			m_pMeshInfo->m_Mapping.insert(currentVertice, (m_pMeshInfo->m_FreeIndex)++);
-			// Add the the index to the triangles index
-			trianglesIndex.append(m_pMeshInfo->m_Mapping.value(currentVertice));
-
-			// Add the bulk data associated to the current vertice to the current mesh info
-			for (int dataIndex= 0; dataIndex < inputDataCount; ++dataIndex)
-			{
-				// The current input data
-				InputData currentInputData= inputDataList.at(dataIndex);
-				// QHash iterator on the right QList<float>
-				BulkDataHash::const_iterator iBulkHash= m_BulkDataHash.find(currentInputData.m_Source);
-				int stride;
-				if (m_DataAccessorHash.contains(currentInputData.m_Source))
-				{
-					stride= m_DataAccessorHash.value(currentInputData.m_Source).m_Stride;
-				}
-				else if (currentInputData.m_Semantic != TEXCOORD) stride= 3; else stride= 2;
-				// Firts value
-				m_pMeshInfo->m_Datas[currentInputData.m_Semantic].append(iBulkHash.value().at(trianglesIndexList.at(i + currentInputData.m_Offset) * stride));
-				// Second value
-				m_pMeshInfo->m_Datas[currentInputData.m_Semantic].append(iBulkHash.value().at(trianglesIndexList.at(i + currentInputData.m_Offset) * stride + 1));
-				// Fird value
-				if (currentInputData.m_Semantic != TEXCOORD)
-				{
-					m_pMeshInfo->m_Datas[currentInputData.m_Semantic].append(iBulkHash.value().at(trianglesIndexList.at(i + currentInputData.m_Offset) * stride + 2));
-				}
-				// Avoid problem wich occur with mesh containing materials with and without texture
-				if (!hasTexture)
-				{
-					m_pMeshInfo->m_Datas[TEXCOORD].append(0.0);
-				}
-			}
+			slot= qHash(pMeshInfo->m_Vertices.at(i)) & mask;
+			while (0 != pNewSlots[slot]) slot= (slot + 1) & mask;
+			pNewSlots[slot]= static_cast<GLuint>(i) + 1;
 		}
 	}
 
-	// Save mesh info index offset
-	const int indexOffset= m_pMeshInfo->m_Index.size();
+	return index;
+}
 
-	// Add index to the mesh info
-	m_pMeshInfo->m_Index.append(trianglesIndex);
+// Triangulate the given polygon of the given mesh
+void GLC_ColladaToWorld::triangulateFace(const MeshInfo* pMeshInfo, IndexList* pFaceIndex)
+{
+	// The polygon is triangulated with its own vertice
+	const GLfloatVector& positions= pMeshInfo->m_Datas.at(VERTEX);
+	const int size= pFaceIndex->size();
+	QList<float> polygon;
+	IndexList polygonIndex;
+	for (int i= 0; i < size; ++i)
+	{
+		const GLuint index= pFaceIndex->at(i);
+		polygon << positions.at(index * 3);
+		polygon << positions.at(index * 3 + 1);
+		polygon << positions.at(index * 3 + 2);
+		polygonIndex.append(i);
+	}
+	glc::triangulatePolygon(&polygonIndex, polygon);
 
-	// Check if normal computation is needed
-	if (!hasNormals)
+	IndexList faceIndex;
+	const int triangleIndexCount= polygonIndex.size();
+	for (int i= 0; i < triangleIndexCount; ++i)
 	{
-		computeNormalOfCurrentPrimitiveOfCurrentMesh(indexOffset);
+		faceIndex.append(pFaceIndex->at(polygonIndex.at(i)));
 	}
+	*pFaceIndex= faceIndex;
+}
+
+// Set the normals of the given triangles of the given mesh to their face normals
+void GLC_ColladaToWorld::computeNormals(MeshInfo* pMeshInfo, const IndexList& triangles)
+{
+	const GLfloat* pData= pMeshInfo->m_Datas.at(VERTEX).constData();
+	GLfloat* pNormal= pMeshInfo->m_Datas[NORMAL].data();
+	const int size= triangles.size();
+	for (int i= 0; i < size; i+= 3)
+	{
+		const GLuint index1= triangles.at(i) * 3;
+		const GLuint index2= triangles.at(i + 1) * 3;
+		const GLuint index3= triangles.at(i + 2) * 3;
+		const GLC_Vector3d vect1(pData[index1], pData[index1 + 1], pData[index1 + 2]);
+		const GLC_Vector3d vect2(pData[index2], pData[index2 + 1], pData[index2 + 2]);
+		const GLC_Vector3d vect3(pData[index3], pData[index3 + 1], pData[index3 + 2]);
+
+		const GLC_Vector3d edge1(vect3 - vect2);
+		const GLC_Vector3d edge2(vect1 - vect2);
 
-	// Add material the current mesh info
-	MatOffsetSize matInfo;
-	matInfo.m_Offset= indexOffset;
-	matInfo.m_size= m_pMeshInfo->m_Index.size() - indexOffset;
-	m_pMeshInfo->m_Materials.insertMulti(materialId, matInfo);
+		GLC_Vector3d normal(edge1 ^ edge2);
+		normal.normalize();
 
+		const GLC_Vector3df curNormal= normal.toVector3df();
+		for (int curVertex= 0; curVertex < 3; ++curVertex)
+		{
+			const GLuint normalIndex= triangles.at(i + curVertex) * 3;
+			pNormal[normalIndex]= curNormal.x();
+			pNormal[normalIndex + 1]= curNormal.y();
+			pNormal[normalIndex + 2]= curNormal.z();
+		}
+	}
 }
 
 // Load the library nodes
@@ -1837,86 +1789,122 @@ void GLC_ColladaToWorld::linkTexturesToMaterials()
 void GLC_ColladaToWorld::createMesh()
 {
 	//qDebug() << "GLC_ColladaToWorld::createMesh()";
+	const int size= m_GeometryHash.size();
+	QVector<MeshTask> tasks(size);
+	QList<QString> ids;
 	QHash<const QString, MeshInfo*>::iterator iMeshInfo= m_GeometryHash.begin();
-	while (m_GeometryHash.constEnd() != iMeshInfo)
+	for (int i= 0; i < size; ++i, ++iMeshInfo)
+	{
+		tasks[i].m_pMeshInfo= iMeshInfo.value();
+		tasks[i].m_FileName= m_FileName;
+		tasks[i].m_pRep= NULL;
+		ids.append(iMeshInfo.key());
+	}
+	// The primitives share the bulk data they use
+	m_BulkDataHash.clear();
+	m_DataAccessorHash.clear();
+
+	// Build the vertices and the triangles of the independent geometries
+	const bool inParallel= GLC_State::isParallelLoadingActivated() && (size > 1);
+	if (inParallel)
+	{
+		QtConcurrent::blockingMap(tasks, &GLC_ColladaToWorld::buildMeshTask);
+	}
+	else
+	{
+		for (int i= 0; i < size; ++i) buildMeshTask(tasks[i]);
+	}
+	for (int i= 0; i < size; ++i)
+	{
+		if (!tasks.at(i).m_Error.isEmpty()) throwException(tasks.at(i).m_Error);
+	}
+
+	// Add bulk data and triangles to the meshes, materials are shared by the meshes
+	for (int i= 0; i < size; ++i)
 	{
-		MeshInfo* pCurrentMeshInfo= iMeshInfo.value();
-		// Add Bulk Data to the mesh
+		MeshInfo* pCurrentMeshInfo= tasks.at(i).m_pMeshInfo;
 		// Add vertice
-		pCurrentMeshInfo->m_pMesh->addVertice(pCurrentMeshInfo->m_Datas.at(VERTEX).toVector());
-		//qDebug() << "Add " << pCurrentMeshInfo->m_Datas[VERTEX].size() << " Vertice";
+		pCurrentMeshInfo->m_pMesh->addVertice(pCurrentMeshInfo->m_Datas.at(VERTEX));
 		pCurrentMeshInfo->m_Datas[VERTEX].clear();
 
 		// Add Normal
-		pCurrentMeshInfo->m_pMesh->addNormals(pCurrentMeshInfo->m_Datas.at(NORMAL).toVector());
-		//qDebug() << "Add " << pCurrentMeshInfo->m_Datas[NORMAL].size() << " Normal";
+		pCurrentMeshInfo->m_pMesh->addNormals(pCurrentMeshInfo->m_Datas.at(NORMAL));
 		pCurrentMeshInfo->m_Datas[NORMAL].clear();
 
 		// Add texel if necessary
-		//qDebug() << "Add " << pCurrentMeshInfo->m_Datas[TEXCOORD].size() << " texel";
 		if (!pCurrentMeshInfo->m_Datas.at(TEXCOORD).isEmpty())
 		{
-			pCurrentMeshInfo->m_pMesh->addTexels(pCurrentMeshInfo->m_Datas.at(TEXCOORD).toVector());
+			pCurrentMeshInfo->m_pMesh->addTexels(pCurrentMeshInfo->m_Datas.at(TEXCOORD));
 			pCurrentMeshInfo->m_Datas[TEXCOORD].clear();
 		}
 
-		// Add face index and material to the mesh
-		QHash<QString, MatOffsetSize>::iterator iMatInfo= pCurrentMeshInfo->m_Materials.begin();
-		while (pCurrentMeshInfo->m_Materials.constEnd() != iMatInfo)
+		// Add the triangles of each primitive with its material
+		const int primitiveCount= pCurrentMeshInfo->m_Primitives.size();
+		for (int primitiveIndex= 0; primitiveIndex < primitiveCount; ++primitiveIndex)
 		{
-			// Trying to find the material
-			QString materialId= iMatInfo.key();
-			GLC_Material* pCurrentMaterial= NULL;
-			if (m_MaterialInstanceMap.contains(materialId))
-			{
-				//qDebug() << "Map " << materialId << " to " << m_MaterialInstanceMap.value(materialId);
-				materialId= m_MaterialInstanceMap.value(materialId);
-			}
-			//qDebug() << "MaterialLibHash size : " << m_MaterialLibHash.size();
-			if (m_MaterialLibHash.contains(materialId))
+			const Primitive& primitive= pCurrentMeshInfo->m_Primitives.at(primitiveIndex);
+			if (!primitive.m_Triangles.isEmpty())
 			{
-				materialId= m_MaterialLibHash.value(materialId);
-				//qDebug() << "Material id " << materialId;
-			}
-			if (m_MaterialEffectHash.contains(materialId))
-			{
-				//qDebug() << "Material " << materialId << " find";
-				pCurrentMaterial= m_MaterialEffectHash.value(materialId);
-				Q_ASSERT(NULL != pCurrentMaterial);
-			}
-			else
-			{
-				QStringList stringList(m_FileName);
-				stringList.append("Material " + materialId + " Not found");
-				GLC_ErrorLog::addError(stringList);
+				pCurrentMeshInfo->m_pMesh->addTriangles(materialOfInstance(primitive.m_MaterialId), primitive.m_Triangles);
 			}
+		}
+		pCurrentMeshInfo->m_Primitives.clear();
+	}
 
-			// Create the list of triangles to add to the mesh
-			const int offset= iMatInfo.value().m_Offset;
-			const int size= iMatInfo.value().m_size;
-			//qDebug() << "Offset : " << offset << " size : " << size;
-			QList<GLuint> triangles;
-			for (int i= offset; i < (offset + size); ++i)
-			{
-				triangles.append(pCurrentMeshInfo->m_Index.at(i));
-			}
-			//qDebug() << "Add " << triangles.size() << " elment to the triangle index";
-			// Add the list of triangle to the mesh
-			if (!triangles.isEmpty())
-			{
-				pCurrentMeshInfo->m_pMesh->addTriangles(pCurrentMaterial, triangles);
-			}
+	// Finish the meshes
+	if (inParallel)
+	{
+		QtConcurrent::blockingMap(tasks, &GLC_ColladaToWorld::finishMeshTask);
+	}
+	else
+	{
+		for (int i= 0; i < size; ++i) finishMeshTask(tasks[i]);
+	}
+	for (int i= 0; i < size; ++i)
+	{
+		//qDebug() << "Insert Rep : " << ids.at(i);
+		m_3DRepHash.insert(ids.at(i), tasks.at(i).m_pRep);
+	}
+}
 
-			++iMatInfo;
-		}
-		pCurrentMeshInfo->m_pMesh->finish();
-		GLC_3DRep* pRep= new GLC_3DRep(pCurrentMeshInfo->m_pMesh);
-		pCurrentMeshInfo->m_pMesh= NULL;
-		pRep->clean();
-		//qDebug() << "Insert Rep : " << iMeshInfo.key();
-		m_3DRepHash.insert(iMeshInfo.key(), pRep);
-		++iMeshInfo;
+// Finish the mesh of the given task and create its representation
+void GLC_ColladaToWorld::finishMeshTask(MeshTask& task)
+{
+	MeshInfo* pMeshInfo= task.m_pMeshInfo;
+	pMeshInfo->m_pMesh->finish();
+	task.m_pRep= new GLC_3DRep(pMeshInfo->m_pMesh);
+	pMeshInfo->m_pMesh= NULL;
+	task.m_pRep->clean();
+}
+
+// Return the material of the given material instance id, NULL if it is not found
+GLC_Material* GLC_ColladaToWorld::materialOfInstance(const QString& materialInstanceId)
+{
+	// Trying to find the material
+	QString materialId= materialInstanceId;
+	GLC_Material* pMaterial= NULL;
+	if (m_MaterialInstanceMap.contains(materialId))
+	{
+		//qDebug() << "Map " << materialId << " to " << m_MaterialInstanceMap.value(materialId);
+		materialId= m_MaterialInstanceMap.value(materialId);
+	}
+	if (m_MaterialLibHash.contains(materialId))
+	{
+		materialId= m_MaterialLibHash.value(materialId);
+	}
+	if (m_MaterialEffectHash.contains(materialId))
+	{
+		pMaterial= m_MaterialEffectHash.value(materialId);
+		Q_ASSERT(NULL != pMaterial);
 	}
+	else
+	{
+		QStringList stringList(m_FileName);
+		stringList.append("Material " + materialId + " Not found");
+		GLC_ErrorLog::addError(stringList);
+	}
+
+	return pMaterial;
 }
 
 // Create the scene graph struct
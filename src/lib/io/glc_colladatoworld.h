@@ -42,6 +42,12 @@ class GLC_World;
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_ColladaToWorld
 /*! \brief GLC_ColladaToWorld : Create an GLC_World from dae file */
+
+/*! The numeric arrays are parsed in place into typed vectors during the xml pass,
+ *  the primitives only keep their index. The vertices and triangles of the
+ *  geometries are built after the xml pass, on worker threads if
+ *  GLC_State::isParallelLoadingActivated() is true.
+ */
 //////////////////////////////////////////////////////////////////////
 class GLC_LIB_EXPORT GLC_ColladaToWorld : public QObject
 {
@@ -59,33 +65,41 @@ private:
 	// input data info
 	struct InputData
 	{
+		InputData()
+		: m_Offset(0)
+		, m_Source()
+		, m_Semantic(VERTEX)
+		, m_Values()
+		, m_ValueOffset(0)
+		, m_Stride(0)
+		{}
 		int m_Offset;
 		QString m_Source;
 		Semantic m_Semantic;
+		// The bulk data of the source, shared with the bulk data hash
+		GLfloatVector m_Values;
+		// The accessor offset and stride of the bulk data
+		int m_ValueOffset;
+		int m_Stride;
 	};
 public:
-	// Collada Vertice (Position index, Normal index and TexCoord index)
+	// Collada Vertice (Position index, Normal index and TexCoord index, -1 if not used)
 	struct ColladaVertice
 	{
 		ColladaVertice()
-		: m_Values(3)
+		: m_InputSet(0)
 		{
-			m_Values[0]= 0;
-			m_Values[1]= 0;
-			m_Values[2]= 0;
+			m_Values[0]= -1;
+			m_Values[1]= -1;
+			m_Values[2]= -1;
 		}
 
-		QVector<int> m_Values;
+		int m_Values[3];
+		// The index of the sources set of the vertice in its mesh
+		int m_InputSet;
 	};
 private:
 
-	// Material assignement
-	struct MatOffsetSize
-	{
-		int m_Offset;
-		int m_size;
-	};
-
 	// Accessor a source data (bulk)
 	struct Accessor
 	{
@@ -99,30 +113,66 @@ private:
 		unsigned int m_Stride;
 	};
 
+	// A triangles, polylist or polygons element of a mesh
+	struct Primitive
+	{
+		Primitive()
+		: m_Inputs()
+		, m_TupleSize(1)
+		, m_VCount()
+		, m_Index()
+		, m_MaterialId()
+		, m_Triangles()
+		{}
+		// The inputs of the primitive
+		QList<InputData> m_Inputs;
+		// The number of index of a vertice in the p elements
+		int m_TupleSize;
+		// The number of vertice of each polygon, empty for triangles
+		GLuintVector m_VCount;
+		// The index of the p elements
+		GLuintVector m_Index;
+		// The material id
+		QString m_MaterialId;
+		// The triangles index in the mesh, built after the xml pass
+		IndexList m_Triangles;
+	};
+
 	// The loading mesh info
 	struct MeshInfo
 	{
 		MeshInfo()
 		: m_pMesh(NULL)
+		, m_Primitives()
 		, m_Datas(3)
-		, m_Mapping()
-		, m_Index()
-		, m_FreeIndex(0)
+		, m_Vertices()
+		, m_VerticeSlots(1024, 0)
 		{}
 
 		~MeshInfo() {delete m_pMesh;}
 		// Mesh of the mesh info
 		GLC_Mesh* m_pMesh;
+		// The primitives of the mesh
+		QList<Primitive> m_Primitives;
 		// Bulk data vector (Position, normal, texel)
-		QVector<QList<float> > m_Datas;
-		// Mapping between collada vertice and index
-		QHash<ColladaVertice, GLuint> m_Mapping;
-		// Triangle index
-		IndexList m_Index;
-		// Next index Position
-		GLuint m_FreeIndex;
-		// QHash containing material id and associated offset and size
-		QHash<QString, MatOffsetSize> m_Materials;
+		QVector<GLfloatVector> m_Datas;
+		// The collada vertice of each index
+		QVector<ColladaVertice> m_Vertices;
+		// Open addressing hash table of collada vertice, a slot contains index + 1 or 0 if it's free
+		GLuintVector m_VerticeSlots;
+	};
+
+	// The building of a mesh after the xml pass
+	struct MeshTask
+	{
+		// The mesh info to build
+		MeshInfo* m_pMeshInfo;
+		// The collada file name
+		QString m_FileName;
+		// Result : the error which stops the building
+		QString m_Error;
+		// Result : the representation of the finished mesh
+		GLC_3DRep* m_pRep;
 	};
 
 	// The collada Node
@@ -152,7 +202,7 @@ private:
 	};
 
 	typedef QHash<const QString, GLC_Material*> MaterialHash;
-	typedef QHash<const QString, QList<float> > BulkDataHash;
+	typedef QHash<const QString, GLfloatVector> BulkDataHash;
 	typedef QHash<const QString, Accessor> DataAccessorHash;
 //////////////////////////////////////////////////////////////////////
 /*! @name Constructor / Destructor */
@@ -200,6 +250,10 @@ private:
 	// Return the content of an element
 	QString getContent(const QString&);
 
+	//! Append the numbers content of the given element to the given floats or to the given index
+	/*! Throw an exception if a number is not valid*/
+	void getNumericContent(const QString& element, GLfloatVector* pValues, GLuintVector* pIndex);
+
 	//! Read the specified attribute
 	QString readAttribute(const QString&, bool required= false);
 
@@ -291,17 +345,36 @@ private:
 	//! Load Polygons
 	void loadPolygons();
 
-	//! Add the polylist to the current mesh
-	void addPolylistToCurrentMesh(const QList<InputData>&, const QList<int>&, const QList<int>&, const QString&);
-
-	//! Compute Normals for the current primitive element of the current mesh from the specified offset
-	void computeNormalOfCurrentPrimitiveOfCurrentMesh(int offset);
-
 	//! Load triangles
 	void loadTriangles();
 
-	//! Add the triangles to current mesh
-	void addTrianglesToCurrentMesh(const QList<InputData>&, const QList<int>&, const QString&);
+	//! Load an input of a primitive
+	InputData loadInput();
+
+	//! Resolve the sources of the given primitive and add it to the current mesh
+	void addPrimitiveToCurrentMesh(Primitive* pPrimitive);
+
+	//! Build the vertices and the triangles of the mesh of the given task
+	static void buildMeshTask(MeshTask& task);
+
+	//! Build the triangles of the given primitive of the mesh of the given task with the given sources set
+	/*! Return false if an index is out of range*/
+	static bool buildPrimitive(const MeshTask& task, int inputSet, Primitive* pPrimitive);
+
+	//! Return the index of the given collada vertice in the given mesh, add it if needed
+	static GLuint colladaVerticeIndex(MeshInfo* pMeshInfo, const InputData* const pInputs[3], const ColladaVertice& vertice);
+
+	//! Triangulate the given polygon of the given mesh
+	static void triangulateFace(const MeshInfo* pMeshInfo, IndexList* pFaceIndex);
+
+	//! Set the normals of the given triangles of the given mesh to their face normals
+	static void computeNormals(MeshInfo* pMeshInfo, const IndexList& triangles);
+
+	//! Finish the mesh of the given task and create its representation
+	static void finishMeshTask(MeshTask& task);
+
+	//! Return the material of the given material instance id, NULL if it is not found
+	GLC_Material* materialOfInstance(const QString& materialId);
 
 	//! Load the library nodes
 	void loadLibraryNodes();
@@ -446,9 +519,18 @@ private:
 
 // To use ColladaVertice as a QHash key
 inline bool operator==(const GLC_ColladaToWorld::ColladaVertice& vertice1, const GLC_ColladaToWorld::ColladaVertice& vertice2)
-{ return (vertice1.m_Values == vertice2.m_Values);}
+{
+	return (vertice1.m_Values[0] == vertice2.m_Values[0]) && (vertice1.m_Values[1] == vertice2.m_Values[1])
+			&& (vertice1.m_Values[2] == vertice2.m_Values[2]) && (vertice1.m_InputSet == vertice2.m_InputSet);
+}
 
 inline uint qHash(const GLC_ColladaToWorld::ColladaVertice& vertice)
-{ return qHash(QString::number(vertice.m_Values.at(0)) + QString::number(vertice.m_Values.at(1)) + QString::number(vertice.m_Values.at(2)));}
+{
+	uint hash= static_cast<uint>(vertice.m_Values[0]) * 73856093u;
+	hash^= static_cast<uint>(vertice.m_Values[1]) * 19349663u;
+	hash^= static_cast<uint>(vertice.m_Values[2]) * 83492791u;
+	hash^= static_cast<uint>(vertice.m_InputSet) * 2654435761u;
+	return hash ^ (hash >> 16);
+}
 
 #endif /* GLC_COLLADATOWORLD_H_ */
@@ -37,6 +37,8 @@
 #include "../sceneGraph/glc_world.h"
 #include "../glc_fileformatexception.h"
 #include "../glc_factory.h"
+#include "../glc_state.h"
+#include "../geometry/glc_meshsimplifier.h"
 #include "glc_worldreaderplugin.h"
 
 //////////////////////////////////////////////////////////////////////
@@ -152,6 +154,13 @@ GLC_World GLC_FileLoader::createWorldFromFile(QFile &file, QStringList* pAttache
 		GLC_FileFormatException fileFormatException(message, file.fileName(), GLC_FileFormatException::FileNotSupported);
 		throw(fileFormatException);
 	}
+
+	// Meshes which already have LODs are left unchanged
+	if (GLC_State::isAutomaticLodActivated())
+	{
+		GLC_MeshSimplifier().generateLods(*pWorld);
+	}
+
 	GLC_World resulWorld(*pWorld);
 	delete pWorld;
 
@@ -0,0 +1,446 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_numericparser.cpp implementation of the numeric text parsing functions.
+
+#include "glc_numericparser.h"
+
+#include <limits>
+#include <math.h>
+#include <string.h>
+
+// Exact powers of ten representable by a double
+static const double exactPowerOfTen[]= {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Mantissa digits above this limit are ignored
+static const quint64 mantissaLimit= Q_UINT64_C(100000000000000000);
+
+// Powers of ten of the significant digits of a formatted float
+static const quint64 integerPowerOfTen[]= {Q_UINT64_C(1), Q_UINT64_C(10), Q_UINT64_C(100), Q_UINT64_C(1000),
+	Q_UINT64_C(10000), Q_UINT64_C(100000), Q_UINT64_C(1000000), Q_UINT64_C(10000000), Q_UINT64_C(100000000),
+	Q_UINT64_C(1000000000)};
+
+// A float written with 6 significant digits keeps all its shorter texts, 9 digits always read back the float
+static const int minimumFloatDigits= 6;
+static const int maximumFloatDigits= 9;
+
+// Return the code of the given character
+static inline ushort charCode(QChar c)
+{
+	return c.unicode();
+}
+
+static inline ushort charCode(char c)
+{
+	return static_cast<uchar>(c);
+}
+
+// Return 10 power the given exponent
+static inline double powerOfTen(int exponent)
+{
+	if ((exponent >= 0) && (exponent <= 22)) return exactPowerOfTen[exponent];
+	else return pow(10.0, exponent);
+}
+
+// Return a pointer after the given lower case keyword if the characters begin with it, ignoring the case
+template <typename Char>
+static const Char* scanKeyword(const Char* p, const Char* pEnd, const char* pKeyword)
+{
+	while ('\0' != *pKeyword)
+	{
+		if ((p == pEnd) || ((charCode(*p) | 0x20) != static_cast<ushort>(*pKeyword))) return NULL;
+		++p;
+		++pKeyword;
+	}
+	return p;
+}
+
+// Parse the not a number and infinity keywords, return NULL if there is none
+template <typename Char>
+static const Char* scanNonFiniteFloat(const Char* p, const Char* pEnd, bool negative, GLfloat* pValue)
+{
+	const Char* pKeywordEnd= scanKeyword(p, pEnd, "nan");
+	if (NULL != pKeywordEnd)
+	{
+		*pValue= std::numeric_limits<GLfloat>::quiet_NaN();
+		return pKeywordEnd;
+	}
+
+	pKeywordEnd= scanKeyword(p, pEnd, "infinity");
+	if (NULL == pKeywordEnd) pKeywordEnd= scanKeyword(p, pEnd, "inf");
+	if (NULL != pKeywordEnd)
+	{
+		*pValue= negative ? -std::numeric_limits<GLfloat>::infinity() : std::numeric_limits<GLfloat>::infinity();
+	}
+	return pKeywordEnd;
+}
+
+template <typename Char>
+static const Char* scanFloat(const Char* p, const Char* pEnd, GLfloat* pValue)
+{
+	bool negative= false;
+	if ((p != pEnd) && (('-' == charCode(*p)) || ('+' == charCode(*p))))
+	{
+		negative= ('-' == charCode(*p));
+		++p;
+	}
+
+	const Char* pNumber= p;
+	quint64 mantissa= 0;
+	int exponent= 0;
+	bool hasDigit= false;
+
+	// Integer part
+	while (p != pEnd)
+	{
+		const uint digit= static_cast<uint>(charCode(*p)) - '0';
+		if (digit > 9) break;
+		hasDigit= true;
+		if (mantissa < mantissaLimit) mantissa= mantissa * 10 + digit;
+		else ++exponent;
+		++p;
+	}
+
+	// Decimal part
+	if ((p != pEnd) && ('.' == charCode(*p)))
+	{
+		++p;
+		while (p != pEnd)
+		{
+			const uint digit= static_cast<uint>(charCode(*p)) - '0';
+			if (digit > 9) break;
+			hasDigit= true;
+			if (mantissa < mantissaLimit)
+			{
+				mantissa= mantissa * 10 + digit;
+				--exponent;
+			}
+			++p;
+		}
+	}
+	if (!hasDigit)
+	{
+		// The not a number and infinity written by formatFloat() have no digit
+		return (pNumber == p) ? scanNonFiniteFloat(p, pEnd, negative, pValue) : NULL;
+	}
+
+	// Exponent part, only consumed if it contains digits
+	if ((p != pEnd) && (('e' == charCode(*p)) || ('E' == charCode(*p))))
+	{
+		const Char* pExponent= p + 1;
+		bool negativeExponent= false;
+		if ((pExponent != pEnd) && (('-' == charCode(*pExponent)) || ('+' == charCode(*pExponent))))
+		{
+			negativeExponent= ('-' == charCode(*pExponent));
+			++pExponent;
+		}
+		int exponentValue= 0;
+		bool hasExponentDigit= false;
+		while (pExponent != pEnd)
+		{
+			const uint digit= static_cast<uint>(charCode(*pExponent)) - '0';
+			if (digit > 9) break;
+			hasExponentDigit= true;
+			if (exponentValue < 10000) exponentValue= exponentValue * 10 + static_cast<int>(digit);
+			++pExponent;
+		}
+		if (hasExponentDigit)
+		{
+			exponent+= negativeExponent ? -exponentValue : exponentValue;
+			p= pExponent;
+		}
+	}
+
+	double value= static_cast<double>(mantissa);
+	if (0 != mantissa)
+	{
+		if (exponent < 0) value/= powerOfTen(-exponent);
+		else if (exponent > 0) value*= powerOfTen(exponent);
+	}
+	*pValue= static_cast<GLfloat>(negative ? -value : value);
+
+	return p;
+}
+
+template <typename Char>
+static const Char* scanUInt(const Char* p, const Char* pEnd, GLuint* pValue)
+{
+	if ((p != pEnd) && ('+' == charCode(*p))) ++p;
+
+	quint64 value= 0;
+	bool hasDigit= false;
+	while (p != pEnd)
+	{
+		const uint digit= static_cast<uint>(charCode(*p)) - '0';
+		if (digit > 9) break;
+		hasDigit= true;
+		value= value * 10 + digit;
+		if (value > Q_UINT64_C(0xFFFFFFFF)) return NULL;
+		++p;
+	}
+	if (!hasDigit) return NULL;
+
+	*pValue= static_cast<GLuint>(value);
+	return p;
+}
+
+// Return the number of numbers of the given characters
+template <typename Char>
+static int countNumbers(const Char* p, const Char* pEnd)
+{
+	int count= 0;
+	bool previousIsSeparator= true;
+	while (p != pEnd)
+	{
+		const bool isSeparator= glc::isNumericSeparator(charCode(*p));
+		if (previousIsSeparator && !isSeparator) ++count;
+		previousIsSeparator= isSeparator;
+		++p;
+	}
+	return count;
+}
+
+template <typename Char>
+static bool scanFloatArray(const Char* p, const Char* pEnd, GLfloatVector* pValues)
+{
+	const int offset= pValues->size();
+	pValues->resize(offset + countNumbers(p, pEnd));
+	GLfloat* pTarget= pValues->data() + offset;
+	GLfloat* pTargetBegin= pTarget;
+
+	bool result= true;
+	while (result)
+	{
+		while ((p != pEnd) && glc::isNumericSeparator(charCode(*p))) ++p;
+		if (p == pEnd) break;
+
+		p= scanFloat(p, pEnd, pTarget);
+		result= (NULL != p) && ((p == pEnd) || glc::isNumericSeparator(charCode(*p)));
+		if (result) ++pTarget;
+	}
+	pValues->resize(offset + static_cast<int>(pTarget - pTargetBegin));
+
+	return result;
+}
+
+template <typename Char, typename Index>
+static bool scanIndexArray(const Char* p, const Char* pEnd, Index* pIndex)
+{
+	// Arrays read by chunks grow by append after the first one
+	if (pIndex->isEmpty()) pIndex->reserve(countNumbers(p, pEnd));
+
+	bool result= true;
+	while (result)
+	{
+		while ((p != pEnd) && glc::isNumericSeparator(charCode(*p))) ++p;
+		if (p == pEnd) break;
+
+		GLuint value;
+		p= scanUInt(p, pEnd, &value);
+		result= (NULL != p) && ((p == pEnd) || glc::isNumericSeparator(charCode(*p)));
+		if (result) pIndex->append(value);
+	}
+
+	return result;
+}
+
+const QChar* glc::parseFloat(const QChar* pBegin, const QChar* pEnd, GLfloat* pValue)
+{
+	return scanFloat(pBegin, pEnd, pValue);
+}
+
+const char* glc::parseFloat(const char* pBegin, const char* pEnd, GLfloat* pValue)
+{
+	return scanFloat(pBegin, pEnd, pValue);
+}
+
+const QChar* glc::parseUInt(const QChar* pBegin, const QChar* pEnd, GLuint* pValue)
+{
+	return scanUInt(pBegin, pEnd, pValue);
+}
+
+const char* glc::parseUInt(const char* pBegin, const char* pEnd, GLuint* pValue)
+{
+	return scanUInt(pBegin, pEnd, pValue);
+}
+
+bool glc::parseFloatArray(const QChar* pBegin, const QChar* pEnd, GLfloatVector* pValues)
+{
+	return scanFloatArray(pBegin, pEnd, pValues);
+}
+
+bool glc::parseFloatArray(const char* pBegin, const char* pEnd, GLfloatVector* pValues)
+{
+	return scanFloatArray(pBegin, pEnd, pValues);
+}
+
+bool glc::parseIndexArray(const QChar* pBegin, const QChar* pEnd, IndexList* pIndex)
+{
+	return scanIndexArray(pBegin, pEnd, pIndex);
+}
+
+bool glc::parseIndexArray(const char* pBegin, const char* pEnd, IndexList* pIndex)
+{
+	return scanIndexArray(pBegin, pEnd, pIndex);
+}
+
+bool glc::parseIndexArray(const QChar* pBegin, const QChar* pEnd, GLuintVector* pIndex)
+{
+	return scanIndexArray(pBegin, pEnd, pIndex);
+}
+
+bool glc::parseIndexArray(const char* pBegin, const char* pEnd, GLuintVector* pIndex)
+{
+	return scanIndexArray(pBegin, pEnd, pIndex);
+}
+
+int glc::formatFloat(GLfloat value, char* pBuffer)
+{
+	char* p= pBuffer;
+	if (qIsNaN(value))
+	{
+		memcpy(p, "nan", 3);
+		return 3;
+	}
+	if ((value < 0.0f) || ((0.0f == value) && (1.0f / value < 0.0f)))
+	{
+		*p++= '-';
+		value= -value;
+	}
+	if (qIsInf(value))
+	{
+		memcpy(p, "inf", 3);
+		return static_cast<int>(p - pBuffer) + 3;
+	}
+	if (0.0f == value)
+	{
+		*p++= '0';
+		return static_cast<int>(p - pBuffer);
+	}
+
+	// Find the fewest significant digits read back to the same float by the parsing functions
+	const double doubleValue= value;
+	int exponent= static_cast<int>(floor(log10(doubleValue)));
+	int precision= minimumFloatDigits;
+	int adjustmentCount= 0;
+	quint64 digits= 0;
+	while (true)
+	{
+		const int scale= precision - 1 - exponent;
+		const double scaled= (scale >= 0) ? doubleValue * powerOfTen(scale) : doubleValue / powerOfTen(-scale);
+		digits= static_cast<quint64>(scaled + 0.5);
+
+		// The exponent given by log10 can be wrong by one near the powers of ten
+		if ((adjustmentCount < 2) && (digits >= integerPowerOfTen[precision]))
+		{
+			++exponent;
+			++adjustmentCount;
+			continue;
+		}
+		if ((adjustmentCount < 2) && (digits < integerPowerOfTen[precision - 1]))
+		{
+			--exponent;
+			++adjustmentCount;
+			continue;
+		}
+
+		const double readValue= (scale >= 0) ? digits / powerOfTen(scale) : digits * powerOfTen(-scale);
+		if ((static_cast<GLfloat>(readValue) == value) || (maximumFloatDigits == precision)) break;
+		++precision;
+	}
+
+	// Remove the trailing zeros
+	int digitCount= precision;
+	while ((digitCount > 1) && (0 == (digits % 10)))
+	{
+		digits/= 10;
+		--digitCount;
+	}
+	char text[maximumFloatDigits];
+	for (int i= digitCount - 1; i >= 0; --i)
+	{
+		text[i]= static_cast<char>('0' + (digits % 10));
+		digits/= 10;
+	}
+
+	// Same notation as the printf g conversion with the found precision
+	if ((exponent < -4) || (exponent >= precision))
+	{
+		*p++= text[0];
+		if (digitCount > 1)
+		{
+			*p++= '.';
+			memcpy(p, text + 1, digitCount - 1);
+			p+= digitCount - 1;
+		}
+		*p++= 'e';
+		*p++= (exponent < 0) ? '-' : '+';
+		const int absoluteExponent= qAbs(exponent);
+		*p++= static_cast<char>('0' + absoluteExponent / 10);
+		*p++= static_cast<char>('0' + absoluteExponent % 10);
+	}
+	else if (exponent >= 0)
+	{
+		for (int i= 0; i <= exponent; ++i)
+		{
+			*p++= (i < digitCount) ? text[i] : '0';
+		}
+		if (digitCount > (exponent + 1))
+		{
+			*p++= '.';
+			memcpy(p, text + exponent + 1, digitCount - exponent - 1);
+			p+= digitCount - exponent - 1;
+		}
+	}
+	else
+	{
+		*p++= '0';
+		*p++= '.';
+		for (int i= -1; i > exponent; --i)
+		{
+			*p++= '0';
+		}
+		memcpy(p, text, digitCount);
+		p+= digitCount;
+	}
+
+	return static_cast<int>(p - pBuffer);
+}
+
+int glc::formatUInt(GLuint value, char* pBuffer)
+{
+	char text[10];
+	int count= 0;
+	do
+	{
+		text[count++]= static_cast<char>('0' + (value % 10));
+		value/= 10;
+	}
+	while (0 != value);
+
+	for (int i= 0; i < count; ++i)
+	{
+		pBuffer[i]= text[count - 1 - i];
+	}
+	return count;
+}
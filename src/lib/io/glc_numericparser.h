@@ -0,0 +1,112 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+
+//! \file glc_numericparser.h interface for the numeric text parsing functions.
+
+#ifndef GLC_NUMERICPARSER_H_
+#define GLC_NUMERICPARSER_H_
+
+#include <QChar>
+
+#include "../glc_global.h"
+
+#include "../glc_config.h"
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Numeric parsing functions
+ *  Numbers are parsed in place from UTF-16 or 8 bits characters without
+ *  temporary strings. Numbers of an array are separated by white spaces or comma.
+ *  Floats can also be nan, inf or infinity, with any case and an optional sign.*/
+//@{
+//////////////////////////////////////////////////////////////////////
+namespace glc
+{
+	//! Return true if the given character code is a numeric array separator
+	inline bool isNumericSeparator(ushort c)
+	{return (' ' == c) || (',' == c) || ('\n' == c) || ('\r' == c) || ('\t' == c);}
+
+	//! Parse a float from the given characters and return a pointer after it
+	/*! Return NULL if the characters don't begin with a float*/
+	GLC_LIB_EXPORT const QChar* parseFloat(const QChar* pBegin, const QChar* pEnd, GLfloat* pValue);
+
+	//! Parse a float from the given characters and return a pointer after it
+	/*! Return NULL if the characters don't begin with a float*/
+	GLC_LIB_EXPORT const char* parseFloat(const char* pBegin, const char* pEnd, GLfloat* pValue);
+
+	//! Parse an unsigned integer from the given characters and return a pointer after it
+	/*! Return NULL if the characters don't begin with an unsigned integer*/
+	GLC_LIB_EXPORT const QChar* parseUInt(const QChar* pBegin, const QChar* pEnd, GLuint* pValue);
+
+	//! Parse an unsigned integer from the given characters and return a pointer after it
+	/*! Return NULL if the characters don't begin with an unsigned integer*/
+	GLC_LIB_EXPORT const char* parseUInt(const char* pBegin, const char* pEnd, GLuint* pValue);
+
+	//! Append the floats of the given characters to the given vector
+	/*! Return false if a number is not valid*/
+	GLC_LIB_EXPORT bool parseFloatArray(const QChar* pBegin, const QChar* pEnd, GLfloatVector* pValues);
+
+	//! Append the floats of the given characters to the given vector
+	/*! Return false if a number is not valid*/
+	GLC_LIB_EXPORT bool parseFloatArray(const char* pBegin, const char* pEnd, GLfloatVector* pValues);
+
+	//! Append the unsigned integers of the given characters to the given index list
+	/*! Return false if a number is not valid*/
+	GLC_LIB_EXPORT bool parseIndexArray(const QChar* pBegin, const QChar* pEnd, IndexList* pIndex);
+
+	//! Append the unsigned integers of the given characters to the given index list
+	/*! Return false if a number is not valid*/
+	GLC_LIB_EXPORT bool parseIndexArray(const char* pBegin, const char* pEnd, IndexList* pIndex);
+
+	//! Append the unsigned integers of the given characters to the given index vector
+	/*! Return false if a number is not valid*/
+	GLC_LIB_EXPORT bool parseIndexArray(const QChar* pBegin, const QChar* pEnd, GLuintVector* pIndex);
+
+	//! Append the unsigned integers of the given characters to the given index vector
+	/*! Return false if a number is not valid*/
+	GLC_LIB_EXPORT bool parseIndexArray(const char* pBegin, const char* pEnd, GLuintVector* pIndex);
+}
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Numeric formatting functions
+ *  Numbers are written in place in 8 bits characters buffers, without terminating
+ *  null character, and are read back to the same value by the parsing functions.*/
+//@{
+//////////////////////////////////////////////////////////////////////
+namespace glc
+{
+	//! The size of a buffer large enough for any formatted number
+	const int numericTextMaxLength= 16;
+
+	//! Write the shortest text of the given float which is parsed back to the same float
+	/*! The not a number is written nan and the infinities inf and -inf, they are
+	 *  parsed back to a not a number and to the same infinities.
+	 *  Return the number of written characters*/
+	GLC_LIB_EXPORT int formatFloat(GLfloat value, char* pBuffer);
+
+	//! Write the text of the given unsigned integer
+	/*! Return the number of written characters*/
+	GLC_LIB_EXPORT int formatUInt(GLuint value, char* pBuffer);
+}
+//@}
+
+#endif /* GLC_NUMERICPARSER_H_ */
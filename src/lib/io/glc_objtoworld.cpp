@@ -28,6 +28,7 @@
 #include "glc_objtoworld.h"
 #include "../sceneGraph/glc_world.h"
 #include "glc_objmtlloader.h"
+#include "glc_numericparser.h"
 #include "../glc_fileformatexception.h"
 #include "../maths/glc_geomtools.h"
 #include "../sceneGraph/glc_structreference.h"
@@ -36,6 +37,80 @@
 #include <QTextStream>
 #include <QFileInfo>
 
+#include <string.h>
+
+// Return true if the given character is a blank
+static inline bool isBlank(char c)
+{
+	return (' ' == c) || ('\t' == c) || ('\r' == c);
+}
+
+// Return a pointer to the first non blank character
+static inline const char* skipBlank(const char* p, const char* pEnd)
+{
+	while ((p != pEnd) && isBlank(*p)) ++p;
+	return p;
+}
+
+// Return true if the given characters are equal to the given keyword
+static inline bool isKeyword(const char* p, const char* pEnd, const char* keyword)
+{
+	while ((p != pEnd) && ('\0' != *keyword) && (*p == *keyword))
+	{
+		++p;
+		++keyword;
+	}
+	return (p == pEnd) && ('\0' == *keyword);
+}
+
+// Return the end of the line which begin at the given position and set the beginning of the next line
+static inline const char* lineEnd(const char* p, const char* pEnd, const char** ppNextLine)
+{
+	const char* pEndOfLine= static_cast<const char*>(memchr(p, '\n', pEnd - p));
+	if (NULL == pEndOfLine)
+	{
+		*ppNextLine= pEnd;
+		return pEnd;
+	}
+	*ppNextLine= pEndOfLine + 1;
+	return pEndOfLine;
+}
+
+// Parse an OBJ index which can be negative and return a pointer after it
+static inline const char* parseObjIndex(const char* p, const char* pEnd, int* pValue)
+{
+	bool negative= false;
+	if ((p != pEnd) && ('-' == *p))
+	{
+		negative= true;
+		++p;
+	}
+	GLuint value= 0;
+	p= glc::parseUInt(p, pEnd, &value);
+	if (NULL != p)
+	{
+		*pValue= negative ? -static_cast<int>(value) : static_cast<int>(value);
+	}
+	return p;
+}
+
+// Return the zero based index of the given OBJ index, relative indexes start from the given count
+static inline int absoluteObjIndex(int objIndex, int count)
+{
+	if (objIndex < 0) return count + objIndex;
+	else return objIndex - 1;
+}
+
+// Append the values of the given element of the source bulk to the target bulk, or zeros if the element doesn't exist
+static inline void appendBulkValues(const GLfloatVector& source, int index, int size, GLfloatVector* pTarget)
+{
+	const bool exist= (index >= 0) && (((index + 1) * size) <= source.size());
+	for (int i= 0; i < size; ++i)
+	{
+		pTarget->append(exist ? source.at(index * size + i) : 0.0f);
+	}
+}
+
 //////////////////////////////////////////////////////////////////////
 // Constructor
 //////////////////////////////////////////////////////////////////////
@@ -52,13 +127,7 @@ GLC_ObjToWorld::GLC_ObjToWorld()
 , m_Positions()
 , m_Normals()
 , m_Texels()
-, m_VerticeIndex(0)
-, m_NormalIndex(0)
-, m_TextureIndex(0)
-, m_VerticeOffset(0)
-, m_NormalOffset(0)
-, m_TextureOffset(0)
-, m_ResetIndex(false)
+, m_MtlLibSearched(false)
 {
 }
 
@@ -95,104 +164,99 @@ GLC_World* GLC_ObjToWorld::CreateWorldFromObj(QFile &file)
 	// Create Working variables
 	int currentQuantumValue= 0;
 	int previousQuantumValue= 0;
-	int numberOfLine= 0;
-
-	// Create the input file stream
-	QTextStream objStream(&file);
-
-	// QString buffer
-	QString lineBuff;
-
-	QString mtlLibLine;
 
 	//////////////////////////////////////////////////////////////////
-	// Searching mtllib attribute
+	// Map the whole file, or read it if the file engine doesn't support mapping
 	//////////////////////////////////////////////////////////////////
-	while (!objStream.atEnd() && !lineBuff.contains("mtllib"))
+	const qint64 fileSize= file.size();
+	QByteArray fileContent;
+	uchar* pMappedData= (fileSize > 0) ? file.map(0, fileSize) : NULL;
+	const char* pData= reinterpret_cast<const char*>(pMappedData);
+	qint64 dataSize= fileSize;
+	if (NULL == pData)
 	{
-		++numberOfLine;
-		lineBuff= objStream.readLine();
-		if (lineBuff.contains("mtllib")) mtlLibLine= lineBuff;
+		fileContent= file.readAll();
+		pData= fileContent.constData();
+		dataSize= fileContent.size();
 	}
+	const char* const pDataEnd= pData + dataSize;
 
 	//////////////////////////////////////////////////////////////////
-	// Count the number of lines of the OBJ file
+	// If mtl file with the same name than the OBJ file is found, load it
+	// Otherwise the mtllib record is used
 	//////////////////////////////////////////////////////////////////
-	while (!objStream.atEnd())
-	{
-		++numberOfLine;
-		objStream.readLine();
-	}
-
-	//////////////////////////////////////////////////////////////////
-	// Reset the stream
-	//////////////////////////////////////////////////////////////////
-	objStream.resetStatus();
-	objStream.seek(0);
-
-	//////////////////////////////////////////////////////////////////
-	// if mtl file found, load it
-	//////////////////////////////////////////////////////////////////
-	QString mtlLibFileName(getMtlLibFileName(mtlLibLine));
+	const QString mtlLibFileName(getMtlLibFileName(QString()));
 	if (!mtlLibFileName.isEmpty())
 	{
-		m_pMtlLoader= new GLC_ObjMtlLoader(mtlLibFileName);
-		if (!m_pMtlLoader->loadMaterials())
-		{
-			delete m_pMtlLoader;
-			m_pMtlLoader= NULL;
-			if (!mtlLibLine.isEmpty())
-			{
-				QStringList stringList(m_FileName);
-				stringList.append("Open Material File : " + mtlLibFileName + " failed");
-				GLC_ErrorLog::addError(stringList);
-			}
-		}
-		else
-		{
-			// Update Attached file name list
-			m_ListOfAttachedFileName << mtlLibFileName;
-			m_ListOfAttachedFileName << m_pMtlLoader->listOfAttachedFileName();
-		}
-	}
-	else
-	{
-		//qDebug() << "GLC_ObjToWorld::CreateWorldFromObj: mtl file not found";
+		loadMtlLib(mtlLibFileName, false);
 	}
+	m_MtlLibSearched= (NULL != m_pMtlLoader);
 
 	//////////////////////////////////////////////////////////////////
 	// Read Buffer and create the world
 	//////////////////////////////////////////////////////////////////
 	emit currentQuantum(currentQuantumValue);
 	m_CurrentLineNumber= 0;
-    m_VerticeIndex= 0;
-    m_NormalIndex= 0;
-    m_TextureIndex= 0;
 
-    m_VerticeOffset= 0;
-    m_NormalOffset= 0;
-    m_TextureOffset= 0;
-
-	while (!objStream.atEnd())
+	try
 	{
-		++m_CurrentLineNumber;
-		lineBuff= objStream.readLine();
+		QByteArray mergedLine;
+		const char* pLine= pData;
+		while (pLine != pDataEnd)
+		{
+			++m_CurrentLineNumber;
+			const char* pNextLine= NULL;
+			const char* pLineEnd= lineEnd(pLine, pDataEnd, &pNextLine);
+			if ((pLineEnd != pLine) && ('\r' == *(pLineEnd - 1))) --pLineEnd;
 
-		mergeLines(&lineBuff, &objStream);
+			if ((pLineEnd != pLine) && ('\\' == *(pLineEnd - 1)))
+			{
+				// Merge Mutli line in one
+				mergedLine= QByteArray(pLine, static_cast<int>(pLineEnd - pLine - 1));
+				bool continued= true;
+				while (continued && (pNextLine != pDataEnd))
+				{
+					++m_CurrentLineNumber;
+					pLine= pNextLine;
+					pLineEnd= lineEnd(pLine, pDataEnd, &pNextLine);
+					if ((pLineEnd != pLine) && ('\r' == *(pLineEnd - 1))) --pLineEnd;
+					continued= (pLineEnd != pLine) && ('\\' == *(pLineEnd - 1));
+					mergedLine.append(' ');
+					mergedLine.append(pLine, static_cast<int>(pLineEnd - pLine - (continued ? 1 : 0)));
+				}
+				scanLine(mergedLine.constData(), mergedLine.constData() + mergedLine.size());
+			}
+			else
+			{
+				scanLine(pLine, pLineEnd);
+			}
+			pLine= pNextLine;
 
-		scanLigne(lineBuff);
-		currentQuantumValue = static_cast<int>((static_cast<double>(m_CurrentLineNumber) / numberOfLine) * 100);
-		if (currentQuantumValue > previousQuantumValue)
-		{
-			emit currentQuantum(currentQuantumValue);
+			currentQuantumValue = static_cast<int>((static_cast<double>(pLine - pData) / dataSize) * 100);
+			if (currentQuantumValue > previousQuantumValue)
+			{
+				emit currentQuantum(currentQuantumValue);
+			}
+			previousQuantumValue= currentQuantumValue;
 		}
-		previousQuantumValue= currentQuantumValue;
-
 	}
+	catch (GLC_FileFormatException&)
+	{
+		if (NULL != pMappedData) file.unmap(pMappedData);
+		file.close();
+		throw;
+	}
+
+	if (NULL != pMappedData) file.unmap(pMappedData);
 	file.close();
 
 	addCurrentObjMeshToWorld();
 
+	// The bulk data are not needed anymore
+	m_Positions.clear();
+	m_Normals.clear();
+	m_Texels.clear();
+
 	//! Test if there is meshes in the world
 	if (m_pWorld->rootOccurrence()->childCount() == 0)
 	{
@@ -241,77 +305,99 @@ QString GLC_ObjToWorld::getMtlLibFileName(QString line)
 	return mtlFileName;
 }
 
+// Load the given mtl file
+void GLC_ObjToWorld::loadMtlLib(const QString& mtlLibFileName, bool reportError)
+{
+	m_pMtlLoader= new GLC_ObjMtlLoader(mtlLibFileName);
+	if (!m_pMtlLoader->loadMaterials())
+	{
+		delete m_pMtlLoader;
+		m_pMtlLoader= NULL;
+		if (reportError)
+		{
+			QStringList stringList(m_FileName);
+			stringList.append("Open Material File : " + mtlLibFileName + " failed");
+			GLC_ErrorLog::addError(stringList);
+		}
+	}
+	else
+	{
+		// Update Attached file name list
+		m_ListOfAttachedFileName << mtlLibFileName;
+		m_ListOfAttachedFileName << m_pMtlLoader->listOfAttachedFileName();
+	}
+}
+
 // Scan a line previously extracted from OBJ file
-void GLC_ObjToWorld::scanLigne(QString &line)
+void GLC_ObjToWorld::scanLine(const char* pBegin, const char* pEnd)
 {
-	line= line.trimmed();
+	// Trim the line
+	const char* p= skipBlank(pBegin, pEnd);
+	while ((pEnd != p) && isBlank(*(pEnd - 1))) --pEnd;
+	if ((p == pEnd) || ('#' == *p)) return;
+
+	// Split the keyword and the arguments
+	const char* pKeywordEnd= p;
+	while ((pKeywordEnd != pEnd) && !isBlank(*pKeywordEnd)) ++pKeywordEnd;
+	const char* pArgument= skipBlank(pKeywordEnd, pEnd);
+
 	// Search Vertexs vectors
-	if (line.startsWith("v ")|| line.startsWith(QString("v") + QString(QChar(9))))
-	{
-        if (m_ResetIndex)
-        {
-            m_VerticeOffset+= m_VerticeIndex;
-            m_NormalOffset+= m_NormalIndex;
-            m_TextureOffset+= m_TextureIndex;
-
-            m_VerticeIndex= 0;
-            m_TextureIndex= 0;
-            m_NormalIndex= 0;
-            m_ResetIndex= false;
-        }
-		line.remove(0,2); // Remove first 2 char
-		m_Positions.append(extract3dVect(line));
+	if (isKeyword(p, pKeywordEnd, "v"))
+	{
+		extractVector(pArgument, pEnd, 3, &m_Positions);
 		m_FaceType = notSet;
-        ++m_VerticeIndex;
 	}
 
 	// Search texture coordinate vectors
-	else if (line.startsWith("vt ")|| line.startsWith(QString("vt") + QString(QChar(9))))
+	else if (isKeyword(p, pKeywordEnd, "vt"))
 	{
-		line.remove(0,3); // Remove first 3 char
-		m_Texels.append(extract2dVect(line));
+		extractVector(pArgument, pEnd, 2, &m_Texels);
 		m_FaceType = notSet;
-        ++m_TextureIndex;
 	}
 
 	// Search normals vectors
-	else if (line.startsWith("vn ") || line.startsWith(QString("vn") + QString(QChar(9))))
+	else if (isKeyword(p, pKeywordEnd, "vn"))
 	{
-		line.remove(0,3); // Remove first 3 char
-		m_Normals.append(extract3dVect(line));
+		extractVector(pArgument, pEnd, 3, &m_Normals);
 		m_FaceType = notSet;
-        ++m_NormalIndex;
 	}
 
 	// Search faces to update index
-	else if (line.startsWith("f ") || line.startsWith(QString("f") + QString(QChar(9))))
+	else if (isKeyword(p, pKeywordEnd, "f"))
 	{
-        m_ResetIndex= true;
 		// If there is no group or object in the OBJ file
 		if (NULL == m_pCurrentObjMesh)
-			{
-				changeGroup("GLC_Default");
-				//qDebug() << "Default group " << line;
-			}
-		line.remove(0,2); // Remove first 2 char
-		extractFaceIndex(line);
+		{
+			changeGroup("GLC_Default");
+		}
+		extractFaceIndex(pArgument, pEnd);
 	}
 
 	// Search Material
-	else if (line.startsWith("usemtl ") || line.startsWith(QString("usemtl") + QString(QChar(9))))
+	else if (isKeyword(p, pKeywordEnd, "usemtl") && (pArgument != pEnd))
 	{
-		line.remove(0,7); // Remove first 7 char
-		setCurrentMaterial(line);
+		const char* pNameEnd= pArgument;
+		while ((pNameEnd != pEnd) && !isBlank(*pNameEnd)) ++pNameEnd;
+		setCurrentMaterial(QString::fromLocal8Bit(pArgument, static_cast<int>(pNameEnd - pArgument)));
 		m_FaceType = notSet;
 	}
 
 	// Search Group
-	else if (line.startsWith("g ") || line.startsWith("o ") || line.startsWith(QString("g") + QString(QChar(9)))
-			|| line.startsWith(QString("o") + QString(QChar(9))))
+	else if ((isKeyword(p, pKeywordEnd, "g") || isKeyword(p, pKeywordEnd, "o")) && (pArgument != pEnd))
 	{
 		m_FaceType = notSet;
-		line.remove(0,2); // Remove first 2 char
-		changeGroup(line);
+		changeGroup(QString::fromLocal8Bit(pArgument, static_cast<int>(pEnd - pArgument)));
+	}
+
+	// Search material library
+	else if (isKeyword(p, pKeywordEnd, "mtllib") && !m_MtlLibSearched)
+	{
+		m_MtlLibSearched= true;
+		const QString mtlLibFileName(getMtlLibFileName(QString::fromLocal8Bit(p, static_cast<int>(pEnd - p))));
+		if (!mtlLibFileName.isEmpty())
+		{
+			loadMtlLib(mtlLibFileName, true);
+		}
 	}
 
 }
@@ -356,141 +442,50 @@ void GLC_ObjToWorld::changeGroup(QString line)
 
 }
 
-// Extract a Vector from a string
-QList<float> GLC_ObjToWorld::extract3dVect(QString &line)
+// Append a vector of the given size extracted from the given characters to the given bulk
+void GLC_ObjToWorld::extractVector(const char* p, const char* pEnd, int size, GLfloatVector* pBulk)
 {
-	float x=0.0f;
-	float y=0.0f;
-	float z=0.0f;
-
-	QList<float> vectResult;
-	QTextStream stringVecteur(&line);
-
-	QString xString, yString, zString;
-
-	if (((stringVecteur >> xString >> yString >> zString).status() == QTextStream::Ok))
+	Q_ASSERT(size <= 3);
+	GLfloat values[3]= {0.0f, 0.0f, 0.0f};
+	bool converted= true;
+	for (int i= 0; converted && (i < size); ++i)
 	{
-		bool xOk, yOk, zOk;
-		x= xString.toFloat(&xOk);
-		y= yString.toFloat(&yOk);
-		z= zString.toFloat(&zOk);
-		if (!(xOk && yOk && zOk))
-		{
-			QString message= "GLC_ObjToWorld::extract3dVect " + m_FileName + " failed to convert vector component to float";
-			message.append("\nAt ligne : ");
-			message.append(QString::number(m_CurrentLineNumber));
-			QStringList stringList(m_FileName);
-			stringList.append(message);
-			GLC_ErrorLog::addError(stringList);
-
-			//GLC_FileFormatException fileFormatException(message, m_FileName);
-			//clear();
-			//throw(fileFormatException);
-		}
-		else
-		{
-			vectResult << x << y << z;
-		}
+		p= glc::parseFloat(skipBlank(p, pEnd), pEnd, &values[i]);
+		converted= (NULL != p) && ((p == pEnd) || isBlank(*p));
 	}
 
-	return vectResult;
-
-}
-
-// Extract a Vector from a string
-QList<float> GLC_ObjToWorld::extract2dVect(QString &line)
-{
-	float x=0.0f;
-	float y=0.0f;
-	QList<float> vectResult;
-	QTextStream stringVecteur(&line);
+	if (!converted)
+	{
+		QString message= "GLC_ObjToWorld::extractVector " + m_FileName + " failed to convert vector component to float";
+		message.append("\nAt ligne : ");
+		message.append(QString::number(m_CurrentLineNumber));
+		QStringList stringList(m_FileName);
+		stringList.append(message);
+		GLC_ErrorLog::addError(stringList);
 
-	QString xString, yString;
+		// A null vector is added in order to keep the following index valid
+		values[0]= values[1]= values[2]= 0.0f;
+	}
 
-	if (((stringVecteur >> xString >> yString).status() == QTextStream::Ok))
+	for (int i= 0; i < size; ++i)
 	{
-		bool xOk, yOk;
-		x= xString.toFloat(&xOk);
-		y= yString.toFloat(&yOk);
-		if (!(xOk && yOk))
-		{
-			QString message= "GLC_ObjToWorld::extract2dVect " + m_FileName + " failed to convert vector component to double";
-			message.append("\nAt ligne : ");
-			message.append(QString::number(m_CurrentLineNumber));
-			GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
-			clear();
-			throw(fileFormatException);
-		}
-		vectResult << x << y;
+		pBulk->append(values[i]);
 	}
-
-	return vectResult;
 }
 
-// Extract a face from a string
-void GLC_ObjToWorld::extractFaceIndex(QString &line)
+// Extract a face from the given characters
+void GLC_ObjToWorld::extractFaceIndex(const char* p, const char* pEnd)
 {
-	QString buff;
-
-	int coordinateIndex;
-	int normalIndex;
-	int textureCoordinateIndex;
-
-	QList<GLuint> currentFaceIndex;
+	ObjVertice currentVertice;
+	IndexList currentFaceIndex;
 	//////////////////////////////////////////////////////////////////
-	// Parse the line containing face index
+	// Parse the characters containing face index
 	//////////////////////////////////////////////////////////////////
-	QTextStream streamFace(&line);
-	while ((!streamFace.atEnd()))
+	p= skipBlank(p, pEnd);
+	while (p != pEnd)
 	{
-		streamFace >> buff;
-		extractVertexIndex(buff, coordinateIndex, normalIndex, textureCoordinateIndex);
-
-		ObjVertice currentVertice(coordinateIndex, normalIndex, textureCoordinateIndex);
-		if (m_pCurrentObjMesh->m_ObjVerticeIndexMap.contains(currentVertice))
-		{
-			currentFaceIndex.append(m_pCurrentObjMesh->m_ObjVerticeIndexMap.value(currentVertice));
-		}
-		else
-		{
-			// Add Vertex to the mesh bulk data
-			m_pCurrentObjMesh->m_Positions.append(m_Positions.value(coordinateIndex * 3));
-			m_pCurrentObjMesh->m_Positions.append(m_Positions.value(coordinateIndex * 3 + 1));
-			m_pCurrentObjMesh->m_Positions.append(m_Positions.value(coordinateIndex * 3 + 2));
-			if (-1 != normalIndex)
-			{
-				// Add Normal to the mesh bulk data
-				m_pCurrentObjMesh->m_Normals.append(m_Normals.value(normalIndex * 3));
-				m_pCurrentObjMesh->m_Normals.append(m_Normals.value(normalIndex * 3 + 1));
-				m_pCurrentObjMesh->m_Normals.append(m_Normals.value(normalIndex * 3 + 2));
-			}
-			else
-			{
-				// Add Null Normal to the mesh bulk data
-				m_pCurrentObjMesh->m_Normals.append(0.0f);
-				m_pCurrentObjMesh->m_Normals.append(0.0f);
-				m_pCurrentObjMesh->m_Normals.append(0.0f);
-			}
-			if (-1 != textureCoordinateIndex)
-			{
-				// Add texture coordinate to the mesh bulk data
-				m_pCurrentObjMesh->m_Texels.append(m_Texels.value(textureCoordinateIndex * 2));
-				m_pCurrentObjMesh->m_Texels.append(m_Texels.value(textureCoordinateIndex * 2 + 1));
-			}
-			else if (!m_pCurrentObjMesh->m_Texels.isEmpty())
-			{
-				// Add epmty texture coordinate
-				m_pCurrentObjMesh->m_Texels.append(0.0f);
-				m_pCurrentObjMesh->m_Texels.append(0.0f);
-			}
-			// Add the index to current face index
-			currentFaceIndex.append(m_pCurrentObjMesh->m_NextFreeIndex);
-			// Add ObjVertice to ObjVertice Map
-			m_pCurrentObjMesh->m_ObjVerticeIndexMap.insert(currentVertice, m_pCurrentObjMesh->m_NextFreeIndex);
-			// Increment next free index
-			++(m_pCurrentObjMesh->m_NextFreeIndex);
-		}
-
+		p= skipBlank(extractVertexIndex(p, pEnd, &currentVertice), pEnd);
+		currentFaceIndex.append(objVerticeIndex(currentVertice));
 	}
 	//////////////////////////////////////////////////////////////////
 	// Check the number of face's vertex
@@ -506,64 +501,35 @@ void GLC_ObjToWorld::extractFaceIndex(QString &line)
 	//////////////////////////////////////////////////////////////////
 	// Add the face to the current mesh
 	//////////////////////////////////////////////////////////////////
-	if ((m_FaceType == coordinateAndNormal) || (m_FaceType == coordinateAndTextureAndNormal))
+	if (size > 3)
 	{
-		if (size > 3)
-		{
-			glc::triangulatePolygon(&currentFaceIndex, m_pCurrentObjMesh->m_Positions);
-		}
-		m_pCurrentObjMesh->m_Index.append(currentFaceIndex);
+		triangulateFace(&currentFaceIndex);
+		if (currentFaceIndex.size() < 3) return;
 	}
-	else if (m_FaceType != notSet)
+
+	if ((m_FaceType != coordinateAndNormal) && (m_FaceType != coordinateAndTextureAndNormal))
 	{
-		if (size > 3)
-		{
-			glc::triangulatePolygon(&currentFaceIndex, m_pCurrentObjMesh->m_Positions);
-		}
 		// Comput the face normal
-		if (currentFaceIndex.size() < 3) return;
 		GLC_Vector3df normal= computeNormal(currentFaceIndex.at(0), currentFaceIndex.at(1), currentFaceIndex.at(2));
 
 		// Add Face normal to bulk data
-		QSet<GLuint> indexSet= currentFaceIndex.toSet();
-		QSet<GLuint>::iterator iIndexSet= indexSet.begin();
-		while (indexSet.constEnd() != iIndexSet)
+		GLfloat* pNormals= m_pCurrentObjMesh->m_Normals.data();
+		const int faceSize= currentFaceIndex.size();
+		for (int i= 0; i < faceSize; ++i)
 		{
-			m_pCurrentObjMesh->m_Normals[*iIndexSet * 3]= normal.x();
-			m_pCurrentObjMesh->m_Normals[*iIndexSet * 3 + 1]= normal.y();
-			m_pCurrentObjMesh->m_Normals[*iIndexSet * 3 + 2]= normal.z();
-
-			++iIndexSet;
+			const GLuint index= currentFaceIndex.at(i);
+			pNormals[index * 3]= normal.x();
+			pNormals[index * 3 + 1]= normal.y();
+			pNormals[index * 3 + 2]= normal.z();
 		}
-
-		m_pCurrentObjMesh->m_Index.append(currentFaceIndex);
-
-	}
-	else
-	{
-		QString message= "GLC_ObjToWorld::extractFaceIndex " + m_FileName + " unknow face type";
-		message.append("\nAt line : ");
-		message.append(QString::number(m_CurrentLineNumber));
-		GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::FileNotSupported);
-		clear();
-		throw(fileFormatException);
 	}
+
+	m_pCurrentObjMesh->m_Index.append(currentFaceIndex);
 }
+
 //! Set Current material index
-void GLC_ObjToWorld::setCurrentMaterial(QString &line)
+void GLC_ObjToWorld::setCurrentMaterial(const QString& materialName)
 {
-	QTextStream streamString(&line);
-	QString materialName;
-
-	if (!((streamString >> materialName).status() == QTextStream::Ok))
-	{
-		QString message= "GLC_ObjToWorld::SetCurrentMaterial " + m_FileName + " : failed to extract materialName";
-		message.append("\nAt line : ");
-		message.append(QString::number(m_CurrentLineNumber));
-		GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
-		clear();
-		throw(fileFormatException);
-	}
 	//////////////////////////////////////////////////////////////////
 	// Check if the material is already loaded from the current mesh
 	//////////////////////////////////////////////////////////////////
@@ -606,215 +572,141 @@ void GLC_ObjToWorld::setCurrentMaterial(QString &line)
 	}
 
 }
-// Extract a vertex from a string
-void GLC_ObjToWorld::extractVertexIndex(QString line, int &Coordinate, int &Normal, int &TextureCoordinate)
+// Extract a face vertex from the given characters and return a pointer after it
+const char* GLC_ObjToWorld::extractVertexIndex(const char* p, const char* pEnd, ObjVertice* pVertice)
 {
- 	if (m_FaceType == notSet)
- 	{
- 		setObjType(line);
- 	}
-
- 	if (m_FaceType == coordinateAndTextureAndNormal)
- 	{
-		// Replace "/" with " "
-		line.replace('/', ' ');
-		QTextStream streamVertex(&line);
-		QString coordinateString, textureCoordinateString, normalString;
-	 	if ((streamVertex >> coordinateString >> textureCoordinateString >> normalString).status() == QTextStream::Ok)
+	int coordinateIndex= 0;
+	int textureCoordinateIndex= 0;
+	int normalIndex= 0;
+	bool hasTextureCoordinate= false;
+	bool hasNormal= false;
+
+	// ex. 10, 10/56, 10//54 or 10/30/54
+	p= parseObjIndex(p, pEnd, &coordinateIndex);
+	if ((NULL != p) && (p != pEnd) && ('/' == *p))
+	{
+		++p;
+		if ((p != pEnd) && ('/' != *p))
 		{
-			bool coordinateOk, textureCoordinateOk, normalOk;
-			Coordinate= coordinateString.toInt(&coordinateOk);
-			--Coordinate;
-			TextureCoordinate= textureCoordinateString.toInt(&textureCoordinateOk);
-			--TextureCoordinate;
-			Normal= normalString.toInt(&normalOk);
-			--Normal;
-			if (!(coordinateOk && textureCoordinateOk && normalOk))
-			{
-				QString message= "GLC_ObjToWorld::extractVertexIndex " + m_FileName + " failed to convert String to int";
-				message.append("\nAt line : ");
-				message.append(QString::number(m_CurrentLineNumber));
-				GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
-				clear();
-				throw(fileFormatException);
-			}
-            else if (Coordinate < 0)
-            {
-                Coordinate= m_VerticeIndex + m_VerticeOffset + Coordinate + 1;
-                Normal= m_NormalIndex + m_NormalOffset + Normal + 1;
-                TextureCoordinate= m_TextureIndex + m_TextureOffset + TextureCoordinate + 1;
-            }
+			p= parseObjIndex(p, pEnd, &textureCoordinateIndex);
+			hasTextureCoordinate= true;
 		}
-		else
+		if ((NULL != p) && (p != pEnd) && ('/' == *p))
 		{
-			QString message= "GLC_ObjToWorld::extractVertexIndex Obj file " + m_FileName + " type is not supported";
-			message.append("\nAt line : ");
-			message.append(QString::number(m_CurrentLineNumber));
-			GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::FileNotSupported);
-			clear();
-			throw(fileFormatException);
+			p= parseObjIndex(p + 1, pEnd, &normalIndex);
+			hasNormal= true;
 		}
+	}
+	if ((NULL == p) || ((p != pEnd) && !isBlank(*p)))
+	{
+		throwException("GLC_ObjToWorld::extractVertexIndex " + m_FileName + " failed to convert String to int", GLC_FileFormatException::WrongFileFormat);
+	}
 
- 	}
- 	else if (m_FaceType == coordinateAndTexture)
- 	{
-		// Replace "/" with " "
-		line.replace('/', ' ');
-		QTextStream streamVertex(&line);
-		QString coordinateString, textureCoordinateString;
-	 	if ((streamVertex >> coordinateString >> textureCoordinateString).status() == QTextStream::Ok)
-		{
-			bool coordinateOk, textureCoordinateOk;
-			Coordinate= coordinateString.toInt(&coordinateOk);
-			--Coordinate;
-			TextureCoordinate= textureCoordinateString.toInt(&textureCoordinateOk);
-			--TextureCoordinate;
-			Normal= -1;
-			if (!(coordinateOk && textureCoordinateOk))
-			{
-				QString message= "GLC_ObjToWorld::extractVertexIndex " + m_FileName +  "failed to convert String to int";
-				message.append("\nAt line : ");
-				message.append(QString::number(m_CurrentLineNumber));
-				GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
-				clear();
-				throw(fileFormatException);
-			}
-            else if (Coordinate < 0)
-            {
-                Coordinate= m_VerticeIndex + m_VerticeOffset + Coordinate + 1;
-                TextureCoordinate= m_TextureIndex + m_TextureOffset + TextureCoordinate + 1;
-            }
-		}
-		else
-		{
-			QString message= "GLC_ObjToWorld::extractVertexIndex " + m_FileName + " this Obj file type is not supported";
-			message.append("\nAt line : ");
-			message.append(QString::number(m_CurrentLineNumber));
-			GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::FileNotSupported);
-			clear();
-			throw(fileFormatException);
-		}
- 	}
- 	else if (m_FaceType == coordinateAndNormal)
- 	{
-		// Replace "/" with " "
-		line.replace('/', ' ');
-		QTextStream streamVertex(&line);
-		QString coordinateString, normalString;
-	 	if ((streamVertex >> coordinateString >> normalString).status() == QTextStream::Ok)
-		{
-			bool coordinateOk, normalOk;
-			Coordinate= coordinateString.toInt(&coordinateOk);
-			--Coordinate;
-			TextureCoordinate= -1;
-			Normal= normalString.toInt(&normalOk);
-			--Normal;
-			if (!(coordinateOk && normalOk))
-			{
-				QString message= "GLC_ObjToWorld::extractVertexIndex " + m_FileName + " failed to convert String to int";
-				message.append("\nAt line : ");
-				message.append(QString::number(m_CurrentLineNumber));
-				GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
-				clear();
-				throw(fileFormatException);
-			}
-            else if (Coordinate < 0)
-            {
-                Coordinate= m_VerticeIndex + m_VerticeOffset + Coordinate + 1;
-                Normal= m_NormalIndex + m_NormalOffset + Normal + 1;
-            }
+	// Set the OBJ face type
+	FaceType faceType= coordinate;
+	if (hasTextureCoordinate && hasNormal) faceType= coordinateAndTextureAndNormal;
+	else if (hasTextureCoordinate) faceType= coordinateAndTexture;
+	else if (hasNormal) faceType= coordinateAndNormal;
 
-		}
-		else
-		{
-			QString message= "GLC_ObjToWorld::extractVertexIndex " + m_FileName + " this Obj file type is not supported";
-			message.append("\nAt line : ");
-			message.append(QString::number(m_CurrentLineNumber));
-			GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::FileNotSupported);
-			clear();
-			throw(fileFormatException);
-		}
- 	}
-  	else if (m_FaceType == coordinate)
- 	{
- 		QTextStream streamVertex(&line);
- 		QString coordinateString;
-	 	if ((streamVertex >> coordinateString).status() == QTextStream::Ok)
+	if (m_FaceType == notSet)
+	{
+		m_FaceType= faceType;
+	}
+	else if (m_FaceType != faceType)
+	{
+		throwException("GLC_ObjToWorld::extractVertexIndex Obj file " + m_FileName + " type is not supported", GLC_FileFormatException::FileNotSupported);
+	}
+
+	pVertice->m_Values[0]= absoluteObjIndex(coordinateIndex, m_Positions.size() / 3);
+	pVertice->m_Values[1]= hasNormal ? absoluteObjIndex(normalIndex, m_Normals.size() / 3) : -1;
+	pVertice->m_Values[2]= hasTextureCoordinate ? absoluteObjIndex(textureCoordinateIndex, m_Texels.size() / 2) : -1;
+
+	return p;
+}
+
+// Return the index of the given obj vertice in the current mesh, add it if needed
+GLuint GLC_ObjToWorld::objVerticeIndex(const ObjVertice& vertice)
+{
+	CurrentObjMesh* pObjMesh= m_pCurrentObjMesh;
+
+	// Search the vertice in the hash table
+	GLuint mask= static_cast<GLuint>(pObjMesh->m_ObjVerticeSlots.size()) - 1;
+	GLuint slot= qHash(vertice) & mask;
+	while (0 != pObjMesh->m_ObjVerticeSlots.at(slot))
+	{
+		const GLuint index= pObjMesh->m_ObjVerticeSlots.at(slot) - 1;
+		if (pObjMesh->m_ObjVertices.at(index) == vertice) return index;
+		slot= (slot + 1) & mask;
+	}
+
+	// Add the vertice to the hash table
+	const GLuint index= static_cast<GLuint>(pObjMesh->m_NextFreeIndex);
+	pObjMesh->m_ObjVerticeSlots[slot]= index + 1;
+	pObjMesh->m_ObjVertices.append(vertice);
+	++(pObjMesh->m_NextFreeIndex);
+
+	// Add Vertex to the mesh bulk data
+	appendBulkValues(m_Positions, vertice.m_Values[0], 3, &(pObjMesh->m_Positions));
+	// Add Normal or null normal to the mesh bulk data
+	appendBulkValues(m_Normals, vertice.m_Values[1], 3, &(pObjMesh->m_Normals));
+	if (-1 != vertice.m_Values[2])
+	{
+		// Previous vertex without texture coordinate get an empty one
+		while (pObjMesh->m_Texels.size() < static_cast<int>(index * 2))
 		{
-			bool coordinateOk;
-			Coordinate= coordinateString.toInt(&coordinateOk);
-			--Coordinate;
-			TextureCoordinate= -1;
-			Normal= -1;
-			if (!coordinateOk)
-			{
-				QString message= "GLC_ObjToWorld::extractVertexIndex "  + m_FileName + " failed to convert String to int";
-				message.append("\nAt line : ");
-				message.append(QString::number(m_CurrentLineNumber));
-				GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
-				clear();
-				throw(fileFormatException);
-			}
-            else if (Coordinate < 0)
-            {
-                Coordinate= m_VerticeIndex + m_VerticeOffset + Coordinate + 1;
-            }
+			pObjMesh->m_Texels.append(0.0f);
 		}
-		else
+		appendBulkValues(m_Texels, vertice.m_Values[2], 2, &(pObjMesh->m_Texels));
+	}
+	else if (!pObjMesh->m_Texels.isEmpty())
+	{
+		// Add epmty texture coordinate
+		pObjMesh->m_Texels.append(0.0f);
+		pObjMesh->m_Texels.append(0.0f);
+	}
+
+	// Keep the load of the hash table under 3/4
+	const int verticeCount= pObjMesh->m_ObjVertices.size();
+	if ((verticeCount * 4) > (pObjMesh->m_ObjVerticeSlots.size() * 3))
+	{
+		pObjMesh->m_ObjVerticeSlots.fill(0, pObjMesh->m_ObjVerticeSlots.size() * 2);
+		mask= static_cast<GLuint>(pObjMesh->m_ObjVerticeSlots.size()) - 1;
+		GLuint* pSlots= pObjMesh->m_ObjVerticeSlots.data();
+		for (int i= 0; i < verticeCount; ++i)
 		{
-			QString message= "GLC_ObjToWorld::extractVertexIndex Obj " + m_FileName + " file type is not supported";
-			message.append("\nAt line : ");
-			message.append(QString::number(m_CurrentLineNumber));
-			GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::FileNotSupported);
-			clear();
-			throw(fileFormatException);
+			slot= qHash(pObjMesh->m_ObjVertices.at(i)) & mask;
+			while (0 != pSlots[slot]) slot= (slot + 1) & mask;
+			pSlots[slot]= static_cast<GLuint>(i) + 1;
 		}
- 	}
- 	else
- 	{
-		QString message= "GLC_ObjToWorld::extractVertexIndex OBJ file " + m_FileName + " not reconize";
-		message.append("\nAt line : ");
-		message.append(QString::number(m_CurrentLineNumber));
-		GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::FileNotSupported);
-		clear();
-		throw(fileFormatException);
- 	}
+	}
 
+	return index;
 }
 
-// set the OBJ File type
-void GLC_ObjToWorld::setObjType(QString& ligne)
+// Triangulate the given polygon of the current mesh
+void GLC_ObjToWorld::triangulateFace(IndexList* pFaceIndex)
 {
-    const QRegExp coordinateOnlyRegExp("^[-+]?\\d{1,}$"); // ex. 10
-    const QRegExp coordinateTextureNormalRegExp("^[-+]?\\d{1,}/[-+]?\\d{1,}/[-+]?\\d{1,}$"); // ex. 10/30/54
-    const QRegExp coordinateNormalRegExp("^[-+]?\\d{1,}//[-+]?\\d{1,}$"); // ex. 10//54
-    const QRegExp coordinateTextureRegExp("^[-+]?\\d{1,}/[-+]?\\d{1,}$"); // ex. 10/56
-
- 	if (coordinateTextureNormalRegExp.exactMatch(ligne))
- 	{
- 		m_FaceType= coordinateAndTextureAndNormal;
- 	}
- 	else if (coordinateTextureRegExp.exactMatch(ligne))
- 	{
- 		m_FaceType= coordinateAndTexture;
- 	}
- 	else if (coordinateNormalRegExp.exactMatch(ligne))
- 	{
- 		m_FaceType= coordinateAndNormal;
- 	}
-  	else if (coordinateOnlyRegExp.exactMatch(ligne))
- 	{
- 		m_FaceType= coordinate;
- 	}
- 	else
- 	{
-		QString message= "GLC_ObjToWorld::setObjType OBJ file " + m_FileName + " not reconize";
-		message.append("\nAt line : ");
-		message.append(QString::number(m_CurrentLineNumber));
-		GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::FileNotSupported);
-		clear();
-		throw(fileFormatException);
- 	}
+	// The polygon is triangulated with its own vertice
+	const int size= pFaceIndex->size();
+	QList<float> polygon;
+	IndexList polygonIndex;
+	for (int i= 0; i < size; ++i)
+	{
+		const GLuint index= pFaceIndex->at(i);
+		polygon << m_pCurrentObjMesh->m_Positions.at(index * 3);
+		polygon << m_pCurrentObjMesh->m_Positions.at(index * 3 + 1);
+		polygon << m_pCurrentObjMesh->m_Positions.at(index * 3 + 2);
+		polygonIndex.append(i);
+	}
+	glc::triangulatePolygon(&polygonIndex, polygon);
+
+	IndexList faceIndex;
+	const int triangleIndexCount= polygonIndex.size();
+	for (int i= 0; i < triangleIndexCount; ++i)
+	{
+		faceIndex.append(pFaceIndex->at(polygonIndex.at(i)));
+	}
+	*pFaceIndex= faceIndex;
 }
 
 // compute face normal
@@ -854,6 +746,9 @@ void GLC_ObjToWorld::clear()
 {
 	m_CurrentMeshMaterials.clear();
 	m_ListOfAttachedFileName.clear();
+	m_Positions.clear();
+	m_Normals.clear();
+	m_Texels.clear();
 
 	if (NULL != m_pMtlLoader)
 	{
@@ -867,16 +762,15 @@ void GLC_ObjToWorld::clear()
 	}
 
 }
-// Merge Mutli line in one
-void GLC_ObjToWorld::mergeLines(QString* pLineBuff, QTextStream* p0bjStream)
+
+// Throw a file format exception with the given message and the current line number
+void GLC_ObjToWorld::throwException(QString message, GLC_FileFormatException::ExceptionType type)
 {
-	if (pLineBuff->endsWith(QChar('\\')))
-	{
-		pLineBuff->replace(QChar('\\'), QChar(' '));
-		pLineBuff->append(p0bjStream->readLine());
-		++m_CurrentLineNumber;
-		mergeLines(pLineBuff, p0bjStream);
-	}
+	message.append("\nAt line : ");
+	message.append(QString::number(m_CurrentLineNumber));
+	GLC_FileFormatException fileFormatException(message, m_FileName, type);
+	clear();
+	throw(fileFormatException);
 }
 
 // Add the current Obj mesh to the world
@@ -886,13 +780,15 @@ void GLC_ObjToWorld::addCurrentObjMeshToWorld()
 	{
 		if (!m_pCurrentObjMesh->m_Positions.isEmpty())
 		{
-			m_pCurrentObjMesh->m_pMesh->addVertice(m_pCurrentObjMesh->m_Positions.toVector());
+			m_pCurrentObjMesh->m_pMesh->addVertice(m_pCurrentObjMesh->m_Positions);
 			m_pCurrentObjMesh->m_Positions.clear();
-			m_pCurrentObjMesh->m_pMesh->addNormals(m_pCurrentObjMesh->m_Normals.toVector());
+			m_pCurrentObjMesh->m_pMesh->addNormals(m_pCurrentObjMesh->m_Normals);
 			m_pCurrentObjMesh->m_Normals.clear();
 			if (!m_pCurrentObjMesh->m_Texels.isEmpty())
 			{
-				m_pCurrentObjMesh->m_pMesh->addTexels(m_pCurrentObjMesh->m_Texels.toVector());
+				// Vertex added after the last texture coordinate get an empty one
+				m_pCurrentObjMesh->m_Texels.resize(m_pCurrentObjMesh->m_NextFreeIndex * 2);
+				m_pCurrentObjMesh->m_pMesh->addTexels(m_pCurrentObjMesh->m_Texels);
 				m_pCurrentObjMesh->m_Texels.clear();
 			}
 			QHash<QString, MatOffsetSize*>::iterator iMat= m_pCurrentObjMesh->m_Materials.begin();
@@ -911,11 +807,7 @@ void GLC_ObjToWorld::addCurrentObjMeshToWorld()
 					size= m_pCurrentObjMesh->m_Index.size() - offset;
 				}
 				//qDebug() << "Offset : " << offset << " size : " << size;
-				QList<GLuint> triangles;
-				for (int i= offset; i < (offset + size); ++i)
-				{
-					triangles.append(m_pCurrentObjMesh->m_Index.at(i));
-				}
+				const IndexList triangles(m_pCurrentObjMesh->m_Index.mid(offset, size));
 				// Add the list of triangle to the mesh
 				if (!triangles.isEmpty())
 				{
@@ -38,6 +38,7 @@
 #include "../maths/glc_vector2df.h"
 #include "../maths/glc_vector3df.h"
 #include "../geometry/glc_mesh.h"
+#include "../glc_fileformatexception.h"
 
 #include "../glc_config.h"
 
@@ -74,21 +75,19 @@ public:
 	struct ObjVertice
 	{
 		ObjVertice()
-		: m_Values(3)
 		{
 			m_Values[0]= 0;
 			m_Values[1]= 0;
 			m_Values[2]= 0;
 		}
 		ObjVertice(int v1, int v2, int v3)
-		: m_Values(3)
 		{
 			m_Values[0]= v1;
 			m_Values[1]= v2;
 			m_Values[2]= v3;
 		}
 
-		QVector<int> m_Values;
+		int m_Values[3];
 	};
 
 	// Material assignement
@@ -114,7 +113,8 @@ public:
 		, m_pLastOffsetSize(new MatOffsetSize())
 		, m_Materials()
 		, m_NextFreeIndex(0)
-		, m_ObjVerticeIndexMap()
+		, m_ObjVertices()
+		, m_ObjVerticeSlots(1024, 0)
 		{
 			m_Materials.insert(materialName, m_pLastOffsetSize);
 		}
@@ -128,9 +128,9 @@ public:
 			}
 		}
 		GLC_Mesh* m_pMesh;
-		QList<float> m_Positions;
-		QList<float> m_Normals;
-		QList<float> m_Texels;
+		GLfloatVector m_Positions;
+		GLfloatVector m_Normals;
+		GLfloatVector m_Texels;
 		//! The index of the current Mesh
 		IndexList m_Index;
 		// Pointer to the last matOffsetSize
@@ -139,8 +139,10 @@ public:
 		QHash<QString, MatOffsetSize*> m_Materials;
 		//! The next free index
 		int m_NextFreeIndex;
-		//! The Hash table of obj vertice mapping to index
-		QHash<ObjVertice, GLuint> m_ObjVerticeIndexMap;
+		//! The obj vertice of each index
+		QVector<ObjVertice> m_ObjVertices;
+		//! Open addressing hash table of obj vertice, a slot contains index + 1 or 0 if it's free
+		QVector<GLuint> m_ObjVerticeSlots;
 	};
 
 //////////////////////////////////////////////////////////////////////
@@ -172,29 +174,32 @@ private:
 	//! Return the name of the mtl file
 	QString getMtlLibFileName(QString);
 
+	//! Load the given mtl file
+	void loadMtlLib(const QString& mtlLibFileName, bool reportError);
+
 	//! Scan a line previously extracted from OBJ file
-	void scanLigne(QString &);
+	void scanLine(const char* pBegin, const char* pEnd);
 
 	//! Change current group
 	void changeGroup(QString);
 
-	//! Extract a 3D Vector from a string
-	QList<float> extract3dVect(QString &);
-
-	//! Extract a 2D Vector from a string
-	QList<float> extract2dVect(QString &);
+	//! Append a vector of the given size extracted from the given characters to the given bulk
+	void extractVector(const char* pBegin, const char* pEnd, int size, GLfloatVector* pBulk);
 
-	//! Extract a face from a string
-	void extractFaceIndex(QString &);
+	//! Extract a face from the given characters
+	void extractFaceIndex(const char* pBegin, const char* pEnd);
 
 	//! Set Current material index
-	void setCurrentMaterial(QString &line);
+	void setCurrentMaterial(const QString& materialName);
 
-	//! Extract a vertex from a string
-	void extractVertexIndex(QString ligne, int &Coordinate, int &Normal, int &TextureCoordinate);
+	//! Extract a face vertex from the given characters and return a pointer after it
+	const char* extractVertexIndex(const char* pBegin, const char* pEnd, ObjVertice* pVertice);
 
-	//! set the OBJ File type
-	void setObjType(QString &);
+	//! Return the index of the given obj vertice in the current mesh, add it if needed
+	GLuint objVerticeIndex(const ObjVertice& vertice);
+
+	//! Triangulate the given polygon of the current mesh
+	void triangulateFace(IndexList* pFaceIndex);
 
 	//! compute face normal
 	GLC_Vector3df computeNormal(GLuint, GLuint, GLuint);
@@ -202,8 +207,8 @@ private:
 	//! clear objToWorld allocate memmory
 	void clear();
 
-	//! Merge Mutli line in one
-	void mergeLines(QString*, QTextStream*);
+	//! Throw a file format exception with the given message and the current line number
+	void throwException(QString message, GLC_FileFormatException::ExceptionType type);
 
 	//! Add the current Obj mesh to the world
 	void addCurrentObjMeshToWorld();
@@ -248,33 +253,33 @@ private:
 	QStringList m_ListOfAttachedFileName;
 
 	//! The position bulk data
-	QList<float> m_Positions;
+	GLfloatVector m_Positions;
 
 	//! The normal bulk data
-	QList<float> m_Normals;
+	GLfloatVector m_Normals;
 
 	//! The texture coordinate bulk data
-	QList<float> m_Texels;
-
-    int m_VerticeIndex;
-    int m_NormalIndex;
-    int m_TextureIndex;
+	GLfloatVector m_Texels;
 
-    int m_VerticeOffset;
-    int m_NormalOffset;
-    int m_TextureOffset;
-
-
-    bool m_ResetIndex;
+	//! True if the mtl file has been searched
+	bool m_MtlLibSearched;
 
 };
 
 // To use ObjVertice as a QHash key
 inline bool operator==(const GLC_ObjToWorld::ObjVertice& vertice1, const GLC_ObjToWorld::ObjVertice& vertice2)
-{ return (vertice1.m_Values == vertice2.m_Values);}
+{
+	return (vertice1.m_Values[0] == vertice2.m_Values[0]) && (vertice1.m_Values[1] == vertice2.m_Values[1])
+			&& (vertice1.m_Values[2] == vertice2.m_Values[2]);
+}
 
 inline uint qHash(const GLC_ObjToWorld::ObjVertice& vertice)
-{ return qHash(QString::number(vertice.m_Values.at(0)) + QString::number(vertice.m_Values.at(1)) + QString::number(vertice.m_Values.at(2)));}
+{
+	uint hash= static_cast<uint>(vertice.m_Values[0]) * 73856093u;
+	hash^= static_cast<uint>(vertice.m_Values[1]) * 19349663u;
+	hash^= static_cast<uint>(vertice.m_Values[2]) * 83492791u;
+	return hash ^ (hash >> 16);
+}
 
 
 #endif /*GLC_OBJTOWORLD_H_*/
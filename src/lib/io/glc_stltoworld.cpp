@@ -29,9 +29,53 @@
 #include "../sceneGraph/glc_structinstance.h"
 #include "../sceneGraph/glc_structoccurrence.h"
 
+#include "../glc_state.h"
+
 #include <QTextStream>
 #include <QFileInfo>
-#include <QDataStream>
+#include <QtEndian>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <climits>
+
+// Number of binary STL facets decoded by one worker
+static const quint32 binaryChunkSize= 65536;
+
+// Size in bytes of a binary STL facet
+static const qint64 binaryFacetSize= 50;
+
+// Cosine of the crease angle (30 degrees) above which welded vertices are not shared
+static const GLfloat weldCreaseCosine= 0.8660254f;
+
+// Read a little endian float from the given binary STL data
+static inline GLfloat readLittleEndianFloat(const uchar* pData)
+{
+	const quint32 bits= qFromLittleEndian<quint32>(pData);
+	GLfloat value;
+	memcpy(&value, &bits, sizeof(GLfloat));
+	return value;
+}
+
+// Return the hash value of the given position used to weld vertices
+static inline quint32 positionHash(const GLfloat* pPosition)
+{
+	quint32 bits[3];
+	memcpy(bits, pPosition, sizeof(bits));
+	return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+}
+
+// Normalize the given 3 floats vector if it is not null
+static inline void normalizeNormal(GLfloat* pNormal)
+{
+	const GLfloat length= sqrt(pNormal[0] * pNormal[0] + pNormal[1] * pNormal[1] + pNormal[2] * pNormal[2]);
+	if (length > 0.0f)
+	{
+		pNormal[0]/= length;
+		pNormal[1]/= length;
+		pNormal[2]/= length;
+	}
+}
 
 GLC_StlToWorld::GLC_StlToWorld()
 : QObject()
@@ -44,6 +88,9 @@ GLC_StlToWorld::GLC_StlToWorld()
 , m_VertexBulk()
 , m_NormalBulk()
 , m_CurrentIndex(0)
+, m_WeldVertices(GLC_State::isStlVertexWeldingActivated())
+, m_BinaryVertexBulk()
+, m_BinaryNormalBulk()
 {
 
 }
@@ -79,73 +126,58 @@ GLC_World* GLC_StlToWorld::CreateWorldFromStl(QFile &file)
 	// Create Working variables
 	int currentQuantumValue= 0;
 	int previousQuantumValue= 0;
-	int numberOfLine= 0;
-
-	// Attach the stream to the file
-	m_StlStream.setDevice(&file);
-
-	// QString buffer
-	QString lineBuff;
-
-	//////////////////////////////////////////////////////////////////
-	// Count the number of lines of the STL file
-    // And test if the STL file is ASCII
-	//////////////////////////////////////////////////////////////////
-    bool stlIsAscii= false;
-	while (!m_StlStream.atEnd())
-	{
-		++numberOfLine;
-        const QString currentLine= m_StlStream.readLine();
-        if (!stlIsAscii)
-        {
-            stlIsAscii= currentLine.contains("facet", Qt::CaseInsensitive);
-        }
-	}
-
-	//////////////////////////////////////////////////////////////////
-	// Reset the stream
-	//////////////////////////////////////////////////////////////////
-	m_StlStream.resetStatus();
-	m_StlStream.seek(0);
-	//////////////////////////////////////////////////////////////////
-	// Read Buffer and create the world
-	//////////////////////////////////////////////////////////////////
+	const qint64 fileSize= qMax(file.size(), static_cast<qint64>(1));
 
 	emit currentQuantum(currentQuantumValue);
 	m_CurrentLineNumber= 0;
-	// Search Object section in the STL
 
-	// Test if the STL File is ASCII or Binary
-	++m_CurrentLineNumber;
-	lineBuff= m_StlStream.readLine();
-	lineBuff= lineBuff.trimmed().toLower();
-    if (!stlIsAscii)
+	// Test if the STL File is ASCII or Binary from its header and size
+	if (isBinaryStl(file))
 	{
-		// The STL File is not ASCII trying to load Binary STL File
+		// The STL File is Binary
 		m_pCurrentMesh= new GLC_Mesh();
-        if (lineBuff.startsWith("solid"))
-        {
-            lineBuff.remove(0, 5);
-            lineBuff= lineBuff.trimmed();
-            m_pCurrentMesh->setName(lineBuff);
-        }
+		QByteArray header= file.read(80);
+		const int endOfHeader= header.indexOf('\0');
+		if (-1 != endOfHeader) header.truncate(endOfHeader);
+		QString lineBuff= QString::fromLatin1(header).trimmed();
+		if (lineBuff.startsWith("solid", Qt::CaseInsensitive))
+		{
+			lineBuff.remove(0, 5);
+			lineBuff= lineBuff.trimmed();
+			m_pCurrentMesh->setName(lineBuff);
+		}
 
 		file.reset();
 		LoadBinariStl(file);
-		m_pCurrentMesh->addTriangles(NULL, m_CurrentFace);
-		m_CurrentFace.clear();
-		m_pCurrentMesh->addVertice(m_VertexBulk.toVector());
-		m_VertexBulk.clear();
-		m_pCurrentMesh->addNormals(m_NormalBulk.toVector());
-		m_NormalBulk.clear();
-		m_pCurrentMesh->finish();
-		GLC_3DRep* pRep= new GLC_3DRep(m_pCurrentMesh);
-		m_pCurrentMesh= NULL;
-		m_pWorld->rootOccurrence()->addChild(new GLC_StructOccurrence(pRep));
+		if (!m_CurrentFace.isEmpty())
+		{
+			m_pCurrentMesh->addTriangles(NULL, m_CurrentFace);
+			m_CurrentFace.clear();
+			m_pCurrentMesh->addVertice(m_BinaryVertexBulk);
+			m_BinaryVertexBulk.clear();
+			m_pCurrentMesh->addNormals(m_BinaryNormalBulk);
+			m_BinaryNormalBulk.clear();
+			m_pCurrentMesh->finish();
+			GLC_3DRep* pRep= new GLC_3DRep(m_pCurrentMesh);
+			m_pCurrentMesh= NULL;
+			m_pWorld->rootOccurrence()->addChild(new GLC_StructOccurrence(pRep));
+		}
+		else
+		{
+			delete m_pCurrentMesh;
+			m_pCurrentMesh= NULL;
+		}
 	}
 	else
 	{
 		// The STL File is ASCII
+		// Attach the stream to the file
+		m_StlStream.setDevice(&file);
+
+		++m_CurrentLineNumber;
+		QString lineBuff= m_StlStream.readLine();
+		lineBuff= lineBuff.trimmed().toLower();
+
 		m_pCurrentMesh= new GLC_Mesh();
         if (lineBuff.startsWith("solid"))
         {
@@ -153,12 +185,12 @@ GLC_World* GLC_StlToWorld::CreateWorldFromStl(QFile &file)
             lineBuff= lineBuff.trimmed();
             m_pCurrentMesh->setName(lineBuff);
         }
-        // Read the mesh facet
+        // Read the mesh facet, progress is given by the file position
 		while (!m_StlStream.atEnd())
 		{
 			scanFacet();
 
-			currentQuantumValue = static_cast<int>((static_cast<double>(m_CurrentLineNumber) / numberOfLine) * 100);
+			currentQuantumValue = static_cast<int>((static_cast<double>(file.pos()) / fileSize) * 100);
 			if (currentQuantumValue > previousQuantumValue)
 			{
 				emit currentQuantum(currentQuantumValue);
@@ -188,6 +220,11 @@ void GLC_StlToWorld::clear()
 	m_CurrentLineNumber= 0;
 	m_pCurrentMesh= NULL;
 	m_CurrentFace.clear();
+	m_VertexBulk.clear();
+	m_NormalBulk.clear();
+	m_BinaryVertexBulk.clear();
+	m_BinaryNormalBulk.clear();
+	m_CurrentIndex= 0;
 }
 
 // Scan a line previously extracted from STL file
@@ -360,84 +397,253 @@ GLC_Vector3df GLC_StlToWorld::extract3dVect(QString &line)
 // Load Binarie STL File
 void GLC_StlToWorld::LoadBinariStl(QFile &file)
 {
-	// Create Working variables
-	int currentQuantumValue= 0;
-	int previousQuantumValue= 0;
-
-	QDataStream stlBinFile(&file);
-	stlBinFile.setVersion(QDataStream::Qt_4_6);
-	stlBinFile.setFloatingPointPrecision(QDataStream::SinglePrecision);
-	stlBinFile.setByteOrder(QDataStream::LittleEndian);
+	const qint64 fileSize= file.size();
 
-	// Skip 80 Bytes STL header
-	int SkipedData= stlBinFile.skipRawData(80);
-	// Check if an error occur
-	if (-1 == SkipedData)
+	// Map the whole file, or read it if the file engine doesn't support mapping
+	QByteArray fileContent;
+	uchar* pMappedData= file.map(0, fileSize);
+	const uchar* pData= pMappedData;
+	if (NULL == pData)
 	{
-		QString message= "GLC_StlToWorld::LoadBinariStl : Failed to skip Header of binary STL";
-		GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
-		clear();
-		throw(fileFormatException);
+		fileContent= file.readAll();
+		pData= reinterpret_cast<const uchar*>(fileContent.constData());
 	}
-	// Read the number of facet
+
+	// Check the header and the number of facet
 	quint32 numberOfFacet= 0;
-	stlBinFile >> numberOfFacet;
-	// Check if an error occur
-	if (QDataStream::Ok != stlBinFile.status())
+	QString errorMessage;
+	if (fileSize < 84)
 	{
-		QString message= "GLC_StlToWorld::LoadBinariStl : Failed to read the number of facets of binary STL";
-		GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
+		errorMessage= "GLC_StlToWorld::LoadBinariStl : Failed to read the number of facets of binary STL";
+	}
+	else
+	{
+		// Skip 80 Bytes STL header
+		numberOfFacet= qFromLittleEndian<quint32>(pData + 80);
+		if ((84 + binaryFacetSize * static_cast<qint64>(numberOfFacet)) > fileSize)
+		{
+			errorMessage= "GLC_StlToWorld::LoadBinariStl : Failed to read the facets of binary STL";
+		}
+		else if (numberOfFacet > static_cast<quint32>(INT_MAX / 9))
+		{
+			// The bulk data of the mesh are indexed with int
+			errorMessage= "GLC_StlToWorld::LoadBinariStl : Too many facets in binary STL";
+		}
+	}
+	if (!errorMessage.isEmpty())
+	{
+		if (NULL != pMappedData) file.unmap(pMappedData);
+		GLC_FileFormatException fileFormatException(errorMessage, m_FileName, GLC_FileFormatException::WrongFileFormat);
 		clear();
 		throw(fileFormatException);
 	}
-	for (quint32 i= 0; i < numberOfFacet; ++i)
+
+	const uchar* pFacets= pData + 84;
+	if (m_WeldVertices)
+	{
+		weldBinaryFacets(pFacets, numberOfFacet);
+	}
+	else
+	{
+		// Facets vertices are not shared, decode them in parallel
+		m_BinaryVertexBulk.resize(static_cast<int>(numberOfFacet) * 9);
+		m_BinaryNormalBulk.resize(static_cast<int>(numberOfFacet) * 9);
+		const GLuint numberOfIndex= numberOfFacet * 3;
+		m_CurrentFace.reserve(static_cast<int>(numberOfIndex));
+		for (GLuint i= 0; i < numberOfIndex; ++i)
+		{
+			m_CurrentFace.append(i);
+		}
+		m_CurrentIndex= numberOfIndex;
+
+		QVector<BinaryChunk> chunks;
+		for (quint32 first= 0; first < numberOfFacet; first+= binaryChunkSize)
+		{
+			BinaryChunk chunk;
+			chunk.m_pFacets= pFacets;
+			chunk.m_FirstFacet= first;
+			chunk.m_FacetCount= qMin(binaryChunkSize, numberOfFacet - first);
+			chunk.m_pPositions= m_BinaryVertexBulk.data();
+			chunk.m_pNormals= m_BinaryNormalBulk.data();
+			chunks.append(chunk);
+		}
+
+		// Decode chunks by waves in order to report progress
+		const int chunkCount= chunks.size();
+		const int waveSize= qMax(1, QThread::idealThreadCount()) * 4;
+		for (int i= 0; i < chunkCount; i+= waveSize)
+		{
+			QVector<BinaryChunk> wave= chunks.mid(i, waveSize);
+			QtConcurrent::blockingMap(wave, GLC_StlToWorld::decodeBinaryChunk);
+
+			const int currentQuantumValue= static_cast<int>((static_cast<double>(qMin(i + waveSize, chunkCount)) / chunkCount) * 100);
+			emit currentQuantum(currentQuantumValue);
+		}
+	}
+
+	if (NULL != pMappedData) file.unmap(pMappedData);
+}
+
+// Return true if the given file is a binary STL
+bool GLC_StlToWorld::isBinaryStl(QFile &file)
+{
+	const qint64 fileSize= file.size();
+	const QByteArray head= file.peek(84);
+	if ((fileSize < 84) || (head.size() < 84)) return false;
+
+	const quint32 numberOfFacet= qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(head.constData()) + 80);
+	const qint64 binarySize= 84 + binaryFacetSize * static_cast<qint64>(numberOfFacet);
+	if (binarySize == fileSize) return true;
+	if (binarySize > fileSize) return false;
+
+	// Some exporters add data after the last facet and many start the binary header with "solid",
+	// the file is ASCII only if the line following "solid" starts a facet or ends the solid
+	const bool headerIsAscii= QString::fromLatin1(head.left(80)).trimmed().startsWith("solid", Qt::CaseInsensitive);
+	if (!headerIsAscii) return true;
+
+	const QByteArray start= file.peek(1024);
+	const int endOfLine= start.indexOf('\n');
+	if (-1 == endOfLine) return true;
+	const QByteArray nextLine= start.mid(endOfLine + 1).trimmed().toLower();
+	return !(nextLine.startsWith("facet") || nextLine.startsWith("endsolid") || nextLine.startsWith("end solid"));
+}
+
+// Decode the given binary chunk into the mesh bulk data
+void GLC_StlToWorld::decodeBinaryChunk(BinaryChunk& chunk)
+{
+	const quint32 lastFacet= chunk.m_FirstFacet + chunk.m_FacetCount;
+	for (quint32 i= chunk.m_FirstFacet; i < lastFacet; ++i)
 	{
+		const uchar* pFacet= chunk.m_pFacets + binaryFacetSize * i;
+		GLfloat* pPosition= chunk.m_pPositions + static_cast<qint64>(9) * i;
+		GLfloat* pNormal= chunk.m_pNormals + static_cast<qint64>(9) * i;
+
 		// Extract the facet normal
-		float nx, ny, nz;
-		stlBinFile >> nx >> ny >> nz;
-		// Check if an error occur
-		if (QDataStream::Ok != stlBinFile.status())
+		const GLfloat nx= readLittleEndianFloat(pFacet);
+		const GLfloat ny= readLittleEndianFloat(pFacet + 4);
+		const GLfloat nz= readLittleEndianFloat(pFacet + 8);
+		for (int j= 0; j < 3; ++j)
 		{
-			QString message= "GLC_StlToWorld::LoadBinariStl : Failed to read the Normal of binary STL";
-			GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
-			clear();
-			throw(fileFormatException);
+			pNormal[3 * j]= nx;
+			pNormal[3 * j + 1]= ny;
+			pNormal[3 * j + 2]= nz;
 		}
 
-		// Extract the 3 Vertexs
+		// Extract the 3 Vertexs, the 2 fill-bytes are not needed
+		for (int j= 0; j < 9; ++j)
+		{
+			pPosition[j]= readLittleEndianFloat(pFacet + 12 + 4 * j);
+		}
+	}
+}
+
+// Decode the given binary facets and weld duplicated vertices
+void GLC_StlToWorld::weldBinaryFacets(const uchar* pFacets, quint32 numberOfFacet)
+{
+	int currentQuantumValue= 0;
+	int previousQuantumValue= 0;
+
+	// Open addressing hash table of (welded vertex index + 1), 0 is an empty slot
+	// A closed mesh has about half as many vertices as facets
+	quint32 capacity= 1024;
+	while (capacity < (numberOfFacet + numberOfFacet / 2)) capacity*= 2;
+	QVector<GLuint> hashTable(static_cast<int>(capacity), 0);
+	quint32 mask= capacity - 1;
+
+	m_BinaryVertexBulk.reserve(static_cast<int>(numberOfFacet / 2 + 3) * 3);
+	m_BinaryNormalBulk.reserve(static_cast<int>(numberOfFacet / 2 + 3) * 3);
+	m_CurrentFace.reserve(static_cast<int>(numberOfFacet) * 3);
+
+	for (quint32 i= 0; i < numberOfFacet; ++i)
+	{
+		const uchar* pFacet= pFacets + binaryFacetSize * i;
+
+		GLfloat positions[9];
+		for (int j= 0; j < 9; ++j)
+		{
+			// Adding 0 turns -0.0 into 0.0
+			positions[j]= readLittleEndianFloat(pFacet + 12 + 4 * j) + 0.0f;
+		}
+
+		// The facet normal, computed if not given by the file
+		GLfloat normal[3]= {readLittleEndianFloat(pFacet), readLittleEndianFloat(pFacet + 4), readLittleEndianFloat(pFacet + 8)};
+		if ((0.0f == normal[0]) && (0.0f == normal[1]) && (0.0f == normal[2]))
+		{
+			const GLfloat u[3]= {positions[3] - positions[0], positions[4] - positions[1], positions[5] - positions[2]};
+			const GLfloat v[3]= {positions[6] - positions[0], positions[7] - positions[1], positions[8] - positions[2]};
+			normal[0]= u[1] * v[2] - u[2] * v[1];
+			normal[1]= u[2] * v[0] - u[0] * v[2];
+			normal[2]= u[0] * v[1] - u[1] * v[0];
+		}
+		normalizeNormal(normal);
+		const bool normalIsNull= (0.0f == normal[0]) && (0.0f == normal[1]) && (0.0f == normal[2]);
+
 		for (int j= 0; j < 3; ++j)
 		{
-			float x, y, z;
-			stlBinFile >> x >> y >> z;
-			// Check if an error occur
-			if (QDataStream::Ok != stlBinFile.status())
+			// A vertex is shared by the facets of the same position whose normals are within the crease angle
+			// of its accumulated normal, so CAD sharp edges are kept
+			const GLfloat* pPosition= &(positions[3 * j]);
+			quint32 slot= positionHash(pPosition) & mask;
+			GLuint index= 0;
+			bool found= false;
+			while (!found && (0 != hashTable.at(slot)))
 			{
-				QString message= "GLC_StlToWorld::LoadBinariStl : Failed to read the Vertex of binary STL";
-				GLC_FileFormatException fileFormatException(message, m_FileName, GLC_FileFormatException::WrongFileFormat);
-				clear();
-				throw(fileFormatException);
+				index= hashTable.at(slot) - 1;
+				found= (0 == memcmp(m_BinaryVertexBulk.constData() + 3 * index, pPosition, 3 * sizeof(GLfloat)));
+				if (found && !normalIsNull)
+				{
+					const GLfloat* pVertexNormal= m_BinaryNormalBulk.constData() + 3 * index;
+					const GLfloat dot= pVertexNormal[0] * normal[0] + pVertexNormal[1] * normal[1] + pVertexNormal[2] * normal[2];
+					const GLfloat length= sqrt(pVertexNormal[0] * pVertexNormal[0] + pVertexNormal[1] * pVertexNormal[1] + pVertexNormal[2] * pVertexNormal[2]);
+					found= (dot >= (weldCreaseCosine * length));
+				}
+				if (!found) slot= (slot + 1) & mask;
 			}
-			m_VertexBulk.append(x);
-			m_VertexBulk.append(y);
-			m_VertexBulk.append(z);
-
-			m_NormalBulk.append(nx);
-			m_NormalBulk.append(ny);
-			m_NormalBulk.append(nz);
+			if (!found)
+			{
+				index= static_cast<GLuint>(m_BinaryVertexBulk.size() / 3);
+				m_BinaryVertexBulk << pPosition[0] << pPosition[1] << pPosition[2];
+				m_BinaryNormalBulk << 0.0f << 0.0f << 0.0f;
+				hashTable[slot]= index + 1;
+
+				// Grow the hash table above 3/4 load
+				if ((static_cast<quint64>(index + 1) * 4) > (static_cast<quint64>(capacity) * 3))
+				{
+					capacity*= 2;
+					mask= capacity - 1;
+					hashTable.fill(0, static_cast<int>(capacity));
+					const GLuint vertexCount= index + 1;
+					for (GLuint vertex= 0; vertex < vertexCount; ++vertex)
+					{
+						quint32 newSlot= positionHash(m_BinaryVertexBulk.constData() + 3 * vertex) & mask;
+						while (0 != hashTable.at(newSlot)) newSlot= (newSlot + 1) & mask;
+						hashTable[newSlot]= vertex + 1;
+					}
+				}
+			}
+			// Accumulate facets normals
+			GLfloat* pNormal= m_BinaryNormalBulk.data() + 3 * index;
+			pNormal[0]+= normal[0];
+			pNormal[1]+= normal[1];
+			pNormal[2]+= normal[2];
 
-			m_CurrentFace.append(m_CurrentIndex);
-			++m_CurrentIndex;
+			m_CurrentFace.append(index);
 		}
+
 		currentQuantumValue = static_cast<int>((static_cast<double>(i + 1) / numberOfFacet) * 100);
 		if (currentQuantumValue > previousQuantumValue)
 		{
 			emit currentQuantum(currentQuantumValue);
 		}
 		previousQuantumValue= currentQuantumValue;
+	}
+	m_CurrentIndex= static_cast<GLuint>(m_BinaryVertexBulk.size() / 3);
 
-		// Skip 2 fill-bytes not needed !!!!
-		stlBinFile.skipRawData(2);
-
+	// Normalize welded vertices normals
+	const int normalCount= m_BinaryNormalBulk.size() / 3;
+	GLfloat* pNormals= m_BinaryNormalBulk.data();
+	for (int i= 0; i < normalCount; ++i)
+	{
+		normalizeNormal(pNormals + 3 * i);
 	}
 }
-
@@ -46,12 +46,34 @@ class GLC_World;
  * 		- Vertex
  * 		- Face
  * 		- Normal coordinate
+ *
+ *  Binary STL files are detected from their size (80 + 4 + 50 * n bytes),
+ *  memory mapped and decoded in parallel. A file with trailing data after the last facet
+ *  is binary unless the line after its "solid" header starts a facet.
+ *  Duplicated vertices of binary STL can be welded, in this case normals are averaged
+ *  from the facets normals within a crease angle of 30 degrees, sharper edges are kept.
   */
 //////////////////////////////////////////////////////////////////////
 
 class GLC_LIB_EXPORT GLC_StlToWorld : public QObject
 {
 	Q_OBJECT
+
+	//! Range of binary STL facets decoded by one worker
+	struct BinaryChunk
+	{
+		//! Pointer to the first facet of the file
+		const uchar* m_pFacets;
+		//! Index of the first facet of the chunk
+		quint32 m_FirstFacet;
+		//! Number of facets of the chunk
+		quint32 m_FacetCount;
+		//! Target positions of the whole mesh
+		GLfloat* m_pPositions;
+		//! Target normals of the whole mesh
+		GLfloat* m_pNormals;
+	};
+
 //////////////////////////////////////////////////////////////////////
 /*! @name Constructor / Destructor */
 //@{
@@ -67,6 +89,15 @@ public:
 public:
 	//! Create and return an GLC_World* from an input STL File
 	GLC_World* CreateWorldFromStl(QFile &file);
+
+	//! Set duplicated vertices welding of binary STL
+	/*! Default value is given by GLC_State::isStlVertexWeldingActivated()*/
+	inline void setVertexWelding(bool weld)
+	{m_WeldVertices= weld;}
+
+	//! Return true if duplicated vertices of binary STL are welded
+	inline bool vertexWelding() const
+	{return m_WeldVertices;}
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -83,6 +114,16 @@ private:
 	//! Load Binarie STL File
 	void LoadBinariStl(QFile &);
 
+	//! Return true if the given file is a binary STL
+	/*! The size of a binary STL is 80 + 4 + 50 * number of facets*/
+	static bool isBinaryStl(QFile &);
+
+	//! Decode the given binary chunk into the mesh bulk data
+	static void decodeBinaryChunk(BinaryChunk& chunk);
+
+	//! Decode the given binary facets and weld duplicated vertices
+	void weldBinaryFacets(const uchar* pFacets, quint32 numberOfFacet);
+
 
 
 //@}
@@ -123,6 +164,15 @@ private:
 
 	//! The current index
 	GLuint m_CurrentIndex;
+
+	//! Binary STL vertices welding
+	bool m_WeldVertices;
+
+	//! Binary STL vertex bulk data
+	GLfloatVector m_BinaryVertexBulk;
+
+	//! Binary STL normal bulk data
+	GLfloatVector m_BinaryNormalBulk;
 };
 
 #endif /*GLC_STLTOWORLD_H_*/
@@ -26,9 +26,20 @@
 #include "../3rdparty/quazip/quazip.h"
 #include "../3rdparty/quazip/quazipfile.h"
 #include "../glc_exception.h"
+#include "../glc_state.h"
 #include "../geometry/glc_mesh.h"
+#include "glc_numericparser.h"
 
 #include <QFileInfo>
+#include <QBuffer>
+#include <QtConcurrent>
+#include <string.h>
+
+// The maximum number of 3DRep formatted by a batch of the parallel export
+#define REP_BATCH_SIZE 64
+
+// The maximum number of mesh values copied by a batch of the parallel export
+#define REP_BATCH_VALUE_COUNT (16 * 1024 * 1024)
 
 GLC_WorldTo3dxml::GLC_WorldTo3dxml(const GLC_World& world, bool threaded)
 : QObject()
@@ -105,30 +116,25 @@ bool GLC_WorldTo3dxml::exportTo3dxml(const QString& filename, GLC_WorldTo3dxml::
 
 		if (m_ExportType != StructureOnly)
 		{
-			int previousQuantumValue= 0;
-			int currentQuantumValue= 0;
-			emit currentQuantum(currentQuantumValue);
-
-			int currentRepIndex= 0;
-			const int size= m_ReferenceRepTo3dxmlFileName.size();
-			// Export the representation
-			QHash<const GLC_3DRep*, QString>::const_iterator iRep= m_ReferenceRepTo3dxmlFileName.constBegin();
-			while ((m_ReferenceRepTo3dxmlFileName.constEnd() != iRep) && continu())
-			{
-				write3DRep(iRep.key(), iRep.value());
-				++iRep;
+			emit currentQuantum(0);
 
-				// Progrees bar indicator
-				++currentRepIndex;
-				currentQuantumValue = static_cast<int>((static_cast<double>(currentRepIndex) / size) * 100);
-				if (currentQuantumValue > previousQuantumValue)
-				{
-					emit currentQuantum(currentQuantumValue);
-				}
-				previousQuantumValue= currentQuantumValue;
-				if (!m_IsThreaded)
+			if (GLC_State::isParallelExportActivated())
+			{
+				write3DRepInParallel();
+			}
+			else
+			{
+				int previousQuantumValue= 0;
+				int currentRepIndex= 0;
+				// Export the representation
+				QHash<const GLC_3DRep*, QString>::const_iterator iRep= m_ReferenceRepTo3dxmlFileName.constBegin();
+				while ((m_ReferenceRepTo3dxmlFileName.constEnd() != iRep) && continu())
 				{
-					QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+					write3DRep(iRep.key(), iRep.value());
+					++iRep;
+
+					// Progrees bar indicator
+					emitRepProgress(++currentRepIndex, &previousQuantumValue);
 				}
 			}
 		}
@@ -453,33 +459,80 @@ QString GLC_WorldTo3dxml::matrixString(const GLC_Matrix4x4& matrix)
 
 void GLC_WorldTo3dxml::write3DRep(const GLC_3DRep* pRep, const QString& fileName)
 {
-	setStreamWriterToFile(fileName);
-
-	m_pOutStream->writeStartDocument();
-	m_pOutStream->writeStartElement("XMLRepresentation");
-	m_pOutStream->writeAttribute("version", "1.2");
-	m_pOutStream->writeAttribute("xmlns", "http://www.3ds.com/xsd/3DXML");
-	m_pOutStream->writeAttribute("xmlns:xsi", "http://www.w3.org/2001/XMLSchema-instance");
-	m_pOutStream->writeAttribute("xmlns:xlink", "http://www.w3.org/1999/xlink");
-	m_pOutStream->writeAttribute("xsi:schemaLocation", "http://www.3ds.com/xsd/3DXML ./3DXMLMesh.xsd");
+	RepTask task(repTask(pRep, fileName));
+	formatRepTask(task);
+	writeRepFile(task);
+}
 
-	m_pOutStream->writeStartElement("Root"); // Root
-	m_pOutStream->writeAttribute("xsi:type", "BagRepType");
-	m_pOutStream->writeAttribute("id", QString::number(++m_CurrentId));
-	const int bodyCount= pRep->numberOfBody();
-	for (int i= 0; i < bodyCount; ++i)
+void GLC_WorldTo3dxml::write3DRepInParallel()
+{
+	int previousQuantumValue= 0;
+	int writtenRepCount= 0;
+
+	// The meshes of a batch are copied while the previous batch is formatted
+	// and the formatted batch before is written
+	QVector<RepTask> formattingTasks;
+	QFuture<void> future;
+	QHash<const GLC_3DRep*, QString>::const_iterator iRep= m_ReferenceRepTo3dxmlFileName.constBegin();
+	try
 	{
-		GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pRep->geomAt(i));
-		if (NULL != pMesh)
+		while (!formattingTasks.isEmpty() || (m_ReferenceRepTo3dxmlFileName.constEnd() != iRep))
 		{
-			writeGeometry(pMesh);
+			QVector<RepTask> nextTasks;
+			int valueCount= 0;
+			while ((m_ReferenceRepTo3dxmlFileName.constEnd() != iRep) && (nextTasks.size() < REP_BATCH_SIZE) && (valueCount < REP_BATCH_VALUE_COUNT))
+			{
+				nextTasks.append(repTask(iRep.key(), iRep.value()));
+				valueCount+= nextTasks.last().m_ValueCount;
+				++iRep;
+			}
+
+			future.waitForFinished();
+			QVector<RepTask> formattedTasks;
+			formattedTasks.swap(formattingTasks);
+			formattingTasks.swap(nextTasks);
+			if (!formattingTasks.isEmpty())
+			{
+				future= QtConcurrent::map(formattingTasks, &GLC_WorldTo3dxml::formatRepTask);
+			}
+
+			// Write the formatted batch in order
+			const int formattedCount= formattedTasks.size();
+			for (int i= 0; i < formattedCount; ++i)
+			{
+				writeRepFile(formattedTasks.at(i));
+				emitRepProgress(++writtenRepCount, &previousQuantumValue);
+			}
+
+			if (!continu())
+			{
+				iRep= m_ReferenceRepTo3dxmlFileName.constEnd();
+				future.waitForFinished();
+				formattingTasks.clear();
+			}
 		}
 	}
-	m_pOutStream->writeEndElement(); // Root
-
-	m_pOutStream->writeEndElement(); // XMLRepresentation
+	catch (GLC_Exception&)
+	{
+		// The formatting tasks must not be destroyed while the workers use them
+		future.waitForFinished();
+		throw;
+	}
+}
 
-	m_pOutStream->writeEndDocument();
+void GLC_WorldTo3dxml::emitRepProgress(int writtenRepCount, int* pPreviousQuantumValue)
+{
+	const int size= m_ReferenceRepTo3dxmlFileName.size();
+	const int currentQuantumValue= static_cast<int>((static_cast<double>(writtenRepCount) / size) * 100);
+	if (currentQuantumValue > *pPreviousQuantumValue)
+	{
+		emit currentQuantum(currentQuantumValue);
+	}
+	*pPreviousQuantumValue= currentQuantumValue;
+	if (!m_IsThreaded)
+	{
+		QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+	}
 }
 
 QString GLC_WorldTo3dxml::representationFileName(const GLC_3DRep* pRep)
@@ -518,260 +571,418 @@ QString GLC_WorldTo3dxml::representationFileName(const GLC_3DRep* pRep)
 	return xmlFileName(fileName);
 }
 
-void GLC_WorldTo3dxml::writeGeometry(const GLC_Mesh* pMesh)
+GLC_WorldTo3dxml::RepTask GLC_WorldTo3dxml::repTask(const GLC_3DRep* pRep, const QString& fileName)
 {
-	// Get the list of material id
-	QList<GLC_uint> materialList= pMesh->materialIds();
-	const int materialCount= materialList.size();
+	RepTask task;
+	task.m_FileName= fileName;
+	task.m_FirstId= ++m_CurrentId;
+	task.m_ExportMaterial= m_ExportMaterial;
+	task.m_IsCompressed= (NULL != m_p3dxmlArchive);
+	task.m_ValueCount= 0;
+	task.m_Crc= 0;
+	task.m_Size= 0;
 
-	m_pOutStream->writeStartElement("Rep");
-	m_pOutStream->writeAttribute("xsi:type", "PolygonalRepType");
-	m_pOutStream->writeAttribute("id", QString::number(++m_CurrentId));
-	const double masterAccuracy= pMesh->getLodAccuracy(0);
-	m_pOutStream->writeAttribute("accuracy", QString::number(masterAccuracy));
-	m_pOutStream->writeAttribute("solid", "1");
-	const int lodCount= pMesh->lodCount();
-	if (lodCount > 1)
+	const int bodyCount= pRep->numberOfBody();
+	for (int i= 0; i < bodyCount; ++i)
 	{
-		// The mesh contains LOD
-		for (int i= 1; i < lodCount; ++i)
+		GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pRep->geomAt(i));
+		if (NULL != pMesh)
 		{
-			const double lodAccuracy= pMesh->getLodAccuracy(i);
-			m_pOutStream->writeStartElement("PolygonalLOD");
-			m_pOutStream->writeAttribute("accuracy", QString::number(lodAccuracy));
-			m_pOutStream->writeStartElement("Faces");
-			for (int matIndex= 0; matIndex < materialCount; ++matIndex)
+			// Each mesh uses the next id
+			++m_CurrentId;
+			task.m_Meshes.append(repMesh(pMesh));
+			const RepMesh& mesh= task.m_Meshes.last();
+			task.m_ValueCount+= mesh.m_Positions.size() + mesh.m_Normals.size() + mesh.m_Texels.size() + mesh.m_WirePositions.size();
+			const int lodCount= mesh.m_Lods.size();
+			for (int lod= 0; lod < lodCount; ++lod)
 			{
-				const GLC_uint materialId= materialList.at(matIndex);
-				if (pMesh->lodContainsMaterial(i, materialId))
+				const QList<RepFace>& faces= mesh.m_Lods.at(lod).m_Faces;
+				const int faceCount= faces.size();
+				for (int face= 0; face < faceCount; ++face)
 				{
-					writeGeometryFace(pMesh, i, materialId);
+					task.m_ValueCount+= faces.at(face).m_Triangles.size();
 				}
 			}
-			m_pOutStream->writeEndElement(); // Faces
-			m_pOutStream->writeEndElement(); // PolygonalLOD
 		}
 	}
 
-	// Master LOD
-	m_pOutStream->writeStartElement("Faces");
-	for (int matIndex= 0; matIndex < materialCount; ++matIndex)
+	return task;
+}
+
+GLC_WorldTo3dxml::RepMesh GLC_WorldTo3dxml::repMesh(const GLC_Mesh* pMesh) const
+{
+	RepMesh mesh;
+
+	// Get the list of material id
+	QList<GLC_uint> materialList= pMesh->materialIds();
+	const int materialCount= materialList.size();
+	const int lodCount= qMax(1, pMesh->lodCount());
+	for (int lod= 0; lod < lodCount; ++lod)
 	{
-		const GLC_uint materialId= materialList.at(matIndex);
-		if (pMesh->lodContainsMaterial(0, materialId))
+		RepLod repLod;
+		repLod.m_Accuracy= pMesh->getLodAccuracy(lod);
+		for (int matIndex= 0; matIndex < materialCount; ++matIndex)
 		{
-			writeGeometryFace(pMesh, 0, materialId);
+			const GLC_uint materialId= materialList.at(matIndex);
+			if (pMesh->lodContainsMaterial(lod, materialId))
+			{
+				RepFace face;
+				if (pMesh->containsTriangles(lod, materialId))
+				{
+					face.m_Triangles= pMesh->getTrianglesIndex(lod, materialId);
+				}
+				if (pMesh->containsStrips(lod, materialId))
+				{
+					face.m_Strips= pMesh->getStripsIndex(lod, materialId);
+				}
+				if (pMesh->containsFans(lod, materialId))
+				{
+					face.m_Fans= pMesh->getFansIndex(lod, materialId);
+				}
+				const GLC_Material* pMaterial= pMesh->material(materialId);
+				face.m_MaterialId= m_MaterialIdToMaterialId.value(pMaterial->id());
+				face.m_DiffuseColor= pMaterial->diffuseColor();
+				repLod.m_Faces.append(face);
+			}
 		}
+		mesh.m_Lods.append(repLod);
 	}
-	m_pOutStream->writeEndElement(); // Faces
+
+	// Bulk data
+	mesh.m_Positions= pMesh->positionVector();
+	mesh.m_Normals= pMesh->normalVector();
+	mesh.m_Texels= pMesh->texelVector();
+
 	if (!pMesh->wireDataIsEmpty())
 	{
-		writeEdges(pMesh);
+		mesh.m_WirePositions= pMesh->wirePositionVector();
+		mesh.m_WireColor= pMesh->wireColor();
+		const int polylineCount= pMesh->wirePolylineCount();
+		mesh.m_WireOffsets.resize(polylineCount);
+		mesh.m_WireSizes.resize(polylineCount);
+		for (int i= 0; i < polylineCount; ++i)
+		{
+			mesh.m_WireOffsets[i]= pMesh->wirePolylineOffset(i);
+			mesh.m_WireSizes[i]= pMesh->wirePolylineSize(i);
+		}
 	}
 
-	// Save Bulk data
-	m_pOutStream->writeStartElement("VertexBuffer");
+	return mesh;
+}
+
+void GLC_WorldTo3dxml::formatRepTask(RepTask& task)
+{
+	QByteArray content;
 	{
-		// Get positions
-		GLfloatVector positionVector= pMesh->positionVector();
-		QString positions;
-		const int size= positionVector.size();
-		for (int i= 0; i < size; i+=3)
+		QBuffer buffer(&content);
+		buffer.open(QIODevice::WriteOnly);
+		QXmlStreamWriter outStream(&buffer);
+		outStream.setAutoFormatting(true);
+
+		outStream.writeStartDocument();
+		outStream.writeStartElement("XMLRepresentation");
+		outStream.writeAttribute("version", "1.2");
+		outStream.writeAttribute("xmlns", "http://www.3ds.com/xsd/3DXML");
+		outStream.writeAttribute("xmlns:xsi", "http://www.w3.org/2001/XMLSchema-instance");
+		outStream.writeAttribute("xmlns:xlink", "http://www.w3.org/1999/xlink");
+		outStream.writeAttribute("xsi:schemaLocation", "http://www.3ds.com/xsd/3DXML ./3DXMLMesh.xsd");
+
+		outStream.writeStartElement("Root"); // Root
+		outStream.writeAttribute("xsi:type", "BagRepType");
+		outStream.writeAttribute("id", QString::number(task.m_FirstId));
+		const int meshCount= task.m_Meshes.size();
+		for (int i= 0; i < meshCount; ++i)
 		{
-			positions.append(QString::number(positionVector.at(i)));
-			positions.append(' ');
-			positions.append(QString::number(positionVector.at(i + 1)));
-			positions.append(' ');
-			positions.append(QString::number(positionVector.at(i + 2)));
-			positions.append(", ");
+			writeGeometry(&outStream, task.m_Meshes.at(i), task.m_FirstId + 1 + i, task.m_ExportMaterial);
 		}
-		positions.remove(positions.size() - 2, 2);
-		m_pOutStream->writeTextElement("Positions", positions);
+		outStream.writeEndElement(); // Root
+
+		outStream.writeEndElement(); // XMLRepresentation
+
+		outStream.writeEndDocument();
 	}
+	// The copy of the meshes is no more needed
+	task.m_Meshes.clear();
+	task.m_Size= content.size();
+
+	if (!task.m_IsCompressed)
 	{
-		// Get normals
-		GLfloatVector normalVector= pMesh->normalVector();
-		QString normals;
-		const int size= normalVector.size();
-		for (int i= 0; i < size; i+=3)
-		{
-			normals.append(QString::number(normalVector.at(i)));
-			normals.append(' ');
-			normals.append(QString::number(normalVector.at(i + 1)));
-			normals.append(' ');
-			normals.append(QString::number(normalVector.at(i + 2)));
-			normals.append(", ");
-		}
-		normals.remove(normals.size() - 2, 2);
-		m_pOutStream->writeTextElement("Normals", normals);
+		task.m_Data= content;
+		return;
 	}
+
+	// Deflate the content as QuaZip does, it is written raw in the archive
+	task.m_Crc= static_cast<quint32>(crc32(0L, reinterpret_cast<const Bytef*>(content.constData()), static_cast<uInt>(content.size())));
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	int result= deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+	if (Z_OK == result)
 	{
-		// Get texture coordinates
-		GLfloatVector texelVector= pMesh->texelVector();
-		if (!texelVector.isEmpty())
+		stream.next_in= reinterpret_cast<Bytef*>(content.data());
+		stream.avail_in= static_cast<uInt>(content.size());
+		task.m_Data.resize(static_cast<int>(deflateBound(&stream, static_cast<uLong>(content.size()))) + 64);
+		while (Z_OK == result)
 		{
-			QString texels;
-			const int size= texelVector.size();
-			for (int i= 0; i < size; i+=2)
+			if (static_cast<int>(stream.total_out) == task.m_Data.size())
 			{
-				texels.append(QString::number(texelVector.at(i)));
-				texels.append(' ');
-				texels.append(QString::number(texelVector.at(i + 1)));
-				texels.append(", ");
+				task.m_Data.resize(task.m_Data.size() * 2);
 			}
-			texels.remove(texels.size() - 2, 2);
-
-			m_pOutStream->writeStartElement("TextureCoordinates");
-			m_pOutStream->writeAttribute("dimension", "2D");
-			m_pOutStream->writeAttribute("channel", "0");
-			m_pOutStream->writeCharacters(texels);
-			m_pOutStream->writeEndElement(); // TexturesCoordinates
+			stream.next_out= reinterpret_cast<Bytef*>(task.m_Data.data()) + stream.total_out;
+			stream.avail_out= static_cast<uInt>(task.m_Data.size() - static_cast<int>(stream.total_out));
+			result= deflate(&stream, Z_FINISH);
 		}
+		deflateEnd(&stream);
 	}
 
-
-	m_pOutStream->writeEndElement(); // VertexBuffer
-	m_pOutStream->writeEndElement(); // Rep
-
+	if (Z_STREAM_END == result)
+	{
+		task.m_Data.resize(static_cast<int>(stream.total_out));
+	}
+	else
+	{
+		// The error is reported by the writer of the file
+		task.m_Data.clear();
+		task.m_Size= -1;
+	}
 }
-void GLC_WorldTo3dxml::writeGeometryFace(const GLC_Mesh* pMesh, int lod, GLC_uint materialId)
+
+void GLC_WorldTo3dxml::writeRepFile(const RepTask& task)
 {
-	m_pOutStream->writeStartElement("Face");
-	if (pMesh->containsTriangles(lod, materialId))
+	delete m_pOutStream;
+	m_pOutStream= NULL;
+
+	bool success= (task.m_Size >= 0);
+	if (success && (NULL != m_p3dxmlArchive))
 	{
-		QVector<GLuint> triangleIndex= pMesh->getTrianglesIndex(lod, materialId);
-		QString indexString;
-		const int indexSize= triangleIndex.size();
-		for (int index= 0; index < indexSize; ++index)
+		if (NULL != m_pCurrentZipFile)
 		{
-			indexString.append(QString::number(triangleIndex.at(index)));
-			indexString.append(' ');
+			m_pCurrentZipFile->close();
+			delete m_pCurrentZipFile;
 		}
-		indexString.remove(indexString.size() - 1, 1);
-		m_pOutStream->writeAttribute("triangles", indexString);
-	}
-	if (pMesh->containsStrips(lod, materialId))
-	{
-		QList<QVector<GLuint> > stripsIndex= pMesh->getStripsIndex(lod, materialId);
-		QString indexStrips;
-		const int stripCount= stripsIndex.size();
-		for (int stripIndex= 0; stripIndex < stripCount; ++stripIndex)
+		QuaZipNewInfo quazipNewInfo(task.m_FileName);
+		quazipNewInfo.uncompressedSize= static_cast<ulong>(task.m_Size);
+		m_pCurrentZipFile= new QuaZipFile(m_p3dxmlArchive);
+		success= m_pCurrentZipFile->open(QIODevice::WriteOnly, quazipNewInfo, NULL, task.m_Crc, Z_DEFLATED, Z_DEFAULT_COMPRESSION, true);
+		success= success && (m_pCurrentZipFile->write(task.m_Data) == task.m_Data.size());
+		if (success)
 		{
-			QVector<GLuint> currentStripIndex= stripsIndex.at(stripIndex);
-			QString currentIndex;
-			const int indexSize= currentStripIndex.size();
-			for (int index= 0; index < indexSize; ++index)
-			{
-				currentIndex.append(QString::number(currentStripIndex.at(index)));
-				currentIndex.append(' ');
-			}
-			currentIndex.remove(currentIndex.size() - 1, 1);
-			indexStrips.append(currentIndex);
-			indexStrips.append(',');
+			m_pCurrentZipFile->close();
+			success= (ZIP_OK == m_pCurrentZipFile->getZipError());
 		}
-		indexStrips.remove(indexStrips.size() - 1, 1);
-		m_pOutStream->writeAttribute("strips", indexStrips);
+		delete m_pCurrentZipFile;
+		m_pCurrentZipFile= NULL;
+	}
+	else if (success)
+	{
+		delete m_pCurrentFile;
+		m_pCurrentFile= new QFile(m_AbsolutePath + task.m_FileName);
+		success= m_pCurrentFile->open(QIODevice::WriteOnly);
+		success= success && (m_pCurrentFile->write(task.m_Data) == task.m_Data.size());
+		m_pCurrentFile->close();
+	}
+
+	if (!success)
+	{
+		QString message(QString("GLC_WorldTo3dxml::writeRepFile Unable to create ") + task.m_FileName);
+		GLC_Exception fileException(message);
+		throw(fileException);
 	}
-	if (pMesh->containsFans(lod, materialId))
+}
+
+void GLC_WorldTo3dxml::writeGeometry(QXmlStreamWriter* pOutStream, const RepMesh& mesh, unsigned int id, bool exportMaterial)
+{
+	pOutStream->writeStartElement("Rep");
+	pOutStream->writeAttribute("xsi:type", "PolygonalRepType");
+	pOutStream->writeAttribute("id", QString::number(id));
+	const double masterAccuracy= mesh.m_Lods.first().m_Accuracy;
+	pOutStream->writeAttribute("accuracy", QString::number(masterAccuracy));
+	pOutStream->writeAttribute("solid", "1");
+	const int lodCount= mesh.m_Lods.size();
+	if (lodCount > 1)
 	{
-		QList<QVector<GLuint> > fansIndex= pMesh->getFansIndex(lod, materialId);
-		QString indexFans;
-		const int fanCount= fansIndex.size();
-		for (int fanIndex= 0; fanIndex < fanCount; ++fanIndex)
+		// The mesh contains LOD
+		for (int i= 1; i < lodCount; ++i)
 		{
-			QVector<GLuint> currentFanIndex= fansIndex.at(fanIndex);
-			QString currentIndex;
-			const int indexSize= currentFanIndex.size();
-			for (int index= 0; index < indexSize; ++index)
+			const RepLod& lod= mesh.m_Lods.at(i);
+			pOutStream->writeStartElement("PolygonalLOD");
+			pOutStream->writeAttribute("accuracy", QString::number(lod.m_Accuracy));
+			pOutStream->writeStartElement("Faces");
+			const int faceCount= lod.m_Faces.size();
+			for (int face= 0; face < faceCount; ++face)
 			{
-				currentIndex.append(QString::number(currentFanIndex.at(index)));
-				currentIndex.append(' ');
+				writeGeometryFace(pOutStream, lod.m_Faces.at(face), exportMaterial);
 			}
-			currentIndex.remove(currentIndex.size() - 1, 1);
-			indexFans.append(currentIndex);
-			indexFans.append(',');
+			pOutStream->writeEndElement(); // Faces
+			pOutStream->writeEndElement(); // PolygonalLOD
 		}
-		indexFans.remove(indexFans.size() - 1, 1);
-		m_pOutStream->writeAttribute("fans", indexFans);
 	}
 
-	writeSurfaceAttributes(pMesh->material(materialId));
+	// Master LOD
+	pOutStream->writeStartElement("Faces");
+	const QList<RepFace>& masterFaces= mesh.m_Lods.first().m_Faces;
+	const int masterFaceCount= masterFaces.size();
+	for (int face= 0; face < masterFaceCount; ++face)
+	{
+		writeGeometryFace(pOutStream, masterFaces.at(face), exportMaterial);
+	}
+	pOutStream->writeEndElement(); // Faces
+	if (!mesh.m_WirePositions.isEmpty())
+	{
+		writeEdges(pOutStream, mesh);
+	}
+
+	// Save Bulk data
+	pOutStream->writeStartElement("VertexBuffer");
+	pOutStream->writeTextElement("Positions", floatsText(mesh.m_Positions.constData(), mesh.m_Positions.size(), 3, ", "));
+	pOutStream->writeTextElement("Normals", floatsText(mesh.m_Normals.constData(), mesh.m_Normals.size(), 3, ", "));
+	if (!mesh.m_Texels.isEmpty())
+	{
+		pOutStream->writeStartElement("TextureCoordinates");
+		pOutStream->writeAttribute("dimension", "2D");
+		pOutStream->writeAttribute("channel", "0");
+		pOutStream->writeCharacters(floatsText(mesh.m_Texels.constData(), mesh.m_Texels.size(), 2, ", "));
+		pOutStream->writeEndElement(); // TexturesCoordinates
+	}
 
-	m_pOutStream->writeEndElement(); // Face
+	pOutStream->writeEndElement(); // VertexBuffer
+	pOutStream->writeEndElement(); // Rep
 
 }
+void GLC_WorldTo3dxml::writeGeometryFace(QXmlStreamWriter* pOutStream, const RepFace& face, bool exportMaterial)
+{
+	pOutStream->writeStartElement("Face");
+	if (!face.m_Triangles.isEmpty())
+	{
+		pOutStream->writeAttribute("triangles", indexText(face.m_Triangles));
+	}
+	if (!face.m_Strips.isEmpty())
+	{
+		pOutStream->writeAttribute("strips", indexListText(face.m_Strips));
+	}
+	if (!face.m_Fans.isEmpty())
+	{
+		pOutStream->writeAttribute("fans", indexListText(face.m_Fans));
+	}
+
+	writeSurfaceAttributes(pOutStream, face, exportMaterial);
+
+	pOutStream->writeEndElement(); // Face
 
-void GLC_WorldTo3dxml::writeSurfaceAttributes(const GLC_Material* pMaterial)
+}
+
+void GLC_WorldTo3dxml::writeSurfaceAttributes(QXmlStreamWriter* pOutStream, const RepFace& face, bool exportMaterial)
 {
-	QColor diffuseColor= pMaterial->diffuseColor();
-	m_pOutStream->writeStartElement("SurfaceAttributes");
-	if (m_ExportMaterial)
+	const QColor& diffuseColor= face.m_DiffuseColor;
+	pOutStream->writeStartElement("SurfaceAttributes");
+	if (exportMaterial)
 	{
-		const QString material3dxmlId=(QString::number(m_MaterialIdToMaterialId.value(pMaterial->id())));
-		m_pOutStream->writeStartElement("MaterialApplication");
-			m_pOutStream->writeAttribute("xsi:type", "MaterialApplicationType");
-			m_pOutStream->writeAttribute("mappingChannel", "0");
-			m_pOutStream->writeStartElement("MaterialId");
-				m_pOutStream->writeAttribute("id", "urn:3DXML:CATMaterialRef.3dxml#" + material3dxmlId);
-			m_pOutStream->writeEndElement(); // MaterialId
-		m_pOutStream->writeEndElement(); // MaterialApplication
+		const QString material3dxmlId(QString::number(face.m_MaterialId));
+		pOutStream->writeStartElement("MaterialApplication");
+			pOutStream->writeAttribute("xsi:type", "MaterialApplicationType");
+			pOutStream->writeAttribute("mappingChannel", "0");
+			pOutStream->writeStartElement("MaterialId");
+				pOutStream->writeAttribute("id", "urn:3DXML:CATMaterialRef.3dxml#" + material3dxmlId);
+			pOutStream->writeEndElement(); // MaterialId
+		pOutStream->writeEndElement(); // MaterialApplication
 	}
 	else
 	{
-		m_pOutStream->writeStartElement("Color");
-			m_pOutStream->writeAttribute("xsi:type", "RGBAColorType");
-			m_pOutStream->writeAttribute("red", QString::number(diffuseColor.redF()));
-			m_pOutStream->writeAttribute("green", QString::number(diffuseColor.greenF()));
-			m_pOutStream->writeAttribute("blue", QString::number(diffuseColor.blueF()));
-			m_pOutStream->writeAttribute("alpha", QString::number(diffuseColor.alphaF()));
-		m_pOutStream->writeEndElement(); // Color
+		pOutStream->writeStartElement("Color");
+			pOutStream->writeAttribute("xsi:type", "RGBAColorType");
+			pOutStream->writeAttribute("red", QString::number(diffuseColor.redF()));
+			pOutStream->writeAttribute("green", QString::number(diffuseColor.greenF()));
+			pOutStream->writeAttribute("blue", QString::number(diffuseColor.blueF()));
+			pOutStream->writeAttribute("alpha", QString::number(diffuseColor.alphaF()));
+		pOutStream->writeEndElement(); // Color
 	}
-	m_pOutStream->writeEndElement(); // SurfaceAttributes
+	pOutStream->writeEndElement(); // SurfaceAttributes
 }
 
-void GLC_WorldTo3dxml::writeEdges(const GLC_Mesh* pMesh)
+void GLC_WorldTo3dxml::writeEdges(QXmlStreamWriter* pOutStream, const RepMesh& mesh)
 {
-	m_pOutStream->writeStartElement("Edges");
-	writeLineAttributes(pMesh->wireColor());
+	pOutStream->writeStartElement("Edges");
+	writeLineAttributes(pOutStream, mesh.m_WireColor);
 
-	GLfloatVector positionVector= pMesh->wirePositionVector();
-	const int polylineCount= pMesh->wirePolylineCount();
+	const int polylineCount= mesh.m_WireOffsets.size();
 	for (int i= 0; i < polylineCount; ++i)
 	{
-		m_pOutStream->writeStartElement("Polyline");
-		QString polylinePosition;
-		const GLuint offset= pMesh->wirePolylineOffset(i);
-		const GLsizei size= pMesh->wirePolylineSize(i);
-		for (GLsizei index= 0; index < size; ++index)
+		pOutStream->writeStartElement("Polyline");
+		const GLfloat* pPositions= mesh.m_WirePositions.constData() + 3 * mesh.m_WireOffsets.at(i);
+		pOutStream->writeAttribute("vertices", floatsText(pPositions, 3 * mesh.m_WireSizes.at(i), 3, ","));
+		pOutStream->writeEndElement(); // Polyline
+	}
+	pOutStream->writeEndElement(); // Edges
+}
+
+void GLC_WorldTo3dxml::writeLineAttributes(QXmlStreamWriter* pOutStream, const QColor& color)
+{
+	pOutStream->writeStartElement("LineAttributes");
+	pOutStream->writeAttribute("lineType", "SOLID");
+	pOutStream->writeAttribute("thickness", "1");
+		pOutStream->writeStartElement("Color");
+			pOutStream->writeAttribute("xsi:type", "RGBAColorType");
+			pOutStream->writeAttribute("red", QString::number(color.redF()));
+			pOutStream->writeAttribute("green", QString::number(color.greenF()));
+			pOutStream->writeAttribute("blue", QString::number(color.blueF()));
+			pOutStream->writeAttribute("alpha", QString::number(color.alphaF()));
+		pOutStream->writeEndElement(); // Color
+	pOutStream->writeEndElement(); // LineAttributes
+}
+
+QString GLC_WorldTo3dxml::floatsText(const GLfloat* pValues, int count, int tupleSize, const char* pSeparator)
+{
+	const int separatorLength= static_cast<int>(strlen(pSeparator));
+	QByteArray text;
+	text.resize(count * (glc::numericTextMaxLength + separatorLength));
+	char* pBegin= text.data();
+	char* p= pBegin;
+	for (int i= 0; i < count; ++i)
+	{
+		if (0 != i)
 		{
-			const int startIndex= 3 * (offset + index);
-			polylinePosition.append(QString::number(positionVector.at(startIndex)));
-			polylinePosition.append(' ');
-			polylinePosition.append(QString::number(positionVector.at(startIndex + 1)));
-			polylinePosition.append(' ');
-			polylinePosition.append(QString::number(positionVector.at(startIndex + 2)));
-			polylinePosition.append(',');
+			if (0 == (i % tupleSize))
+			{
+				memcpy(p, pSeparator, separatorLength);
+				p+= separatorLength;
+			}
+			else
+			{
+				*p++= ' ';
+			}
 		}
-		polylinePosition.remove(polylinePosition.size() - 1, 1);
-		m_pOutStream->writeAttribute("vertices", polylinePosition);
-		m_pOutStream->writeEndElement(); // Polyline
+		p+= glc::formatFloat(pValues[i], p);
 	}
-	m_pOutStream->writeEndElement(); // Edges
+
+	return QString::fromLatin1(pBegin, static_cast<int>(p - pBegin));
+}
+
+QString GLC_WorldTo3dxml::indexText(const QVector<GLuint>& index)
+{
+	const int count= index.size();
+	QByteArray text;
+	text.resize(count * (glc::numericTextMaxLength + 1));
+	char* pBegin= text.data();
+	char* p= pBegin;
+	for (int i= 0; i < count; ++i)
+	{
+		if (0 != i) *p++= ' ';
+		p+= glc::formatUInt(index.at(i), p);
+	}
+
+	return QString::fromLatin1(pBegin, static_cast<int>(p - pBegin));
 }
 
-void GLC_WorldTo3dxml::writeLineAttributes(const QColor& color)
+QString GLC_WorldTo3dxml::indexListText(const QList<QVector<GLuint> >& indexList)
 {
-	m_pOutStream->writeStartElement("LineAttributes");
-	m_pOutStream->writeAttribute("lineType", "SOLID");
-	m_pOutStream->writeAttribute("thickness", "1");
-		m_pOutStream->writeStartElement("Color");
-			m_pOutStream->writeAttribute("xsi:type", "RGBAColorType");
-			m_pOutStream->writeAttribute("red", QString::number(color.redF()));
-			m_pOutStream->writeAttribute("green", QString::number(color.greenF()));
-			m_pOutStream->writeAttribute("blue", QString::number(color.blueF()));
-			m_pOutStream->writeAttribute("alpha", QString::number(color.alphaF()));
-		m_pOutStream->writeEndElement(); // Color
-	m_pOutStream->writeEndElement(); // LineAttributes
+	QString text;
+	const int listCount= indexList.size();
+	for (int i= 0; i < listCount; ++i)
+	{
+		if (0 != i) text.append(',');
+		text.append(indexText(indexList.at(i)));
+	}
+
+	return text;
 }
 
 void GLC_WorldTo3dxml::writeMaterial(const GLC_Material* pMaterial)
@@ -25,6 +25,10 @@
 #define GLC_WORLDTO3DXML_H_
 #include <QObject>
 #include <QXmlStreamWriter>
+#include <QVector>
+#include <QList>
+#include <QColor>
+#include <QByteArray>
 
 #include "../sceneGraph/glc_world.h"
 #include "../glc_config.h"
@@ -40,6 +44,13 @@ class GLC_Mesh;
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_WorldTo3dxml
 /*! \brief GLC_WorldTo3dxml : Export a GLC_World to a 3dxml file */
+
+/*! The meshes of a 3DRep are copied by the exporting thread, which owns the OpenGL
+ *  context if their data are in VBO, then the 3DRep is formatted and deflated in memory.
+ *  If GLC_State::isParallelExportActivated() is true, batches of 3DRep are formatted
+ *  and deflated by QtConcurrent workers while the previous batch is written in order
+ *  by the exporting thread, the written files are the same.
+ */
 //////////////////////////////////////////////////////////////////////
 class GLC_LIB_EXPORT GLC_WorldTo3dxml : public QObject
 {
@@ -80,6 +91,79 @@ public:
 	void setInterupt(QReadWriteLock* pReadWriteLock, bool* pInterupt);
 //@}
 
+//////////////////////////////////////////////////////////////////////
+	/* Private types */
+//////////////////////////////////////////////////////////////////////
+private:
+	//! \struct RepFace
+	/*! \brief RepFace : A face of a mesh LOD written in a 3DRep */
+	struct RepFace
+	{
+		//! The triangles index
+		QVector<GLuint> m_Triangles;
+		//! The strips index
+		QList<QVector<GLuint> > m_Strips;
+		//! The fans index
+		QList<QVector<GLuint> > m_Fans;
+		//! The 3DXML id of the material
+		unsigned int m_MaterialId;
+		//! The diffuse color of the material
+		QColor m_DiffuseColor;
+	};
+
+	//! \struct RepLod
+	/*! \brief RepLod : A LOD of a mesh written in a 3DRep */
+	struct RepLod
+	{
+		//! The LOD accuracy
+		double m_Accuracy;
+		//! The faces of the LOD, one by material
+		QList<RepFace> m_Faces;
+	};
+
+	//! \struct RepMesh
+	/*! \brief RepMesh : A mesh written in a 3DRep */
+	struct RepMesh
+	{
+		//! The LODs, the master LOD first
+		QList<RepLod> m_Lods;
+		//! The vertex buffer
+		GLfloatVector m_Positions;
+		GLfloatVector m_Normals;
+		GLfloatVector m_Texels;
+		//! The wire positions
+		GLfloatVector m_WirePositions;
+		//! The offset and size of each wire polyline
+		QVector<GLuint> m_WireOffsets;
+		QVector<GLsizei> m_WireSizes;
+		//! The wire color
+		QColor m_WireColor;
+	};
+
+	//! \struct RepTask
+	/*! \brief RepTask : A 3DRep formatted by a worker thread */
+	struct RepTask
+	{
+		//! The 3DRep file name
+		QString m_FileName;
+		//! The 3DXML id of the 3DRep root, the meshes use the following ids
+		unsigned int m_FirstId;
+		//! Flag to know if material are exported
+		bool m_ExportMaterial;
+		//! Flag to know if the content is deflated
+		bool m_IsCompressed;
+		//! The meshes of the 3DRep
+		QList<RepMesh> m_Meshes;
+		//! The number of values of the meshes
+		int m_ValueCount;
+		//! Result : the content of the file, deflated if m_IsCompressed is true
+		QByteArray m_Data;
+		//! Result : the CRC 32 of the uncompressed content
+		quint32 m_Crc;
+		//! Result : the size of the uncompressed content
+		qint64 m_Size;
+	};
+
 //////////////////////////////////////////////////////////////////////
 /*! @name Private services functions */
 //@{
@@ -119,23 +203,51 @@ private:
 	//! Write the given 3DRep to 3DXML 3DRep
 	void write3DRep(const GLC_3DRep* pRep, const QString& fileName);
 
+	//! Write the 3DRep of the list of reference rep, formatted by batches on worker threads
+	void write3DRepInParallel();
+
+	//! Emit the progress of the given number of written 3DRep
+	void emitRepProgress(int writtenRepCount, int* pPreviousQuantumValue);
+
 	//! Return the file name of the given 3DRep
 	QString representationFileName(const GLC_3DRep* pRep);
 
-	//! Write the given mesh to 3DXML 3DRep
-	void writeGeometry(const GLC_Mesh* pMesh);
+	//! Return the task formatting the given 3DRep in the given file name
+	/*! The meshes are copied and the 3DXML ids of the 3DRep are reserved*/
+	RepTask repTask(const GLC_3DRep* pRep, const QString& fileName);
+
+	//! Return the copy of the given mesh written in a 3DRep
+	RepMesh repMesh(const GLC_Mesh* pMesh) const;
 
-	//! Write the geometry face from the given lod and material
-	void writeGeometryFace(const GLC_Mesh* pMesh, int lod, GLC_uint materialId);
+	//! Format the 3DRep of the given task and deflate it if needed
+	static void formatRepTask(RepTask& task);
 
-	//! Write surface attributes
-	void writeSurfaceAttributes(const GLC_Material* pMaterial);
+	//! Write the content of the given formatted task in its file
+	void writeRepFile(const RepTask& task);
 
-	//! Write edges
-	void writeEdges(const GLC_Mesh* pMesh);
+	//! Write the given mesh with the given id to 3DXML 3DRep
+	static void writeGeometry(QXmlStreamWriter* pOutStream, const RepMesh& mesh, unsigned int id, bool exportMaterial);
+
+	//! Write the given geometry face
+	static void writeGeometryFace(QXmlStreamWriter* pOutStream, const RepFace& face, bool exportMaterial);
+
+	//! Write surface attributes of the given face
+	static void writeSurfaceAttributes(QXmlStreamWriter* pOutStream, const RepFace& face, bool exportMaterial);
+
+	//! Write edges of the given mesh
+	static void writeEdges(QXmlStreamWriter* pOutStream, const RepMesh& mesh);
 
 	//! Write lines attributes
-	void writeLineAttributes(const QColor& color);
+	static void writeLineAttributes(QXmlStreamWriter* pOutStream, const QColor& color);
+
+	//! Return the text of the given floats, the tuples of the given size are separated by the given separator
+	static QString floatsText(const GLfloat* pValues, int count, int tupleSize, const char* pSeparator);
+
+	//! Return the text of the given index separated by spaces
+	static QString indexText(const QVector<GLuint>& index);
+
+	//! Return the text of the given index lists separated by comma
+	static QString indexListText(const QList<QVector<GLuint> >& indexList);
 
 	//! Write Material
 	void writeMaterial(const GLC_Material* pMaterial);
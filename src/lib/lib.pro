@@ -1,6 +1,6 @@
 # GLC_lib qmake configuration
 TEMPLATE = lib
-QT += core opengl quick
+QT += core opengl quick concurrent
 
 win32 {
     LIBS += -lopengl32
@@ -100,7 +100,8 @@ HEADERS_GLC_IO +=   io/glc_objmtlloader.h \
                     io/glc_fileloader.h \
                     io/glc_worldreaderplugin.h \
                     io/glc_worldreaderhandler.h \
-                    io/glc_worldtoobj.h
+                    io/glc_worldtoobj.h \
+                    io/glc_numericparser.h
 
 HEADERS_GLC_SCENEGRAPH +=   sceneGraph/glc_3dviewcollection.h \
                             sceneGraph/glc_3dviewinstance.h \
@@ -113,7 +114,15 @@ HEADERS_GLC_SCENEGRAPH +=   sceneGraph/glc_3dviewcollection.h \
                             sceneGraph/glc_spacepartitioning.h \
                             sceneGraph/glc_octree.h \
                             sceneGraph/glc_octreenode.h \
-                            sceneGraph/glc_selectionset.h
+                            sceneGraph/glc_selectionset.h \
+                            sceneGraph/glc_repstreamer.h \
+                            sceneGraph/glc_raypicker.h \
+                            sceneGraph/glc_frustumselector.h \
+                            sceneGraph/glc_renderqueue.h \
+                            sceneGraph/glc_bvhpartitioning.h \
+                            sceneGraph/glc_transformtable.h \
+                            sceneGraph/glc_occlusionculler.h \
+                            sceneGraph/glc_sectionengine.h
 							
 HEADERS_GLC_GEOMETRY += geometry/glc_geometry.h \
                         geometry/glc_circle.h \
@@ -123,6 +132,10 @@ HEADERS_GLC_GEOMETRY += geometry/glc_geometry.h \
                         geometry/glc_meshdata.h \
                         geometry/glc_primitivegroup.h \
                         geometry/glc_mesh.h \
+                        geometry/glc_meshsimplifier.h \
+                        geometry/glc_vertexcacheoptimizer.h \
+                        geometry/glc_bvh.h \
+                        geometry/glc_meshbvh.h \
                         geometry/glc_lod.h \
                         geometry/glc_rectangle.h \
                         geometry/glc_line.h \
@@ -141,6 +154,7 @@ HEADERS_GLC_GEOMETRY += geometry/glc_geometry.h \
 
 HEADERS_GLC_SHADING +=  shading/glc_material.h \
                         shading/glc_texture.h \
+                        shading/glc_textureimage.h \
                         shading/glc_shader.h \
                         shading/glc_selectionmaterial.h \
                         shading/glc_light.h \
@@ -161,6 +175,7 @@ HEADERS_GLC_VIEWPORT +=	viewport/glc_camera.h \
                         viewport/glc_settargetmover.h \
                         viewport/glc_turntablemover.h \
                         viewport/glc_frustum.h \
+                        viewport/glc_frustumculler.h \
                         viewport/glc_flymover.h \
                         viewport/glc_repflymover.h \
                         viewport/glc_userinput.h \
@@ -182,6 +197,7 @@ HEADERS_GLC += glc_global.h \
                glc_config.h \
                glc_cachemanager.h \
                glc_renderstatistics.h \
+               glc_frameprofiler.h \
                glc_log.h \
                glc_errorlog.h \
                glc_tracelog.h \
@@ -206,7 +222,8 @@ HEADERS_GLC_QML +=      qml/glc_quickitem.h \
                         qml/glc_quickview.h \
                         qml/glc_quickcamera.h \
                         qml/glc_quickoccurrence.h \
-                        qml/glc_quickselection.h
+                        qml/glc_quickselection.h \
+                        qml/glc_quickprofiler.h
 
 HEADERS += $${HEADERS_QUAZIP} $${HEADERS_LIB3DS} $${HEADERS_GLC_MATHS} $${HEADERS_GLC_IO}
 HEADERS += $${HEADERS_GLC} $${HEADERS_GLEXT} $${HEADERS_GLC_SCENEGRAPH} $${HEADERS_GLC_GEOMETRY}
@@ -276,7 +293,8 @@ SOURCES +=	io/glc_objmtlloader.cpp \
                 io/glc_worldto3ds.cpp \
                 io/glc_bsreptoworld.cpp \
                 io/glc_fileloader.cpp \
-                io/glc_worldtoobj.cpp
+                io/glc_worldtoobj.cpp \
+                io/glc_numericparser.cpp
 
 SOURCES +=	sceneGraph/glc_3dviewcollection.cpp \
                 sceneGraph/glc_3dviewinstance.cpp \
@@ -289,6 +307,14 @@ SOURCES +=	sceneGraph/glc_3dviewcollection.cpp \
                 sceneGraph/glc_octree.cpp \
                 sceneGraph/glc_octreenode.cpp \
                 sceneGraph/glc_selectionset.cpp \
+                sceneGraph/glc_repstreamer.cpp \
+                sceneGraph/glc_raypicker.cpp \
+                sceneGraph/glc_frustumselector.cpp \
+                sceneGraph/glc_renderqueue.cpp \
+                sceneGraph/glc_bvhpartitioning.cpp \
+                sceneGraph/glc_transformtable.cpp \
+                sceneGraph/glc_occlusionculler.cpp \
+                sceneGraph/glc_sectionengine.cpp \
                 sceneGraph/glc_structoccurrence.cpp
 
 SOURCES +=	geometry/glc_geometry.cpp \
@@ -299,6 +325,10 @@ SOURCES +=	geometry/glc_geometry.cpp \
                 geometry/glc_meshdata.cpp \
                 geometry/glc_primitivegroup.cpp \
                 geometry/glc_mesh.cpp \
+                geometry/glc_meshsimplifier.cpp \
+                geometry/glc_vertexcacheoptimizer.cpp \
+                geometry/glc_bvh.cpp \
+                geometry/glc_meshbvh.cpp \
                 geometry/glc_lod.cpp \
                 geometry/glc_rectangle.cpp \
                 geometry/glc_line.cpp \
@@ -318,6 +348,7 @@ SOURCES +=	geometry/glc_geometry.cpp \
 
 SOURCES +=	shading/glc_material.cpp \
                 shading/glc_texture.cpp \
+                shading/glc_textureimage.cpp \
                 shading/glc_light.cpp \
                 shading/glc_selectionmaterial.cpp \
                 shading/glc_shader.cpp \
@@ -338,6 +369,7 @@ SOURCES +=	viewport/glc_camera.cpp \
                 viewport/glc_settargetmover.cpp \
                 viewport/glc_turntablemover.cpp \
                 viewport/glc_frustum.cpp \
+                viewport/glc_frustumculler.cpp \
                 viewport/glc_flymover.cpp \
                 viewport/glc_repflymover.cpp \
                 viewport/glc_userinput.cpp \
@@ -359,6 +391,7 @@ SOURCES +=	glc_global.cpp \
                 glc_state.cpp \
                 glc_cachemanager.cpp \
                 glc_renderstatistics.cpp \
+                glc_frameprofiler.cpp \
                 glc_log.cpp \
                 glc_errorlog.cpp \
                 glc_tracelog.cpp \
@@ -383,7 +416,8 @@ SOURCES +=      qml/glc_quickitem.cpp \
                 qml/glc_quickview.cpp \
                 qml/glc_quickcamera.cpp \
                 qml/glc_quickoccurrence.cpp \
-                qml/glc_quickselection.cpp
+                qml/glc_quickselection.cpp \
+                qml/glc_quickprofiler.cpp
 
 # Windows compilation configuration
 win32:CONFIG *= dll
@@ -414,6 +448,7 @@ HEADERS_INST = GLC_BoundingBox \
                GLC_Point3d \
                GLC_Point3df \
                GLC_Texture \
+               GLC_TextureImage \
                GLC_Vector2d \
                GLC_Vector2df \
                GLC_Vector3d \
@@ -436,6 +471,10 @@ HEADERS_INST = GLC_BoundingBox \
                GLC_Attributes \
                GLC_Rectangle \
                GLC_Mesh \
+               GLC_MeshSimplifier \
+               GLC_VertexCacheOptimizer \
+               GLC_Bvh \
+               GLC_MeshBvh \
                GLC_StructOccurrence \
                GLC_StructInstance \
                GLC_StructReference \
@@ -452,6 +491,7 @@ HEADERS_INST = GLC_BoundingBox \
                GLC_OctreeNode \
                GLC_Plane \
                GLC_Frustum \
+               GLC_FrustumCuller \
                GLC_GeomTools \
                GLC_Line3d \
                GLC_3DWidget \
@@ -469,6 +509,7 @@ HEADERS_INST = GLC_BoundingBox \
                GLC_WorldTo3dxml \
                GLC_WorldTo3ds \
                GLC_RenderStatistics \
+               GLC_FrameProfiler \
                GLC_Ext \
                GLC_Cone \
                GLC_Sphere \
@@ -483,6 +524,14 @@ HEADERS_INST = GLC_BoundingBox \
                GLC_WorldReaderHandler \
                GLC_PointCloud \
                GLC_SelectionSet \
+               GLC_RepStreamer \
+               GLC_RayPicker \
+               GLC_FrustumSelector \
+               GLC_RenderQueue \
+               GLC_BvhPartitioning \
+               GLC_TransformTable \
+               GLC_OcclusionCuller \
+               GLC_SectionEngine \
                GLC_UserInput \
                GLC_TsrMover \
                GLC_Glu \
@@ -497,7 +546,8 @@ HEADERS_INST = GLC_BoundingBox \
                GLC_ScreenShotSettings \
                GLC_QuickView \
                GLC_QuickCamera \
-               GLC_QuickOccurrence
+               GLC_QuickOccurrence \
+               GLC_QuickProfiler
 
 include (../../install.pri)
 
@@ -27,6 +27,7 @@
 #include "../glc_context.h"
 #include "../glc_exception.h"
 #include "../glc_factory.h"
+#include "../glc_frameprofiler.h"
 
 #include "glc_quickitem.h"
 
@@ -45,6 +46,7 @@ GLC_QuickItem::GLC_QuickItem(GLC_QuickItem *pParent)
     , m_pCamera(new GLC_QuickCamera(this))
     , m_Source()
     , m_pQuickSelection(new GLC_QuickSelection(this))
+    , m_pQuickProfiler(new GLC_QuickProfiler(this))
 {
     setAcceptedMouseButtons(Qt::LeftButton | Qt::RightButton | Qt::MidButton);
     setFlag(QQuickItem::ItemHasContents);
@@ -262,6 +264,12 @@ QSGNode* GLC_QuickItem::updatePaintNode(QSGNode* pNode, UpdatePaintNodeData* pDa
         m_Viewhandler->renderingFinished();
 
         glFinish();
+
+        // The profiler lives in the GUI thread
+        if (GLC_FrameProfiler::activated())
+        {
+            QMetaObject::invokeMethod(m_pQuickProfiler, "update", Qt::QueuedConnection);
+        }
     }
 
     return pTextureNode;
@@ -40,6 +40,7 @@
 #include "../maths/glc_vector3d.h"
 #include "glc_quickcamera.h"
 #include "glc_quickselection.h"
+#include "glc_quickprofiler.h"
 
 #include "../glc_config.h"
 
@@ -74,6 +75,9 @@ class GLC_LIB_EXPORT GLC_QuickItem : public QQuickItem
     //! Current selection
     Q_PROPERTY(GLC_QuickSelection* selection READ selection)
 
+    //! Frame profiler summary
+    Q_PROPERTY(GLC_QuickProfiler* profiler READ profiler)
+
 
 //////////////////////////////////////////////////////////////////////
 /*! @name Constructor / Destructor */
@@ -106,6 +110,9 @@ public:
     GLC_QuickSelection* selection() const
     {return m_pQuickSelection;}
 
+    GLC_QuickProfiler* profiler() const
+    {return m_pQuickProfiler;}
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -189,6 +196,8 @@ protected:
     QString m_Source;
 
     GLC_QuickSelection* m_pQuickSelection;
+
+    GLC_QuickProfiler* m_pQuickProfiler;
 };
 
 #endif // GLC_QUICKITEM_H
@@ -0,0 +1,73 @@
+/*
+ *  glc_quickprofiler.cpp
+ *
+ *  Created on: 17/10/2026
+ *      Author: Laurent Ribon
+ */
+
+#include <QUrl>
+
+#include "glc_quickprofiler.h"
+#include "../glc_frameprofiler.h"
+
+GLC_QuickProfiler::GLC_QuickProfiler(QObject *parent)
+    : QObject(parent)
+    , m_Summary()
+{
+}
+
+bool GLC_QuickProfiler::activated() const
+{
+    return GLC_FrameProfiler::activated();
+}
+
+int GLC_QuickProfiler::frameCapacity() const
+{
+    return GLC_FrameProfiler::frameCapacity();
+}
+
+bool GLC_QuickProfiler::exportChromeTrace(const QString &fileName) const
+{
+    // QML file dialogs give urls
+    QString localFileName(fileName);
+    const QUrl url(fileName);
+    if (url.isLocalFile())
+    {
+        localFileName= url.toLocalFile();
+    }
+    return GLC_FrameProfiler::exportChromeTrace(localFileName);
+}
+
+void GLC_QuickProfiler::setActivated(bool arg)
+{
+    if (arg != GLC_FrameProfiler::activated())
+    {
+        GLC_FrameProfiler::setActivationFlag(arg);
+        emit activatedChanged(arg);
+    }
+}
+
+void GLC_QuickProfiler::setFrameCapacity(int arg)
+{
+    if ((arg > 0) && (arg != GLC_FrameProfiler::frameCapacity()))
+    {
+        GLC_FrameProfiler::setFrameCapacity(arg);
+        emit frameCapacityChanged(arg);
+    }
+}
+
+void GLC_QuickProfiler::reset()
+{
+    GLC_FrameProfiler::reset();
+    m_Summary.clear();
+    emit summaryChanged();
+}
+
+void GLC_QuickProfiler::update()
+{
+    if (GLC_FrameProfiler::activated())
+    {
+        m_Summary= GLC_FrameProfiler::summary();
+        emit summaryChanged();
+    }
+}
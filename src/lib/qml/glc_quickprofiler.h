@@ -0,0 +1,54 @@
+/*
+ *  glc_quickprofiler.h
+ *
+ *  Created on: 17/10/2026
+ *      Author: Laurent Ribon
+ */
+
+#ifndef GLC_QUICKPROFILER_H
+#define GLC_QUICKPROFILER_H
+
+#include <QObject>
+#include <QVariantMap>
+
+#include "../glc_config.h"
+
+//! Expose the GLC_FrameProfiler summary of the last frame to QML
+class GLC_LIB_EXPORT GLC_QuickProfiler : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool activated READ activated WRITE setActivated NOTIFY activatedChanged)
+    Q_PROPERTY(int frameCapacity READ frameCapacity WRITE setFrameCapacity NOTIFY frameCapacityChanged)
+    Q_PROPERTY(QVariantMap summary READ summary NOTIFY summaryChanged)
+
+public:
+    explicit GLC_QuickProfiler(QObject *parent = 0);
+
+public:
+    bool activated() const;
+    int frameCapacity() const;
+
+    QVariantMap summary() const
+    {return m_Summary;}
+
+    Q_INVOKABLE bool exportChromeTrace(const QString& fileName) const;
+
+signals:
+    void activatedChanged(bool arg);
+    void frameCapacityChanged(int arg);
+    void summaryChanged();
+
+public slots:
+    void setActivated(bool arg);
+    void setFrameCapacity(int arg);
+    void reset();
+
+    //! Read the summary of the last frame from the profiler
+    void update();
+
+private:
+    QVariantMap m_Summary;
+};
+
+#endif // GLC_QUICKPROFILER_H
@@ -33,6 +33,7 @@
 #include "glc_spacepartitioning.h"
 #include "../glc_context.h"
 #include "../glc_contextmanager.h"
+#include "../glc_frameprofiler.h"
 
 #include <QtDebug>
 
@@ -52,6 +53,11 @@ GLC_3DViewCollection::GLC_3DViewCollection()
 , m_pSpacePartitioning(NULL)
 , m_UseSpacePartitioning(false)
 , m_IsViewable(true)
+, m_RenderQueue()
+, m_OcclusionCuller()
+, m_MovedInstanceIds()
+, m_AddedInstanceIds()
+, m_RemovedInstances()
 {
 }
 
@@ -172,6 +178,11 @@ bool GLC_3DViewCollection::add(const GLC_3DViewInstance& node, GLC_uint shaderID
 		result=true;
 	}
 
+	if (result && (NULL != m_pSpacePartitioning))
+	{
+		m_AddedInstanceIds.insert(key);
+	}
+
 	return result;
 }
 
@@ -245,6 +256,13 @@ bool GLC_3DViewCollection::remove(GLC_uint Key)
 
 		m_MainInstances.remove(Key);
 
+		// An instance added since the last space partitioning update is not in the space partitioning
+		if ((NULL != m_pSpacePartitioning) && !m_AddedInstanceIds.remove(Key))
+		{
+			m_RemovedInstances.insert(&(iNode.value()));
+		}
+		m_MovedInstanceIds.remove(Key);
+
 		m_3DViewInstanceHash.remove(Key);		// Delete the conteneur
 
 		//qDebug("GLC_3DViewCollection::removeNode : Element succesfuly deleted");
@@ -276,8 +294,13 @@ void GLC_3DViewCollection::clear(void)
 	m_ShadedPointerViewInstanceHash.clear();
 	m_ShaderGroup.clear();
 
+	m_MovedInstanceIds.clear();
+	m_AddedInstanceIds.clear();
+	m_RemovedInstances.clear();
+
 	// Clear main Hash table
     m_3DViewInstanceHash.clear();
+	m_OcclusionCuller.clearCache();
 
 	// delete the space partitioning
 	delete m_pSpacePartitioning;
@@ -447,6 +470,11 @@ void GLC_3DViewCollection::bindSpacePartitioning(GLC_SpacePartitioning* pSpacePa
 	delete m_pSpacePartitioning;
 	m_pSpacePartitioning= pSpacePartitioning;
     m_pSpacePartitioning->set3DViewCollection(this);
+
+	// The changes are taken into account when the space partitioning is built
+	m_MovedInstanceIds.clear();
+	m_AddedInstanceIds.clear();
+	m_RemovedInstances.clear();
 }
 
 void GLC_3DViewCollection::unbindSpacePartitioning()
@@ -454,6 +482,9 @@ void GLC_3DViewCollection::unbindSpacePartitioning()
 	delete m_pSpacePartitioning;
 	m_pSpacePartitioning= NULL;
 	m_UseSpacePartitioning= false;
+	m_MovedInstanceIds.clear();
+	m_AddedInstanceIds.clear();
+	m_RemovedInstances.clear();
 
 	ViewInstancesHash::iterator iEntry= m_3DViewInstanceHash.begin();
     while (iEntry != m_3DViewInstanceHash.constEnd())
@@ -469,9 +500,38 @@ void GLC_3DViewCollection::updateInstanceViewableState(GLC_Matrix4x4* pMatrix)
 {
 	if ((NULL != m_pViewport) && m_UseSpacePartitioning && (NULL != m_pSpacePartitioning))
 	{
-		if (m_pViewport->updateFrustum(pMatrix))
+		const bool instancesChanged= updateChangedInstances();
+		bool frustumChanged;
+		{
+			GLC_ProfileScope scope("Frustum update");
+			frustumChanged= m_pViewport->updateFrustum(pMatrix);
+		}
+		if (frustumChanged || instancesChanged)
         {
-            m_pSpacePartitioning->updateViewableInstances(m_pViewport->frustum());
+            {
+                GLC_ProfileScope scope("Space partition culling");
+                m_pSpacePartitioning->updateViewableInstances(m_pViewport->frustum());
+            }
+            if (GLC_State::isOcclusionCullingActivated())
+            {
+                GLC_ProfileScope scope("Occlusion culling");
+                // The candidates are the instances not culled by the frustum
+                QList<GLC_3DViewInstance*> instances;
+                ViewInstancesHash::iterator iEntry= m_3DViewInstanceHash.begin();
+                while (iEntry != m_3DViewInstanceHash.constEnd())
+                {
+                    GLC_3DViewInstance* pInstance= &(iEntry.value());
+                    if ((pInstance->isVisible() == m_IsInShowSate) && (pInstance->viewableFlag() != GLC_3DViewInstance::NoViewable))
+                    {
+                        instances.append(pInstance);
+                    }
+                    ++iEntry;
+                }
+                m_OcclusionCuller.setViewportSize(m_pViewport->viewHSize(), m_pViewport->viewVSize());
+                m_OcclusionCuller.setClipPlanes(m_pViewport->frustum().clipPlanes());
+                const GLC_Matrix4x4 compositionMatrix((NULL == pMatrix) ? m_pViewport->compositionMatrix() : *pMatrix);
+                m_OcclusionCuller.cull(instances, compositionMatrix);
+            }
         }
 	}
 }
@@ -480,6 +540,8 @@ void GLC_3DViewCollection::updateInstanceViewableState(const GLC_Frustum& frustu
 {
     if (NULL != m_pSpacePartitioning)
     {
+        updateChangedInstances();
+        GLC_ProfileScope scope("Space partition culling");
         m_pSpacePartitioning->updateViewableInstances(frustum);
     }
 }
@@ -490,6 +552,53 @@ void GLC_3DViewCollection::updateSpacePartitionning()
     {
         m_pSpacePartitioning->updateSpacePartitioning();
     }
+	m_MovedInstanceIds.clear();
+	m_AddedInstanceIds.clear();
+	m_RemovedInstances.clear();
+}
+
+void GLC_3DViewCollection::setInstanceMatrix(GLC_uint instanceId, const GLC_Matrix4x4& matrix)
+{
+	Q_ASSERT(m_3DViewInstanceHash.contains(instanceId));
+	m_3DViewInstanceHash[instanceId].setMatrix(matrix);
+	setInstanceMoved(instanceId);
+}
+
+void GLC_3DViewCollection::setInstanceMoved(GLC_uint instanceId)
+{
+	// An instance added since the last update is inserted with its current box
+	if ((NULL != m_pSpacePartitioning) && !m_AddedInstanceIds.contains(instanceId))
+	{
+		m_MovedInstanceIds.insert(instanceId);
+	}
+}
+
+bool GLC_3DViewCollection::updateChangedInstances()
+{
+	const bool subject= !(m_MovedInstanceIds.isEmpty() && m_AddedInstanceIds.isEmpty() && m_RemovedInstances.isEmpty());
+	if (subject && (NULL != m_pSpacePartitioning))
+	{
+		QList<GLC_3DViewInstance*> movedInstances;
+		QSet<GLC_uint>::const_iterator iId= m_MovedInstanceIds.constBegin();
+		while (iId != m_MovedInstanceIds.constEnd())
+		{
+			movedInstances.append(&(m_3DViewInstanceHash[*iId]));
+			++iId;
+		}
+		QList<GLC_3DViewInstance*> addedInstances;
+		iId= m_AddedInstanceIds.constBegin();
+		while (iId != m_AddedInstanceIds.constEnd())
+		{
+			addedInstances.append(&(m_3DViewInstanceHash[*iId]));
+			++iId;
+		}
+		m_pSpacePartitioning->updateInstances(movedInstances, addedInstances, m_RemovedInstances);
+	}
+	m_MovedInstanceIds.clear();
+	m_AddedInstanceIds.clear();
+	m_RemovedInstances.clear();
+
+	return subject;
 }
 
 void GLC_3DViewCollection::setVboUsage(bool usage)
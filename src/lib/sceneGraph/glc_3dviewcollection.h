@@ -27,9 +27,13 @@
 
 
 #include <QHash>
+#include <QSet>
 #include "glc_3dviewinstance.h"
+#include "glc_renderqueue.h"
+#include "glc_occlusionculler.h"
 #include "../glc_global.h"
 #include "../viewport/glc_frustum.h"
+#include "../glc_frameprofiler.h"
 
 #include "../glc_config.h"
 
@@ -160,6 +164,11 @@ public:
 	inline bool isViewable() const
 	{return m_IsViewable;}
 
+	//! Return an handle to the occlusion culler
+	/*! Used when the occlusion culling is activated in GLC_State*/
+	inline GLC_OcclusionCuller* occlusionCullerHandle()
+	{return &m_OcclusionCuller;}
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -250,7 +259,8 @@ public:
 
 	//! Update the instance viewable state
 	/*! Update the frustrum culling from the viewport
-	 * If the specified matrix pointer is not null*/
+	 * If the specified matrix pointer is not null
+	 * If the occlusion culling is activated, the occluded instances are set NoViewable*/
 	void updateInstanceViewableState(GLC_Matrix4x4* pMatrix= NULL);
 
 	//! Update the instance viewable state with the specified frustum
@@ -259,6 +269,17 @@ public:
     //! Update space partitionning
     void updateSpacePartitionning();
 
+	//! Set the matrix of the given instance and record its move for the space partitioning
+	void setInstanceMatrix(GLC_uint instanceId, const GLC_Matrix4x4& matrix);
+
+	//! Record that the given instance has moved since the last space partitioning update
+	/*! To be called when the matrix of the instance is not set with setInstanceMatrix()*/
+	void setInstanceMoved(GLC_uint instanceId);
+
+	//! Update the space partitioning with the instances moved, added and removed since the last call
+	/*! Called by updateInstanceViewableState(), return true if instances have changed*/
+	bool updateChangedInstances();
+
 	//! Set the attached viewport of this collection
 	inline void setAttachedViewport(GLC_Viewport* pViewport)
 	{m_pViewport= pViewport;}
@@ -340,6 +361,21 @@ private:
 	//! Viewable state
 	bool m_IsViewable;
 
+	//! The render queue of the opaque instances
+	GLC_RenderQueue m_RenderQueue;
+
+	//! The occlusion culler of the instances
+	GLC_OcclusionCuller m_OcclusionCuller;
+
+	//! The id of the instances moved since the last space partitioning update
+	QSet<GLC_uint> m_MovedInstanceIds;
+
+	//! The id of the instances added since the last space partitioning update
+	QSet<GLC_uint> m_AddedInstanceIds;
+
+	//! The instances removed since the last space partitioning update
+	QSet<GLC_3DViewInstance*> m_RemovedInstances;
+
 private:
     Q_DISABLE_COPY(GLC_3DViewCollection)
 };
@@ -372,20 +408,34 @@ void GLC_3DViewCollection::glDrawInstancesOf(PointerViewInstanceHash* pHash, glc
 	{
 		if (!(renderFlag == glc::TransparentRenderFlag))
 		{
-			while (iEntry != pHash->constEnd())
+			// Opaque draws of queueable instances are sorted by state and batched
+			const bool useRenderQueue= GLC_State::isRenderQueueActivated() && (renderFlag == glc::ShadingFlag);
 			{
-				pCurInstance= iEntry.value();
-				if ((pCurInstance->viewableFlag() != GLC_3DViewInstance::NoViewable) && (pCurInstance->isVisible() == m_IsInShowSate))
+				GLC_ProfileScope scope(useRenderQueue ? "Render queue build" : "Opaque draws");
+				while (iEntry != pHash->constEnd())
 				{
-					if (!pCurInstance->isTransparent() || pCurInstance->renderPropertiesHandle()->isSelected() || (renderFlag == glc::WireRenderFlag))
+					pCurInstance= iEntry.value();
+					if ((pCurInstance->viewableFlag() != GLC_3DViewInstance::NoViewable) && (pCurInstance->isVisible() == m_IsInShowSate))
 					{
-						pCurInstance->render(renderFlag, m_UseLod, m_pViewport);
+						if (!pCurInstance->isTransparent() || pCurInstance->renderPropertiesHandle()->isSelected() || (renderFlag == glc::WireRenderFlag))
+						{
+							if (!useRenderQueue || !pCurInstance->appendToRenderQueue(&m_RenderQueue, m_UseLod, m_pViewport))
+							{
+								pCurInstance->render(renderFlag, m_UseLod, m_pViewport);
+							}
+						}
 					}
-				}
 
-				++iEntry;
+					++iEntry;
+				}
 			}
 
+			if (useRenderQueue)
+			{
+				GLC_ProfileScope scope("Render queue execute");
+				m_RenderQueue.glExecute();
+				m_RenderQueue.clear();
+			}
 		}
 		else
 		{
@@ -25,8 +25,11 @@
 #include "glc_3dviewinstance.h"
 #include "../shading/glc_selectionmaterial.h"
 #include "../viewport/glc_viewport.h"
+#include "../geometry/glc_mesh.h"
+#include "glc_renderqueue.h"
 #include <QMutexLocker>
 #include "../glc_state.h"
+#include "../glc_frameprofiler.h"
 
 //! A Mutex
 QMutex GLC_3DViewInstance::m_Mutex;
@@ -342,13 +345,16 @@ void GLC_3DViewInstance::render(glc::RenderFlag renderFlag, bool useLod, GLC_Vie
 		glColor3ubv(m_colorId); // D'ont use Alpha component
 	}
 
+	// The time of the LOD choices is accumulated and added once to the profiler
+	qint64 lodChoiceDuration= 0;
+	qint64* pLodChoiceDuration= GLC_FrameProfiler::activated() ? &lodChoiceDuration : NULL;
 	if (useLod && (NULL != pView))
 	{
 		for (int i= 0; i < bodyCount; ++i)
 		{
 			if (m_ViewableGeomFlag.at(i))
 			{
-				const int lodValue= choseLod(m_3DRep.geomAt(i)->boundingBox(), pView, useLod);
+				const int lodValue= choseLod(m_3DRep.geomAt(i)->boundingBox(), pView, useLod, pLodChoiceDuration);
 				if (lodValue <= 100)
 				{
 					m_3DRep.geomAt(i)->setCurrentLod(lodValue);
@@ -367,7 +373,7 @@ void GLC_3DViewInstance::render(glc::RenderFlag renderFlag, bool useLod, GLC_Vie
 				int lodValue= 0;
 				if (GLC_State::isPixelCullingActivated() && (NULL != pView))
 				{
-					lodValue= choseLod(m_3DRep.geomAt(i)->boundingBox(), pView, useLod);
+					lodValue= choseLod(m_3DRep.geomAt(i)->boundingBox(), pView, useLod, pLodChoiceDuration);
 				}
 
 				if (lodValue <= 100)
@@ -379,6 +385,8 @@ void GLC_3DViewInstance::render(glc::RenderFlag renderFlag, bool useLod, GLC_Vie
 			}
 		}
 	}
+	if (NULL != pLodChoiceDuration) GLC_FrameProfiler::addLodChoiceDuration(lodChoiceDuration);
+
 	// Restore OpenGL Matrix
     pContext->glcPopMatrix();
 
@@ -460,7 +468,60 @@ int GLC_3DViewInstance::renderForPrimitiveSelection(GLC_uint bodyId)
 	return i;
 }
 
+// Append the opaque draws of this instance to the given render queue
+bool GLC_3DViewInstance::appendToRenderQueue(GLC_RenderQueue* pQueue, bool useLod, GLC_Viewport* pView)
+{
+	Q_ASSERT(!GLC_State::isInSelectionMode());
+	if (m_3DRep.isEmpty()) return true;
+
+	if ((m_AbsoluteMatrix.type() == GLC_Matrix4x4::Indirect) || m_RenderProperties.isSelected()
+			|| (m_RenderProperties.renderingMode() != glc::NormalRenderMode)
+			|| (m_RenderProperties.polyFaceMode() != GL_FRONT_AND_BACK) || (m_RenderProperties.polygonMode() != GL_FILL))
+	{
+		return false;
+	}
+
+	const int bodyCount= m_3DRep.numberOfBody();
+	if (bodyCount != m_ViewableGeomFlag.size())
+	{
+		m_ViewableGeomFlag.fill(true, bodyCount);
+	}
 
+	// All viewable bodies must be queueable
+	for (int i= 0; i < bodyCount; ++i)
+	{
+		if (m_ViewableGeomFlag.at(i))
+		{
+			GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(m_3DRep.geomAt(i));
+			if ((NULL == pMesh) || !pMesh->canBeQueued()) return false;
+		}
+	}
+
+	const bool lodIsUsed= useLod && (NULL != pView);
+	qint64 lodChoiceDuration= 0;
+	qint64* pLodChoiceDuration= GLC_FrameProfiler::activated() ? &lodChoiceDuration : NULL;
+	for (int i= 0; i < bodyCount; ++i)
+	{
+		if (m_ViewableGeomFlag.at(i))
+		{
+			GLC_Mesh* pMesh= static_cast<GLC_Mesh*>(m_3DRep.geomAt(i));
+			int lodValue= 0;
+			if (lodIsUsed || (GLC_State::isPixelCullingActivated() && (NULL != pView)))
+			{
+				lodValue= choseLod(pMesh->boundingBox(), pView, useLod, pLodChoiceDuration);
+			}
+
+			if (lodValue <= 100)
+			{
+				const int lod= lodIsUsed ? pMesh->lodIndex(lodValue) : pMesh->lodIndex(m_DefaultLOD);
+				pQueue->append(pMesh, lod, m_AbsoluteMatrix);
+			}
+		}
+	}
+	if (NULL != pLodChoiceDuration) GLC_FrameProfiler::addLodChoiceDuration(lodChoiceDuration);
+
+	return true;
+}
 
 //////////////////////////////////////////////////////////////////////
 // private services functions
@@ -501,9 +562,12 @@ void GLC_3DViewInstance::clear()
 }
 
 // Compute LOD
-int GLC_3DViewInstance::choseLod(const GLC_BoundingBox& boundingBox, GLC_Viewport* pView, bool useLod)
+int GLC_3DViewInstance::choseLod(const GLC_BoundingBox& boundingBox, GLC_Viewport* pView, bool useLod, qint64* pDuration)
 {
 	if (NULL == pView) return 0;
+
+	const qint64 start= (NULL != pDuration) ? GLC_FrameProfiler::currentTime() : 0;
+
 	double pixelCullingRatio= 0.0;
 	if (useLod)
 	{
@@ -535,6 +599,8 @@ int GLC_3DViewInstance::choseLod(const GLC_BoundingBox& boundingBox, GLC_Viewpor
 		ratio= static_cast<double>(m_DefaultLOD);
 	}
 
+	if (NULL != pDuration) *pDuration+= GLC_FrameProfiler::currentTime() - start;
+
 	return static_cast<int>(ratio);
 }
 
@@ -40,6 +40,7 @@
 #include "../glc_config.h"
 
 class GLC_Viewport;
+class GLC_RenderQueue;
 
 //////////////////////////////////////////////////////////////////////
 //! \class GLC_3DViewInstance
@@ -305,6 +306,12 @@ public:
 	//! Display the instance in Primitive selection mode of the specified body id and return the body index
 	int renderForPrimitiveSelection(GLC_uint);
 
+	//! Append the opaque draws of this instance to the given render queue
+	/*! Return false if this instance can't be queued and must be rendered with render() :
+	 *  its matrix is indirect, it is selected, it is not in normal rendering mode, its polygons
+	 *  are not filled or one of its viewable bodies is not a queueable mesh*/
+	bool appendToRenderQueue(GLC_RenderQueue* pQueue, bool useLod= false, GLC_Viewport* pView= NULL);
+
 
 private:
 	//! Set instance visualisation properties
@@ -330,7 +337,8 @@ private:
 	void clear();
 
 	//! Compute LOD
-	int choseLod(const GLC_BoundingBox&, GLC_Viewport*, bool);
+	/*! If the given duration is not NULL the time of the choice is added to it*/
+	int choseLod(const GLC_BoundingBox&, GLC_Viewport*, bool, qint64* pDuration= NULL);
 
 //////////////////////////////////////////////////////////////////////
 // Private members
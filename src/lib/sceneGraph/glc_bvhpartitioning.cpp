@@ -0,0 +1,693 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_bvhpartitioning.cpp implementation for the GLC_BvhPartitioning class.
+
+#include <QVarLengthArray>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <functional>
+
+#include "glc_bvhpartitioning.h"
+#include "glc_3dviewcollection.h"
+#include "../viewport/glc_frustumculler.h"
+
+// The ratio of added and removed instances which triggers a rebuild
+#define GLC_BVHPARTITIONING_CHANGE_RATIO 0.1
+
+// The minimum number of added and removed instances which triggers a rebuild
+#define GLC_BVHPARTITIONING_MIN_CHANGE 32
+
+// The growth of the hierarchy cost which triggers a rebuild
+#define GLC_BVHPARTITIONING_COST_RATIO 2.0
+
+// The ratio of moved instances above which the whole hierarchy is refitted
+#define GLC_BVHPARTITIONING_REFIT_RATIO 0.25
+
+GLC_BvhPartitioning::GLC_BvhPartitioning(GLC_3DViewCollection* pCollection, int maximumLeafSize)
+: GLC_SpacePartitioning(pCollection)
+, m_Bvh(maximumLeafSize)
+, m_Instances()
+, m_ItemIndexes()
+, m_Boxes()
+, m_NodeRanges()
+, m_Parents()
+, m_Leaves()
+, m_AddedInstances()
+, m_RemovedCount(0)
+, m_BuildCost(0.0)
+, m_MoveCount(0)
+, m_IsBuilt(false)
+, m_RebuildFuture()
+, m_RebuildInstances()
+, m_RebuildBoxes()
+, m_RebuildAddedInstances()
+, m_RebuildRemovedInstances()
+, m_IsRebuilding(false)
+{
+
+}
+
+GLC_BvhPartitioning::GLC_BvhPartitioning(const GLC_BvhPartitioning& partitioning)
+: GLC_SpacePartitioning(partitioning)
+, m_Bvh(partitioning.m_Bvh.maximumLeafSize())
+, m_Instances()
+, m_ItemIndexes()
+, m_Boxes()
+, m_NodeRanges()
+, m_Parents()
+, m_Leaves()
+, m_AddedInstances()
+, m_RemovedCount(0)
+, m_BuildCost(0.0)
+, m_MoveCount(0)
+, m_IsBuilt(false)
+, m_RebuildFuture()
+, m_RebuildInstances()
+, m_RebuildBoxes()
+, m_RebuildAddedInstances()
+, m_RebuildRemovedInstances()
+, m_IsRebuilding(false)
+{
+
+}
+
+GLC_BvhPartitioning::~GLC_BvhPartitioning()
+{
+	cancelRebuild();
+}
+
+GLC_SpacePartitioning* GLC_BvhPartitioning::clone()
+{
+	GLC_SpacePartitioning* pSubject= new GLC_BvhPartitioning(*this);
+
+	return pSubject;
+}
+
+QList<GLC_3DViewInstance*> GLC_BvhPartitioning::listOfIntersectedInstances(const GLC_BoundingBox& bBox)
+{
+	if (!m_IsBuilt)
+	{
+		updateSpacePartitioning();
+	}
+
+	QList<GLC_3DViewInstance*> subject;
+	if (bBox.isEmpty()) return subject;
+
+	const double* pLower= bBox.lowerCorner().data();
+	const double* pUpper= bBox.upperCorner().data();
+	const GLC_Bvh::Node* pNodes= m_Bvh.nodes().constData();
+
+	QVarLengthArray<int, 64> stack;
+	if (!m_Bvh.isEmpty()) stack.append(0);
+	while (!stack.isEmpty())
+	{
+		const int index= stack.last();
+		stack.removeLast();
+		const GLC_Bvh::Node& node= pNodes[index];
+
+		bool intersect= true;
+		for (int axis= 0; (axis < 3) && intersect; ++axis)
+		{
+			intersect= (node.m_Lower[axis] <= pUpper[axis]) && (node.m_Upper[axis] >= pLower[axis]);
+		}
+		if (!intersect) continue;
+
+		if (node.m_Count > 0)
+		{
+			const int last= node.m_Offset + node.m_Count;
+			for (int slot= node.m_Offset; slot < last; ++slot)
+			{
+				GLC_3DViewInstance* pInstance= m_Instances.at(m_Bvh.item(slot));
+				if ((NULL != pInstance) && pInstance->boundingBox().intersect(bBox))
+				{
+					subject.append(pInstance);
+				}
+			}
+		}
+		else
+		{
+			stack.append(node.m_Offset);
+			stack.append(index + 1);
+		}
+	}
+
+	const int addedCount= m_AddedInstances.size();
+	for (int i= 0; i < addedCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= m_AddedInstances.at(i);
+		if (pInstance->boundingBox().intersect(bBox))
+		{
+			subject.append(pInstance);
+		}
+	}
+
+	return subject;
+}
+
+QList<GLC_3DViewInstance*> GLC_BvhPartitioning::listOfInstancesInFrustum(const GLC_Frustum& frustum)
+{
+	if (!m_IsBuilt)
+	{
+		updateSpacePartitioning();
+	}
+
+	QList<GLC_3DViewInstance*> subject;
+
+	const GLC_FrustumCuller culler(frustum);
+	const GLC_Bvh::Node* pNodes= m_Bvh.nodes().constData();
+	const float* pBoxes= m_Boxes.constData();
+
+	QVarLengthArray<int, 64> stack;
+	if (!m_Bvh.isEmpty()) stack.append(0);
+	while (!stack.isEmpty())
+	{
+		const int index= stack.last();
+		stack.removeLast();
+		const GLC_Bvh::Node& node= pNodes[index];
+
+		const GLC_Frustum::Localisation localisation= culler.localize(node.m_Lower, node.m_Upper);
+		if (localisation == GLC_Frustum::OutFrustum) continue;
+
+		if (localisation == GLC_Frustum::InFrustum)
+		{
+			appendInstancesOf(index, &subject);
+		}
+		else if (node.m_Count > 0)
+		{
+			const int last= node.m_Offset + node.m_Count;
+			for (int slot= node.m_Offset; slot < last; ++slot)
+			{
+				const int item= m_Bvh.item(slot);
+				if ((NULL != m_Instances.at(item)) && (culler.localize(&pBoxes[item * 6], &pBoxes[item * 6 + 3]) != GLC_Frustum::OutFrustum))
+				{
+					subject.append(m_Instances.at(item));
+				}
+			}
+		}
+		else
+		{
+			stack.append(node.m_Offset);
+			stack.append(index + 1);
+		}
+	}
+
+	const int addedCount= m_AddedInstances.size();
+	for (int i= 0; i < addedCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= m_AddedInstances.at(i);
+		if (culler.localize(pInstance->boundingBox()) != GLC_Frustum::OutFrustum)
+		{
+			subject.append(pInstance);
+		}
+	}
+
+	return subject;
+}
+
+void GLC_BvhPartitioning::updateViewableInstances(const GLC_Frustum& frustum)
+{
+	if (!m_IsBuilt)
+	{
+		updateSpacePartitioning();
+	}
+	else
+	{
+		finishRebuild(false);
+	}
+
+	const GLC_FrustumCuller culler(frustum);
+	GLC_FrustumCuller geomCuller;
+	const GLC_Bvh::Node* pNodes= m_Bvh.nodes().constData();
+
+	QVarLengthArray<int, 64> stack;
+	if (!m_Bvh.isEmpty()) stack.append(0);
+	while (!stack.isEmpty())
+	{
+		const int index= stack.last();
+		stack.removeLast();
+		const GLC_Bvh::Node& node= pNodes[index];
+
+		const GLC_Frustum::Localisation localisation= culler.localize(node.m_Lower, node.m_Upper);
+		if (localisation == GLC_Frustum::OutFrustum)
+		{
+			setViewableFlag(index, false);
+		}
+		else if (localisation == GLC_Frustum::InFrustum)
+		{
+			setViewableFlag(index, true);
+		}
+		else if (node.m_Count > 0)
+		{
+			updateViewableInstancesOfLeaf(node, frustum, culler, &geomCuller);
+		}
+		else
+		{
+			stack.append(node.m_Offset);
+			stack.append(index + 1);
+		}
+	}
+
+	const int addedCount= m_AddedInstances.size();
+	for (int i= 0; i < addedCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= m_AddedInstances.at(i);
+		updateViewableInstance(pInstance, culler.localize(pInstance->boundingBox()), frustum, &geomCuller);
+	}
+}
+
+void GLC_BvhPartitioning::updateSpacePartitioning()
+{
+	cancelRebuild();
+	m_Instances.clear();
+	m_Boxes.clear();
+	m_AddedInstances.clear();
+	m_RemovedCount= 0;
+
+	// Instances without geometry are not in the hierarchy
+	const QList<GLC_3DViewInstance*> instances(m_pCollection->instancesHandle());
+	const int size= instances.size();
+	m_Instances.reserve(size);
+	m_Boxes.reserve(size * 6);
+	for (int i= 0; i < size; ++i)
+	{
+		GLC_3DViewInstance* pInstance= instances.at(i);
+		if (!pInstance->boundingBox().isEmpty())
+		{
+			m_Instances.append(pInstance);
+			GLC_Bvh::appendBox(pInstance->boundingBox(), &m_Boxes);
+		}
+	}
+
+	m_Bvh.build(m_Boxes);
+	computeItemIndexes();
+	computeNodeRanges();
+	m_BuildCost= m_Bvh.surfaceAreaCost();
+	m_MoveCount= 0;
+	m_IsBuilt= true;
+}
+
+void GLC_BvhPartitioning::updateInstances(const QList<GLC_3DViewInstance*>& movedInstances, const QList<GLC_3DViewInstance*>& addedInstances, const QSet<GLC_3DViewInstance*>& removedInstances)
+{
+	// The hierarchy is built with all the instances when it is used
+	if (!m_IsBuilt) return;
+
+	finishRebuild(false);
+
+	// The removed instances are handled first, an added instance may reuse their address
+	QSet<GLC_3DViewInstance*>::const_iterator iRemoved= removedInstances.constBegin();
+	while (iRemoved != removedInstances.constEnd())
+	{
+		GLC_3DViewInstance* pInstance= *iRemoved;
+		QHash<GLC_3DViewInstance*, int>::iterator iItem= m_ItemIndexes.find(pInstance);
+		if (iItem != m_ItemIndexes.end())
+		{
+			// The item keeps its slot and its box until the next build
+			m_Instances[iItem.value()]= NULL;
+			m_ItemIndexes.erase(iItem);
+			++m_RemovedCount;
+		}
+		else
+		{
+			m_AddedInstances.removeOne(pInstance);
+		}
+		if (m_IsRebuilding)
+		{
+			m_RebuildRemovedInstances.insert(pInstance);
+			m_RebuildAddedInstances.removeOne(pInstance);
+		}
+		++iRemoved;
+	}
+
+	const int addedCount= addedInstances.size();
+	for (int i= 0; i < addedCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= addedInstances.at(i);
+		if (!pInstance->boundingBox().isEmpty())
+		{
+			m_AddedInstances.append(pInstance);
+			if (m_IsRebuilding)
+			{
+				m_RebuildAddedInstances.append(pInstance);
+			}
+		}
+	}
+
+	// The added instances are tested with their current box, only the items are refitted
+	QList<int> movedItems;
+	const int movedCount= movedInstances.size();
+	for (int i= 0; i < movedCount; ++i)
+	{
+		QHash<GLC_3DViewInstance*, int>::const_iterator iItem= m_ItemIndexes.constFind(movedInstances.at(i));
+		if (iItem != m_ItemIndexes.constEnd())
+		{
+			movedItems.append(iItem.value());
+		}
+	}
+	if (movedItems.size() > (m_Instances.size() * GLC_BVHPARTITIONING_REFIT_RATIO))
+	{
+		refit();
+	}
+	else if (!movedItems.isEmpty())
+	{
+		refitItems(movedItems);
+	}
+	m_MoveCount+= movedItems.size();
+
+	if (!m_IsRebuilding && rebuildIsNeeded())
+	{
+		startRebuild();
+	}
+}
+
+void GLC_BvhPartitioning::clear()
+{
+	cancelRebuild();
+	m_Bvh.clear();
+	m_Instances.clear();
+	m_ItemIndexes.clear();
+	m_Boxes.clear();
+	m_NodeRanges.clear();
+	m_Parents.clear();
+	m_Leaves.clear();
+	m_AddedInstances.clear();
+	m_RemovedCount= 0;
+	m_BuildCost= 0.0;
+	m_MoveCount= 0;
+	m_IsBuilt= false;
+}
+
+void GLC_BvhPartitioning::refit()
+{
+	if (!m_IsBuilt)
+	{
+		updateSpacePartitioning();
+		return;
+	}
+
+	const int size= m_Instances.size();
+	QVector<float> boxes;
+	boxes.reserve(size * 6);
+	for (int i= 0; i < size; ++i)
+	{
+		// A removed instance or an instance which becomes empty keeps its previous box
+		GLC_3DViewInstance* pInstance= m_Instances.at(i);
+		if ((NULL != pInstance) && !pInstance->boundingBox().isEmpty())
+		{
+			GLC_Bvh::appendBox(pInstance->boundingBox(), &boxes);
+		}
+		else
+		{
+			for (int j= 0; j < 6; ++j) boxes.append(m_Boxes.at(i * 6 + j));
+		}
+	}
+	m_Boxes= boxes;
+	m_Bvh.refit(m_Boxes);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services function
+//////////////////////////////////////////////////////////////////////
+
+GLC_Bvh GLC_BvhPartitioning::buildTask(QVector<float> boxes, int maximumLeafSize)
+{
+	GLC_Bvh subject(maximumLeafSize);
+	subject.build(boxes);
+
+	return subject;
+}
+
+void GLC_BvhPartitioning::computeNodeRanges()
+{
+	const QVector<GLC_Bvh::Node>& nodes= m_Bvh.nodes();
+	const int size= nodes.size();
+	m_NodeRanges.resize(size * 2);
+	m_Parents.resize(size);
+	m_Leaves.resize(m_Instances.size());
+	if (size > 0) m_Parents[0]= -1;
+
+	// The children of a node follow it
+	for (int index= size - 1; index >= 0; --index)
+	{
+		const GLC_Bvh::Node& node= nodes.at(index);
+		if (node.m_Count > 0)
+		{
+			m_NodeRanges[index * 2]= node.m_Offset;
+			m_NodeRanges[index * 2 + 1]= node.m_Offset + node.m_Count;
+			for (int slot= node.m_Offset; slot < (node.m_Offset + node.m_Count); ++slot)
+			{
+				m_Leaves[m_Bvh.item(slot)]= index;
+			}
+		}
+		else
+		{
+			m_NodeRanges[index * 2]= m_NodeRanges.at((index + 1) * 2);
+			m_NodeRanges[index * 2 + 1]= m_NodeRanges.at(node.m_Offset * 2 + 1);
+			m_Parents[index + 1]= index;
+			m_Parents[node.m_Offset]= index;
+		}
+	}
+}
+
+void GLC_BvhPartitioning::computeItemIndexes()
+{
+	m_ItemIndexes.clear();
+	const int size= m_Instances.size();
+	m_ItemIndexes.reserve(size);
+	for (int i= 0; i < size; ++i)
+	{
+		if (NULL != m_Instances.at(i))
+		{
+			m_ItemIndexes.insert(m_Instances.at(i), i);
+		}
+	}
+}
+
+void GLC_BvhPartitioning::refitItems(const QList<int>& items)
+{
+	// Collect the leaves of the items and their ancestors
+	QSet<int> dirtyNodes;
+	const int size= items.size();
+	for (int i= 0; i < size; ++i)
+	{
+		const int item= items.at(i);
+		const GLC_BoundingBox& box= m_Instances.at(item)->boundingBox();
+		if (!box.isEmpty())
+		{
+			QVector<float> itemBox;
+			GLC_Bvh::appendBox(box, &itemBox);
+			for (int j= 0; j < 6; ++j) m_Boxes[item * 6 + j]= itemBox.at(j);
+		}
+
+		int node= m_Leaves.at(item);
+		while ((node >= 0) && !dirtyNodes.contains(node))
+		{
+			dirtyNodes.insert(node);
+			node= m_Parents.at(node);
+		}
+	}
+
+	// The children of a node follow it, so the nodes are refitted from the last one
+	QVector<int> nodes;
+	nodes.reserve(dirtyNodes.size());
+	QSet<int>::const_iterator iNode= dirtyNodes.constBegin();
+	while (iNode != dirtyNodes.constEnd())
+	{
+		nodes.append(*iNode);
+		++iNode;
+	}
+	std::sort(nodes.begin(), nodes.end(), std::greater<int>());
+
+	const int nodeCount= nodes.size();
+	for (int i= 0; i < nodeCount; ++i)
+	{
+		m_Bvh.refitNode(nodes.at(i), m_Boxes);
+	}
+}
+
+bool GLC_BvhPartitioning::rebuildIsNeeded()
+{
+	const int minimumCount= qMax(GLC_BVHPARTITIONING_MIN_CHANGE, static_cast<int>(m_Instances.size() * GLC_BVHPARTITIONING_CHANGE_RATIO));
+	if ((m_RemovedCount + m_AddedInstances.size()) > minimumCount) return true;
+
+	bool subject= false;
+	if (m_MoveCount > minimumCount)
+	{
+		subject= m_Bvh.surfaceAreaCost() > (m_BuildCost * GLC_BVHPARTITIONING_COST_RATIO);
+		m_MoveCount= 0;
+	}
+
+	return subject;
+}
+
+void GLC_BvhPartitioning::startRebuild()
+{
+	Q_ASSERT(!m_IsRebuilding);
+	m_RebuildInstances.clear();
+	m_RebuildBoxes.clear();
+	m_RebuildAddedInstances.clear();
+	m_RebuildRemovedInstances.clear();
+
+	// The boxes are computed by this thread, the worker thread only builds the hierarchy
+	QList<GLC_3DViewInstance*> instances(m_AddedInstances);
+	const int size= m_Instances.size();
+	for (int i= 0; i < size; ++i)
+	{
+		if (NULL != m_Instances.at(i)) instances.append(m_Instances.at(i));
+	}
+	const int instanceCount= instances.size();
+	m_RebuildInstances.reserve(instanceCount);
+	m_RebuildBoxes.reserve(instanceCount * 6);
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= instances.at(i);
+		if (!pInstance->boundingBox().isEmpty())
+		{
+			m_RebuildInstances.append(pInstance);
+			GLC_Bvh::appendBox(pInstance->boundingBox(), &m_RebuildBoxes);
+		}
+	}
+
+	m_RebuildFuture= QtConcurrent::run(GLC_BvhPartitioning::buildTask, m_RebuildBoxes, m_Bvh.maximumLeafSize());
+	m_IsRebuilding= true;
+}
+
+void GLC_BvhPartitioning::finishRebuild(bool wait)
+{
+	if (!m_IsRebuilding) return;
+	if (!wait && !m_RebuildFuture.isFinished()) return;
+
+	m_Bvh= m_RebuildFuture.result();
+	m_RebuildFuture= QFuture<GLC_Bvh>();
+	m_IsRebuilding= false;
+
+	m_Instances= m_RebuildInstances;
+	m_Boxes= m_RebuildBoxes;
+	m_AddedInstances= m_RebuildAddedInstances;
+	m_RebuildInstances.clear();
+	m_RebuildBoxes.clear();
+	m_RebuildAddedInstances.clear();
+	computeItemIndexes();
+
+	// The instances removed while the hierarchy was built
+	m_RemovedCount= 0;
+	QSet<GLC_3DViewInstance*>::const_iterator iRemoved= m_RebuildRemovedInstances.constBegin();
+	while (iRemoved != m_RebuildRemovedInstances.constEnd())
+	{
+		QHash<GLC_3DViewInstance*, int>::iterator iItem= m_ItemIndexes.find(*iRemoved);
+		if (iItem != m_ItemIndexes.end())
+		{
+			m_Instances[iItem.value()]= NULL;
+			m_ItemIndexes.erase(iItem);
+			++m_RemovedCount;
+		}
+		++iRemoved;
+	}
+	m_RebuildRemovedInstances.clear();
+
+	// The instances moved while the hierarchy was built
+	computeNodeRanges();
+	refit();
+	m_BuildCost= m_Bvh.surfaceAreaCost();
+	m_MoveCount= 0;
+}
+
+void GLC_BvhPartitioning::cancelRebuild()
+{
+	if (!m_IsRebuilding) return;
+
+	m_RebuildFuture.waitForFinished();
+	m_RebuildFuture= QFuture<GLC_Bvh>();
+	m_IsRebuilding= false;
+	m_RebuildInstances.clear();
+	m_RebuildBoxes.clear();
+	m_RebuildAddedInstances.clear();
+	m_RebuildRemovedInstances.clear();
+}
+
+void GLC_BvhPartitioning::appendInstancesOf(int node, QList<GLC_3DViewInstance*>* pList) const
+{
+	const int last= m_NodeRanges.at(node * 2 + 1);
+	for (int slot= m_NodeRanges.at(node * 2); slot < last; ++slot)
+	{
+		GLC_3DViewInstance* pInstance= m_Instances.at(m_Bvh.item(slot));
+		if (NULL != pInstance) pList->append(pInstance);
+	}
+}
+
+void GLC_BvhPartitioning::setViewableFlag(int node, bool viewable)
+{
+	const GLC_3DViewInstance::Viewable flag= viewable ? GLC_3DViewInstance::FullViewable : GLC_3DViewInstance::NoViewable;
+	const int last= m_NodeRanges.at(node * 2 + 1);
+	for (int slot= m_NodeRanges.at(node * 2); slot < last; ++slot)
+	{
+		GLC_3DViewInstance* pInstance= m_Instances.at(m_Bvh.item(slot));
+		if (NULL != pInstance) pInstance->setViewable(flag);
+	}
+}
+
+void GLC_BvhPartitioning::updateViewableInstancesOfLeaf(const GLC_Bvh::Node& node, const GLC_Frustum& frustum, const GLC_FrustumCuller& culler, GLC_FrustumCuller* pGeomCuller)
+{
+	const float* pBoxes= m_Boxes.constData();
+	const int last= node.m_Offset + node.m_Count;
+	for (int slot= node.m_Offset; slot < last; ++slot)
+	{
+		const int item= m_Bvh.item(slot);
+		GLC_3DViewInstance* pCurrentInstance= m_Instances.at(item);
+		if (NULL != pCurrentInstance)
+		{
+			updateViewableInstance(pCurrentInstance, culler.localize(&pBoxes[item * 6], &pBoxes[item * 6 + 3]), frustum, pGeomCuller);
+		}
+	}
+}
+
+void GLC_BvhPartitioning::updateViewableInstance(GLC_3DViewInstance* pInstance, GLC_Frustum::Localisation localisation, const GLC_Frustum& frustum, GLC_FrustumCuller* pGeomCuller)
+{
+	if (localisation == GLC_Frustum::OutFrustum)
+	{
+		pInstance->setViewable(GLC_3DViewInstance::NoViewable);
+	}
+	else if (localisation == GLC_Frustum::InFrustum)
+	{
+		pInstance->setViewable(GLC_3DViewInstance::FullViewable);
+	}
+	else
+	{
+		pInstance->setViewable(GLC_3DViewInstance::PartialViewable);
+		// Update the geometries viewable property of the instance
+		// The geometries boxes are localized in the instance coordinates
+		pGeomCuller->setFrustum(frustum, pInstance->matrix());
+		pGeomCuller->clearBoxes();
+		const int size= pInstance->numberOfBody();
+		pGeomCuller->reserve(size);
+		for (int i= 0; i < size; ++i)
+		{
+			pGeomCuller->appendBox(pInstance->geomAt(i)->boundingBox());
+		}
+		QVector<GLC_Frustum::Localisation> geomLocalisations;
+		pGeomCuller->localizeBoxes(&geomLocalisations);
+		for (int i= 0; i < size; ++i)
+		{
+			pInstance->setGeomViewable(i, geomLocalisations.at(i) != GLC_Frustum::OutFrustum);
+		}
+	}
+}
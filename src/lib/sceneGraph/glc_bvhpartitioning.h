@@ -0,0 +1,225 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_bvhpartitioning.h interface for the GLC_BvhPartitioning class.
+
+#ifndef GLC_BVHPARTITIONING_H_
+#define GLC_BVHPARTITIONING_H_
+
+#include <QVector>
+#include <QHash>
+#include <QFuture>
+
+#include "glc_spacepartitioning.h"
+#include "../geometry/glc_bvh.h"
+
+#include "../glc_config.h"
+
+class GLC_FrustumCuller;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_BvhPartitioning
+/*! \brief GLC_BvhPartitioning : represent space partioning implementation with a bounding volume hierarchy */
+
+/*! The hierarchy is a GLC_Bvh built over the bounding boxes of the instances
+ *  of the collection with the surface area heuristic. Each instance is in
+ *  exactly one leaf and the leaves fit the instances, so the cost of a
+ *  frustum or box query depends on the number of instances near its boundary,
+ *  not on how the model fits a regular grid.
+ *
+ *  The slots of a subtree are contiguous : an entire subtree inside or outside
+ *  of the frustum is updated without being traversed.
+ *
+ *  The changes pushed by the collection with updateInstances() do not
+ *  rebuild the hierarchy : the boxes of the moved instances and of their
+ *  ancestor nodes are refitted, removed instances are left out and added
+ *  instances are tested one by one. When the added and removed instances
+ *  become too many or when the refitted hierarchy cost grows too much, a new
+ *  hierarchy is built in a worker thread and swapped in once ready.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_BvhPartitioning : public GLC_SpacePartitioning
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Create an empty hierarchy of the given 3D view collection with the given maximum number of instances per leaf
+	GLC_BvhPartitioning(GLC_3DViewCollection*, int maximumLeafSize= 4);
+
+	//! Create an empty hierarchy with the parameters of the given one
+	GLC_BvhPartitioning(const GLC_BvhPartitioning&);
+
+	//! Destructor
+	virtual ~GLC_BvhPartitioning();
+
+	virtual GLC_SpacePartitioning* clone();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the hierarchy of this space partitioning
+	inline const GLC_Bvh& bvh() const
+	{return m_Bvh;}
+
+	//! Return the number of instances of the hierarchy
+	inline int instanceCount() const
+	{return m_Instances.size() - m_RemovedCount + m_AddedInstances.size();}
+
+	//! Return true if a new hierarchy is being built in a worker thread
+	inline bool isRebuilding() const
+	{return m_IsRebuilding;}
+
+	//! Return the list off instances inside or intersect the given bounding box
+	virtual QList<GLC_3DViewInstance*> listOfIntersectedInstances(const GLC_BoundingBox& bBox);
+
+	//! Return the list of instances which are inside or intersect the given frustum
+	virtual QList<GLC_3DViewInstance*> listOfInstancesInFrustum(const GLC_Frustum& frustum);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Update the viewable 3d view instance of this hierarchy from the given frustum
+	virtual void updateViewableInstances(const GLC_Frustum&);
+
+	//! Rebuild this hierarchy from the instances of the collection
+	virtual void updateSpacePartitioning();
+
+	//! Update this hierarchy with the given moved, added and removed instances
+	virtual void updateInstances(const QList<GLC_3DViewInstance*>& movedInstances, const QList<GLC_3DViewInstance*>& addedInstances, const QSet<GLC_3DViewInstance*>& removedInstances);
+
+	//! Clear the space partionning
+	virtual void clear();
+
+	//! Update the node boxes from the current bounding boxes of the instances
+	/*! The hierarchy is kept, the query cost grows if the instances move far*/
+	void refit();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private services function
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Build a hierarchy from the given boxes, run by the worker thread
+	static GLC_Bvh buildTask(QVector<float> boxes, int maximumLeafSize);
+
+	//! Compute the slots range of each node, the parent of each node and the leaf of each item
+	void computeNodeRanges();
+
+	//! Compute the item index of each instance
+	void computeItemIndexes();
+
+	//! Refit the leaves of the given items and their ancestors
+	void refitItems(const QList<int>& items);
+
+	//! Return true if this hierarchy should be rebuilt
+	/*! The cost of the refitted hierarchy is checked once enough instances have moved*/
+	bool rebuildIsNeeded();
+
+	//! Build a new hierarchy from the current instances in a worker thread
+	void startRebuild();
+
+	//! Swap in the new hierarchy if it is built, wait for it if the given flag is true
+	void finishRebuild(bool wait);
+
+	//! Wait for the worker thread and drop the new hierarchy
+	void cancelRebuild();
+
+	//! Append the instances of the given node subtree to the given list
+	void appendInstancesOf(int node, QList<GLC_3DViewInstance*>* pList) const;
+
+	//! Set the viewable flag of the instances of the given node subtree
+	void setViewableFlag(int node, bool viewable);
+
+	//! Set the viewable flag of the instances of the given leaf from the given culler
+	void updateViewableInstancesOfLeaf(const GLC_Bvh::Node& node, const GLC_Frustum& frustum, const GLC_FrustumCuller& culler, GLC_FrustumCuller* pGeomCuller);
+
+	//! Set the viewable flag of the given instance from its localisation
+	/*! The geometries culler is reused for the geometries of a partially viewable instance*/
+	static void updateViewableInstance(GLC_3DViewInstance* pInstance, GLC_Frustum::Localisation localisation, const GLC_Frustum& frustum, GLC_FrustumCuller* pGeomCuller);
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The hierarchy
+	GLC_Bvh m_Bvh;
+
+	//! The instances of the hierarchy by item index, NULL if removed
+	QVector<GLC_3DViewInstance*> m_Instances;
+
+	//! The item index of each instance of the hierarchy
+	QHash<GLC_3DViewInstance*, int> m_ItemIndexes;
+
+	//! The boxes of the instances by item index
+	QVector<float> m_Boxes;
+
+	//! The first slot and the end slot of each node subtree
+	QVector<int> m_NodeRanges;
+
+	//! The parent of each node, -1 for the root
+	QVector<int> m_Parents;
+
+	//! The leaf of each item
+	QVector<int> m_Leaves;
+
+	//! The instances added since the hierarchy has been built
+	QList<GLC_3DViewInstance*> m_AddedInstances;
+
+	//! The number of instances removed since the hierarchy has been built
+	int m_RemovedCount;
+
+	//! The cost of the hierarchy when built
+	double m_BuildCost;
+
+	//! The number of instance moves since the cost has been checked
+	int m_MoveCount;
+
+	//! True if the hierarchy has been built
+	bool m_IsBuilt;
+
+	//! The new hierarchy built by the worker thread
+	QFuture<GLC_Bvh> m_RebuildFuture;
+
+	//! The instances of the new hierarchy by item index
+	QVector<GLC_3DViewInstance*> m_RebuildInstances;
+
+	//! The boxes of the instances of the new hierarchy
+	QVector<float> m_RebuildBoxes;
+
+	//! The instances added since the new hierarchy has been started
+	QList<GLC_3DViewInstance*> m_RebuildAddedInstances;
+
+	//! The instances removed since the new hierarchy has been started
+	QSet<GLC_3DViewInstance*> m_RebuildRemovedInstances;
+
+	//! True if a new hierarchy is being built
+	bool m_IsRebuilding;
+};
+
+#endif /* GLC_BVHPARTITIONING_H_ */
@@ -0,0 +1,488 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_frustumselector.cpp implementation of the GLC_FrustumSelector class.
+
+#include <QtConcurrent>
+
+#include "glc_frustumselector.h"
+#include "glc_3dviewcollection.h"
+#include "glc_3dviewinstance.h"
+#include "glc_spacepartitioning.h"
+#include "../geometry/glc_mesh.h"
+#include "../viewport/glc_frustumculler.h"
+
+// The hierarchy of a mesh with more triangles is tested by several tasks
+#define GLC_FRUSTUMSELECTOR_TASK_SIZE 4096
+
+// The depth of the subtrees roots of the tasks of a mesh
+#define GLC_FRUSTUMSELECTOR_SPLIT_DEPTH 3
+
+GLC_FrustumSelector::GLC_FrustumSelector(GLC_3DViewCollection* pCollection, Mode mode)
+: m_pCollection(pCollection)
+, m_Mode(mode)
+, m_MeshBvhHash()
+{
+
+}
+
+bool GLC_FrustumSelector::triangleIsInside(const double planes[6][4], const float* p0, const float* p1, const float* p2)
+{
+	for (int i= 0; i < 6; ++i)
+	{
+		const double* plane= planes[i];
+		if ((plane[0] * p0[0] + plane[1] * p0[1] + plane[2] * p0[2] + plane[3]) < 0.0) return false;
+		if ((plane[0] * p1[0] + plane[1] * p1[1] + plane[2] * p1[2] + plane[3]) < 0.0) return false;
+		if ((plane[0] * p2[0] + plane[1] * p2[1] + plane[2] * p2[2] + plane[3]) < 0.0) return false;
+	}
+	return true;
+}
+
+bool GLC_FrustumSelector::triangleIsCrossing(const double planes[6][4], const float* p0, const float* p1, const float* p2)
+{
+	// Trivial cases : the triangle is out of a plane or inside all planes
+	bool isInside= true;
+	for (int i= 0; i < 6; ++i)
+	{
+		const double* plane= planes[i];
+		int outCount= 0;
+		if ((plane[0] * p0[0] + plane[1] * p0[1] + plane[2] * p0[2] + plane[3]) < 0.0) ++outCount;
+		if ((plane[0] * p1[0] + plane[1] * p1[1] + plane[2] * p1[2] + plane[3]) < 0.0) ++outCount;
+		if ((plane[0] * p2[0] + plane[1] * p2[1] + plane[2] * p2[2] + plane[3]) < 0.0) ++outCount;
+		if (3 == outCount) return false;
+		if (0 != outCount) isInside= false;
+	}
+	if (isInside) return true;
+
+	// Clip the triangle by each plane, each clipping adds at most one vertex
+	double polygons[2][9 * 3]=
+	{
+		{p0[0], p0[1], p0[2], p1[0], p1[1], p1[2], p2[0], p2[1], p2[2]},
+		{0.0}
+	};
+	int current= 0;
+	int vertexCount= 3;
+	for (int i= 0; i < 6; ++i)
+	{
+		const double* plane= planes[i];
+		const double* pSource= polygons[current];
+		double* pTarget= polygons[1 - current];
+		int clippedCount= 0;
+		for (int vertex= 0; vertex < vertexCount; ++vertex)
+		{
+			const double* pCurrent= pSource + (vertex * 3);
+			const double* pNext= pSource + (((vertex + 1) % vertexCount) * 3);
+			const double currentDistance= plane[0] * pCurrent[0] + plane[1] * pCurrent[1] + plane[2] * pCurrent[2] + plane[3];
+			const double nextDistance= plane[0] * pNext[0] + plane[1] * pNext[1] + plane[2] * pNext[2] + plane[3];
+			if (currentDistance >= 0.0)
+			{
+				pTarget[clippedCount * 3]= pCurrent[0];
+				pTarget[clippedCount * 3 + 1]= pCurrent[1];
+				pTarget[clippedCount * 3 + 2]= pCurrent[2];
+				++clippedCount;
+			}
+			if ((currentDistance >= 0.0) != (nextDistance >= 0.0))
+			{
+				const double t= currentDistance / (currentDistance - nextDistance);
+				pTarget[clippedCount * 3]= pCurrent[0] + (pNext[0] - pCurrent[0]) * t;
+				pTarget[clippedCount * 3 + 1]= pCurrent[1] + (pNext[1] - pCurrent[1]) * t;
+				pTarget[clippedCount * 3 + 2]= pCurrent[2] + (pNext[2] - pCurrent[2]) * t;
+				++clippedCount;
+			}
+		}
+		if (0 == clippedCount) return false;
+		vertexCount= clippedCount;
+		current= 1 - current;
+	}
+	return true;
+}
+
+void GLC_FrustumSelector::setCollection(GLC_3DViewCollection* pCollection)
+{
+	if (m_pCollection != pCollection)
+	{
+		clear();
+		m_pCollection= pCollection;
+	}
+}
+
+void GLC_FrustumSelector::clear()
+{
+	m_MeshBvhHash.clear();
+}
+
+QSet<GLC_uint> GLC_FrustumSelector::selectInstances(const GLC_Frustum& frustum)
+{
+	return select(frustum, InstanceLevel).keys().toSet();
+}
+
+OccurrenceSelection GLC_FrustumSelector::selectBodies(const GLC_Frustum& frustum)
+{
+	return select(frustum, BodyLevel);
+}
+
+OccurrenceSelection GLC_FrustumSelector::selectPrimitives(const GLC_Frustum& frustum)
+{
+	return select(frustum, PrimitiveLevel);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+OccurrenceSelection GLC_FrustumSelector::select(const GLC_Frustum& frustum, Level level)
+{
+	OccurrenceSelection subject;
+	if (NULL == m_pCollection) return subject;
+
+	const bool insideMode= (InsideMode == m_Mode);
+
+	// The candidate instances
+	QList<GLC_3DViewInstance*> instances;
+	if (m_pCollection->spacePartitioningIsUsed() && (NULL != m_pCollection->spacePartitioningHandle()))
+	{
+		instances= m_pCollection->spacePartitioningHandle()->listOfInstancesInFrustum(frustum);
+	}
+	else
+	{
+		instances= m_pCollection->viewableInstancesHandle();
+	}
+
+	// Localize the world boxes of the visible instances
+	GLC_FrustumCuller culler(frustum);
+	culler.reserve(instances.size());
+	QList<GLC_3DViewInstance*> candidates;
+	const int instanceCount= instances.size();
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= instances.at(i);
+		if (pInstance->isVisible() != m_pCollection->showState()) continue;
+		const GLC_BoundingBox box(pInstance->boundingBox());
+		if (box.isEmpty()) continue;
+		culler.appendBox(box);
+		candidates.append(pInstance);
+	}
+	QVector<GLC_Frustum::Localisation> localisations;
+	culler.localizeBoxes(&localisations);
+
+	// Localize the bodies of the candidates and create the triangles tests
+	// of the meshes crossing the frustum
+	QVector<BodyEntry> bodies;
+	QVector<TriangleTask> tasks;
+	const bool stopOnFirst= (PrimitiveLevel != level);
+	const int candidateCount= candidates.size();
+	for (int i= 0; i < candidateCount; ++i)
+	{
+		if (GLC_Frustum::OutFrustum == localisations.at(i)) continue;
+
+		GLC_3DViewInstance* pInstance= candidates.at(i);
+		const bool instanceIsIn= (GLC_Frustum::InFrustum == localisations.at(i));
+		const GLC_FrustumCuller bodyCuller(frustum, pInstance->matrix());
+		double planes[6][4];
+		bool planesAreSet= false;
+
+		const int bodyCount= pInstance->numberOfGeometry();
+		for (int bodyIndex= 0; bodyIndex < bodyCount; ++bodyIndex)
+		{
+			GLC_Geometry* pGeometry= pInstance->geomAt(bodyIndex);
+			const GLC_BoundingBox& bodyBox= pGeometry->boundingBox();
+			if (bodyBox.isEmpty()) continue;
+
+			BodyEntry body;
+			body.m_InstanceId= pInstance->id();
+			body.m_BodyId= pGeometry->id();
+			body.m_pMesh= dynamic_cast<GLC_Mesh*>(pGeometry);
+			body.m_pMeshBvh= NULL;
+
+			const GLC_Frustum::Localisation bodyLocalisation= instanceIsIn ? GLC_Frustum::InFrustum : bodyCuller.localize(bodyBox);
+			body.m_IsInside= (GLC_Frustum::InFrustum == bodyLocalisation);
+			body.m_IsCrossing= (GLC_Frustum::OutFrustum != bodyLocalisation);
+
+			if ((GLC_Frustum::IntersectFrustum == bodyLocalisation) && (NULL != body.m_pMesh))
+			{
+				const GLC_MeshBvh* pMeshBvh= meshBvh(body.m_pMesh);
+				if (!pMeshBvh->isEmpty())
+				{
+					body.m_pMeshBvh= pMeshBvh;
+					body.m_IsInside= true;
+					body.m_IsCrossing= false;
+					if (!planesAreSet)
+					{
+						localPlanes(frustum, pInstance->matrix(), planes);
+						planesAreSet= true;
+					}
+
+					// Split big hierarchies in subtrees tested in parallel
+					const QVector<GLC_Bvh::Node>& nodes= pMeshBvh->bvh().nodes();
+					QVector<int> roots;
+					roots.append(0);
+					if (pMeshBvh->triangleCount() > GLC_FRUSTUMSELECTOR_TASK_SIZE)
+					{
+						for (int depth= 0; depth < GLC_FRUSTUMSELECTOR_SPLIT_DEPTH; ++depth)
+						{
+							QVector<int> children;
+							const int rootCount= roots.size();
+							for (int root= 0; root < rootCount; ++root)
+							{
+								const GLC_Bvh::Node& node= nodes.at(roots.at(root));
+								if (0 == node.m_Count) children << (roots.at(root) + 1) << node.m_Offset;
+								else children << roots.at(root);
+							}
+							roots= children;
+						}
+					}
+
+					const int rootCount= roots.size();
+					for (int root= 0; root < rootCount; ++root)
+					{
+						TriangleTask task;
+						task.m_pMeshBvh= pMeshBvh;
+						for (int plane= 0; plane < 6; ++plane)
+						{
+							for (int coef= 0; coef < 4; ++coef) task.m_Planes[plane][coef]= planes[plane][coef];
+						}
+						task.m_Node= roots.at(root);
+						task.m_Mode= m_Mode;
+						task.m_StopOnFirst= stopOnFirst;
+						task.m_Body= bodies.size();
+						task.m_IsCrossing= false;
+						task.m_IsInside= true;
+						tasks.append(task);
+					}
+				}
+			}
+			bodies.append(body);
+		}
+	}
+
+	// Test the triangles and merge the results in the bodies
+	QtConcurrent::blockingMap(tasks, &GLC_FrustumSelector::testTriangles);
+	const int taskCount= tasks.size();
+	for (int i= 0; i < taskCount; ++i)
+	{
+		const TriangleTask& task= tasks.at(i);
+		BodyEntry& body= bodies[task.m_Body];
+		body.m_IsCrossing= body.m_IsCrossing || task.m_IsCrossing;
+		body.m_IsInside= body.m_IsInside && task.m_IsInside;
+		body.m_PrimitiveIds.unite(task.m_PrimitiveIds);
+	}
+	tasks.clear();
+
+	// Build the selection, the bodies of an instance are contiguous
+	const int bodyCount= bodies.size();
+	int first= 0;
+	while (first < bodyCount)
+	{
+		const GLC_uint instanceId= bodies.at(first).m_InstanceId;
+		int end= first + 1;
+		while ((end < bodyCount) && (bodies.at(end).m_InstanceId == instanceId)) ++end;
+
+		if (InstanceLevel == level)
+		{
+			bool isSelected= insideMode;
+			for (int i= first; i < end; ++i)
+			{
+				if (insideMode) isSelected= isSelected && bodies.at(i).m_IsInside;
+				else isSelected= isSelected || bodies.at(i).m_IsCrossing;
+			}
+			if (isSelected) subject.insert(instanceId, BodySelection());
+		}
+		else
+		{
+			for (int i= first; i < end; ++i)
+			{
+				const BodyEntry& body= bodies.at(i);
+				const bool bodyIsSelected= insideMode ? body.m_IsInside : body.m_IsCrossing;
+				PrimitiveSelection primitives;
+				if (PrimitiveLevel == level)
+				{
+					if (bodyIsSelected && (NULL == body.m_pMeshBvh))
+					{
+						// Entirely inside by its box
+						if (NULL != body.m_pMesh) primitives= body.m_pMesh->setOfPrimitiveId();
+					}
+					else if (NULL != body.m_pMeshBvh)
+					{
+						if (insideMode)
+						{
+							primitives= body.m_pMeshBvh->primitiveIds().toList().toSet();
+							primitives.subtract(body.m_PrimitiveIds);
+						}
+						else
+						{
+							primitives= body.m_PrimitiveIds;
+						}
+						if (primitives.isEmpty()) continue;
+					}
+					else continue;
+				}
+				else if (!bodyIsSelected) continue;
+
+				subject[instanceId].insert(body.m_BodyId, primitives);
+			}
+		}
+		first= end;
+	}
+
+	return subject;
+}
+
+const GLC_MeshBvh* GLC_FrustumSelector::meshBvh(GLC_Mesh* pMesh)
+{
+	// The hierarchy is shared by the mesh, it is referenced here while it is used
+	const QSharedPointer<const GLC_MeshBvh> pMeshBvh= pMesh->meshBvh();
+	m_MeshBvhHash.insert(pMesh->id(), pMeshBvh);
+	return pMeshBvh.data();
+}
+
+GLC_Frustum::Localisation GLC_FrustumSelector::localizeNode(const double planes[6][4], const GLC_Bvh::Node& node)
+{
+	GLC_Frustum::Localisation subject= GLC_Frustum::InFrustum;
+	for (int i= 0; i < 6; ++i)
+	{
+		// The positive vertex decides if the node is out, the negative one if it is crossed
+		const double* plane= planes[i];
+		double positive= plane[3];
+		double negative= plane[3];
+		for (int axis= 0; axis < 3; ++axis)
+		{
+			if (plane[axis] >= 0.0)
+			{
+				positive+= plane[axis] * node.m_Upper[axis];
+				negative+= plane[axis] * node.m_Lower[axis];
+			}
+			else
+			{
+				positive+= plane[axis] * node.m_Lower[axis];
+				negative+= plane[axis] * node.m_Upper[axis];
+			}
+		}
+		if (positive < 0.0) return GLC_Frustum::OutFrustum;
+		if (negative < 0.0) subject= GLC_Frustum::IntersectFrustum;
+	}
+	return subject;
+}
+
+void GLC_FrustumSelector::testTriangles(TriangleTask& task)
+{
+	const QVector<GLC_Bvh::Node>& nodes= task.m_pMeshBvh->bvh().nodes();
+	const float* pPositions= task.m_pMeshBvh->positions().constData();
+	const GLuint* pIndex= task.m_pMeshBvh->trianglesIndex().constData();
+	const GLC_uint* pPrimitiveIds= task.m_pMeshBvh->primitiveIds().constData();
+	const bool insideMode= (InsideMode == task.m_Mode);
+
+	QVector<int> stack;
+	stack.append(task.m_Node);
+	while (!stack.isEmpty())
+	{
+		const int nodeIndex= stack.last();
+		stack.removeLast();
+		const GLC_Bvh::Node& node= nodes.at(nodeIndex);
+
+		const GLC_Frustum::Localisation localisation= localizeNode(task.m_Planes, node);
+		if (GLC_Frustum::OutFrustum == localisation)
+		{
+			// No triangle of the node is inside
+			if (insideMode)
+			{
+				task.m_IsInside= false;
+				if (task.m_StopOnFirst) return;
+				insertPrimitiveIds(task.m_pMeshBvh, nodeIndex, &task.m_PrimitiveIds);
+			}
+		}
+		else if (GLC_Frustum::InFrustum == localisation)
+		{
+			// All triangles of the node are inside
+			task.m_IsCrossing= true;
+			if (!insideMode)
+			{
+				if (task.m_StopOnFirst) return;
+				insertPrimitiveIds(task.m_pMeshBvh, nodeIndex, &task.m_PrimitiveIds);
+			}
+		}
+		else if (0 == node.m_Count)
+		{
+			stack.append(nodeIndex + 1);
+			stack.append(node.m_Offset);
+		}
+		else
+		{
+			const int end= node.m_Offset + node.m_Count;
+			for (int slot= node.m_Offset; slot < end; ++slot)
+			{
+				const GLuint* pTriangle= pIndex + (slot * 3);
+				const float* p0= pPositions + (pTriangle[0] * 3);
+				const float* p1= pPositions + (pTriangle[1] * 3);
+				const float* p2= pPositions + (pTriangle[2] * 3);
+				if (insideMode)
+				{
+					if (!triangleIsInside(task.m_Planes, p0, p1, p2))
+					{
+						task.m_IsInside= false;
+						if (task.m_StopOnFirst) return;
+						task.m_PrimitiveIds.insert(pPrimitiveIds[slot]);
+					}
+				}
+				else if (triangleIsCrossing(task.m_Planes, p0, p1, p2))
+				{
+					task.m_IsCrossing= true;
+					if (task.m_StopOnFirst) return;
+					task.m_PrimitiveIds.insert(pPrimitiveIds[slot]);
+				}
+			}
+		}
+	}
+}
+
+void GLC_FrustumSelector::insertPrimitiveIds(const GLC_MeshBvh* pMeshBvh, int node, QSet<GLC_uint>* pIds)
+{
+	const QVector<GLC_Bvh::Node>& nodes= pMeshBvh->bvh().nodes();
+	const QVector<GLC_uint>& primitiveIds= pMeshBvh->primitiveIds();
+
+	// The slots of a subtree are contiguous, from its leftmost leaf to its rightmost leaf
+	int first= node;
+	while (0 == nodes.at(first).m_Count) first= first + 1;
+	int last= node;
+	while (0 == nodes.at(last).m_Count) last= nodes.at(last).m_Offset;
+
+	const int end= nodes.at(last).m_Offset + nodes.at(last).m_Count;
+	for (int slot= nodes.at(first).m_Offset; slot < end; ++slot)
+	{
+		pIds->insert(primitiveIds.at(slot));
+	}
+}
+
+void GLC_FrustumSelector::localPlanes(const GLC_Frustum& frustum, const GLC_Matrix4x4& matrix, double planes[6][4])
+{
+	// The local plane of a world plane P is transpose(M) * P
+	const double* m= matrix.getData();
+	const GLC_Plane worldPlanes[6]= {frustum.leftClippingPlane(), frustum.rightClippingPlane(),
+							frustum.topClippingPlane(), frustum.bottomClippingPlane(),
+							frustum.nearClippingPlane(), frustum.farClippingPlane()};
+	for (int i= 0; i < 6; ++i)
+	{
+		const double* p= worldPlanes[i].data();
+		for (int column= 0; column < 4; ++column)
+		{
+			planes[i][column]= p[0] * m[column * 4] + p[1] * m[column * 4 + 1] + p[2] * m[column * 4 + 2] + p[3] * m[column * 4 + 3];
+		}
+	}
+}
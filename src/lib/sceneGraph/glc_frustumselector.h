@@ -0,0 +1,232 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_frustumselector.h interface for the GLC_FrustumSelector class.
+
+#ifndef GLC_FRUSTUMSELECTOR_H_
+#define GLC_FRUSTUMSELECTOR_H_
+
+#include <QSet>
+#include <QHash>
+#include <QSharedPointer>
+
+#include "glc_selectionset.h"
+#include "../geometry/glc_meshbvh.h"
+#include "../viewport/glc_frustum.h"
+#include "../maths/glc_matrix4x4.h"
+
+#include "../glc_config.h"
+
+class GLC_3DViewCollection;
+class GLC_Mesh;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_FrustumSelector
+/*! \brief GLC_FrustumSelector : Select the instances of a collection inside a frustum on the CPU */
+
+/*! The selection frustum of a screen rectangle is returned by
+ *  GLC_Viewport::selectionFrustum(). Unlike GLC_Viewport::selectInsideSquare()
+ *  the scene is not rendered and no pixel is read back, so the cost of a selection
+ *  doesn't depend on the window size.
+ *
+ *  The candidate instances are given by the space partitioning of the collection
+ *  when it is used, their boxes are localized with a GLC_FrustumCuller.
+ *  Instances and bodies which are entirely in or out of the frustum are decided
+ *  from their boxes, the triangles of the crossed meshes are tested in parallel
+ *  with the GLC_MeshBvh of their LOD 0 given by the mesh, see GLC_State::isMeshBvhActivated().
+ *
+ *  In InsideMode an element is selected if all its triangles are inside the frustum,
+ *  in CrossingMode if one of its triangles is inside or crosses the frustum.
+ *  Geometries which are not meshes are selected from their bounding box.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_FrustumSelector
+{
+public:
+	//! The selection semantics
+	enum Mode
+	{
+		InsideMode,
+		CrossingMode
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a selector of the given collection with the given mode
+	explicit GLC_FrustumSelector(GLC_3DViewCollection* pCollection= NULL, Mode mode= InsideMode);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the collection of this selector
+	inline GLC_3DViewCollection* collection() const
+	{return m_pCollection;}
+
+	//! Return the selection mode
+	inline Mode mode() const
+	{return m_Mode;}
+
+	//! Return the number of built mesh hierarchies
+	inline int meshBvhCount() const
+	{return m_MeshBvhHash.size();}
+
+	//! Return true if the given triangle is entirely on the positive side of the given planes
+	static bool triangleIsInside(const double planes[6][4], const float* p0, const float* p1, const float* p2);
+
+	//! Return true if the given triangle is inside or crosses the volume of the given planes
+	static bool triangleIsCrossing(const double planes[6][4], const float* p0, const float* p1, const float* p2);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set the collection of this selector
+	void setCollection(GLC_3DViewCollection* pCollection);
+
+	//! Set the selection mode
+	inline void setMode(Mode mode)
+	{m_Mode= mode;}
+
+	//! Remove the meshes hierarchies of this selector
+	void clear();
+
+	//! Return the id of the visible instances selected by the given frustum
+	QSet<GLC_uint> selectInstances(const GLC_Frustum& frustum);
+
+	//! Return the bodies of the visible instances selected by the given frustum
+	/*! The primitive selection of each body is empty*/
+	OccurrenceSelection selectBodies(const GLC_Frustum& frustum);
+
+	//! Return the primitives of the visible instances selected by the given frustum
+	OccurrenceSelection selectPrimitives(const GLC_Frustum& frustum);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The selection granularity
+	enum Level
+	{
+		InstanceLevel,
+		BodyLevel,
+		PrimitiveLevel
+	};
+
+	//! The triangles test of a mesh subtree
+	struct TriangleTask
+	{
+		//! The mesh hierarchy
+		const GLC_MeshBvh* m_pMeshBvh;
+
+		//! The frustum planes in mesh coordinates
+		double m_Planes[6][4];
+
+		//! The root node of the tested subtree
+		int m_Node;
+
+		//! The selection mode
+		Mode m_Mode;
+
+		//! True to stop on the first triangle which decides the body
+		bool m_StopOnFirst;
+
+		//! The index of the tested body in the result
+		int m_Body;
+
+		//! Result : true if a triangle is inside or crosses the frustum
+		bool m_IsCrossing;
+
+		//! Result : true if all triangles are inside the frustum
+		bool m_IsInside;
+
+		//! Result : the crossing primitives in crossing mode, the not inside primitives in inside mode
+		QSet<GLC_uint> m_PrimitiveIds;
+	};
+
+	//! The localisation of a body of a candidate instance
+	struct BodyEntry
+	{
+		//! The instance id
+		GLC_uint m_InstanceId;
+
+		//! The body id
+		GLC_uint m_BodyId;
+
+		//! The body mesh, NULL if the body is not a mesh
+		GLC_Mesh* m_pMesh;
+
+		//! The mesh hierarchy if the triangles are tested, NULL otherwise
+		const GLC_MeshBvh* m_pMeshBvh;
+
+		//! True if a triangle is inside or crosses the frustum
+		bool m_IsCrossing;
+
+		//! True if all triangles are inside the frustum
+		bool m_IsInside;
+
+		//! The crossing primitives in crossing mode, the not inside primitives in inside mode
+		QSet<GLC_uint> m_PrimitiveIds;
+	};
+
+	//! Select the elements of the given level inside the given frustum
+	OccurrenceSelection select(const GLC_Frustum& frustum, Level level);
+
+	//! Return the hierarchy of the given mesh, build it if needed
+	const GLC_MeshBvh* meshBvh(GLC_Mesh* pMesh);
+
+	//! Return the localisation of the given node against the given planes
+	static GLC_Frustum::Localisation localizeNode(const double planes[6][4], const GLC_Bvh::Node& node);
+
+	//! Test the triangles of the given task
+	static void testTriangles(TriangleTask& task);
+
+	//! Insert the primitive ids of the given subtree in the given set
+	static void insertPrimitiveIds(const GLC_MeshBvh* pMeshBvh, int node, QSet<GLC_uint>* pIds);
+
+	//! Set the given planes to the planes of the given frustum in the local coordinates of the given matrix
+	static void localPlanes(const GLC_Frustum& frustum, const GLC_Matrix4x4& matrix, double planes[6][4]);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The collection
+	GLC_3DViewCollection* m_pCollection;
+
+	//! The selection mode
+	Mode m_Mode;
+
+	//! The meshes hierarchies by mesh id
+	QHash<GLC_uint, QSharedPointer<const GLC_MeshBvh> > m_MeshBvhHash;
+};
+
+#endif /* GLC_FRUSTUMSELECTOR_H_ */
@@ -0,0 +1,643 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_occlusionculler.cpp implementation of the GLC_OcclusionCuller class.
+
+#include "glc_occlusionculler.h"
+#include "glc_3dviewinstance.h"
+#include "../geometry/glc_mesh.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define GLC_OCCLUSIONCULLER_SSE
+#endif
+
+// The height of the depth buffer in pixels
+#define GLC_OCCLUSIONCULLER_HEIGHT 128
+
+// The maximum width of the depth buffer in pixels
+#define GLC_OCCLUSIONCULLER_MAX_WIDTH 512
+
+// A box is tested at the first level where it covers at most this number of pixels by side
+#define GLC_OCCLUSIONCULLER_TEST_SIZE 4
+
+// The occluder triangles of a mesh are removed when it has not been used by this number of culls
+#define GLC_OCCLUSIONCULLER_CACHE_CULLS 64
+
+// The smallest w of a clip space vertex
+#define GLC_OCCLUSIONCULLER_MIN_W 1e-9
+
+GLC_OcclusionCuller::GLC_OcclusionCuller()
+: m_Width(0)
+, m_Height(0)
+, m_Levels()
+, m_LevelWidths()
+, m_LevelHeights()
+, m_MaximumOccluderCount(32)
+, m_TriangleBudget(65536)
+, m_MinimumOccluderRatio(0.01)
+, m_ClipPlanes()
+, m_OccluderMeshHash()
+, m_CullCount(0)
+, m_OccluderCount(0)
+, m_ProcessedTriangleCount(0)
+, m_RasterizedTriangleCount(0)
+, m_TestedInstanceCount(0)
+, m_OccludedInstanceCount(0)
+{
+	for (int i= 0; i < 16; ++i)
+	{
+		m_Matrix[i]= ((i % 5) == 0) ? 1.0 : 0.0;
+	}
+	resizeLevels(2 * GLC_OCCLUSIONCULLER_HEIGHT, GLC_OCCLUSIONCULLER_HEIGHT);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Get Functions
+//////////////////////////////////////////////////////////////////////
+
+bool GLC_OcclusionCuller::isOccluded(const GLC_BoundingBox& box) const
+{
+	return isOccluded(projectBox(box));
+}
+
+const char* GLC_OcclusionCuller::instructionSet()
+{
+#if defined(GLC_OCCLUSIONCULLER_SSE)
+	return "SSE";
+#else
+	return "Scalar";
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////
+// Set Functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_OcclusionCuller::setViewportSize(int width, int height)
+{
+	if ((width <= 0) || (height <= 0)) return;
+
+	const int bufferHeight= GLC_OCCLUSIONCULLER_HEIGHT;
+	int bufferWidth= qRound(static_cast<double>(bufferHeight) * width / height);
+	bufferWidth= qBound(4, bufferWidth, GLC_OCCLUSIONCULLER_MAX_WIDTH);
+	if ((bufferWidth != m_Width) || (bufferHeight != m_Height))
+	{
+		resizeLevels(bufferWidth, bufferHeight);
+	}
+}
+
+int GLC_OcclusionCuller::cull(const QList<GLC_3DViewInstance*>& instances, const GLC_Matrix4x4& compositionMatrix)
+{
+	clear(compositionMatrix);
+	++m_CullCount;
+	m_OccluderCount= 0;
+	m_OccludedInstanceCount= 0;
+
+	const int count= instances.size();
+	m_TestedInstanceCount= count;
+
+	// Project the instances boxes and choose the occluder candidates
+	QVector<ScreenBox> screenBoxes(count);
+	QVector<Candidate> candidates;
+	for (int i= 0; i < count; ++i)
+	{
+		GLC_3DViewInstance* pInstance= instances.at(i);
+		screenBoxes[i]= projectBox(pInstance->boundingBox());
+		if ((screenBoxes.at(i).m_Ratio >= m_MinimumOccluderRatio) && canOcclude(pInstance))
+		{
+			Candidate candidate;
+			candidate.m_pInstance= pInstance;
+			candidate.m_Ratio= screenBoxes.at(i).m_Ratio;
+			candidates.append(candidate);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), coversMore);
+
+	// Rasterize the largest occluders
+	const int candidateCount= candidates.size();
+	for (int i= 0; (i < candidateCount) && (m_OccluderCount < m_MaximumOccluderCount); ++i)
+	{
+		if (m_ProcessedTriangleCount >= m_TriangleBudget) break;
+		if (rasterizeInstance(candidates.at(i).m_pInstance) > 0)
+		{
+			++m_OccluderCount;
+		}
+	}
+
+	// Remove the occluder triangles of the meshes no more used
+	QHash<GLC_uint, OccluderMesh>::iterator iMesh= m_OccluderMeshHash.begin();
+	while (iMesh != m_OccluderMeshHash.end())
+	{
+		if ((m_CullCount - iMesh.value().m_LastCull) > GLC_OCCLUSIONCULLER_CACHE_CULLS)
+		{
+			iMesh= m_OccluderMeshHash.erase(iMesh);
+		}
+		else
+		{
+			++iMesh;
+		}
+	}
+
+	if (0 == m_OccluderCount) return 0;
+
+	buildHierarchy();
+
+	// Test the instances boxes
+	for (int i= 0; i < count; ++i)
+	{
+		if (isOccluded(screenBoxes.at(i)))
+		{
+			instances.at(i)->setViewable(GLC_3DViewInstance::NoViewable);
+			++m_OccludedInstanceCount;
+		}
+	}
+
+	return m_OccludedInstanceCount;
+}
+
+void GLC_OcclusionCuller::clear(const GLC_Matrix4x4& compositionMatrix)
+{
+	const double* pData= compositionMatrix.getData();
+	for (int i= 0; i < 16; ++i)
+	{
+		m_Matrix[i]= pData[i];
+	}
+	m_Levels.first().fill(1.0f);
+	m_ProcessedTriangleCount= 0;
+	m_RasterizedTriangleCount= 0;
+}
+
+void GLC_OcclusionCuller::rasterizeTriangles(const GLfloatVector& positions, const QVector<GLuint>& index, const GLC_Matrix4x4& matrix)
+{
+	Q_ASSERT((index.size() % 3) == 0);
+
+	// The matrix from the given coordinates to the clip space
+	const double* m= m_Matrix;
+	const double* n= matrix.getData();
+	double f[16];
+	for (int column= 0; column < 4; ++column)
+	{
+		for (int row= 0; row < 4; ++row)
+		{
+			f[column * 4 + row]= m[row] * n[column * 4] + m[4 + row] * n[column * 4 + 1]
+							   + m[8 + row] * n[column * 4 + 2] + m[12 + row] * n[column * 4 + 3];
+		}
+	}
+
+	// Transform the vertices in clip space
+	const int vertexCount= positions.size() / 3;
+	QVector<double> clipPositions(vertexCount * 4);
+	const float* pPosition= positions.constData();
+	double* pClip= clipPositions.data();
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		const double x= pPosition[0];
+		const double y= pPosition[1];
+		const double z= pPosition[2];
+		for (int row= 0; row < 4; ++row)
+		{
+			pClip[row]= f[row] * x + f[4 + row] * y + f[8 + row] * z + f[12 + row];
+		}
+		pPosition+= 3;
+		pClip+= 4;
+	}
+
+	// The culled and clipped triangles cost time, they count in the budget
+	const int triangleCount= index.size() / 3;
+	m_ProcessedTriangleCount+= triangleCount;
+	for (int i= 0; i < triangleCount; ++i)
+	{
+		const GLuint* pTriangle= index.constData() + (i * 3);
+		if ((pTriangle[0] >= static_cast<GLuint>(vertexCount)) || (pTriangle[1] >= static_cast<GLuint>(vertexCount))
+				|| (pTriangle[2] >= static_cast<GLuint>(vertexCount))) continue;
+
+		double clip[3][4];
+		for (int vertex= 0; vertex < 3; ++vertex)
+		{
+			const double* pVertex= clipPositions.constData() + (pTriangle[vertex] * 4);
+			for (int j= 0; j < 4; ++j)
+			{
+				clip[vertex][j]= pVertex[j];
+			}
+		}
+
+		// Reject the triangles entirely out of one of the clipping planes
+		bool outside= false;
+		for (int axis= 0; (axis < 3) && !outside; ++axis)
+		{
+			outside= ((clip[0][axis] < -clip[0][3]) && (clip[1][axis] < -clip[1][3]) && (clip[2][axis] < -clip[2][3]))
+					|| ((clip[0][axis] > clip[0][3]) && (clip[1][axis] > clip[1][3]) && (clip[2][axis] > clip[2][3]));
+		}
+		if (!outside)
+		{
+			rasterizeTriangle(clip);
+		}
+	}
+}
+
+void GLC_OcclusionCuller::buildHierarchy()
+{
+	const int levelCount= m_Levels.size();
+	for (int level= 1; level < levelCount; ++level)
+	{
+		const QVector<float>& previous= m_Levels.at(level - 1);
+		const int previousWidth= m_LevelWidths.at(level - 1);
+		const int previousHeight= m_LevelHeights.at(level - 1);
+		const int width= m_LevelWidths.at(level);
+		const int height= m_LevelHeights.at(level);
+		float* pDepth= m_Levels[level].data();
+		for (int y= 0; y < height; ++y)
+		{
+			const int y0= 2 * y;
+			const int y1= qMin(y0 + 1, previousHeight - 1);
+			for (int x= 0; x < width; ++x)
+			{
+				const int x0= 2 * x;
+				const int x1= qMin(x0 + 1, previousWidth - 1);
+				const float depth0= qMax(previous.at(y0 * previousWidth + x0), previous.at(y0 * previousWidth + x1));
+				const float depth1= qMax(previous.at(y1 * previousWidth + x0), previous.at(y1 * previousWidth + x1));
+				pDepth[y * width + x]= qMax(depth0, depth1);
+			}
+		}
+	}
+}
+
+void GLC_OcclusionCuller::clearCache()
+{
+	m_OccluderMeshHash.clear();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+bool GLC_OcclusionCuller::coversMore(const Candidate& first, const Candidate& second)
+{
+	return first.m_Ratio > second.m_Ratio;
+}
+
+bool GLC_OcclusionCuller::canOcclude(GLC_3DViewInstance* pInstance) const
+{
+	bool subject= !pInstance->isTransparent() && !pInstance->renderPropertiesHandle()->needToRenderWithTransparency()
+			&& (pInstance->polygonMode() == GL_FILL);
+
+	// The box must be entirely kept by the clip planes
+	const int clipPlaneCount= m_ClipPlanes.size();
+	if (subject && (clipPlaneCount > 0))
+	{
+		const GLC_BoundingBox box(pInstance->boundingBox());
+		const double* lower= box.lowerCorner().data();
+		const double* upper= box.upperCorner().data();
+		for (int i= 0; subject && (i < clipPlaneCount); ++i)
+		{
+			// The distance of the box corner the nearest to the clipped side
+			const double* plane= m_ClipPlanes.at(i).data();
+			double distance= plane[3];
+			for (int axis= 0; axis < 3; ++axis)
+			{
+				distance+= plane[axis] * ((plane[axis] >= 0.0) ? lower[axis] : upper[axis]);
+			}
+			subject= (distance >= 0.0);
+		}
+	}
+	return subject;
+}
+
+GLC_OcclusionCuller::ScreenBox GLC_OcclusionCuller::projectBox(const GLC_BoundingBox& box) const
+{
+	ScreenBox screenBox;
+	screenBox.m_MinX= 0;
+	screenBox.m_MinY= 0;
+	screenBox.m_MaxX= -1;
+	screenBox.m_MaxY= -1;
+	screenBox.m_MinZ= 1.0f;
+	screenBox.m_CrossNear= false;
+	screenBox.m_OnScreen= false;
+	screenBox.m_Ratio= 0.0;
+	if (box.isEmpty()) return screenBox;
+
+	const GLC_Point3d& lower= box.lowerCorner();
+	const GLC_Point3d& upper= box.upperCorner();
+	const double* m= m_Matrix;
+	double minX= 1.0;
+	double minY= 1.0;
+	double minZ= 1.0;
+	double maxX= -1.0;
+	double maxY= -1.0;
+	for (int corner= 0; corner < 8; ++corner)
+	{
+		const double x= (corner & 1) ? upper.x() : lower.x();
+		const double y= (corner & 2) ? upper.y() : lower.y();
+		const double z= (corner & 4) ? upper.z() : lower.z();
+		const double clipZ= m[2] * x + m[6] * y + m[10] * z + m[14];
+		const double clipW= m[3] * x + m[7] * y + m[11] * z + m[15];
+		if ((clipW <= GLC_OCCLUSIONCULLER_MIN_W) || (clipZ < -clipW))
+		{
+			// The box crosses the near plane, it covers the whole view
+			screenBox.m_CrossNear= true;
+			screenBox.m_Ratio= 1.0;
+			return screenBox;
+		}
+		const double clipX= m[0] * x + m[4] * y + m[8] * z + m[12];
+		const double clipY= m[1] * x + m[5] * y + m[9] * z + m[13];
+		const double ndcX= clipX / clipW;
+		const double ndcY= clipY / clipW;
+		const double ndcZ= clipZ / clipW;
+		if (0 == corner)
+		{
+			minX= maxX= ndcX;
+			minY= maxY= ndcY;
+			minZ= ndcZ;
+		}
+		else
+		{
+			minX= qMin(minX, ndcX);
+			maxX= qMax(maxX, ndcX);
+			minY= qMin(minY, ndcY);
+			maxY= qMax(maxY, ndcY);
+			minZ= qMin(minZ, ndcZ);
+		}
+	}
+
+	minX= qMax(minX, -1.0);
+	minY= qMax(minY, -1.0);
+	maxX= qMin(maxX, 1.0);
+	maxY= qMin(maxY, 1.0);
+	if ((minX > maxX) || (minY > maxY)) return screenBox;
+	screenBox.m_Ratio= (maxX - minX) * (maxY - minY) / 4.0;
+
+	// All the pixels touched by the box are covered
+	screenBox.m_MinX= qMax(0, static_cast<int>(std::floor((minX * 0.5 + 0.5) * m_Width)));
+	screenBox.m_MinY= qMax(0, static_cast<int>(std::floor((minY * 0.5 + 0.5) * m_Height)));
+	screenBox.m_MaxX= qMin(m_Width - 1, static_cast<int>(std::floor((maxX * 0.5 + 0.5) * m_Width)));
+	screenBox.m_MaxY= qMin(m_Height - 1, static_cast<int>(std::floor((maxY * 0.5 + 0.5) * m_Height)));
+	screenBox.m_OnScreen= (screenBox.m_MinX <= screenBox.m_MaxX) && (screenBox.m_MinY <= screenBox.m_MaxY);
+	screenBox.m_MinZ= static_cast<float>(minZ);
+
+	return screenBox;
+}
+
+bool GLC_OcclusionCuller::isOccluded(const ScreenBox& screenBox) const
+{
+	if (screenBox.m_CrossNear || !screenBox.m_OnScreen) return false;
+
+	// Choose the level where the box covers a few pixels
+	const int levelCount= m_Levels.size();
+	int level= 0;
+	int minX= screenBox.m_MinX;
+	int minY= screenBox.m_MinY;
+	int maxX= screenBox.m_MaxX;
+	int maxY= screenBox.m_MaxY;
+	while (((level + 1) < levelCount) && (((maxX - minX) >= GLC_OCCLUSIONCULLER_TEST_SIZE) || ((maxY - minY) >= GLC_OCCLUSIONCULLER_TEST_SIZE)))
+	{
+		++level;
+		minX/= 2;
+		minY/= 2;
+		maxX/= 2;
+		maxY/= 2;
+	}
+
+	const QVector<float>& depths= m_Levels.at(level);
+	const int width= m_LevelWidths.at(level);
+	for (int y= minY; y <= maxY; ++y)
+	{
+		const float* pDepth= depths.constData() + (y * width);
+		for (int x= minX; x <= maxX; ++x)
+		{
+			if (pDepth[x] >= screenBox.m_MinZ) return false;
+		}
+	}
+	return true;
+}
+
+int GLC_OcclusionCuller::rasterizeInstance(GLC_3DViewInstance* pInstance)
+{
+	int triangleCount= 0;
+	const int geometryCount= pInstance->numberOfGeometry();
+	for (int i= 0; i < geometryCount; ++i)
+	{
+		const GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pInstance->geomAt(i));
+		if ((NULL != pMesh) && !pMesh->hasTransparentMaterials())
+		{
+			const OccluderMesh& occluder= occluderMesh(pMesh);
+			rasterizeTriangles(occluder.m_pMeshBvh->positions(), occluder.m_pMeshBvh->trianglesIndex(), pInstance->matrix());
+			triangleCount+= occluder.m_pMeshBvh->triangleCount();
+		}
+	}
+	return triangleCount;
+}
+
+const GLC_OcclusionCuller::OccluderMesh& GLC_OcclusionCuller::occluderMesh(const GLC_Mesh* pMesh)
+{
+	QHash<GLC_uint, OccluderMesh>::iterator iMesh= m_OccluderMeshHash.find(pMesh->id());
+	if (iMesh == m_OccluderMeshHash.end())
+	{
+		iMesh= m_OccluderMeshHash.insert(pMesh->id(), OccluderMesh());
+	}
+	// The mesh keeps the hierarchy of its current data
+	iMesh.value().m_pMeshBvh= pMesh->meshBvh(qMax(0, pMesh->lodCount() - 1));
+	iMesh.value().m_LastCull= m_CullCount;
+
+	return iMesh.value();
+}
+
+void GLC_OcclusionCuller::rasterizeTriangle(const double clip[3][4])
+{
+	// Clip the triangle with the near plane (z >= -w)
+	double polygon[4][4];
+	int vertexCount= 0;
+	for (int i= 0; i < 3; ++i)
+	{
+		const int j= (i + 1) % 3;
+		const double distanceI= clip[i][2] + clip[i][3];
+		const double distanceJ= clip[j][2] + clip[j][3];
+		if (distanceI >= 0.0)
+		{
+			for (int k= 0; k < 4; ++k) polygon[vertexCount][k]= clip[i][k];
+			++vertexCount;
+		}
+		if ((distanceI >= 0.0) != (distanceJ >= 0.0))
+		{
+			const double t= distanceI / (distanceI - distanceJ);
+			for (int k= 0; k < 4; ++k) polygon[vertexCount][k]= clip[i][k] + t * (clip[j][k] - clip[i][k]);
+			++vertexCount;
+		}
+	}
+	if (vertexCount < 3) return;
+
+	// Project the polygon in the depth buffer
+	double screen[4][3];
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		const double w= polygon[i][3];
+		if (w <= GLC_OCCLUSIONCULLER_MIN_W) return;
+		screen[i][0]= (polygon[i][0] / w * 0.5 + 0.5) * m_Width;
+		screen[i][1]= (polygon[i][1] / w * 0.5 + 0.5) * m_Height;
+		screen[i][2]= polygon[i][2] / w;
+	}
+
+	// Rasterize the polygon as a fan of triangles
+	for (int i= 2; i < vertexCount; ++i)
+	{
+		const double triangle[3][3]= {{screen[0][0], screen[0][1], screen[0][2]}
+									, {screen[i - 1][0], screen[i - 1][1], screen[i - 1][2]}
+									, {screen[i][0], screen[i][1], screen[i][2]}};
+		rasterizeScreenTriangle(triangle);
+	}
+}
+
+void GLC_OcclusionCuller::rasterizeScreenTriangle(const double v[3][3])
+{
+	const double* p0= v[0];
+	const double* p1= v[1];
+	const double* p2= v[2];
+	double area= (p1[0] - p0[0]) * (p2[1] - p0[1]) - (p1[1] - p0[1]) * (p2[0] - p0[0]);
+	if (qAbs(area) < 1e-12) return;
+	++m_RasterizedTriangleCount;
+
+	// Both faces are rasterized, the triangle is made counter clockwise
+	if (area < 0.0)
+	{
+		qSwap(p1, p2);
+		area= -area;
+	}
+
+	// The pixels whose center may be inside the triangle
+	const int minX= qMax(0, static_cast<int>(std::ceil(qMin(p0[0], qMin(p1[0], p2[0])) - 0.5)));
+	const int minY= qMax(0, static_cast<int>(std::ceil(qMin(p0[1], qMin(p1[1], p2[1])) - 0.5)));
+	const int maxX= qMin(m_Width - 1, static_cast<int>(std::floor(qMax(p0[0], qMax(p1[0], p2[0])) - 0.5)));
+	const int maxY= qMin(m_Height - 1, static_cast<int>(std::floor(qMax(p0[1], qMax(p1[1], p2[1])) - 0.5)));
+	if ((minX > maxX) || (minY > maxY)) return;
+
+	// Edge functions a * x + b * y + c, positive inside, the edge i is opposite to the vertex i
+	const double* edgeStart[3]= {p1, p2, p0};
+	const double* edgeEnd[3]= {p2, p0, p1};
+	const double* vertices[3]= {p0, p1, p2};
+	double a[3];
+	double b[3];
+	double c[3];
+	double depthA= 0.0;
+	double depthB= 0.0;
+	double depthC= 0.0;
+	for (int i= 0; i < 3; ++i)
+	{
+		a[i]= edgeStart[i][1] - edgeEnd[i][1];
+		b[i]= edgeEnd[i][0] - edgeStart[i][0];
+		c[i]= -(a[i] * edgeStart[i][0] + b[i] * edgeStart[i][1]);
+
+		// The depth is interpolated with the barycentric coordinates edge / area
+		depthA+= a[i] * vertices[i][2];
+		depthB+= b[i] * vertices[i][2];
+		depthC+= c[i] * vertices[i][2];
+	}
+	depthA/= area;
+	depthB/= area;
+	depthC/= area;
+
+#if defined(GLC_OCCLUSIONCULLER_SSE)
+	// Rows are rasterized by blocks of 4 pixels, the buffer width is a multiple of 4
+	const int firstX= minX & ~3;
+	const __m128 offsets= _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+	const __m128 zero= _mm_setzero_ps();
+	const __m128 stepA0= _mm_set1_ps(static_cast<float>(4.0 * a[0]));
+	const __m128 stepA1= _mm_set1_ps(static_cast<float>(4.0 * a[1]));
+	const __m128 stepA2= _mm_set1_ps(static_cast<float>(4.0 * a[2]));
+	const __m128 stepDepth= _mm_set1_ps(static_cast<float>(4.0 * depthA));
+	for (int y= minY; y <= maxY; ++y)
+	{
+		const double centerX= firstX + 0.5;
+		const double centerY= y + 0.5;
+		__m128 edge0= _mm_add_ps(_mm_set1_ps(static_cast<float>(a[0] * centerX + b[0] * centerY + c[0])), _mm_mul_ps(offsets, _mm_set1_ps(static_cast<float>(a[0]))));
+		__m128 edge1= _mm_add_ps(_mm_set1_ps(static_cast<float>(a[1] * centerX + b[1] * centerY + c[1])), _mm_mul_ps(offsets, _mm_set1_ps(static_cast<float>(a[1]))));
+		__m128 edge2= _mm_add_ps(_mm_set1_ps(static_cast<float>(a[2] * centerX + b[2] * centerY + c[2])), _mm_mul_ps(offsets, _mm_set1_ps(static_cast<float>(a[2]))));
+		__m128 depth= _mm_add_ps(_mm_set1_ps(static_cast<float>(depthA * centerX + depthB * centerY + depthC)), _mm_mul_ps(offsets, _mm_set1_ps(static_cast<float>(depthA))));
+
+		float* pRow= m_Levels[0].data() + (y * m_Width);
+		for (int x= firstX; x <= maxX; x+= 4)
+		{
+			const __m128 inside= _mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_and_ps(_mm_cmpge_ps(edge1, zero), _mm_cmpge_ps(edge2, zero)));
+			const __m128 current= _mm_loadu_ps(pRow + x);
+			const __m128 nearest= _mm_min_ps(current, depth);
+			_mm_storeu_ps(pRow + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+
+			edge0= _mm_add_ps(edge0, stepA0);
+			edge1= _mm_add_ps(edge1, stepA1);
+			edge2= _mm_add_ps(edge2, stepA2);
+			depth= _mm_add_ps(depth, stepDepth);
+		}
+	}
+#else
+	const float stepA0= static_cast<float>(a[0]);
+	const float stepA1= static_cast<float>(a[1]);
+	const float stepA2= static_cast<float>(a[2]);
+	const float stepDepth= static_cast<float>(depthA);
+	for (int y= minY; y <= maxY; ++y)
+	{
+		const double centerX= minX + 0.5;
+		const double centerY= y + 0.5;
+		float edge0= static_cast<float>(a[0] * centerX + b[0] * centerY + c[0]);
+		float edge1= static_cast<float>(a[1] * centerX + b[1] * centerY + c[1]);
+		float edge2= static_cast<float>(a[2] * centerX + b[2] * centerY + c[2]);
+		float depth= static_cast<float>(depthA * centerX + depthB * centerY + depthC);
+
+		float* pRow= m_Levels[0].data() + (y * m_Width);
+		for (int x= minX; x <= maxX; ++x)
+		{
+			if ((edge0 >= 0.0f) && (edge1 >= 0.0f) && (edge2 >= 0.0f) && (depth < pRow[x]))
+			{
+				pRow[x]= depth;
+			}
+			edge0+= stepA0;
+			edge1+= stepA1;
+			edge2+= stepA2;
+			depth+= stepDepth;
+		}
+	}
+#endif
+}
+
+void GLC_OcclusionCuller::resizeLevels(int width, int height)
+{
+	// The width is a multiple of 4 for the blocks of the rasterizer
+	m_Width= ((width + 3) / 4) * 4;
+	m_Height= height;
+
+	m_Levels.clear();
+	m_LevelWidths.clear();
+	m_LevelHeights.clear();
+	int levelWidth= m_Width;
+	int levelHeight= m_Height;
+	m_Levels.append(QVector<float>(levelWidth * levelHeight, 1.0f));
+	m_LevelWidths.append(levelWidth);
+	m_LevelHeights.append(levelHeight);
+	while ((levelWidth > 1) || (levelHeight > 1))
+	{
+		levelWidth= (levelWidth + 1) / 2;
+		levelHeight= (levelHeight + 1) / 2;
+		m_Levels.append(QVector<float>(levelWidth * levelHeight, 1.0f));
+		m_LevelWidths.append(levelWidth);
+		m_LevelHeights.append(levelHeight);
+	}
+}
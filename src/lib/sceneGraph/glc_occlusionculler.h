@@ -0,0 +1,308 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_occlusionculler.h interface for the GLC_OcclusionCuller class.
+
+#ifndef GLC_OCCLUSIONCULLER_H_
+#define GLC_OCCLUSIONCULLER_H_
+
+#include <QVector>
+#include <QList>
+#include <QHash>
+#include <QSharedPointer>
+
+#include "../glc_global.h"
+#include "../glc_boundingbox.h"
+#include "../maths/glc_matrix4x4.h"
+#include "../maths/glc_plane.h"
+
+#include "../glc_config.h"
+
+class GLC_3DViewInstance;
+class GLC_Mesh;
+class GLC_MeshBvh;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_OcclusionCuller
+/*! \brief GLC_OcclusionCuller : Hide the instances occluded by the largest occluders on the CPU */
+
+/*! The culler works on a low resolution depth buffer :
+ *  - The instances whose projected bounding box is the largest are chosen as occluders,
+ *    the triangles of the coarsest LOD of their meshes are rasterized in the depth buffer
+ *  - A hierarchy of the depth buffer is built, each level keeping the farthest depth
+ *    of 2 x 2 pixels of the previous one
+ *  - The bounding box of each instance is projected and compared to the level of the
+ *    hierarchy where it covers a few pixels, an instance is occluded if its nearest
+ *    depth is behind all the covered depths
+ *
+ *  Rows of pixels are rasterized 4 at a time with SSE when the library is compiled
+ *  for this instruction set, otherwise a scalar loop is used.
+ *
+ *  Transparent and wire instances are not used as occluders, nor instances crossing
+ *  one of the clip planes since their clipped part doesn't hide. Boxes crossing the near
+ *  plane are never occluded. Pixels are covered when their center is inside an occluder
+ *  triangle, so an instance seen through a gap thinner than a depth buffer pixel may be culled.
+ *
+ *  The occluder triangles are the hierarchy of the coarsest LOD given by the mesh, built from
+ *  the client side data : once the meshes are uploaded GLC_State::isMeshBvhActivated() must be
+ *  true to keep it. They are referenced by mesh id while the mesh is used as occluder
+ *  by recent culls or until clearCache() is called. The culler doesn't need an OpenGL context.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_OcclusionCuller
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a culler with the default depth buffer size
+	GLC_OcclusionCuller();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the depth buffer width in pixels
+	inline int width() const
+	{return m_Width;}
+
+	//! Return the depth buffer height in pixels
+	inline int height() const
+	{return m_Height;}
+
+	//! Return the number of levels of the depth hierarchy
+	inline int levelCount() const
+	{return m_Levels.size();}
+
+	//! Return the depth buffer, row by row from the bottom of the view
+	/*! Depths are normalized device coordinates, 1.0 where nothing have been rasterized*/
+	inline const QVector<float>& depthBuffer() const
+	{return m_Levels.first();}
+
+	//! Return the maximum number of occluders of a cull
+	inline int maximumOccluderCount() const
+	{return m_MaximumOccluderCount;}
+
+	//! Return the number of processed triangles after which a cull stops adding occluders
+	inline int triangleBudget() const
+	{return m_TriangleBudget;}
+
+	//! Return the minimum ratio of the view covered by the box of an occluder
+	inline double minimumOccluderRatio() const
+	{return m_MinimumOccluderRatio;}
+
+	//! Return the number of occluders of the last cull
+	inline int occluderCount() const
+	{return m_OccluderCount;}
+
+	//! Return the number of occluder triangles processed since the last clear
+	/*! The rejected triangles are counted, this number is bounded by the triangle budget*/
+	inline int processedTriangleCount() const
+	{return m_ProcessedTriangleCount;}
+
+	//! Return the number of screen triangles rasterized since the last clear
+	/*! The rejected and degenerated triangles are not counted, a triangle clipped by the near plane can count twice*/
+	inline int rasterizedTriangleCount() const
+	{return m_RasterizedTriangleCount;}
+
+	//! Return the number of instances tested by the last cull
+	inline int testedInstanceCount() const
+	{return m_TestedInstanceCount;}
+
+	//! Return the number of instances occluded by the last cull
+	inline int occludedInstanceCount() const
+	{return m_OccludedInstanceCount;}
+
+	//! Return true if the given world bounding box is occluded
+	/*! The depth hierarchy must have been built*/
+	bool isOccluded(const GLC_BoundingBox& box) const;
+
+	//! Return the name of the instruction set used to rasterize
+	static const char* instructionSet();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set the depth buffer size from the given view size
+	/*! The depth buffer keeps the aspect ratio of the view with a fixed height*/
+	void setViewportSize(int width, int height);
+
+	//! Set the maximum number of occluders of a cull
+	inline void setMaximumOccluderCount(int count)
+	{m_MaximumOccluderCount= qMax(0, count);}
+
+	//! Set the number of processed triangles after which a cull stops adding occluders
+	inline void setTriangleBudget(int count)
+	{m_TriangleBudget= qMax(0, count);}
+
+	//! Set the minimum ratio of the view covered by the box of an occluder
+	inline void setMinimumOccluderRatio(double ratio)
+	{m_MinimumOccluderRatio= ratio;}
+
+	//! Set the clip planes in world coordinates, the kept half space is on the positive side
+	inline void setClipPlanes(const QList<GLC_Plane>& planes)
+	{m_ClipPlanes= planes;}
+
+	//! Set the NoViewable flag of the given instances occluded with the given composition matrix
+	/*! The instances must be visible and not culled by the frustum.
+	 *  Return the number of occluded instances*/
+	int cull(const QList<GLC_3DViewInstance*>& instances, const GLC_Matrix4x4& compositionMatrix);
+
+	//! Clear the depth buffer and set the composition matrix (projection * modelview)
+	void clear(const GLC_Matrix4x4& compositionMatrix);
+
+	//! Rasterize the given triangles placed with the given matrix in the depth buffer
+	/*! positions contains 3 floats per vertex and index 3 vertices per triangle*/
+	void rasterizeTriangles(const GLfloatVector& positions, const QVector<GLuint>& index, const GLC_Matrix4x4& matrix);
+
+	//! Build the depth hierarchy from the depth buffer
+	void buildHierarchy();
+
+	//! Remove the occluder triangles kept by this culler
+	void clearCache();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The projection of a bounding box in the depth buffer
+	struct ScreenBox
+	{
+		//! The covered pixels, bounds included
+		int m_MinX;
+		int m_MinY;
+		int m_MaxX;
+		int m_MaxY;
+
+		//! The nearest depth of the box
+		float m_MinZ;
+
+		//! True if the box crosses the near plane
+		bool m_CrossNear;
+
+		//! True if the box covers at least one pixel
+		bool m_OnScreen;
+
+		//! The ratio of the view covered by the box
+		double m_Ratio;
+	};
+
+	//! The coarsest LOD triangles of a mesh
+	struct OccluderMesh
+	{
+		//! The hierarchy of the coarsest LOD of the mesh
+		QSharedPointer<const GLC_MeshBvh> m_pMeshBvh;
+
+		//! The number of the last cull which used this mesh
+		int m_LastCull;
+	};
+
+	//! An occluder candidate of a cull
+	struct Candidate
+	{
+		//! The candidate instance
+		GLC_3DViewInstance* m_pInstance;
+
+		//! The ratio of the view covered by its box
+		double m_Ratio;
+	};
+
+	//! Return true if the first candidate covers more of the view than the second one
+	static bool coversMore(const Candidate& first, const Candidate& second);
+
+	//! Return true if the given instance can occlude
+	bool canOcclude(GLC_3DViewInstance* pInstance) const;
+
+	//! Return the projection of the given world bounding box
+	ScreenBox projectBox(const GLC_BoundingBox& box) const;
+
+	//! Return true if the given projected box is occluded
+	bool isOccluded(const ScreenBox& screenBox) const;
+
+	//! Rasterize the occluder triangles of the given instance, return the number of triangles
+	int rasterizeInstance(GLC_3DViewInstance* pInstance);
+
+	//! Return the occluder triangles of the given mesh
+	const OccluderMesh& occluderMesh(const GLC_Mesh* pMesh);
+
+	//! Clip the given clip space triangle with the near plane and rasterize it
+	void rasterizeTriangle(const double clip[3][4]);
+
+	//! Rasterize the given screen space triangle, 3 coordinates (x, y, depth) by vertex
+	void rasterizeScreenTriangle(const double v[3][3]);
+
+	//! Resize the depth buffer and the hierarchy levels
+	void resizeLevels(int width, int height);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The depth buffer size
+	int m_Width;
+	int m_Height;
+
+	//! The depth hierarchy, the first level is the depth buffer
+	QVector<QVector<float> > m_Levels;
+
+	//! The width and height of each level
+	QVector<int> m_LevelWidths;
+	QVector<int> m_LevelHeights;
+
+	//! The composition matrix in column major order
+	double m_Matrix[16];
+
+	//! The maximum number of occluders of a cull
+	int m_MaximumOccluderCount;
+
+	//! The maximum number of occluder triangles processed by a cull
+	int m_TriangleBudget;
+
+	//! The minimum ratio of the view covered by the box of an occluder
+	double m_MinimumOccluderRatio;
+
+	//! The clip planes
+	QList<GLC_Plane> m_ClipPlanes;
+
+	//! The occluder triangles by mesh id
+	QHash<GLC_uint, OccluderMesh> m_OccluderMeshHash;
+
+	//! The number of culls done by this culler
+	int m_CullCount;
+
+	//! The statistics of the last cull
+	int m_OccluderCount;
+	int m_ProcessedTriangleCount;
+	int m_RasterizedTriangleCount;
+	int m_TestedInstanceCount;
+	int m_OccludedInstanceCount;
+};
+
+#endif /* GLC_OCCLUSIONCULLER_H_ */
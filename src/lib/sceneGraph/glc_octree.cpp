@@ -70,6 +70,16 @@ QList<GLC_3DViewInstance*> GLC_Octree::listOfIntersectedInstances(const GLC_Boun
 	return m_pRootNode->setOfIntersectedInstances(bBox).toList();
 }
 
+QList<GLC_3DViewInstance*> GLC_Octree::listOfInstancesInFrustum(const GLC_Frustum& frustum)
+{
+	if (NULL == m_pRootNode)
+	{
+		updateSpacePartitioning();
+	}
+	const GLC_FrustumCuller culler(frustum);
+	return m_pRootNode->setOfInstancesInFrustum(culler).toList();
+}
+
 void GLC_Octree::updateViewableInstances(const GLC_Frustum& frustum)
 {
 	if (NULL == m_pRootNode)
@@ -66,6 +66,9 @@ public:
 	//! Return the list off instances inside or intersect the given bounding box
 	virtual QList<GLC_3DViewInstance*> listOfIntersectedInstances(const GLC_BoundingBox& bBox);
 
+	//! Return the list of instances of the octree nodes which are inside or intersect the given frustum
+	virtual QList<GLC_3DViewInstance*> listOfInstancesInFrustum(const GLC_Frustum& frustum);
+
 //@}
 //////////////////////////////////////////////////////////////////////
 /*! \name Set Functions*/
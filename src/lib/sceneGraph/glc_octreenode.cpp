@@ -90,6 +90,23 @@ QSet<GLC_3DViewInstance*> GLC_OctreeNode::setOfIntersectedInstances(const GLC_Bo
 
 	return instanceSet;
 }
+
+QSet<GLC_3DViewInstance*> GLC_OctreeNode::setOfInstancesInFrustum(const GLC_FrustumCuller& culler) const
+{
+	QSet<GLC_3DViewInstance*> instanceSet;
+	if (culler.localize(m_BoundingBox) != GLC_Frustum::OutFrustum)
+	{
+		instanceSet= m_3DViewInstanceSet;
+		const int childCount= m_Children.size();
+		for (int i= 0; i < childCount; ++i)
+		{
+			instanceSet.unite(m_Children.at(i)->setOfInstancesInFrustum(culler));
+		}
+	}
+
+	return instanceSet;
+}
+
 //////////////////////////////////////////////////////////////////////
 // Set Functions
 //////////////////////////////////////////////////////////////////////
@@ -233,65 +250,10 @@ void GLC_OctreeNode::updateViewableInstances(const GLC_Frustum& frustum, QSet<GL
 		firstCall= true;
 	}
 
-	// Test the localisation of current octree node
-	GLC_Frustum::Localisation nodeLocalisation= frustum.localizeBoundingBox(m_BoundingBox);
-	if (nodeLocalisation == GLC_Frustum::OutFrustum)
-	{
-		disableViewFlag(pInstanceSet);
-	}
-	else if (nodeLocalisation == GLC_Frustum::InFrustum)
-	{
-		unableViewFlag(pInstanceSet);
-	}
-	else // The current node intersect the frustum
-	{
-		QSet<GLC_3DViewInstance*>::iterator iInstance= m_3DViewInstanceSet.begin();
-		while (m_3DViewInstanceSet.constEnd() != iInstance)
-		{
-			// Test if the instances is in the viewable set
-			if (!pInstanceSet->contains(*iInstance))
-			{
-				GLC_3DViewInstance* pCurrentInstance= (*iInstance);
-				// Test the localisation of the current instance
-				GLC_Frustum::Localisation instanceLocalisation= frustum.localizeBoundingBox(pCurrentInstance->boundingBox());
-
-				if (instanceLocalisation == GLC_Frustum::OutFrustum)
-				{
-					pCurrentInstance->setViewable(GLC_3DViewInstance::NoViewable);
-				}
-				else if (instanceLocalisation == GLC_Frustum::InFrustum)
-				{
-					pInstanceSet->insert(pCurrentInstance);
-					pCurrentInstance->setViewable(GLC_3DViewInstance::FullViewable);
-				}
-				else
-				{
-					pInstanceSet->insert(pCurrentInstance);
-					pCurrentInstance->setViewable(GLC_3DViewInstance::PartialViewable);
-					//Update the geometries viewable property of the instance
-					GLC_Matrix4x4 instanceMat= pCurrentInstance->matrix();
-					const int size= pCurrentInstance->numberOfBody();
-					for (int i= 0; i < size; ++i)
-					{
-						// Get the geometry bounding box
-						GLC_BoundingBox geomBox= pCurrentInstance->geomAt(i)->boundingBox();
-						GLC_Point3d center(instanceMat * geomBox.center());
-						double radius= geomBox.boundingSphereRadius() * instanceMat.scalingX();
-						GLC_Frustum::Localisation geomLocalisation= frustum.localizeSphere(center, radius);
-
-						pCurrentInstance->setGeomViewable(i, geomLocalisation != GLC_Frustum::OutFrustum);
-					}
-				}
-			}
+	GLC_FrustumCuller culler(frustum);
+	GLC_FrustumCuller geomCuller;
+	updateViewableInstances(frustum, &culler, &geomCuller, pInstanceSet);
 
-			++iInstance;
-		}
-		const int size= m_Children.size();
-		for (int i= 0; i < size; ++i)
-		{
-			m_Children.at(i)->updateViewableInstances(frustum, pInstanceSet);
-		}
-	}
 	if (firstCall) delete pInstanceSet;
 }
 
@@ -335,6 +297,83 @@ void GLC_OctreeNode::useBoundingSphereIntersection(bool use)
 	m_useBoundingSphere= use;
 }
 
+void GLC_OctreeNode::updateViewableInstances(const GLC_Frustum& frustum, GLC_FrustumCuller* pCuller, GLC_FrustumCuller* pGeomCuller, QSet<GLC_3DViewInstance*>* pInstanceSet)
+{
+	// Test the localisation of current octree node
+	GLC_Frustum::Localisation nodeLocalisation= pCuller->localize(m_BoundingBox);
+	if (nodeLocalisation == GLC_Frustum::OutFrustum)
+	{
+		disableViewFlag(pInstanceSet);
+	}
+	else if (nodeLocalisation == GLC_Frustum::InFrustum)
+	{
+		unableViewFlag(pInstanceSet);
+	}
+	else // The current node intersect the frustum
+	{
+		// Localize the instances which are not in the viewable set in one batch
+		QVector<GLC_3DViewInstance*> instances;
+		instances.reserve(m_3DViewInstanceSet.size());
+		pCuller->clearBoxes();
+		QSet<GLC_3DViewInstance*>::iterator iInstance= m_3DViewInstanceSet.begin();
+		while (m_3DViewInstanceSet.constEnd() != iInstance)
+		{
+			if (!pInstanceSet->contains(*iInstance))
+			{
+				instances.append(*iInstance);
+				pCuller->appendBox((*iInstance)->boundingBox());
+			}
+			++iInstance;
+		}
+		QVector<GLC_Frustum::Localisation> localisations;
+		pCuller->localizeBoxes(&localisations);
+
+		QVector<GLC_Frustum::Localisation> geomLocalisations;
+		const int instanceCount= instances.size();
+		for (int iCurrent= 0; iCurrent < instanceCount; ++iCurrent)
+		{
+			GLC_3DViewInstance* pCurrentInstance= instances.at(iCurrent);
+			const GLC_Frustum::Localisation instanceLocalisation= localisations.at(iCurrent);
+
+			if (instanceLocalisation == GLC_Frustum::OutFrustum)
+			{
+				pCurrentInstance->setViewable(GLC_3DViewInstance::NoViewable);
+			}
+			else if (instanceLocalisation == GLC_Frustum::InFrustum)
+			{
+				pInstanceSet->insert(pCurrentInstance);
+				pCurrentInstance->setViewable(GLC_3DViewInstance::FullViewable);
+			}
+			else
+			{
+				pInstanceSet->insert(pCurrentInstance);
+				pCurrentInstance->setViewable(GLC_3DViewInstance::PartialViewable);
+				// Update the geometries viewable property of the instance
+				// The geometries boxes are localized in the instance coordinates
+				pGeomCuller->setFrustum(frustum, pCurrentInstance->matrix());
+				pGeomCuller->clearBoxes();
+				const int size= pCurrentInstance->numberOfBody();
+				pGeomCuller->reserve(size);
+				for (int i= 0; i < size; ++i)
+				{
+					pGeomCuller->appendBox(pCurrentInstance->geomAt(i)->boundingBox());
+				}
+				pGeomCuller->localizeBoxes(&geomLocalisations);
+				for (int i= 0; i < size; ++i)
+				{
+					pCurrentInstance->setGeomViewable(i, geomLocalisations.at(i) != GLC_Frustum::OutFrustum);
+				}
+			}
+		}
+
+		const int size= m_Children.size();
+		for (int i= 0; i < size; ++i)
+		{
+			m_Children.at(i)->updateViewableInstances(frustum, pCuller, pGeomCuller, pInstanceSet);
+		}
+	}
+}
+
 void GLC_OctreeNode::unableViewFlag(QSet<GLC_3DViewInstance*>* pInstanceSet)
 {
 	QSet<GLC_3DViewInstance*>::iterator iInstance= m_3DViewInstanceSet.begin();
@@ -29,6 +29,7 @@
 #include "../glc_boundingbox.h"
 #include "../glc_config.h"
 #include "../viewport/glc_frustum.h"
+#include "../viewport/glc_frustumculler.h"
 #include <QList>
 #include <QSet>
 
@@ -99,6 +100,9 @@ public:
 	//! Return the list off instances inside or intersect the given bounding box
 	QSet<GLC_3DViewInstance*> setOfIntersectedInstances(const GLC_BoundingBox& bBox);
 
+	//! Return the set of instances of the nodes which are inside or intersect the frustum of the given culler
+	QSet<GLC_3DViewInstance*> setOfInstancesInFrustum(const GLC_FrustumCuller& culler) const;
+
 
 //@}
 
@@ -135,6 +139,10 @@ private:
 	//! Disable the node and sub node view flag
 	void disableViewFlag(QSet<GLC_3DViewInstance*>*);
 
+	//! Update 3d view instances visibility of this octree node branch with the given culler of the given frustum
+	/*! The geometries culler is reused for the geometries of the partially viewable instances*/
+	void updateViewableInstances(const GLC_Frustum&, GLC_FrustumCuller* pCuller, GLC_FrustumCuller* pGeomCuller, QSet<GLC_3DViewInstance*>* pInstanceSet);
+
 //////////////////////////////////////////////////////////////////////
 // Private members
 //////////////////////////////////////////////////////////////////////
@@ -0,0 +1,205 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_raypicker.cpp implementation of the GLC_RayPicker class.
+
+#include <limits>
+#include <QSet>
+
+#include "glc_raypicker.h"
+#include "glc_3dviewcollection.h"
+#include "glc_3dviewinstance.h"
+#include "../geometry/glc_mesh.h"
+
+// Test the ray against the instances of the visited slots and keep the nearest hit
+struct GLC_RayPickerVisitor
+{
+	GLC_RayPicker* m_pPicker;
+	const double* m_pOrigin;
+	const double* m_pDirection;
+	GLC_RayHit* m_pHit;
+
+	inline void operator()(int slot, double* pMaxDistance)
+	{
+		m_pPicker->pickInstance(slot, m_pOrigin, m_pDirection, pMaxDistance, m_pHit);
+	}
+};
+
+GLC_RayPicker::GLC_RayPicker(GLC_3DViewCollection* pCollection)
+: m_pCollection(pCollection)
+, m_Instances()
+, m_Bvh()
+, m_MeshBvhHash()
+{
+	update();
+}
+
+qint64 GLC_RayPicker::memorySize() const
+{
+	qint64 subject= m_Instances.size() * sizeof(InstanceEntry);
+	subject+= m_Bvh.nodes().size() * sizeof(GLC_Bvh::Node);
+	QHash<GLC_uint, QSharedPointer<const GLC_MeshBvh> >::const_iterator iBvh= m_MeshBvhHash.constBegin();
+	while (iBvh != m_MeshBvhHash.constEnd())
+	{
+		subject+= iBvh.value()->memorySize();
+		++iBvh;
+	}
+	return subject;
+}
+
+void GLC_RayPicker::setCollection(GLC_3DViewCollection* pCollection)
+{
+	if (m_pCollection != pCollection)
+	{
+		clear();
+		m_pCollection= pCollection;
+	}
+	update();
+}
+
+void GLC_RayPicker::update()
+{
+	m_Instances.clear();
+	m_Bvh.clear();
+	if (NULL == m_pCollection) return;
+
+	QSet<GLC_uint> meshIds;
+	QVector<float> boxes;
+	const QList<GLC_3DViewInstance*> instances= m_pCollection->viewableInstancesHandle();
+	const int instanceCount= instances.size();
+	m_Instances.reserve(instanceCount);
+	boxes.reserve(instanceCount * 6);
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= instances.at(i);
+		InstanceEntry entry;
+		entry.m_InstanceId= pInstance->id();
+
+		const int bodyCount= pInstance->numberOfGeometry();
+		for (int bodyIndex= 0; bodyIndex < bodyCount; ++bodyIndex)
+		{
+			GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pInstance->geomAt(bodyIndex));
+			if ((NULL != pMesh) && !pMesh->isEmpty())
+			{
+				BodyEntry body;
+				body.m_BodyIndex= bodyIndex;
+				body.m_pMesh= pMesh;
+				entry.m_Bodies.append(body);
+				meshIds.insert(pMesh->id());
+			}
+		}
+		if (entry.m_Bodies.isEmpty()) continue;
+
+		const GLC_BoundingBox box(pInstance->boundingBox());
+		if (box.isEmpty()) continue;
+
+		const GLC_Matrix4x4 inverse(pInstance->matrix().inverted());
+		for (int j= 0; j < 16; ++j) entry.m_Inverse[j]= inverse.getData()[j];
+
+		GLC_Bvh::appendBox(box, &boxes);
+		m_Instances.append(entry);
+	}
+
+	// Remove the hierarchies of the meshes which are no more in the collection
+	QHash<GLC_uint, QSharedPointer<const GLC_MeshBvh> >::iterator iBvh= m_MeshBvhHash.begin();
+	while (iBvh != m_MeshBvhHash.end())
+	{
+		if (meshIds.contains(iBvh.key())) ++iBvh;
+		else iBvh= m_MeshBvhHash.erase(iBvh);
+	}
+
+	m_Bvh.build(boxes);
+}
+
+void GLC_RayPicker::clear()
+{
+	m_Instances.clear();
+	m_Bvh.clear();
+	m_MeshBvhHash.clear();
+}
+
+GLC_RayHit GLC_RayPicker::pick(const GLC_Point3d& origin, const GLC_Vector3d& direction)
+{
+	GLC_RayHit subject;
+	if (m_Bvh.isEmpty() || direction.isNull()) return subject;
+
+	// Use a normalized direction so distances are world distances
+	GLC_Vector3d normalizedDirection(direction);
+	normalizedDirection.normalize();
+
+	GLC_RayPickerVisitor visitor;
+	visitor.m_pPicker= this;
+	visitor.m_pOrigin= origin.data();
+	visitor.m_pDirection= normalizedDirection.data();
+	visitor.m_pHit= &subject;
+
+	double maxDistance= std::numeric_limits<double>::max();
+	m_Bvh.raycast(origin.data(), normalizedDirection.data(), &maxDistance, visitor);
+
+	if (subject.isValid())
+	{
+		subject.m_Distance= maxDistance;
+		subject.m_Point= origin + (normalizedDirection * maxDistance);
+	}
+	return subject;
+}
+
+const GLC_MeshBvh* GLC_RayPicker::meshBvh(GLC_Mesh* pMesh)
+{
+	// The hierarchy is shared by the mesh, it is referenced here while it is used
+	const QSharedPointer<const GLC_MeshBvh> pMeshBvh= pMesh->meshBvh();
+	m_MeshBvhHash.insert(pMesh->id(), pMeshBvh);
+	return pMeshBvh.data();
+}
+
+void GLC_RayPicker::pickInstance(int slot, const double origin[3], const double direction[3], double* pMaxDistance, GLC_RayHit* pHit)
+{
+	const InstanceEntry& entry= m_Instances.at(m_Bvh.item(slot));
+
+	// The ray in instance coordinates, the distance along the ray is unchanged
+	const double* m= entry.m_Inverse;
+	const double localOrigin[3]=
+	{
+		m[0] * origin[0] + m[4] * origin[1] + m[8] * origin[2] + m[12],
+		m[1] * origin[0] + m[5] * origin[1] + m[9] * origin[2] + m[13],
+		m[2] * origin[0] + m[6] * origin[1] + m[10] * origin[2] + m[14]
+	};
+	const double localDirection[3]=
+	{
+		m[0] * direction[0] + m[4] * direction[1] + m[8] * direction[2],
+		m[1] * direction[0] + m[5] * direction[1] + m[9] * direction[2],
+		m[2] * direction[0] + m[6] * direction[1] + m[10] * direction[2]
+	};
+
+	const int bodyCount= entry.m_Bodies.size();
+	for (int i= 0; i < bodyCount; ++i)
+	{
+		const BodyEntry& body= entry.m_Bodies.at(i);
+		GLC_uint primitiveId= 0;
+		if (meshBvh(body.m_pMesh)->intersect(localOrigin, localDirection, pMaxDistance, &primitiveId))
+		{
+			pHit->m_InstanceId= entry.m_InstanceId;
+			pHit->m_BodyIndex= body.m_BodyIndex;
+			pHit->m_BodyId= body.m_pMesh->id();
+			pHit->m_PrimitiveId= primitiveId;
+		}
+	}
+}
@@ -0,0 +1,239 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_raypicker.h interface for the GLC_RayPicker class.
+
+#ifndef GLC_RAYPICKER_H_
+#define GLC_RAYPICKER_H_
+
+#include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+
+#include "../geometry/glc_bvh.h"
+#include "../geometry/glc_meshbvh.h"
+#include "../maths/glc_vector3d.h"
+#include "../maths/glc_line3d.h"
+
+#include "../glc_config.h"
+
+class GLC_3DViewCollection;
+class GLC_Mesh;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_RayHit
+/*! \brief GLC_RayHit : The nearest hit of a ray picking */
+
+/*! In a GLC_World the instance id is the id of the picked occurrence,
+ *  the body id is the id of the picked geometry and the primitive id
+ *  the id of the picked primitive of this geometry.*/
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_RayHit
+{
+public:
+	//! Construct an invalid hit
+	GLC_RayHit()
+	: m_InstanceId(0)
+	, m_BodyIndex(-1)
+	, m_BodyId(0)
+	, m_PrimitiveId(0)
+	, m_Point()
+	, m_Distance(-1.0)
+	{}
+
+	//! Return true if the ray hits a body
+	inline bool isValid() const
+	{return 0 != m_InstanceId;}
+
+	//! Return the hit instance id (the occurrence id in a world)
+	inline GLC_uint instanceId() const
+	{return m_InstanceId;}
+
+	//! Return the index of the hit body in its instance
+	inline int bodyIndex() const
+	{return m_BodyIndex;}
+
+	//! Return the hit body id
+	inline GLC_uint bodyId() const
+	{return m_BodyId;}
+
+	//! Return the hit primitive id
+	inline GLC_uint primitiveId() const
+	{return m_PrimitiveId;}
+
+	//! Return the hit point in world coordinates
+	inline const GLC_Point3d& point() const
+	{return m_Point;}
+
+	//! Return the distance from the ray starting point to the hit point
+	inline double distance() const
+	{return m_Distance;}
+
+private:
+	friend class GLC_RayPicker;
+
+	//! The hit instance id
+	GLC_uint m_InstanceId;
+
+	//! The index of the hit body
+	int m_BodyIndex;
+
+	//! The hit body id
+	GLC_uint m_BodyId;
+
+	//! The hit primitive id
+	GLC_uint m_PrimitiveId;
+
+	//! The hit point in world coordinates
+	GLC_Point3d m_Point;
+
+	//! The distance to the hit point
+	double m_Distance;
+};
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_RayPicker
+/*! \brief GLC_RayPicker : Pick the instances of a collection with rays on the CPU */
+
+/*! The picker uses a two level hierarchy :
+ *  - A GLC_Bvh of the world bounding boxes of the viewable instances
+ *  - A GLC_MeshBvh of the LOD 0 triangles of each mesh, in mesh coordinates
+ *
+ *  The ray is transformed in the coordinates of each crossed instance, so
+ *  the meshes hierarchies are shared by all instances of a mesh. The hierarchy of a mesh
+ *  is given by the mesh, it is built from the client side data so the OpenGL buffers
+ *  are never read and picking doesn't need a current context. Once the meshes are
+ *  uploaded GLC_State::isMeshBvhActivated() must be true to keep their hierarchies.
+ *
+ *  update() must be called when instances are added, removed, moved or hidden.
+ *  Geometries which are not meshes (lines, points) are not picked.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_RayPicker
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a picker of the given collection
+	explicit GLC_RayPicker(GLC_3DViewCollection* pCollection= NULL);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the picked collection
+	inline GLC_3DViewCollection* collection() const
+	{return m_pCollection;}
+
+	//! Return the number of pickable instances
+	inline int instanceCount() const
+	{return m_Instances.size();}
+
+	//! Return the number of built mesh hierarchies
+	inline int meshBvhCount() const
+	{return m_MeshBvhHash.size();}
+
+	//! Return the estimated memory size of this picker in bytes
+	qint64 memorySize() const;
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set the picked collection and update this picker
+	void setCollection(GLC_3DViewCollection* pCollection);
+
+	//! Update the instances hierarchy from the collection
+	void update();
+
+	//! Remove all instances and meshes hierarchies of this picker
+	void clear();
+
+	//! Return the nearest hit of the given ray
+	/*! Meshes hierarchies crossed for the first time are built*/
+	GLC_RayHit pick(const GLC_Point3d& origin, const GLC_Vector3d& direction);
+
+	//! Return the nearest hit of the given ray
+	inline GLC_RayHit pick(const GLC_Line3d& ray)
+	{return pick(ray.startingPoint(), ray.direction());}
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! A pickable body of an instance
+	struct BodyEntry
+	{
+		//! The body index in the instance
+		int m_BodyIndex;
+
+		//! The body mesh
+		GLC_Mesh* m_pMesh;
+	};
+
+	//! A pickable instance
+	struct InstanceEntry
+	{
+		//! The instance id
+		GLC_uint m_InstanceId;
+
+		//! The inverse of the instance matrix in column major order
+		double m_Inverse[16];
+
+		//! The pickable bodies of the instance
+		QVector<BodyEntry> m_Bodies;
+	};
+
+	//! Return the hierarchy of the given mesh, build it if needed
+	const GLC_MeshBvh* meshBvh(GLC_Mesh* pMesh);
+
+	//! Test the given ray against the instance of the given slot
+	void pickInstance(int slot, const double origin[3], const double direction[3], double* pMaxDistance, GLC_RayHit* pHit);
+
+	friend struct GLC_RayPickerVisitor;
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The picked collection
+	GLC_3DViewCollection* m_pCollection;
+
+	//! The pickable instances
+	QVector<InstanceEntry> m_Instances;
+
+	//! The hierarchy of the instances world bounding boxes
+	GLC_Bvh m_Bvh;
+
+	//! The meshes hierarchies by mesh id
+	QHash<GLC_uint, QSharedPointer<const GLC_MeshBvh> > m_MeshBvhHash;
+};
+
+#endif /* GLC_RAYPICKER_H_ */
@@ -0,0 +1,298 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_renderqueue.cpp implementation of the GLC_RenderQueue class.
+
+#include <algorithm>
+
+#include "glc_renderqueue.h"
+#include "../geometry/glc_mesh.h"
+#include "../shading/glc_material.h"
+#include "../shading/glc_shader.h"
+#include "../glc_renderstatistics.h"
+#include "../glc_frameprofiler.h"
+#include "../glc_context.h"
+#include "../glc_contextmanager.h"
+#include "../glc_state.h"
+#include "../glc_ext.h"
+
+// The number of floats by instance : the model matrix followed by the normal matrix
+#define GLC_RENDERQUEUE_INSTANCE_SIZE 25
+
+GLC_RenderQueue::GLC_RenderQueue()
+: m_Items()
+, m_Matrices()
+, m_InstanceData()
+, m_InstanceBuffer(QOpenGLBuffer::VertexBuffer)
+, m_BodyCount(0)
+, m_TriangleCount(0)
+, m_DrawCallCount(0)
+, m_UseInstancing(true)
+{
+	m_InstanceBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+}
+
+GLC_RenderQueue::~GLC_RenderQueue()
+{
+	m_InstanceBuffer.destroy();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Set Functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_RenderQueue::append(GLC_Mesh* pMesh, int lod, const GLC_Matrix4x4& matrix)
+{
+	Q_ASSERT(pMesh->canBeQueued());
+	const QList<GLC_uint> materialIds= pMesh->lodMaterialIds(lod);
+	const int materialCount= materialIds.size();
+	const int matrixIndex= m_Matrices.size();
+	bool isAppended= false;
+	for (int i= 0; i < materialCount; ++i)
+	{
+		GLC_Material* pMaterial= pMesh->material(materialIds.at(i));
+		if ((NULL != pMaterial) && !pMaterial->isTransparent())
+		{
+			Item item;
+			item.m_MaterialId= materialIds.at(i);
+			item.m_pMaterial= pMaterial;
+			item.m_pMesh= pMesh;
+			item.m_Lod= lod;
+			item.m_MatrixIndex= matrixIndex;
+			m_Items.append(item);
+			isAppended= true;
+		}
+	}
+	if (isAppended)
+	{
+		m_Matrices.append(matrix);
+		++m_BodyCount;
+		m_TriangleCount+= pMesh->trianglesCount(lod);
+	}
+}
+
+void GLC_RenderQueue::clear()
+{
+	// The capacity is kept from frame to frame
+	m_Items.resize(0);
+	m_Matrices.resize(0);
+	m_BodyCount= 0;
+	m_TriangleCount= 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+// OpenGL Functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_RenderQueue::glExecute()
+{
+	m_DrawCallCount= 0;
+	if (m_Items.isEmpty()) return;
+
+	std::sort(m_Items.begin(), m_Items.end(), itemLessThan);
+
+	GLC_Context* pContext= GLC_ContextManager::instance()->currentContext();
+	Q_ASSERT(NULL != pContext);
+
+	GLC_Shader* pInstancingShader= NULL;
+	if (m_UseInstancing && GLC_State::instancingSupported() && !GLC_Shader::hasActiveShader())
+	{
+		pInstancingShader= pContext->instancingShaderHandle();
+	}
+
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	pContext->glcEnableLighting(true);
+
+	if (NULL != pInstancingShader)
+	{
+		glFillInstanceBuffer();
+		pInstancingShader->use();
+	}
+
+	const int size= m_Items.size();
+	int first= 0;
+	while (first < size)
+	{
+		const Item& firstItem= m_Items.at(first);
+		firstItem.m_pMaterial->glExecute();
+
+		// The items of the same material
+		while ((first < size) && (m_Items.at(first).m_MaterialId == firstItem.m_MaterialId))
+		{
+			GLC_Mesh* pMesh= m_Items.at(first).m_pMesh;
+			const int lod= m_Items.at(first).m_Lod;
+
+			// The items of the same material, mesh and LOD
+			int last= first + 1;
+			while ((last < size) && (m_Items.at(last).m_MaterialId == firstItem.m_MaterialId)
+					&& (m_Items.at(last).m_pMesh == pMesh) && (m_Items.at(last).m_Lod == lod))
+			{
+				++last;
+			}
+
+			pMesh->glBindLod(lod);
+			if (NULL != pInstancingShader)
+			{
+				glDrawInstanced(pInstancingShader, first, last);
+			}
+			else
+			{
+				glDrawOneByOne(first, last);
+			}
+			pMesh->glReleaseLod();
+
+			first= last;
+		}
+	}
+
+	if (NULL != pInstancingShader)
+	{
+		pInstancingShader->unuse();
+	}
+
+	// Update statistics
+	GLC_RenderStatistics::addBodies(m_BodyCount);
+	GLC_RenderStatistics::addTriangles(m_TriangleCount);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+bool GLC_RenderQueue::itemLessThan(const Item& item1, const Item& item2)
+{
+	if (item1.m_MaterialId != item2.m_MaterialId) return item1.m_MaterialId < item2.m_MaterialId;
+	if (item1.m_pMesh != item2.m_pMesh) return item1.m_pMesh->id() < item2.m_pMesh->id();
+	if (item1.m_Lod != item2.m_Lod) return item1.m_Lod < item2.m_Lod;
+	return item1.m_MatrixIndex < item2.m_MatrixIndex;
+}
+
+void GLC_RenderQueue::glFillInstanceBuffer()
+{
+	const int size= m_Items.size();
+	m_InstanceData.resize(size * GLC_RENDERQUEUE_INSTANCE_SIZE);
+	GLfloat* pData= m_InstanceData.data();
+	for (int i= 0; i < size; ++i)
+	{
+		const double* pMatrix= m_Matrices.at(m_Items.at(i).m_MatrixIndex).getData();
+		for (int j= 0; j < 16; ++j)
+		{
+			pData[j]= static_cast<GLfloat>(pMatrix[j]);
+		}
+
+		// The normal matrix is the inverse transpose of the upper 3x3, its columns are
+		// the cross products of the columns of the upper 3x3 divided by its determinant
+		const GLC_Vector3d column0(pMatrix[0], pMatrix[1], pMatrix[2]);
+		const GLC_Vector3d column1(pMatrix[4], pMatrix[5], pMatrix[6]);
+		const GLC_Vector3d column2(pMatrix[8], pMatrix[9], pMatrix[10]);
+		const GLC_Vector3d normalColumns[3]= {column1 ^ column2, column2 ^ column0, column0 ^ column1};
+		const double determinant= column0 * normalColumns[0];
+		// The normals are normalized by the shader, only the sign of a singular matrix matters
+		const double factor= (0.0 != determinant) ? (1.0 / determinant) : 1.0;
+		for (int column= 0; column < 3; ++column)
+		{
+			for (int row= 0; row < 3; ++row)
+			{
+				pData[16 + column * 3 + row]= static_cast<GLfloat>(normalColumns[column].data()[row] * factor);
+			}
+		}
+		pData+= GLC_RENDERQUEUE_INSTANCE_SIZE;
+	}
+
+	if (!m_InstanceBuffer.isCreated())
+	{
+		m_InstanceBuffer.create();
+	}
+	m_InstanceBuffer.bind();
+	const int dataSize= m_InstanceData.size() * sizeof(GLfloat);
+	if (m_InstanceBuffer.size() < dataSize)
+	{
+		m_InstanceBuffer.allocate(m_InstanceData.constData(), dataSize);
+	}
+	else
+	{
+		m_InstanceBuffer.write(0, m_InstanceData.constData(), dataSize);
+	}
+	m_InstanceBuffer.release();
+	GLC_FrameProfiler::addUploadBytes(dataSize);
+}
+
+void GLC_RenderQueue::glDrawInstanced(GLC_Shader* pShader, int first, int last)
+{
+#if !defined(Q_OS_MAC)
+	GLC_Context* pContext= GLC_ContextManager::instance()->currentContext();
+	QOpenGLFunctions* pGlFunctions= pContext->contextHandle()->functions();
+
+	const GLuint location= static_cast<GLuint>(pShader->instanceMatrixAttributeId());
+	const GLuint normalLocation= static_cast<GLuint>(pShader->instanceNormalMatrixAttributeId());
+	const int instanceSize= GLC_RENDERQUEUE_INSTANCE_SIZE * sizeof(GLfloat);
+	const int firstOffset= first * instanceSize;
+
+	// A mat4 attribute use 4 consecutive locations and a mat3 attribute 3, one by column
+	m_InstanceBuffer.bind();
+	for (GLuint i= 0; i < 4; ++i)
+	{
+		pGlFunctions->glVertexAttribPointer(location + i, 4, GL_FLOAT, GL_FALSE, instanceSize, BUFFER_OFFSET(firstOffset + i * 4 * sizeof(GLfloat)));
+		pGlFunctions->glEnableVertexAttribArray(location + i);
+		glcVertexAttribDivisor(location + i, 1);
+	}
+	for (GLuint i= 0; i < 3; ++i)
+	{
+		pGlFunctions->glVertexAttribPointer(normalLocation + i, 3, GL_FLOAT, GL_FALSE, instanceSize, BUFFER_OFFSET(firstOffset + (16 + i * 3) * sizeof(GLfloat)));
+		pGlFunctions->glEnableVertexAttribArray(normalLocation + i);
+		glcVertexAttribDivisor(normalLocation + i, 1);
+	}
+
+	m_Items.at(first).m_pMesh->glDrawMaterialGroup(m_Items.at(first).m_MaterialId, last - first);
+	++m_DrawCallCount;
+
+	for (GLuint i= 0; i < 4; ++i)
+	{
+		glcVertexAttribDivisor(location + i, 0);
+		pGlFunctions->glDisableVertexAttribArray(location + i);
+	}
+	for (GLuint i= 0; i < 3; ++i)
+	{
+		glcVertexAttribDivisor(normalLocation + i, 0);
+		pGlFunctions->glDisableVertexAttribArray(normalLocation + i);
+	}
+	m_InstanceBuffer.release();
+#else
+	Q_UNUSED(pShader);
+	Q_UNUSED(first);
+	Q_UNUSED(last);
+	Q_ASSERT(false);
+#endif
+}
+
+void GLC_RenderQueue::glDrawOneByOne(int first, int last)
+{
+	GLC_Context* pContext= GLC_ContextManager::instance()->currentContext();
+	for (int i= first; i < last; ++i)
+	{
+		const Item& item= m_Items.at(i);
+		pContext->glcPushMatrix();
+		pContext->glcMultMatrix(m_Matrices.at(item.m_MatrixIndex));
+		item.m_pMesh->glDrawMaterialGroup(item.m_MaterialId);
+		pContext->glcPopMatrix();
+		++m_DrawCallCount;
+	}
+}
@@ -0,0 +1,186 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_renderqueue.h interface for the GLC_RenderQueue class.
+
+#ifndef GLC_RENDERQUEUE_H_
+#define GLC_RENDERQUEUE_H_
+
+#include <QVector>
+#include <QOpenGLBuffer>
+
+#include "../glc_global.h"
+#include "../maths/glc_matrix4x4.h"
+
+#include "../glc_config.h"
+
+class GLC_Mesh;
+class GLC_Material;
+class GLC_Shader;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_RenderQueue
+/*! \brief GLC_RenderQueue : Sort the opaque draws of a frame by state and batch them */
+
+/*! A draw of the queue is the primitives of one material of one mesh LOD
+ *  with a model matrix. GLC_3DViewInstance::appendToRenderQueue() appends
+ *  the draws of an instance and glExecute() sorts them by material, then
+ *  by mesh and LOD, so that a material is executed and the buffers of a mesh
+ *  are bound once by run instead of once by instance.
+ *
+ *  If the instancing extension is supported and no shader is active, the
+ *  draws of a run are done with one instanced draw call by primitive, the
+ *  model matrices and their normal matrices are read by the instancing shader
+ *  of the context from per instance vertex attributes. Otherwise the draws of a run are done one
+ *  by one with their model matrix.
+ *
+ *  Only opaque and unselected meshes drawn in normal rendering mode can be queued.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_RenderQueue
+{
+	//! A queued draw
+	struct Item
+	{
+		//! The material id
+		GLC_uint m_MaterialId;
+
+		//! The material
+		GLC_Material* m_pMaterial;
+
+		//! The mesh
+		GLC_Mesh* m_pMesh;
+
+		//! The LOD index
+		int m_Lod;
+
+		//! The index of the model matrix
+		int m_MatrixIndex;
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Default constructor
+	GLC_RenderQueue();
+
+	//! Destructor
+	~GLC_RenderQueue();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the number of queued draws
+	inline int size() const
+	{return m_Items.size();}
+
+	//! Return true if this queue is empty
+	inline bool isEmpty() const
+	{return m_Items.isEmpty();}
+
+	//! Return the number of draw calls of the last execution
+	inline int drawCallCount() const
+	{return m_DrawCallCount;}
+
+	//! Return true if instancing is used when it is supported
+	inline bool instancingIsUsed() const
+	{return m_UseInstancing;}
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Append the opaque draws of the given LOD of the given mesh with the given model matrix
+	void append(GLC_Mesh* pMesh, int lod, const GLC_Matrix4x4& matrix);
+
+	//! Remove the draws of this queue
+	void clear();
+
+	//! Set instancing usage
+	inline void setInstancingUsage(bool usage)
+	{m_UseInstancing= usage;}
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name OpenGL Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Sort and draw the queued draws
+	/*! The queue is not cleared*/
+	void glExecute();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Return true if the first item must be drawn before the second one
+	static bool itemLessThan(const Item& item1, const Item& item2);
+
+	//! Fill the instance buffer with the model and normal matrices of the sorted items
+	void glFillInstanceBuffer();
+
+	//! Draw the given range of items which share material, mesh and LOD with the given instancing shader
+	void glDrawInstanced(GLC_Shader* pShader, int first, int last);
+
+	//! Draw the given range of items which share material, mesh and LOD one by one
+	void glDrawOneByOne(int first, int last);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The queued draws
+	QVector<Item> m_Items;
+
+	//! The model matrices
+	QVector<GLC_Matrix4x4> m_Matrices;
+
+	//! The model and normal matrices of the sorted items in float
+	QVector<GLfloat> m_InstanceData;
+
+	//! The instance buffer
+	QOpenGLBuffer m_InstanceBuffer;
+
+	//! The number of queued bodies
+	unsigned int m_BodyCount;
+
+	//! The number of queued triangles
+	unsigned int m_TriangleCount;
+
+	//! The number of draw calls of the last execution
+	int m_DrawCallCount;
+
+	//! Instancing usage
+	bool m_UseInstancing;
+};
+
+#endif /* GLC_RENDERQUEUE_H_ */
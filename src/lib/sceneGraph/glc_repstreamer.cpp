@@ -0,0 +1,433 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_repstreamer.cpp implementation of the GLC_RepStreamer class.
+
+#include "glc_repstreamer.h"
+#include "glc_structoccurrence.h"
+#include "glc_structreference.h"
+#include "../viewport/glc_viewport.h"
+#include "../glc_factory.h"
+#include "../glc_errorlog.h"
+#include "../glc_exception.h"
+#include "../glc_state.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+GLC_RepStreamer::RepEntry::RepEntry()
+: m_BoundingBox()
+, m_Size(-1)
+, m_LastVisibleFrame(-1)
+, m_LastSeenFrame(-1)
+, m_Priority(0.0)
+, m_Future()
+, m_IsLoading(false)
+, m_IsResident(false)
+, m_LoadFailed(false)
+{
+
+}
+
+GLC_RepStreamer::GLC_RepStreamer(const GLC_World& world)
+: m_World(world)
+, m_RepEntries()
+, m_OrphanFutures()
+, m_MemoryBudget(0)
+, m_ResidentSize(0)
+, m_MaximumConcurrentLoad(qMax(1, QThread::idealThreadCount()))
+, m_PendingLoadCount(0)
+, m_FrameCount(0)
+{
+
+}
+
+GLC_RepStreamer::~GLC_RepStreamer()
+{
+	// The loaded representations are deleted with the futures
+	QHash<GLC_StructReference*, RepEntry>::iterator iEntry= m_RepEntries.begin();
+	while (m_RepEntries.constEnd() != iEntry)
+	{
+		if (iEntry.value().m_IsLoading)
+		{
+			iEntry.value().m_Future.waitForFinished();
+		}
+		++iEntry;
+	}
+
+	const int size= m_OrphanFutures.size();
+	for (int i= 0; i < size; ++i)
+	{
+		m_OrphanFutures[i].waitForFinished();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// Get Functions
+//////////////////////////////////////////////////////////////////////
+
+qint64 GLC_RepStreamer::estimatedSize(const GLC_3DRep& rep)
+{
+	// Position, normal and texel per vertex, plus a triangle index of the most detailed LOD
+	const qint64 vertexSize= 8 * sizeof(GLfloat);
+	const qint64 faceSize= 3 * sizeof(GLuint);
+
+	return (static_cast<qint64>(rep.vertexCount()) * vertexSize) + (static_cast<qint64>(rep.faceCount()) * faceSize);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Set Functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_RepStreamer::setMaximumConcurrentLoad(int count)
+{
+	Q_ASSERT(count > 0);
+	m_MaximumConcurrentLoad= count;
+}
+
+bool GLC_RepStreamer::update(GLC_Viewport* pView)
+{
+	Q_ASSERT(NULL != pView);
+	++m_FrameCount;
+
+	bool worldChanged= attachFinishedLoads();
+	updatePriorities(pView);
+	worldChanged= evict() || worldChanged;
+	startLoads();
+
+	return worldChanged;
+}
+
+bool GLC_RepStreamer::waitForPendingLoads()
+{
+	QHash<GLC_StructReference*, RepEntry>::iterator iEntry= m_RepEntries.begin();
+	while (m_RepEntries.constEnd() != iEntry)
+	{
+		if (iEntry.value().m_IsLoading)
+		{
+			iEntry.value().m_Future.waitForFinished();
+		}
+		++iEntry;
+	}
+
+	return attachFinishedLoads();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+bool GLC_RepStreamer::attachFinishedLoads()
+{
+	// Forget the loads of removed references
+	QList<QFuture<GLC_3DRep> >::iterator iFuture= m_OrphanFutures.begin();
+	while (m_OrphanFutures.end() != iFuture)
+	{
+		if ((*iFuture).isFinished())
+		{
+			iFuture= m_OrphanFutures.erase(iFuture);
+			--m_PendingLoadCount;
+		}
+		else
+		{
+			++iFuture;
+		}
+	}
+
+	bool repLoaded= false;
+	QHash<GLC_StructReference*, RepEntry>::iterator iEntry= m_RepEntries.begin();
+	while (m_RepEntries.constEnd() != iEntry)
+	{
+		RepEntry& entry= iEntry.value();
+		if (entry.m_IsLoading && entry.m_Future.isFinished())
+		{
+			entry.m_IsLoading= false;
+			--m_PendingLoadCount;
+			repLoaded= attach(iEntry.key(), entry) || repLoaded;
+			entry.m_Future= QFuture<GLC_3DRep>();
+		}
+		++iEntry;
+	}
+
+	return repLoaded;
+}
+
+bool GLC_RepStreamer::attach(GLC_StructReference* pReference, RepEntry& entry)
+{
+	GLC_3DRep loadedRep(entry.m_Future.result());
+	if (loadedRep.isEmpty())
+	{
+		entry.m_LoadFailed= true;
+		return false;
+	}
+
+	// The representation can have been loaded by another way
+	if (pReference->representationIsLoaded()) return false;
+
+	entry.m_BoundingBox= loadedRep.boundingBox();
+	entry.m_Size= estimatedSize(loadedRep);
+
+	const bool attached= pReference->loadRepresentation(&loadedRep);
+	if (attached)
+	{
+		// Occurrences which don't use automatic creation are instanciated too
+		QList<GLC_StructOccurrence*> occurrences= pReference->listOfStructOccurrence();
+		const int size= occurrences.size();
+		for (int i= 0; i < size; ++i)
+		{
+			GLC_StructOccurrence* pOccurrence= occurrences.at(i);
+			if (!pOccurrence->has3DViewInstance())
+			{
+				pOccurrence->create3DViewInstance();
+			}
+		}
+		m_ResidentSize+= entry.m_Size;
+		entry.m_IsResident= true;
+	}
+	else
+	{
+		entry.m_LoadFailed= true;
+	}
+
+	return attached;
+}
+
+void GLC_RepStreamer::updatePriorities(GLC_Viewport* pView)
+{
+	const GLC_Frustum& frustum= pView->frustum();
+	const GLC_Point3d eye(pView->cameraHandle()->eye());
+	const double viewTangent= pView->viewTangent();
+
+	// Screen coverage under which an occurrence is not drawn
+	double minimumCoverage= 0.0;
+	if (GLC_State::isPixelCullingActivated())
+	{
+		minimumCoverage= pView->minimumStaticPixelCullingRatio() / 100.0;
+	}
+
+	QHash<GLC_StructReference*, RepEntry>::iterator iEntry= m_RepEntries.begin();
+	while (m_RepEntries.constEnd() != iEntry)
+	{
+		iEntry.value().m_Priority= 0.0;
+		++iEntry;
+	}
+
+	const QList<GLC_StructOccurrence*> occurrences(m_World.listOfOccurrence());
+	const int occurrenceCount= occurrences.size();
+	for (int i= 0; i < occurrenceCount; ++i)
+	{
+		GLC_StructOccurrence* pOccurrence= occurrences.at(i);
+		if (!pOccurrence->hasRepresentation()) continue;
+
+		GLC_StructReference* pReference= pOccurrence->structReference();
+		if (pReference->representationFileName().isEmpty()) continue;
+
+		RepEntry& entry= m_RepEntries[pReference];
+		const bool isLoaded= pReference->representationIsLoaded();
+		if ((entry.m_LastSeenFrame != m_FrameCount) && (entry.m_IsResident != isLoaded))
+		{
+			// Representation loaded or unloaded without the streamer
+			if (isLoaded)
+			{
+				GLC_3DRep* pRep= dynamic_cast<GLC_3DRep*>(pReference->representationHandle());
+				Q_ASSERT(NULL != pRep);
+				entry.m_BoundingBox= pRep->boundingBox();
+				entry.m_Size= estimatedSize(*pRep);
+				m_ResidentSize+= entry.m_Size;
+			}
+			else
+			{
+				m_ResidentSize-= entry.m_Size;
+			}
+			entry.m_IsResident= isLoaded;
+		}
+		entry.m_LastSeenFrame= m_FrameCount;
+
+		if (!pOccurrence->isVisible()) continue;
+
+		const GLC_Matrix4x4 absoluteMatrix(pOccurrence->absoluteMatrix());
+		double priority= 0.0;
+		if (entry.m_BoundingBox.isEmpty())
+		{
+			// Unknown extent : the nearest occurrences are loaded first, after the visible known ones
+			const double dist= (absoluteMatrix * GLC_Point3d() - eye).length();
+			priority= 1.0 / (1.0 + dist);
+		}
+		else
+		{
+			GLC_BoundingBox boundingBox(entry.m_BoundingBox);
+			boundingBox.transform(absoluteMatrix);
+			if (frustum.localizeBoundingBox(boundingBox) == GLC_Frustum::OutFrustum) continue;
+
+			const double diameter= boundingBox.boundingSphereRadius() * 2.0;
+			const double dist= (boundingBox.center() - eye).length();
+			double coverage= 1.0;
+			if (dist > diameter)
+			{
+				coverage= qMin(1.0, diameter / (dist * viewTangent));
+			}
+			if (coverage < minimumCoverage) continue;
+
+			priority= 1.0 + coverage;
+		}
+
+		entry.m_Priority= qMax(entry.m_Priority, priority);
+		entry.m_LastVisibleFrame= m_FrameCount;
+	}
+
+	// Remove the references which are no more in the world
+	iEntry= m_RepEntries.begin();
+	while (m_RepEntries.constEnd() != iEntry)
+	{
+		if (iEntry.value().m_LastSeenFrame != m_FrameCount)
+		{
+			if (iEntry.value().m_IsLoading)
+			{
+				m_OrphanFutures.append(iEntry.value().m_Future);
+			}
+			else if (iEntry.value().m_IsResident)
+			{
+				m_ResidentSize-= iEntry.value().m_Size;
+			}
+			iEntry= m_RepEntries.erase(iEntry);
+		}
+		else
+		{
+			++iEntry;
+		}
+	}
+}
+
+bool GLC_RepStreamer::evict()
+{
+	if ((0 == m_MemoryBudget) || (m_ResidentSize <= m_MemoryBudget)) return false;
+
+	// Sort resident and currently not visible representations from the least recently visible
+	QList<QPair<double, GLC_StructReference*> > candidates;
+	QHash<GLC_StructReference*, RepEntry>::const_iterator iEntry= m_RepEntries.constBegin();
+	while (m_RepEntries.constEnd() != iEntry)
+	{
+		const RepEntry& entry= iEntry.value();
+		if ((entry.m_LastVisibleFrame != m_FrameCount) && entry.m_IsResident)
+		{
+			candidates.append(qMakePair(-static_cast<double>(entry.m_LastVisibleFrame), iEntry.key()));
+		}
+		++iEntry;
+	}
+	std::sort(candidates.begin(), candidates.end(), hasHigherPriority);
+
+	bool repUnloaded= false;
+	const int size= candidates.size();
+	int i= 0;
+	while ((i < size) && (m_ResidentSize > m_MemoryBudget))
+	{
+		GLC_StructReference* pReference= candidates.at(i).second;
+		QList<GLC_StructOccurrence*> occurrences= pReference->listOfStructOccurrence();
+		const int occurrenceCount= occurrences.size();
+		for (int iOcc= 0; iOcc < occurrenceCount; ++iOcc)
+		{
+			occurrences.at(iOcc)->unloadRepresentation();
+		}
+
+		if (!pReference->representationIsLoaded())
+		{
+			RepEntry& entry= m_RepEntries[pReference];
+			m_ResidentSize-= entry.m_Size;
+			entry.m_IsResident= false;
+			repUnloaded= true;
+		}
+		++i;
+	}
+
+	return repUnloaded;
+}
+
+void GLC_RepStreamer::startLoads()
+{
+	if (m_PendingLoadCount >= m_MaximumConcurrentLoad) return;
+
+	QList<QPair<double, GLC_StructReference*> > candidates;
+	QHash<GLC_StructReference*, RepEntry>::const_iterator iEntry= m_RepEntries.constBegin();
+	while (m_RepEntries.constEnd() != iEntry)
+	{
+		const RepEntry& entry= iEntry.value();
+		if ((entry.m_Priority > 0.0) && !entry.m_IsLoading && !entry.m_LoadFailed && !iEntry.key()->representationIsLoaded())
+		{
+			candidates.append(qMakePair(entry.m_Priority, iEntry.key()));
+		}
+		++iEntry;
+	}
+	std::sort(candidates.begin(), candidates.end(), hasHigherPriority);
+
+	// The size of the pending loads is counted to keep the budget
+	qint64 expectedSize= m_ResidentSize;
+	iEntry= m_RepEntries.constBegin();
+	while (m_RepEntries.constEnd() != iEntry)
+	{
+		if (iEntry.value().m_IsLoading && (iEntry.value().m_Size > 0))
+		{
+			expectedSize+= iEntry.value().m_Size;
+		}
+		++iEntry;
+	}
+
+	const int size= candidates.size();
+	int i= 0;
+	while ((i < size) && (m_PendingLoadCount < m_MaximumConcurrentLoad))
+	{
+		GLC_StructReference* pReference= candidates.at(i).second;
+		RepEntry& entry= m_RepEntries[pReference];
+		if ((m_MemoryBudget > 0) && (entry.m_Size > 0))
+		{
+			if ((expectedSize + entry.m_Size) > m_MemoryBudget) break;
+			expectedSize+= entry.m_Size;
+		}
+
+		entry.m_Future= QtConcurrent::run(GLC_RepStreamer::loadRepTask, pReference->representationFileName());
+		entry.m_IsLoading= true;
+		++m_PendingLoadCount;
+		++i;
+	}
+}
+
+GLC_3DRep GLC_RepStreamer::loadRepTask(const QString& fileName)
+{
+	GLC_3DRep rep;
+	try
+	{
+		rep= GLC_Factory::instance()->create3DRepFromFile(fileName);
+	}
+	catch (GLC_Exception& e)
+	{
+		QStringList stringList("GLC_RepStreamer::loadRepTask");
+		stringList.append(e.what());
+		GLC_ErrorLog::addError(stringList);
+	}
+
+	return rep;
+}
+
+bool GLC_RepStreamer::hasHigherPriority(const QPair<double, GLC_StructReference*>& entry1, const QPair<double, GLC_StructReference*>& entry2)
+{
+	return entry1.first > entry2.first;
+}
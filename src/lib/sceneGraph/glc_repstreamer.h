@@ -0,0 +1,221 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_repstreamer.h interface for the GLC_RepStreamer class.
+
+#ifndef GLC_REPSTREAMER_H_
+#define GLC_REPSTREAMER_H_
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QFuture>
+
+#include "glc_world.h"
+#include "../geometry/glc_3drep.h"
+#include "../glc_boundingbox.h"
+
+#include "../glc_config.h"
+
+class GLC_Viewport;
+class GLC_StructReference;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_RepStreamer
+/*! \brief GLC_RepStreamer : Load and unload the representations of a world on demand */
+
+/*! The streamer works on a world whose representations are not loaded,
+ *  typically a world created with the structure only option.
+ *  Each call to update() :
+ *  - Attaches the representations loaded on worker threads since the last call
+ *  - Computes the priority of each reference from the screen coverage of its occurrences
+ *  - Unloads the least recently visible representations while the resident size exceed the budget
+ *  - Starts the loading of the visible representations with the highest priority
+ *
+ *  The screen coverage is computed as in GLC_3DViewInstance::choseLod().
+ *  The bounding box of a representation is only known once loaded, before that
+ *  representations are loaded from the nearest to the farthest occurrence.
+ *  update() must be called from the thread which own the world, usually the GUI thread.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_RepStreamer
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a streamer of the given world
+	explicit GLC_RepStreamer(const GLC_World& world);
+
+	//! Destructor wait for the pending loads
+	virtual ~GLC_RepStreamer();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the streamed world
+	inline GLC_World world() const
+	{return m_World;}
+
+	//! Return the memory budget in bytes (0 means unlimited)
+	inline qint64 memoryBudget() const
+	{return m_MemoryBudget;}
+
+	//! Return the estimated size in bytes of the resident representations
+	inline qint64 residentSize() const
+	{return m_ResidentSize;}
+
+	//! Return the maximum number of concurrent loads
+	inline int maximumConcurrentLoad() const
+	{return m_MaximumConcurrentLoad;}
+
+	//! Return the number of representations being loaded
+	inline int pendingLoadCount() const
+	{return m_PendingLoadCount;}
+
+	//! Return true if there is no pending load
+	inline bool isIdle() const
+	{return 0 == m_PendingLoadCount;}
+
+	//! Return the estimated size in bytes of the given representation
+	static qint64 estimatedSize(const GLC_3DRep& rep);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set the memory budget in bytes (0 means unlimited)
+	inline void setMemoryBudget(qint64 budget)
+	{m_MemoryBudget= budget;}
+
+	//! Set the maximum number of concurrent loads
+	void setMaximumConcurrentLoad(int count);
+
+	//! Update the resident representations for the given viewport
+	/*! Return true if representations have been loaded or unloaded*/
+	bool update(GLC_Viewport* pView);
+
+	//! Wait for the pending loads and attach them
+	/*! Return true if representations have been loaded*/
+	bool waitForPendingLoads();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Streaming state of a reference
+	struct RepEntry
+	{
+		RepEntry();
+
+		//! The representation bounding box in reference coordinate
+		GLC_BoundingBox m_BoundingBox;
+
+		//! The estimated size of the representation (-1 if unknown)
+		qint64 m_Size;
+
+		//! The last frame where an occurrence of the reference was visible
+		qint64 m_LastVisibleFrame;
+
+		//! The last frame where the reference was in the world
+		qint64 m_LastSeenFrame;
+
+		//! The loading priority of the current frame
+		double m_Priority;
+
+		//! The pending load
+		QFuture<GLC_3DRep> m_Future;
+
+		//! True if a load is pending
+		bool m_IsLoading;
+
+		//! True if the representation size is counted in the resident size
+		bool m_IsResident;
+
+		//! True if the last load failed
+		bool m_LoadFailed;
+	};
+
+	//! Attach the finished loads and return true if representations have been loaded
+	bool attachFinishedLoads();
+
+	//! Attach the loaded representation to the given reference and return true on success
+	bool attach(GLC_StructReference* pReference, RepEntry& entry);
+
+	//! Compute the priority of the references for the given viewport
+	void updatePriorities(GLC_Viewport* pView);
+
+	//! Unload least recently visible representations while over budget
+	/*! Return true if representations have been unloaded*/
+	bool evict();
+
+	//! Start the load of the visible representations with the highest priority
+	void startLoads();
+
+	//! Load the representation of the given file on a worker thread
+	static GLC_3DRep loadRepTask(const QString& fileName);
+
+	//! Return true if the first entry has a higher priority than the second
+	static bool hasHigherPriority(const QPair<double, GLC_StructReference*>& entry1, const QPair<double, GLC_StructReference*>& entry2);
+
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The streamed world
+	GLC_World m_World;
+
+	//! The streaming state of the references
+	QHash<GLC_StructReference*, RepEntry> m_RepEntries;
+
+	//! Pending loads of references which have been removed from the world
+	QList<QFuture<GLC_3DRep> > m_OrphanFutures;
+
+	//! The memory budget in bytes (0 means unlimited)
+	qint64 m_MemoryBudget;
+
+	//! The estimated size of the resident representations
+	qint64 m_ResidentSize;
+
+	//! The maximum number of concurrent loads
+	int m_MaximumConcurrentLoad;
+
+	//! The number of pending loads
+	int m_PendingLoadCount;
+
+	//! The current frame number
+	qint64 m_FrameCount;
+
+private:
+	Q_DISABLE_COPY(GLC_RepStreamer)
+};
+
+#endif /* GLC_REPSTREAMER_H_ */
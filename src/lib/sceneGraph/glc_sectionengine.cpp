@@ -0,0 +1,923 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_sectionengine.cpp implementation of the GLC_SectionEngine class.
+
+#include <algorithm>
+#include <limits>
+#include <QtConcurrent>
+
+#include "glc_sectionengine.h"
+#include "glc_3dviewcollection.h"
+#include "glc_3dviewinstance.h"
+#include "../geometry/glc_mesh.h"
+#include "../geometry/glc_polylines.h"
+
+// The hierarchy of a mesh with more triangles is intersected by several tasks
+#define GLC_SECTIONENGINE_TASK_SIZE 4096
+
+// The depth of the subtrees roots of the tasks of a mesh
+#define GLC_SECTIONENGINE_SPLIT_DEPTH 3
+
+// The ratio of the body box diagonal under which the ends of open chains are joined
+#define GLC_SECTIONENGINE_JOIN_RATIO 1.0e-5
+
+GLC_SectionEngine::GLC_SectionEngine(GLC_3DViewCollection* pCollection)
+: m_pCollection(pCollection)
+, m_Plane()
+, m_CapIsUsed(true)
+, m_Sections()
+, m_SegmentCount(0)
+, m_ComputeCount(0)
+, m_MeshBvhHash()
+{
+
+}
+
+int GLC_SectionEngine::loopCount() const
+{
+	int subject= 0;
+	const int sectionCount= m_Sections.size();
+	for (int i= 0; i < sectionCount; ++i)
+	{
+		subject+= m_Sections.at(i).m_Loops.size();
+	}
+	return subject;
+}
+
+int GLC_SectionEngine::openChainCount() const
+{
+	int subject= 0;
+	const int sectionCount= m_Sections.size();
+	for (int i= 0; i < sectionCount; ++i)
+	{
+		subject+= m_Sections.at(i).m_OpenChains.size();
+	}
+	return subject;
+}
+
+double GLC_SectionEngine::area() const
+{
+	double subject= 0.0;
+	const int sectionCount= m_Sections.size();
+	for (int i= 0; i < sectionCount; ++i)
+	{
+		subject+= m_Sections.at(i).m_Area;
+	}
+	return subject;
+}
+
+GLC_Polylines* GLC_SectionEngine::createContours() const
+{
+	GLC_Polylines* pPolylines= new GLC_Polylines();
+	const int sectionCount= m_Sections.size();
+	for (int i= 0; i < sectionCount; ++i)
+	{
+		const Section& section= m_Sections.at(i);
+		const int loopCount= section.m_Loops.size();
+		for (int loop= 0; loop < loopCount; ++loop)
+		{
+			GLfloatVector data(section.m_Loops.at(loop));
+			data << data.at(0) << data.at(1) << data.at(2);
+			pPolylines->addPolyline(data);
+		}
+		const int chainCount= section.m_OpenChains.size();
+		for (int chain= 0; chain < chainCount; ++chain)
+		{
+			pPolylines->addPolyline(section.m_OpenChains.at(chain));
+		}
+	}
+	return pPolylines;
+}
+
+GLC_Mesh* GLC_SectionEngine::createCaps(GLC_Material* pMaterial) const
+{
+	GLfloatVector positions;
+	IndexList indexList;
+	const int sectionCount= m_Sections.size();
+	for (int i= 0; i < sectionCount; ++i)
+	{
+		const Section& section= m_Sections.at(i);
+		const GLuint offset= static_cast<GLuint>(positions.size() / 3);
+		positions+= section.m_CapPositions;
+		const int indexCount= section.m_CapIndex.size();
+		for (int index= 0; index < indexCount; ++index)
+		{
+			indexList.append(offset + section.m_CapIndex.at(index));
+		}
+	}
+	if (indexList.isEmpty()) return NULL;
+
+	// The caps face the negative side of the plane
+	GLC_Vector3d normal(-m_Plane.coefA(), -m_Plane.coefB(), -m_Plane.coefC());
+	normal.normalize();
+	const int vertexCount= positions.size() / 3;
+	GLfloatVector normals(positions.size());
+	for (int i= 0; i < vertexCount; ++i)
+	{
+		normals[i * 3]= static_cast<GLfloat>(normal.x());
+		normals[i * 3 + 1]= static_cast<GLfloat>(normal.y());
+		normals[i * 3 + 2]= static_cast<GLfloat>(normal.z());
+	}
+
+	GLC_Mesh* pMesh= new GLC_Mesh();
+	pMesh->addVertice(positions);
+	pMesh->addNormals(normals);
+	pMesh->addTriangles(pMaterial, indexList);
+	pMesh->finish();
+	return pMesh;
+}
+
+void GLC_SectionEngine::setCollection(GLC_3DViewCollection* pCollection)
+{
+	if (m_pCollection != pCollection)
+	{
+		clear();
+		m_pCollection= pCollection;
+	}
+}
+
+int GLC_SectionEngine::compute(const GLC_Plane& plane)
+{
+	m_Plane= plane;
+	m_Sections.clear();
+	m_SegmentCount= 0;
+	++m_ComputeCount;
+	if (NULL == m_pCollection) return 0;
+
+	// Create the intersection tasks of the meshes crossed by the plane
+	QVector<BodyTask> bodies;
+	QVector<SegmentTask> tasks;
+	const QList<GLC_3DViewInstance*> instances(m_pCollection->instancesHandle());
+	const int instanceCount= instances.size();
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		GLC_3DViewInstance* pInstance= instances.at(i);
+		if (pInstance->isVisible() != m_pCollection->showState()) continue;
+		const GLC_BoundingBox box(pInstance->boundingBox());
+		if (box.isEmpty()) continue;
+		const double lower[3]= {box.lowerCorner().x(), box.lowerCorner().y(), box.lowerCorner().z()};
+		const double upper[3]= {box.upperCorner().x(), box.upperCorner().y(), box.upperCorner().z()};
+		if (!boxIsCut(plane.data(), lower, upper)) continue;
+
+		double planeInMesh[4];
+		localPlane(plane, pInstance->matrix(), planeInMesh);
+
+		const int bodyCount= pInstance->numberOfGeometry();
+		for (int bodyIndex= 0; bodyIndex < bodyCount; ++bodyIndex)
+		{
+			GLC_Mesh* pMesh= dynamic_cast<GLC_Mesh*>(pInstance->geomAt(bodyIndex));
+			if (NULL == pMesh) continue;
+			const GLC_BoundingBox& bodyBox= pMesh->boundingBox();
+			if (bodyBox.isEmpty()) continue;
+			const double bodyLower[3]= {bodyBox.lowerCorner().x(), bodyBox.lowerCorner().y(), bodyBox.lowerCorner().z()};
+			const double bodyUpper[3]= {bodyBox.upperCorner().x(), bodyBox.upperCorner().y(), bodyBox.upperCorner().z()};
+			if (!boxIsCut(planeInMesh, bodyLower, bodyUpper)) continue;
+
+			const GLC_MeshBvh* pMeshBvh= meshBvh(pMesh);
+			if (pMeshBvh->isEmpty()) continue;
+
+			BodyTask body;
+			body.m_Matrix= pInstance->matrix();
+			for (int coef= 0; coef < 4; ++coef) body.m_Plane[coef]= plane.data()[coef];
+			body.m_Tolerance= (bodyBox.upperCorner() - bodyBox.lowerCorner()).length() * GLC_SECTIONENGINE_JOIN_RATIO;
+			body.m_CapIsUsed= m_CapIsUsed;
+			body.m_Section.m_InstanceId= pInstance->id();
+			body.m_Section.m_BodyId= pMesh->id();
+			body.m_Section.m_Area= 0.0;
+
+			// Split big hierarchies in subtrees intersected in parallel
+			const QVector<GLC_Bvh::Node>& nodes= pMeshBvh->bvh().nodes();
+			QVector<int> roots;
+			roots.append(0);
+			if (pMeshBvh->triangleCount() > GLC_SECTIONENGINE_TASK_SIZE)
+			{
+				for (int depth= 0; depth < GLC_SECTIONENGINE_SPLIT_DEPTH; ++depth)
+				{
+					QVector<int> children;
+					const int rootCount= roots.size();
+					for (int root= 0; root < rootCount; ++root)
+					{
+						const GLC_Bvh::Node& node= nodes.at(roots.at(root));
+						if (0 == node.m_Count) children << (roots.at(root) + 1) << node.m_Offset;
+						else children << roots.at(root);
+					}
+					roots= children;
+				}
+			}
+
+			const int rootCount= roots.size();
+			for (int root= 0; root < rootCount; ++root)
+			{
+				SegmentTask task;
+				task.m_pMeshBvh= pMeshBvh;
+				for (int coef= 0; coef < 4; ++coef) task.m_Plane[coef]= planeInMesh[coef];
+				task.m_Node= roots.at(root);
+				task.m_Body= bodies.size();
+				tasks.append(task);
+			}
+			bodies.append(body);
+		}
+	}
+
+	// Intersect the triangles and gather the segments of each body
+	QtConcurrent::blockingMap(tasks, &GLC_SectionEngine::intersectTriangles);
+	const int taskCount= tasks.size();
+	for (int i= 0; i < taskCount; ++i)
+	{
+		bodies[tasks.at(i).m_Body].m_Segments+= tasks.at(i).m_Segments;
+	}
+	tasks.clear();
+
+	// Chain the segments and build the caps of the bodies
+	QtConcurrent::blockingMap(bodies, &GLC_SectionEngine::buildSection);
+	const int bodyCount= bodies.size();
+	for (int i= 0; i < bodyCount; ++i)
+	{
+		const BodyTask& body= bodies.at(i);
+		m_SegmentCount+= body.m_Segments.size() / 6;
+		if (!body.m_Section.m_Loops.isEmpty() || !body.m_Section.m_OpenChains.isEmpty())
+		{
+			m_Sections.append(body.m_Section);
+		}
+	}
+
+	// Release the hierarchies of the meshes removed from the collection or not cut by this section
+	QHash<GLC_uint, SectionMesh>::iterator iMesh= m_MeshBvhHash.begin();
+	while (iMesh != m_MeshBvhHash.end())
+	{
+		if (iMesh.value().m_LastCompute != m_ComputeCount)
+		{
+			iMesh= m_MeshBvhHash.erase(iMesh);
+		}
+		else
+		{
+			++iMesh;
+		}
+	}
+
+	return loopCount();
+}
+
+void GLC_SectionEngine::clear()
+{
+	m_MeshBvhHash.clear();
+	m_Sections.clear();
+	m_SegmentCount= 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+const GLC_MeshBvh* GLC_SectionEngine::meshBvh(GLC_Mesh* pMesh)
+{
+	// The hierarchy is shared by the mesh, it is referenced here while it is used
+	SectionMesh& sectionMesh= m_MeshBvhHash[pMesh->id()];
+	sectionMesh.m_pMeshBvh= pMesh->meshBvh();
+	sectionMesh.m_LastCompute= m_ComputeCount;
+	return sectionMesh.m_pMeshBvh.data();
+}
+
+void GLC_SectionEngine::intersectTriangles(SegmentTask& task)
+{
+	const QVector<GLC_Bvh::Node>& nodes= task.m_pMeshBvh->bvh().nodes();
+	const float* pPositions= task.m_pMeshBvh->positions().constData();
+	const GLuint* pIndex= task.m_pMeshBvh->trianglesIndex().constData();
+	const double* plane= task.m_Plane;
+
+	QVector<int> stack;
+	stack.append(task.m_Node);
+	while (!stack.isEmpty())
+	{
+		const int nodeIndex= stack.last();
+		stack.removeLast();
+		const GLC_Bvh::Node& node= nodes.at(nodeIndex);
+
+		const double lower[3]= {node.m_Lower[0], node.m_Lower[1], node.m_Lower[2]};
+		const double upper[3]= {node.m_Upper[0], node.m_Upper[1], node.m_Upper[2]};
+		if (!boxIsCut(plane, lower, upper)) continue;
+
+		if (0 == node.m_Count)
+		{
+			stack.append(nodeIndex + 1);
+			stack.append(node.m_Offset);
+			continue;
+		}
+
+		const int end= node.m_Offset + node.m_Count;
+		for (int slot= node.m_Offset; slot < end; ++slot)
+		{
+			const GLuint* pTriangle= pIndex + (slot * 3);
+			const float* p[3]= {pPositions + (pTriangle[0] * 3), pPositions + (pTriangle[1] * 3), pPositions + (pTriangle[2] * 3)};
+			double distances[3];
+			int negativeCount= 0;
+			for (int vertex= 0; vertex < 3; ++vertex)
+			{
+				distances[vertex]= plane[0] * p[vertex][0] + plane[1] * p[vertex][1] + plane[2] * p[vertex][2] + plane[3];
+				if (distances[vertex] < 0.0) ++negativeCount;
+			}
+			if ((0 == negativeCount) || (3 == negativeCount)) continue;
+
+			// A vertex on the plane is on the positive side, so a triangle crosses the plane
+			// by exactly 2 edges. The point of an edge is computed from its lexicographically
+			// first end, the triangles sharing the edge give the same point.
+			double points[2][3];
+			int pointCount= 0;
+			for (int edge= 0; edge < 3; ++edge)
+			{
+				int first= edge;
+				int second= (edge + 1) % 3;
+				if ((distances[first] < 0.0) == (distances[second] < 0.0)) continue;
+
+				const float* p0= p[first];
+				const float* p1= p[second];
+				if ((p1[0] < p0[0]) || ((p1[0] == p0[0]) && ((p1[1] < p0[1]) || ((p1[1] == p0[1]) && (p1[2] < p0[2])))))
+				{
+					qSwap(first, second);
+					qSwap(p0, p1);
+				}
+				const double t= distances[first] / (distances[first] - distances[second]);
+				for (int axis= 0; axis < 3; ++axis)
+				{
+					points[pointCount][axis]= p0[axis] + (static_cast<double>(p1[axis]) - p0[axis]) * t;
+				}
+				++pointCount;
+			}
+
+			// Triangles touching the plane by a vertex give an empty segment
+			if ((points[0][0] == points[1][0]) && (points[0][1] == points[1][1]) && (points[0][2] == points[1][2])) continue;
+
+			task.m_Segments << points[0][0] << points[0][1] << points[0][2] << points[1][0] << points[1][1] << points[1][2];
+		}
+	}
+}
+
+void GLC_SectionEngine::buildSection(BodyTask& task)
+{
+	QVector<double> points;
+	QList<QVector<int> > loops;
+	QList<QVector<int> > openChains;
+	chainSegments(task.m_Segments, task.m_Tolerance, &points, &loops, &openChains);
+
+	// Transform the welded points in world coordinates
+	const double* m= task.m_Matrix.getData();
+	const int pointCount= points.size() / 3;
+	QVector<double> worldPoints(points.size());
+	for (int i= 0; i < pointCount; ++i)
+	{
+		const double* p= points.constData() + (i * 3);
+		for (int row= 0; row < 3; ++row)
+		{
+			worldPoints[i * 3 + row]= m[row] * p[0] + m[4 + row] * p[1] + m[8 + row] * p[2] + m[12 + row];
+		}
+	}
+
+	// The 2d frame of the plane : u ^ v is the cap normal, opposite to the plane normal
+	GLC_Vector3d normal(task.m_Plane[0], task.m_Plane[1], task.m_Plane[2]);
+	normal.normalize();
+	GLC_Vector3d u((qAbs(normal.x()) < 0.9) ? glc::X_AXIS : glc::Y_AXIS);
+	u= u ^ normal;
+	u.normalize();
+	const GLC_Vector3d v((-normal) ^ u);
+
+	Section& section= task.m_Section;
+	QList<QVector<double> > loops2d;
+	const int loopCount= loops.size();
+	for (int i= 0; i < loopCount; ++i)
+	{
+		const QVector<int>& loop= loops.at(i);
+		const int size= loop.size();
+		GLfloatVector data(size * 3);
+		QVector<double> loop2d(size * 2);
+		for (int point= 0; point < size; ++point)
+		{
+			const double* p= worldPoints.constData() + (loop.at(point) * 3);
+			for (int axis= 0; axis < 3; ++axis) data[point * 3 + axis]= static_cast<GLfloat>(p[axis]);
+			loop2d[point * 2]= p[0] * u.x() + p[1] * u.y() + p[2] * u.z();
+			loop2d[point * 2 + 1]= p[0] * v.x() + p[1] * v.y() + p[2] * v.z();
+		}
+		section.m_Loops.append(data);
+		loops2d.append(loop2d);
+	}
+
+	const int chainCount= openChains.size();
+	for (int i= 0; i < chainCount; ++i)
+	{
+		const QVector<int>& chain= openChains.at(i);
+		const int size= chain.size();
+		GLfloatVector data(size * 3);
+		for (int point= 0; point < size; ++point)
+		{
+			const double* p= worldPoints.constData() + (chain.at(point) * 3);
+			for (int axis= 0; axis < 3; ++axis) data[point * 3 + axis]= static_cast<GLfloat>(p[axis]);
+		}
+		section.m_OpenChains.append(data);
+	}
+
+	buildCap(loops2d, task.m_CapIsUsed, &section);
+}
+
+bool GLC_SectionEngine::endPointLessThan(const EndPoint& first, const EndPoint& second)
+{
+	for (int axis= 0; axis < 3; ++axis)
+	{
+		if (first.m_Coordinates[axis] < second.m_Coordinates[axis]) return true;
+		if (first.m_Coordinates[axis] > second.m_Coordinates[axis]) return false;
+	}
+	return first.m_Index < second.m_Index;
+}
+
+void GLC_SectionEngine::chainSegments(const QVector<double>& segments, double tolerance, QVector<double>* pPoints, QList<QVector<int> >* pLoops, QList<QVector<int> >* pOpenChains)
+{
+	const int segmentCount= segments.size() / 6;
+	if (0 == segmentCount) return;
+
+	// Weld the equal end points
+	QVector<EndPoint> endPoints(segmentCount * 2);
+	for (int i= 0; i < (segmentCount * 2); ++i)
+	{
+		EndPoint& endPoint= endPoints[i];
+		for (int axis= 0; axis < 3; ++axis) endPoint.m_Coordinates[axis]= segments.at(i * 3 + axis);
+		endPoint.m_Index= i;
+	}
+	std::sort(endPoints.begin(), endPoints.end(), endPointLessThan);
+
+	QVector<int> pointOf(segmentCount * 2);
+	int pointCount= 0;
+	for (int i= 0; i < (segmentCount * 2); ++i)
+	{
+		const EndPoint& endPoint= endPoints.at(i);
+		if ((0 == i) || (endPoints.at(i - 1).m_Coordinates[0] != endPoint.m_Coordinates[0])
+				|| (endPoints.at(i - 1).m_Coordinates[1] != endPoint.m_Coordinates[1])
+				|| (endPoints.at(i - 1).m_Coordinates[2] != endPoint.m_Coordinates[2]))
+		{
+			(*pPoints) << endPoint.m_Coordinates[0] << endPoint.m_Coordinates[1] << endPoint.m_Coordinates[2];
+			++pointCount;
+		}
+		pointOf[endPoint.m_Index]= pointCount - 1;
+	}
+
+	// The segments around each point
+	QVector<int> offsets(pointCount + 1, 0);
+	for (int i= 0; i < (segmentCount * 2); ++i) ++offsets[pointOf.at(i) + 1];
+	for (int i= 0; i < pointCount; ++i) offsets[i + 1]+= offsets.at(i);
+	QVector<int> incidents(segmentCount * 2);
+	QVector<int> fill(offsets);
+	for (int i= 0; i < (segmentCount * 2); ++i) incidents[fill[pointOf.at(i)]++]= i / 2;
+
+	// Walk the unused segments from each point
+	QVector<bool> isUsed(segmentCount, false);
+	QList<QVector<int> > chains;
+	for (int segment= 0; segment < segmentCount; ++segment)
+	{
+		if (isUsed.at(segment)) continue;
+		isUsed[segment]= true;
+
+		// Extend the chain forward from the segment end, then backward from its start
+		QVector<int> parts[2];
+		parts[0] << pointOf.at(segment * 2) << pointOf.at(segment * 2 + 1);
+		parts[1] << pointOf.at(segment * 2);
+		bool isClosed= false;
+		for (int direction= 0; (direction < 2) && !isClosed; ++direction)
+		{
+			QVector<int>& part= parts[direction];
+			bool isExtended= true;
+			while (isExtended && !isClosed)
+			{
+				isExtended= false;
+				const int point= part.last();
+				for (int i= offsets.at(point); i < offsets.at(point + 1); ++i)
+				{
+					const int next= incidents.at(i);
+					if (isUsed.at(next)) continue;
+					isUsed[next]= true;
+					const int nextPoint= (pointOf.at(next * 2) == point) ? pointOf.at(next * 2 + 1) : pointOf.at(next * 2);
+					part.append(nextPoint);
+					isClosed= (0 == direction) && (nextPoint == part.first());
+					isExtended= true;
+					break;
+				}
+			}
+		}
+
+		if (isClosed)
+		{
+			parts[0].removeLast();
+			if (parts[0].size() > 2) pLoops->append(parts[0]);
+		}
+		else
+		{
+			QVector<int> chain;
+			for (int i= parts[1].size() - 1; i > 0; --i) chain.append(parts[1].at(i));
+			chain+= parts[0];
+			chains.append(chain);
+		}
+	}
+
+	// Close the chains whose ends are near and join the chains whose ends are near
+	const double squaredTolerance= tolerance * tolerance;
+	bool isJoined= true;
+	while (isJoined)
+	{
+		isJoined= false;
+		const int chainCount= chains.size();
+		for (int i= 0; (i < chainCount) && !isJoined; ++i)
+		{
+			QVector<int>& chain= chains[i];
+			const double* pFirst= pPoints->constData() + (chain.first() * 3);
+			const double* pLast= pPoints->constData() + (chain.last() * 3);
+			double dx= pFirst[0] - pLast[0];
+			double dy= pFirst[1] - pLast[1];
+			double dz= pFirst[2] - pLast[2];
+			if ((chain.size() > 3) && ((dx * dx + dy * dy + dz * dz) <= squaredTolerance))
+			{
+				chain.removeLast();
+				pLoops->append(chain);
+				chains.removeAt(i);
+				isJoined= true;
+				break;
+			}
+
+			for (int j= i + 1; (j < chainCount) && !isJoined; ++j)
+			{
+				const QVector<int>& other= chains.at(j);
+				for (int ends= 0; (ends < 4) && !isJoined; ++ends)
+				{
+					// Bit 0 : the end of the chain, bit 1 : the end of the other chain
+					const int chainEnd= (ends & 1) ? chain.last() : chain.first();
+					const int otherEnd= (ends & 2) ? other.last() : other.first();
+					const double* p0= pPoints->constData() + (chainEnd * 3);
+					const double* p1= pPoints->constData() + (otherEnd * 3);
+					dx= p0[0] - p1[0];
+					dy= p0[1] - p1[1];
+					dz= p0[2] - p1[2];
+					if ((dx * dx + dy * dy + dz * dz) > squaredTolerance) continue;
+
+					// Append the other chain starting from its joined end to the last point of the chain
+					if (0 == (ends & 1)) std::reverse(chain.begin(), chain.end());
+					if (0 != (ends & 2))
+					{
+						for (int k= other.size() - 1; k >= 0; --k) chain.append(other.at(k));
+					}
+					else
+					{
+						chain+= other;
+					}
+					chains.removeAt(j);
+					isJoined= true;
+				}
+			}
+		}
+	}
+	(*pOpenChains)+= chains;
+}
+
+void GLC_SectionEngine::buildCap(const QList<QVector<double> >& loops2d, bool capIsUsed, Section* pSection)
+{
+	// The box and the signed area of each loop
+	const int loopCount= loops2d.size();
+	QVector<double> areas(loopCount);
+	QVector<double> boxes(loopCount * 4);
+	for (int i= 0; i < loopCount; ++i)
+	{
+		const QVector<double>& loop= loops2d.at(i);
+		areas[i]= signedArea(loop);
+		double* box= boxes.data() + (i * 4);
+		box[0]= box[2]= loop.at(0);
+		box[1]= box[3]= loop.at(1);
+		const int size= loop.size() / 2;
+		for (int point= 1; point < size; ++point)
+		{
+			box[0]= qMin(box[0], loop.at(point * 2));
+			box[1]= qMin(box[1], loop.at(point * 2 + 1));
+			box[2]= qMax(box[2], loop.at(point * 2));
+			box[3]= qMax(box[3], loop.at(point * 2 + 1));
+		}
+	}
+
+	// The depth of a loop is the number of loops containing it, its parent the smallest of them
+	QVector<int> depths(loopCount, 0);
+	QVector<int> parents(loopCount, -1);
+	for (int i= 0; i < loopCount; ++i)
+	{
+		const double x= loops2d.at(i).at(0);
+		const double y= loops2d.at(i).at(1);
+		for (int j= 0; j < loopCount; ++j)
+		{
+			if ((j == i) || (qAbs(areas.at(j)) <= qAbs(areas.at(i)))) continue;
+			const double* box= boxes.constData() + (j * 4);
+			if ((x < box[0]) || (x > box[2]) || (y < box[1]) || (y > box[3])) continue;
+			if (!loopContains(loops2d.at(j), x, y)) continue;
+			++depths[i];
+			if ((-1 == parents.at(i)) || (qAbs(areas.at(j)) < qAbs(areas.at(parents.at(i))))) parents[i]= j;
+		}
+	}
+
+	pSection->m_Area= 0.0;
+	for (int i= 0; i < loopCount; ++i)
+	{
+		pSection->m_Area+= (0 == (depths.at(i) % 2)) ? qAbs(areas.at(i)) : -qAbs(areas.at(i));
+	}
+	if (!capIsUsed) return;
+
+	// The cap vertices are the loops points
+	QVector<double> points2d;
+	QVector<int> offsets;
+	for (int i= 0; i < loopCount; ++i)
+	{
+		offsets.append(points2d.size() / 2);
+		points2d+= loops2d.at(i);
+		pSection->m_CapPositions+= pSection->m_Loops.at(i);
+	}
+
+	// Triangulate each outer loop with its holes
+	for (int i= 0; i < loopCount; ++i)
+	{
+		if (0 != (depths.at(i) % 2)) continue;
+
+		// The outer loop counterclockwise
+		QVector<int> polygon;
+		const int size= loops2d.at(i).size() / 2;
+		for (int point= 0; point < size; ++point) polygon.append(offsets.at(i) + point);
+		if (areas.at(i) < 0.0) std::reverse(polygon.begin(), polygon.end());
+
+		// The holes clockwise, bridged from the rightmost one
+		QList<QVector<int> > holes;
+		QVector<double> holeMaxX;
+		for (int j= 0; j < loopCount; ++j)
+		{
+			if ((parents.at(j) != i) || (0 == (depths.at(j) % 2))) continue;
+			QVector<int> hole;
+			const int holeSize= loops2d.at(j).size() / 2;
+			for (int point= 0; point < holeSize; ++point) hole.append(offsets.at(j) + point);
+			if (areas.at(j) > 0.0) std::reverse(hole.begin(), hole.end());
+			holes.append(hole);
+			holeMaxX.append(boxes.at(j * 4 + 2));
+		}
+		while (!holes.isEmpty())
+		{
+			int rightmost= 0;
+			for (int j= 1; j < holes.size(); ++j)
+			{
+				if (holeMaxX.at(j) > holeMaxX.at(rightmost)) rightmost= j;
+			}
+			bridgeHole(points2d, holes.at(rightmost), &polygon);
+			holes.removeAt(rightmost);
+			holeMaxX.remove(rightmost);
+		}
+
+		triangulateRegion(points2d, polygon, &(pSection->m_CapIndex));
+	}
+}
+
+void GLC_SectionEngine::triangulateRegion(const QVector<double>& points2d, const QVector<int>& polygon, QVector<GLuint>* pIndex)
+{
+	const int size= polygon.size();
+	if (size < 3) return;
+	const double* xy= points2d.constData();
+
+	// The remaining vertices are linked in a circular list
+	QVector<int> previous(size);
+	QVector<int> next(size);
+	for (int i= 0; i < size; ++i)
+	{
+		previous[i]= (i + size - 1) % size;
+		next[i]= (i + 1) % size;
+	}
+
+	int remaining= size;
+	int current= 0;
+	int failureCount= 0;
+	while (remaining > 3)
+	{
+		const int before= previous.at(current);
+		const int after= next.at(current);
+		const double* a= xy + (polygon.at(before) * 2);
+		const double* b= xy + (polygon.at(current) * 2);
+		const double* c= xy + (polygon.at(after) * 2);
+		const double cross= (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+
+		// A convex vertex is an ear if no reflex vertex is inside its triangle,
+		// the vertices at the same place as a corner are bridge ends and don't hide it
+		bool isEar= (cross > 0.0);
+		for (int k= next.at(after); isEar && (k != before); k= next.at(k))
+		{
+			const double* p= xy + (polygon.at(k) * 2);
+			if (((p[0] == a[0]) && (p[1] == a[1])) || ((p[0] == b[0]) && (p[1] == b[1])) || ((p[0] == c[0]) && (p[1] == c[1]))) continue;
+			const double* pBefore= xy + (polygon.at(previous.at(k)) * 2);
+			const double* pAfter= xy + (polygon.at(next.at(k)) * 2);
+			if (((p[0] - pBefore[0]) * (pAfter[1] - pBefore[1]) - (p[1] - pBefore[1]) * (pAfter[0] - pBefore[0])) > 0.0) continue;
+			const double d0= (b[0] - a[0]) * (p[1] - a[1]) - (b[1] - a[1]) * (p[0] - a[0]);
+			const double d1= (c[0] - b[0]) * (p[1] - b[1]) - (c[1] - b[1]) * (p[0] - b[0]);
+			const double d2= (a[0] - c[0]) * (p[1] - c[1]) - (a[1] - c[1]) * (p[0] - c[0]);
+			isEar= (d0 < 0.0) || (d1 < 0.0) || (d2 < 0.0);
+		}
+
+		// Flat vertices are removed without triangle. When rounding or a self intersecting
+		// loop leaves no ear, a vertex is clipped anyway to end the triangulation.
+		if (isEar || (0.0 == cross) || (failureCount > remaining))
+		{
+			if (cross > 0.0)
+			{
+				pIndex->append(static_cast<GLuint>(polygon.at(before)));
+				pIndex->append(static_cast<GLuint>(polygon.at(current)));
+				pIndex->append(static_cast<GLuint>(polygon.at(after)));
+			}
+			next[before]= after;
+			previous[after]= before;
+			--remaining;
+			current= before;
+			failureCount= 0;
+		}
+		else
+		{
+			current= after;
+			++failureCount;
+		}
+	}
+
+	const int before= previous.at(current);
+	const int after= next.at(current);
+	const double* a= xy + (polygon.at(before) * 2);
+	const double* b= xy + (polygon.at(current) * 2);
+	const double* c= xy + (polygon.at(after) * 2);
+	if (((b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0])) > 0.0)
+	{
+		pIndex->append(static_cast<GLuint>(polygon.at(before)));
+		pIndex->append(static_cast<GLuint>(polygon.at(current)));
+		pIndex->append(static_cast<GLuint>(polygon.at(after)));
+	}
+}
+
+void GLC_SectionEngine::bridgeHole(const QVector<double>& points2d, const QVector<int>& hole, QVector<int>* pPolygon)
+{
+	const double* xy= points2d.constData();
+	const QVector<int>& polygon= *pPolygon;
+	const int size= polygon.size();
+
+	// The rightmost vertex of the hole
+	const int holeSize= hole.size();
+	int holeStart= 0;
+	for (int i= 1; i < holeSize; ++i)
+	{
+		if (xy[hole.at(i) * 2] > xy[hole.at(holeStart) * 2]) holeStart= i;
+	}
+	const double mx= xy[hole.at(holeStart) * 2];
+	const double my= xy[hole.at(holeStart) * 2 + 1];
+
+	// The nearest edge of the polygon crossed by the ray from this vertex toward +x
+	double nearestX= std::numeric_limits<double>::max();
+	int target= -1;
+	for (int i= 0; i < size; ++i)
+	{
+		const double* a= xy + (polygon.at(i) * 2);
+		const double* b= xy + (polygon.at((i + 1) % size) * 2);
+		if ((a[1] > my) == (b[1] > my))
+		{
+			if ((a[1] == my) && (a[0] >= mx) && (a[0] < nearestX))
+			{
+				nearestX= a[0];
+				target= i;
+			}
+			continue;
+		}
+		const double x= a[0] + (my - a[1]) * (b[0] - a[0]) / (b[1] - a[1]);
+		if ((x >= mx) && (x < nearestX))
+		{
+			nearestX= x;
+			// The end of the edge with the largest x, the hit vertex if the ray hits a vertex
+			if (b[1] == my) target= (i + 1) % size;
+			else if (a[1] == my) target= i;
+			else target= (a[0] > b[0]) ? i : ((i + 1) % size);
+		}
+	}
+	if (-1 == target) return;
+
+	// The reflex vertices inside the triangle of the hole vertex, the hit point and the
+	// target may hide the target, the one with the smallest angle to the ray is visible
+	const double* p= xy + (polygon.at(target) * 2);
+	if ((p[0] != nearestX) || (p[1] != my))
+	{
+		const double corners[3][2]= {{mx, my}, {nearestX, my}, {p[0], p[1]}};
+		double bestTangent= qAbs(p[1] - my) / qMax(p[0] - mx, std::numeric_limits<double>::min());
+		const int candidate= target;
+		for (int i= 0; i < size; ++i)
+		{
+			if (i == candidate) continue;
+			const double* q= xy + (polygon.at(i) * 2);
+			if (q[0] <= mx) continue;
+			const double* qBefore= xy + (polygon.at((i + size - 1) % size) * 2);
+			const double* qAfter= xy + (polygon.at((i + 1) % size) * 2);
+			if (((q[0] - qBefore[0]) * (qAfter[1] - qBefore[1]) - (q[1] - qBefore[1]) * (qAfter[0] - qBefore[0])) > 0.0) continue;
+
+			bool hasPositive= false;
+			bool hasNegative= false;
+			for (int corner= 0; corner < 3; ++corner)
+			{
+				const double* e0= corners[corner];
+				const double* e1= corners[(corner + 1) % 3];
+				const double d= (e1[0] - e0[0]) * (q[1] - e0[1]) - (e1[1] - e0[1]) * (q[0] - e0[0]);
+				if (d > 0.0) hasPositive= true;
+				if (d < 0.0) hasNegative= true;
+			}
+			if (hasPositive && hasNegative) continue;
+
+			const double tangent= qAbs(q[1] - my) / (q[0] - mx);
+			if (tangent < bestTangent)
+			{
+				bestTangent= tangent;
+				target= i;
+			}
+		}
+	}
+
+	// Insert the hole after the target : target, hole from its rightmost vertex, back to target
+	QVector<int> bridged;
+	bridged.reserve(size + holeSize + 2);
+	for (int i= 0; i <= target; ++i) bridged.append(polygon.at(i));
+	for (int i= 0; i <= holeSize; ++i) bridged.append(hole.at((holeStart + i) % holeSize));
+	for (int i= target; i < size; ++i) bridged.append(polygon.at(i));
+	*pPolygon= bridged;
+}
+
+bool GLC_SectionEngine::boxIsCut(const double plane[4], const double lower[3], const double upper[3])
+{
+	// The positive vertex is the farthest on the positive side, the negative one on the negative side
+	double positive= plane[3];
+	double negative= plane[3];
+	for (int axis= 0; axis < 3; ++axis)
+	{
+		if (plane[axis] >= 0.0)
+		{
+			positive+= plane[axis] * upper[axis];
+			negative+= plane[axis] * lower[axis];
+		}
+		else
+		{
+			positive+= plane[axis] * lower[axis];
+			negative+= plane[axis] * upper[axis];
+		}
+	}
+	return (positive >= 0.0) && (negative < 0.0);
+}
+
+double GLC_SectionEngine::signedArea(const QVector<double>& loop2d)
+{
+	double subject= 0.0;
+	const int size= loop2d.size() / 2;
+	for (int i= 0; i < size; ++i)
+	{
+		const int j= (i + 1) % size;
+		subject+= loop2d.at(i * 2) * loop2d.at(j * 2 + 1) - loop2d.at(j * 2) * loop2d.at(i * 2 + 1);
+	}
+	return subject * 0.5;
+}
+
+bool GLC_SectionEngine::loopContains(const QVector<double>& loop2d, double x, double y)
+{
+	// Even odd rule
+	bool subject= false;
+	const int size= loop2d.size() / 2;
+	for (int i= 0, j= size - 1; i < size; j= i++)
+	{
+		const double xi= loop2d.at(i * 2);
+		const double yi= loop2d.at(i * 2 + 1);
+		const double xj= loop2d.at(j * 2);
+		const double yj= loop2d.at(j * 2 + 1);
+		if (((yi > y) != (yj > y)) && (x < (xj - xi) * (y - yi) / (yj - yi) + xi))
+		{
+			subject= !subject;
+		}
+	}
+	return subject;
+}
+
+void GLC_SectionEngine::localPlane(const GLC_Plane& plane, const GLC_Matrix4x4& matrix, double local[4])
+{
+	// The local plane of a world plane P is transpose(M) * P
+	const double* m= matrix.getData();
+	const double* p= plane.data();
+	for (int column= 0; column < 4; ++column)
+	{
+		local[column]= p[0] * m[column * 4] + p[1] * m[column * 4 + 1] + p[2] * m[column * 4 + 2] + p[3] * m[column * 4 + 3];
+	}
+}
@@ -0,0 +1,304 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_sectionengine.h interface for the GLC_SectionEngine class.
+
+#ifndef GLC_SECTIONENGINE_H_
+#define GLC_SECTIONENGINE_H_
+
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+
+#include "../glc_global.h"
+#include "../geometry/glc_meshbvh.h"
+#include "../maths/glc_plane.h"
+#include "../maths/glc_matrix4x4.h"
+
+#include "../glc_config.h"
+
+class GLC_3DViewCollection;
+class GLC_Polylines;
+class GLC_Mesh;
+class GLC_Material;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_SectionEngine
+/*! \brief GLC_SectionEngine : Compute the section curves and caps of a collection cut by a plane */
+
+/*! The triangles of the LOD 0 of the meshes of the visible instances are
+ *  intersected with the plane on the CPU. The crossed triangles are found with
+ *  the GLC_MeshBvh given by each mesh, see GLC_State::isMeshBvhActivated(), big hierarchies are split
+ *  in subtrees intersected in parallel.
+ *
+ *  The segments of a body are welded by their end points and chained into loops,
+ *  the points of the segments crossing an edge shared by two triangles are equal.
+ *  Chains which don't close, on meshes which are not closed, are joined when their
+ *  ends are nearer than a small ratio of the body size, otherwise they are kept open.
+ *
+ *  The loops of a body are nested by containment : a loop inside an odd number
+ *  of loops is a hole. Each region made of an outer loop and its holes is triangulated
+ *  in the plane, the cap faces the negative side of the plane so it closes the solid
+ *  kept by a clip plane with the same equation.
+ *
+ *  A section can be computed each time the plane of a GLC_CuttingPlane moves,
+ *  the hierarchies are built once by mesh from the client side data, the engine
+ *  doesn't need an OpenGL context.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_SectionEngine
+{
+public:
+	//! The section of a body
+	struct Section
+	{
+		//! The instance id
+		GLC_uint m_InstanceId;
+
+		//! The body id
+		GLC_uint m_BodyId;
+
+		//! The closed loops in world coordinates, 3 floats per point, the first point is not repeated
+		QList<GLfloatVector> m_Loops;
+
+		//! The chains which don't close in world coordinates, 3 floats per point
+		QList<GLfloatVector> m_OpenChains;
+
+		//! The cap vertices in world coordinates, the points of the loops
+		GLfloatVector m_CapPositions;
+
+		//! The cap triangles, 3 index per triangle
+		QVector<GLuint> m_CapIndex;
+
+		//! The area enclosed by the loops
+		double m_Area;
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a section engine of the given collection
+	explicit GLC_SectionEngine(GLC_3DViewCollection* pCollection= NULL);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the collection of this engine
+	inline GLC_3DViewCollection* collection() const
+	{return m_pCollection;}
+
+	//! Return the plane of the last section
+	inline GLC_Plane plane() const
+	{return m_Plane;}
+
+	//! Return true if the caps are computed
+	inline bool capIsUsed() const
+	{return m_CapIsUsed;}
+
+	//! Return the number of mesh hierarchies referenced by the last section
+	inline int meshBvhCount() const
+	{return m_MeshBvhHash.size();}
+
+	//! Return the sections of the bodies cut by the last section
+	inline const QList<Section>& sections() const
+	{return m_Sections;}
+
+	//! Return the number of closed loops of the last section
+	int loopCount() const;
+
+	//! Return the number of open chains of the last section
+	int openChainCount() const;
+
+	//! Return the number of segments of the last section
+	inline int segmentCount() const
+	{return m_SegmentCount;}
+
+	//! Return the area enclosed by the loops of the last section
+	double area() const;
+
+	//! Return a new polylines of the loops and open chains of the last section
+	/*! The loops are closed by repeating their first point*/
+	GLC_Polylines* createContours() const;
+
+	//! Return a new mesh of the caps of the last section with the given material
+	/*! Return NULL if there is no cap*/
+	GLC_Mesh* createCaps(GLC_Material* pMaterial= NULL) const;
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set the collection of this engine
+	void setCollection(GLC_3DViewCollection* pCollection);
+
+	//! Set the caps usage
+	inline void setCapUsage(bool usage)
+	{m_CapIsUsed= usage;}
+
+	//! Compute the section of the visible instances by the given world plane
+	/*! Return the number of closed loops*/
+	int compute(const GLC_Plane& plane);
+
+	//! Remove the meshes hierarchies and the last section
+	void clear();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The hierarchy of a mesh referenced by the engine
+	struct SectionMesh
+	{
+		//! The hierarchy given by the mesh
+		QSharedPointer<const GLC_MeshBvh> m_pMeshBvh;
+
+		//! The number of the last section which used this mesh
+		int m_LastCompute;
+	};
+
+	//! The intersection of the triangles of a mesh subtree with the plane
+	struct SegmentTask
+	{
+		//! The mesh hierarchy
+		const GLC_MeshBvh* m_pMeshBvh;
+
+		//! The plane in mesh coordinates
+		double m_Plane[4];
+
+		//! The root node of the subtree
+		int m_Node;
+
+		//! The index of the cut body
+		int m_Body;
+
+		//! Result : the segments in mesh coordinates, 6 doubles per segment
+		QVector<double> m_Segments;
+	};
+
+	//! A body cut by the plane
+	struct BodyTask
+	{
+		//! The instance matrix
+		GLC_Matrix4x4 m_Matrix;
+
+		//! The world plane
+		double m_Plane[4];
+
+		//! The distance under which chain ends are joined in mesh coordinates
+		double m_Tolerance;
+
+		//! True to compute the caps
+		bool m_CapIsUsed;
+
+		//! The segments in mesh coordinates, 6 doubles per segment
+		QVector<double> m_Segments;
+
+		//! Result : the section of the body
+		Section m_Section;
+	};
+
+	//! An end point of a segment
+	struct EndPoint
+	{
+		//! The point coordinates
+		double m_Coordinates[3];
+
+		//! The index of the end point, 2 * segment + end
+		int m_Index;
+	};
+
+	//! Return the hierarchy of the given mesh and mark it used by the current section
+	const GLC_MeshBvh* meshBvh(GLC_Mesh* pMesh);
+
+	//! Intersect the triangles of the given task
+	static void intersectTriangles(SegmentTask& task);
+
+	//! Chain the segments of the given body and build its section
+	static void buildSection(BodyTask& task);
+
+	//! Return true if the first end point is before the second one in lexicographic order
+	static bool endPointLessThan(const EndPoint& first, const EndPoint& second);
+
+	//! Chain the given segments, set the loops and the open chains as lists of welded points
+	/*! The points are 3 doubles each in the given points vector*/
+	static void chainSegments(const QVector<double>& segments, double tolerance, QVector<double>* pPoints, QList<QVector<int> >* pLoops, QList<QVector<int> >* pOpenChains);
+
+	//! Nest the given loops of a section, set its area and its cap if capIsUsed is true
+	/*! The loops are the loops of the section in 2d coordinates of the plane*/
+	static void buildCap(const QList<QVector<double> >& loops2d, bool capIsUsed, Section* pSection);
+
+	//! Append the triangles of the given counterclockwise polygon to the given index
+	/*! The polygon is given by the index of its 2d points, an index can be repeated*/
+	static void triangulateRegion(const QVector<double>& points2d, const QVector<int>& polygon, QVector<GLuint>* pIndex);
+
+	//! Bridge the given clockwise hole to the given counterclockwise polygon
+	static void bridgeHole(const QVector<double>& points2d, const QVector<int>& hole, QVector<int>* pPolygon);
+
+	//! Return true if the given box is crossed by the given plane
+	static bool boxIsCut(const double plane[4], const double lower[3], const double upper[3]);
+
+	//! Return the signed area of the given 2d loop
+	static double signedArea(const QVector<double>& loop2d);
+
+	//! Return true if the given 2d point is inside the given 2d loop
+	static bool loopContains(const QVector<double>& loop2d, double x, double y);
+
+	//! Return the local plane of the given world plane in the coordinates of the given matrix
+	static void localPlane(const GLC_Plane& plane, const GLC_Matrix4x4& matrix, double local[4]);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The collection
+	GLC_3DViewCollection* m_pCollection;
+
+	//! The plane of the last section
+	GLC_Plane m_Plane;
+
+	//! True if the caps are computed
+	bool m_CapIsUsed;
+
+	//! The cut bodies of the last section
+	QList<Section> m_Sections;
+
+	//! The number of segments of the last section
+	int m_SegmentCount;
+
+	//! The number of computed sections
+	int m_ComputeCount;
+
+	//! The meshes hierarchies by mesh id
+	QHash<GLC_uint, SectionMesh> m_MeshBvhHash;
+};
+
+#endif /* GLC_SECTIONENGINE_H_ */
@@ -23,6 +23,7 @@
 
 #include "glc_spacepartitioning.h"
 #include "glc_3dviewcollection.h"
+#include "../viewport/glc_frustumculler.h"
 
 #include <QtGlobal>
 
@@ -45,6 +46,38 @@ GLC_SpacePartitioning::~GLC_SpacePartitioning()
 
 }
 
+QList<GLC_3DViewInstance*> GLC_SpacePartitioning::listOfInstancesInFrustum(const GLC_Frustum& frustum)
+{
+	const QList<GLC_3DViewInstance*> instances= m_pCollection->instancesHandle();
+	const int instanceCount= instances.size();
+
+	GLC_FrustumCuller culler(frustum);
+	culler.reserve(instanceCount);
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		culler.appendBox(instances.at(i)->boundingBox());
+	}
+	QVector<GLC_Frustum::Localisation> localisations;
+	culler.localizeBoxes(&localisations);
+
+	QList<GLC_3DViewInstance*> subject;
+	for (int i= 0; i < instanceCount; ++i)
+	{
+		if (localisations.at(i) != GLC_Frustum::OutFrustum)
+		{
+			subject.append(instances.at(i));
+		}
+	}
+	return subject;
+}
+
+void GLC_SpacePartitioning::updateInstances(const QList<GLC_3DViewInstance*>& movedInstances, const QList<GLC_3DViewInstance*>& addedInstances, const QSet<GLC_3DViewInstance*>& removedInstances)
+{
+	Q_UNUSED(movedInstances);
+	Q_UNUSED(addedInstances);
+	Q_UNUSED(removedInstances);
+}
+
 void GLC_SpacePartitioning::set3DViewCollection(GLC_3DViewCollection *pCollection)
 {
     Q_ASSERT(NULL != pCollection);
@@ -24,6 +24,9 @@
 #ifndef GLC_SPACEPARTITIONING_H_
 #define GLC_SPACEPARTITIONING_H_
 
+#include <QList>
+#include <QSet>
+
 #include "../glc_config.h"
 #include "../glc_boundingbox.h"
 #include "../viewport/glc_frustum.h"
@@ -66,6 +69,10 @@ public:
 	//! Return the list off instances inside or intersect the given bounding box
 	virtual QList<GLC_3DViewInstance*> listOfIntersectedInstances(const GLC_BoundingBox&)= 0;
 
+	//! Return the list of instances which may be inside or intersect the given frustum
+	/*! The default implementation localizes the bounding box of all instances of the collection*/
+	virtual QList<GLC_3DViewInstance*> listOfInstancesInFrustum(const GLC_Frustum& frustum);
+
 
 //@}
 //////////////////////////////////////////////////////////////////////
@@ -80,6 +87,11 @@ public:
 	//! Update the space partionning
 	virtual void updateSpacePartitioning()= 0;
 
+	//! Update the space partitioning with the instances moved, added and removed since the last update
+	/*! The removed instances are deleted and must not be dereferenced.
+	 *  The default implementation does nothing, updateSpacePartitioning() must be called*/
+	virtual void updateInstances(const QList<GLC_3DViewInstance*>& movedInstances, const QList<GLC_3DViewInstance*>& addedInstances, const QSet<GLC_3DViewInstance*>& removedInstances);
+
 	//! Clear the space partionning
 	virtual void clear()= 0;
 
@@ -41,6 +41,12 @@ GLC_StructOccurrence::GLC_StructOccurrence()
 , m_pRenderProperties(NULL)
 , m_AutomaticCreationOf3DViewInstance(true)
 , m_pRelativeMatrix(NULL)
+, m_BoundingBox()
+, m_BoundingBoxIsValid(false)
+, m_NumberOfFaces(0)
+, m_NumberOfVertex(0)
+, m_MaterialSet()
+, m_StatisticsAreValid(false)
 {
 	// Update instance
 	m_pStructInstance->structOccurrenceCreated(this);
@@ -59,6 +65,12 @@ GLC_StructOccurrence::GLC_StructOccurrence(GLC_StructInstance* pStructInstance,
 , m_pRenderProperties(NULL)
 , m_AutomaticCreationOf3DViewInstance(true)
 , m_pRelativeMatrix(NULL)
+, m_BoundingBox()
+, m_BoundingBoxIsValid(false)
+, m_NumberOfFaces(0)
+, m_NumberOfVertex(0)
+, m_MaterialSet()
+, m_StatisticsAreValid(false)
 {
 	doCreateOccurrenceFromInstance(shaderId);
 }
@@ -76,6 +88,12 @@ GLC_StructOccurrence::GLC_StructOccurrence(GLC_StructInstance* pStructInstance,
 , m_pRenderProperties(NULL)
 , m_AutomaticCreationOf3DViewInstance(true)
 , m_pRelativeMatrix(NULL)
+, m_BoundingBox()
+, m_BoundingBoxIsValid(false)
+, m_NumberOfFaces(0)
+, m_NumberOfVertex(0)
+, m_MaterialSet()
+, m_StatisticsAreValid(false)
 {
 	doCreateOccurrenceFromInstance(shaderId);
 }
@@ -93,6 +111,12 @@ GLC_StructOccurrence::GLC_StructOccurrence(GLC_3DRep* pRep)
 , m_pRenderProperties(NULL)
 , m_AutomaticCreationOf3DViewInstance(true)
 , m_pRelativeMatrix(NULL)
+, m_BoundingBox()
+, m_BoundingBoxIsValid(false)
+, m_NumberOfFaces(0)
+, m_NumberOfVertex(0)
+, m_MaterialSet()
+, m_StatisticsAreValid(false)
 {
 	m_pStructInstance= new GLC_StructInstance(pRep);
 
@@ -113,6 +137,12 @@ GLC_StructOccurrence::GLC_StructOccurrence(GLC_3DRep* pRep, GLC_uint id)
 , m_pRenderProperties(NULL)
 , m_AutomaticCreationOf3DViewInstance(true)
 , m_pRelativeMatrix(NULL)
+, m_BoundingBox()
+, m_BoundingBoxIsValid(false)
+, m_NumberOfFaces(0)
+, m_NumberOfVertex(0)
+, m_MaterialSet()
+, m_StatisticsAreValid(false)
 {
 	m_pStructInstance= new GLC_StructInstance(pRep);
 
@@ -133,6 +163,12 @@ GLC_StructOccurrence::GLC_StructOccurrence(GLC_WorldHandle* pWorldHandle, const
 , m_pRenderProperties(NULL)
 , m_AutomaticCreationOf3DViewInstance(structOccurrence.m_AutomaticCreationOf3DViewInstance)
 , m_pRelativeMatrix(NULL)
+, m_BoundingBox()
+, m_BoundingBoxIsValid(false)
+, m_NumberOfFaces(0)
+, m_NumberOfVertex(0)
+, m_MaterialSet()
+, m_StatisticsAreValid(false)
 {
 	if (shareInstance)
 	{
@@ -331,71 +367,30 @@ QList<GLC_StructOccurrence*> GLC_StructOccurrence::subOccurrenceList() const
 
 unsigned int GLC_StructOccurrence::numberOfFaces() const
 {
-	unsigned int result= 0;
-	if (hasRepresentation())
-	{
-		result= structInstance()->structReference()->numberOfFaces();
-	}
-
-	const int size= m_Childs.size();
-	for (int i= 0; i < size; ++i)
-	{
-		result+= m_Childs.at(i)->numberOfFaces();
-	}
+	if (!m_StatisticsAreValid) computeStatistics();
 
-	return result;
+	return m_NumberOfFaces;
 }
 
 unsigned int GLC_StructOccurrence::numberOfVertex() const
 {
-	unsigned int result= 0;
-	if (hasRepresentation())
-	{
-		result= structInstance()->structReference()->numberOfVertex();
-	}
-	const int size= m_Childs.size();
-	for (int i= 0; i < size; ++i)
-	{
-		result+= m_Childs.at(i)->numberOfVertex();
-	}
+	if (!m_StatisticsAreValid) computeStatistics();
 
-	return result;
+	return m_NumberOfVertex;
 }
 
 unsigned int GLC_StructOccurrence::numberOfMaterials() const
 {
-	unsigned int result= 0;
-	QSet<GLC_Material*> materialSet;
-	if (hasRepresentation())
-	{
-		result= structInstance()->structReference()->numberOfMaterials();
-	}
-
-	const int size= m_Childs.size();
-	for (int i= 0; i < size; ++i)
-	{
-		materialSet.unite(m_Childs.at(i)->materialSet());
-	}
-	result= static_cast<unsigned int>(materialSet.size());
+	if (!m_StatisticsAreValid) computeStatistics();
 
-	return result;
+	return static_cast<unsigned int>(m_MaterialSet.size());
 }
 
 QSet<GLC_Material*> GLC_StructOccurrence::materialSet() const
 {
-	QSet<GLC_Material*> materialSet;
-	if (hasRepresentation())
-	{
-		materialSet= structInstance()->structReference()->materialSet();
-	}
+	if (!m_StatisticsAreValid) computeStatistics();
 
-	const int size= m_Childs.size();
-	for (int i= 0; i < size; ++i)
-	{
-		materialSet.unite(m_Childs.at(i)->materialSet());
-	}
-
-	return materialSet;
+	return m_MaterialSet;
 }
 
 GLC_StructOccurrence* GLC_StructOccurrence::clone(GLC_WorldHandle* pWorldHandle, bool shareInstance) const
@@ -436,21 +431,23 @@ GLC_BoundingBox GLC_StructOccurrence::boundingBox() const
 	{
 		if (has3DViewInstance())
 		{
-			Q_ASSERT(m_pWorldHandle->collection()->contains(id()));
+			// The instance caches its own bounding box
 			boundingBox= m_pWorldHandle->collection()->instanceHandle(id())->boundingBox();
+			m_BoundingBoxIsValid= true;
 		}
 		else
 		{
-			if (hasChild())
+			if (!m_BoundingBoxIsValid)
 			{
-                QList<GLC_StructOccurrence*> childrenList= children();
-				const int size= childrenList.size();
-
+				m_BoundingBox= GLC_BoundingBox();
+				const int size= m_Childs.size();
 				for (int i= 0; i < size; ++i)
 				{
-					boundingBox.combine(childrenList.at(i)->boundingBox());
+					m_BoundingBox.combine(m_Childs.at(i)->boundingBox());
 				}
+				m_BoundingBoxIsValid= true;
 			}
+			boundingBox= m_BoundingBox;
 		}
 	}
 
@@ -595,7 +592,8 @@ GLC_StructOccurrence* GLC_StructOccurrence::updateAbsoluteMatrix()
 
 	if ((NULL != m_pWorldHandle) && m_pWorldHandle->collection()->contains(m_Uid))
 	{
-		m_pWorldHandle->collection()->instanceHandle(m_Uid)->setMatrix(m_AbsoluteMatrix);
+		m_pWorldHandle->collection()->setInstanceMatrix(m_Uid, m_AbsoluteMatrix);
+		invalidateBoundingBox();
 	}
 	return this;
 }
@@ -626,6 +624,8 @@ void GLC_StructOccurrence::addChild(GLC_StructOccurrence* pChild)
 		pChild->setWorldHandle(m_pWorldHandle);
 	}
 	pChild->updateChildrenAbsoluteMatrix();
+	invalidateBoundingBox();
+	invalidateStatistics();
 }
 
 void GLC_StructOccurrence::insertChild(int index, GLC_StructOccurrence* pChild)
@@ -644,6 +644,8 @@ void GLC_StructOccurrence::insertChild(int index, GLC_StructOccurrence* pChild)
 		pChild->setWorldHandle(m_pWorldHandle);
 	}
 	pChild->updateChildrenAbsoluteMatrix();
+	invalidateBoundingBox();
+	invalidateStatistics();
 }
 
 GLC_StructOccurrence* GLC_StructOccurrence::addChild(GLC_StructInstance* pInstance)
@@ -683,6 +685,8 @@ bool GLC_StructOccurrence::removeChild(GLC_StructOccurrence* pChild)
 	Q_ASSERT(pChild->m_pParent == this);
 	pChild->m_pParent= NULL;
 	pChild->detach();
+	invalidateBoundingBox();
+	invalidateStatistics();
 
 	return m_Childs.removeOne(pChild);
 }
@@ -721,6 +725,8 @@ bool GLC_StructOccurrence::create3DViewInstance(GLuint shaderId)
 			{
 				m_pWorldHandle->collection()->select(m_Uid);
 			}
+			invalidateBoundingBox();
+			invalidateStatistics();
 		}
 	}
 	return subject;
@@ -730,6 +736,8 @@ bool GLC_StructOccurrence::remove3DViewInstance()
 {
 	if (NULL != m_pWorldHandle)
 	{
+		invalidateBoundingBox();
+		invalidateStatistics();
 		return m_pWorldHandle->collection()->remove(m_Uid);
 	}
 	else return false;
@@ -747,6 +755,7 @@ void GLC_StructOccurrence::setWorldHandle(GLC_WorldHandle* pWorldHandle)
 	}
 
 	m_pWorldHandle= pWorldHandle;
+	invalidateBoundingBox();
 
 	if (NULL != m_pWorldHandle)
 	{
@@ -802,6 +811,8 @@ bool GLC_StructOccurrence::unloadRepresentation()
 
             // Remove this occurence 3DVIew instance
             unloadResult= m_pWorldHandle->collection()->remove(m_Uid);
+            invalidateBoundingBox();
+            invalidateStatistics();
 
             // Check if there is another Occurrence with the same representation
             QSet<GLC_StructOccurrence*> occurrenceSet= pRef->setOfStructOccurrence();
@@ -936,6 +947,8 @@ void GLC_StructOccurrence::setReference(GLC_StructReference* pRef)
 	}
 
 	m_pStructInstance->setReference(pRef);
+	invalidateBoundingBox();
+	invalidateStatistics();
 }
 
 void GLC_StructOccurrence::makeFlexible(const GLC_Matrix4x4& relativeMatrix)
@@ -971,6 +984,28 @@ void GLC_StructOccurrence::swap(int i, int j)
 
 }
 
+void GLC_StructOccurrence::invalidateBoundingBox()
+{
+	// The ancestors of an invalid occurrence are invalid
+	GLC_StructOccurrence* pOccurrence= this;
+	while ((NULL != pOccurrence) && pOccurrence->m_BoundingBoxIsValid)
+	{
+		pOccurrence->m_BoundingBoxIsValid= false;
+		pOccurrence= pOccurrence->m_pParent;
+	}
+}
+
+void GLC_StructOccurrence::invalidateStatistics()
+{
+	// The ancestors of an invalid occurrence are invalid
+	GLC_StructOccurrence* pOccurrence= this;
+	while ((NULL != pOccurrence) && pOccurrence->m_StatisticsAreValid)
+	{
+		pOccurrence->m_StatisticsAreValid= false;
+		pOccurrence= pOccurrence->m_pParent;
+	}
+}
+
 //////////////////////////////////////////////////////////////////////
 // Private services function
 //////////////////////////////////////////////////////////////////////
@@ -991,6 +1026,7 @@ void GLC_StructOccurrence::detach()
 		}
 		m_pWorldHandle->removeOccurrence(this);
 		m_pWorldHandle= NULL;
+		invalidateBoundingBox();
 		if (!m_Childs.isEmpty())
 		{
 			const int size= m_Childs.size();
@@ -1035,3 +1071,27 @@ void GLC_StructOccurrence::doCreateOccurrenceFromInstance(GLuint shaderId)
 	// Update instance
 	m_pStructInstance->structOccurrenceCreated(this);
 }
+
+void GLC_StructOccurrence::computeStatistics() const
+{
+	m_NumberOfFaces= 0;
+	m_NumberOfVertex= 0;
+	m_MaterialSet.clear();
+	if (hasRepresentation())
+	{
+		m_NumberOfFaces= structInstance()->structReference()->numberOfFaces();
+		m_NumberOfVertex= structInstance()->structReference()->numberOfVertex();
+		m_MaterialSet= structInstance()->structReference()->materialSet();
+	}
+
+	const int size= m_Childs.size();
+	for (int i= 0; i < size; ++i)
+	{
+		const GLC_StructOccurrence* pChild= m_Childs.at(i);
+		if (!pChild->m_StatisticsAreValid) pChild->computeStatistics();
+		m_NumberOfFaces+= pChild->m_NumberOfFaces;
+		m_NumberOfVertex+= pChild->m_NumberOfVertex;
+		m_MaterialSet.unite(pChild->m_MaterialSet);
+	}
+	m_StatisticsAreValid= true;
+}
@@ -44,6 +44,7 @@ typedef QList<QPair<QString, uint> > GLC_OccurencePath;
 //////////////////////////////////////////////////////////////////////
 class GLC_LIB_EXPORT GLC_StructOccurrence
 {
+	friend class GLC_TransformTable;
 //////////////////////////////////////////////////////////////////////
 /*! @name Constructor / Destructor */
 //@{
@@ -147,15 +148,18 @@ public:
     QList<GLC_StructOccurrence*> subOccurrenceList() const;
 
 	//! Return the number of faces of the representation of this occurrence
+	/*! The number of faces of the branch is cached until the branch changes*/
 	unsigned int numberOfFaces() const;
 
 	//! Return the number of vertex of the representation of this occurrence
+	/*! The number of vertex of the branch is cached until the branch changes*/
 	unsigned int numberOfVertex() const;
 
 	//! Return the number of materials of the representation of this occurrence
 	unsigned int numberOfMaterials() const;
 
 	//! Return the materials List of the representation of this occurrence
+	/*! The materials of the branch are cached until the branch changes*/
 	QSet<GLC_Material*> materialSet() const;
 
 	//! Return a clone this occurrence
@@ -165,6 +169,7 @@ public:
 	bool isVisible() const;
 
 	//! Return the occurrence Bounding Box
+	/*! The bounding box of an occurrence without 3DViewInstance is cached until the branch changes*/
 	GLC_BoundingBox boundingBox() const;
 
 	//! Return the occurrence number of this occurrence
@@ -300,6 +305,13 @@ public:
     /*! This function assumes that both i and j are at least 0 but less than childCount().*/
 	void swap(int i, int j);
 
+	//! Invalidate the cached bounding box of this occurrence and of its ancestors
+	/*! Must be called when the geometry of a representation of this branch is modified*/
+	void invalidateBoundingBox();
+
+	//! Invalidate the cached number of faces, vertex and materials of this occurrence and of its ancestors
+	void invalidateStatistics();
+
 //@}
 
 //////////////////////////////////////////////////////////////////////
@@ -312,6 +324,9 @@ private:
 	//! Create occurrence from instance and given shader id
 	void doCreateOccurrenceFromInstance(GLuint shaderId);
 
+	//! Compute the cached number of faces, vertex and materials of this branch
+	void computeStatistics() const;
+
 //////////////////////////////////////////////////////////////////////
 // Private members
 //////////////////////////////////////////////////////////////////////
@@ -352,6 +367,26 @@ private:
 	//! The relative matrix of this occurrence if this occurrence is flexible
 	GLC_Matrix4x4* m_pRelativeMatrix;
 
+	//! The cached bounding box of this branch
+	mutable GLC_BoundingBox m_BoundingBox;
+
+	//! True if the cached bounding box is valid
+	/*! If this flag is false, the flags of the ancestors are false*/
+	mutable bool m_BoundingBoxIsValid;
+
+	//! The cached number of faces of this branch
+	mutable unsigned int m_NumberOfFaces;
+
+	//! The cached number of vertex of this branch
+	mutable unsigned int m_NumberOfVertex;
+
+	//! The cached materials of this branch
+	mutable QSet<GLC_Material*> m_MaterialSet;
+
+	//! True if the cached number of faces, vertex and materials are valid
+	/*! If this flag is false, the flags of the ancestors are false*/
+	mutable bool m_StatisticsAreValid;
+
 };
 
 #endif /* GLC_STRUCTOCCURRENCE_H_ */
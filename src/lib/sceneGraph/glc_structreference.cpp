@@ -207,18 +207,20 @@ bool GLC_StructReference::loadRepresentation()
 	Q_ASSERT(NULL != m_pRepresentation);
 	if (m_pRepresentation->load())
 	{
-		QSet<GLC_StructOccurrence*> structOccurrenceSet= this->setOfStructOccurrence();
-		QSet<GLC_StructOccurrence*>::iterator iOcc= structOccurrenceSet.begin();
-		while (structOccurrenceSet.constEnd() != iOcc)
-		{
-			GLC_StructOccurrence* pOccurrence= *iOcc;
-			Q_ASSERT(!pOccurrence->has3DViewInstance());
-			if (pOccurrence->useAutomatic3DViewInstanceCreation())
-			{
-				pOccurrence->create3DViewInstance();
-			}
-			++iOcc;
-		}
+		createOccurrences3DViewInstance();
+		return true;
+	}
+	else return false;
+}
+
+bool GLC_StructReference::loadRepresentation(GLC_3DRep* pLoadedRep)
+{
+	Q_ASSERT(NULL != m_pRepresentation);
+	GLC_3DRep* p3DRep= dynamic_cast<GLC_3DRep*>(m_pRepresentation);
+	Q_ASSERT(NULL != p3DRep);
+	if (p3DRep->load(pLoadedRep))
+	{
+		createOccurrences3DViewInstance();
 		return true;
 	}
 	else return false;
@@ -270,3 +272,21 @@ QList<GLC_StructOccurrence*> GLC_StructReference::addChild(GLC_StructOccurrence*
 	return subject;
 }
 
+//////////////////////////////////////////////////////////////////////
+// Private services functions
+//////////////////////////////////////////////////////////////////////
+void GLC_StructReference::createOccurrences3DViewInstance()
+{
+	QSet<GLC_StructOccurrence*> structOccurrenceSet= this->setOfStructOccurrence();
+	QSet<GLC_StructOccurrence*>::iterator iOcc= structOccurrenceSet.begin();
+	while (structOccurrenceSet.constEnd() != iOcc)
+	{
+		GLC_StructOccurrence* pOccurrence= *iOcc;
+		Q_ASSERT(!pOccurrence->has3DViewInstance());
+		if (pOccurrence->useAutomatic3DViewInstanceCreation())
+		{
+			pOccurrence->create3DViewInstance();
+		}
+		++iOcc;
+	}
+}
@@ -206,6 +206,10 @@ public:
 	/*! The representation must exists*/
 	bool loadRepresentation();
 
+	//! Load the representation from the given representation loaded elsewhere
+	/*! The representation must exists and be a GLC_3DRep*/
+	bool loadRepresentation(GLC_3DRep* pLoadedRep);
+
 	//! Unload the representation
 	/*! The representation must exists*/
 	bool unloadRepresentation();
@@ -217,6 +221,13 @@ public:
 
 //@}
 
+//////////////////////////////////////////////////////////////////////
+// Private services functions
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Create the 3DViewInstance of the occurrences which use automatic creation
+	void createOccurrences3DViewInstance();
+
 //////////////////////////////////////////////////////////////////////
 // Private members
 //////////////////////////////////////////////////////////////////////
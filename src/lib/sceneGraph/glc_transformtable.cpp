@@ -0,0 +1,241 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_transformtable.cpp implementation for the GLC_TransformTable class.
+
+#include <QtConcurrent>
+
+#include <algorithm>
+
+#include "glc_transformtable.h"
+#include "glc_structoccurrence.h"
+#include "glc_3dviewcollection.h"
+#include "glc_worldhandle.h"
+
+// A level with more entries is computed by several threads
+#define GLC_TRANSFORMTABLE_TASK_SIZE 1024
+
+GLC_TransformTable::GLC_TransformTable()
+: m_Occurrences()
+, m_Instances()
+, m_Parents()
+, m_LocalMatrices()
+, m_WorldMatrices()
+, m_DirtyFlags()
+, m_LevelOffsets()
+, m_Indexes()
+, m_RootParentMatrix()
+, m_FirstDirtyLevel(0)
+, m_pCollection(NULL)
+{
+
+}
+
+//////////////////////////////////////////////////////////////////////
+// Get Functions
+//////////////////////////////////////////////////////////////////////
+
+int GLC_TransformTable::indexOf(const GLC_StructOccurrence* pOccurrence) const
+{
+	return m_Indexes.value(pOccurrence, -1);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Set Functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_TransformTable::build(GLC_StructOccurrence* pRoot)
+{
+	Q_ASSERT(NULL != pRoot);
+	clear();
+
+	if (NULL != pRoot->worldHandle())
+	{
+		m_pCollection= pRoot->worldHandle()->collection();
+	}
+	if (NULL != pRoot->parent())
+	{
+		m_RootParentMatrix= pRoot->parent()->absoluteMatrix();
+	}
+
+	// Breadth first order : the entries of a level follow the entries of the previous level
+	m_Occurrences.append(pRoot);
+	m_Parents.append(-1);
+	int first= 0;
+	while (first < m_Occurrences.size())
+	{
+		const int last= m_Occurrences.size();
+		m_LevelOffsets.append(first);
+		for (int i= first; i < last; ++i)
+		{
+			const GLC_StructOccurrence* pOccurrence= m_Occurrences.at(i);
+			const int childCount= pOccurrence->childCount();
+			for (int j= 0; j < childCount; ++j)
+			{
+				m_Occurrences.append(pOccurrence->child(j));
+				m_Parents.append(i);
+			}
+		}
+		first= last;
+	}
+	m_LevelOffsets.append(m_Occurrences.size());
+
+	const int size= m_Occurrences.size();
+	m_Instances.reserve(size);
+	m_LocalMatrices.reserve(size);
+	m_WorldMatrices.reserve(size);
+	m_DirtyFlags.fill(0, size);
+	m_Indexes.reserve(size);
+	for (int i= 0; i < size; ++i)
+	{
+		GLC_StructOccurrence* pOccurrence= m_Occurrences.at(i);
+		GLC_3DViewInstance* pInstance= NULL;
+		if ((NULL != m_pCollection) && m_pCollection->contains(pOccurrence->id()))
+		{
+			pInstance= m_pCollection->instanceHandle(pOccurrence->id());
+		}
+		m_Instances.append(pInstance);
+
+		if (pOccurrence->isFlexible())
+		{
+			m_LocalMatrices.append(pOccurrence->occurrenceRelativeMatrix());
+		}
+		else
+		{
+			m_LocalMatrices.append(pOccurrence->structInstance()->relativeMatrix());
+		}
+		m_WorldMatrices.append(pOccurrence->absoluteMatrix());
+		m_Indexes.insert(pOccurrence, i);
+	}
+	m_FirstDirtyLevel= levelCount();
+}
+
+void GLC_TransformTable::setLocalMatrix(int index, const GLC_Matrix4x4& matrix)
+{
+	m_LocalMatrices[index]= matrix;
+	m_DirtyFlags[index]= 1;
+
+	const int level= static_cast<int>(std::upper_bound(m_LevelOffsets.constBegin(), m_LevelOffsets.constEnd(), index) - m_LevelOffsets.constBegin()) - 1;
+	m_FirstDirtyLevel= qMin(m_FirstDirtyLevel, level);
+}
+
+void GLC_TransformTable::update()
+{
+	const int count= levelCount();
+	if (m_FirstDirtyLevel >= count) return;
+
+	// Detach the arrays before the worker threads write them
+	m_WorldMatrices.data();
+	m_DirtyFlags.data();
+
+	for (int level= m_FirstDirtyLevel; level < count; ++level)
+	{
+		const int first= m_LevelOffsets.at(level);
+		const int last= m_LevelOffsets.at(level + 1);
+		if ((last - first) > GLC_TRANSFORMTABLE_TASK_SIZE)
+		{
+			// The parents are in the previous level, the entries of a level are independent
+			QList<LevelTask> tasks;
+			for (int taskFirst= first; taskFirst < last; taskFirst+= GLC_TRANSFORMTABLE_TASK_SIZE)
+			{
+				LevelTask task;
+				task.m_pTable= this;
+				task.m_First= taskFirst;
+				task.m_Last= qMin(taskFirst + GLC_TRANSFORMTABLE_TASK_SIZE, last);
+				tasks.append(task);
+			}
+			QtConcurrent::blockingMap(tasks, GLC_TransformTable::updateTask);
+		}
+		else
+		{
+			updateRange(first, last);
+		}
+	}
+
+	scatter();
+	m_FirstDirtyLevel= count;
+}
+
+void GLC_TransformTable::clear()
+{
+	m_Occurrences.clear();
+	m_Instances.clear();
+	m_Parents.clear();
+	m_LocalMatrices.clear();
+	m_WorldMatrices.clear();
+	m_DirtyFlags.clear();
+	m_LevelOffsets.clear();
+	m_Indexes.clear();
+	m_RootParentMatrix.setToIdentity();
+	m_FirstDirtyLevel= 0;
+	m_pCollection= NULL;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_TransformTable::updateTask(LevelTask& task)
+{
+	task.m_pTable->updateRange(task.m_First, task.m_Last);
+}
+
+void GLC_TransformTable::updateRange(int first, int last)
+{
+	const int* pParents= m_Parents.constData();
+	const GLC_Matrix4x4* pLocalMatrices= m_LocalMatrices.constData();
+	GLC_Matrix4x4* pWorldMatrices= m_WorldMatrices.data();
+	char* pDirtyFlags= m_DirtyFlags.data();
+
+	for (int i= first; i < last; ++i)
+	{
+		const int parent= pParents[i];
+		if (parent < 0)
+		{
+			if (pDirtyFlags[i]) pWorldMatrices[i]= m_RootParentMatrix * pLocalMatrices[i];
+		}
+		else if (pDirtyFlags[i] || pDirtyFlags[parent])
+		{
+			pDirtyFlags[i]= 1;
+			pWorldMatrices[i]= pWorldMatrices[parent] * pLocalMatrices[i];
+		}
+	}
+}
+
+void GLC_TransformTable::scatter()
+{
+	const int size= m_Occurrences.size();
+	for (int i= m_LevelOffsets.at(m_FirstDirtyLevel); i < size; ++i)
+	{
+		if (m_DirtyFlags.at(i))
+		{
+			GLC_StructOccurrence* pOccurrence= m_Occurrences.at(i);
+			pOccurrence->m_AbsoluteMatrix= m_WorldMatrices.at(i);
+			if (NULL != m_Instances.at(i))
+			{
+				m_Instances.at(i)->setMatrix(m_WorldMatrices.at(i));
+				m_pCollection->setInstanceMoved(pOccurrence->id());
+				pOccurrence->invalidateBoundingBox();
+			}
+			m_DirtyFlags[i]= 0;
+		}
+	}
+}
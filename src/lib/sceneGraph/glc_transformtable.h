@@ -0,0 +1,189 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_transformtable.h interface for the GLC_TransformTable class.
+
+#ifndef GLC_TRANSFORMTABLE_H_
+#define GLC_TRANSFORMTABLE_H_
+
+#include <QVector>
+#include <QHash>
+
+#include "../maths/glc_matrix4x4.h"
+
+#include "../glc_config.h"
+
+class GLC_StructOccurrence;
+class GLC_3DViewInstance;
+class GLC_3DViewCollection;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_TransformTable
+/*! \brief GLC_TransformTable : Flattened transform hierarchy of an occurrence branch */
+
+/*! The occurrences of the branch are stored level by level, each entry has
+ *  the index of its parent, its local matrix and its world matrix in
+ *  contiguous arrays. A parent is always in the level before its children.
+ *
+ *  setLocalMatrix() marks an entry dirty and update() computes the world
+ *  matrices of the dirty entries and of their descendants level by level,
+ *  the entries of a large level are computed by several threads. The
+ *  world matrices are then written in one pass into the occurrences and
+ *  their 3DViewInstances, and the moves are recorded by the collection.
+ *
+ *  The relative matrices of the occurrences are not modified. The table
+ *  must be built again when the branch or its 3DViewInstances change.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_TransformTable
+{
+	//! The entries of a level computed by a worker thread
+	struct LevelTask
+	{
+		//! The table
+		GLC_TransformTable* m_pTable;
+
+		//! The first entry
+		int m_First;
+
+		//! The end entry
+		int m_Last;
+	};
+
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct an empty table
+	GLC_TransformTable();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the number of entries of this table
+	inline int size() const
+	{return m_Occurrences.size();}
+
+	//! Return true if this table is empty
+	inline bool isEmpty() const
+	{return m_Occurrences.isEmpty();}
+
+	//! Return the number of levels of this table
+	inline int levelCount() const
+	{return qMax(0, m_LevelOffsets.size() - 1);}
+
+	//! Return the index of the given occurrence, -1 if it is not in this table
+	int indexOf(const GLC_StructOccurrence* pOccurrence) const;
+
+	//! Return the occurrence of the given entry
+	inline GLC_StructOccurrence* occurrence(int index) const
+	{return m_Occurrences.at(index);}
+
+	//! Return the parent entry of the given entry, -1 for the root
+	inline int parentIndex(int index) const
+	{return m_Parents.at(index);}
+
+	//! Return the local matrix of the given entry
+	inline const GLC_Matrix4x4& localMatrix(int index) const
+	{return m_LocalMatrices.at(index);}
+
+	//! Return the world matrix of the given entry
+	/*! The matrix is up to date after update()*/
+	inline const GLC_Matrix4x4& worldMatrix(int index) const
+	{return m_WorldMatrices.at(index);}
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Build this table from the branch of the given occurrence
+	void build(GLC_StructOccurrence* pRoot);
+
+	//! Set the local matrix of the given entry
+	void setLocalMatrix(int index, const GLC_Matrix4x4& matrix);
+
+	//! Compute the world matrices of the dirty entries and write them into the occurrences
+	void update();
+
+	//! Remove all entries of this table
+	void clear();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Compute the world matrices of the given task entries
+	static void updateTask(LevelTask& task);
+
+	//! Compute the world matrices of the dirty entries of the given range of a level
+	void updateRange(int first, int last);
+
+	//! Write the world matrices of the dirty entries into the occurrences and clear the dirty flags
+	void scatter();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The occurrences by entry
+	QVector<GLC_StructOccurrence*> m_Occurrences;
+
+	//! The 3DViewInstances by entry, NULL if the occurrence has no instance
+	QVector<GLC_3DViewInstance*> m_Instances;
+
+	//! The parent entry by entry
+	QVector<int> m_Parents;
+
+	//! The local matrices by entry
+	QVector<GLC_Matrix4x4> m_LocalMatrices;
+
+	//! The world matrices by entry
+	QVector<GLC_Matrix4x4> m_WorldMatrices;
+
+	//! The dirty flags by entry
+	QVector<char> m_DirtyFlags;
+
+	//! The first entry of each level and the end entry
+	QVector<int> m_LevelOffsets;
+
+	//! The entry index of each occurrence
+	QHash<const GLC_StructOccurrence*, int> m_Indexes;
+
+	//! The world matrix of the parent of the root occurrence
+	GLC_Matrix4x4 m_RootParentMatrix;
+
+	//! The first level with a dirty entry
+	int m_FirstDirtyLevel;
+
+	//! The collection of the 3DViewInstances
+	GLC_3DViewCollection* m_pCollection;
+};
+
+#endif /* GLC_TRANSFORMTABLE_H_ */
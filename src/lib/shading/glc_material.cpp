@@ -26,6 +26,7 @@
 #include "../geometry/glc_geometry.h"
 #include "../glc_factory.h"
 #include "../glc_openglexception.h"
+#include "../glc_frameprofiler.h"
 
 #include <QtDebug>
 
@@ -464,6 +465,7 @@ void GLC_Material::glLoadTexture()
 // Execute OpenGL Material
 void GLC_Material::glExecute()
 {
+	GLC_FrameProfiler::addStateChanges(1);
 
 	GLfloat pAmbientColor[4]= {ambientColor().redF(),
 								ambientColor().greenF(),
@@ -538,6 +540,8 @@ void GLC_Material::glExecute()
 // Execute OpenGL Material
 void GLC_Material::glExecute(float overwriteTransparency)
 {
+	GLC_FrameProfiler::addStateChanges(1);
+
 	GLfloat pAmbientColor[4]= {ambientColor().redF(),
 								ambientColor().greenF(),
 								ambientColor().blueF(),
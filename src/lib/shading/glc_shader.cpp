@@ -29,6 +29,7 @@
 #include "../glc_state.h"
 #include "../glc_context.h"
 #include "../glc_contextmanager.h"
+#include "../glc_frameprofiler.h"
 
 #include "glc_light.h"
 
@@ -47,6 +48,8 @@ GLC_Shader::GLC_Shader()
 , m_TextcoordAttributeId(-1)
 , m_ColorAttributeId(-1)
 , m_NormalAttributeId(-1)
+, m_InstanceMatrixAttributeId(-1)
+, m_InstanceNormalMatrixAttributeId(-1)
 , m_ModelViewLocationId(-1)
 , m_MvpLocationId(-1)
 , m_InvModelViewLocationId(-1)
@@ -78,6 +81,8 @@ GLC_Shader::GLC_Shader(QFile& vertexShaderFile, QFile& fragmentShaderFile)
 , m_TextcoordAttributeId(-1)
 , m_ColorAttributeId(-1)
 , m_NormalAttributeId(-1)
+, m_InstanceMatrixAttributeId(-1)
+, m_InstanceNormalMatrixAttributeId(-1)
 , m_ModelViewLocationId(-1)
 , m_MvpLocationId(-1)
 , m_InvModelViewLocationId(-1)
@@ -109,6 +114,8 @@ GLC_Shader::GLC_Shader(const GLC_Shader& shader)
 , m_TextcoordAttributeId(-1)
 , m_ColorAttributeId(-1)
 , m_NormalAttributeId(-1)
+, m_InstanceMatrixAttributeId(-1)
+, m_InstanceNormalMatrixAttributeId(-1)
 , m_ModelViewLocationId(-1)
 , m_MvpLocationId(-1)
 , m_InvModelViewLocationId(-1)
@@ -196,6 +203,7 @@ void GLC_Shader::use()
 		m_CurrentShadingGroupId= m_ProgramShaderId;
 		m_ShaderProgramHash.value(m_CurrentShadingGroupId)->m_ProgramShader.bind();
         GLC_ContextManager::instance()->currentContext()->updateUniformVariables();
+		GLC_FrameProfiler::addStateChanges(1);
 	}
 
 }
@@ -214,6 +222,7 @@ bool GLC_Shader::use(GLC_uint shaderId)
 			m_CurrentShadingGroupId= shaderId;
 			m_ShaderProgramHash.value(m_CurrentShadingGroupId)->m_ProgramShader.bind();
             GLC_ContextManager::instance()->currentContext()->updateUniformVariables();
+			GLC_FrameProfiler::addStateChanges(1);
 		}
 
 		return true;
@@ -242,6 +251,7 @@ void GLC_Shader::unuse()
 		m_CurrentShadingGroupId= m_ShadingGroupStack.top();
 		m_ShaderProgramHash.value(m_CurrentShadingGroupId)->m_ProgramShader.bind();
 	}
+	GLC_FrameProfiler::addStateChanges(1);
 }
 
 void GLC_Shader::createAndCompileProgrammShader()
@@ -266,6 +276,8 @@ void GLC_Shader::createAndCompileProgrammShader()
 		//qDebug() << "m_ColorAttributeId " << m_ColorAttributeId;
 		m_NormalAttributeId= m_ProgramShader.attributeLocation("a_normal");
 		//qDebug() << "m_NormalAttributeId " << m_NormalAttributeId;
+		m_InstanceMatrixAttributeId= m_ProgramShader.attributeLocation("a_instance_matrix");
+		m_InstanceNormalMatrixAttributeId= m_ProgramShader.attributeLocation("a_instance_normal_matrix");
 
 		m_ModelViewLocationId= m_ProgramShader.uniformLocation("modelview_matrix");
 		//qDebug() << "m_ModelViewLocationId " << m_ModelViewLocationId;
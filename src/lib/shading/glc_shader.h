@@ -106,6 +106,14 @@ public:
 	inline int normalAttributeId() const
 	{return m_NormalAttributeId;}
 
+	//! Return the per instance matrix attribute id, the matrix uses 4 consecutive ids
+	inline int instanceMatrixAttributeId() const
+	{return m_InstanceMatrixAttributeId;}
+
+	//! Return the per instance normal matrix attribute id, the matrix uses 3 consecutive ids
+	inline int instanceNormalMatrixAttributeId() const
+	{return m_InstanceNormalMatrixAttributeId;}
+
 	//! Return the number of shader
 	static int shaderCount();
 
@@ -285,6 +293,12 @@ private:
 	//! The Normal attribute id
 	int m_NormalAttributeId;
 
+	//! The per instance matrix attribute id
+	int m_InstanceMatrixAttributeId;
+
+	//! The per instance normal matrix attribute id
+	int m_InstanceNormalMatrixAttributeId;
+
 	//! The modelView location matrix id
 	int m_ModelViewLocationId;
 
@@ -27,10 +27,6 @@
 #include "../glc_exception.h"
 #include "../glc_global.h"
 
-// Quazip library
-#include "../quazip/quazip.h"
-#include "../quazip/quazipfile.h"
-
 #include <QtDebug>
 
 // The default maximum texture size
@@ -47,24 +43,18 @@ QHash<GLuint, int> GLC_Texture::m_TextureIdUsage;
 
 //! Default constructor
 GLC_Texture::GLC_Texture()
-: m_pQOpenGLTexture(NULL)
-, m_FileName()
-, m_TextureImage()
-, m_TextureSize()
-, m_HasAlphaChannel(false)
+: m_FileName()
+, m_pTextureImage()
 {
 
 }
 
 // Constructor with fileName
 GLC_Texture::GLC_Texture(const QString &Filename)
-: m_pQOpenGLTexture(NULL)
-, m_FileName(Filename)
-, m_TextureImage(loadFromFile(m_FileName))
-, m_TextureSize()
-, m_HasAlphaChannel(m_TextureImage.hasAlphaChannel())
+: m_FileName(Filename)
+, m_pTextureImage(GLC_TextureImage::fromFile(m_FileName, m_MaxTextureSize))
 {
-    if (m_TextureImage.isNull())
+    if (m_pTextureImage.isNull())
 	{
 		QString ErrorMess("GLC_Texture::GLC_Texture open image : ");
 		ErrorMess.append(m_FileName).append(" Failed");
@@ -72,21 +62,13 @@ GLC_Texture::GLC_Texture(const QString &Filename)
 		GLC_Exception e(ErrorMess);
 		throw(e);
 	}
-    else
-    {
-        m_TextureSize= m_TextureImage.size();
-    }
 }
 // Constructor with QFile
 GLC_Texture::GLC_Texture(const QFile &file)
-: m_pQOpenGLTexture(NULL)
-, m_FileName(file.fileName())
-, m_TextureImage()
-, m_TextureSize()
-, m_HasAlphaChannel(m_TextureImage.hasAlphaChannel())
+: m_FileName(file.fileName())
+, m_pTextureImage(GLC_TextureImage::fromFile(m_FileName, m_MaxTextureSize))
 {
-    m_TextureImage.load(const_cast<QFile*>(&file), QFileInfo(m_FileName).suffix().toLocal8Bit());
-    if (m_TextureImage.isNull())
+    if (m_pTextureImage.isNull())
 	{
 		QString ErrorMess("GLC_Texture::GLC_Texture open image : ");
 		ErrorMess.append(m_FileName).append(" Failed");
@@ -94,31 +76,21 @@ GLC_Texture::GLC_Texture(const QFile &file)
 		GLC_Exception e(ErrorMess);
 		throw(e);
 	}
-    else
-    {
-        m_TextureSize= m_TextureImage.size();
-    }
 }
 
 // Constructor with QImage
 GLC_Texture::GLC_Texture(const QImage& image, const QString& fileName)
-: m_pQOpenGLTexture(NULL)
-, m_FileName(fileName)
-, m_TextureImage(image)
-, m_TextureSize(m_TextureImage.size())
-, m_HasAlphaChannel(m_TextureImage.hasAlphaChannel())
+: m_FileName(fileName)
+, m_pTextureImage(GLC_TextureImage::fromImage(image, m_FileName, m_MaxTextureSize))
 {
-    Q_ASSERT(!m_TextureImage.isNull());
+
 }
 
 GLC_Texture::GLC_Texture(const GLC_Texture &TextureToCopy)
-: m_pQOpenGLTexture(NULL)
-, m_FileName(TextureToCopy.m_FileName)
-, m_TextureImage(TextureToCopy.m_TextureImage)
-, m_TextureSize(TextureToCopy.m_TextureSize)
-, m_HasAlphaChannel(m_TextureImage.hasAlphaChannel())
+: m_FileName(TextureToCopy.m_FileName)
+, m_pTextureImage(TextureToCopy.m_pTextureImage)
 {
-    if (m_TextureImage.isNull())
+    if (m_pTextureImage.isNull())
 	{
 		QString ErrorMess("GLC_Texture::GLC_Texture open image : ");
 		ErrorMess.append(m_FileName).append(" Failed");
@@ -133,12 +105,8 @@ GLC_Texture& GLC_Texture::operator=(const GLC_Texture& texture)
 {
 	if (!(*this == texture))
 	{
-        delete m_pQOpenGLTexture;
-        m_pQOpenGLTexture= NULL;
 		m_FileName= texture.m_FileName;
-        m_TextureImage= texture.m_TextureImage;
-		m_TextureSize= texture.m_TextureSize;
-        m_HasAlphaChannel= m_TextureImage.hasAlphaChannel();
+		m_pTextureImage= texture.m_pTextureImage;
 	}
 
 	return *this;
@@ -146,15 +114,15 @@ GLC_Texture& GLC_Texture::operator=(const GLC_Texture& texture)
 
 GLC_Texture::~GLC_Texture()
 {
-    delete m_pQOpenGLTexture;
+
 }
 
 GLuint GLC_Texture::textureId() const
 {
     GLuint subject= 0;
-    if (m_pQOpenGLTexture)
+    if (isLoaded())
     {
-        subject= m_pQOpenGLTexture->textureId();
+        subject= m_pTextureImage->openGLTexture()->textureId();
     }
 
     return subject;
@@ -167,13 +135,27 @@ GLuint GLC_Texture::textureId() const
 bool GLC_Texture::operator==(const GLC_Texture& texture) const
 {
 	bool result;
-	if (this == &texture)
+	if ((this == &texture) || (m_pTextureImage == texture.m_pTextureImage))
 	{
 		result= true;
 	}
+	else if (m_pTextureImage.isNull() || texture.m_pTextureImage.isNull())
+	{
+		result= false;
+	}
+	else if (m_FileName != texture.m_FileName)
+	{
+		result= false;
+	}
+	else if (m_pTextureImage->isReadable() || texture.m_pTextureImage->isReadable())
+	{
+		// The images are read from the same source, they are not decoded again to be compared
+		result= m_pTextureImage->isReadable() && texture.m_pTextureImage->isReadable();
+	}
 	else
 	{
-        result= (m_FileName == texture.m_FileName) && (m_TextureImage == texture.m_TextureImage);
+		// The images without readable source keep their CPU copy
+		result= (m_pTextureImage->image() == texture.m_pTextureImage->image());
 	}
 	return result;
 }
@@ -202,92 +184,24 @@ void GLC_Texture::setMaxTextureSize(const QSize& size)
 // Load the texture
 void GLC_Texture::glLoadTexture()
 {
-    if (NULL == m_pQOpenGLTexture)
+    if (!m_pTextureImage.isNull())
 	{
-		// Test image size
-        if ((m_TextureImage.height() > m_MaxTextureSize.height())
-                || (m_TextureImage.width() > m_MaxTextureSize.width()))
-		{
-			QImage rescaledImage;
-            if(m_TextureImage.height() > m_TextureImage.width())
-			{
-                rescaledImage= m_TextureImage.scaledToHeight(m_MaxTextureSize.height(), Qt::SmoothTransformation);
-			}
-			else
-			{
-                rescaledImage= m_TextureImage.scaledToWidth(m_MaxTextureSize.width(), Qt::SmoothTransformation);
-			}
-            m_TextureImage= rescaledImage;
-            m_TextureSize= m_TextureImage.size();
-		}
-		else
-		{
-            m_TextureSize= m_TextureImage.size();
-		}
-        m_pQOpenGLTexture= new QOpenGLTexture(m_TextureImage.mirrored());
+		// The image prepared on the worker thread pool is uploaded with its mip levels
+		m_pTextureImage->glLoad(m_MaxTextureSize);
 	}
 }
 
 // Bind texture in 2D mode
 void GLC_Texture::glcBindTexture(void)
 {
-    if (NULL == m_pQOpenGLTexture)
+    if (!isLoaded())
 	{
 		glLoadTexture();
 	}
-    m_pQOpenGLTexture->bind();
-}
-
-QImage GLC_Texture::loadFromFile(const QString& fileName)
-{
-	QImage resultImage;
-	if (glc::isArchiveString(fileName))
-	{
-
-		// Load the image from a zip archive
-		QuaZip* p3dxmlArchive= new QuaZip(glc::archiveFileName(fileName));
-		// Trying to load archive
-		if(!p3dxmlArchive->open(QuaZip::mdUnzip))
-		{
-		  delete p3dxmlArchive;
-		  return QImage();
-		}
-		else
-		{
-			// Set the file Name Codec
-			p3dxmlArchive->setFileNameCodec("IBM866");
-		}
-		QString imageFileName= glc::archiveEntryFileName(fileName);
-
-		// Create QuaZip File
-		QuaZipFile* p3dxmlFile= new QuaZipFile(p3dxmlArchive);
-
-		// Get the file of the 3dxml
-		if (!p3dxmlArchive->setCurrentFile(imageFileName, QuaZip::csInsensitive))
-		{
-			delete p3dxmlFile;
-			delete p3dxmlArchive;
-			return QImage();
-		}
-
-		// Open the file of the 3dxml
-		if(!p3dxmlFile->open(QIODevice::ReadOnly))
-	    {
-			delete p3dxmlFile;
-			delete p3dxmlArchive;
-			return QImage();
-	    }
-		resultImage.load(p3dxmlFile, QFileInfo(imageFileName).suffix().toLocal8Bit());
-		p3dxmlFile->close();
-		delete p3dxmlFile;
-		delete p3dxmlArchive;
-	}
-	else
-	{
-		resultImage.load(fileName);
-	}
-
-	return resultImage;
+    if (isLoaded())
+    {
+        m_pTextureImage->openGLTexture()->bind();
+    }
 }
 
 // Non-member stream operator
@@ -28,6 +28,9 @@
 #include <QFile>
 #include <QtOpenGL>
 #include <QOpenGLTexture>
+#include <QSharedPointer>
+
+#include "glc_textureimage.h"
 
 #include "../glc_config.h"
 
@@ -35,7 +38,9 @@
 //! \class GLC_Texture
 /*! \brief GLC_Texture : Image texture */
 
-/*! Image texture define a texture map in 2 D coordinate system*/
+/*! Image texture define a texture map in 2 D coordinate system
+ *  The image is decoded and prepared on the worker thread pool by a GLC_TextureImage,
+ *  shared by the textures of the same file.*/
 //////////////////////////////////////////////////////////////////////
 
 
@@ -83,11 +88,11 @@ public:
 
 	//! Return true if the texture is loaded
 	inline bool isLoaded() const
-    {return (m_pQOpenGLTexture != NULL);}
+    {return (!m_pTextureImage.isNull() && (m_pTextureImage->openGLTexture() != NULL));}
 
 	//! Return the texture size
 	inline QSize size() const
-	{return m_TextureSize;}
+	{return m_pTextureImage.isNull() ? QSize() : m_pTextureImage->size();}
 
 	//! Return the maximum texture size
 	static QSize maxSize()
@@ -98,11 +103,16 @@ public:
 
 	//! Return true if the texture has alpha channel
 	inline bool hasAlphaChannel() const
-	{ return m_HasAlphaChannel;}
+	{ return !m_pTextureImage.isNull() && m_pTextureImage->hasAlphaChannel();}
 
 	//! Return the an image of the texture
+	/*! The image is read again from the texture file if its CPU copy has been released*/
 	inline QImage imageOfTexture() const
-    { return m_TextureImage;}
+    { return m_pTextureImage.isNull() ? QImage() : m_pTextureImage->image();}
+
+	//! Return the shared image of this texture
+	inline QSharedPointer<GLC_TextureImage> textureImage() const
+	{return m_pTextureImage;}
 
 
 //@}
@@ -127,35 +137,16 @@ public:
 	void glcBindTexture(void);
 
 
-//////////////////////////////////////////////////////////////////////
-/*! @name Private services functions */
-//@{
-//////////////////////////////////////////////////////////////////////
-private:
-	//! Load the image of this texture from the given fileName and return resutling image
-	QImage loadFromFile(const QString& fileName);
-
-//@}
-
 //////////////////////////////////////////////////////////////////////
 // Private members
 //////////////////////////////////////////////////////////////////////
 
 private:
-	//! OpenGL Context
-    QOpenGLTexture *m_pQOpenGLTexture;
-
 	//! Texture Name
 	QString m_FileName;
 
-	//! QImage off the texture
-    QImage m_TextureImage;
-
-	//! Size of the texture
-	QSize m_TextureSize;
-
-	//! Flag to know if the texture has alpha channel
-	bool m_HasAlphaChannel;
+	//! The image and the OpenGL texture shared by the textures of the same file
+	QSharedPointer<GLC_TextureImage> m_pTextureImage;
 
 	//! Static member used to check texture size
 	static QSize m_MaxTextureSize;
@@ -0,0 +1,325 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_textureimage.cpp implementation of the GLC_TextureImage class.
+
+#include <QtConcurrent>
+#include <QImageReader>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QOpenGLTexture>
+#include <QtDebug>
+
+#include "glc_textureimage.h"
+#include "../glc_global.h"
+#include "../glc_state.h"
+
+// Quazip library
+#include "../quazip/quazip.h"
+#include "../quazip/quazipfile.h"
+
+QHash<QString, QWeakPointer<GLC_TextureImage> > GLC_TextureImage::m_SharedImages;
+
+QMutex GLC_TextureImage::m_SharedImagesMutex;
+
+GLC_TextureImage::GLC_TextureImage(const QString& fileName, bool isReadable)
+: m_FileName(fileName)
+, m_IsReadable(isReadable)
+, m_SharedKey()
+, m_Mutex()
+, m_Future()
+, m_IsFinished(false)
+, m_Preparation()
+, m_HeaderSize()
+, m_TextureSize()
+, m_pOpenGLTexture(NULL)
+{
+	m_Preparation.m_HasAlphaChannel= false;
+}
+
+QSharedPointer<GLC_TextureImage> GLC_TextureImage::fromFile(const QString& fileName, const QSize& maxSize)
+{
+	const QString key(sharedKey(fileName));
+	QMutexLocker locker(&m_SharedImagesMutex);
+	QSharedPointer<GLC_TextureImage> subject(m_SharedImages.value(key).toStrongRef());
+	if (subject.isNull())
+	{
+		// Only the header of a file is read here, an archive entry is checked by the preparation
+		QSize headerSize;
+		if (!glc::isArchiveString(fileName))
+		{
+			QImageReader reader(fileName);
+			if (!reader.canRead()) return subject;
+			headerSize= reader.size();
+		}
+
+		subject= QSharedPointer<GLC_TextureImage>(new GLC_TextureImage(fileName, true));
+		subject->m_SharedKey= key;
+		subject->m_HeaderSize= headerSize;
+		subject->m_Future= QtConcurrent::run(GLC_TextureImage::prepareTask, fileName, QImage(), maxSize);
+		m_SharedImages.insert(key, subject.toWeakRef());
+	}
+	return subject;
+}
+
+QSharedPointer<GLC_TextureImage> GLC_TextureImage::fromImage(const QImage& image, const QString& fileName, const QSize& maxSize)
+{
+	Q_ASSERT(!image.isNull());
+	const bool isReadable= !fileName.isEmpty() && (glc::isArchiveString(fileName) || QFileInfo(fileName).isFile());
+	QSharedPointer<GLC_TextureImage> subject(new GLC_TextureImage(fileName, isReadable));
+	subject->m_HeaderSize= image.size();
+	subject->m_Future= QtConcurrent::run(GLC_TextureImage::prepareTask, fileName, image, maxSize);
+	return subject;
+}
+
+GLC_TextureImage::~GLC_TextureImage()
+{
+	m_Future.waitForFinished();
+	delete m_pOpenGLTexture;
+
+	if (!m_SharedKey.isEmpty())
+	{
+		// The entry may have been replaced by a new image of the same file
+		QMutexLocker locker(&m_SharedImagesMutex);
+		QHash<QString, QWeakPointer<GLC_TextureImage> >::iterator iImage= m_SharedImages.find(m_SharedKey);
+		if ((iImage != m_SharedImages.end()) && iImage.value().isNull())
+		{
+			m_SharedImages.erase(iImage);
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// Get Functions
+//////////////////////////////////////////////////////////////////////
+
+bool GLC_TextureImage::isReady() const
+{
+	QMutexLocker locker(&m_Mutex);
+	return m_IsFinished || m_Future.isFinished();
+}
+
+bool GLC_TextureImage::isValid() const
+{
+	QMutexLocker locker(&m_Mutex);
+	finish();
+	return m_Preparation.m_Size.isValid();
+}
+
+QSize GLC_TextureImage::size() const
+{
+	QMutexLocker locker(&m_Mutex);
+	if (m_TextureSize.isValid()) return m_TextureSize;
+	if (m_HeaderSize.isValid()) return m_HeaderSize;
+
+	finish();
+	return m_Preparation.m_Size;
+}
+
+bool GLC_TextureImage::hasAlphaChannel() const
+{
+	QMutexLocker locker(&m_Mutex);
+	finish();
+	return m_Preparation.m_HasAlphaChannel;
+}
+
+QImage GLC_TextureImage::image() const
+{
+	{
+		QMutexLocker locker(&m_Mutex);
+		finish();
+		if (!m_Preparation.m_Image.isNull() || !m_IsReadable) return m_Preparation.m_Image;
+	}
+	return readImage(m_FileName);
+}
+
+int GLC_TextureImage::sharedImageCount()
+{
+	QMutexLocker locker(&m_SharedImagesMutex);
+	return m_SharedImages.size();
+}
+
+QImage GLC_TextureImage::readImage(const QString& fileName)
+{
+	QImage resultImage;
+	if (glc::isArchiveString(fileName))
+	{
+
+		// Load the image from a zip archive
+		QuaZip* p3dxmlArchive= new QuaZip(glc::archiveFileName(fileName));
+		// Trying to load archive
+		if(!p3dxmlArchive->open(QuaZip::mdUnzip))
+		{
+		  delete p3dxmlArchive;
+		  return QImage();
+		}
+		else
+		{
+			// Set the file Name Codec
+			p3dxmlArchive->setFileNameCodec("IBM866");
+		}
+		QString imageFileName= glc::archiveEntryFileName(fileName);
+
+		// Create QuaZip File
+		QuaZipFile* p3dxmlFile= new QuaZipFile(p3dxmlArchive);
+
+		// Get the file of the 3dxml
+		if (!p3dxmlArchive->setCurrentFile(imageFileName, QuaZip::csInsensitive))
+		{
+			delete p3dxmlFile;
+			delete p3dxmlArchive;
+			return QImage();
+		}
+
+		// Open the file of the 3dxml
+		if(!p3dxmlFile->open(QIODevice::ReadOnly))
+	    {
+			delete p3dxmlFile;
+			delete p3dxmlArchive;
+			return QImage();
+	    }
+		resultImage.load(p3dxmlFile, QFileInfo(imageFileName).suffix().toLocal8Bit());
+		p3dxmlFile->close();
+		delete p3dxmlFile;
+		delete p3dxmlArchive;
+	}
+	else
+	{
+		resultImage.load(fileName);
+	}
+
+	return resultImage;
+}
+
+//////////////////////////////////////////////////////////////////////
+// OpenGL Functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_TextureImage::glLoad(const QSize& maxSize)
+{
+	QMutexLocker locker(&m_Mutex);
+	if (NULL != m_pOpenGLTexture) return;
+
+	finish();
+	if (!m_Preparation.m_Size.isValid()) return;
+
+	// The maximum size has changed since the preparation, or the levels have been released
+	if (m_Preparation.m_Levels.isEmpty() || (m_Preparation.m_MaxSize != maxSize))
+	{
+		const QImage sourceImage(m_Preparation.m_Image.isNull() ? readImage(m_FileName) : m_Preparation.m_Image);
+		if (sourceImage.isNull()) return;
+		m_Preparation.m_Levels= mipLevels(sourceImage, maxSize);
+		m_Preparation.m_MaxSize= maxSize;
+	}
+
+	const QList<QImage>& levels= m_Preparation.m_Levels;
+	const int levelCount= levels.size();
+	m_pOpenGLTexture= new QOpenGLTexture(QOpenGLTexture::Target2D);
+	m_pOpenGLTexture->setAutoMipMapGenerationEnabled(false);
+	m_pOpenGLTexture->setFormat(QOpenGLTexture::RGBA8_UNorm);
+	m_pOpenGLTexture->setSize(levels.first().width(), levels.first().height());
+	m_pOpenGLTexture->setMipLevels(levelCount);
+	m_pOpenGLTexture->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8);
+	for (int level= 0; level < levelCount; ++level)
+	{
+		m_pOpenGLTexture->setData(level, QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, levels.at(level).constBits());
+	}
+	m_pOpenGLTexture->setMinMagFilters(QOpenGLTexture::LinearMipMapLinear, QOpenGLTexture::Linear);
+	m_TextureSize= levels.first().size();
+
+	// The levels are only needed by the upload
+	m_Preparation.m_Levels.clear();
+	if (m_IsReadable && GLC_State::isTextureReleaseActivated())
+	{
+		m_Preparation.m_Image= QImage();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_TextureImage::finish() const
+{
+	if (!m_IsFinished)
+	{
+		m_Preparation= m_Future.result();
+		m_Future= QFuture<Preparation>();
+		m_IsFinished= true;
+		if (!m_Preparation.m_Size.isValid())
+		{
+			qDebug() << "GLC_TextureImage::finish open image : " << m_FileName << " Failed";
+		}
+	}
+}
+
+GLC_TextureImage::Preparation GLC_TextureImage::prepareTask(const QString& fileName, const QImage& image, const QSize& maxSize)
+{
+	Preparation subject;
+	subject.m_Image= image.isNull() ? readImage(fileName) : image;
+	subject.m_Size= subject.m_Image.size();
+	subject.m_HasAlphaChannel= subject.m_Image.hasAlphaChannel();
+	subject.m_MaxSize= maxSize;
+	if (!subject.m_Image.isNull())
+	{
+		subject.m_Levels= mipLevels(subject.m_Image, maxSize);
+	}
+	return subject;
+}
+
+QList<QImage> GLC_TextureImage::mipLevels(const QImage& image, const QSize& maxSize)
+{
+	QList<QImage> subject;
+	QImage level(image.convertToFormat(QImage::Format_RGBA8888));
+
+	// Fit the image in the maximum size
+	if ((level.height() > maxSize.height()) || (level.width() > maxSize.width()))
+	{
+		if (level.height() > level.width())
+		{
+			level= level.scaledToHeight(maxSize.height(), Qt::SmoothTransformation);
+		}
+		else
+		{
+			level= level.scaledToWidth(maxSize.width(), Qt::SmoothTransformation);
+		}
+	}
+	level= level.mirrored();
+	subject.append(level);
+
+	// Each level halves the previous one down to 1 x 1
+	int width= level.width();
+	int height= level.height();
+	while ((width > 1) || (height > 1))
+	{
+		width= qMax(1, width / 2);
+		height= qMax(1, height / 2);
+		level= level.scaled(width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation).convertToFormat(QImage::Format_RGBA8888);
+		subject.append(level);
+	}
+	return subject;
+}
+
+QString GLC_TextureImage::sharedKey(const QString& fileName)
+{
+	if (glc::isArchiveString(fileName)) return fileName;
+	else return QFileInfo(fileName).absoluteFilePath();
+}
@@ -0,0 +1,208 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_textureimage.h interface for the GLC_TextureImage class.
+
+#ifndef GLC_TEXTUREIMAGE_H_
+#define GLC_TEXTUREIMAGE_H_
+
+#include <QImage>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QFuture>
+#include <QSharedPointer>
+#include <QWeakPointer>
+
+#include "../glc_config.h"
+
+class QOpenGLTexture;
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_TextureImage
+/*! \brief GLC_TextureImage : The image and the OpenGL texture shared by the textures of a source */
+
+/*! The image is decoded, fitted in the maximum texture size, flipped for OpenGL
+ *  and reduced into its mip levels on the worker thread pool as soon as the
+ *  texture image is created, so the loaders don't wait for the images.
+ *  The functions which need the image wait for the end of its preparation.
+ *
+ *  The texture images of the same file are shared : the textures of the materials
+ *  using this file share the same decoded image and the same OpenGL texture.
+ *
+ *  After the upload of the mip levels the CPU copy is released if its source can be
+ *  read again and GLC_State::isTextureReleaseActivated() is true, image() reads it again
+ *  from its source on demand.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_TextureImage
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the shared texture image of the given file prepared for the given maximum size
+	/*! The file name can be an archive string. Return a null pointer if the file is not a readable image,
+	 *  the image of an archive entry is only checked by its preparation*/
+	static QSharedPointer<GLC_TextureImage> fromFile(const QString& fileName, const QSize& maxSize);
+
+	//! Return a new texture image of the given image prepared for the given maximum size
+	/*! The given file name is the source of the image, it is read again after the release of the CPU copy*/
+	static QSharedPointer<GLC_TextureImage> fromImage(const QImage& image, const QString& fileName, const QSize& maxSize);
+
+	//! Destructor, the OpenGL texture is deleted
+	~GLC_TextureImage();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the source file name
+	inline QString fileName() const
+	{return m_FileName;}
+
+	//! Return true if the source can be read again
+	/*! A texture image without readable source keeps its CPU copy*/
+	inline bool isReadable() const
+	{return m_IsReadable;}
+
+	//! Return true if the preparation of this image is done
+	bool isReady() const;
+
+	//! Return true if the image has been decoded, wait for the preparation
+	bool isValid() const;
+
+	//! Return the size of the source image, or the fitted size once the OpenGL texture is loaded
+	/*! Wait for the preparation if the size was not read from the file header*/
+	QSize size() const;
+
+	//! Return true if the image has an alpha channel, wait for the preparation
+	bool hasAlphaChannel() const;
+
+	//! Return the source image, read it again from its source if it has been released
+	QImage image() const;
+
+	//! Return the OpenGL texture, NULL if it has not been loaded
+	inline QOpenGLTexture* openGLTexture() const
+	{return m_pOpenGLTexture;}
+
+	//! Return the number of texture images shared by file name
+	static int sharedImageCount();
+
+	//! Read the image of the given file or archive string
+	static QImage readImage(const QString& fileName);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name OpenGL Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Load the OpenGL texture fitted in the given maximum size, wait for the preparation
+	void glLoad(const QSize& maxSize);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The result of the preparation of an image
+	struct Preparation
+	{
+		//! The source image
+		QImage m_Image;
+
+		//! The size of the source image
+		QSize m_Size;
+
+		//! True if the source image has an alpha channel
+		bool m_HasAlphaChannel;
+
+		//! The maximum size used to fit the mip levels
+		QSize m_MaxSize;
+
+		//! The mip levels, from the largest
+		QList<QImage> m_Levels;
+	};
+
+	//! Construct a texture image of the given source
+	GLC_TextureImage(const QString& fileName, bool isReadable);
+
+	//! Take the result of the preparation, wait for it if needed, the mutex must be locked
+	void finish() const;
+
+	//! Decode the given image if it is null and prepare its mip levels
+	static Preparation prepareTask(const QString& fileName, const QImage& image, const QSize& maxSize);
+
+	//! Return the mip levels of the given image fitted in the given maximum size
+	/*! The levels are flipped vertically in RGBA 8888 format*/
+	static QList<QImage> mipLevels(const QImage& image, const QSize& maxSize);
+
+	//! Return the key of the given file name in the shared images
+	static QString sharedKey(const QString& fileName);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The source file name
+	QString m_FileName;
+
+	//! True if the source can be read again
+	bool m_IsReadable;
+
+	//! The key of this image in the shared images, empty if it is not shared
+	QString m_SharedKey;
+
+	//! The mutex protecting the preparation
+	mutable QMutex m_Mutex;
+
+	//! The preparation running on the worker thread pool
+	mutable QFuture<Preparation> m_Future;
+
+	//! True if the result of the preparation has been taken
+	mutable bool m_IsFinished;
+
+	//! The result of the preparation
+	mutable Preparation m_Preparation;
+
+	//! The size read from the file header
+	QSize m_HeaderSize;
+
+	//! The size of the loaded OpenGL texture, fitted in the maximum size
+	QSize m_TextureSize;
+
+	//! The OpenGL texture
+	QOpenGLTexture* m_pOpenGLTexture;
+
+	//! The texture images shared by file name
+	static QHash<QString, QWeakPointer<GLC_TextureImage> > m_SharedImages;
+
+	//! The mutex protecting the shared images
+	static QMutex m_SharedImagesMutex;
+};
+
+#endif /* GLC_TEXTUREIMAGE_H_ */
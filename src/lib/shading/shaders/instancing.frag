@@ -0,0 +1,20 @@
+#version 120
+
+// Instancing fragment shader used by GLC_RenderQueue
+
+// Texture, set by GLC_Material
+uniform bool        useTexture;
+uniform sampler2D   tex;
+
+varying vec4    v_front_color;
+varying vec4    v_back_color;
+
+void main()
+{
+    vec4 color= gl_FrontFacing ? v_front_color : v_back_color;
+    if (useTexture)
+    {
+        color*= texture2D(tex, gl_TexCoord[0].st);
+    }
+    gl_FragColor= color;
+}
@@ -0,0 +1,82 @@
+#version 120
+
+// Instancing vertex shader used by GLC_RenderQueue
+// The view matrix is the current model view matrix and the model matrix of
+// each instance and its normal matrix are read from per instance attributes.
+// Lights and materials are the fixed pipeline ones.
+
+// Per instance model matrix
+attribute mat4  a_instance_matrix;
+
+// Per instance inverse transpose of the upper 3x3 of the model matrix
+attribute mat3  a_instance_normal_matrix;
+
+uniform bool    enable_lighting;
+uniform bool    light_model_two_sided;
+uniform bool    light_enable_state[8];
+
+varying vec4    v_front_color;
+varying vec4    v_back_color;
+
+vec4 do_lighting(vec3 n, vec3 p_eye)
+{
+    vec4 vtx_color= gl_FrontLightModelProduct.sceneColor;
+    for (int i= 0; i < 8; ++i)
+    {
+        if (!light_enable_state[i]) continue;
+
+        vec3 VPpli;
+        float att_factor= 1.0;
+        if (gl_LightSource[i].position.w != 0.0)
+        {
+            // this is a point or a spot light
+            VPpli= gl_LightSource[i].position.xyz - p_eye;
+            float distance= length(VPpli);
+            VPpli= VPpli / distance;
+            att_factor= 1.0 / (gl_LightSource[i].constantAttenuation + gl_LightSource[i].linearAttenuation * distance
+                               + gl_LightSource[i].quadraticAttenuation * distance * distance);
+            if (gl_LightSource[i].spotCutoff <= 90.0)
+            {
+                float spot_factor= dot(-VPpli, normalize(gl_LightSource[i].spotDirection));
+                att_factor*= (spot_factor >= gl_LightSource[i].spotCosCutoff) ? pow(spot_factor, gl_LightSource[i].spotExponent) : 0.0;
+            }
+        }
+        else
+        {
+            // this is a directional light
+            VPpli= normalize(gl_LightSource[i].position.xyz);
+        }
+
+        float ndotl= max(0.0, dot(n, VPpli));
+        vec4 light_color= gl_FrontLightProduct[i].ambient + ndotl * gl_FrontLightProduct[i].diffuse;
+        if (ndotl > 0.0)
+        {
+            float ndoth= max(0.0, dot(n, normalize(VPpli + vec3(0.0, 0.0, 1.0))));
+            light_color+= pow(ndoth, gl_FrontMaterial.shininess) * gl_FrontLightProduct[i].specular;
+        }
+        vtx_color+= att_factor * light_color;
+    }
+    vtx_color.a= gl_FrontMaterial.diffuse.a;
+    return vtx_color;
+}
+
+void main()
+{
+    vec4 p_eye= gl_ModelViewMatrix * (a_instance_matrix * gl_Vertex);
+
+    if (enable_lighting)
+    {
+        vec3 n= normalize(gl_NormalMatrix * (a_instance_normal_matrix * gl_Normal));
+        v_front_color= do_lighting(n, p_eye.xyz);
+        v_back_color= light_model_two_sided ? do_lighting(-n, p_eye.xyz) : v_front_color;
+    }
+    else
+    {
+        v_front_color= gl_Color;
+        v_back_color= gl_Color;
+    }
+
+    gl_TexCoord[0]= gl_MultiTexCoord0;
+    gl_ClipVertex= p_eye;
+    gl_Position= gl_ProjectionMatrix * p_eye;
+}
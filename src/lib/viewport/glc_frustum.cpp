@@ -26,6 +26,7 @@
 
 GLC_Frustum::GLC_Frustum()
 : m_PlaneList()
+, m_ClipPlaneList()
 , m_PreviousMatrix()
 {
 	for (int i= 0; i < 6; ++i)
@@ -36,6 +37,7 @@ GLC_Frustum::GLC_Frustum()
 
 GLC_Frustum::GLC_Frustum(const GLC_Frustum& frustum)
 : m_PlaneList(frustum.m_PlaneList)
+, m_ClipPlaneList(frustum.m_ClipPlaneList)
 , m_PreviousMatrix(frustum.m_PreviousMatrix)
 {
 
@@ -48,10 +50,36 @@ GLC_Frustum::~GLC_Frustum()
 
 GLC_Frustum::Localisation GLC_Frustum::localizeBoundingBox(const GLC_BoundingBox& box) const
 {
-	const GLC_Point3d center= box.center();
-	const double radius= box.boundingSphereRadius();
+	const double* lower= box.lowerCorner().data();
+	const double* upper= box.upperCorner().data();
 
-	return localizeSphere(center, radius);
+	// Positive / negative vertex test : the box corner the farthest along the plane
+	// normal is out of the plane only if the whole box is out
+	GLC_Frustum::Localisation localisationResult= InFrustum;
+	const int planeCount= 6 + m_ClipPlaneList.size();
+	for (int i= 0; i < planeCount; ++i)
+	{
+		const double* plane= this->plane(i).data();
+		double positiveDistance= plane[3];
+		double negativeDistance= plane[3];
+		for (int axis= 0; axis < 3; ++axis)
+		{
+			if (plane[axis] >= 0.0)
+			{
+				positiveDistance+= plane[axis] * upper[axis];
+				negativeDistance+= plane[axis] * lower[axis];
+			}
+			else
+			{
+				positiveDistance+= plane[axis] * lower[axis];
+				negativeDistance+= plane[axis] * upper[axis];
+			}
+		}
+		if (positiveDistance < 0.0) return OutFrustum;
+		if (negativeDistance < 0.0) localisationResult= IntersectFrustum;
+	}
+
+	return localisationResult;
 }
 
 GLC_Frustum::Localisation GLC_Frustum::localizeSphere(const GLC_Point3d& center, double radius) const
@@ -60,9 +88,10 @@ GLC_Frustum::Localisation GLC_Frustum::localizeSphere(const GLC_Point3d& center,
 
 	int i= 0;
 	bool continu= true;
-	while (continu && (i < 6))
+	const int planeCount= 6 + m_ClipPlaneList.size();
+	while (continu && (i < planeCount))
 	{
-		localisationResult= static_cast<GLC_Frustum::Localisation>(localisationResult | localizeSphereToPlane(center, radius, m_PlaneList.at(i)));
+		localisationResult= static_cast<GLC_Frustum::Localisation>(localisationResult | localizeSphereToPlane(center, radius, plane(i)));
         continu= (localisationResult != GLC_Frustum::OutFrustum);
 		++i;
 	}
@@ -143,3 +172,21 @@ bool GLC_Frustum::update(const GLC_Matrix4x4& compMatrix)
         return true;
 	}
 }
+
+bool GLC_Frustum::setClipPlanes(const QList<GLC_Plane>& planes)
+{
+	// The sphere test uses signed distances, the planes are normalized
+	QList<GLC_Plane> normalizedPlanes(planes);
+	const int size= normalizedPlanes.size();
+	for (int i= 0; i < size; ++i)
+	{
+		normalizedPlanes[i].normalize();
+	}
+
+	const bool subject= (normalizedPlanes != m_ClipPlaneList);
+	if (subject)
+	{
+		m_ClipPlaneList= normalizedPlanes;
+	}
+	return subject;
+}
@@ -34,7 +34,9 @@ class GLC_LIB_EXPORT GLC_Viewport;
 //! \class GLC_Frustum
 /*! \brief GLC_Frustum : OpenGL Frustum */
 
-/*! GLC_Frustum by 6 planes */
+/*! GLC_Frustum by 6 planes
+ *  Clip planes can be added to the frustum as additional half spaces,
+ *  then what is clipped is localized out of the frustum.*/
 //////////////////////////////////////////////////////////////////////
 class GLC_LIB_EXPORT GLC_Frustum
 {
@@ -100,7 +102,16 @@ public:
 	inline GLC_Plane farClippingPlane() const
 	{return m_PlaneList.at(FarPlane);}
 
+	//! Return the number of additional clip planes
+	inline int clipPlaneCount() const
+	{return m_ClipPlaneList.size();}
+
+	//! Return the additional clip planes, the kept half space is on the positive side
+	inline const QList<GLC_Plane>& clipPlanes() const
+	{return m_ClipPlaneList;}
+
 	//! Localize bounding box
+	/*! Use the exact box test, see GLC_FrustumCuller to localize many boxes*/
 	Localisation localizeBoundingBox(const GLC_BoundingBox&) const;
 
 	//! Localize sphere
@@ -142,6 +153,10 @@ public:
 	/*! Return true if the frustum as change*/
 	bool update(const GLC_Matrix4x4&);
 
+	//! Set the additional clip planes in world coordinates
+	/*! The planes are normalized, return true if the clip planes have changed*/
+	bool setClipPlanes(const QList<GLC_Plane>& planes);
+
 //@}
 //////////////////////////////////////////////////////////////////////
 // Private services function
@@ -150,6 +165,10 @@ private:
 	//! localize a sphere to a plane
 	Localisation localizeSphereToPlane(const GLC_Point3d&, double, const GLC_Plane&) const;
 
+	//! Return the plane of the given index, the frustum planes are followed by the clip planes
+	inline const GLC_Plane& plane(int index) const
+	{return (index < 6) ? m_PlaneList.at(index) : m_ClipPlaneList.at(index - 6);}
+
 //////////////////////////////////////////////////////////////////////
 // Private Member
 //////////////////////////////////////////////////////////////////////
@@ -158,6 +177,9 @@ private:
 	//! The list of frustum plane
 	QList<GLC_Plane> m_PlaneList;
 
+	//! The list of additional clip plane
+	QList<GLC_Plane> m_ClipPlaneList;
+
 	//! The previous frustum matrix
 	GLC_Matrix4x4 m_PreviousMatrix;
 };
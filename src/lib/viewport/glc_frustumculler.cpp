@@ -0,0 +1,405 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_frustumculler.cpp implementation of the GLC_FrustumCuller class.
+
+#include "glc_frustumculler.h"
+
+#include <cfloat>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define GLC_FRUSTUMCULLER_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define GLC_FRUSTUMCULLER_SSE
+#endif
+
+namespace
+{
+	//! The boxes buffers are padded to this number of boxes
+	const int glcCullerBlockSize= 8;
+
+	//! The out test margin relative to the plane magnitude, above the float rounding of the distances
+	const double glcCullerOutEpsilon= 16.0 * FLT_EPSILON;
+}
+
+GLC_FrustumCuller::GLC_FrustumCuller(const GLC_Frustum& frustum)
+: m_PlaneCount(6)
+, m_LowerX()
+, m_LowerY()
+, m_LowerZ()
+, m_UpperX()
+, m_UpperY()
+, m_UpperZ()
+, m_BoxCount(0)
+{
+	setFrustum(frustum);
+}
+
+GLC_FrustumCuller::GLC_FrustumCuller(const GLC_Frustum& frustum, const GLC_Matrix4x4& matrix)
+: m_PlaneCount(6)
+, m_LowerX()
+, m_LowerY()
+, m_LowerZ()
+, m_UpperX()
+, m_UpperY()
+, m_UpperZ()
+, m_BoxCount(0)
+{
+	setFrustum(frustum, matrix);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Get Functions
+//////////////////////////////////////////////////////////////////////
+
+GLC_Frustum::Localisation GLC_FrustumCuller::localize(const GLC_BoundingBox& box) const
+{
+	const float lower[3]= {lowerFloat(box.lowerCorner().x()), lowerFloat(box.lowerCorner().y()), lowerFloat(box.lowerCorner().z())};
+	const float upper[3]= {upperFloat(box.upperCorner().x()), upperFloat(box.upperCorner().y()), upperFloat(box.upperCorner().z())};
+
+	return localize(lower, upper);
+}
+
+GLC_Frustum::Localisation GLC_FrustumCuller::localize(const float lower[3], const float upper[3]) const
+{
+	GLC_Frustum::Localisation localisation= GLC_Frustum::InFrustum;
+	for (int i= 0; i < m_PlaneCount; ++i)
+	{
+		float positiveDistance= m_Planes[i][3];
+		float negativeDistance= m_Planes[i][3];
+		for (int axis= 0; axis < 3; ++axis)
+		{
+			if (m_UpperIsPositive[i][axis])
+			{
+				positiveDistance+= m_Planes[i][axis] * upper[axis];
+				negativeDistance+= m_Planes[i][axis] * lower[axis];
+			}
+			else
+			{
+				positiveDistance+= m_Planes[i][axis] * lower[axis];
+				negativeDistance+= m_Planes[i][axis] * upper[axis];
+			}
+		}
+		if (positiveDistance < m_OutThresholds[i]) return GLC_Frustum::OutFrustum;
+		if (negativeDistance < 0.0f) localisation= GLC_Frustum::IntersectFrustum;
+	}
+
+	return localisation;
+}
+
+void GLC_FrustumCuller::localizeBoxes(QVector<GLC_Frustum::Localisation>* pLocalisations) const
+{
+	Q_ASSERT(NULL != pLocalisations);
+	pLocalisations->resize(m_BoxCount);
+	if (0 == m_BoxCount) return;
+
+	GLC_Frustum::Localisation* pResult= pLocalisations->data();
+	const float* pLowerX= m_LowerX.constData();
+	const float* pLowerY= m_LowerY.constData();
+	const float* pLowerZ= m_LowerZ.constData();
+	const float* pUpperX= m_UpperX.constData();
+	const float* pUpperY= m_UpperY.constData();
+	const float* pUpperZ= m_UpperZ.constData();
+
+#if defined(GLC_FRUSTUMCULLER_AVX)
+	const int width= 8;
+	const __m256 zero= _mm256_setzero_ps();
+	for (int first= 0; first < m_BoxCount; first+= width)
+	{
+		const __m256 lowerX= _mm256_loadu_ps(pLowerX + first);
+		const __m256 lowerY= _mm256_loadu_ps(pLowerY + first);
+		const __m256 lowerZ= _mm256_loadu_ps(pLowerZ + first);
+		const __m256 upperX= _mm256_loadu_ps(pUpperX + first);
+		const __m256 upperY= _mm256_loadu_ps(pUpperY + first);
+		const __m256 upperZ= _mm256_loadu_ps(pUpperZ + first);
+
+		__m256 outMask= zero;
+		__m256 intersectMask= zero;
+		for (int i= 0; i < m_PlaneCount; ++i)
+		{
+			const __m256 a= _mm256_set1_ps(m_Planes[i][0]);
+			const __m256 b= _mm256_set1_ps(m_Planes[i][1]);
+			const __m256 c= _mm256_set1_ps(m_Planes[i][2]);
+			const __m256 d= _mm256_set1_ps(m_Planes[i][3]);
+			const __m256 outThreshold= _mm256_set1_ps(m_OutThresholds[i]);
+
+			const __m256 positiveDistance= _mm256_add_ps(_mm256_add_ps(
+					_mm256_mul_ps(a, m_UpperIsPositive[i][0] ? upperX : lowerX),
+					_mm256_mul_ps(b, m_UpperIsPositive[i][1] ? upperY : lowerY)),
+					_mm256_add_ps(_mm256_mul_ps(c, m_UpperIsPositive[i][2] ? upperZ : lowerZ), d));
+			const __m256 negativeDistance= _mm256_add_ps(_mm256_add_ps(
+					_mm256_mul_ps(a, m_UpperIsPositive[i][0] ? lowerX : upperX),
+					_mm256_mul_ps(b, m_UpperIsPositive[i][1] ? lowerY : upperY)),
+					_mm256_add_ps(_mm256_mul_ps(c, m_UpperIsPositive[i][2] ? lowerZ : upperZ), d));
+
+			outMask= _mm256_or_ps(outMask, _mm256_cmp_ps(positiveDistance, outThreshold, _CMP_LT_OQ));
+			intersectMask= _mm256_or_ps(intersectMask, _mm256_cmp_ps(negativeDistance, zero, _CMP_LT_OQ));
+		}
+
+		const int outBits= _mm256_movemask_ps(outMask);
+		const int intersectBits= _mm256_movemask_ps(intersectMask);
+		const int count= qMin(width, m_BoxCount - first);
+		for (int k= 0; k < count; ++k)
+		{
+			if (outBits & (1 << k)) pResult[first + k]= GLC_Frustum::OutFrustum;
+			else if (intersectBits & (1 << k)) pResult[first + k]= GLC_Frustum::IntersectFrustum;
+			else pResult[first + k]= GLC_Frustum::InFrustum;
+		}
+	}
+#elif defined(GLC_FRUSTUMCULLER_SSE)
+	const int width= 4;
+	const __m128 zero= _mm_setzero_ps();
+	for (int first= 0; first < m_BoxCount; first+= width)
+	{
+		const __m128 lowerX= _mm_loadu_ps(pLowerX + first);
+		const __m128 lowerY= _mm_loadu_ps(pLowerY + first);
+		const __m128 lowerZ= _mm_loadu_ps(pLowerZ + first);
+		const __m128 upperX= _mm_loadu_ps(pUpperX + first);
+		const __m128 upperY= _mm_loadu_ps(pUpperY + first);
+		const __m128 upperZ= _mm_loadu_ps(pUpperZ + first);
+
+		__m128 outMask= zero;
+		__m128 intersectMask= zero;
+		for (int i= 0; i < m_PlaneCount; ++i)
+		{
+			const __m128 a= _mm_set1_ps(m_Planes[i][0]);
+			const __m128 b= _mm_set1_ps(m_Planes[i][1]);
+			const __m128 c= _mm_set1_ps(m_Planes[i][2]);
+			const __m128 d= _mm_set1_ps(m_Planes[i][3]);
+			const __m128 outThreshold= _mm_set1_ps(m_OutThresholds[i]);
+
+			const __m128 positiveDistance= _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(a, m_UpperIsPositive[i][0] ? upperX : lowerX),
+					_mm_mul_ps(b, m_UpperIsPositive[i][1] ? upperY : lowerY)),
+					_mm_add_ps(_mm_mul_ps(c, m_UpperIsPositive[i][2] ? upperZ : lowerZ), d));
+			const __m128 negativeDistance= _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(a, m_UpperIsPositive[i][0] ? lowerX : upperX),
+					_mm_mul_ps(b, m_UpperIsPositive[i][1] ? lowerY : upperY)),
+					_mm_add_ps(_mm_mul_ps(c, m_UpperIsPositive[i][2] ? lowerZ : upperZ), d));
+
+			outMask= _mm_or_ps(outMask, _mm_cmplt_ps(positiveDistance, outThreshold));
+			intersectMask= _mm_or_ps(intersectMask, _mm_cmplt_ps(negativeDistance, zero));
+		}
+
+		const int outBits= _mm_movemask_ps(outMask);
+		const int intersectBits= _mm_movemask_ps(intersectMask);
+		const int count= qMin(width, m_BoxCount - first);
+		for (int k= 0; k < count; ++k)
+		{
+			if (outBits & (1 << k)) pResult[first + k]= GLC_Frustum::OutFrustum;
+			else if (intersectBits & (1 << k)) pResult[first + k]= GLC_Frustum::IntersectFrustum;
+			else pResult[first + k]= GLC_Frustum::InFrustum;
+		}
+	}
+#else
+	Q_UNUSED(pLowerX);
+	Q_UNUSED(pLowerY);
+	Q_UNUSED(pLowerZ);
+	Q_UNUSED(pUpperX);
+	Q_UNUSED(pUpperY);
+	Q_UNUSED(pUpperZ);
+	localizeBoxesScalar(0, pResult);
+#endif
+}
+
+const char* GLC_FrustumCuller::instructionSet()
+{
+#if defined(GLC_FRUSTUMCULLER_AVX)
+	return "AVX";
+#elif defined(GLC_FRUSTUMCULLER_SSE)
+	return "SSE";
+#else
+	return "Scalar";
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////
+// Set Functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_FrustumCuller::setFrustum(const GLC_Frustum& frustum)
+{
+	GLC_Plane planes[GLC_FRUSTUMCULLER_MAX_PLANES];
+	m_PlaneCount= frustumPlanes(frustum, planes);
+	for (int i= 0; i < m_PlaneCount; ++i)
+	{
+		setPlane(i, planes[i].coefA(), planes[i].coefB(), planes[i].coefC(), planes[i].coefD());
+	}
+}
+
+void GLC_FrustumCuller::setFrustum(const GLC_Frustum& frustum, const GLC_Matrix4x4& matrix)
+{
+	// A point p of the local space is in world space M * p, so the plane
+	// equation P.(M * p) is the equation of the local plane (transpose(M) * P).p
+	const double* m= matrix.getData();
+	GLC_Plane planes[GLC_FRUSTUMCULLER_MAX_PLANES];
+	m_PlaneCount= frustumPlanes(frustum, planes);
+	for (int i= 0; i < m_PlaneCount; ++i)
+	{
+		const double* p= planes[i].data();
+		double local[4];
+		for (int column= 0; column < 4; ++column)
+		{
+			local[column]= p[0] * m[column * 4] + p[1] * m[column * 4 + 1] + p[2] * m[column * 4 + 2] + p[3] * m[column * 4 + 3];
+		}
+		setPlane(i, local[0], local[1], local[2], local[3]);
+	}
+}
+
+void GLC_FrustumCuller::clearBoxes()
+{
+	m_BoxCount= 0;
+}
+
+void GLC_FrustumCuller::reserve(int count)
+{
+	const int size= ((count + glcCullerBlockSize - 1) / glcCullerBlockSize) * glcCullerBlockSize;
+	m_LowerX.reserve(size);
+	m_LowerY.reserve(size);
+	m_LowerZ.reserve(size);
+	m_UpperX.reserve(size);
+	m_UpperY.reserve(size);
+	m_UpperZ.reserve(size);
+}
+
+int GLC_FrustumCuller::appendBox(const GLC_BoundingBox& box)
+{
+	if (m_BoxCount == m_LowerX.size())
+	{
+		// Keep the buffers padded to a whole block
+		const int size= m_BoxCount + glcCullerBlockSize;
+		m_LowerX.resize(size);
+		m_LowerY.resize(size);
+		m_LowerZ.resize(size);
+		m_UpperX.resize(size);
+		m_UpperY.resize(size);
+		m_UpperZ.resize(size);
+	}
+
+	const GLC_Point3d& lower= box.lowerCorner();
+	const GLC_Point3d& upper= box.upperCorner();
+	m_LowerX[m_BoxCount]= lowerFloat(lower.x());
+	m_LowerY[m_BoxCount]= lowerFloat(lower.y());
+	m_LowerZ[m_BoxCount]= lowerFloat(lower.z());
+	m_UpperX[m_BoxCount]= upperFloat(upper.x());
+	m_UpperY[m_BoxCount]= upperFloat(upper.y());
+	m_UpperZ[m_BoxCount]= upperFloat(upper.z());
+
+	return m_BoxCount++;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Private services Functions
+//////////////////////////////////////////////////////////////////////
+
+void GLC_FrustumCuller::setPlane(int index, double a, double b, double c, double d)
+{
+	// The plane is normalized in order to keep the float distances in range
+	const double length= sqrt(a * a + b * b + c * c);
+	if (length > 0.0)
+	{
+		a/= length;
+		b/= length;
+		c/= length;
+		d/= length;
+	}
+	m_Planes[index][0]= static_cast<float>(a);
+	m_Planes[index][1]= static_cast<float>(b);
+	m_Planes[index][2]= static_cast<float>(c);
+	m_Planes[index][3]= upperFloat(d);
+
+	// A box is out beyond a margin scaled by the plane magnitude, so the rounding of its
+	// distance does not cull a box touching the plane
+	const double magnitude= fabs(a) + fabs(b) + fabs(c) + fabs(d);
+	m_OutThresholds[index]= lowerFloat(-glcCullerOutEpsilon * magnitude);
+
+	m_UpperIsPositive[index][0]= (a >= 0.0);
+	m_UpperIsPositive[index][1]= (b >= 0.0);
+	m_UpperIsPositive[index][2]= (c >= 0.0);
+}
+
+int GLC_FrustumCuller::frustumPlanes(const GLC_Frustum& frustum, GLC_Plane* pPlanes)
+{
+	pPlanes[0]= frustum.leftClippingPlane();
+	pPlanes[1]= frustum.rightClippingPlane();
+	pPlanes[2]= frustum.topClippingPlane();
+	pPlanes[3]= frustum.bottomClippingPlane();
+	pPlanes[4]= frustum.nearClippingPlane();
+	pPlanes[5]= frustum.farClippingPlane();
+
+	const QList<GLC_Plane>& clipPlanes= frustum.clipPlanes();
+	const int clipPlaneCount= qMin(clipPlanes.size(), GLC_FRUSTUMCULLER_MAX_PLANES - 6);
+	for (int i= 0; i < clipPlaneCount; ++i)
+	{
+		pPlanes[6 + i]= clipPlanes.at(i);
+	}
+	return 6 + clipPlaneCount;
+}
+
+void GLC_FrustumCuller::localizeBoxesScalar(int first, GLC_Frustum::Localisation* pResult) const
+{
+	for (int index= first; index < m_BoxCount; ++index)
+	{
+		const float lower[3]= {m_LowerX.at(index), m_LowerY.at(index), m_LowerZ.at(index)};
+		const float upper[3]= {m_UpperX.at(index), m_UpperY.at(index), m_UpperZ.at(index)};
+
+		GLC_Frustum::Localisation localisation= GLC_Frustum::InFrustum;
+		int i= 0;
+		while ((i < m_PlaneCount) && (GLC_Frustum::OutFrustum != localisation))
+		{
+			float positiveDistance= m_Planes[i][3];
+			float negativeDistance= m_Planes[i][3];
+			for (int axis= 0; axis < 3; ++axis)
+			{
+				const float coef= m_Planes[i][axis];
+				positiveDistance+= coef * (m_UpperIsPositive[i][axis] ? upper[axis] : lower[axis]);
+				negativeDistance+= coef * (m_UpperIsPositive[i][axis] ? lower[axis] : upper[axis]);
+			}
+			if (positiveDistance < m_OutThresholds[i]) localisation= GLC_Frustum::OutFrustum;
+			else if (negativeDistance < 0.0f) localisation= GLC_Frustum::IntersectFrustum;
+			++i;
+		}
+		pResult[index]= localisation;
+	}
+}
+
+float GLC_FrustumCuller::lowerFloat(double value)
+{
+	float result= static_cast<float>(value);
+	if (static_cast<double>(result) > value)
+	{
+		result-= fabs(result) * FLT_EPSILON + FLT_MIN;
+	}
+	return result;
+}
+
+float GLC_FrustumCuller::upperFloat(double value)
+{
+	float result= static_cast<float>(value);
+	if (static_cast<double>(result) < value)
+	{
+		result+= fabs(result) * FLT_EPSILON + FLT_MIN;
+	}
+	return result;
+}
@@ -0,0 +1,176 @@
+/****************************************************************************
+
+ This file is part of the GLC-lib library.
+ Copyright (C) 2005-2008 Laurent Ribon (laumaya@users.sourceforge.net)
+ http://glc-lib.sourceforge.net
+
+ GLC-lib is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+
+ GLC-lib is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with GLC-lib; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*****************************************************************************/
+//! \file glc_frustumculler.h interface for the GLC_FrustumCuller class.
+
+#ifndef GLC_FRUSTUMCULLER_H_
+#define GLC_FRUSTUMCULLER_H_
+
+#include <QVector>
+
+#include "glc_frustum.h"
+#include "../glc_boundingbox.h"
+#include "../maths/glc_matrix4x4.h"
+
+#include "../glc_config.h"
+
+//! The maximum number of planes of a culler : the 6 frustum planes and 8 clip planes
+#define GLC_FRUSTUMCULLER_MAX_PLANES 14
+
+//////////////////////////////////////////////////////////////////////
+//! \class GLC_FrustumCuller
+/*! \brief GLC_FrustumCuller : Localize batches of axis aligned boxes against a frustum */
+
+/*! The boxes are stored in structure of arrays float buffers and localized
+ *  with the positive / negative vertex test : for each plane the box corner
+ *  the farthest along the plane normal decides if the box is out, the nearest
+ *  one if the box intersect the plane. Unlike the bounding sphere test of
+ *  GLC_Frustum::localizeSphere() long thin boxes are not over estimated.
+ *
+ *  The boxes are tested 8 at a time with AVX or 4 at a time with SSE when the
+ *  library is compiled for these instruction sets, otherwise a scalar loop is used.
+ *  Floats are rounded outward and a box is only out beyond a margin of a few
+ *  float epsilons scaled by the plane magnitude, so the float rounding of the
+ *  distances does not cull a box touching a plane. Boxes whose coordinates are
+ *  much larger than the plane distance to the origin get a relatively smaller margin.
+ *
+ *  The frustum can be expressed in the local coordinates of a matrix, in order
+ *  to localize boxes of an instance without transforming them.
+ *
+ *  The clip planes of the frustum are tested as the frustum planes, so clipped boxes
+ *  are out. Clip planes beyond GLC_FRUSTUMCULLER_MAX_PLANES are ignored, which can only
+ *  keep boxes.
+ */
+//////////////////////////////////////////////////////////////////////
+class GLC_LIB_EXPORT GLC_FrustumCuller
+{
+//////////////////////////////////////////////////////////////////////
+/*! @name Constructor / Destructor */
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Construct a culler of the given frustum
+	explicit GLC_FrustumCuller(const GLC_Frustum& frustum= GLC_Frustum());
+
+	//! Construct a culler of the given frustum expressed in the local coordinates of the given matrix
+	GLC_FrustumCuller(const GLC_Frustum& frustum, const GLC_Matrix4x4& matrix);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Get Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Return the number of boxes
+	inline int boxCount() const
+	{return m_BoxCount;}
+
+	//! Return the number of planes, the frustum planes and the clip planes
+	inline int planeCount() const
+	{return m_PlaneCount;}
+
+	//! Return the localisation of the given box
+	GLC_Frustum::Localisation localize(const GLC_BoundingBox& box) const;
+
+	//! Return the localisation of the box of the given float corners
+	GLC_Frustum::Localisation localize(const float lower[3], const float upper[3]) const;
+
+	//! Localize the boxes of this culler in the given vector
+	/*! The vector is resized to the number of boxes*/
+	void localizeBoxes(QVector<GLC_Frustum::Localisation>* pLocalisations) const;
+
+	//! Return the name of the instruction set used to localize boxes
+	static const char* instructionSet();
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Set Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+public:
+	//! Set the frustum to localize against
+	void setFrustum(const GLC_Frustum& frustum);
+
+	//! Set the frustum to localize against, expressed in the local coordinates of the given matrix
+	void setFrustum(const GLC_Frustum& frustum, const GLC_Matrix4x4& matrix);
+
+	//! Remove all boxes of this culler
+	void clearBoxes();
+
+	//! Reserve memory for the given number of boxes
+	void reserve(int count);
+
+	//! Append the given box and return its index
+	int appendBox(const GLC_BoundingBox& box);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+/*! \name Private services Functions*/
+//@{
+//////////////////////////////////////////////////////////////////////
+private:
+	//! Set the plane of the given index
+	void setPlane(int index, double a, double b, double c, double d);
+
+	//! Set the frustum planes followed by the clip planes in the given array and return their number
+	static int frustumPlanes(const GLC_Frustum& frustum, GLC_Plane* pPlanes);
+
+	//! Localize the boxes from the given index with the scalar loop
+	void localizeBoxesScalar(int first, GLC_Frustum::Localisation* pResult) const;
+
+	//! Return the given value rounded to a lower float
+	static float lowerFloat(double value);
+
+	//! Return the given value rounded to an upper float
+	static float upperFloat(double value);
+//@}
+
+//////////////////////////////////////////////////////////////////////
+// Private members
+//////////////////////////////////////////////////////////////////////
+private:
+	//! The frustum and clip planes coefficients (a, b, c, d), positive inside
+	float m_Planes[GLC_FRUSTUMCULLER_MAX_PLANES][4];
+
+	//! For each plane the distance below which a box is out, a small negative margin
+	float m_OutThresholds[GLC_FRUSTUMCULLER_MAX_PLANES];
+
+	//! For each plane and axis true if the positive vertex is on the upper corner
+	bool m_UpperIsPositive[GLC_FRUSTUMCULLER_MAX_PLANES][3];
+
+	//! The number of planes
+	int m_PlaneCount;
+
+	//! The boxes lower corner coordinates
+	QVector<float> m_LowerX;
+	QVector<float> m_LowerY;
+	QVector<float> m_LowerZ;
+
+	//! The boxes upper corner coordinates
+	QVector<float> m_UpperX;
+	QVector<float> m_UpperY;
+	QVector<float> m_UpperZ;
+
+	//! The number of boxes
+	int m_BoxCount;
+};
+
+#endif /* GLC_FRUSTUMCULLER_H_ */
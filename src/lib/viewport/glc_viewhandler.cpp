@@ -31,6 +31,7 @@
 #include "../glc_factory.h"
 #include "../sceneGraph/glc_octree.h"
 #include "../glc_exception.h"
+#include "../glc_frameprofiler.h"
 
 #include "../qml/glc_quickview.h"
 
@@ -290,6 +291,7 @@ void GLC_ViewHandler::renderBackGround()
 
 void GLC_ViewHandler::render()
 {
+    GLC_FrameProfiler::beginFrame();
     try
     {
         QOpenGLContext::currentContext()->functions()->glUseProgram(0);
@@ -313,19 +315,37 @@ void GLC_ViewHandler::render()
             m_pViewport->glExecuteCam();
         }
 
-        m_World.render(0, m_RenderFlag);
-        m_World.render(0, glc::TransparentRenderFlag);
-        m_World.render(1, m_RenderFlag);
-
-        if (!GLC_State::isInSelectionMode())
+        if (GLC_State::isInSelectionMode())
         {
-            m_pMoverController->drawActiveMoverRep();
+            GLC_ProfileScope scope("Selection render");
+            GLC_FrameProfiler::beginGpuPass("Selection render");
+            m_World.render(0, m_RenderFlag);
+            m_World.render(0, glc::TransparentRenderFlag);
+            m_World.render(1, m_RenderFlag);
+            m_3DWidgetManager.render();
+            GLC_FrameProfiler::endGpuPass();
         }
+        else
+        {
+            GLC_ProfileScope scope("Draw submission");
+            GLC_FrameProfiler::beginGpuPass("Opaque pass");
+            m_World.render(0, m_RenderFlag);
+            GLC_FrameProfiler::endGpuPass();
 
-        m_3DWidgetManager.render();
+            GLC_FrameProfiler::beginGpuPass("Transparent pass");
+            m_World.render(0, glc::TransparentRenderFlag);
+            GLC_FrameProfiler::endGpuPass();
+
+            GLC_FrameProfiler::beginGpuPass("Overlay pass");
+            m_World.render(1, m_RenderFlag);
+            m_pMoverController->drawActiveMoverRep();
+            m_3DWidgetManager.render();
+            GLC_FrameProfiler::endGpuPass();
+        }
     }
     catch (GLC_Exception &e)
     {
         qDebug() << e.what();
     }
+    GLC_FrameProfiler::endFrame();
 }
@@ -154,6 +154,21 @@ GLC_Vector3d GLC_Viewport::mapNormalyzePosMouse(double Posx, double Posy) const
 	return mapPosMouse(screenX, screenY);
 }
 
+QList<GLC_Plane> GLC_Viewport::usedClipPlanes() const
+{
+	QList<GLC_Plane> subject;
+	if (m_UseClipPlane)
+	{
+		QHash<GLenum, GLC_Plane*>::const_iterator iClip= m_ClipPlanesHash.constBegin();
+		while (m_ClipPlanesHash.constEnd() != iClip)
+		{
+			subject.append(*(iClip.value()));
+			++iClip;
+		}
+	}
+	return subject;
+}
+
 //////////////////////////////////////////////////////////////////////
 // Public OpenGL Functions
 //////////////////////////////////////////////////////////////////////
@@ -275,36 +290,47 @@ void GLC_Viewport::updateAspectRatio()
 GLC_Frustum GLC_Viewport::selectionFrustum(int x, int y) const
 {
 	const int halfSize= m_SelectionSquareSize / 2;
-	// Calculate the 4 points of the selection
+	return selectionFrustum(x - halfSize, y - halfSize, x + halfSize, y + halfSize);
+}
+
+GLC_Frustum GLC_Viewport::selectionFrustum(int x1, int y1, int x2, int y2) const
+{
+	// The selection rectangle is at least one pixel wide
+	const int xMin= qMin(x1, x2);
+	const int yMin= qMin(y1, y2);
+	const int xMax= qMax(qMax(x1, x2), xMin + 1);
+	const int yMax= qMax(qMax(y1, y2), yMin + 1);
+
+	// The rays of the 4 corners of the selection
 	//p1->p2
 	//
 	//p0  p3
-	QList<int> coordinates;
-	// Point 0
-	coordinates << (x - halfSize) << (y + halfSize);
-	// Point 1
-	coordinates << (x - halfSize) << (y - halfSize);
-	// Point 2
-	coordinates << (x + halfSize) << (y - halfSize);
-	// Point 3
-	coordinates << (x + halfSize) << (y + halfSize);
-
-	// Unproject the 4 point
-	QList<GLC_Point3d> listOfPoint= unproject(coordinates);
-
-	Q_ASSERT(4 == listOfPoint.size());
-	// Create the four frustum planes
-	GLC_Point3d eye= m_pViewCam->eye();
-	const GLC_Plane leftPlane(listOfPoint.at(0), listOfPoint.at(1), eye);
-	const GLC_Plane rightPlane(listOfPoint.at(3), eye , listOfPoint.at(2));
-	const GLC_Plane upPlane(listOfPoint.at(2), eye, listOfPoint.at(1));
-	const GLC_Plane bottomPlane(listOfPoint.at(0), eye, listOfPoint.at(3));
+	const GLC_Line3d rays[4]= {pickingRay(xMin, yMax), pickingRay(xMin, yMin), pickingRay(xMax, yMin), pickingRay(xMax, yMax)};
+
+	// A point inside the selection volume
+	const GLC_Line3d centerRay(pickingRay((xMin + xMax) / 2, (yMin + yMax) / 2));
+	const GLC_Point3d center(centerRay.startingPoint() + (centerRay.direction() * 0.5));
+
+	// Each side plane contains the rays of 2 consecutive corners and is oriented toward the center
+	GLC_Plane sidePlanes[4];
+	for (int i= 0; i < 4; ++i)
+	{
+		const GLC_Line3d& ray= rays[i];
+		const GLC_Line3d& nextRay= rays[(i + 1) % 4];
+		GLC_Plane plane(ray.startingPoint(), nextRay.startingPoint(), nextRay.startingPoint() + nextRay.direction());
+		if (plane.distanceToPoint(center) < 0.0)
+		{
+			plane= GLC_Plane(-plane.coefA(), -plane.coefB(), -plane.coefC(), -plane.coefD());
+		}
+		sidePlanes[i]= plane;
+	}
 
+	// The near and far planes are the planes of the viewport frustum
 	GLC_Frustum selectionFrustum(m_Frustum);
-	selectionFrustum.setLeftClippingPlane(leftPlane);
-	selectionFrustum.setRightClippingPlane(rightPlane);
-	selectionFrustum.setTopClippingPlane(upPlane);
-	selectionFrustum.setBottomClippingPlane(bottomPlane);
+	selectionFrustum.setLeftClippingPlane(sidePlanes[0]);
+	selectionFrustum.setTopClippingPlane(sidePlanes[1]);
+	selectionFrustum.setRightClippingPlane(sidePlanes[2]);
+	selectionFrustum.setBottomClippingPlane(sidePlanes[3]);
 
 	return selectionFrustum;
 }
@@ -335,6 +361,50 @@ GLC_Point3d GLC_Viewport::unproject(int x, int y, GLenum buffer, bool onGeometry
     return subject;
 }
 
+GLC_Point3d GLC_Viewport::unproject(int x, int y, GLC_RayPicker* pPicker, bool onGeometry) const
+{
+    Q_ASSERT(NULL != pPicker);
+    const GLC_Line3d ray(pickingRay(x, y));
+    const GLC_RayHit hit(pPicker->pick(ray));
+
+    GLC_Point3d subject;
+    if (hit.isValid())
+    {
+        subject= hit.point();
+    }
+    else if (!onGeometry)
+    {
+        subject= ray.startingPoint() + ray.direction();
+    }
+    return subject;
+}
+
+GLC_Line3d GLC_Viewport::pickingRay(int x, int y) const
+{
+    // The current viewport opengl definition
+    GLint viewport[4]= {0, 0, m_Width, m_Height};
+
+    // Unproject the point on the near and the far plane
+    GLdouble nearX, nearY, nearZ;
+    glc::gluUnProject((GLdouble) x, (GLdouble) (m_Height - y), 0.0
+        , m_pViewCam->modelViewMatrix().getData(), m_ProjectionMatrix.getData(), viewport, &nearX, &nearY, &nearZ);
+
+    GLdouble farX, farY, farZ;
+    glc::gluUnProject((GLdouble) x, (GLdouble) (m_Height - y), 1.0
+        , m_pViewCam->modelViewMatrix().getData(), m_ProjectionMatrix.getData(), viewport, &farX, &farY, &farZ);
+
+    const GLC_Point3d nearPoint(nearX, nearY, nearZ);
+    const GLC_Point3d farPoint(farX, farY, farZ);
+
+    return GLC_Line3d(nearPoint, farPoint - nearPoint);
+}
+
+GLC_RayHit GLC_Viewport::pick(int x, int y, GLC_RayPicker* pPicker) const
+{
+    Q_ASSERT(NULL != pPicker);
+    return pPicker->pick(pickingRay(x, y));
+}
+
 GLC_Point2d GLC_Viewport::project(const GLC_Point3d &point, bool useCameraMatrix) const
 {
     GLC_Matrix4x4 modelView;
@@ -956,6 +1026,7 @@ void GLC_Viewport::removeAllClipPlane()
 		delete iClip.value();
 		++iClip;
 	}
+	m_ClipPlanesHash.clear();
 }
 
 void GLC_Viewport::useClipPlane(bool flag)
@@ -35,6 +35,8 @@
 #include "glc_frustum.h"
 #include "../maths/glc_plane.h"
 #include "../sceneGraph/glc_3dviewcollection.h"
+#include "../sceneGraph/glc_raypicker.h"
+#include "../maths/glc_line3d.h"
 
 #include "../glc_config.h"
 
@@ -155,6 +157,14 @@ public:
 	inline bool useOrtho()const
 	{return m_UseParallelProjection;}
 
+	//! Return true if the clipping planes are used
+	inline bool clipPlaneIsUsed() const
+	{return m_UseClipPlane;}
+
+	//! Return the used clipping planes in world coordinates
+	/*! Empty if the clipping planes are not used*/
+	QList<GLC_Plane> usedClipPlanes() const;
+
 	//! Return the minimum pixel culling size
 	inline int minimumPixelCullingSize() const
 	{return m_MinimumStaticPixelSize;}
@@ -196,9 +206,27 @@ public:
 	//! Return the frustum associated to a selection coordinate
 	GLC_Frustum selectionFrustum(int, int) const;
 
+	//! Return the frustum of the given selection rectangle
+	/*! The frustum is computed from the camera and the projection, no OpenGL buffer is read.
+	 *  See GLC_FrustumSelector to select the instances inside this frustum*/
+	GLC_Frustum selectionFrustum(int x1, int y1, int x2, int y2) const;
+
 	//! Return the world 3d point from the given screen coordinate
     GLC_Point3d unproject(int, int, GLenum buffer= GL_FRONT, bool onGeometry= false) const;
 
+    //! Return the world 3d point from the given screen coordinate picked on the CPU with the given picker
+    /*! If no geometry is hit, return the point on the far plane, or a null point if onGeometry is true.
+     *  No OpenGL buffer is read*/
+    GLC_Point3d unproject(int x, int y, GLC_RayPicker* pPicker, bool onGeometry= false) const;
+
+    //! Return the world ray of the given screen coordinate
+    /*! The ray starts on the near plane, its direction length is the distance to the far plane*/
+    GLC_Line3d pickingRay(int x, int y) const;
+
+    //! Return the nearest hit of the given screen coordinate picked on the CPU with the given picker
+    /*! Unlike renderAndSelect(), selectBody() and selectPrimitive() the scene is not rendered*/
+    GLC_RayHit pick(int x, int y, GLC_RayPicker* pPicker) const;
+
     //! Return the screen coordinate from the world 3D point
     GLC_Point2d project(const GLC_Point3d& point, bool useCameraMatrix= true) const;
 
@@ -299,7 +327,8 @@ public:
 	{m_SelectionSquareSize= size;}
 
 	//! Update this viewport frustum (frustum cullin purpose)
-	/*! Return true if the frustum has changed*/
+	/*! The used clipping planes are added to the frustum
+	 *  Return true if the frustum has changed*/
 	inline bool updateFrustum(GLC_Matrix4x4* pMat= NULL);
 
 	//! Add a clipping plane to this viewport
@@ -454,13 +483,17 @@ GLC_Matrix4x4 GLC_Viewport::compositionMatrix() const
 
 bool GLC_Viewport::updateFrustum(GLC_Matrix4x4* pMat)
 {
+	// What is clipped is culled as what is out of the frustum
+	const bool clipPlanesChanged= m_Frustum.setClipPlanes(usedClipPlanes());
+	bool frustumChanged;
 	if (NULL == pMat)
 	{
-		return m_Frustum.update(compositionMatrix());
+		frustumChanged= m_Frustum.update(compositionMatrix());
 	}
 	else
 	{
-		return m_Frustum.update(*pMat);
+		frustumChanged= m_Frustum.update(*pMat);
 	}
+	return clipPlanesChanged || frustumChanged;
 }
 #endif //GLC_VIEWPORT_H_
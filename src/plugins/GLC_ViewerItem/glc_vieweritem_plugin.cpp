@@ -3,6 +3,7 @@
 #include <GLC_QuickCamera>
 #include <GLC_QuickSelection>
 #include <GLC_QuickOccurrence>
+#include <GLC_QuickProfiler>
 
 #include <qqml.h>
 
@@ -13,6 +14,7 @@ void GLC_ViewerItemPlugin::registerTypes(const char *uri)
     qmlRegisterType<GLC_QuickCamera>();
     qmlRegisterType<GLC_QuickOccurrence>();
     qmlRegisterType<GLC_QuickSelection>();
+    qmlRegisterType<GLC_QuickProfiler>();
 }
 
 